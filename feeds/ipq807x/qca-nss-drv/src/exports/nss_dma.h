@@ -297,6 +297,129 @@ void nss_dma_init(void);
  */
 extern struct nss_ctx_instance *nss_dma_get_context(void);
 
+/*
+ * Maximum number of segments in a copy job
+ */
+#define NSS_DMA_COPY_SEG_MAX 16
+
+/*
+ * Copy job flags
+ */
+#define NSS_DMA_COPY_FLAG_CPU 0x01		/**< Copy every segment on the CPU. */
+#define NSS_DMA_COPY_FLAG_OFFLOAD 0x02		/**< Copy every segment on the DMA engine, whatever its size. */
+
+/**
+ * nss_dma_copy_seg
+ *	One contiguous copy; its source and destination must not overlap.
+ *
+ * Only memory of the kernel linear map, such as kmalloc() or skb data, can
+ * be copied by the DMA engine; other segments are copied on the CPU.
+ */
+struct nss_dma_copy_seg {
+	void *dst;		/**< Destination of the copy. */
+	const void *src;	/**< Source of the copy. */
+	size_t len;		/**< Bytes to copy. */
+};
+
+/**
+ * Callback function for completed copy jobs.
+ *
+ * @param[in] app_data  Pointer to the application context of the job.
+ * @param[in] status    0 when all segments were copied or a negative error.
+ */
+typedef void (*nss_dma_copy_callback_t)(void *app_data, int status);
+
+/**
+ * nss_dma_copy_job
+ *	Scatter-gather copy job.
+ *
+ * The job and its segments must stay valid until the callback runs.
+ */
+struct nss_dma_copy_job {
+	struct work_struct work;	/**< Driver private, runs the completion. */
+	struct nss_dma_copy_seg *segs;	/**< Segments to copy. */
+	uint16_t num_segs;		/**< Number of segments. */
+	uint16_t mapped;		/**< Driver private, segments mapped for the engine. */
+	uint32_t flags;			/**< NSS_DMA_COPY_FLAG_* flags. */
+	atomic_t pending;		/**< Driver private, segments in flight. */
+	int status;			/**< Driver private, status passed to the callback. */
+	dma_addr_t src_addr[NSS_DMA_COPY_SEG_MAX];
+					/**< Driver private, source mappings. */
+	dma_addr_t dst_addr[NSS_DMA_COPY_SEG_MAX];
+					/**< Driver private, destination mappings. */
+	nss_dma_copy_callback_t cb;	/**< Completion callback. */
+	void *app_data;			/**< Context passed to the callback. */
+};
+
+/**
+ * nss_dma_copy_job_init
+ *	Initializes a copy job.
+ *
+ * @datatypes
+ * nss_dma_copy_job \n
+ * nss_dma_copy_seg
+ *
+ * @param[in,out] job       Pointer to the job.
+ * @param[in]     segs      Pointer to the segments.
+ * @param[in]     num_segs  Number of segments, at most NSS_DMA_COPY_SEG_MAX.
+ * @param[in]     flags     NSS_DMA_COPY_FLAG_* flags, 0 to let the driver choose.
+ * @param[in]     cb        Completion callback.
+ * @param[in]     app_data  Context passed to the callback.
+ *
+ * @return
+ * None.
+ */
+extern void nss_dma_copy_job_init(struct nss_dma_copy_job *job, struct nss_dma_copy_seg *segs, uint16_t num_segs,
+			uint32_t flags, nss_dma_copy_callback_t cb, void *app_data);
+
+/**
+ * nss_dma_copy_submit
+ *	Queues a copy job.
+ *
+ * Segments are handed to the DMA engine when one is available and copied on
+ * the CPU otherwise. The callback runs in process context once every
+ * segment is copied, never from within this call. A job can be submitted
+ * again from its callback.
+ *
+ * @datatypes
+ * nss_dma_copy_job
+ *
+ * @param[in] job  Pointer to the job.
+ *
+ * @return
+ * 0 on success, -EINVAL for a malformed job, -EBUSY if the job is still
+ * queued, -EOPNOTSUPP if NSS_DMA_COPY_FLAG_OFFLOAD is set without a DMA
+ * engine, or -ENODEV if copies are not available.
+ */
+extern int nss_dma_copy_submit(struct nss_dma_copy_job *job);
+
+/**
+ * nss_dma_copy
+ *	Copies the segments on the CPU in the caller context.
+ *
+ * Fallback for callers that cannot wait for a completion; usable in
+ * atomic context.
+ *
+ * @datatypes
+ * nss_dma_copy_seg
+ *
+ * @param[in] segs      Pointer to the segments.
+ * @param[in] num_segs  Number of segments, at most NSS_DMA_COPY_SEG_MAX.
+ *
+ * @return
+ * 0 on success or -EINVAL for malformed segments.
+ */
+extern int nss_dma_copy(struct nss_dma_copy_seg *segs, uint16_t num_segs);
+
+/**
+ * nss_dma_copy_has_offload
+ *	Checks whether copy jobs can be offloaded to a DMA engine.
+ *
+ * @return
+ * True if a memcpy capable DMA engine channel is in use.
+ */
+extern bool nss_dma_copy_has_offload(void);
+
 /**
  * nss_dma_stats_unregister_notifier
  *	Deregisters a statistics notifier.
@@ -156,6 +156,8 @@ enum nss_ipv4_message_types {
 	NSS_IPV4_TX_CONN_TABLE_SIZE_MSG,
 	NSS_IPV4_TX_DSCP2PRI_CFG_MSG,
 	NSS_IPV4_TX_RPS_HASH_BITMAP_CFG_MSG,
+	NSS_IPV4_TX_CREATE_RULE_MANY_MSG,
+	NSS_IPV4_TX_DESTROY_RULE_MANY_MSG,
 	NSS_IPV4_MAX_MSG_TYPES,
 };
 
@@ -784,6 +786,57 @@ struct nss_ipv4_conn_sync_many_msg {
 	struct nss_ipv4_conn_sync conn_sync[];	/**< Array for the statistics. */
 };
 
+/**
+ * nss_ipv4_rule_many_status
+ *	Result for one rule of a multiple rule create or destroy message.
+ */
+struct nss_ipv4_rule_many_status {
+	uint16_t response;	/**< Response for the rule, from nss_cmn_response. */
+	uint16_t error;		/**< Error for the rule, from nss_ipv4_error_response_types. */
+};
+
+/**
+ * nss_ipv4_rule_create_many_entry
+ *	One rule of a multiple rule create message.
+ */
+struct nss_ipv4_rule_create_many_entry {
+	struct nss_ipv4_rule_many_status status;	/**< Firmware response for this rule. */
+	struct nss_ipv4_rule_create_msg rule;		/**< Rule to create. */
+};
+
+/**
+ * nss_ipv4_rule_destroy_many_entry
+ *	One rule of a multiple rule destroy message.
+ */
+struct nss_ipv4_rule_destroy_many_entry {
+	struct nss_ipv4_rule_many_status status;	/**< Firmware response for this rule. */
+	struct nss_ipv4_rule_destroy_msg rule;		/**< Rule to destroy. */
+};
+
+/**
+ * nss_ipv4_rule_create_many_msg
+ *	Information for a multiple IPv4 rule create message.
+ *
+ * The firmware returns the message with the status of every entry filled in.
+ */
+struct nss_ipv4_rule_create_many_msg {
+	uint16_t count;		/**< Number of rules included in this message. */
+	uint16_t size;		/**< Buffer size of this message. */
+	struct nss_ipv4_rule_create_many_entry entry[];	/**< Array of rules. */
+};
+
+/**
+ * nss_ipv4_rule_destroy_many_msg
+ *	Information for a multiple IPv4 rule destroy message.
+ *
+ * The firmware returns the message with the status of every entry filled in.
+ */
+struct nss_ipv4_rule_destroy_many_msg {
+	uint16_t count;		/**< Number of rules included in this message. */
+	uint16_t size;		/**< Buffer size of this message. */
+	struct nss_ipv4_rule_destroy_many_entry entry[];	/**< Array of rules. */
+};
+
 /**
  * nss_ipv4_accel_mode_cfg_msg
  *	IPv4 acceleration mode configuration.
@@ -1003,6 +1056,10 @@ struct nss_ipv4_msg {
 				/**< Configure dscp2pri mapping. */
 		struct nss_ipv4_rps_hash_bitmap_cfg_msg rps_hash_bitmap;
 				/**< Configure rps_hash_bitmap. */
+		struct nss_ipv4_rule_create_many_msg rule_create_many;
+				/**< Create multiple rules. */
+		struct nss_ipv4_rule_destroy_many_msg rule_destroy_many;
+				/**< Destroy multiple rules. */
 	} msg;			/**< Message payload. */
 };
 
@@ -1017,6 +1074,20 @@ struct nss_ipv4_stats_notification {
 	uint64_t exception_stats[NSS_IPV4_EXCEPTION_EVENT_MAX];	/**< IPv4 exception statistics. */
 };
 
+/**
+ * nss_ipv4_flow_info
+ *	Accelerated IPv4 connection as known to the host.
+ */
+struct nss_ipv4_flow_info {
+	struct nss_ipv4_5tuple tuple;			/**< 5-tuple of the connection. */
+	struct nss_ipv4_connection_rule conn_rule;	/**< Connection rule it was created with. */
+	uint64_t flow_rx_packets;	/**< Packets received in the flow direction. */
+	uint64_t flow_rx_bytes;		/**< Bytes received in the flow direction. */
+	uint64_t return_rx_packets;	/**< Packets received in the return direction. */
+	uint64_t return_rx_bytes;	/**< Bytes received in the return direction. */
+	unsigned long last_sync;	/**< Time of the last synchronization, in jiffies. */
+};
+
 /**
  * Configured IPv4 connection number to use for calculating the total number of
  * connections.
@@ -1095,6 +1166,78 @@ extern nss_tx_status_t nss_ipv4_tx_sync(struct nss_ctx_instance *nss_ctx, struct
  */
 extern nss_tx_status_t nss_ipv4_tx_with_size(struct nss_ctx_instance *nss_ctx, struct nss_ipv4_msg *msg, uint32_t size);
 
+/**
+ * nss_ipv4_tx_rule_coalesced
+ *	Queues an IPv4 create or destroy rule message to be transmitted to the NSS
+ *	together with other rule messages.
+ *
+ * @datatypes
+ * nss_ctx_instance \n
+ * nss_ipv4_msg
+ *
+ * @param[in] nss_ctx  Pointer to the NSS context.
+ * @param[in] msg      Pointer to the message data.
+ *
+ * @return
+ * Status of queuing the message.
+ *
+ * @note Queued rules go out in one multiple rule message after a short window,
+ *       or as soon as the message is full. The callback of each rule message is
+ *       called with the response for that rule. Rule messages are only kept in
+ *       order with respect to each other, so all create and destroy messages of
+ *       a connection must use this API once one of them does.
+ */
+extern nss_tx_status_t nss_ipv4_tx_rule_coalesced(struct nss_ctx_instance *nss_ctx, struct nss_ipv4_msg *msg);
+
+/**
+ * Callback function for iterating over accelerated IPv4 connections.
+ *
+ * @datatypes
+ * nss_ipv4_flow_info
+ *
+ * @param[in] app_data  Pointer to the application context.
+ * @param[in] info      Pointer to the connection information.
+ *
+ * @return
+ * False to stop the iteration.
+ */
+typedef bool (*nss_ipv4_flow_iter_callback_t)(void *app_data, struct nss_ipv4_flow_info *info);
+
+/**
+ * nss_ipv4_flow_find
+ *	Looks up an accelerated IPv4 connection in the host flow table.
+ *
+ * @datatypes
+ * nss_ipv4_5tuple \n
+ * nss_ipv4_flow_info
+ *
+ * @param[in]  tuple  Pointer to the 5-tuple of the connection.
+ * @param[out] info   Pointer to the connection information, or NULL.
+ *
+ * @return
+ * True if the connection is accelerated.
+ */
+extern bool nss_ipv4_flow_find(struct nss_ipv4_5tuple *tuple, struct nss_ipv4_flow_info *info);
+
+/**
+ * nss_ipv4_flow_iterate
+ *	Calls a function for every accelerated IPv4 connection in the host flow table.
+ *
+ * @datatypes
+ * nss_ipv4_flow_iter_callback_t
+ *
+ * @param[in] cb        Callback function for each connection.
+ * @param[in] app_data  Pointer to the application context.
+ *
+ * @return
+ * Number of connections visited.
+ *
+ * @note The callback runs in the caller's context, without the flow table
+ *       lock, on a copy of each connection. Connections added or removed
+ *       during the walk may or may not be visited.
+ */
+extern uint32_t nss_ipv4_flow_iterate(nss_ipv4_flow_iter_callback_t cb, void *app_data);
+
 /**
  * nss_ipv4_notify_register
  *	Registers a notifier callback to forward the IPv4 messages received from the NSS
@@ -227,6 +227,8 @@ enum nss_ipv6_message_types {
 	NSS_IPV6_TX_CONN_TABLE_SIZE_MSG,
 	NSS_IPV6_TX_DSCP2PRI_CFG_MSG,
 	NSS_IPV6_TX_RPS_HASH_BITMAP_CFG_MSG,
+	NSS_IPV6_TX_CREATE_RULE_MANY_MSG,
+	NSS_IPV6_TX_DESTROY_RULE_MANY_MSG,
 	NSS_IPV6_MAX_MSG_TYPES,
 };
 
@@ -871,6 +873,57 @@ struct nss_ipv6_conn_sync_many_msg {
 	struct nss_ipv6_conn_sync conn_sync[];	/**< Array for the statistics. */
 };
 
+/**
+ * nss_ipv6_rule_many_status
+ *	Result for one rule of a multiple rule create or destroy message.
+ */
+struct nss_ipv6_rule_many_status {
+	uint16_t response;	/**< Response for the rule, from nss_cmn_response. */
+	uint16_t error;		/**< Error for the rule, from nss_ipv6_error_response_types. */
+};
+
+/**
+ * nss_ipv6_rule_create_many_entry
+ *	One rule of a multiple rule create message.
+ */
+struct nss_ipv6_rule_create_many_entry {
+	struct nss_ipv6_rule_many_status status;	/**< Firmware response for this rule. */
+	struct nss_ipv6_rule_create_msg rule;		/**< Rule to create. */
+};
+
+/**
+ * nss_ipv6_rule_destroy_many_entry
+ *	One rule of a multiple rule destroy message.
+ */
+struct nss_ipv6_rule_destroy_many_entry {
+	struct nss_ipv6_rule_many_status status;	/**< Firmware response for this rule. */
+	struct nss_ipv6_rule_destroy_msg rule;		/**< Rule to destroy. */
+};
+
+/**
+ * nss_ipv6_rule_create_many_msg
+ *	Information for a multiple IPv6 rule create message.
+ *
+ * The firmware returns the message with the status of every entry filled in.
+ */
+struct nss_ipv6_rule_create_many_msg {
+	uint16_t count;		/**< Number of rules included in this message. */
+	uint16_t size;		/**< Buffer size of this message. */
+	struct nss_ipv6_rule_create_many_entry entry[];	/**< Array of rules. */
+};
+
+/**
+ * nss_ipv6_rule_destroy_many_msg
+ *	Information for a multiple IPv6 rule destroy message.
+ *
+ * The firmware returns the message with the status of every entry filled in.
+ */
+struct nss_ipv6_rule_destroy_many_msg {
+	uint16_t count;		/**< Number of rules included in this message. */
+	uint16_t size;		/**< Buffer size of this message. */
+	struct nss_ipv6_rule_destroy_many_entry entry[];	/**< Array of rules. */
+};
+
 /**
  * nss_ipv6_accel_mode_cfg_msg
  *	IPv6 acceleration mode configuration.
@@ -998,6 +1051,10 @@ struct nss_ipv6_msg {
 				/**< Configure DSCP-to-priority mapping. */
 		struct nss_ipv6_rps_hash_bitmap_cfg_msg rps_hash_bitmap;
 				/**< Configure rps_hash_bitmap. */
+		struct nss_ipv6_rule_create_many_msg rule_create_many;
+				/**< Create multiple rules. */
+		struct nss_ipv6_rule_destroy_many_msg rule_destroy_many;
+				/**< Destroy multiple rules. */
 	} msg;			/**< Message payload. */
 };
 
@@ -1090,6 +1147,29 @@ extern nss_tx_status_t nss_ipv6_tx_sync(struct nss_ctx_instance *nss_ctx, struct
  */
 extern nss_tx_status_t nss_ipv6_tx_with_size(struct nss_ctx_instance *nss_ctx, struct nss_ipv6_msg *msg, uint32_t size);
 
+/**
+ * nss_ipv6_tx_rule_coalesced
+ *	Queues an IPv6 create or destroy rule message to be transmitted to the NSS
+ *	together with other rule messages.
+ *
+ * @datatypes
+ * nss_ctx_instance \n
+ * nss_ipv6_msg
+ *
+ * @param[in] nss_ctx  Pointer to the NSS context.
+ * @param[in] msg      Pointer to the message data.
+ *
+ * @return
+ * Status of queuing the message.
+ *
+ * @note Queued rules go out in one multiple rule message after a short window,
+ *       or as soon as the message is full. The callback of each rule message is
+ *       called with the response for that rule. Rule messages are only kept in
+ *       order with respect to each other, so all create and destroy messages of
+ *       a connection must use this API once one of them does.
+ */
+extern nss_tx_status_t nss_ipv6_tx_rule_coalesced(struct nss_ctx_instance *nss_ctx, struct nss_ipv6_msg *msg);
+
 /**
  * nss_ipv6_notify_register
  *	Registers a notifier callback to forward the IPv6 messages received from the NSS
@@ -37,6 +37,8 @@ enum nss_qrfs_msg_types {
 	NSS_QRFS_MSG_MAC_ADD,
 	NSS_QRFS_MSG_MAC_DELETE,
 	NSS_QRFS_MSG_STATS_SYNC,
+	NSS_QRFS_MSG_FLOW_ADD_MANY,
+	NSS_QRFS_MSG_FLOW_DELETE_MANY,
 	NSS_QRFS_MSG_MAX,
 };
 
@@ -91,6 +93,16 @@ struct nss_qrfs_stats_sync_msg {
 	uint32_t ipv6_flow_rule_hits;		/**< Number of IPv6 flow rule hits. */
 };
 
+/**
+ * nss_qrfs_flow_rule_many_msg
+ *	Several flow rules added or deleted with one message.
+ */
+struct nss_qrfs_flow_rule_many_msg {
+	uint16_t count;					/**< Number of rules in the message. */
+	uint16_t size;					/**< Size of the whole message, including the rules. */
+	struct nss_qrfs_flow_rule_msg rule[];		/**< Array of rules. */
+};
+
 /**
  * nss_qrfs_msg
  *	Data for sending and receiving NSS QRFS rule or statistics messages.
@@ -107,6 +119,10 @@ struct nss_qrfs_msg {
 		struct nss_qrfs_mac_rule_msg mac_add;		/**< Add MAC rule. */
 		struct nss_qrfs_mac_rule_msg mac_delete;	/**< Delete MAC rule. */
 		struct nss_qrfs_stats_sync_msg stats_sync;	/**< Synchronize statistics. */
+		struct nss_qrfs_flow_rule_many_msg flow_add_many;
+				/**< Add several flow rules. */
+		struct nss_qrfs_flow_rule_many_msg flow_delete_many;
+				/**< Delete several flow rules. */
 	} msg;			/**< Message payload. */
 };
 
@@ -165,6 +181,16 @@ void nss_qrfs_notify_unregister(int core);
  * nss_qrfs_set_flow_rule
  *	Sends a QRFS message to the NSS core to set the flow rule.
  *
+ * Rules are recorded in a host table. Adding a rule that is already
+ * programmed with the same CPU only marks it as active. When
+ * dev.nss.qrfs.rule_idle_sec is set, rules that stay idle that long are
+ * deleted when statistics are synchronized. Rules the NSS rejects are
+ * dropped from the table.
+ *
+ * Each change is sent to the NSS right away, unless dev.nss.qrfs.rule_batch
+ * is set for firmware taking multi-rule messages. Changes are then batched
+ * and the status only reflects queuing.
+ *
  * @datatypes
  * sk_buff
  *
@@ -177,6 +203,24 @@ void nss_qrfs_notify_unregister(int core);
  */
 nss_tx_status_t nss_qrfs_set_flow_rule(struct sk_buff *skb, uint32_t cpu, uint32_t action);
 
+/**
+ * nss_qrfs_set_flow_rule_msg
+ *	Sends a QRFS message to the NSS cores to set an already built flow rule.
+ *
+ * Addresses and ports are in network byte order, as produced by
+ * nss_qrfs_set_flow_rule() from a packet.
+ *
+ * @datatypes
+ * nss_qrfs_flow_rule_msg
+ *
+ * @param[in] rule    Pointer to the flow rule, including the CPU to steer to.
+ * @param[in] action  Action to perform on the flow table.
+ *
+ * @return
+ * Status of the Tx operation.
+ */
+nss_tx_status_t nss_qrfs_set_flow_rule_msg(struct nss_qrfs_flow_rule_msg *rule, uint32_t action);
+
 /**
  * nss_qrfs_init
  *	Initializes the QRFS.
@@ -186,6 +230,15 @@ nss_tx_status_t nss_qrfs_set_flow_rule(struct sk_buff *skb, uint32_t cpu, uint32
  */
 void nss_qrfs_init(void);
 
+/**
+ * nss_qrfs_exit
+ *	Releases the QRFS host state.
+ *
+ * @return
+ * None.
+ */
+void nss_qrfs_exit(void);
+
 /**
  * @}
  */
@@ -0,0 +1,74 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/**
+ * @file nss_stats_bin.h
+ *	Layout of the binary statistics files under qca-nss-drv/stats_bin.
+ *
+ * Only fixed width types are used so the header can also be included by
+ * userspace readers.
+ */
+
+#ifndef __NSS_STATS_BIN_H
+#define __NSS_STATS_BIN_H
+
+#ifdef __KERNEL__
+#include <linux/types.h>
+#else
+#include <stdint.h>
+#endif
+
+/**
+ * @addtogroup nss_stats_public_subsystem
+ * @{
+ */
+
+/*
+ * A file holds a struct nss_stats_bin_hdr followed by num_blocks blocks.
+ * Each block is a struct nss_stats_bin_block followed by num_counters
+ * uint64_t counters in host byte order, in the order of the matching table
+ * under qca-nss-drv/strings. The whole file should be read in one go; every
+ * read starting at offset 0 takes a new snapshot.
+ */
+#define NSS_STATS_BIN_MAGIC 0x4e535342		/**< "NSSB". */
+#define NSS_STATS_BIN_VERSION 1			/**< Layout version. */
+
+/**
+ * nss_stats_bin_hdr
+ *	Header of a binary statistics file.
+ */
+struct nss_stats_bin_hdr {
+	uint32_t magic;		/**< NSS_STATS_BIN_MAGIC. */
+	uint16_t version;	/**< NSS_STATS_BIN_VERSION. */
+	uint16_t num_blocks;	/**< Blocks that follow. */
+};
+
+/**
+ * nss_stats_bin_block
+ *	Header of one block of counters.
+ */
+struct nss_stats_bin_block {
+	uint32_t num_counters;	/**< Counters that follow. */
+	uint32_t reserved;	/**< Keeps the counters 64-bit aligned. */
+};
+
+/**
+ * @}
+ */
+
+#endif /* __NSS_STATS_BIN_H */
@@ -0,0 +1,191 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/**
+ * @file nss_tx_msg_txn.h
+ *	NSS pipelined message transaction definitions.
+ */
+
+#ifndef __NSS_TX_MSG_TXN_H
+#define __NSS_TX_MSG_TXN_H
+
+/**
+ * @addtogroup nss_tx_msg_txn_subsystem
+ * @{
+ */
+
+#define NSS_TX_MSG_TXN_DEFAULT_IN_FLIGHT 32
+		/**< Default number of transaction messages waiting for a response. */
+
+/**
+ * nss_tx_msg_txn
+ *	Opaque pipelined message transaction.
+ */
+struct nss_tx_msg_txn;
+
+/**
+ * Callback function of a subsystem that sends a message asynchronously.
+ *
+ * @datatypes
+ * nss_ctx_instance \n
+ * nss_cmn_msg
+ *
+ * @param[in] nss_ctx  Pointer to the NSS context.
+ * @param[in] ncm      Pointer to the message.
+ */
+typedef nss_tx_status_t (*nss_tx_msg_sync_subsys_async_t)(struct nss_ctx_instance *nss_ctx, struct nss_cmn_msg *ncm);
+
+/**
+ * Callback function of a subsystem that sends a message of a given buffer size asynchronously.
+ *
+ * @datatypes
+ * nss_ctx_instance \n
+ * nss_cmn_msg
+ *
+ * @param[in] nss_ctx  Pointer to the NSS context.
+ * @param[in] ncm      Pointer to the message.
+ * @param[in] size     Size of the message buffer.
+ */
+typedef nss_tx_status_t (*nss_tx_msg_sync_subsys_async_with_size_t)(struct nss_ctx_instance *nss_ctx, struct nss_cmn_msg *ncm, uint32_t size);
+
+/**
+ * nss_tx_msg_txn_alloc
+ *	Allocates a transaction for up to max_msgs messages.
+ *
+ * Messages of a transaction are sent back to back and their responses are
+ * waited for once, instead of one round trip to the NSS per message.
+ *
+ * @datatypes
+ * nss_ctx_instance
+ *
+ * @param[in] nss_ctx        Pointer to the NSS context the messages are sent to.
+ * @param[in] max_msgs       Maximum number of messages in the transaction.
+ * @param[in] max_in_flight  Maximum number of messages waiting for a response,
+ *                           0 for NSS_TX_MSG_TXN_DEFAULT_IN_FLIGHT.
+ * @param[in] timeout        Timeout in milliseconds of every wait.
+ *
+ * @return
+ * Pointer to the transaction or NULL on failure.
+ *
+ * @dependencies
+ * Must be called from process context.
+ */
+extern struct nss_tx_msg_txn *nss_tx_msg_txn_alloc(struct nss_ctx_instance *nss_ctx, uint32_t max_msgs,
+				uint32_t max_in_flight, uint32_t timeout);
+
+/**
+ * nss_tx_msg_txn_add
+ *	Sends a message as part of a transaction without waiting for its response.
+ *
+ * The callback and application data of the message are replaced. The part of
+ * the response payload at resp_offset, copy_len bytes long, is copied back to
+ * the message when the response arrives.
+ *
+ * @datatypes
+ * nss_tx_msg_txn \n
+ * nss_cmn_msg
+ *
+ * @param[in]     txn           Pointer to the transaction.
+ * @param[in]     tx_msg_async  Asynchronous send function of the subsystem.
+ * @param[in,out] ncm           Pointer to the message, valid until nss_tx_msg_txn_wait() returns.
+ * @param[in]     resp_offset   Offset in the message payload of the response to copy.
+ * @param[in]     copy_len      Number of response bytes to copy.
+ *
+ * @return
+ * Status of the transmit operation.
+ *
+ * @dependencies
+ * May sleep while max_in_flight messages wait for a response.
+ */
+extern nss_tx_status_t nss_tx_msg_txn_add(struct nss_tx_msg_txn *txn,
+				nss_tx_msg_sync_subsys_async_t tx_msg_async,
+				struct nss_cmn_msg *ncm, uint32_t resp_offset, uint32_t copy_len);
+
+/**
+ * nss_tx_msg_txn_add_with_size
+ *	Sends a message with a given buffer size as part of a transaction.
+ *
+ * @datatypes
+ * nss_tx_msg_txn \n
+ * nss_cmn_msg
+ *
+ * @param[in]     txn                     Pointer to the transaction.
+ * @param[in]     tx_msg_async_with_size  Asynchronous send function of the subsystem.
+ * @param[in]     msg_buf_size            Size of the message buffer.
+ * @param[in,out] ncm                     Pointer to the message, valid until nss_tx_msg_txn_wait() returns.
+ * @param[in]     resp_offset             Offset in the message payload of the response to copy.
+ * @param[in]     copy_len                Number of response bytes to copy.
+ *
+ * @return
+ * Status of the transmit operation.
+ */
+extern nss_tx_status_t nss_tx_msg_txn_add_with_size(struct nss_tx_msg_txn *txn,
+				nss_tx_msg_sync_subsys_async_with_size_t tx_msg_async_with_size,
+				uint32_t msg_buf_size, struct nss_cmn_msg *ncm,
+				uint32_t resp_offset, uint32_t copy_len);
+
+/**
+ * nss_tx_msg_txn_wait
+ *	Waits for the responses of all messages of a transaction.
+ *
+ * @datatypes
+ * nss_tx_msg_txn
+ *
+ * @param[in] txn  Pointer to the transaction.
+ *
+ * @return
+ * NSS_TX_SUCCESS or the status of the first message that failed.
+ */
+extern nss_tx_status_t nss_tx_msg_txn_wait(struct nss_tx_msg_txn *txn);
+
+/**
+ * nss_tx_msg_txn_status
+ *	Gets the status of a message of a transaction.
+ *
+ * @datatypes
+ * nss_tx_msg_txn
+ *
+ * @param[in] txn    Pointer to the transaction.
+ * @param[in] index  Index of the message, in the order it was added.
+ *
+ * @return
+ * Status of the message.
+ */
+extern nss_tx_status_t nss_tx_msg_txn_status(struct nss_tx_msg_txn *txn, uint32_t index);
+
+/**
+ * nss_tx_msg_txn_free
+ *	Releases a transaction.
+ *
+ * Responses still in flight are no longer copied to the messages.
+ *
+ * @datatypes
+ * nss_tx_msg_txn
+ *
+ * @param[in] txn  Pointer to the transaction.
+ *
+ * @return
+ * None.
+ */
+extern void nss_tx_msg_txn_free(struct nss_tx_msg_txn *txn);
+
+/**
+ * @}
+ */
+
+#endif /* __NSS_TX_MSG_TXN_H */
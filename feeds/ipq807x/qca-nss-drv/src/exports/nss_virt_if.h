@@ -327,6 +327,28 @@ extern nss_tx_status_t nss_virt_if_tx_msg(struct nss_ctx_instance *nss_ctx, stru
 extern nss_tx_status_t nss_virt_if_tx_buf(struct nss_virt_if_handle *handle,
 						struct sk_buff *skb);
 
+/**
+ * nss_virt_if_tx_buf_list
+ *	Forwards a burst of virtual interface packets to the NSS.
+ *
+ * The burst is placed in the NSS descriptor ring under a single lock and
+ * signaled to the NSS once.
+ *
+ * @datatypes
+ * nss_virt_if_handle \n
+ * sk_buff_head
+ *
+ * @param[in,out] handle  Pointer to the virtual interface handle (provided during
+ *                        registration).
+ * @param[in,out] list    Pointer to the list of data socket buffers. Buffers that
+ *                        could not be sent are left on the list.
+ *
+ * @return
+ * Status of the Tx operation.
+ */
+extern nss_tx_status_t nss_virt_if_tx_buf_list(struct nss_virt_if_handle *handle,
+						struct sk_buff_head *list);
+
 /**
  * nss_virt_if_xmit_callback_register
  *	Registers a transmit callback to a virtual interface.
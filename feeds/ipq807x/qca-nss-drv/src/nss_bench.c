@@ -0,0 +1,915 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/*
+ * nss_bench.c
+ *	NSS firmware self-test benchmarks
+ *
+ * Runs the DMA, core to core and UDP speed tests of the firmware with
+ * common parameters and returns one sample per repetition through the
+ * nss_bench generic netlink family. Summaries and baseline comparisons
+ * are left to the userspace runner.
+ *
+ * The DMA test reports its own packet count and time. The C2C and UDP
+ * speed tests run for the requested duration and are measured from the
+ * node statistics, which the firmware syncs about once a second, so they
+ * need durations of several seconds to be accurate.
+ *
+ * The copy test times host copies of the payload size on the CPU and
+ * through the DMA copy jobs, either forced onto the CPU or onto the DMA
+ * engine, so the offload can be set against memcpy() across sizes.
+ *
+ * The stats_drv test does not involve the firmware. It measures the cost
+ * of the driver packet counters under contention from all host CPUs, for
+ * the per CPU backend and for the shared atomic64_t it replaced.
+ */
+
+#include <linux/cpu.h>
+#include <net/genetlink.h>
+#include "nss_core.h"
+#include "nss_bench_nl.h"
+#ifdef NSS_DRV_C2C_ENABLE
+#include "nss_c2c_tx_stats.h"
+#endif
+#ifdef NSS_DRV_UDP_ST_ENABLE
+#include "nss_udp_st_stats.h"
+#include "nss_udp_st_nl.h"
+#endif
+
+#define NSS_BENCH_MSG_TIMEOUT 5000	/* 5 sec for the firmware to answer a test message */
+#define NSS_BENCH_STATS_DRV_CHUNK 1024	/* Counter updates between checks of the deadline */
+#define NSS_BENCH_COPY_JOBS 8		/* Copy jobs in flight */
+
+/*
+ * Parameters of a run
+ */
+struct nss_bench_params {
+	uint32_t repeat;		/* Repetitions */
+	uint32_t duration;		/* ms per repetition */
+	uint32_t pkt_size;		/* Payload bytes */
+	uint32_t burst;			/* Packets per loop */
+	uint32_t core;			/* NSS core */
+	uint32_t variant;		/* Test specific mode */
+	uint32_t flags;			/* Test specific flags */
+	uint32_t rate;			/* Mbps */
+	uint32_t src_ip;		/* IPv4 source */
+	uint32_t dest_ip;		/* IPv4 destination */
+	uint16_t src_port;		/* Source port */
+	uint16_t dest_port;		/* Destination port */
+};
+
+/*
+ * Benchmark test
+ */
+struct nss_bench_test {
+	int (*run)(const struct nss_bench_params *p, struct nss_bench_nl_sample *s);
+					/* Runs one repetition */
+	uint32_t variant;		/* Default variant */
+};
+
+/*
+ * Reply to the test message being waited for
+ */
+struct nss_bench_wait {
+	spinlock_t lock;		/* Protects the fields below */
+	struct completion complete;	/* Completed by the reply */
+	unsigned long seq;		/* Identifies the message waited for */
+	enum nss_cmn_response response;	/* Response of the firmware */
+	uint32_t error;			/* Error of the firmware */
+	uint64_t packets;		/* Packets reported with the reply */
+	uint32_t fw_time;		/* Time reported with the reply */
+};
+
+#ifdef NSS_DRV_DMA_ENABLE
+/*
+ * Copy jobs in flight
+ */
+struct nss_bench_copy {
+	struct nss_dma_copy_job jobs[NSS_BENCH_COPY_JOBS];
+	struct nss_dma_copy_seg segs[NSS_BENCH_COPY_JOBS][NSS_DMA_COPY_SEG_MAX];
+	struct completion complete;	/* Completed by the last job */
+	atomic_t pending;		/* Jobs not completed, plus one while submitting */
+	int status;			/* First job failure */
+};
+#endif
+
+static struct nss_bench_wait nss_bench_wait;
+static DEFINE_MUTEX(nss_bench_lock);		/* One run at a time */
+static bool nss_bench_registered;
+static struct genl_family nss_bench_family;
+
+/*
+ * nss_bench_wait_prepare()
+ *	Arm the wait for a new message; the result goes in its app_data.
+ */
+static void *nss_bench_wait_prepare(void)
+{
+	unsigned long seq;
+
+	spin_lock_bh(&nss_bench_wait.lock);
+	seq = ++nss_bench_wait.seq;
+	reinit_completion(&nss_bench_wait.complete);
+	nss_bench_wait.response = NSS_CMN_RESPONSE_EMSG;
+	nss_bench_wait.error = 0;
+	nss_bench_wait.packets = 0;
+	nss_bench_wait.fw_time = 0;
+	spin_unlock_bh(&nss_bench_wait.lock);
+
+	return (void *)seq;
+}
+
+/*
+ * nss_bench_wait_reply()
+ *	Record the reply to the message being waited for; late replies are dropped.
+ */
+static void nss_bench_wait_reply(void *app_data, struct nss_cmn_msg *ncm, uint64_t packets, uint32_t fw_time)
+{
+	spin_lock_bh(&nss_bench_wait.lock);
+	if ((unsigned long)app_data != nss_bench_wait.seq) {
+		spin_unlock_bh(&nss_bench_wait.lock);
+		nss_warning("bench: dropping late reply to message %d\n", ncm->type);
+		return;
+	}
+
+	nss_bench_wait.response = ncm->response;
+	nss_bench_wait.error = ncm->error;
+	nss_bench_wait.packets = packets;
+	nss_bench_wait.fw_time = fw_time;
+	complete(&nss_bench_wait.complete);
+	spin_unlock_bh(&nss_bench_wait.lock);
+}
+
+/*
+ * nss_bench_wait_done()
+ *	Wait for the reply to the last prepared message.
+ */
+static int nss_bench_wait_done(void)
+{
+	long ret;
+
+	ret = wait_for_completion_interruptible_timeout(&nss_bench_wait.complete,
+			msecs_to_jiffies(NSS_BENCH_MSG_TIMEOUT));
+
+	/*
+	 * Whatever happened, a reply from now on is late.
+	 */
+	spin_lock_bh(&nss_bench_wait.lock);
+	nss_bench_wait.seq++;
+	spin_unlock_bh(&nss_bench_wait.lock);
+
+	if (ret < 0) {
+		return -EINTR;
+	}
+
+	if (!ret) {
+		nss_warning("bench: test message not answered\n");
+		return -ETIMEDOUT;
+	}
+
+	if (nss_bench_wait.response != NSS_CMN_RESPONSE_ACK) {
+		nss_warning("bench: test message failed, error %d\n", nss_bench_wait.error);
+		return -EIO;
+	}
+
+	return 0;
+}
+
+/*
+ * nss_bench_sleep()
+ *	Let a timed test run.
+ */
+static int nss_bench_sleep(uint32_t duration)
+{
+	return msleep_interruptible(duration) ? -EINTR : 0;
+}
+
+#ifdef NSS_DRV_DMA_ENABLE
+/*
+ * nss_bench_dma_callback()
+ */
+static void nss_bench_dma_callback(void *app_data, struct nss_cmn_msg *ncm)
+{
+	struct nss_dma_test_cfg *ndtc = &((struct nss_dma_msg *)ncm)->msg.test_cfg;
+
+	nss_bench_wait_reply(app_data, ncm, ndtc->node_stats.rx_packets, ndtc->time_delta);
+}
+
+/*
+ * nss_bench_dma_run()
+ *	Run the DMA performance test once.
+ */
+static int nss_bench_dma_run(const struct nss_bench_params *p, struct nss_bench_nl_sample *s)
+{
+	struct nss_ctx_instance *nss_ctx = nss_dma_get_context();
+	struct nss_dma_msg ndm;
+	ktime_t start;
+	void *seq;
+	int ret;
+
+	if ((p->variant >= NSS_DMA_TEST_TYPE_MAX) || !p->burst || (p->burst > U16_MAX)) {
+		return -EINVAL;
+	}
+
+	/*
+	 * Same message as the dev.nss.dma.test_run sysctl, linearized unless asked otherwise.
+	 */
+	seq = nss_bench_wait_prepare();
+	nss_dma_msg_init(&ndm, NSS_DMA_INTERFACE, NSS_DMA_MSG_TYPE_TEST_PERF,
+			sizeof(struct nss_cmn_msg) + sizeof(struct nss_dma_test_cfg), nss_bench_dma_callback, seq);
+	ndm.msg.test_cfg.packet_count = p->burst;
+	ndm.msg.test_cfg.type = p->variant;
+	ndm.msg.test_cfg.flags = p->flags ? p->flags : NSS_DMA_TEST_FLAGS_LINEARIZE;
+
+	start = ktime_get();
+	if (nss_dma_tx_msg(nss_ctx, &ndm) != NSS_TX_SUCCESS) {
+		return -EBUSY;
+	}
+
+	ret = nss_bench_wait_done();
+	s->elapsed_ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+	if (ret) {
+		return ret;
+	}
+
+	s->packets = nss_bench_wait.packets;
+	s->fw_time = nss_bench_wait.fw_time;
+	return 0;
+}
+
+/*
+ * nss_bench_copy_callback()
+ */
+static void nss_bench_copy_callback(void *app_data, int status)
+{
+	struct nss_bench_copy *nbc = (struct nss_bench_copy *)app_data;
+
+	if (status) {
+		cmpxchg(&nbc->status, 0, status);
+	}
+
+	if (atomic_dec_and_test(&nbc->pending)) {
+		complete(&nbc->complete);
+	}
+}
+
+/*
+ * nss_bench_copy_jobs()
+ *	Copy count times through copy jobs, a window of jobs at a time.
+ *
+ * Every segment targets the same buffer; segments running in parallel race
+ * on it, which is harmless as they all write the same bytes.
+ */
+static int nss_bench_copy_jobs(struct nss_bench_copy *nbc, void *dst, const void *src, uint32_t len, uint32_t count,
+				uint32_t flags)
+{
+	uint16_t num_segs, i, j;
+	int ret = 0;
+
+	nbc->status = 0;
+	while (count && !ret && !nbc->status) {
+		reinit_completion(&nbc->complete);
+		atomic_set(&nbc->pending, 1);
+
+		for (i = 0; (i < NSS_BENCH_COPY_JOBS) && count; i++) {
+			num_segs = min_t(uint32_t, count, NSS_DMA_COPY_SEG_MAX);
+			for (j = 0; j < num_segs; j++) {
+				nbc->segs[i][j].dst = dst;
+				nbc->segs[i][j].src = src;
+				nbc->segs[i][j].len = len;
+			}
+
+			nss_dma_copy_job_init(&nbc->jobs[i], nbc->segs[i], num_segs, flags, nss_bench_copy_callback, nbc);
+			atomic_inc(&nbc->pending);
+			ret = nss_dma_copy_submit(&nbc->jobs[i]);
+			if (ret) {
+				atomic_dec(&nbc->pending);
+				break;
+			}
+
+			count -= num_segs;
+		}
+
+		/*
+		 * The jobs use the buffers, wait for all of them whatever happened.
+		 */
+		if (!atomic_dec_and_test(&nbc->pending)) {
+			wait_for_completion(&nbc->complete);
+		}
+	}
+
+	return ret ? ret : nbc->status;
+}
+
+/*
+ * nss_bench_copy_run()
+ *	Copy the payload size burst times on the requested path.
+ */
+static int nss_bench_copy_run(const struct nss_bench_params *p, struct nss_bench_nl_sample *s)
+{
+	struct nss_bench_copy *nbc = NULL;
+	void *src, *dst;
+	ktime_t start;
+	uint32_t i;
+	int ret = -ENOMEM;
+
+	if ((p->variant >= NSS_BENCH_NL_COPY_MAX) || !p->pkt_size || (p->pkt_size > NSS_BENCH_NL_COPY_SIZE_MAX)
+		|| !p->burst || (p->burst > U16_MAX)) {
+		return -EINVAL;
+	}
+
+	if ((p->variant == NSS_BENCH_NL_COPY_JOB_DMA) && !nss_dma_copy_has_offload()) {
+		return -EOPNOTSUPP;
+	}
+
+	/*
+	 * The DMA engine only takes memory of the linear map.
+	 */
+	src = kmalloc(p->pkt_size, GFP_KERNEL);
+	dst = kmalloc(p->pkt_size, GFP_KERNEL);
+	if (!src || !dst) {
+		goto free;
+	}
+
+	if (p->variant != NSS_BENCH_NL_COPY_CPU) {
+		nbc = kzalloc(sizeof(*nbc), GFP_KERNEL);
+		if (!nbc) {
+			goto free;
+		}
+
+		init_completion(&nbc->complete);
+	}
+
+	memset(src, 0xa5, p->pkt_size);
+	ret = 0;
+	start = ktime_get();
+
+	switch (p->variant) {
+	case NSS_BENCH_NL_COPY_JOB_CPU:
+		ret = nss_bench_copy_jobs(nbc, dst, src, p->pkt_size, p->burst, NSS_DMA_COPY_FLAG_CPU);
+		break;
+
+	case NSS_BENCH_NL_COPY_JOB_DMA:
+		ret = nss_bench_copy_jobs(nbc, dst, src, p->pkt_size, p->burst, NSS_DMA_COPY_FLAG_OFFLOAD);
+		break;
+
+	default:
+		for (i = 0; i < p->burst; i++) {
+			memcpy(dst, src, p->pkt_size);
+			if (!((i + 1) % NSS_DMA_COPY_SEG_MAX)) {
+				cond_resched();
+			}
+		}
+	}
+
+	s->elapsed_ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+	if (!ret && memcmp(dst, src, p->pkt_size)) {
+		ret = -EIO;
+	}
+
+	if (!ret) {
+		s->packets = p->burst;
+		s->bytes = (uint64_t)p->burst * p->pkt_size;
+	}
+
+free:
+	kfree(nbc);
+	kfree(dst);
+	kfree(src);
+	return ret;
+}
+#endif
+
+#ifdef NSS_DRV_C2C_ENABLE
+/*
+ * nss_bench_c2c_callback()
+ */
+static void nss_bench_c2c_callback(void *app_data, struct nss_c2c_tx_msg *nctm)
+{
+	nss_bench_wait_reply(app_data, &nctm->cm, 0, 0);
+}
+
+/*
+ * nss_bench_c2c_run()
+ *	Run the core to core transmit test for the duration.
+ */
+static int nss_bench_c2c_run(const struct nss_bench_params *p, struct nss_bench_nl_sample *s)
+{
+	uint64_t before[NSS_C2C_TX_STATS_MAX], after[NSS_C2C_TX_STATS_MAX];
+	struct nss_ctx_instance *nss_ctx;
+	struct nss_c2c_tx_msg nctm;
+	ktime_t start;
+	void *seq;
+	int ret;
+
+	if ((p->core >= nss_top_main.num_nss) || (p->variant < NSS_C2C_TX_TEST_TYPE_SIMPLE)
+		|| (p->variant >= NSS_C2C_TX_TEST_TYPE_MAX)) {
+		return -EINVAL;
+	}
+
+	nss_ctx = &nss_top_main.nss[p->core];
+	seq = nss_bench_wait_prepare();
+	nss_c2c_tx_msg_init(&nctm, NSS_C2C_TX_INTERFACE, NSS_C2C_TX_MSG_TYPE_PERFORMANCE_TEST,
+			sizeof(struct nss_c2c_tx_test), nss_bench_c2c_callback, seq);
+	nctm.msg.test.test_id = p->variant;
+
+	if (nss_c2c_tx_tx_msg(nss_ctx, &nctm) != NSS_TX_SUCCESS) {
+		return -EBUSY;
+	}
+
+	ret = nss_bench_wait_done();
+	if (ret) {
+		return ret;
+	}
+
+	nss_c2c_tx_stats_get(p->core, before);
+	start = ktime_get();
+	ret = nss_bench_sleep(p->duration);
+	nss_c2c_tx_stats_get(p->core, after);
+	s->elapsed_ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+	s->packets = after[NSS_STATS_NODE_TX_PKTS] - before[NSS_STATS_NODE_TX_PKTS];
+	s->bytes = after[NSS_STATS_NODE_TX_BYTES] - before[NSS_STATS_NODE_TX_BYTES];
+	return ret;
+}
+#endif
+
+#ifdef NSS_DRV_UDP_ST_ENABLE
+/*
+ * nss_bench_udp_st_msg()
+ *	Send a udp_st message and wait for its reply.
+ */
+static int nss_bench_udp_st_msg(struct nss_udp_st_msg *num)
+{
+	return nss_udp_st_tx_sync(nss_udp_st_get_mgr(), num) == NSS_TX_SUCCESS ? 0 : -EIO;
+}
+
+/*
+ * nss_bench_udp_st_rule()
+ *	Configure or unconfigure the rule of the test.
+ */
+static int nss_bench_udp_st_rule(const struct nss_bench_params *p, uint32_t type)
+{
+	struct nss_udp_st_msg num;
+
+	memset(&num, 0, sizeof(num));
+	nss_udp_st_msg_init(&num, NSS_UDP_ST_INTERFACE, type, sizeof(struct nss_udp_st_cfg), NULL, NULL);
+	num.msg.cfg.src_ip.ip.ipv4 = p->src_ip;
+	num.msg.cfg.dest_ip.ip.ipv4 = p->dest_ip;
+	num.msg.cfg.src_port = p->src_port;
+	num.msg.cfg.dest_port = p->dest_port;
+	num.msg.cfg.type = NSS_UDP_ST_TEST_TX;
+	num.msg.cfg.ip_version = NSS_UDP_ST_FLAG_IPV4;
+	return nss_bench_udp_st_msg(&num);
+}
+
+/*
+ * nss_bench_udp_st_type()
+ *	Send a message carrying only a test type or flag.
+ */
+static int nss_bench_udp_st_type(uint32_t type)
+{
+	struct nss_udp_st_msg num;
+
+	memset(&num, 0, sizeof(num));
+	nss_udp_st_msg_init(&num, NSS_UDP_ST_INTERFACE, type, sizeof(uint32_t), NULL, NULL);
+	num.msg.start.type = NSS_UDP_ST_TEST_TX;
+	return nss_bench_udp_st_msg(&num);
+}
+
+/*
+ * nss_bench_udp_st_run()
+ *	Transmit one flow at the requested rate for the duration.
+ */
+static int nss_bench_udp_st_run(const struct nss_bench_params *p, struct nss_bench_nl_sample *s)
+{
+	struct nss_udp_st_nl_stats before, after;
+	struct nss_udp_st_msg num;
+	ktime_t start;
+	int ret;
+
+	if (!p->rate || !p->pkt_size || !p->dest_ip) {
+		return -EINVAL;
+	}
+
+	memset(&num, 0, sizeof(num));
+	nss_udp_st_msg_init(&num, NSS_UDP_ST_INTERFACE, NSS_UDP_ST_TX_CREATE_MSG,
+			sizeof(struct nss_udp_st_tx_create), NULL, NULL);
+	num.msg.create.rate = p->rate;
+	num.msg.create.buffer_size = p->pkt_size;
+	ret = nss_bench_udp_st_msg(&num);
+	if (ret) {
+		return ret;
+	}
+
+	ret = nss_bench_udp_st_rule(p, NSS_UDP_ST_CFG_RULE_MSG);
+	if (ret) {
+		goto destroy;
+	}
+
+	ret = nss_bench_udp_st_type(NSS_UDP_ST_START_MSG);
+	if (ret) {
+		goto uncfg;
+	}
+
+	nss_udp_st_stats_get(&before);
+	start = ktime_get();
+	ret = nss_bench_sleep(p->duration);
+	nss_udp_st_stats_get(&after);
+	s->elapsed_ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+	s->packets = after.tx_packets - before.tx_packets;
+	s->bytes = after.tx_bytes - before.tx_bytes;
+	s->fw_time = after.time[NSS_UDP_ST_TEST_TX][NSS_UDP_ST_STATS_TIME_ELAPSED];
+
+	if (nss_bench_udp_st_type(NSS_UDP_ST_STOP_MSG) && !ret) {
+		ret = -EIO;
+	}
+
+uncfg:
+	nss_bench_udp_st_rule(p, NSS_UDP_ST_UNCFG_RULE_MSG);
+
+destroy:
+	nss_bench_udp_st_type(NSS_UDP_ST_TX_DESTROY_MSG);
+	return ret;
+}
+#endif
+
+#if (NSS_PKT_STATS_ENABLED == 1)
+/*
+ * Per CPU worker of the stats_drv test
+ */
+struct nss_bench_stats_drv_work {
+	struct work_struct work;
+	uint32_t variant;		/* enum nss_bench_nl_stats_drv */
+	uint64_t __percpu *percpu;	/* Counter of the per CPU backend */
+	ktime_t deadline;		/* Stop updating at this time */
+	uint64_t updates;		/* Counter updates made */
+};
+
+/*
+ * Counter of the atomic backend, alone in its cache line like a stats_drv entry used to be
+ */
+static atomic64_t nss_bench_stats_drv_atomic ____cacheline_aligned_in_smp;
+
+/*
+ * nss_bench_stats_drv_work()
+ *	Update the counter until the deadline.
+ */
+static void nss_bench_stats_drv_work(struct work_struct *work)
+{
+	struct nss_bench_stats_drv_work *w = container_of(work, struct nss_bench_stats_drv_work, work);
+	uint64_t updates = 0;
+	int i;
+
+	do {
+		if (w->variant == NSS_BENCH_NL_STATS_DRV_ATOMIC) {
+			for (i = 0; i < NSS_BENCH_STATS_DRV_CHUNK; i++) {
+				atomic64_inc(&nss_bench_stats_drv_atomic);
+			}
+		} else {
+			for (i = 0; i < NSS_BENCH_STATS_DRV_CHUNK; i++) {
+				nss_pkt_stats_inc(w->percpu);
+			}
+		}
+
+		updates += NSS_BENCH_STATS_DRV_CHUNK;
+		cond_resched();
+	} while (ktime_before(ktime_get(), w->deadline));
+
+	w->updates = updates;
+}
+
+/*
+ * nss_bench_stats_drv_run()
+ *	Update a driver packet counter from every online CPU for the duration.
+ */
+static int nss_bench_stats_drv_run(const struct nss_bench_params *p, struct nss_bench_nl_sample *s)
+{
+	struct nss_bench_stats_drv_work *works;
+	uint64_t __percpu *percpu;
+	ktime_t start, deadline;
+	uint64_t sum;
+	int cpu;
+	int ret = 0;
+
+	if ((p->variant >= NSS_BENCH_NL_STATS_DRV_MAX) || !p->duration) {
+		return -EINVAL;
+	}
+
+	works = kcalloc(nr_cpu_ids, sizeof(*works), GFP_KERNEL);
+	if (!works) {
+		return -ENOMEM;
+	}
+
+	percpu = alloc_percpu(uint64_t);
+	if (!percpu) {
+		kfree(works);
+		return -ENOMEM;
+	}
+
+	atomic64_set(&nss_bench_stats_drv_atomic, 0);
+
+	get_online_cpus();
+	start = ktime_get();
+	deadline = ktime_add_ms(start, p->duration);
+	for_each_online_cpu(cpu) {
+		INIT_WORK(&works[cpu].work, nss_bench_stats_drv_work);
+		works[cpu].variant = p->variant;
+		works[cpu].percpu = percpu;
+		works[cpu].deadline = deadline;
+		queue_work_on(cpu, system_highpri_wq, &works[cpu].work);
+	}
+
+	for_each_online_cpu(cpu) {
+		flush_work(&works[cpu].work);
+		s->packets += works[cpu].updates;
+	}
+
+	s->elapsed_ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+	put_online_cpus();
+
+	/*
+	 * Folding the counter must account for every update
+	 */
+	if (p->variant == NSS_BENCH_NL_STATS_DRV_ATOMIC) {
+		sum = atomic64_read(&nss_bench_stats_drv_atomic);
+	} else {
+		sum = nss_pkt_stats_read(percpu);
+	}
+
+	if (sum != s->packets) {
+		nss_warning("bench: stats_drv counter %llu, %llu updates made\n", sum, s->packets);
+		ret = -EIO;
+	}
+
+	free_percpu(percpu);
+	kfree(works);
+	return ret;
+}
+#endif
+
+/*
+ * nss_bench_tests
+ *	Tests built in, indexed by enum nss_bench_nl_test.
+ */
+static const struct nss_bench_test nss_bench_tests[NSS_BENCH_NL_TEST_MAX] = {
+#ifdef NSS_DRV_DMA_ENABLE
+	[NSS_BENCH_NL_TEST_DMA] = { .run = nss_bench_dma_run, .variant = NSS_DMA_TEST_TYPE_DEFAULT },
+	[NSS_BENCH_NL_TEST_COPY] = { .run = nss_bench_copy_run, .variant = NSS_BENCH_NL_COPY_CPU },
+#endif
+#ifdef NSS_DRV_C2C_ENABLE
+	[NSS_BENCH_NL_TEST_C2C] = { .run = nss_bench_c2c_run, .variant = NSS_C2C_TX_TEST_TYPE_SIMPLE },
+#endif
+#ifdef NSS_DRV_UDP_ST_ENABLE
+	[NSS_BENCH_NL_TEST_UDP_ST] = { .run = nss_bench_udp_st_run },
+#endif
+#if (NSS_PKT_STATS_ENABLED == 1)
+	[NSS_BENCH_NL_TEST_STATS_DRV] = { .run = nss_bench_stats_drv_run, .variant = NSS_BENCH_NL_STATS_DRV_PERCPU },
+#endif
+};
+
+/*
+ * nss_bench_policy
+ */
+static const struct nla_policy nss_bench_policy[NSS_BENCH_NL_ATTR_MAX + 1] = {
+	[NSS_BENCH_NL_ATTR_TEST] = { .type = NLA_U32 },
+	[NSS_BENCH_NL_ATTR_REPEAT] = { .type = NLA_U32 },
+	[NSS_BENCH_NL_ATTR_DURATION] = { .type = NLA_U32 },
+	[NSS_BENCH_NL_ATTR_PKT_SIZE] = { .type = NLA_U32 },
+	[NSS_BENCH_NL_ATTR_BURST] = { .type = NLA_U32 },
+	[NSS_BENCH_NL_ATTR_CORE] = { .type = NLA_U32 },
+	[NSS_BENCH_NL_ATTR_VARIANT] = { .type = NLA_U32 },
+	[NSS_BENCH_NL_ATTR_FLAGS] = { .type = NLA_U32 },
+	[NSS_BENCH_NL_ATTR_RATE] = { .type = NLA_U32 },
+	[NSS_BENCH_NL_ATTR_SRC_IP] = { .type = NLA_U32 },
+	[NSS_BENCH_NL_ATTR_DEST_IP] = { .type = NLA_U32 },
+	[NSS_BENCH_NL_ATTR_SRC_PORT] = { .type = NLA_U16 },
+	[NSS_BENCH_NL_ATTR_DEST_PORT] = { .type = NLA_U16 },
+	[NSS_BENCH_NL_ATTR_SAMPLES] = { .type = NLA_BINARY,
+				.len = NSS_BENCH_NL_REPEAT_MAX * sizeof(struct nss_bench_nl_sample) },
+};
+
+/*
+ * nss_bench_get_u32()
+ *	Value of an optional u32 attribute.
+ */
+static uint32_t nss_bench_get_u32(struct genl_info *info, int attr, uint32_t def)
+{
+	return info->attrs[attr] ? nla_get_u32(info->attrs[attr]) : def;
+}
+
+/*
+ * nss_bench_run()
+ *	Run a test the requested number of times and reply with the samples.
+ */
+static int nss_bench_run(struct sk_buff *skb, struct genl_info *info)
+{
+	const struct nss_bench_test *test;
+	struct nss_bench_nl_sample *samples;
+	struct nss_bench_params p;
+	struct sk_buff *reply;
+	uint32_t id, i;
+	void *hdr;
+	int ret;
+
+	id = nss_bench_get_u32(info, NSS_BENCH_NL_ATTR_TEST, NSS_BENCH_NL_TEST_MAX);
+	if ((id >= NSS_BENCH_NL_TEST_MAX) || !nss_bench_tests[id].run) {
+		NSS_GENL_SET_ERR_MSG(info, "test not built in this driver");
+		return -EOPNOTSUPP;
+	}
+
+	test = &nss_bench_tests[id];
+	memset(&p, 0, sizeof(p));
+	p.repeat = nss_bench_get_u32(info, NSS_BENCH_NL_ATTR_REPEAT, 1);
+	p.duration = nss_bench_get_u32(info, NSS_BENCH_NL_ATTR_DURATION, 1000);
+	p.pkt_size = nss_bench_get_u32(info, NSS_BENCH_NL_ATTR_PKT_SIZE, 1400);
+	p.burst = nss_bench_get_u32(info, NSS_BENCH_NL_ATTR_BURST, 1);
+	p.core = nss_bench_get_u32(info, NSS_BENCH_NL_ATTR_CORE, 0);
+	p.variant = nss_bench_get_u32(info, NSS_BENCH_NL_ATTR_VARIANT, test->variant);
+	p.flags = nss_bench_get_u32(info, NSS_BENCH_NL_ATTR_FLAGS, 0);
+	p.rate = nss_bench_get_u32(info, NSS_BENCH_NL_ATTR_RATE, 0);
+	p.src_ip = nss_bench_get_u32(info, NSS_BENCH_NL_ATTR_SRC_IP, 0);
+	p.dest_ip = nss_bench_get_u32(info, NSS_BENCH_NL_ATTR_DEST_IP, 0);
+	if (info->attrs[NSS_BENCH_NL_ATTR_SRC_PORT]) {
+		p.src_port = nla_get_u16(info->attrs[NSS_BENCH_NL_ATTR_SRC_PORT]);
+	}
+	if (info->attrs[NSS_BENCH_NL_ATTR_DEST_PORT]) {
+		p.dest_port = nla_get_u16(info->attrs[NSS_BENCH_NL_ATTR_DEST_PORT]);
+	}
+
+	if (!p.repeat || (p.repeat > NSS_BENCH_NL_REPEAT_MAX) || (p.duration > NSS_BENCH_NL_DURATION_MAX)) {
+		NSS_GENL_SET_ERR_MSG(info, "repeat or duration out of range");
+		return -EINVAL;
+	}
+
+	samples = kcalloc(p.repeat, sizeof(*samples), GFP_KERNEL);
+	if (!samples) {
+		return -ENOMEM;
+	}
+
+	if (mutex_lock_interruptible(&nss_bench_lock)) {
+		kfree(samples);
+		return -EINTR;
+	}
+
+	/*
+	 * A bad parameter fails every repetition the same way, stop at the
+	 * first one; other failures are reported per sample.
+	 */
+	for (i = 0; i < p.repeat; i++) {
+		samples[i].status = test->run(&p, &samples[i]);
+		if ((samples[i].status == -EINVAL) || (samples[i].status == -EINTR)) {
+			ret = samples[i].status;
+			mutex_unlock(&nss_bench_lock);
+			kfree(samples);
+			NSS_GENL_SET_ERR_MSG(info, "test parameters rejected or run interrupted");
+			return ret;
+		}
+	}
+
+	mutex_unlock(&nss_bench_lock);
+
+	ret = -ENOMEM;
+	reply = genlmsg_new(nla_total_size(sizeof(uint32_t)) + nla_total_size(p.repeat * sizeof(*samples)),
+			GFP_KERNEL);
+	if (!reply) {
+		goto free;
+	}
+
+	ret = -EMSGSIZE;
+	hdr = genlmsg_put_reply(reply, info, &nss_bench_family, 0, info->genlhdr->cmd);
+	if (!hdr
+		|| nla_put_u32(reply, NSS_BENCH_NL_ATTR_TEST, id)
+		|| nla_put(reply, NSS_BENCH_NL_ATTR_SAMPLES, p.repeat * sizeof(*samples), samples)) {
+		nlmsg_free(reply);
+		goto free;
+	}
+
+	genlmsg_end(reply, hdr);
+	ret = genlmsg_reply(reply, info);
+
+free:
+	kfree(samples);
+	return ret;
+}
+
+/*
+ * nss_bench_list()
+ *	Reply with the tests built in.
+ */
+static int nss_bench_list(struct sk_buff *skb, struct genl_info *info)
+{
+	struct sk_buff *reply;
+	void *hdr;
+	uint32_t i;
+
+	reply = genlmsg_new(NSS_BENCH_NL_TEST_MAX * nla_total_size(sizeof(uint32_t)), GFP_KERNEL);
+	if (!reply) {
+		return -ENOMEM;
+	}
+
+	hdr = genlmsg_put_reply(reply, info, &nss_bench_family, 0, info->genlhdr->cmd);
+	if (!hdr) {
+		nlmsg_free(reply);
+		return -EMSGSIZE;
+	}
+
+	for (i = 0; i < NSS_BENCH_NL_TEST_MAX; i++) {
+		if (nss_bench_tests[i].run && nla_put_u32(reply, NSS_BENCH_NL_ATTR_TEST, i)) {
+			nlmsg_free(reply);
+			return -EMSGSIZE;
+		}
+	}
+
+	genlmsg_end(reply, hdr);
+	return genlmsg_reply(reply, info);
+}
+
+/*
+ * nss_bench_ops
+ */
+static const struct genl_ops nss_bench_ops[] = {
+	{
+		.cmd = NSS_BENCH_NL_CMD_LIST,
+		.doit = nss_bench_list,
+		NSS_GENL_OP_POLICY(nss_bench_policy)
+	},
+	{
+		.cmd = NSS_BENCH_NL_CMD_RUN,
+		.doit = nss_bench_run,
+		NSS_GENL_OP_POLICY(nss_bench_policy)
+		.flags = GENL_ADMIN_PERM,
+	},
+};
+
+/*
+ * nss_bench_family
+ *	Runs take seconds, so they must not hold the genetlink mutex.
+ */
+static struct genl_family nss_bench_family = {
+	.name = NSS_BENCH_NL_FAMILY,
+	.version = NSS_BENCH_NL_VERSION,
+	.maxattr = NSS_BENCH_NL_ATTR_MAX,
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(5, 2, 0))
+	.policy = nss_bench_policy,
+#endif
+	.parallel_ops = true,
+	.module = THIS_MODULE,
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(4, 10, 0))
+	.ops = nss_bench_ops,
+	.n_ops = ARRAY_SIZE(nss_bench_ops),
+#endif
+};
+
+/*
+ * nss_bench_init()
+ *	Register the benchmark generic netlink family.
+ */
+void nss_bench_init(void)
+{
+	int ret;
+
+	spin_lock_init(&nss_bench_wait.lock);
+	init_completion(&nss_bench_wait.complete);
+
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(4, 10, 0))
+	ret = genl_register_family_with_ops(&nss_bench_family, nss_bench_ops);
+#else
+	ret = genl_register_family(&nss_bench_family);
+#endif
+	if (ret) {
+		nss_warning("bench netlink family registration failed: %d\n", ret);
+		return;
+	}
+
+	nss_bench_registered = true;
+}
+
+/*
+ * nss_bench_exit()
+ *	Unregister the benchmark generic netlink family.
+ */
+void nss_bench_exit(void)
+{
+	if (!nss_bench_registered) {
+		return;
+	}
+
+	genl_unregister_family(&nss_bench_family);
+	nss_bench_registered = false;
+}
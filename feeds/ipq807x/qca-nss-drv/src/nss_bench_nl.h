@@ -0,0 +1,127 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/*
+ * nss_bench_nl.h
+ *	Generic netlink interface of the firmware self-test benchmarks.
+ *
+ * NSS_BENCH_NL_CMD_RUN runs one test NSS_BENCH_NL_ATTR_REPEAT times with the
+ * common parameters and replies with one struct nss_bench_nl_sample per
+ * repetition. Parameters a test has no use for are ignored.
+ *
+ * NSS_BENCH_NL_TEST_STATS_DRV runs on the host alone: every online CPU
+ * updates one driver packet counter for DURATION ms, and packets is the
+ * number of updates made by all CPUs together.
+ *
+ * The header is shared with the host tools, so it can also be built
+ * outside the kernel.
+ */
+
+#ifndef __NSS_BENCH_NL_H
+#define __NSS_BENCH_NL_H
+
+#ifdef __KERNEL__
+#include <linux/types.h>
+#else
+#include <stdint.h>
+#endif
+
+#define NSS_BENCH_NL_FAMILY		"nss_bench"
+#define NSS_BENCH_NL_VERSION		1
+
+#define NSS_BENCH_NL_REPEAT_MAX		100	/* Repetitions of one run */
+#define NSS_BENCH_NL_DURATION_MAX	60000	/* ms, one repetition */
+#define NSS_BENCH_NL_COPY_SIZE_MAX	(256 * 1024)	/* Bytes, one copy */
+
+/*
+ * Tests
+ */
+enum nss_bench_nl_test {
+	NSS_BENCH_NL_TEST_DMA,		/* DMA performance test, VARIANT is the test type */
+	NSS_BENCH_NL_TEST_C2C,		/* Core to core transmit test, VARIANT is the test ID */
+	NSS_BENCH_NL_TEST_UDP_ST,	/* UDP speed test transmit towards DEST_IP */
+	NSS_BENCH_NL_TEST_STATS_DRV,	/* Driver packet counter updates, VARIANT is the backend */
+	NSS_BENCH_NL_TEST_COPY,		/* BURST copies of PKT_SIZE bytes, VARIANT is the copy path */
+	NSS_BENCH_NL_TEST_MAX
+};
+
+/*
+ * Copy paths of NSS_BENCH_NL_TEST_COPY
+ */
+enum nss_bench_nl_copy {
+	NSS_BENCH_NL_COPY_CPU,		/* memcpy() in the benchmark */
+	NSS_BENCH_NL_COPY_JOB_CPU,	/* Copy jobs forced onto the CPU fallback */
+	NSS_BENCH_NL_COPY_JOB_DMA,	/* Copy jobs forced onto the DMA engine */
+	NSS_BENCH_NL_COPY_MAX
+};
+
+/*
+ * Counter backends of NSS_BENCH_NL_TEST_STATS_DRV
+ */
+enum nss_bench_nl_stats_drv {
+	NSS_BENCH_NL_STATS_DRV_PERCPU,	/* Per CPU counters, as NSS_PKT_STATS_INC() */
+	NSS_BENCH_NL_STATS_DRV_ATOMIC,	/* One shared atomic64_t, the previous backend */
+	NSS_BENCH_NL_STATS_DRV_MAX
+};
+
+/*
+ * Commands
+ */
+enum nss_bench_nl_cmd {
+	NSS_BENCH_NL_CMD_UNSPEC,
+	NSS_BENCH_NL_CMD_LIST,		/* Replies one TEST per test built in */
+	NSS_BENCH_NL_CMD_RUN,		/* Replies TEST and SAMPLES */
+	NSS_BENCH_NL_CMD_MAX
+};
+
+/*
+ * Attributes
+ */
+enum nss_bench_nl_attr {
+	NSS_BENCH_NL_ATTR_UNSPEC,
+	NSS_BENCH_NL_ATTR_TEST,		/* u32, enum nss_bench_nl_test */
+	NSS_BENCH_NL_ATTR_REPEAT,	/* u32, repetitions, default 1 */
+	NSS_BENCH_NL_ATTR_DURATION,	/* u32, ms per repetition for timed tests */
+	NSS_BENCH_NL_ATTR_PKT_SIZE,	/* u32, payload bytes */
+	NSS_BENCH_NL_ATTR_BURST,	/* u32, packets per loop */
+	NSS_BENCH_NL_ATTR_CORE,		/* u32, NSS core running the test */
+	NSS_BENCH_NL_ATTR_VARIANT,	/* u32, test specific mode */
+	NSS_BENCH_NL_ATTR_FLAGS,	/* u32, test specific flags */
+	NSS_BENCH_NL_ATTR_RATE,		/* u32, Mbps for rate driven tests */
+	NSS_BENCH_NL_ATTR_SRC_IP,	/* u32, IPv4 in host byte order */
+	NSS_BENCH_NL_ATTR_DEST_IP,	/* u32, IPv4 in host byte order */
+	NSS_BENCH_NL_ATTR_SRC_PORT,	/* u16 */
+	NSS_BENCH_NL_ATTR_DEST_PORT,	/* u16 */
+	NSS_BENCH_NL_ATTR_SAMPLES,	/* Array of struct nss_bench_nl_sample */
+	NSS_BENCH_NL_ATTR_MAX_PLUS_ONE
+};
+
+#define NSS_BENCH_NL_ATTR_MAX (NSS_BENCH_NL_ATTR_MAX_PLUS_ONE - 1)
+
+/*
+ * Result of one repetition
+ */
+struct nss_bench_nl_sample {
+	uint64_t packets;		/* Packets the test moved */
+	uint64_t bytes;			/* Bytes the test moved, 0 if not counted */
+	uint64_t elapsed_ns;		/* Host time the repetition took */
+	uint32_t fw_time;		/* Time reported by the firmware, in its own unit */
+	int32_t status;			/* 0 or the negative errno of a failed repetition */
+};
+
+#endif /* __NSS_BENCH_NL_H */
@@ -132,6 +132,17 @@ void nss_c2c_tx_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss_c2c_tx_s
 	spin_unlock_bh(&nss_c2c_tx_stats_lock);
 }
 
+/*
+ * nss_c2c_tx_stats_get()
+ *	Copy the NSS_C2C_TX_STATS_MAX counters of a core.
+ */
+void nss_c2c_tx_stats_get(uint32_t core, uint64_t *stats)
+{
+	spin_lock_bh(&nss_c2c_tx_stats_lock);
+	memcpy(stats, nss_c2c_tx_stats[core], sizeof(nss_c2c_tx_stats[core]));
+	spin_unlock_bh(&nss_c2c_tx_stats_lock);
+}
+
 /*
  * nss_c2c_tx_stats_notify()
  *	Sends notifications to all the registered modules.
@@ -25,5 +25,6 @@
 extern void nss_c2c_tx_stats_notify(struct nss_ctx_instance *nss_ctx);
 extern void nss_c2c_tx_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss_c2c_tx_stats *nct);
 extern void nss_c2c_tx_stats_dentry_create(void);
+extern void nss_c2c_tx_stats_get(uint32_t core, uint64_t *stats);
 
 #endif /* __NSS_C2C_TX_STATS_H */
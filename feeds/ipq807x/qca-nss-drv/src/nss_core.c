@@ -35,6 +35,14 @@
 #include <linux/etherdevice.h>
 #include "nss_tx_rx_common.h"
 #include "nss_data_plane.h"
+#include "nss_ring.h"
+
+#define NSS_RING_HAL_CTX struct nss_ctx_instance
+#define NSS_RING_HAL_BUF struct sk_buff
+#include "nss_ring_ops.h"
+#ifdef NSS_DRV_QRFS_ENABLE
+#include "nss_qrfs_steer.h"
+#endif
 
 #define NSS_CORE_JUMBO_LINEAR_BUF_SIZE 128
 
@@ -77,10 +85,31 @@ module_param_array(pn_qlimits, short, NULL, 0);
 MODULE_PARM_DESC(pn_qlimits, "Queue limit per queue");
 
 /*
- * Atomic variables to control jumbo_mru & paged_mode
+ * Atomic variables to control jumbo_mru, paged_mode, rx_list & napi_adapt
  */
 static atomic_t jumbo_mru;
 static atomic_t paged_mode;
+static atomic_t rx_list;
+static atomic_t napi_adapt;
+
+/*
+ * Adaptive NAPI levels, lightest first
+ *
+ * Light levels yield the CPU to the other NSS NAPI contexts sooner; the
+ * heaviest one polls a drained queue again a few times, every
+ * NSS_CORE_NAPI_LINGER_NS, so that bursts are absorbed without taking an
+ * interrupt for each of them.
+ */
+static const struct nss_core_napi_level {
+	int16_t weight;			/* Descriptors processed per poll */
+	uint16_t linger;		/* Idle polls before the interrupt is re-enabled */
+} nss_core_napi_levels[] = {
+	{8, 0},
+	{16, 0},
+	{32, 0},
+	{NSS_DATA_COMMAND_BUFFER_PROCESSING_WEIGHT, 0},
+	{NSS_DATA_COMMAND_BUFFER_PROCESSING_WEIGHT, 2},
+};
 
 /*
  * nss_core_update_max_ipv4_conn()
@@ -171,6 +200,135 @@ int nss_core_get_paged_mode(void)
 	return atomic_read(&paged_mode);
 }
 
+/*
+ * nss_core_set_rx_list()
+ *	Enable or disable list based delivery of packets to the stack
+ */
+void nss_core_set_rx_list(int enable)
+{
+	atomic_set(&rx_list, enable);
+}
+
+/*
+ * nss_core_get_rx_list()
+ *	Does an atomic read of rx_list
+ */
+int nss_core_get_rx_list(void)
+{
+	return atomic_read(&rx_list);
+}
+
+/*
+ * nss_core_set_napi_adapt()
+ *	Enable or disable adaptive NAPI weights on the N2H queues
+ */
+void nss_core_set_napi_adapt(int enable)
+{
+	atomic_set(&napi_adapt, enable);
+}
+
+/*
+ * nss_core_get_napi_adapt()
+ *	Does an atomic read of napi_adapt
+ */
+int nss_core_get_napi_adapt(void)
+{
+	return atomic_read(&napi_adapt);
+}
+
+/*
+ * nss_core_napi_level_weight()
+ *	Return the poll weight of an adaptive NAPI level
+ */
+int16_t nss_core_napi_level_weight(uint16_t level)
+{
+	return nss_core_napi_levels[level].weight;
+}
+
+/*
+ * nss_core_napi_level_linger()
+ *	Return the number of idle polls of an adaptive NAPI level
+ */
+uint16_t nss_core_napi_level_linger(uint16_t level)
+{
+	return nss_core_napi_levels[level].linger;
+}
+
+/*
+ * nss_core_n2h_backlog()
+ *	Return the number of descriptors pending on the N2H data queues of a core
+ *
+ * The HLOS indexes are read without the NAPI context that owns them, so the
+ * result is a snapshot meant for heuristics such as frequency scaling.
+ */
+uint32_t nss_core_n2h_backlog(struct nss_ctx_instance *nss_ctx)
+{
+	struct nss_if_mem_map *if_map = nss_ctx->meminfo_ctx.if_map;
+	struct hlos_n2h_desc_ring *n2h_desc_ring;
+	uint32_t backlog = 0;
+	uint32_t nss_index;
+	uint32_t qid;
+
+	if (!if_map) {
+		return 0;
+	}
+
+	for (qid = NSS_IF_N2H_DATA_QUEUE_0; (qid <= NSS_IF_N2H_DATA_QUEUE_3) && (qid < if_map->n2h_rings); qid++) {
+		n2h_desc_ring = &nss_ctx->n2h_desc_ring[qid];
+		if (!n2h_desc_ring->desc_ring.size) {
+			continue;
+		}
+
+		NSS_CORE_DMA_CACHE_MAINT((void *)&if_map->n2h_nss_index[qid], sizeof(uint32_t), DMA_FROM_DEVICE);
+		NSS_CORE_DSB();
+		nss_index = if_map->n2h_nss_index[qid];
+
+		backlog += nss_ring_used(nss_index, READ_ONCE(n2h_desc_ring->hlos_index), n2h_desc_ring->desc_ring.size - 1);
+	}
+
+	return backlog;
+}
+
+/*
+ * nss_core_napi_adapt_sample()
+ *	Account the backlog found on a poll and move to another level at the end of a window.
+ */
+static inline void nss_core_napi_adapt_sample(struct nss_core_napi_adapt *adapt, uint32_t backlog)
+{
+	int32_t weight;
+	int32_t avg;
+
+	if (unlikely(backlog > adapt->backlog_max)) {
+		adapt->backlog_max = backlog;
+	}
+
+	/*
+	 * Moving average with a 1/8 contribution from the latest poll.
+	 */
+	avg = adapt->backlog_avg;
+	avg += ((int32_t)(backlog << NSS_CORE_NAPI_ADAPT_AVG_SHIFT) - avg) >> 3;
+	adapt->backlog_avg = avg;
+
+	if (++adapt->samples < NSS_CORE_NAPI_ADAPT_WINDOW) {
+		return;
+	}
+
+	adapt->samples = 0;
+	weight = nss_core_napi_levels[adapt->level].weight << NSS_CORE_NAPI_ADAPT_AVG_SHIFT;
+
+	/*
+	 * Polls keep finding most of a weight waiting: go heavier. Polls
+	 * find the queue nearly empty: go lighter.
+	 */
+	if ((avg > ((weight * 3) >> 2)) && (adapt->level < ARRAY_SIZE(nss_core_napi_levels) - 1)) {
+		adapt->level++;
+		adapt->level_up++;
+	} else if ((avg < (weight >> 2)) && (adapt->level > 0)) {
+		adapt->level--;
+		adapt->level_down++;
+	}
+}
+
 /*
  * nss_core_register_msg_handler()
  *	Register a msg callback per interface number. One per interface.
@@ -836,6 +994,72 @@ static inline void nss_core_handle_virt_if_pkt(struct nss_ctx_instance *nss_ctx,
 	dev_put(ndev);
 }
 
+/*
+ * nss_core_rx_batch_flush()
+ *	Deliver the packets batched for one net device to the stack.
+ *
+ * Devices with GRO enabled get their packets through the NAPI GRO engine,
+ * which is flushed when the NAPI poll completes. Others are handed over in
+ * one netif_receive_skb_list() call where the kernel supports it.
+ */
+static void nss_core_rx_batch_flush(struct nss_ctx_instance *nss_ctx, struct nss_core_rx_batch *batch,
+					struct napi_struct *napi)
+{
+	struct net_device *ndev = batch->ndev;
+	struct sk_buff *nbuf;
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(4, 19, 0))
+	LIST_HEAD(rx_list);
+#endif
+
+	if (!ndev) {
+		return;
+	}
+
+	NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_RX_LIST]);
+
+	if (ndev->features & NETIF_F_GRO) {
+		while ((nbuf = __skb_dequeue(&batch->list))) {
+			napi_gro_receive(napi, nbuf);
+		}
+	} else {
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(4, 19, 0))
+		while ((nbuf = __skb_dequeue(&batch->list))) {
+			list_add_tail(&nbuf->list, &rx_list);
+		}
+		netif_receive_skb_list(&rx_list);
+#else
+		while ((nbuf = __skb_dequeue(&batch->list))) {
+			netif_receive_skb(nbuf);
+		}
+#endif
+	}
+
+	batch->ndev = NULL;
+	dev_put(ndev);
+}
+
+/*
+ * nss_core_rx_batch_add()
+ *	Queue a packet for list delivery to ndev.
+ */
+static inline void nss_core_rx_batch_add(struct nss_ctx_instance *nss_ctx, struct nss_core_rx_batch *batch,
+					struct napi_struct *napi, struct net_device *ndev, struct sk_buff *nbuf)
+{
+	/*
+	 * Packets are delivered in order per destination, so a change
+	 * of destination closes the current batch.
+	 */
+	if (unlikely(batch->ndev != ndev)) {
+		nss_core_rx_batch_flush(nss_ctx, batch, napi);
+		dev_hold(ndev);
+		batch->ndev = ndev;
+	}
+
+	nbuf->dev = ndev;
+	nbuf->protocol = eth_type_trans(nbuf, ndev);
+	__skb_queue_tail(&batch->list, nbuf);
+}
+
 /*
  * nss_core_handle_buffer_pkt()
  *	Handle data packet received on physical or virtual interface.
@@ -885,6 +1109,15 @@ static inline void nss_core_handle_buffer_pkt(struct nss_ctx_instance *nss_ctx,
 		}
 	}
 
+#ifdef NSS_DRV_QRFS_ENABLE
+	/*
+	 * QRFS rules only apply to traffic received on physical ports.
+	 */
+	if (NSS_IS_IF_TYPE(PHYSICAL, interface_num)) {
+		nss_qrfs_steer_rx(nbuf);
+	}
+#endif
+
 	/*
 	 * Deliver nbuf to the interface through callback if there is one.
 	 */
@@ -915,6 +1148,13 @@ static inline void nss_core_handle_buffer_pkt(struct nss_ctx_instance *nss_ctx,
 	 * Deliver to the stack directly. Ex. there is no rule matched for
 	 * redirect interface.
 	 */
+	if (nss_core_get_rx_list()) {
+		struct int_ctx_instance *int_ctx = container_of(napi, struct int_ctx_instance, napi);
+
+		nss_core_rx_batch_add(nss_ctx, &int_ctx->rx_batch, napi, ndev, nbuf);
+		return;
+	}
+
 	dev_hold(ndev);
 	nbuf->dev = ndev;
 	nbuf->protocol = eth_type_trans(nbuf, ndev);
@@ -1416,176 +1656,455 @@ static inline bool nss_core_handle_linear_skb(struct nss_ctx_instance *nss_ctx,
 	return true;
 }
 
+#if (NSS_SKB_REUSE_SUPPORT == 1)
 /*
- * nss_core_handle_empty_buffers()
- *	Handle empty buffer returns.
- */
-static inline void nss_core_handle_empty_buffers(struct nss_ctx_instance *nss_ctx,
-						 struct nss_if_mem_map *if_map,
-						 struct hlos_n2h_desc_ring *n2h_desc_ring,
-						 struct n2h_descriptor *desc_ring,
-						 struct n2h_descriptor *desc,
-						 uint32_t count, uint32_t hlos_index,
-						 uint16_t mask)
-{
-	while (count) {
-		/*
-		 * Since we only return the primary skb, we have no way to unmap
-		 * properly. Simple skb's are properly mapped but page data skbs
-		 * have the payload mapped (and not the skb->data slab payload).
-		 *
-		 * Warning: On non-Krait HW, we need to unmap fragments.
-		 *
-		 * This only unmaps the first segment either slab payload or
-		 * skb page data. Eventually, we need to unmap all of a frag_list
-		 * or all of page_data however this is not a big concern as of now
-		 * since on Kriats dma_map_single() does not allocate any resource
-		 * and hence dma_unmap_single() is sort off a nop.
-		 *
-		 * No need to invalidate for Tx Completions, so set dma direction = DMA_TO_DEVICE;
-		 * Similarly prefetch is not needed for an empty buffer.
-		 */
-		struct sk_buff *nbuf;
-
-		/*
-		 * Prefetch the next cache line of descriptors.
-		 */
-		if (((hlos_index & 1) == 0) && likely(count > 2)) {
-			struct n2h_descriptor *next_cache_desc = &desc_ring[(hlos_index + 2) & mask];
-			prefetch(next_cache_desc);
-		}
-
-		nbuf = (struct sk_buff *)desc->opaque;
-
-		if (unlikely(nbuf < (struct sk_buff *)PAGE_OFFSET)) {
-			/*
-			 * Invalid opaque pointer
-			 */
-			nss_dump_desc(nss_ctx, desc);
-			NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_RX_BAD_DESCRIPTOR]);
-			goto next;
-		}
-
-		dma_unmap_single(nss_ctx->dev, (desc->buffer + desc->payload_offs), desc->payload_len, DMA_TO_DEVICE);
-		dev_kfree_skb_any(nbuf);
-
-		NSS_PKT_STATS_DEC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_NSS_SKB_COUNT]);
-		NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_RX_EMPTY]);
-
-next:
-		hlos_index = (hlos_index + 1) & (mask);
-		desc = &desc_ring[hlos_index];
-		count--;
-	}
-
-	n2h_desc_ring->hlos_index = hlos_index;
-	if_map->n2h_hlos_index[NSS_IF_N2H_EMPTY_BUFFER_RETURN_QUEUE] = hlos_index;
-
-	NSS_CORE_DMA_CACHE_MAINT((void *)&if_map->n2h_hlos_index[NSS_IF_N2H_EMPTY_BUFFER_RETURN_QUEUE], sizeof(uint32_t), DMA_TO_DEVICE);
-	NSS_CORE_DSB();
-}
-
-/*
- * nss_core_handle_cause_queue()
- *	Handle interrupt cause related to N2H/H2N queues
+ * nss_core_skb_can_reuse
+ *	check if skb can be reuse
  */
-static int32_t nss_core_handle_cause_queue(struct int_ctx_instance *int_ctx, uint16_t cause, int16_t weight)
+static inline bool nss_core_skb_can_reuse(struct nss_ctx_instance *nss_ctx,
+	uint32_t if_num, struct sk_buff *nbuf, int min_skb_size)
 {
-	int16_t count, count_temp;
-	uint16_t size, mask, qid;
-	uint32_t nss_index, hlos_index, start, end;
-	struct sk_buff *nbuf;
-	struct hlos_n2h_desc_ring *n2h_desc_ring;
-	struct n2h_desc_if_instance *desc_if;
-	struct n2h_descriptor *desc_ring;
-	struct n2h_descriptor *desc;
-	struct n2h_descriptor *next_cache_desc;
-	struct nss_ctx_instance *nss_ctx = int_ctx->nss_ctx;
-	struct nss_meminfo_ctx *mem_ctx = &nss_ctx->meminfo_ctx;
-	struct nss_if_mem_map *if_map = mem_ctx->if_map;
-
-	qid = nss_core_cause_to_queue(cause);
-
-	/*
-	 * Make sure qid < num_rings
-	 */
-	nss_assert(qid < if_map->n2h_rings);
-
-	n2h_desc_ring = &nss_ctx->n2h_desc_ring[qid];
-	desc_if = &n2h_desc_ring->desc_ring;
-	desc_ring = desc_if->desc;
-	NSS_CORE_DMA_CACHE_MAINT((void *)&if_map->n2h_nss_index[qid], sizeof(uint32_t), DMA_FROM_DEVICE);
-	NSS_CORE_DSB();
-	nss_index = if_map->n2h_nss_index[qid];
-
-	hlos_index = n2h_desc_ring->hlos_index;
-	size = desc_if->size;
-	mask = size - 1;
-
 	/*
-	 * Check if there is work to be done for this queue
+	 * If we have to call a destructor, we can't re-use the buffer?
 	 */
-	count = ((nss_index - hlos_index) + size) & (mask);
-	if (unlikely(count == 0)) {
-		return 0;
+	if (unlikely(nbuf->destructor != NULL)) {
+		return false;
 	}
 
 	/*
-	 * Restrict ourselves to suggested weight
+	 * Check if skb has more than single user.
 	 */
-	if (count > weight) {
-		count = weight;
+	if (unlikely(skb_shared(nbuf))) {
+		return false;
 	}
 
+#if IS_ENABLED(CONFIG_NF_CONNTRACK)
 	/*
-	 * Invalidate all the descriptors we are going to read
+	 * This check is added to avoid deadlock from nf_conntrack
+	 * when ecm is trying to flush a rule.
 	 */
-	start = hlos_index;
-	end = (hlos_index + count) & mask;
-	if (end > start) {
-		dmac_inv_range((void *)&desc_ring[start], (void *)&desc_ring[end] + sizeof(struct n2h_descriptor));
-	} else {
-		/*
-		 * We have wrapped around
-		 */
-		dmac_inv_range((void *)&desc_ring[start], (void *)&desc_ring[mask] + sizeof(struct n2h_descriptor));
-		dmac_inv_range((void *)&desc_ring[0], (void *)&desc_ring[end] + sizeof(struct n2h_descriptor));
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(4, 5, 0))
+	if (unlikely(nbuf->nfct)) {
+		return false;
+	}
+#else
+	if (unlikely(nbuf->_nfct)) {
+		return false;
 	}
+#endif
+#endif
 
+#ifdef CONFIG_BRIDGE_NETFILTER
 	/*
-	 * Prefetch the first descriptor
+	 * This check is added to avoid deadlock from nf_bridge
+	 * when ecm is trying to flush a rule.
 	 */
-	desc = &desc_ring[hlos_index];
-	prefetch(desc);
+	if (unlikely(nf_bridge_info_get(nbuf))) {
+		return false;
+	}
+#endif
 
 	/*
-	 * Prefetch the next cache line of descriptors if we are starting with
-	 * the second descriptor in the cache line. If it is the first in the cache line,
-	 * this will be done inside the loop.
+	 * If skb has security parameters set do not reuse
 	 */
-	if (((hlos_index & 1) == 1) && likely((count > 1))) {
-		next_cache_desc = &desc_ring[(hlos_index + 2) & mask];
-		prefetch(next_cache_desc);
+	if (unlikely(skb_sec_path(nbuf))) {
+		return false;
 	}
 
-	if (qid == NSS_IF_N2H_EMPTY_BUFFER_RETURN_QUEUE) {
-		nss_core_handle_empty_buffers(nss_ctx, if_map, n2h_desc_ring, desc_ring, desc, count, hlos_index, mask);
-		return count;
-	}
+	if (unlikely(irqs_disabled()))
+		return false;
 
-	count_temp = count;
-	while (count_temp) {
-		unsigned int buffer_type;
-		nss_ptr_t opaque;
+	if (unlikely(skb_shinfo(nbuf)->tx_flags & SKBTX_DEV_ZEROCOPY))
+		return false;
+
+	if (unlikely(skb_is_nonlinear(nbuf)))
+		return false;
+
+	if (unlikely(skb_has_frag_list(nbuf)))
+		return false;
+
+	if (unlikely(skb_shinfo(nbuf)->nr_frags))
+		return false;
+
+	if (unlikely(nbuf->fclone != SKB_FCLONE_UNAVAILABLE))
+		return false;
+
+	min_skb_size = SKB_DATA_ALIGN(min_skb_size + NET_SKB_PAD);
+	if (unlikely(skb_end_pointer(nbuf) - nbuf->head < min_skb_size))
+		return false;
+
+	if (unlikely(skb_end_pointer(nbuf) - nbuf->head >= nss_core_get_max_reuse()))
+		return false;
+
+	if (unlikely(skb_cloned(nbuf)))
+		return false;
+
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(3, 6, 0))
+	if (unlikely(skb_pfmemalloc(nbuf)))
+		return false;
+#endif
+
+	return true;
+}
+
+/*
+ * nss_skb_reuse - clean up an skb
+ *	Clears the skb to be reused as a receive buffer.
+ *
+ * NOTE: This function does any necessary reference count dropping, and
+ * cleans up the skbuff as if its allocated fresh.
+ */
+void nss_skb_reuse(struct sk_buff *nbuf)
+{
+	struct skb_shared_info *shinfo;
+
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(3, 14, 0))
+	u8 head_frag = nbuf->head_frag;
+#endif
+
+	/*
+	 * Reset all the necessary head state information from skb which
+	 * we found can be recycled for NSS.
+	 */
+	skb_dst_drop(nbuf);
+
+	shinfo = skb_shinfo(nbuf);
+	memset(shinfo, 0, offsetof(struct skb_shared_info, dataref));
+	atomic_set(&shinfo->dataref, 1);
+
+	memset(nbuf, 0, offsetof(struct sk_buff, tail));
+	nbuf->data = nbuf->head + NET_SKB_PAD;
+	skb_reset_tail_pointer(nbuf);
+
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(3, 14, 0))
+	nbuf->head_frag = head_frag;
+#endif
+}
+#endif
+
+/*
+ * nss_core_cmd_buf_cb
+ *	Control block of a command buffer that belongs to a core's command buffer pool.
+ *
+ * Only valid once nss_core_is_cmd_buf() identified the buffer.
+ */
+struct nss_core_cmd_buf_cb {
+	struct nss_ctx_instance *nss_ctx;	/* Core whose pool the buffer returns to */
+};
+
+#define NSS_CORE_CMD_BUF_CB(skb) ((struct nss_core_cmd_buf_cb *)(skb)->cb)
+
+/*
+ * nss_core_cmd_buf_destructor()
+ *	Destructor of command pool buffers.
+ *
+ * There is nothing to release; the pointer itself marks a buffer as owned
+ * by a command buffer pool, since no other code can install it.
+ */
+static void nss_core_cmd_buf_destructor(struct sk_buff *nbuf)
+{
+}
+
+/*
+ * nss_core_is_cmd_buf()
+ *	Return true if nbuf belongs to a command buffer pool.
+ */
+static inline bool nss_core_is_cmd_buf(struct sk_buff *nbuf)
+{
+	return nbuf->destructor == nss_core_cmd_buf_destructor;
+}
+
+/*
+ * nss_core_cmd_buf_alloc()
+ *	Allocate a command buffer that can be recycled into the pool.
+ */
+static struct sk_buff *nss_core_cmd_buf_alloc(struct nss_ctx_instance *nss_ctx)
+{
+	struct sk_buff *nbuf;
+
+	nbuf = dev_alloc_skb(NSS_NBUF_PAYLOAD_SIZE);
+	if (unlikely(!nbuf)) {
+		return NULL;
+	}
+
+	nbuf->destructor = nss_core_cmd_buf_destructor;
+	NSS_CORE_CMD_BUF_CB(nbuf)->nss_ctx = nss_ctx;
+	return nbuf;
+}
+
+/*
+ * nss_core_cmd_buf_get()
+ *	Get a command buffer of at least buf_size bytes, from the pool if possible.
+ */
+static struct sk_buff *nss_core_cmd_buf_get(struct nss_ctx_instance *nss_ctx, int buf_size)
+{
+	struct sk_buff *nbuf;
+
+	if (unlikely(buf_size > NSS_NBUF_PAYLOAD_SIZE)) {
+		NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_TX_CMD_POOL_MISS]);
+		return dev_alloc_skb(buf_size);
+	}
+
+	nbuf = skb_dequeue(&nss_ctx->cmd_buf_pool);
+	if (likely(nbuf)) {
+		NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_TX_CMD_POOL_HIT]);
+		return nbuf;
+	}
+
+	NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_TX_CMD_POOL_MISS]);
+	return nss_core_cmd_buf_alloc(nss_ctx);
+}
+
+/*
+ * nss_core_cmd_buf_recycle()
+ *	Return an empty command buffer to its pool; false if nbuf is not a pool buffer or the pool is full.
+ */
+static inline bool nss_core_cmd_buf_recycle(struct nss_ctx_instance *nss_ctx, struct sk_buff *nbuf)
+{
+	if (likely(!nss_core_is_cmd_buf(nbuf)) || (NSS_CORE_CMD_BUF_CB(nbuf)->nss_ctx != nss_ctx)) {
+		return false;
+	}
 
+	if (unlikely(skb_queue_len(&nss_ctx->cmd_buf_pool) >= NSS_CORE_CMD_BUF_POOL_MAX)) {
+		return false;
+	}
+
+	skb_trim(nbuf, 0);
+	skb_queue_tail(&nss_ctx->cmd_buf_pool, nbuf);
+	return true;
+}
+
+/*
+ * nss_core_cmd_buf_pool_init()
+ *	Initialize and fill the command buffer pool of a core.
+ */
+void nss_core_cmd_buf_pool_init(struct nss_ctx_instance *nss_ctx)
+{
+	struct sk_buff *nbuf;
+	int i;
+
+	skb_queue_head_init(&nss_ctx->cmd_buf_pool);
+
+	for (i = 0; i < NSS_CORE_CMD_BUF_POOL_MAX; i++) {
+		nbuf = nss_core_cmd_buf_alloc(nss_ctx);
+		if (!nbuf) {
+			nss_warning("%px: command buffer pool filled with %d buffers only", nss_ctx, i);
+			break;
+		}
+
+		skb_queue_tail(&nss_ctx->cmd_buf_pool, nbuf);
+	}
+}
+
+/*
+ * nss_core_cmd_buf_pool_free()
+ *	Free the command buffers held in the pool of a core.
+ *
+ * Buffers still owned by NSS are freed when they return, not recycled.
+ */
+void nss_core_cmd_buf_pool_free(struct nss_ctx_instance *nss_ctx)
+{
+	skb_queue_purge(&nss_ctx->cmd_buf_pool);
+}
+
+#if (NSS_SKB_REUSE_SUPPORT == 1)
+/*
+ * nss_core_rx_buf_recycle()
+ *	Keep a buffer returned empty by NSS for the next empty buffer refill; false if it cannot be kept.
+ */
+static inline bool nss_core_rx_buf_recycle(struct nss_ctx_instance *nss_ctx, struct sk_buff *nbuf)
+{
+	if (unlikely(skb_queue_len(&nss_ctx->rx_buf_cache) >= NSS_CORE_RX_BUF_CACHE_MAX)) {
+		return false;
+	}
+
+	if (!nss_core_skb_can_reuse(nss_ctx, NSS_N2H_INTERFACE, nbuf, nss_ctx->max_buf_size)) {
+		return false;
+	}
+
+	nss_skb_reuse(nbuf);
+	skb_queue_tail(&nss_ctx->rx_buf_cache, nbuf);
+	return true;
+}
+#endif
+
+/*
+ * nss_core_rx_buf_get()
+ *	Get an empty buffer for max_buf_size sized payloads, from the recycle cache if possible.
+ */
+static inline struct sk_buff *nss_core_rx_buf_get(struct nss_ctx_instance *nss_ctx, uint16_t max_buf_size)
+{
+	struct sk_buff *nbuf;
+
+#if (NSS_SKB_REUSE_SUPPORT == 1)
+	while ((nbuf = skb_dequeue(&nss_ctx->rx_buf_cache))) {
 		/*
-		 * Prefetch the next cache line of descriptors.
+		 * The maximum buffer size may have grown since nbuf was cached.
 		 */
-		if (((hlos_index & 1) == 0) && likely(count_temp > 2)) {
-			next_cache_desc = &desc_ring[(hlos_index + 2) & mask];
-			prefetch(next_cache_desc);
+		if (likely(skb_end_pointer(nbuf) - nbuf->head >= SKB_DATA_ALIGN(max_buf_size + NET_SKB_PAD))) {
+			NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_TX_EMPTY_RECYCLE_HIT]);
+			return nbuf;
 		}
 
+		dev_kfree_skb_any(nbuf);
+	}
+#endif
+
+	NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_TX_EMPTY_RECYCLE_MISS]);
+	return dev_alloc_skb(max_buf_size);
+}
+
+/*
+ * nss_core_rx_buf_cache_init()
+ *	Initialize the empty buffer recycle cache of a core.
+ */
+void nss_core_rx_buf_cache_init(struct nss_ctx_instance *nss_ctx)
+{
+	skb_queue_head_init(&nss_ctx->rx_buf_cache);
+}
+
+/*
+ * nss_core_rx_buf_cache_free()
+ *	Free the buffers held in the empty buffer recycle cache of a core.
+ */
+void nss_core_rx_buf_cache_free(struct nss_ctx_instance *nss_ctx)
+{
+	skb_queue_purge(&nss_ctx->rx_buf_cache);
+}
+
+/*
+ * nss_core_handle_empty_buffers()
+ *	Handle empty buffer returns.
+ */
+static inline void nss_core_handle_empty_buffers(struct nss_ctx_instance *nss_ctx,
+						 struct nss_if_mem_map *if_map,
+						 struct hlos_n2h_desc_ring *n2h_desc_ring,
+						 struct n2h_descriptor *desc_ring,
+						 struct n2h_descriptor *desc,
+						 uint32_t count, uint32_t hlos_index,
+						 uint16_t mask)
+{
+	nss_ring_n2h_for_each(desc_ring, desc, hlos_index, count, mask) {
+		/*
+		 * Since we only return the primary skb, we have no way to unmap
+		 * properly. Simple skb's are properly mapped but page data skbs
+		 * have the payload mapped (and not the skb->data slab payload).
+		 *
+		 * Warning: On non-Krait HW, we need to unmap fragments.
+		 *
+		 * This only unmaps the first segment either slab payload or
+		 * skb page data. Eventually, we need to unmap all of a frag_list
+		 * or all of page_data however this is not a big concern as of now
+		 * since on Kriats dma_map_single() does not allocate any resource
+		 * and hence dma_unmap_single() is sort off a nop.
+		 *
+		 * No need to invalidate for Tx Completions, so set dma direction = DMA_TO_DEVICE;
+		 * Similarly prefetch is not needed for an empty buffer.
+		 */
+		struct sk_buff *nbuf;
+
+		nbuf = (struct sk_buff *)desc->opaque;
+
+		if (unlikely(nbuf < (struct sk_buff *)PAGE_OFFSET)) {
+			/*
+			 * Invalid opaque pointer
+			 */
+			nss_dump_desc(nss_ctx, desc);
+			NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_RX_BAD_DESCRIPTOR]);
+			continue;
+		}
+
+		dma_unmap_single(nss_ctx->dev, (desc->buffer + desc->payload_offs), desc->payload_len, DMA_TO_DEVICE);
+		if (nss_core_cmd_buf_recycle(nss_ctx, nbuf)) {
+			goto recycled;
+		}
+
+#if (NSS_SKB_REUSE_SUPPORT == 1)
+		if (nss_core_rx_buf_recycle(nss_ctx, nbuf)) {
+			goto recycled;
+		}
+#endif
+
+		dev_kfree_skb_any(nbuf);
+
+recycled:
+
+		NSS_PKT_STATS_DEC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_NSS_SKB_COUNT]);
+		NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_RX_EMPTY]);
+	}
+
+	n2h_desc_ring->hlos_index = hlos_index;
+	if_map->n2h_hlos_index[NSS_IF_N2H_EMPTY_BUFFER_RETURN_QUEUE] = hlos_index;
+
+	NSS_CORE_DMA_CACHE_MAINT((void *)&if_map->n2h_hlos_index[NSS_IF_N2H_EMPTY_BUFFER_RETURN_QUEUE], sizeof(uint32_t), DMA_TO_DEVICE);
+	NSS_CORE_DSB();
+}
+
+/*
+ * nss_core_handle_cause_queue()
+ *	Handle interrupt cause related to N2H/H2N queues
+ */
+static int32_t nss_core_handle_cause_queue(struct int_ctx_instance *int_ctx, uint16_t cause, int16_t weight)
+{
+	int16_t count, count_temp;
+	uint16_t size, mask, qid;
+	uint32_t nss_index, hlos_index;
+	struct sk_buff *nbuf;
+	struct hlos_n2h_desc_ring *n2h_desc_ring;
+	struct n2h_desc_if_instance *desc_if;
+	struct n2h_descriptor *desc_ring;
+	struct n2h_descriptor *desc;
+	struct nss_ctx_instance *nss_ctx = int_ctx->nss_ctx;
+	struct nss_meminfo_ctx *mem_ctx = &nss_ctx->meminfo_ctx;
+	struct nss_if_mem_map *if_map = mem_ctx->if_map;
+
+	qid = nss_core_cause_to_queue(cause);
+
+	/*
+	 * Make sure qid < num_rings
+	 */
+	nss_assert(qid < if_map->n2h_rings);
+
+	n2h_desc_ring = &nss_ctx->n2h_desc_ring[qid];
+	desc_if = &n2h_desc_ring->desc_ring;
+	desc_ring = desc_if->desc;
+	NSS_CORE_DMA_CACHE_MAINT((void *)&if_map->n2h_nss_index[qid], sizeof(uint32_t), DMA_FROM_DEVICE);
+	NSS_CORE_DSB();
+	nss_index = if_map->n2h_nss_index[qid];
+
+	hlos_index = n2h_desc_ring->hlos_index;
+	size = desc_if->size;
+	mask = size - 1;
+
+	/*
+	 * Check if there is work to be done for this queue
+	 */
+	if (nss_core_get_napi_adapt()) {
+		nss_core_napi_adapt_sample(&n2h_desc_ring->adapt, nss_ring_used(nss_index, hlos_index, mask));
+	}
+
+	/*
+	 * Restrict ourselves to suggested weight
+	 */
+	count = nss_ring_drain_count(nss_index, hlos_index, mask, weight);
+	if (unlikely(count == 0)) {
+		return 0;
+	}
+
+	n2h_desc_ring->desc_count += count;
+
+	desc = nss_ring_n2h_drain_begin(nss_ctx, desc_ring, hlos_index, count, mask);
+
+	if (qid == NSS_IF_N2H_EMPTY_BUFFER_RETURN_QUEUE) {
+		nss_core_handle_empty_buffers(nss_ctx, if_map, n2h_desc_ring, desc_ring, desc, count, hlos_index, mask);
+		return count;
+	}
+
+	count_temp = count;
+	nss_ring_n2h_for_each(desc_ring, desc, hlos_index, count_temp, mask) {
+		unsigned int buffer_type;
+		nss_ptr_t opaque;
+
 		buffer_type = desc->buffer_type;
 		opaque = desc->opaque;
 
@@ -1599,7 +2118,7 @@ static int32_t nss_core_handle_cause_queue(struct int_ctx_instance *int_ctx, uin
 			 */
 			nss_dump_desc(nss_ctx, desc);
 			NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_RX_BAD_DESCRIPTOR]);
-			goto next;
+			continue;
 		}
 
 		/*
@@ -1638,7 +2157,7 @@ static int32_t nss_core_handle_cause_queue(struct int_ctx_instance *int_ctx, uin
 			}
 
 			if (!nss_core_handle_nr_frag_skb(nss_ctx, &nbuf, &n2h_desc_ring->jumbo_start, desc, buffer_type)) {
-				goto next;
+				continue;
 			}
 			NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_RX_NR_FRAGS]);
 			goto consume;
@@ -1662,17 +2181,11 @@ static int32_t nss_core_handle_cause_queue(struct int_ctx_instance *int_ctx, uin
 		 * handler to process it.
 		 */
 		if (!nss_core_handle_linear_skb(nss_ctx, &nbuf, &n2h_desc_ring->head, &n2h_desc_ring->tail, desc)) {
-			goto next;
+			continue;
 		}
 
 consume:
 		nss_core_rx_pbuf(nss_ctx, desc, &(int_ctx->napi), buffer_type, nbuf, qid);
-
-next:
-
-		hlos_index = (hlos_index + 1) & (mask);
-		desc = &desc_ring[hlos_index];
-		count_temp--;
 	}
 
 	n2h_desc_ring->hlos_index = hlos_index;
@@ -1681,6 +2194,11 @@ next:
 	NSS_CORE_DMA_CACHE_MAINT((void *)&if_map->n2h_hlos_index[qid], sizeof(uint32_t), DMA_TO_DEVICE);
 	NSS_CORE_DSB();
 
+	/*
+	 * Hand over whatever was batched for the stack in this pass.
+	 */
+	nss_core_rx_batch_flush(nss_ctx, &int_ctx->rx_batch, &int_ctx->napi);
+
 	return count;
 }
 
@@ -1834,7 +2352,7 @@ static void nss_core_alloc_paged_buffers(struct nss_ctx_instance *nss_ctx, struc
 		 */
 		NSS_CORE_DMA_CACHE_MAINT((void *)desc, sizeof(*desc), DMA_TO_DEVICE);
 
-		hlos_index = (hlos_index + 1) & (mask);
+		hlos_index = nss_ring_next(hlos_index, mask);
 		count--;
 	}
 
@@ -1843,6 +2361,7 @@ static void nss_core_alloc_paged_buffers(struct nss_ctx_instance *nss_ctx, struc
 	 */
 	NSS_CORE_DSB();
 
+	h2n_desc_ring->desc_count += nss_ring_used(hlos_index, h2n_desc_ring->hlos_index, mask);
 	h2n_desc_ring->hlos_index = hlos_index;
 	if_map->h2n_hlos_index[buffer_queue] = hlos_index;
 
@@ -1908,7 +2427,7 @@ static void nss_core_alloc_jumbo_mru_buffers(struct nss_ctx_instance *nss_ctx, s
 		 */
 		NSS_CORE_DMA_CACHE_MAINT((void *)desc, sizeof(*desc), DMA_TO_DEVICE);
 
-		hlos_index = (hlos_index + 1) & (mask);
+		hlos_index = nss_ring_next(hlos_index, mask);
 		count--;
 	}
 
@@ -1917,6 +2436,7 @@ static void nss_core_alloc_jumbo_mru_buffers(struct nss_ctx_instance *nss_ctx, s
 	 */
 	NSS_CORE_DSB();
 
+	h2n_desc_ring->desc_count += nss_ring_used(hlos_index, h2n_desc_ring->hlos_index, mask);
 	h2n_desc_ring->hlos_index = hlos_index;
 	if_map->h2n_hlos_index[NSS_IF_H2N_EMPTY_BUFFER_QUEUE] = hlos_index;
 
@@ -1945,7 +2465,7 @@ static void nss_core_alloc_max_avail_size_buffers(struct nss_ctx_instance *nss_c
 		dma_addr_t buffer;
 		struct h2n_descriptor *desc = &desc_ring[hlos_index];
 
-		struct sk_buff *nbuf = dev_alloc_skb(max_buf_size);
+		struct sk_buff *nbuf = nss_core_rx_buf_get(nss_ctx, max_buf_size);
 		if (unlikely(!nbuf)) {
 			/*
 			 * ERR:
@@ -1979,14 +2499,14 @@ static void nss_core_alloc_max_avail_size_buffers(struct nss_ctx_instance *nss_c
 		desc->buffer = buffer;
 		desc->buffer_len = payload_len;
 
-		hlos_index = (hlos_index + 1) & (mask);
+		hlos_index = nss_ring_next(hlos_index, mask);
 		count--;
 	}
 
 	/*
 	 * Find the last descriptor we need to flush.
 	 */
-	prev_hlos_index = (hlos_index - 1) & mask;
+	prev_hlos_index = nss_ring_prev(hlos_index, mask);
 
 	/*
 	 * Flush the descriptors, including the descriptor at prev_hlos_index.
@@ -2006,6 +2526,7 @@ static void nss_core_alloc_max_avail_size_buffers(struct nss_ctx_instance *nss_c
 	 */
 	NSS_CORE_DSB();
 
+	h2n_desc_ring->desc_count += nss_ring_used(hlos_index, h2n_desc_ring->hlos_index, mask);
 	h2n_desc_ring->hlos_index = hlos_index;
 	if_map->h2n_hlos_index[NSS_IF_H2N_EMPTY_BUFFER_QUEUE] = hlos_index;
 
@@ -2040,7 +2561,7 @@ static inline void nss_core_handle_empty_buffer_sos(struct nss_ctx_instance *nss
 	size = h2n_desc_ring->desc_ring.size;
 
 	mask = size - 1;
-	count = ((nss_index - hlos_index - 1) + size) & (mask);
+	count = nss_ring_free(hlos_index, nss_index, mask);
 
 	nss_trace("%px: Adding %d buffers to empty queue\n", nss_ctx, count);
 
@@ -2048,6 +2569,9 @@ static inline void nss_core_handle_empty_buffer_sos(struct nss_ctx_instance *nss
 	 * Fill empty buffer queue with buffers leaving one empty descriptor
 	 * Note that total number of descriptors in queue cannot be more than (size - 1)
 	 */
+	NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_RX_EMPTY_SOS]);
+	nss_ctx->empty_buf_sos++;
+
 	if (!count) {
 		return;
 	}
@@ -2092,9 +2616,11 @@ static inline void nss_core_handle_paged_empty_buffer_sos(struct nss_ctx_instanc
 	size = h2n_desc_ring->desc_ring.size;
 
 	mask = size - 1;
-	count = ((nss_index - hlos_index - 1) + size) & (mask);
+	count = nss_ring_free(hlos_index, nss_index, mask);
 	nss_trace("%px: Adding %d buffers to paged buffer queue", nss_ctx, count);
 
+	NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_RX_PAGED_EMPTY_SOS]);
+
 	/*
 	 * Fill empty buffer queue with buffers leaving one empty descriptor
 	 * Note that total number of descriptors in queue cannot be more than (size - 1)
@@ -2432,263 +2958,206 @@ int nss_core_handle_napi_sdma(struct napi_struct *napi, int budget)
 int nss_core_handle_napi_queue(struct napi_struct *napi, int budget)
 {
 	int processed;
+	int weight = budget;
 	struct int_ctx_instance *int_ctx = container_of(napi, struct int_ctx_instance, napi);
+	struct nss_core_napi_adapt *adapt = NULL;
 
-	processed = nss_core_handle_cause_queue(int_ctx, int_ctx->cause, budget);
-	if (processed < budget) {
-		napi_complete(napi);
-		enable_irq(int_ctx->irq);
+	if (nss_core_get_napi_adapt()) {
+		adapt = &int_ctx->nss_ctx->n2h_desc_ring[nss_core_cause_to_queue(int_ctx->cause)].adapt;
+		weight = min_t(int, nss_core_napi_levels[adapt->level].weight, budget);
 	}
 
-	return processed;
-}
-
-/*
- * nss_core_handle_napi_non_queue()
- *	NAPI handler for NSS non queue cause
- */
-int nss_core_handle_napi_non_queue(struct napi_struct *napi, int budget)
-{
-	struct int_ctx_instance *int_ctx = container_of(napi, struct int_ctx_instance, napi);
-
-	nss_core_handle_cause_nonqueue(int_ctx, int_ctx->cause, 0);
-	napi_complete(napi);
-	enable_irq(int_ctx->irq);
-	return 0;
-}
-
-/*
- * nss_core_write_one_descriptor()
- *	Fills-up a descriptor with required fields.
- */
-static inline void nss_core_write_one_descriptor(struct h2n_descriptor *desc,
-	uint16_t buffer_type, uint32_t buffer, uint32_t if_num,
-	nss_ptr_t opaque, uint16_t payload_off, uint16_t payload_len, uint16_t buffer_len,
-	uint32_t qos_tag, uint16_t mss, uint16_t bit_flags)
-{
-	desc->buffer_type = buffer_type;
-	desc->buffer = buffer;
-	desc->interface_num = if_num;
-	desc->opaque = opaque;
-	desc->payload_offs = payload_off;
-	desc->payload_len = payload_len;
-	desc->buffer_len = buffer_len;
-	desc->qos_tag = qos_tag;
-	desc->mss = mss;
-	desc->bit_flags = bit_flags;
-}
-
-/*
-* nss_core_send_unwind_dma()
-*	It unwinds (or unmap) DMA from descriptors
-*/
-static inline void nss_core_send_unwind_dma(struct device *dev, struct h2n_desc_if_instance *desc_if,
-	uint16_t hlos_index, int16_t count, bool is_fraglist)
-{
-	struct h2n_descriptor *desc_ring = desc_if->desc;
-	struct h2n_descriptor *desc;
-	int16_t i, mask;
-
-	mask = desc_if->size - 1;
-	for (i = 0; i < count; i++) {
-		desc = &desc_ring[hlos_index];
-		if (is_fraglist) {
-			dma_unmap_single(dev, desc->buffer, desc->buffer_len, DMA_TO_DEVICE);
-		} else {
-			dma_unmap_page(dev, desc->buffer, desc->buffer_len, DMA_TO_DEVICE);
+	processed = nss_core_handle_cause_queue(int_ctx, int_ctx->cause, weight);
+	if (processed >= weight) {
+		/*
+		 * More work is pending. Ask to be polled again even when
+		 * the adaptive weight is below the budget.
+		 */
+		if (adapt) {
+			adapt->linger = nss_core_napi_levels[adapt->level].linger;
 		}
-		hlos_index = (hlos_index - 1) & mask;
-	}
-}
-
-/*
- * nss_core_skb_tail_offset()
- */
-static inline uint32_t nss_core_skb_tail_offset(struct sk_buff *skb)
-{
-#ifdef NET_SKBUFF_DATA_USES_OFFSET
-	return skb->tail;
-#else
-	return skb->tail - skb->head;
-#endif
-}
-
-/*
- * nss_core_dma_map_single()
- */
-static inline uint32_t nss_core_dma_map_single(struct device *dev, struct sk_buff *skb)
-{
-	return (uint32_t)dma_map_single(dev, skb->head, nss_core_skb_tail_offset(skb), DMA_TO_DEVICE);
-}
 
-#if (NSS_SKB_REUSE_SUPPORT == 1)
-/*
- * nss_core_skb_can_reuse
- *	check if skb can be reuse
- */
-static inline bool nss_core_skb_can_reuse(struct nss_ctx_instance *nss_ctx,
-	uint32_t if_num, struct sk_buff *nbuf, int min_skb_size)
-{
-	/*
-	 * If we have to call a destructor, we can't re-use the buffer?
-	 */
-	if (unlikely(nbuf->destructor != NULL)) {
-		return false;
+		return budget;
 	}
 
-	/*
-	 * Check if skb has more than single user.
-	 */
-	if (unlikely(skb_shared(nbuf))) {
-		return false;
-	}
-
-#if IS_ENABLED(CONFIG_NF_CONNTRACK)
-	/*
-	 * This check is added to avoid deadlock from nf_conntrack
-	 * when ecm is trying to flush a rule.
-	 */
-#if (LINUX_VERSION_CODE < KERNEL_VERSION(4, 5, 0))
-	if (unlikely(nbuf->nfct)) {
-		return false;
-	}
-#else
-	if (unlikely(nbuf->_nfct)) {
-		return false;
-	}
-#endif
-#endif
+	if (adapt) {
+		/*
+		 * At the heaviest level a drained queue is polled again from
+		 * the linger timer instead of taking another interrupt. NAPI
+		 * is completed meanwhile so that the CPU is not busy-polling
+		 * an empty ring; the interrupt stays disabled until the
+		 * linger polls run out.
+		 */
+		if (processed) {
+			adapt->linger = nss_core_napi_levels[adapt->level].linger;
+		}
 
-#ifdef CONFIG_BRIDGE_NETFILTER
-	/*
-	 * This check is added to avoid deadlock from nf_bridge
-	 * when ecm is trying to flush a rule.
-	 */
-	if (unlikely(nf_bridge_info_get(nbuf))) {
-		return false;
-	}
-#endif
+		if (adapt->linger) {
+			adapt->linger--;
+			adapt->linger_polls++;
+			napi_complete(napi);
+			hrtimer_start(&int_ctx->linger_timer, ns_to_ktime(NSS_CORE_NAPI_LINGER_NS), HRTIMER_MODE_REL_PINNED);
+			return processed;
+		}
 
-	/*
-	 * If skb has security parameters set do not reuse
-	 */
-	if (unlikely(skb_sec_path(nbuf))) {
-		return false;
+		adapt->irq_enable++;
 	}
 
-	if (unlikely(irqs_disabled()))
-		return false;
-
-	if (unlikely(skb_shinfo(nbuf)->tx_flags & SKBTX_DEV_ZEROCOPY))
-		return false;
-
-	if (unlikely(skb_is_nonlinear(nbuf)))
-		return false;
-
-	if (unlikely(skb_has_frag_list(nbuf)))
-		return false;
-
-	if (unlikely(skb_shinfo(nbuf)->nr_frags))
-		return false;
-
-	if (unlikely(nbuf->fclone != SKB_FCLONE_UNAVAILABLE))
-		return false;
-
-	min_skb_size = SKB_DATA_ALIGN(min_skb_size + NET_SKB_PAD);
-	if (unlikely(skb_end_pointer(nbuf) - nbuf->head < min_skb_size))
-		return false;
-
-	if (unlikely(skb_end_pointer(nbuf) - nbuf->head >= nss_core_get_max_reuse()))
-		return false;
-
-	if (unlikely(skb_cloned(nbuf)))
-		return false;
+	napi_complete(napi);
+	enable_irq(int_ctx->irq);
+	return processed;
+}
 
-#if (LINUX_VERSION_CODE >= KERNEL_VERSION(3, 6, 0))
-	if (unlikely(skb_pfmemalloc(nbuf)))
-		return false;
-#endif
+/*
+ * nss_core_handle_napi_linger()
+ *	Linger timer handler, polls the queue again
+ */
+enum hrtimer_restart nss_core_handle_napi_linger(struct hrtimer *timer)
+{
+	struct int_ctx_instance *int_ctx = container_of(timer, struct int_ctx_instance, linger_timer);
 
-	return true;
+	napi_schedule(&int_ctx->napi);
+	return HRTIMER_NORESTART;
 }
 
 /*
- * nss_skb_reuse - clean up an skb
- *	Clears the skb to be reused as a receive buffer.
- *
- * NOTE: This function does any necessary reference count dropping, and
- * cleans up the skbuff as if its allocated fresh.
+ * nss_core_handle_napi_non_queue()
+ *	NAPI handler for NSS non queue cause
  */
-void nss_skb_reuse(struct sk_buff *nbuf)
+int nss_core_handle_napi_non_queue(struct napi_struct *napi, int budget)
 {
-	struct skb_shared_info *shinfo;
+	struct int_ctx_instance *int_ctx = container_of(napi, struct int_ctx_instance, napi);
 
-#if (LINUX_VERSION_CODE >= KERNEL_VERSION(3, 14, 0))
-	u8 head_frag = nbuf->head_frag;
+	nss_core_handle_cause_nonqueue(int_ctx, int_ctx->cause, 0);
+	napi_complete(napi);
+	enable_irq(int_ctx->irq);
+	return 0;
+}
+
+/*
+ * nss_core_skb_tail_offset()
+ */
+static inline uint32_t nss_core_skb_tail_offset(struct sk_buff *skb)
+{
+#ifdef NET_SKBUFF_DATA_USES_OFFSET
+	return skb->tail;
+#else
+	return skb->tail - skb->head;
 #endif
+}
+
+/*
+ * nss_core_dma_map_single()
+ */
+static inline uint32_t nss_core_dma_map_single(struct device *dev, struct sk_buff *skb)
+{
+	return (uint32_t)dma_map_single(dev, skb->head, nss_core_skb_tail_offset(skb), DMA_TO_DEVICE);
+}
 
+/*
+ * nss_core_skb_kmemleak_not_leak()
+ *	Tell kmemleak that the NSS FW is holding this skb.
+ */
+static inline void nss_core_skb_kmemleak_not_leak(struct sk_buff *nbuf)
+{
+#ifdef CONFIG_DEBUG_KMEMLEAK
 	/*
-	 * Reset all the necessary head state information from skb which
-	 * we found can be recycled for NSS.
+	 * If the skb is a fast clone (FCLONE), then nbuf is pointing to the
+	 * cloned skb which is at the middle of the allocated block and kmemleak API
+	 * would backtrace if passed such a pointer. We will need to get to the original
+	 * skb pointer which kmemleak is aware of.
 	 */
-	skb_dst_drop(nbuf);
-
-	shinfo = skb_shinfo(nbuf);
-	memset(shinfo, 0, offsetof(struct skb_shared_info, dataref));
-	atomic_set(&shinfo->dataref, 1);
-
-	memset(nbuf, 0, offsetof(struct sk_buff, tail));
-	nbuf->data = nbuf->head + NET_SKB_PAD;
-	skb_reset_tail_pointer(nbuf);
-
-#if (LINUX_VERSION_CODE >= KERNEL_VERSION(3, 14, 0))
-	nbuf->head_frag = head_frag;
+	if (nbuf->fclone == SKB_FCLONE_CLONE) {
+		kmemleak_not_leak(nbuf - 1);
+	} else {
+		kmemleak_not_leak(nbuf);
+	}
 #endif
 }
-#endif
 
 /*
- * nss_core_send_buffer_simple_skb()
- *	Sends one skb to NSS FW
+ * nss_ring_hal_desc_flush()
+ *	Write back an H2N descriptor; nss_ring_ops.h hook.
  */
-static inline int32_t nss_core_send_buffer_simple_skb(struct nss_ctx_instance *nss_ctx,
-	struct h2n_desc_if_instance *desc_if, uint32_t if_num,
-	struct sk_buff *nbuf, uint16_t hlos_index, uint16_t flags, uint8_t buffer_type, uint16_t mss)
+static inline void nss_ring_hal_desc_flush(struct nss_ctx_instance *nss_ctx, struct h2n_descriptor *desc)
 {
-	struct h2n_descriptor *desc_ring = desc_if->desc;
-	struct h2n_descriptor *desc;
-	uint16_t bit_flags;
-	uint16_t mask;
-	uint32_t frag0phyaddr;
+	NSS_CORE_DMA_CACHE_MAINT((void *)desc, sizeof(*desc), DMA_TO_DEVICE);
+}
 
-#if (NSS_SKB_REUSE_SUPPORT == 1)
-	uint16_t sz;
-#endif
+/*
+ * nss_ring_hal_desc_inv()
+ *	Invalidate N2H descriptors; nss_ring_ops.h hook.
+ */
+static inline void nss_ring_hal_desc_inv(struct nss_ctx_instance *nss_ctx, struct n2h_descriptor *start, struct n2h_descriptor *end)
+{
+	dmac_inv_range((void *)start, (void *)end);
+}
 
-	bit_flags = flags | H2N_BIT_FLAG_FIRST_SEGMENT | H2N_BIT_FLAG_LAST_SEGMENT;
-	if (likely(nbuf->ip_summed == CHECKSUM_PARTIAL)) {
-		bit_flags |= H2N_BIT_FLAG_GEN_IP_TRANSPORT_CHECKSUM;
-		bit_flags |= H2N_BIT_FLAG_GEN_IPV4_IP_CHECKSUM;
-	} else if (nbuf->ip_summed == CHECKSUM_UNNECESSARY) {
-		bit_flags |= H2N_BIT_FLAG_GEN_IP_TRANSPORT_CHECKSUM_NONE;
+/*
+ * nss_ring_hal_prefetch()
+ */
+static inline void nss_ring_hal_prefetch(const void *addr)
+{
+	prefetch(addr);
+}
+
+/*
+ * nss_ring_hal_map_head()
+ *	Map the linear area of an skb.
+ */
+static inline bool nss_ring_hal_map_head(struct nss_ctx_instance *nss_ctx, struct sk_buff *nbuf, struct nss_ring_seg *seg)
+{
+	seg->buffer = nss_core_dma_map_single(nss_ctx->dev, nbuf);
+	if (unlikely(dma_mapping_error(nss_ctx->dev, seg->buffer))) {
+		nss_warning("%px: DMA mapping failed for virtual address = %px", nss_ctx, nbuf->head);
+		return false;
 	}
 
-	mask = desc_if->size - 1;
-	desc = &desc_ring[hlos_index];
+	seg->payload_offs = nbuf->data - nbuf->head;
+	seg->payload_len = nbuf->len - nbuf->data_len;
+	seg->buffer_len = skb_end_offset(nbuf);
+	seg->priority = nbuf->priority;
+	return true;
+}
 
-#if (NSS_SKB_REUSE_SUPPORT == 1)
+/*
+ * nss_ring_hal_map_chained()
+ *	Map an skb of the frag_list of another.
+ */
+static inline bool nss_ring_hal_map_chained(struct nss_ctx_instance *nss_ctx, struct sk_buff *iter, struct nss_ring_seg *seg)
+{
 	/*
-	 * Check if the caller indicates that the buffer is not to be re-used (kept in the accelerator).
+	 * We currently don't support frags[] array inside a
+	 * fraglist.
 	 */
-	if (unlikely(!(bit_flags & H2N_BIT_FLAG_BUFFER_REUSABLE))) {
-		goto no_reuse;
+	if (unlikely(skb_shinfo(iter)->nr_frags > 0)) {
+		nss_warning("%px: fraglist with page data are not supported: %px\n", nss_ctx, iter);
+		return false;
+	}
+
+	if (!nss_ring_hal_map_head(nss_ctx, iter, seg)) {
+		return false;
 	}
 
 	/*
-	 * Since the caller is allowing re-use, we now check if the skb meets the criteria.
+	 * We are holding this skb in NSS FW, let kmemleak know about it.
 	 */
+	nss_core_skb_kmemleak_not_leak(iter);
+	return true;
+}
+
+/*
+ * nss_ring_hal_map_reuse()
+ *	Map an skb for Tx and then Rx if it can be kept in the accelerator.
+ */
+static inline bool nss_ring_hal_map_reuse(struct nss_ctx_instance *nss_ctx, uint32_t if_num,
+					struct sk_buff *nbuf, struct nss_ring_seg *seg)
+{
+#if (NSS_SKB_REUSE_SUPPORT == 1)
+	uint16_t sz;
+
 	if (unlikely(!nss_core_skb_can_reuse(nss_ctx, if_num, nbuf, nss_ctx->max_buf_size))) {
-		goto no_reuse;
+		return false;
 	}
 
 	/*
@@ -2696,325 +3165,299 @@ static inline int32_t nss_core_send_buffer_simple_skb(struct nss_ctx_instance *n
 	 * and then map Rx over the entire buffer.
 	 */
 	sz = max((uint16_t)nss_core_skb_tail_offset(nbuf), (uint16_t)(nss_ctx->max_buf_size + NET_SKB_PAD));
-	frag0phyaddr = (uint32_t)dma_map_single(nss_ctx->dev, nbuf->head, sz, DMA_TO_DEVICE);
-	if (unlikely(dma_mapping_error(nss_ctx->dev, frag0phyaddr))) {
-		goto no_reuse;
+	seg->buffer = (uint32_t)dma_map_single(nss_ctx->dev, nbuf->head, sz, DMA_TO_DEVICE);
+	if (unlikely(dma_mapping_error(nss_ctx->dev, seg->buffer))) {
+		return false;
 	}
 
-	/*
-	 * We are allowed to re-use the packet
-	 */
-	nss_core_write_one_descriptor(desc, buffer_type, frag0phyaddr, if_num,
-		(nss_ptr_t)nbuf, (uint16_t)(nbuf->data - nbuf->head), nbuf->len,
-		sz, (uint32_t)nbuf->priority, mss, bit_flags);
+	seg->payload_offs = nbuf->data - nbuf->head;
+	seg->payload_len = nbuf->len;
+	seg->buffer_len = sz;
+	seg->priority = nbuf->priority;
+	return true;
+#else
+	return false;
+#endif
+}
 
-	NSS_CORE_DMA_CACHE_MAINT((void *)desc, sizeof(*desc), DMA_TO_DEVICE);
+/*
+ * nss_ring_hal_map_frag()
+ *	Map a page fragment of an skb.
+ */
+static inline bool nss_ring_hal_map_frag(struct nss_ctx_instance *nss_ctx, struct sk_buff *nbuf,
+					uint32_t i, struct nss_ring_seg *seg)
+{
+	const skb_frag_t *frag = &skb_shinfo(nbuf)->frags[i];
+	dma_addr_t buffer;
 
-	/*
-	 * We are done using the skb fields and can reuse it now
-	 */
-	nss_skb_reuse(nbuf);
+	buffer = skb_frag_dma_map(nss_ctx->dev, frag, 0, skb_frag_size(frag), DMA_TO_DEVICE);
+	if (unlikely(dma_mapping_error(nss_ctx->dev, buffer))) {
+		nss_warning("%px: DMA mapping failed for fragment", nss_ctx);
+		return false;
+	}
 
-	NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_TX_BUFFER_REUSE]);
-	return 1;
+	seg->buffer = buffer;
+	seg->payload_offs = 0;
+	seg->payload_len = skb_frag_size(frag);
+	seg->buffer_len = skb_frag_size(frag);
+	seg->priority = nbuf->priority;
+	return true;
+}
 
-no_reuse:
-#endif
+/*
+ * nss_ring_hal_unmap()
+ *	Unwind (unmap) the DMA of descriptors.
+ */
+static inline void nss_ring_hal_unmap(struct nss_ctx_instance *nss_ctx, struct h2n_descriptor *desc_ring, uint32_t mask,
+					uint32_t hlos_index, uint32_t count, bool is_fraglist)
+{
+	struct h2n_descriptor *desc;
+	uint32_t i;
 
-	bit_flags &= ~H2N_BIT_FLAG_BUFFER_REUSABLE;
-	frag0phyaddr = nss_core_dma_map_single(nss_ctx->dev, nbuf);
-	if (unlikely(dma_mapping_error(nss_ctx->dev, frag0phyaddr))) {
-		nss_warning("%px: DMA mapping failed for virtual address = %px", nss_ctx, nbuf->head);
-		return 0;
+	for (i = 0; i < count; i++) {
+		desc = &desc_ring[hlos_index];
+		if (is_fraglist) {
+			dma_unmap_single(nss_ctx->dev, desc->buffer, desc->buffer_len, DMA_TO_DEVICE);
+		} else {
+			dma_unmap_page(nss_ctx->dev, desc->buffer, desc->buffer_len, DMA_TO_DEVICE);
+		}
+		hlos_index = nss_ring_prev(hlos_index, mask);
 	}
+}
+
+/*
+ * nss_ring_hal_written()
+ *	Account for an skb written to an H2N ring.
+ */
+static inline void nss_ring_hal_written(struct nss_ctx_instance *nss_ctx, struct sk_buff *nbuf,
+					enum nss_ring_h2n_kind kind, uint32_t count)
+{
+	switch (kind) {
+	case NSS_RING_H2N_REUSE:
+		/*
+		 * We are done using the skb fields and can reuse it now
+		 */
+		nss_skb_reuse(nbuf);
+		NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_TX_BUFFER_REUSE]);
+		break;
 
-	nss_core_write_one_descriptor(desc, buffer_type, frag0phyaddr, if_num,
-		(nss_ptr_t)nbuf, (uint16_t)(nbuf->data - nbuf->head), nbuf->len,
-		(uint16_t)skb_end_offset(nbuf), (uint32_t)nbuf->priority, mss, bit_flags);
+	case NSS_RING_H2N_SIMPLE:
+		NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_TX_SIMPLE]);
+		break;
 
-	NSS_CORE_DMA_CACHE_MAINT((void *)desc, sizeof(*desc), DMA_TO_DEVICE);
+	case NSS_RING_H2N_NR_FRAGS:
+		NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_TX_NR_FRAGS]);
+		break;
 
-	NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_TX_SIMPLE]);
-	return 1;
+	case NSS_RING_H2N_FRAGLIST:
+		/*
+		 * We need to defrag the frag_list, otherwise, if this structure is
+		 * received back we don't know how we can reconstruct the frag_list.
+		 * Therefore, we are clearing skb_has_fraglist. This is safe because all
+		 * information about the segments are already sent to NSS-FW.
+		 * So, the information will be in the NSS-FW.
+		 */
+		skb_shinfo(nbuf)->frag_list = NULL;
+		NSS_PKT_STATS_ADD(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_NSS_SKB_COUNT], count - 1);
+		NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_TX_FRAGLIST]);
+		break;
+	}
 }
 
 /*
- * nss_core_send_buffer_nr_frags()
- *	Sends frags array (NETIF_F_SG) to NSS FW
- *
- * Note - Opaque is set only on LAST fragment, and DISCARD is set for the rest of segments
- * Used to differentiate from FRAGLIST
+ * nss_ring_hal_len()
  */
-static inline int32_t nss_core_send_buffer_nr_frags(struct nss_ctx_instance *nss_ctx,
-	struct h2n_desc_if_instance *desc_if, uint32_t if_num,
-	struct sk_buff *nbuf, uint16_t hlos_index, uint16_t flags, uint8_t buffer_type, uint16_t mss)
+static inline uint16_t nss_ring_hal_len(struct sk_buff *nbuf)
 {
-	struct h2n_descriptor *desc_ring = desc_if->desc;
-	struct h2n_descriptor *desc;
-	const skb_frag_t *frag;
-	dma_addr_t buffer;
-	uint32_t nr_frags;
-	uint16_t bit_flags;
-	int16_t i;
-	uint16_t mask;
-
-	uint32_t frag0phyaddr = nss_core_dma_map_single(nss_ctx->dev, nbuf);
-	if (unlikely(dma_mapping_error(nss_ctx->dev, frag0phyaddr))) {
-		nss_warning("%px: DMA mapping failed for virtual address = %px", nss_ctx, nbuf->head);
-		return 0;
-	}
+	return nbuf->len;
+}
 
-	/*
-	 * Set the appropriate flags.
-	 */
-	bit_flags = (flags | H2N_BIT_FLAG_DISCARD);
+/*
+ * nss_ring_hal_gso_size()
+ */
+static inline uint16_t nss_ring_hal_gso_size(struct sk_buff *nbuf)
+{
+	return skb_is_gso(nbuf) ? skb_shinfo(nbuf)->gso_size : 0;
+}
 
-	/*
-	 * Reset the reuse flag for non-linear buffers.
-	 */
-	bit_flags &= ~H2N_BIT_FLAG_BUFFER_REUSABLE;
+/*
+ * nss_ring_hal_csum()
+ */
+static inline enum nss_ring_csum nss_ring_hal_csum(struct sk_buff *nbuf)
+{
 	if (likely(nbuf->ip_summed == CHECKSUM_PARTIAL)) {
-		bit_flags |= H2N_BIT_FLAG_GEN_IP_TRANSPORT_CHECKSUM;
-		bit_flags |= H2N_BIT_FLAG_GEN_IPV4_IP_CHECKSUM;
+		return NSS_RING_CSUM_PARTIAL;
 	}
 
-	mask = desc_if->size - 1;
-	desc = &desc_ring[hlos_index];
+	if (nbuf->ip_summed == CHECKSUM_UNNECESSARY) {
+		return NSS_RING_CSUM_UNNECESSARY;
+	}
 
-	/*
-	 * First fragment/descriptor is special
-	 */
-	nss_core_write_one_descriptor(desc, buffer_type, frag0phyaddr, if_num,
-		(nss_ptr_t)NULL, nbuf->data - nbuf->head, nbuf->len - nbuf->data_len,
-		skb_end_offset(nbuf), (uint32_t)nbuf->priority, mss, bit_flags | H2N_BIT_FLAG_FIRST_SEGMENT);
+	return NSS_RING_CSUM_NONE;
+}
 
-	NSS_CORE_DMA_CACHE_MAINT((void *)desc, sizeof(*desc), DMA_TO_DEVICE);
+/*
+ * nss_ring_hal_nr_frags()
+ */
+static inline uint32_t nss_ring_hal_nr_frags(struct sk_buff *nbuf)
+{
+	uint32_t nr_frags = skb_shinfo(nbuf)->nr_frags;
 
-	/*
-	 * Now handle rest of the fragments.
-	 */
-	nr_frags = skb_shinfo(nbuf)->nr_frags;
 	BUG_ON(nr_frags > MAX_SKB_FRAGS);
-	for (i = 0; i < nr_frags; i++) {
-		frag = &skb_shinfo(nbuf)->frags[i];
-
-		buffer = skb_frag_dma_map(nss_ctx->dev, frag, 0, skb_frag_size(frag), DMA_TO_DEVICE);
-		if (unlikely(dma_mapping_error(nss_ctx->dev, buffer))) {
-			nss_warning("%px: DMA mapping failed for fragment", nss_ctx);
-			nss_core_send_unwind_dma(nss_ctx->dev, desc_if, hlos_index, i + 1, false);
-			return -(i + 1);
-		}
-
-		hlos_index = (hlos_index + 1) & (mask);
-		desc = &(desc_if->desc[hlos_index]);
-
-		nss_core_write_one_descriptor(desc, buffer_type, buffer, if_num,
-			(nss_ptr_t)NULL, 0, skb_frag_size(frag), skb_frag_size(frag),
-			nbuf->priority, mss, bit_flags);
-
-		NSS_CORE_DMA_CACHE_MAINT((void *)desc, sizeof(*desc), DMA_TO_DEVICE);
-	}
+	return nr_frags;
+}
 
-	/*
-	 * Update bit flag for last descriptor.
-	 * The discard flag shall be set for all fragments except the
-	 * the last one.The NSS returns the last fragment to HLOS
-	 * after the packet processing is done.We do need to send the
-	 * packet buffer address (skb) in the descriptor of last segment
-	 * when the decriptor returns from NSS the HLOS uses the
-	 * opaque field to free the memory allocated.
-	 */
-	desc->bit_flags |= H2N_BIT_FLAG_LAST_SEGMENT;
-	desc->bit_flags &= ~(H2N_BIT_FLAG_DISCARD);
-	desc->opaque = (nss_ptr_t)nbuf;
+/*
+ * nss_ring_hal_frag_list()
+ */
+static inline struct sk_buff *nss_ring_hal_frag_list(struct sk_buff *nbuf)
+{
+	return skb_shinfo(nbuf)->frag_list;
+}
 
-	NSS_CORE_DMA_CACHE_MAINT((void *)desc, sizeof(*desc), DMA_TO_DEVICE);
+/*
+ * nss_ring_hal_frag_next()
+ */
+static inline struct sk_buff *nss_ring_hal_frag_next(struct sk_buff *iter)
+{
+	return iter->next;
+}
 
-	NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_TX_NR_FRAGS]);
-	return i+1;
+/*
+ * nss_core_init_handlers()
+ *	Initialize the handlers for all interfaces associated with core
+ */
+void nss_core_init_handlers(struct nss_ctx_instance *nss_ctx)
+{
+	struct nss_rx_cb_list *cb_list = nss_ctx->nss_rx_interface_handlers;
+	memset(cb_list, 0, sizeof(*cb_list) * NSS_MAX_NET_INTERFACES);
 }
 
 /*
- * nss_core_send_buffer_fraglist()
- *	Sends fraglist (NETIF_F_FRAGLIST) to NSS FW
+ * nss_core_skb_segments()
+ *	Return the number of segments that follow the head of nbuf.
  *
- * Note - Opaque will be set on all fragments, and DISCARD is set for the rest of segments
- * Used to differentiate from FRAGS
+ * Returns -1 if the nbuf can never fit in a ring of the given size.
  */
-static inline int32_t nss_core_send_buffer_fraglist(struct nss_ctx_instance *nss_ctx,
-	struct h2n_desc_if_instance *desc_if, uint32_t if_num,
-	struct sk_buff *nbuf, uint16_t hlos_index, uint16_t flags, uint8_t buffer_type, uint16_t mss)
+static inline int32_t nss_core_skb_segments(struct nss_ctx_instance *nss_ctx, struct sk_buff *nbuf, int16_t size)
 {
-	struct h2n_descriptor *desc_ring = desc_if->desc;
-	struct h2n_descriptor *desc;
-	dma_addr_t buffer;
-	uint16_t mask;
-	struct sk_buff *iter;
-	uint16_t bit_flags;
-	int16_t i;
+	int32_t segments = nss_ring_h2n_segments(nbuf, size);
 
-	uint32_t frag0phyaddr = nss_core_dma_map_single(nss_ctx->dev, nbuf);
-	if (unlikely(dma_mapping_error(nss_ctx->dev, frag0phyaddr))) {
-		nss_warning("%px: DMA mapping failed for virtual address = %px", nss_ctx, nbuf->head);
-		return 0;
-	}
-
-	/*
-	 * Copy and Set bit flags
-	 */
-	bit_flags = flags;
-
-	/*
-	 * Reset the reuse flag for non-linear buffers.
-	 */
-	bit_flags &= ~H2N_BIT_FLAG_BUFFER_REUSABLE;
-	if (likely(nbuf->ip_summed == CHECKSUM_PARTIAL)) {
-		bit_flags |= H2N_BIT_FLAG_GEN_IP_TRANSPORT_CHECKSUM;
-		bit_flags |= H2N_BIT_FLAG_GEN_IPV4_IP_CHECKSUM;
+	if (unlikely(segments < 0)) {
+		nss_warning("%px: Unable to fit in skb - more than %d segments in our descriptors", nss_ctx, size);
 	}
 
-	mask = desc_if->size - 1;
-	desc = &desc_ring[hlos_index];
-
-	/*
-	 * First fragment/descriptor is special. Will hold the Opaque
-	 */
-	nss_core_write_one_descriptor(desc, buffer_type, frag0phyaddr, if_num,
-		(nss_ptr_t)nbuf, nbuf->data - nbuf->head, nbuf->len - nbuf->data_len,
-		skb_end_offset(nbuf), (uint32_t)nbuf->priority, mss, bit_flags | H2N_BIT_FLAG_FIRST_SEGMENT);
+	return segments;
+}
 
-	NSS_CORE_DMA_CACHE_MAINT((void *)desc, sizeof(*desc), DMA_TO_DEVICE);
+/*
+ * nss_core_h2n_free_count()
+ *	Read the NSS index and return the number of free descriptors of an H2N ring.
+ *
+ * Must be called with the ring lock held.
+ */
+static inline int16_t nss_core_h2n_free_count(struct hlos_h2n_desc_rings *h2n_desc_ring,
+					struct nss_if_mem_map *if_map, uint16_t qid)
+{
+	int16_t nss_index;
+	int16_t size = h2n_desc_ring->desc_ring.size;
 
-	/*
-	 * Walk the frag_list in nbuf
-	 */
-	i = 0;
-	skb_walk_frags(nbuf, iter) {
-		uint32_t nr_frags;
+	NSS_CORE_DMA_CACHE_MAINT((void *)&if_map->h2n_nss_index[qid], sizeof(uint32_t), DMA_FROM_DEVICE);
+	NSS_CORE_DSB();
+	nss_index = if_map->h2n_nss_index[qid];
 
-		buffer = nss_core_dma_map_single(nss_ctx->dev, iter);
-		if (unlikely(dma_mapping_error(nss_ctx->dev, buffer))) {
-			nss_warning("%px: DMA mapping failed for virtual address = %px", nss_ctx, iter->head);
-			nss_core_send_unwind_dma(nss_ctx->dev, desc_if, hlos_index, i + 1, true);
-			return -(i+1);
-		}
+	return nss_ring_free(h2n_desc_ring->hlos_index, nss_index, size - 1);
+}
 
-		/*
-		 * We currently don't support frags[] array inside a
-		 * fraglist.
-		 */
-		nr_frags = skb_shinfo(iter)->nr_frags;
-		if (unlikely(nr_frags > 0)) {
-			nss_warning("%px: fraglist with page data are not supported: %px\n", nss_ctx, iter);
-			nss_core_send_unwind_dma(nss_ctx->dev, desc_if, hlos_index, i + 1, true);
-			return -(i+1);
-		}
+/*
+ * nss_core_h2n_publish_index()
+ *	Publish the host index of an H2N ring so the NSS sees the new descriptors.
+ *
+ * Must be called with the ring lock held.
+ */
+static inline void nss_core_h2n_publish_index(struct hlos_h2n_desc_rings *h2n_desc_ring,
+					struct nss_if_mem_map *if_map, uint16_t qid)
+{
+	/*
+	 * Sync to ensure all flushing of the descriptors are complete
+	 */
+	NSS_CORE_DSB();
 
-		/*
-		 * Update index.
-		 */
-		hlos_index = (hlos_index + 1) & (mask);
-		desc = &(desc_if->desc[hlos_index]);
+	if_map->h2n_hlos_index[qid] = h2n_desc_ring->hlos_index;
 
-#ifdef CONFIG_DEBUG_KMEMLEAK
-		/*
-		 * We are holding this skb in NSS FW, let kmemleak know about it.
-		 *
-		 * If the skb is a fast clone (FCLONE), then nbuf is pointing to the
-		 * cloned skb which is at the middle of the allocated block and kmemleak API
-		 * would backtrace if passed such a pointer. We will need to get to the original
-		 * skb pointer which kmemleak is aware of.
-		 */
-		if (iter->fclone == SKB_FCLONE_CLONE) {
-			kmemleak_not_leak(iter - 1);
-		} else {
-			kmemleak_not_leak(iter);
-		}
-#endif
+	NSS_CORE_DMA_CACHE_MAINT(&if_map->h2n_hlos_index[qid], sizeof(uint32_t), DMA_TO_DEVICE);
+	NSS_CORE_DSB();
 
-		nss_core_write_one_descriptor(desc, buffer_type, buffer, if_num,
-			(nss_ptr_t)iter, iter->data - iter->head, iter->len - iter->data_len,
-			skb_end_offset(iter), iter->priority, mss, bit_flags);
+	h2n_desc_ring->desc_count += h2n_desc_ring->pending;
+	h2n_desc_ring->pending = 0;
+}
 
-		NSS_CORE_DMA_CACHE_MAINT((void *)desc, sizeof(*desc), DMA_TO_DEVICE);
+/*
+ * nss_core_h2n_queue_full()
+ *	Account for a full H2N ring and ask the NSS to tell us when it drains.
+ *
+ * Must be called with the ring lock released.
+ */
+static void nss_core_h2n_queue_full(struct nss_ctx_instance *nss_ctx)
+{
+	nss_warning("%px: Data/Command Queue full reached", nss_ctx);
 
-		i++;
+#if (NSS_PKT_STATS_ENABLED == 1)
+	if (nss_ctx->id == NSS_CORE_0) {
+		NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_TX_QUEUE_FULL_0]);
+	} else if (nss_ctx->id == NSS_CORE_1) {
+		NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_TX_QUEUE_FULL_1]);
+	} else {
+		nss_warning("%px: Invalid nss core: %d\n", nss_ctx, nss_ctx->id);
 	}
+#endif
 
 	/*
-	 * We need to defrag the frag_list, otherwise, if this structure is
-	 * received back we don't know how we can reconstruct the frag_list.
-	 * Therefore, we are clearing skb_has_fraglist. This is safe because all
-	 * information about the segments are already sent to NSS-FW.
-	 * So, the information will be in the NSS-FW.
-	 */
-	skb_shinfo(nbuf)->frag_list = NULL;
-	NSS_PKT_STATS_ADD(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_NSS_SKB_COUNT], i);
-
-	/*
-	 * Update bit flag for last descriptor.
+	 * Enable de-congestion interrupt from NSS
 	 */
-	desc->bit_flags |= H2N_BIT_FLAG_LAST_SEGMENT;
-	NSS_CORE_DMA_CACHE_MAINT((void *)desc, sizeof(*desc), DMA_TO_DEVICE);
-
-	NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_TX_FRAGLIST]);
-	return i+1;
+	nss_hal_enable_interrupt(nss_ctx, nss_ctx->int_ctx[0].shift_factor, NSS_N2H_INTR_TX_UNBLOCKED);
 }
 
 /*
- * nss_core_init_handlers()
- *	Initialize the handlers for all interfaces associated with core
+ * nss_core_write_skb_descriptors()
+ *	Fill the descriptors for one nbuf starting at hlos_index.
+ *
+ * Must be called with the ring lock held, after checking that segments + 1
+ * descriptors are free. Returns the number of descriptors used, or <= 0 on failure.
  */
-void nss_core_init_handlers(struct nss_ctx_instance *nss_ctx)
+static inline int32_t nss_core_write_skb_descriptors(struct nss_ctx_instance *nss_ctx,
+	struct h2n_desc_if_instance *desc_if, uint32_t if_num, struct sk_buff *nbuf,
+	uint16_t hlos_index, int32_t segments, uint8_t buffer_type, uint16_t flags)
 {
-	struct nss_rx_cb_list *cb_list = nss_ctx->nss_rx_interface_handlers;
-	memset(cb_list, 0, sizeof(*cb_list) * NSS_MAX_NET_INTERFACES);
+	return nss_ring_h2n_fill(nss_ctx, desc_if->desc, desc_if->size - 1, hlos_index, if_num,
+			nbuf, segments, buffer_type, flags);
 }
 
 /*
- * nss_core_send_buffer()
- *	Send network buffer to NSS
+ * nss_core_send_buffer_one()
+ *	Send network buffer to NSS, optionally deferring the index update.
+ *
+ * When xmit_more is set, the descriptors are written but the host index is
+ * not published; the next non-deferred send on the same ring publishes all of
+ * them. Deferred descriptors on other rings are left to the caller.
  */
-int32_t nss_core_send_buffer(struct nss_ctx_instance *nss_ctx, uint32_t if_num,
+static int32_t nss_core_send_buffer_one(struct nss_ctx_instance *nss_ctx, uint32_t if_num,
 					struct sk_buff *nbuf, uint16_t qid,
-					uint8_t buffer_type, uint16_t flags)
+					uint8_t buffer_type, uint16_t flags, bool xmit_more)
 {
-	int16_t count, hlos_index, nss_index, size, mask;
-	uint32_t segments;
+	int16_t count, size, mask;
+	int32_t segments;
 	struct hlos_h2n_desc_rings *h2n_desc_ring = &nss_ctx->h2n_desc_rings[qid];
 	struct h2n_desc_if_instance *desc_if = &h2n_desc_ring->desc_ring;
-	struct h2n_descriptor *desc_ring;
-	struct h2n_descriptor *desc;
 	struct nss_meminfo_ctx *mem_ctx = &nss_ctx->meminfo_ctx;
 	struct nss_if_mem_map *if_map = mem_ctx->if_map;
-	uint16_t mss = 0;
-	bool is_bounce = ((buffer_type == H2N_BUFFER_SHAPER_BOUNCE_INTERFACE) || (buffer_type == H2N_BUFFER_SHAPER_BOUNCE_BRIDGE));
 
-	desc_ring = desc_if->desc;
 	size = desc_if->size;
 	mask = size - 1;
 
-	/*
-	 * If nbuf does not have fraglist, then update nr_frags
-	 * from frags[] array. Otherwise walk the frag_list.
-	 */
-	if (!skb_has_frag_list(nbuf)) {
-		segments = skb_shinfo(nbuf)->nr_frags;
-		BUG_ON(segments > MAX_SKB_FRAGS);
-	} else {
-		struct sk_buff *iter;
-		segments = 0;
-		skb_walk_frags(nbuf, iter) {
-			segments++;
-		}
-
-		/*
-		 * Check that segments do not overflow the number of descriptors
-		 */
-		if (unlikely(segments > size)) {
-			nss_warning("%px: Unable to fit in skb - %d segments in our descriptors", nss_ctx, segments);
-			return NSS_CORE_STATUS_FAILURE;
-		}
+	segments = nss_core_skb_segments(nss_ctx, nbuf, size);
+	if (unlikely(segments < 0)) {
+		return NSS_CORE_STATUS_FAILURE;
 	}
 
 	/*
@@ -3026,14 +3469,7 @@ int32_t nss_core_send_buffer(struct nss_ctx_instance *nss_ctx, uint32_t if_num,
 	 * We need to work out if there's sufficent space in our transmit descriptor
 	 * ring to place all the segments of a nbuf.
 	 */
-	NSS_CORE_DMA_CACHE_MAINT((void *)&if_map->h2n_nss_index[qid], sizeof(uint32_t), DMA_FROM_DEVICE);
-	NSS_CORE_DSB();
-	nss_index = if_map->h2n_nss_index[qid];
-
-	hlos_index = h2n_desc_ring->hlos_index;
-
-	count = ((nss_index - hlos_index - 1) + size) & (mask);
-
+	count = nss_core_h2n_free_count(h2n_desc_ring, if_map, qid);
 	if (unlikely(count < (segments + 1))) {
 		/*
 		 * NOTE: tx_q_full_cnt and TX_STOPPED flags will be used
@@ -3042,113 +3478,149 @@ int32_t nss_core_send_buffer(struct nss_ctx_instance *nss_ctx, uint32_t if_num,
 		 */
 		h2n_desc_ring->tx_q_full_cnt++;
 		h2n_desc_ring->flags |= NSS_H2N_DESC_RING_FLAGS_TX_STOPPED;
-		spin_unlock_bh(&h2n_desc_ring->lock);
-		nss_warning("%px: Data/Command Queue full reached", nss_ctx);
-
-#if (NSS_PKT_STATS_ENABLED == 1)
-		if (nss_ctx->id == NSS_CORE_0) {
-			NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_TX_QUEUE_FULL_0]);
-		} else if (nss_ctx->id == NSS_CORE_1) {
-			NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_TX_QUEUE_FULL_1]);
-		} else {
-			nss_warning("%px: Invalid nss core: %d\n", nss_ctx, nss_ctx->id);
-		}
-#endif
 
 		/*
-		 * Enable de-congestion interrupt from NSS
+		 * Do not leave earlier deferred descriptors behind; the caller
+		 * may not come back to this ring for a while.
 		 */
-		nss_hal_enable_interrupt(nss_ctx, nss_ctx->int_ctx[0].shift_factor, NSS_N2H_INTR_TX_UNBLOCKED);
+		if (h2n_desc_ring->pending) {
+			nss_core_h2n_publish_index(h2n_desc_ring, if_map, qid);
+		}
+		spin_unlock_bh(&h2n_desc_ring->lock);
 
+		nss_core_h2n_queue_full(nss_ctx);
 		return NSS_CORE_STATUS_FAILURE_QUEUE;
 	}
 
-	desc = &desc_ring[hlos_index];
-
-	/*
-	 * Check if segmentation enabled.
-	 * Configure descriptor bit flags accordingly
-	 */
-
-	/*
-	 * When CONFIG_HIGHMEM is enabled OS is giving a single big chunk buffer without
-	 * any scattered frames.
-	 *
-	 * NOTE: We dont have to perform segmentation offload for packets that are being
-	 * bounced. These packets WILL return to the HLOS for freeing or further processing.
-	 * They will NOT be transmitted by the NSS.
-	 */
-	if (skb_is_gso(nbuf) && !is_bounce) {
-		mss = skb_shinfo(nbuf)->gso_size;
-		flags |= H2N_BIT_FLAG_SEGMENTATION_ENABLE;
-	}
-
-	/*
-	 * WARNING! : The following "is_bounce" check has a potential to cause corruption
-	 * if things change in the NSS. This check allows fragmented packets to be sent down
-	 * with incomplete payload information since NSS does not care about the payload content
-	 * when packets are bounced for shaping. If it starts caring in future, then this code
-	 * will have to change.
-	 *
-	 * WHY WE ARE DOING THIS - Skipping S/G processing helps with performance.
-	 *
-	 */
-	count = 0;
-	if (likely((segments == 0) || is_bounce)) {
-		count = nss_core_send_buffer_simple_skb(nss_ctx, desc_if, if_num,
-			nbuf, hlos_index, flags, buffer_type, mss);
-	} else if (skb_has_frag_list(nbuf)) {
-		count = nss_core_send_buffer_fraglist(nss_ctx, desc_if, if_num,
-			nbuf, hlos_index, flags, buffer_type, mss);
-	} else {
-		count = nss_core_send_buffer_nr_frags(nss_ctx, desc_if, if_num,
-			nbuf, hlos_index, flags, buffer_type, mss);
-	}
-
+	count = nss_core_write_skb_descriptors(nss_ctx, desc_if, if_num, nbuf,
+			h2n_desc_ring->hlos_index, segments, buffer_type, flags);
 	if (unlikely(count <= 0)) {
 		/*
 		 * We failed and hence we need to unmap dma regions
 		 */
 		nss_warning("%px: failed to map DMA regions:%d", nss_ctx, -count);
+		if (h2n_desc_ring->pending) {
+			nss_core_h2n_publish_index(h2n_desc_ring, if_map, qid);
+		}
 		spin_unlock_bh(&h2n_desc_ring->lock);
 		return NSS_CORE_STATUS_FAILURE;
 	}
 
-	/*
-	 * Sync to ensure all flushing of the descriptors are complete
-	 */
-	NSS_CORE_DSB();
-
 	/*
 	 * Update our host index so the NSS sees we've written a new descriptor.
 	 */
-	hlos_index = (hlos_index + count) & mask;
-	h2n_desc_ring->hlos_index = hlos_index;
-	if_map->h2n_hlos_index[qid] = hlos_index;
+	h2n_desc_ring->hlos_index = nss_ring_advance(h2n_desc_ring->hlos_index, count, mask);
+	h2n_desc_ring->pending += count;
+	if (!xmit_more) {
+		nss_core_h2n_publish_index(h2n_desc_ring, if_map, qid);
+	}
 
-	NSS_CORE_DMA_CACHE_MAINT(&if_map->h2n_hlos_index[qid], sizeof(uint32_t), DMA_TO_DEVICE);
-	NSS_CORE_DSB();
+	nss_core_skb_kmemleak_not_leak(nbuf);
+
+	NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_NSS_SKB_COUNT]);
+
+	spin_unlock_bh(&h2n_desc_ring->lock);
+	return NSS_CORE_STATUS_SUCCESS;
+}
+
+/*
+ * nss_core_send_buffer()
+ *	Send network buffer to NSS
+ */
+int32_t nss_core_send_buffer(struct nss_ctx_instance *nss_ctx, uint32_t if_num,
+					struct sk_buff *nbuf, uint16_t qid,
+					uint8_t buffer_type, uint16_t flags)
+{
+	return nss_core_send_buffer_one(nss_ctx, if_num, nbuf, qid, buffer_type, flags, false);
+}
+
+/*
+ * nss_core_send_buffer_list()
+ *	Send a burst of network buffers to NSS under a single ring lock.
+ *
+ * Buffers are dequeued from the head of the list until it is empty, the ring
+ * is full or a buffer fails to map; the host index is published once for the
+ * whole burst. Buffers that were not sent are left on the list, in order,
+ * and belong to the caller. The number of buffers sent is returned in *sent.
+ */
+int32_t nss_core_send_buffer_list(struct nss_ctx_instance *nss_ctx, uint32_t if_num,
+					struct sk_buff_head *list, uint16_t qid,
+					uint8_t buffer_type, uint16_t flags, uint32_t *sent)
+{
+	int16_t count, free, size, mask;
+	int32_t segments;
+	int32_t status = NSS_CORE_STATUS_SUCCESS;
+	uint32_t nsent = 0;
+	struct sk_buff *nbuf;
+	struct hlos_h2n_desc_rings *h2n_desc_ring = &nss_ctx->h2n_desc_rings[qid];
+	struct h2n_desc_if_instance *desc_if = &h2n_desc_ring->desc_ring;
+	struct nss_meminfo_ctx *mem_ctx = &nss_ctx->meminfo_ctx;
+	struct nss_if_mem_map *if_map = mem_ctx->if_map;
+
+	*sent = 0;
+	if (skb_queue_empty(list)) {
+		return NSS_CORE_STATUS_SUCCESS;
+	}
+
+	size = desc_if->size;
+	mask = size - 1;
+
+	spin_lock_bh(&h2n_desc_ring->lock);
 
-#ifdef CONFIG_DEBUG_KMEMLEAK
 	/*
-	 * We are holding this skb in NSS FW, let kmemleak know about it.
-	 *
-	 * If the skb is a fast clone (FCLONE), then nbuf is pointing to the
-	 * cloned skb which is at the middle of the allocated block and kmemleak API
-	 * would backtrace if passed such a pointer. We will need to get to the original
-	 * skb pointer which kmemleak is aware of.
+	 * Read the NSS index once for the whole burst. The NSS only ever
+	 * frees descriptors, so the count can only be pessimistic.
 	 */
-	if (nbuf->fclone == SKB_FCLONE_CLONE) {
-		kmemleak_not_leak(nbuf - 1);
-	} else {
-		kmemleak_not_leak(nbuf);
+	free = nss_core_h2n_free_count(h2n_desc_ring, if_map, qid);
+
+	while ((nbuf = skb_peek(list)) != NULL) {
+		segments = nss_core_skb_segments(nss_ctx, nbuf, size);
+		if (unlikely(segments < 0)) {
+			status = NSS_CORE_STATUS_FAILURE;
+			break;
+		}
+
+		if (unlikely(free < (segments + 1))) {
+			h2n_desc_ring->tx_q_full_cnt++;
+			h2n_desc_ring->flags |= NSS_H2N_DESC_RING_FLAGS_TX_STOPPED;
+			status = NSS_CORE_STATUS_FAILURE_QUEUE;
+			break;
+		}
+
+		count = nss_core_write_skb_descriptors(nss_ctx, desc_if, if_num, nbuf,
+				h2n_desc_ring->hlos_index, segments, buffer_type, flags);
+		if (unlikely(count <= 0)) {
+			nss_warning("%px: failed to map DMA regions:%d", nss_ctx, -count);
+			status = NSS_CORE_STATUS_FAILURE;
+			break;
+		}
+
+		__skb_unlink(nbuf, list);
+		nss_core_skb_kmemleak_not_leak(nbuf);
+
+		h2n_desc_ring->hlos_index = nss_ring_advance(h2n_desc_ring->hlos_index, count, mask);
+		h2n_desc_ring->pending += count;
+		free -= count;
+		nsent++;
 	}
-#endif
 
-	NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_NSS_SKB_COUNT]);
+	if (h2n_desc_ring->pending) {
+		nss_core_h2n_publish_index(h2n_desc_ring, if_map, qid);
+	}
 
 	spin_unlock_bh(&h2n_desc_ring->lock);
-	return NSS_CORE_STATUS_SUCCESS;
+
+	if (unlikely(status == NSS_CORE_STATUS_FAILURE_QUEUE)) {
+		nss_core_h2n_queue_full(nss_ctx);
+	}
+
+	if (nsent) {
+		NSS_PKT_STATS_ADD(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_NSS_SKB_COUNT], nsent);
+		NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_TX_BURST]);
+	}
+
+	*sent = nsent;
+	return status;
 }
 
 /*
@@ -3160,6 +3632,7 @@ int32_t nss_core_send_cmd(struct nss_ctx_instance *nss_ctx, void *msg, int size,
 	struct nss_cmn_msg *ncm = (struct nss_cmn_msg *)msg;
 	int32_t status;
 	struct sk_buff *nbuf;
+	uint16_t flags;
 
 	NSS_VERIFY_CTX_MAGIC(nss_ctx);
 	if (unlikely(nss_ctx->state != NSS_CORE_STATE_INITIALIZED)) {
@@ -3179,7 +3652,7 @@ int32_t nss_core_send_cmd(struct nss_ctx_instance *nss_ctx, void *msg, int size,
 		return NSS_TX_FAILURE_BAD_PARAM;
 	}
 
-	nbuf = dev_alloc_skb(buf_size);
+	nbuf = nss_core_cmd_buf_get(nss_ctx, buf_size);
 	if (unlikely(!nbuf)) {
 		NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_NBUF_ALLOC_FAILS]);
 		nss_warning("%px: interface: %d type: %d msg dropped as command allocation failed", nss_ctx, ncm->interface, ncm->type);
@@ -3188,9 +3661,21 @@ int32_t nss_core_send_cmd(struct nss_ctx_instance *nss_ctx, void *msg, int size,
 
 	memcpy(skb_put(nbuf, buf_size), (void *)ncm, size);
 
-	status = nss_core_send_buffer(nss_ctx, 0, nbuf, NSS_IF_H2N_CMD_QUEUE, H2N_BUFFER_CTRL, H2N_BIT_FLAG_BUFFER_REUSABLE);
+	/*
+	 * Pool buffers are not offered to NSS for reuse so that they always come
+	 * back on the empty buffer return queue and can be recycled.
+	 */
+	flags = H2N_BIT_FLAG_BUFFER_REUSABLE;
+	if (nss_core_is_cmd_buf(nbuf)) {
+		flags = 0;
+	}
+
+	status = nss_core_send_buffer(nss_ctx, 0, nbuf, NSS_IF_H2N_CMD_QUEUE, H2N_BUFFER_CTRL, flags);
 	if (status != NSS_CORE_STATUS_SUCCESS) {
-		dev_kfree_skb_any(nbuf);
+		if (!nss_core_cmd_buf_recycle(nss_ctx, nbuf)) {
+			dev_kfree_skb_any(nbuf);
+		}
+
 		NSS_PKT_STATS_INC(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_TX_CMD_QUEUE_FULL]);
 		nss_warning("%px: interface: %d type: %d unable to enqueue message status %d\n", nss_ctx, ncm->interface, ncm->type, status);
 		return status;
@@ -3202,13 +3687,63 @@ int32_t nss_core_send_cmd(struct nss_ctx_instance *nss_ctx, void *msg, int size,
 }
 
 /*
- * nss_core_send_packet()
- *	Send data packet to NSS
+ * nss_core_get_data_queue()
+ *	Select the H2N data queue for a packet.
  */
-int32_t nss_core_send_packet(struct nss_ctx_instance *nss_ctx, struct sk_buff *nbuf, uint32_t if_num, uint32_t flag)
+static inline uint16_t nss_core_get_data_queue(struct sk_buff *nbuf)
+{
+	uint16_t queue_id = 0;
+
+#ifdef NSS_MULTI_H2N_DATA_RING_SUPPORT
+	queue_id = (skb_get_queue_mapping(nbuf) & (NSS_HOST_CORES - 1)) << 1;
+	if (nbuf->priority) {
+		queue_id++;
+	}
+#endif
+	return queue_id;
+}
+
+/*
+ * nss_core_publish_data_queues()
+ *	Publish the descriptors left behind on the H2N data queues, without a doorbell.
+ *
+ * Returns true if any queue had descriptors to publish.
+ */
+static bool nss_core_publish_data_queues(struct nss_ctx_instance *nss_ctx)
+{
+	struct nss_if_mem_map *if_map = nss_ctx->meminfo_ctx.if_map;
+	struct hlos_h2n_desc_rings *h2n_desc_ring;
+	bool published = false;
+	uint16_t qid;
+
+	for (qid = NSS_IF_H2N_DATA_QUEUE; qid < NSS_H2N_DESC_RING_NUM; qid++) {
+		h2n_desc_ring = &nss_ctx->h2n_desc_rings[qid];
+		if (likely(!h2n_desc_ring->pending)) {
+			continue;
+		}
+
+		spin_lock_bh(&h2n_desc_ring->lock);
+		if (h2n_desc_ring->pending) {
+			nss_core_h2n_publish_index(h2n_desc_ring, if_map, qid);
+			published = true;
+		}
+		spin_unlock_bh(&h2n_desc_ring->lock);
+	}
+
+	return published;
+}
+
+/*
+ * nss_core_send_packet_more()
+ *	Send data packet to NSS, deferring the doorbell while more packets follow.
+ *
+ * xmit_more must only be set from an ndo_start_xmit context, where the stack
+ * guarantees a later call without it (see nss_core_flush_data_queues()).
+ */
+int32_t nss_core_send_packet_more(struct nss_ctx_instance *nss_ctx, struct sk_buff *nbuf, uint32_t if_num, uint32_t flag, bool xmit_more)
 {
 	int32_t status;
-	int32_t queue_id = 0;
+	uint16_t queue_id;
 
 	NSS_VERIFY_CTX_MAGIC(nss_ctx);
 	if (unlikely(nss_ctx->state != NSS_CORE_STATE_INITIALIZED)) {
@@ -3216,19 +3751,28 @@ int32_t nss_core_send_packet(struct nss_ctx_instance *nss_ctx, struct sk_buff *n
 		return NSS_TX_FAILURE_NOT_READY;
 	}
 
-#ifdef NSS_MULTI_H2N_DATA_RING_SUPPORT
-	queue_id = (skb_get_queue_mapping(nbuf) & (NSS_HOST_CORES - 1)) << 1;
-	if (nbuf->priority) {
-		queue_id++;
-	}
-#endif
-	status = nss_core_send_buffer(nss_ctx, if_num, nbuf, NSS_IF_H2N_DATA_QUEUE + queue_id, H2N_BUFFER_PACKET, flag);
+	queue_id = nss_core_get_data_queue(nbuf);
+	status = nss_core_send_buffer_one(nss_ctx, if_num, nbuf, NSS_IF_H2N_DATA_QUEUE + queue_id, H2N_BUFFER_PACKET, flag, xmit_more);
 	if (status != NSS_CORE_STATUS_SUCCESS) {
 		nss_warning("%px: interface: %d unable to enqueue packet status %d\n", nss_ctx, if_num, status);
+
+		/*
+		 * The stack may not come back soon after a failure, publish
+		 * whatever earlier packets of the burst left behind.
+		 */
+		nss_core_flush_data_queues(nss_ctx);
 		return status;
 	}
 
-	nss_hal_send_interrupt(nss_ctx, NSS_H2N_INTR_DATA_COMMAND_QUEUE);
+	if (!xmit_more) {
+		/*
+		 * Packets of one burst can map to different rings (priority,
+		 * queue mapping); publish all of them, not only this ring, then
+		 * ring the doorbell once for the whole burst.
+		 */
+		nss_core_publish_data_queues(nss_ctx);
+		nss_hal_send_interrupt(nss_ctx, NSS_H2N_INTR_DATA_COMMAND_QUEUE);
+	}
 
 #ifdef NSS_MULTI_H2N_DATA_RING_SUPPORT
 	/*
@@ -3240,6 +3784,89 @@ int32_t nss_core_send_packet(struct nss_ctx_instance *nss_ctx, struct sk_buff *n
 	return status;
 }
 
+/*
+ * nss_core_send_packet()
+ *	Send data packet to NSS
+ */
+int32_t nss_core_send_packet(struct nss_ctx_instance *nss_ctx, struct sk_buff *nbuf, uint32_t if_num, uint32_t flag)
+{
+	return nss_core_send_packet_more(nss_ctx, nbuf, if_num, flag, false);
+}
+
+/*
+ * nss_core_send_packet_list()
+ *	Send a burst of data packets to NSS with a single doorbell.
+ *
+ * Consecutive packets that map to the same H2N data queue are sent as one
+ * burst. On failure, the packets that were not sent are left on the list and
+ * belong to the caller. The number of packets sent is returned in *sent.
+ */
+int32_t nss_core_send_packet_list(struct nss_ctx_instance *nss_ctx, struct sk_buff_head *list, uint32_t if_num, uint32_t flag, uint32_t *sent)
+{
+	struct sk_buff_head burst;
+	struct sk_buff *nbuf;
+	int32_t status = NSS_CORE_STATUS_SUCCESS;
+	uint32_t nsent = 0;
+	uint32_t burst_sent;
+	uint16_t queue_id;
+
+	*sent = 0;
+
+	NSS_VERIFY_CTX_MAGIC(nss_ctx);
+	if (unlikely(nss_ctx->state != NSS_CORE_STATE_INITIALIZED)) {
+		nss_warning("%px: interface: %d packet list dropped as core not ready\n", nss_ctx, if_num);
+		return NSS_TX_FAILURE_NOT_READY;
+	}
+
+	__skb_queue_head_init(&burst);
+	while (!skb_queue_empty(list)) {
+		/*
+		 * Move the run of packets that share the head's queue to the burst.
+		 */
+		queue_id = nss_core_get_data_queue(skb_peek(list));
+		while ((nbuf = skb_peek(list)) && (nss_core_get_data_queue(nbuf) == queue_id)) {
+			__skb_unlink(nbuf, list);
+			__skb_queue_tail(&burst, nbuf);
+		}
+
+		status = nss_core_send_buffer_list(nss_ctx, if_num, &burst, NSS_IF_H2N_DATA_QUEUE + queue_id,
+						H2N_BUFFER_PACKET, flag, &burst_sent);
+		nsent += burst_sent;
+
+#ifdef NSS_MULTI_H2N_DATA_RING_SUPPORT
+		NSS_PKT_STATS_ADD(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_TX_PACKET_QUEUE_0 + queue_id], burst_sent);
+#endif
+
+		if (unlikely(status != NSS_CORE_STATUS_SUCCESS)) {
+			/*
+			 * Put the unsent part of the burst back in front of the list.
+			 */
+			skb_queue_splice(&burst, list);
+			nss_warning("%px: interface: %d unable to enqueue packet list status %d\n", nss_ctx, if_num, status);
+			break;
+		}
+	}
+
+	if (nsent) {
+		nss_hal_send_interrupt(nss_ctx, NSS_H2N_INTR_DATA_COMMAND_QUEUE);
+		NSS_PKT_STATS_ADD(&nss_ctx->nss_top->stats_drv[NSS_DRV_STATS_TX_PACKET], nsent);
+	}
+
+	*sent = nsent;
+	return status;
+}
+
+/*
+ * nss_core_flush_data_queues()
+ *	Publish any descriptors left behind by a deferred (xmit_more) send.
+ */
+void nss_core_flush_data_queues(struct nss_ctx_instance *nss_ctx)
+{
+	if (nss_core_publish_data_queues(nss_ctx)) {
+		nss_hal_send_interrupt(nss_ctx, NSS_H2N_INTR_DATA_COMMAND_QUEUE);
+	}
+}
+
 /*
  * nss_core_ddr_info()
  *	Getting DDR information for NSS core
@@ -28,15 +28,18 @@
 #include <linux/types.h>
 #include <linux/spinlock.h>
 #include <linux/interrupt.h>
+#include <linux/hrtimer.h>
 #include <linux/skbuff.h>
 #include <linux/netdevice.h>
 #include <linux/debugfs.h>
 #include <linux/workqueue.h>
+#include <linux/percpu.h>
 #include <asm/cacheflush.h>
 
 #include <nss_api_if.h>
 #include "nss_phys_if.h"
 #include "nss_hlos_if.h"
+#include "nss_freq_gov.h"
 #include "nss_oam.h"
 #include "nss_data_plane.h"
 #include "nss_gmac_stats.h"
@@ -137,6 +140,20 @@ static inline void nss_core_dma_cache_maint(void *start, uint32_t size, int dire
 #define NSS_NBUF_PAD_EXTRA 256
 #define NSS_NBUF_ETH_EXTRA 192
 
+/*
+ * Command buffer pool
+ *	Command buffers are NSS_NBUF_PAYLOAD_SIZE bytes; up to NSS_CORE_CMD_BUF_POOL_MAX
+ *	of them are kept per core and recycled when NSS returns them empty.
+ */
+#define NSS_CORE_CMD_BUF_POOL_MAX 32
+
+/*
+ * Empty buffer recycle cache
+ *	Buffers NSS returns empty that could serve as receive buffers are kept,
+ *	up to NSS_CORE_RX_BUF_CACHE_MAX per core, for the next empty buffer SOS.
+ */
+#define NSS_CORE_RX_BUF_CACHE_MAX 256
+
 /*
  * N2H/H2N Queue IDs
  */
@@ -212,6 +229,16 @@ static inline void nss_core_dma_cache_maint(void *start, uint32_t size, int dire
 #define NSS_EMPTY_BUFFER_SOS_PROCESSING_WEIGHT 64
 #define NSS_DATA_COMMAND_BUFFER_PROCESSING_WEIGHT 64
 #define NSS_EMPTY_BUFFER_RETURN_PROCESSING_WEIGHT 64
+
+/*
+ * Adaptive NAPI
+ *	The backlog average is re-evaluated every NSS_CORE_NAPI_ADAPT_WINDOW polls.
+ * A lingering queue is polled again NSS_CORE_NAPI_LINGER_NS after it drained.
+ */
+#define NSS_CORE_NAPI_ADAPT_WINDOW 16
+#define NSS_CORE_NAPI_ADAPT_AVG_SHIFT 4
+#define NSS_CORE_NAPI_ADAPT_LEVEL_DEFAULT 3
+#define NSS_CORE_NAPI_LINGER_NS (20 * NSEC_PER_USEC)
 #define NSS_TX_UNBLOCKED_PROCESSING_WEIGHT 1
 
 /*
@@ -358,6 +385,17 @@ struct netdev_priv_instance {
 	struct int_ctx_instance *int_ctx;	/* Back pointer to interrupt context */
 };
 
+/*
+ * Batch of N2H packets destined to one net device
+ *
+ * Filled by the rx path when rx_list is enabled and delivered to the stack
+ * as a list once the destination changes or the queue has been drained.
+ */
+struct nss_core_rx_batch {
+	struct net_device *ndev;	/* Destination of the queued packets, held while non-NULL */
+	struct sk_buff_head list;	/* Packets queued for delivery */
+};
+
 /*
  * Interrupt context instance (one per queue per NSS core)
  */
@@ -369,6 +407,30 @@ struct int_ctx_instance {
 	uint32_t shift_factor;	/* Shift factor for this IRQ queue */
 	uint32_t cause;			/* Interrupt cause carried forward to BH */
 	struct napi_struct napi;/* NAPI handler */
+	struct hrtimer linger_timer;	/* Polls a lingering queue again with its interrupt still disabled */
+	struct nss_core_rx_batch rx_batch;
+					/* Packets pending delivery to the stack */
+};
+
+/*
+ * Adaptive NAPI state of an N2H queue
+ *
+ * The backlog found on every poll is averaged over a sampling window. The
+ * queue then moves between the levels of nss_core_napi_levels[], each of
+ * which sets a poll weight and a number of idle polls to linger before the
+ * queue interrupt is re-enabled. A lingering queue completes NAPI and is
+ * polled again from int_ctx->linger_timer, so it does not busy-poll.
+ */
+struct nss_core_napi_adapt {
+	uint32_t backlog_avg;		/* Moving average of the backlog, scaled by 1 << NSS_CORE_NAPI_ADAPT_AVG_SHIFT */
+	uint32_t backlog_max;		/* Largest backlog found on a poll */
+	uint16_t level;			/* Current level */
+	uint16_t linger;		/* Idle polls left before the interrupt is re-enabled */
+	uint32_t samples;		/* Polls sampled in the current window */
+	uint64_t level_up;		/* Moves to a heavier level */
+	uint64_t level_down;		/* Moves to a lighter level */
+	uint64_t linger_polls;		/* Polls made on a drained queue instead of re-enabling the interrupt */
+	uint64_t irq_enable;		/* Times the queue interrupt was re-enabled */
 };
 
 /*
@@ -381,6 +443,9 @@ struct hlos_n2h_desc_ring {
 	struct sk_buff *head;		/* First segment of an skb fraglist */
 	struct sk_buff *tail;		/* Last segment received of an skb fraglist */
 	struct sk_buff *jumbo_start;	/* First segment of an skb with frags[] */
+	struct nss_core_napi_adapt adapt;
+					/* Adaptive NAPI state */
+	uint32_t desc_count;		/* Descriptors consumed, wraps around */
 };
 
 /*
@@ -391,7 +456,9 @@ struct hlos_h2n_desc_rings {
 	uint32_t hlos_index;
 	spinlock_t lock;			/* Lock to save from simultaneous access */
 	uint32_t flags;				/* Flags */
+	uint32_t pending;			/* Descriptors written but not yet published to NSS */
 	uint64_t tx_q_full_cnt;			/* Descriptor queue full count */
+	uint32_t desc_count;			/* Descriptors handed to NSS, wraps around */
 };
 
 #define NSS_H2N_DESC_RING_FLAGS_TX_STOPPED 0x1	/* Tx has been stopped for this queue */
@@ -464,6 +531,8 @@ struct nss_ctx_instance {
 	uint32_t vphys;			/* Phys mem pointer to virtual register map */
 	uint32_t qgic_phys;		/* Phys mem pointer to QGIC register map */
 	uint32_t load;			/* Load address for this core */
+	uint32_t fw_size;		/* Size of the loaded firmware image */
+	uint32_t fw_crc;		/* CRC32 of the loaded firmware image */
 	struct nss_meminfo_ctx meminfo_ctx;	/* Meminfo context */
 	enum nss_core_state state;	/* State of NSS core */
 	uint32_t c2c_start;		/* C2C start address */
@@ -499,6 +568,12 @@ struct nss_ctx_instance {
 					/* NSS interface callback handlers */
 	struct nss_subsystem_dataplane_register subsys_dp_register[NSS_MAX_NET_INTERFACES];
 					/* Subsystem registration data */
+	struct sk_buff_head cmd_buf_pool;
+					/* Recycled command buffers */
+	struct sk_buff_head rx_buf_cache;
+					/* Recycled empty buffers */
+	uint32_t empty_buf_sos;
+					/* Empty buffer SOS requests from this core */
 	uint32_t magic;
 					/* Magic protection */
 };
@@ -511,10 +586,10 @@ struct nss_top_instance {
 	uint8_t num_phys_ports;			/* Number of physical ports supported */
 	uint32_t clk_src;			/* Clock source: default/alternate */
 	spinlock_t lock;			/* Big lock for NSS driver */
-	spinlock_t stats_lock;			/* Statistics lock */
 	struct mutex wq_lock;			/* Mutex for NSS Work queue function */
 	struct dentry *top_dentry;		/* Top dentry for nss */
 	struct dentry *stats_dentry;		/* Top dentry for nss stats */
+	struct dentry *stats_bin_dentry;	/* Top dentry for binary nss stats */
 	struct dentry *strings_dentry;		/* Top dentry for nss stats strings */
 	struct dentry *project_dentry;		/* per-project stats dentry */
 	struct nss_ctx_instance nss[NSS_MAX_CORES];
@@ -661,8 +736,7 @@ struct nss_top_instance {
 	/*
 	 * Statistics for various interfaces
 	 */
-	atomic64_t stats_drv[NSS_DRV_STATS_MAX];
-					/* Hlos driver statistics */
+	uint64_t __percpu *stats_drv;	/* Hlos driver statistics, NSS_DRV_STATS_MAX per CPU */
 	uint64_t stats_gmac[NSS_MAX_PHYSICAL_INTERFACES][NSS_GMAC_STATS_MAX];
 					/* GMAC statistics */
 	uint64_t stats_node[NSS_MAX_NET_INTERFACES][NSS_STATS_NODE_MAX];
@@ -682,44 +756,59 @@ struct nss_top_instance {
 };
 
 #if (NSS_PKT_STATS_ENABLED == 1)
+/*
+ * Packet statistics are kept per CPU so that the hot paths never share a
+ * cache line; a counter's value is the sum over all CPUs. A counter may be
+ * incremented on one CPU and decremented on another, so an individual
+ * CPU's share can wrap while the sum stays correct.
+ */
+
 /*
  * nss_pkt_stats_inc()
  */
-static inline void nss_pkt_stats_inc(atomic64_t *stat)
+static inline void nss_pkt_stats_inc(uint64_t __percpu *stat)
 {
-	atomic64_inc(stat);
+	this_cpu_inc(*stat);
 }
 
 /*
  * nss_pkt_stats_dec()
  */
-static inline void nss_pkt_stats_dec(atomic64_t *stat)
+static inline void nss_pkt_stats_dec(uint64_t __percpu *stat)
 {
-	atomic64_dec(stat);
+	this_cpu_dec(*stat);
 }
 
 /*
  * nss_pkt_stats_add()
  */
-static inline void nss_pkt_stats_add(atomic64_t *stat, uint32_t pkt)
+static inline void nss_pkt_stats_add(uint64_t __percpu *stat, uint32_t pkt)
 {
-	atomic64_add(pkt, stat);
+	this_cpu_add(*stat, pkt);
 }
 
 /*
  * nss_pkt_stats_sub()
  */
-static inline void nss_pkt_stats_sub(atomic64_t *stat, uint32_t pkt)
+static inline void nss_pkt_stats_sub(uint64_t __percpu *stat, uint32_t pkt)
 {
-	atomic64_sub(pkt, stat);
+	this_cpu_sub(*stat, pkt);
 }
 
 /*
  * nss_pkt_stats_read()
+ *	Fold the per CPU counters; only called from stats readers.
  */
-static inline uint64_t nss_pkt_stats_read(atomic64_t *stat)
+static inline uint64_t nss_pkt_stats_read(uint64_t __percpu *stat)
 {
-	return atomic64_read(stat);
+	uint64_t sum = 0;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		sum += *per_cpu_ptr(stat, cpu);
+	}
+
+	return sum;
 }
 
 #endif
@@ -738,37 +827,11 @@ struct nss_cmd_buffer {
 };
 extern struct nss_cmd_buffer nss_cmd_buf;
 
-/*
- * The scales for NSS
- */
-typedef enum nss_freq_scales {
-	NSS_FREQ_LOW_SCALE = 0,
-	NSS_FREQ_MID_SCALE = 1,
-	NSS_FREQ_HIGH_SCALE = 2,
-	NSS_FREQ_MAX_SCALE = 3,
-} nss_freq_scales_t;
-
 /*
  * NSS Core Statistics and Frequencies
  */
-#define NSS_SAMPLE_BUFFER_SIZE 4			/* Ring Buffer should be a Size of two */
-#define NSS_SAMPLE_BUFFER_MASK (NSS_SAMPLE_BUFFER_SIZE - 1)
-#define NSS_FREQUENCY_SCALE_RATE_LIMIT_UP 2		/* Adjust the Rate of Frequency Switching Up */
-#define NSS_FREQUENCY_SCALE_RATE_LIMIT_DOWN 60000	/* Adjust the Rate of Frequency Switching Down */
 #define NSS_MESSAGE_RATE_LIMIT 15000			/* Adjust the Rate of Displaying Statistic Messages */
 
-/*
- * NSS Frequency Scale Info
- *
- * INFO: Contains the Scale information per Frequency
- *	Per Scale information needed to Program PLL and make switching decisions
- */
-struct nss_scale_info {
-	uint32_t frequency;	/* Frequency in Mhz */
-	uint32_t minimum;	/* Minimum INST_CNT per Sec */
-	uint32_t maximum;	/* Maximum INST_CNT per Sec */
-};
-
 /*
  * NSS Runtime Sample Structure
  *
@@ -779,8 +842,7 @@ struct nss_runtime_sampling {
 	struct nss_scale_info freq_scale[NSS_FREQ_MAX_SCALE];	/* NSS Max Scale Per Freq */
 	nss_freq_scales_t freq_scale_index;			/* Current Freq Index */
 	uint32_t freq_scale_ready;				/* Allow Freq Scaling */
-	uint32_t freq_scale_rate_limit_up;			/* Scaling Change Rate Limit */
-	uint32_t freq_scale_rate_limit_down;			/* Scaling Change Rate Limit */
+	struct nss_freq_gov gov;				/* Scaling Governor State */
 	uint32_t buffer[NSS_SAMPLE_BUFFER_SIZE];		/* Sample Ring Buffer */
 	uint32_t buffer_index;					/* Running Buffer Index */
 	uint32_t sum;						/* Total INST_CNT SUM */
@@ -804,6 +866,15 @@ struct nss_freq_cpu_usage {
 	uint16_t avg_ctr;				/* Averaging counter */
 };
 
+/*
+ * nss_freq_governor_stats
+ *	Frequency changes made by the auto scaling governors
+ */
+struct nss_freq_governor_stats {
+	uint32_t scale_up;				/* Changes to a higher scale */
+	uint32_t scale_down;				/* Changes to a lower scale */
+};
+
 #if (NSS_DT_SUPPORT == 1)
 /*
  * nss_feature_enabled
@@ -940,14 +1011,25 @@ typedef struct {
  */
 extern int nss_core_handle_napi(struct napi_struct *napi, int budget);
 extern int nss_core_handle_napi_queue(struct napi_struct *napi, int budget);
+extern enum hrtimer_restart nss_core_handle_napi_linger(struct hrtimer *timer);
 extern int nss_core_handle_napi_non_queue(struct napi_struct *napi, int budget);
 extern int nss_core_handle_napi_emergency(struct napi_struct *napi, int budget);
 extern int nss_core_handle_napi_sdma(struct napi_struct *napi, int budget);
 extern int32_t nss_core_send_buffer(struct nss_ctx_instance *nss_ctx, uint32_t if_num,
 					struct sk_buff *nbuf, uint16_t qid,
 					uint8_t buffer_type, uint16_t flags);
+extern int32_t nss_core_send_buffer_list(struct nss_ctx_instance *nss_ctx, uint32_t if_num,
+					struct sk_buff_head *list, uint16_t qid,
+					uint8_t buffer_type, uint16_t flags, uint32_t *sent);
 extern int32_t nss_core_send_cmd(struct nss_ctx_instance *nss_ctx, void *msg, int size, int buf_size);
+extern void nss_core_cmd_buf_pool_init(struct nss_ctx_instance *nss_ctx);
+extern void nss_core_cmd_buf_pool_free(struct nss_ctx_instance *nss_ctx);
+extern void nss_core_rx_buf_cache_init(struct nss_ctx_instance *nss_ctx);
+extern void nss_core_rx_buf_cache_free(struct nss_ctx_instance *nss_ctx);
 extern int32_t nss_core_send_packet(struct nss_ctx_instance *nss_ctx, struct sk_buff *nbuf, uint32_t if_num, uint32_t flag);
+extern int32_t nss_core_send_packet_more(struct nss_ctx_instance *nss_ctx, struct sk_buff *nbuf, uint32_t if_num, uint32_t flag, bool xmit_more);
+extern int32_t nss_core_send_packet_list(struct nss_ctx_instance *nss_ctx, struct sk_buff_head *list, uint32_t if_num, uint32_t flag, uint32_t *sent);
+extern void nss_core_flush_data_queues(struct nss_ctx_instance *nss_ctx);
 extern uint32_t nss_core_ddr_info(struct nss_mmu_ddr_info *coreinfo);
 extern uint32_t nss_core_register_msg_handler(struct nss_ctx_instance *nss_ctx, uint32_t interface, nss_if_rx_msg_callback_t msg_cb);
 extern uint32_t nss_core_unregister_msg_handler(struct nss_ctx_instance *nss_ctx, uint32_t interface);
@@ -974,6 +1056,40 @@ static inline uint32_t nss_core_get_max_buf_size(struct nss_ctx_instance *nss_ct
 	return nss_ctx->max_buf_size;
 }
 
+/*
+ * nss_core_skb_xmit_more()
+ *	Returns true if the stack has more packets queued behind this one.
+ *
+ * Only meaningful from an ndo_start_xmit context.
+ */
+static inline bool nss_core_skb_xmit_more(struct sk_buff *skb)
+{
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(3, 18, 0))
+	return false;
+#elif (LINUX_VERSION_CODE < KERNEL_VERSION(5, 2, 0))
+	return skb->xmit_more;
+#else
+	return netdev_xmit_more();
+#endif
+}
+
+/*
+ * Generic netlink compatibility
+ *	Extended error messages appeared in 4.12, and the family wide policy
+ *	replaced the per operation one in 5.2.
+ */
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(4, 12, 0))
+#define NSS_GENL_SET_ERR_MSG(info, msg) nss_info("%s\n", msg)
+#else
+#define NSS_GENL_SET_ERR_MSG(info, msg) GENL_SET_ERR_MSG(info, msg)
+#endif
+
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(5, 2, 0))
+#define NSS_GENL_OP_POLICY(p) .policy = (p),
+#else
+#define NSS_GENL_OP_POLICY(p)
+#endif
+
 /*
  * APIs provided by nss_tx_rx.c
  */
@@ -993,12 +1109,45 @@ extern bool nss_debug_log_buffer_alloc(uint8_t nss_id, uint32_t nentry);
 extern int nss_logbuffer_handler(struct ctl_table *ctl, int write, void __user *buffer, size_t *lenp, loff_t *ppos);
 
 /*
- * APIs to set jumbo_mru & paged_mode
+ * APIs provided by nss_profiler.c
+ */
+extern int nss_ctl_profiler_collect;
+extern void nss_profiler_collect_init(void);
+extern void nss_profiler_collect_exit(void);
+extern int nss_profiler_collect_handler(struct ctl_table *ctl, int write, void __user *buffer, size_t *lenp, loff_t *ppos);
+
+/*
+ * APIs provided by nss_bench.c
+ */
+extern void nss_bench_init(void);
+extern void nss_bench_exit(void);
+
+/*
+ * APIs provided by nss_dma_copy.c
+ */
+extern void nss_dma_copy_init(void);
+extern void nss_dma_copy_exit(void);
+
+/*
+ * APIs provided by nss_udp_st_nl.c
+ */
+extern void nss_udp_st_nl_init(void);
+extern void nss_udp_st_nl_exit(void);
+
+/*
+ * APIs to set jumbo_mru, paged_mode, rx_list & napi_adapt
  */
 extern void nss_core_set_jumbo_mru(int jumbo_mru);
 extern int nss_core_get_jumbo_mru(void);
 extern void nss_core_set_paged_mode(int mode);
 extern int nss_core_get_paged_mode(void);
+extern void nss_core_set_rx_list(int enable);
+extern int nss_core_get_rx_list(void);
+extern void nss_core_set_napi_adapt(int enable);
+extern int nss_core_get_napi_adapt(void);
+extern int16_t nss_core_napi_level_weight(uint16_t level);
+extern uint16_t nss_core_napi_level_linger(uint16_t level);
+extern uint32_t nss_core_n2h_backlog(struct nss_ctx_instance *nss_ctx);
 #if (NSS_SKB_REUSE_SUPPORT == 1)
 extern void nss_core_set_max_reuse(int max);
 extern int nss_core_get_max_reuse(void);
@@ -1016,6 +1165,9 @@ extern int nss_coredump_init_delay_work(void);
  * APIs provided by nss_freq.c
  */
 extern bool nss_freq_sched_change(nss_freq_scales_t index, bool auto_scale);
+extern bool nss_freq_set_governor(int id);
+extern int nss_freq_get_governor(void);
+extern const char *nss_freq_governor_name(int id);
 
 /*
  * nss_freq_init_cpu_usage
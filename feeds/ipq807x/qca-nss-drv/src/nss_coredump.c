@@ -25,14 +25,105 @@
 #include <linux/kernel.h>
 #include <linux/notifier.h>	/* for panic_notifier_list */
 #include <linux/jiffies.h>	/* for time */
+#include <linux/devcoredump.h>
+#include <linux/lz4.h>
+#include <linux/vmalloc.h>
 #include "nss_tx_rx_common.h"
+#include "nss_arch.h"
+#include "nss_drv_strings.h"
 
 #if NSS_MAX_CORES > 2	/* see comment in nss_fw_coredump_notify */
 #error	too many NSS Cores: should be 1 or 2
 #endif
 
+/*
+ * Streaming coredump
+ *	When panic is disabled, the memory of a dead core is exposed through
+ * devcoredump (/sys/class/devcoredump/devcdN/data) instead of having to be
+ * pulled out in one piece. The file is a text header with the metadata,
+ * terminated by an "end" line, followed by the memory regions listed in the
+ * header in chunks of NSS_COREDUMP_CHUNK_SIZE bytes. Each chunk starts with a
+ * struct nss_coredump_chunk and is LZ4 block compressed unless that does not
+ * make it smaller.
+ *
+ * Chunks are copied and compressed as the file is read, so collecting a
+ * dump only needs a few chunk sized buffers whatever the size of the regions.
+ */
+#define NSS_COREDUMP_CHUNK_SIZE		(64 * 1024)
+#define NSS_COREDUMP_CHUNK_MAGIC	0x4b43534e	/* "NSCK" */
+#define NSS_COREDUMP_CHUNK_LZ4		0x1		/* Data is LZ4 block compressed */
+#define NSS_COREDUMP_CHUNK_MISSING	0x2		/* Region could not be read, no data follows */
+#define NSS_COREDUMP_HDR_SIZE		(16 * 1024)
+#define NSS_COREDUMP_MAX_REGIONS	64
+
+/*
+ * LZ4 took its upstream API in 4.11; older kernels have lz4_compress(),
+ * which returns 0 on success and the compressed length through a pointer.
+ */
+#if !IS_ENABLED(CONFIG_LZ4_COMPRESS)
+#define NSS_COREDUMP_LZ4_BOUND(size)	(size)
+#elif (LINUX_VERSION_CODE < KERNEL_VERSION(4, 11, 0))
+#define NSS_COREDUMP_LZ4_BOUND(size)	lz4_compressbound(size)
+#else
+#define NSS_COREDUMP_LZ4_BOUND(size)	LZ4_COMPRESSBOUND(size)
+#endif
+
+/*
+ * devcoredump callbacks are passed a const data pointer before 4.7
+ */
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(4, 7, 0))
+typedef const void nss_coredump_data_t;
+#else
+typedef void nss_coredump_data_t;
+#endif
+
+/*
+ * Chunk header, in CPU byte order
+ */
+struct nss_coredump_chunk {
+	uint32_t magic;			/* NSS_COREDUMP_CHUNK_MAGIC */
+	uint16_t region;		/* Index of the region in the header */
+	uint16_t flags;			/* NSS_COREDUMP_CHUNK_* */
+	uint32_t offset;		/* Offset of the chunk in the region */
+	uint32_t len;			/* Uncompressed length */
+	uint32_t stored_len;		/* Length of the data following this header */
+} __attribute__((packed));
+
+/*
+ * Memory region of a core copied into the dump
+ */
+struct nss_coredump_region {
+	char name[NSS_MEMINFO_BLOCK_NAME_MAXLEN];
+					/* Region name */
+	uint32_t addr;			/* Physical address */
+	uint32_t size;			/* Size in bytes */
+	void *kern_addr;		/* Kernel address, NULL to map each chunk */
+	bool io;			/* kern_addr is I/O memory */
+};
+
+/*
+ * Dump of one core being read
+ */
+struct nss_coredump_stream {
+	struct nss_ctx_instance *nss_ctx;
+	struct mutex lock;		/* Serializes readers */
+	struct nss_coredump_region region[NSS_COREDUMP_MAX_REGIONS];
+	uint32_t num_regions;		/* Number of regions */
+	char *hdr;			/* Text header */
+	size_t hdr_len;			/* Length of the text header */
+	void *src;			/* Uncompressed chunk */
+	void *out;			/* Chunk header and stored chunk */
+	void *wrkmem;			/* LZ4 work memory */
+	char *frame;			/* Frame being read: hdr or out */
+	size_t frame_len;		/* Length of the frame */
+	loff_t frame_start;		/* File offset of the frame */
+	uint32_t next_region;		/* Region of the next chunk */
+	uint32_t next_offset;		/* Offset of the next chunk in its region */
+};
+
 static struct delayed_work coredump_queuewait;
 static struct workqueue_struct *coredump_workqueue;
+static struct work_struct coredump_stream_work[NSS_MAX_CORES];
 
 /*
  * nss_coredump_wait()
@@ -43,9 +134,339 @@ static struct workqueue_struct *coredump_workqueue;
  */
 static void nss_coredump_wait(struct work_struct *work)
 {
+	/*
+	 * Panic is disabled: leave the system up for the dump to be collected.
+	 */
+	if (nss_cmd_buf.coredump & 0xFFFFFFFE)
+		return;
+
 	panic("did not get all coredump finished signals\n");
 }
 
+/*
+ * nss_coredump_stream_add_region()
+ *	Add a memory region to a dump.
+ */
+static void nss_coredump_stream_add_region(struct nss_coredump_stream *s, const char *name,
+				uint32_t addr, uint32_t size, void *kern_addr, bool io)
+{
+	struct nss_coredump_region *r;
+
+	if (!size || s->num_regions == NSS_COREDUMP_MAX_REGIONS)
+		return;
+
+	r = &s->region[s->num_regions++];
+	snprintf(r->name, sizeof(r->name), "%.*s", (int)sizeof(r->name) - 1, name);
+	r->addr = addr;
+	r->size = size;
+	r->kern_addr = kern_addr;
+	r->io = io;
+}
+
+/*
+ * nss_coredump_stream_add_regions()
+ *	Collect the firmware DDR and the IMEM/SDRAM blocks handed to a core.
+ */
+static void nss_coredump_stream_add_regions(struct nss_coredump_stream *s)
+{
+	struct nss_ctx_instance *nss_ctx = s->nss_ctx;
+	struct nss_meminfo_ctx *mem_ctx = &nss_ctx->meminfo_ctx;
+	struct nss_meminfo_request *requests = mem_ctx->meminfo_map.requests;
+	struct nss_meminfo_block *b;
+	struct nss_mmu_ddr_info coreinfo;
+	uint32_t ddr_size;
+
+	/*
+	 * The reserved DDR is split among the cores the same way as the heap.
+	 */
+	ddr_size = nss_core_ddr_info(&coreinfo);
+	nss_coredump_stream_add_region(s, "ddr", nss_ctx->load,
+			ddr_size / max_t(uint32_t, nss_top_main.num_nss, 1), NULL, false);
+
+	for (b = mem_ctx->block_lists[NSS_MEMINFO_MEMTYPE_IMEM].head; b; b = b->next)
+		nss_coredump_stream_add_region(s, requests ? requests[b->index].name : "imem",
+				b->dma_addr, b->size, b->kern_addr, true);
+
+	for (b = mem_ctx->block_lists[NSS_MEMINFO_MEMTYPE_SDRAM].head; b; b = b->next)
+		nss_coredump_stream_add_region(s, requests ? requests[b->index].name : "sdram",
+				b->dma_addr, b->size, b->kern_addr, false);
+}
+
+/*
+ * nss_coredump_stream_header()
+ *	Format the metadata of a dump: firmware, ring indices and driver stats.
+ */
+static size_t nss_coredump_stream_header(struct nss_coredump_stream *s)
+{
+	struct nss_ctx_instance *nss_ctx = s->nss_ctx;
+	struct nss_if_mem_map *if_map = nss_ctx->meminfo_ctx.if_map;
+	char *buf = s->hdr;
+	size_t len = 0;
+	size_t size = NSS_COREDUMP_HDR_SIZE;
+	uint32_t i;
+
+	len += scnprintf(buf + len, size - len, "nss coredump\n");
+	len += scnprintf(buf + len, size - len, "core: %u\n", nss_ctx->id);
+	len += scnprintf(buf + len, size - len, "state: 0x%x\n", nss_ctx->state);
+	len += scnprintf(buf + len, size - len, "fw_size: %u\n", nss_ctx->fw_size);
+	len += scnprintf(buf + len, size - len, "fw_crc32: 0x%08x\n", nss_ctx->fw_crc);
+	len += scnprintf(buf + len, size - len, "load_addr: 0x%08x\n", nss_ctx->load);
+	len += scnprintf(buf + len, size - len, "chunk_size: %u\n", NSS_COREDUMP_CHUNK_SIZE);
+	len += scnprintf(buf + len, size - len, "compression: %s\n",
+			IS_ENABLED(CONFIG_LZ4_COMPRESS) ? "lz4" : "none");
+
+	if (if_map) {
+		NSS_CORE_DMA_CACHE_MAINT((void *)if_map, sizeof(*if_map), DMA_FROM_DEVICE);
+
+		for (i = 0; i < NSS_N2H_RING_COUNT; i++) {
+			len += scnprintf(buf + len, size - len,
+					"n2h_ring %u: nss_index %u hlos_index %u desc_count %u\n",
+					i, if_map->n2h_nss_index[i], nss_ctx->n2h_desc_ring[i].hlos_index,
+					nss_ctx->n2h_desc_ring[i].desc_count);
+		}
+
+		for (i = 0; i < NSS_H2N_RING_COUNT; i++) {
+			len += scnprintf(buf + len, size - len,
+					"h2n_ring %u: nss_index %u hlos_index %u desc_count %u pending %u\n",
+					i, if_map->h2n_nss_index[i], nss_ctx->h2n_desc_rings[i].hlos_index,
+					nss_ctx->h2n_desc_rings[i].desc_count, nss_ctx->h2n_desc_rings[i].pending);
+		}
+	}
+
+	for (i = 0; i < NSS_DRV_STATS_MAX; i++) {
+		len += scnprintf(buf + len, size - len, "drv %s: %llu\n",
+				nss_drv_strings_stats[i].stats_name,
+				NSS_PKT_STATS_READ(&nss_top_main.stats_drv[i]));
+	}
+
+	for (i = 0; i < s->num_regions; i++) {
+		len += scnprintf(buf + len, size - len, "region %u: %s addr 0x%08x size %u\n",
+				i, s->region[i].name, s->region[i].addr, s->region[i].size);
+	}
+
+	len += scnprintf(buf + len, size - len, "end\n");
+	return len;
+}
+
+/*
+ * nss_coredump_stream_copy()
+ *	Copy part of a region into the chunk buffer.
+ */
+static bool nss_coredump_stream_copy(struct nss_coredump_stream *s, struct nss_coredump_region *r,
+				uint32_t offset, uint32_t len)
+{
+	void __iomem *mem;
+
+	if (r->kern_addr && r->io) {
+		memcpy_fromio(s->src, (void __iomem *)r->kern_addr + offset, len);
+		return true;
+	}
+
+	if (r->kern_addr) {
+		dma_sync_single_for_cpu(s->nss_ctx->dev, r->addr + offset, len, DMA_FROM_DEVICE);
+		memcpy(s->src, r->kern_addr + offset, len);
+		return true;
+	}
+
+	/*
+	 * Memory not mapped by the host is mapped one chunk at a time.
+	 */
+	mem = ioremap_nocache(r->addr + offset, len);
+	if (!mem)
+		return false;
+
+	memcpy_fromio(s->src, mem, len);
+	iounmap(mem);
+	return true;
+}
+
+/*
+ * nss_coredump_stream_compress()
+ *	LZ4 compress the chunk of len bytes in s->src to dst.
+ *
+ * Returns the compressed length, or 0 if the chunk has to be stored as is.
+ */
+static int nss_coredump_stream_compress(struct nss_coredump_stream *s, void *dst, uint32_t len)
+{
+#if !IS_ENABLED(CONFIG_LZ4_COMPRESS)
+	return 0;
+#elif (LINUX_VERSION_CODE < KERNEL_VERSION(4, 11, 0))
+	size_t stored;
+
+	if (lz4_compress(s->src, len, dst, &stored, s->wrkmem))
+		return 0;
+
+	return stored;
+#else
+	return LZ4_compress_default(s->src, dst, len, NSS_COREDUMP_LZ4_BOUND(NSS_COREDUMP_CHUNK_SIZE), s->wrkmem);
+#endif
+}
+
+/*
+ * nss_coredump_stream_next()
+ *	Produce the next chunk; false once all regions have been read.
+ */
+static bool nss_coredump_stream_next(struct nss_coredump_stream *s)
+{
+	struct nss_coredump_chunk *c = s->out;
+	struct nss_coredump_region *r;
+	uint32_t len;
+	int stored = 0;
+
+	while (s->next_region < s->num_regions && s->next_offset >= s->region[s->next_region].size) {
+		s->next_region++;
+		s->next_offset = 0;
+	}
+
+	if (s->next_region == s->num_regions)
+		return false;
+
+	r = &s->region[s->next_region];
+	len = min_t(uint32_t, r->size - s->next_offset, NSS_COREDUMP_CHUNK_SIZE);
+
+	c->magic = NSS_COREDUMP_CHUNK_MAGIC;
+	c->region = s->next_region;
+	c->offset = s->next_offset;
+	c->len = len;
+	c->flags = 0;
+
+	if (!nss_coredump_stream_copy(s, r, s->next_offset, len)) {
+		c->flags = NSS_COREDUMP_CHUNK_MISSING;
+		c->stored_len = 0;
+		goto done;
+	}
+
+	stored = nss_coredump_stream_compress(s, s->out + sizeof(*c), len);
+	if (stored > 0 && (uint32_t)stored < len) {
+		c->flags = NSS_COREDUMP_CHUNK_LZ4;
+		c->stored_len = stored;
+	} else {
+		memcpy(s->out + sizeof(*c), s->src, len);
+		c->stored_len = len;
+	}
+
+done:
+	s->next_offset += len;
+	s->frame = s->out;
+	s->frame_len = sizeof(*c) + c->stored_len;
+	return true;
+}
+
+/*
+ * nss_coredump_stream_rewind()
+ *	Restart a dump from its header.
+ */
+static void nss_coredump_stream_rewind(struct nss_coredump_stream *s)
+{
+	s->frame = s->hdr;
+	s->frame_len = s->hdr_len;
+	s->frame_start = 0;
+	s->next_region = 0;
+	s->next_offset = 0;
+}
+
+/*
+ * nss_coredump_stream_read()
+ *	devcoredump read callback.
+ *
+ * Readers go through the file in order; reading backwards restarts the
+ * dump, which costs another pass over the regions but no extra memory.
+ */
+static ssize_t nss_coredump_stream_read(char *buffer, loff_t offset, size_t count, nss_coredump_data_t *data, size_t datalen)
+{
+	struct nss_coredump_stream *s = (struct nss_coredump_stream *)data;
+	ssize_t copied;
+
+	mutex_lock(&s->lock);
+
+	if (offset < s->frame_start)
+		nss_coredump_stream_rewind(s);
+
+	while (offset >= s->frame_start + s->frame_len) {
+		s->frame_start += s->frame_len;
+		s->frame_len = 0;
+		if (!nss_coredump_stream_next(s)) {
+			mutex_unlock(&s->lock);
+			return 0;
+		}
+	}
+
+	copied = min_t(size_t, count, s->frame_start + s->frame_len - offset);
+	memcpy(buffer, s->frame + (offset - s->frame_start), copied);
+
+	mutex_unlock(&s->lock);
+	return copied;
+}
+
+/*
+ * nss_coredump_stream_free()
+ *	devcoredump free callback, also used on allocation failure.
+ */
+static void nss_coredump_stream_free(nss_coredump_data_t *data)
+{
+	struct nss_coredump_stream *s = (struct nss_coredump_stream *)data;
+
+	vfree(s->wrkmem);
+	vfree(s->out);
+	vfree(s->src);
+	vfree(s->hdr);
+	vfree(s);
+}
+
+/*
+ * nss_coredump_stream_work()
+ *	Publish the dump of a core through devcoredump.
+ */
+static void nss_coredump_stream_work(struct work_struct *work)
+{
+	struct nss_ctx_instance *nss_ctx = &nss_top_main.nss[work - coredump_stream_work];
+	struct nss_coredump_stream *s;
+	size_t datalen;
+	uint32_t i;
+
+	s = vzalloc(sizeof(*s));
+	if (!s) {
+		nss_warning("%px: no memory for coredump stream\n", nss_ctx);
+		return;
+	}
+
+	s->nss_ctx = nss_ctx;
+	mutex_init(&s->lock);
+	s->hdr = vmalloc(NSS_COREDUMP_HDR_SIZE);
+	s->src = vmalloc(NSS_COREDUMP_CHUNK_SIZE);
+	s->out = vmalloc(sizeof(struct nss_coredump_chunk) + NSS_COREDUMP_LZ4_BOUND(NSS_COREDUMP_CHUNK_SIZE));
+#if IS_ENABLED(CONFIG_LZ4_COMPRESS)
+	s->wrkmem = vmalloc(LZ4_MEM_COMPRESS);
+	if (!s->wrkmem)
+		goto fail;
+#endif
+	if (!s->hdr || !s->src || !s->out)
+		goto fail;
+
+	nss_coredump_stream_add_regions(s);
+	s->hdr_len = nss_coredump_stream_header(s);
+	nss_coredump_stream_rewind(s);
+
+	/*
+	 * Upper bound of the file size; reads stop at the last chunk.
+	 */
+	datalen = s->hdr_len;
+	for (i = 0; i < s->num_regions; i++) {
+		datalen += s->region[i].size;
+		datalen += DIV_ROUND_UP(s->region[i].size, NSS_COREDUMP_CHUNK_SIZE) * sizeof(struct nss_coredump_chunk);
+	}
+
+	nss_info_always("%px: NSS core %u dump of %zu bytes in %u regions available through devcoredump\n",
+			nss_ctx, nss_ctx->id, datalen, s->num_regions);
+	dev_coredumpm(nss_ctx->dev, THIS_MODULE, s, datalen, GFP_KERNEL,
+			nss_coredump_stream_read, nss_coredump_stream_free);
+	return;
+
+fail:
+	nss_warning("%px: no memory for coredump stream buffers\n", nss_ctx);
+	nss_coredump_stream_free(s);
+}
+
 /*
  * nss_coredump_init_delay_work()
  *	set a wait function in case coredump finish interrupt lost or
@@ -53,6 +474,11 @@ static void nss_coredump_wait(struct work_struct *work)
  */
 int nss_coredump_init_delay_work(void)
 {
+	int i;
+
+	for (i = 0; i < NSS_MAX_CORES; i++)
+		INIT_WORK(&coredump_stream_work[i], nss_coredump_stream_work);
+
 	coredump_workqueue = create_singlethread_workqueue("coredump_wait");
 	if (!coredump_workqueue) {
 		nss_warning("can't set wait: hopefully all int will come\n");
@@ -137,6 +563,7 @@ void nss_fw_coredump_notify(struct nss_ctx_instance *nss_own,
 	struct nss_log_entry *nle_init, *nle_print;
 	dma_addr_t dma_addr;
 	uint32_t offset, index;
+	bool sync = false;
 
 	nss_warning("%px: COREDUMP %x Baddr %px stat %x",
 			nss_own, intr, nss_own->nmap, nss_own->state);
@@ -144,6 +571,13 @@ void nss_fw_coredump_notify(struct nss_ctx_instance *nss_own,
 	queue_delayed_work(coredump_workqueue, &coredump_queuewait,
 			msecs_to_jiffies(3456));
 
+	/*
+	 * The IPv4 connections accelerated by this core are gone with it.
+	 */
+	if (nss_own->id == nss_top_main.ipv4_handler_id) {
+		nss_ipv4_flow_flush();
+	}
+
 	/*
 	 * If external log buffer is not set, use the nss initial log buffer.
 	 */
@@ -152,9 +586,15 @@ void nss_fw_coredump_notify(struct nss_ctx_instance *nss_own,
 	if (!nld) {
 		nld = nss_own->meminfo_ctx.logbuffer;
 		dma_addr = nss_own->meminfo_ctx.logbuffer_dma;
+		sync = true;
 	}
 
-	dma_sync_single_for_cpu(NULL, dma_addr, sizeof(struct nss_log_descriptor), DMA_FROM_DEVICE);
+	/*
+	 * The external log buffer is coherent memory; only the initial one is streaming DMA.
+	 */
+	if (sync) {
+		dma_sync_single_for_cpu(NULL, dma_addr, sizeof(struct nss_log_descriptor), DMA_FROM_DEVICE);
+	}
 
 	/*
 	 * If the current entry is smaller than or equal to the number of NSS_LOG_COREDUMP_LINE_NUM,
@@ -179,10 +619,12 @@ void nss_fw_coredump_notify(struct nss_ctx_instance *nss_own,
 			index = 0;
 		}
 
-		offset = (index * sizeof(struct nss_log_entry))
-			+ offsetof(struct nss_log_descriptor, log_ring_buffer);
-		dma_sync_single_for_cpu(NULL, dma_addr + offset,
-				sizeof(struct nss_log_entry), DMA_FROM_DEVICE);
+		if (sync) {
+			offset = (index * sizeof(struct nss_log_entry))
+				+ offsetof(struct nss_log_descriptor, log_ring_buffer);
+			dma_sync_single_for_cpu(NULL, dma_addr + offset,
+					sizeof(struct nss_log_entry), DMA_FROM_DEVICE);
+		}
 		nss_info_always("%px: %s\n", nss_own, nle_print->message);
 		nle_print++;
 	}
@@ -190,6 +632,12 @@ void nss_fw_coredump_notify(struct nss_ctx_instance *nss_own,
 	if (nss_own->state & NSS_CORE_STATE_PANIC)
 		return;
 
+	/*
+	 * Panic is disabled: stream the dump of this core to user space.
+	 */
+	if (nss_cmd_buf.coredump & 0xFFFFFFFE)
+		schedule_work(&coredump_stream_work[nss_own->id]);
+
 	/*
 	 * We need to wait until all other cores finish their dump.
 	 */
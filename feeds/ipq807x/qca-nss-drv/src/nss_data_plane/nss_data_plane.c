@@ -160,6 +160,7 @@ static netdev_tx_t __nss_data_plane_buf(struct nss_dp_data_plane_ctx *dpc, struc
 	int extra_tail = 0;
 	nss_tx_status_t status;
 	struct net_device *dev = dpc->dev;
+	bool xmit_more = nss_core_skb_xmit_more(skb);
 
 	if (skb->len < ETH_HLEN) {
 		nss_warning("skb->len ( %u ) < ETH_HLEN ( %u ) \n", skb->len, ETH_HLEN);
@@ -192,7 +193,7 @@ static netdev_tx_t __nss_data_plane_buf(struct nss_dp_data_plane_ctx *dpc, struc
 		}
 	}
 
-	status = nss_phys_if_buf(dp->nss_ctx, skb, dp->if_num);
+	status = nss_phys_if_buf_more(dp->nss_ctx, skb, dp->if_num, xmit_more);
 	if (likely(status == NSS_TX_SUCCESS)) {
 		return NETDEV_TX_OK;
 	} else if (status == NSS_TX_FAILURE_QUEUE) {
@@ -203,6 +204,14 @@ drop:
 	dev_kfree_skb_any(skb);
 	dev->stats.tx_dropped++;
 
+	/*
+	 * The stack will not call us again for this burst; publish what
+	 * earlier packets of the burst left behind.
+	 */
+	if (!xmit_more) {
+		nss_phys_if_buf_flush(dp->nss_ctx);
+	}
+
 	return NETDEV_TX_OK;
 }
 
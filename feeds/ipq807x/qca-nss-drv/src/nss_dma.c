@@ -498,4 +498,5 @@ EXPORT_SYMBOL(nss_dma_notify_unregister);
 void nss_dma_init(void)
 {
 	nss_dma_register_sysctl();
+	nss_dma_copy_init();
 }
@@ -0,0 +1,330 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/*
+ * nss_dma_copy.c
+ *	NSS DMA asynchronous copy APIs
+ *
+ * The NSS DMA firmware only linearizes and splits packets it already owns,
+ * so host buffers are copied by a DMA engine channel with the DMA_MEMCPY
+ * capability, requested from the kernel dmaengine framework at init. Each
+ * segment of a job is one engine descriptor. Segments the engine cannot
+ * take (no capable channel, short segments, memory that cannot be mapped,
+ * descriptor shortage) are copied by the CPU instead, unless the job asks
+ * for the engine only.
+ *
+ * A job completes once all of its segments are done. Its callback always
+ * runs from the copy workqueue, which also releases the DMA mappings.
+ */
+
+#include <linux/dmaengine.h>
+#include <linux/dma-mapping.h>
+#include "nss_core.h"
+
+#define NSS_DMA_COPY_OFFLOAD_MIN 512	/* Segments shorter than this are cheaper to copy on the CPU */
+
+static struct workqueue_struct *nss_dma_copy_wq;
+static struct dma_chan *nss_dma_copy_chan;
+
+/*
+ * nss_dma_copy_verify()
+ *	Verify the segments of a copy.
+ */
+static bool nss_dma_copy_verify(struct nss_dma_copy_seg *segs, uint16_t num_segs)
+{
+	uint16_t i;
+
+	if (!segs || !num_segs || (num_segs > NSS_DMA_COPY_SEG_MAX)) {
+		return false;
+	}
+
+	for (i = 0; i < num_segs; i++) {
+		if (segs[i].len && (!segs[i].dst || !segs[i].src)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * nss_dma_copy_cpu()
+ *	Copy the segments on the host.
+ */
+static inline void nss_dma_copy_cpu(struct nss_dma_copy_seg *segs, uint16_t num_segs)
+{
+	uint16_t i;
+
+	for (i = 0; i < num_segs; i++) {
+		memcpy(segs[i].dst, segs[i].src, segs[i].len);
+	}
+}
+
+/*
+ * nss_dma_copy_put()
+ *	Drop a reference on a job; the last one queues its completion.
+ */
+static inline void nss_dma_copy_put(struct nss_dma_copy_job *job)
+{
+	if (atomic_dec_and_test(&job->pending)) {
+		queue_work(nss_dma_copy_wq, &job->work);
+	}
+}
+
+/*
+ * nss_dma_copy_engine_done()
+ *	Engine completion of one segment.
+ */
+static void nss_dma_copy_engine_done(void *param)
+{
+	nss_dma_copy_put((struct nss_dma_copy_job *)param);
+}
+
+/*
+ * nss_dma_copy_unmap()
+ *	Release the DMA mappings of segment i.
+ */
+static void nss_dma_copy_unmap(struct nss_dma_copy_job *job, uint16_t i)
+{
+	struct device *dev = nss_dma_copy_chan->device->dev;
+
+	dma_unmap_single(dev, job->dst_addr[i], job->segs[i].len, DMA_FROM_DEVICE);
+	dma_unmap_single(dev, job->src_addr[i], job->segs[i].len, DMA_TO_DEVICE);
+	job->mapped &= ~BIT(i);
+}
+
+/*
+ * nss_dma_copy_engine()
+ *	Hand segment i to the engine; false if the CPU has to copy it.
+ */
+static bool nss_dma_copy_engine(struct nss_dma_copy_job *job, uint16_t i)
+{
+	struct nss_dma_copy_seg *seg = &job->segs[i];
+	struct device *dev = nss_dma_copy_chan->device->dev;
+	struct dma_async_tx_descriptor *tx;
+
+	if (!virt_addr_valid(seg->src) || !virt_addr_valid(seg->dst)) {
+		return false;
+	}
+
+	job->src_addr[i] = dma_map_single(dev, (void *)seg->src, seg->len, DMA_TO_DEVICE);
+	if (unlikely(dma_mapping_error(dev, job->src_addr[i]))) {
+		return false;
+	}
+
+	job->dst_addr[i] = dma_map_single(dev, seg->dst, seg->len, DMA_FROM_DEVICE);
+	if (unlikely(dma_mapping_error(dev, job->dst_addr[i]))) {
+		dma_unmap_single(dev, job->src_addr[i], seg->len, DMA_TO_DEVICE);
+		return false;
+	}
+
+	job->mapped |= BIT(i);
+	tx = dmaengine_prep_dma_memcpy(nss_dma_copy_chan, job->dst_addr[i], job->src_addr[i], seg->len,
+					DMA_PREP_INTERRUPT | DMA_CTRL_ACK);
+	if (unlikely(!tx)) {
+		nss_dma_copy_unmap(job, i);
+		return false;
+	}
+
+	tx->callback = nss_dma_copy_engine_done;
+	tx->callback_param = job;
+	atomic_inc(&job->pending);
+	if (unlikely(dma_submit_error(dmaengine_submit(tx)))) {
+		atomic_dec(&job->pending);
+		nss_dma_copy_unmap(job, i);
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * nss_dma_copy_work()
+ *	Complete a job whose segments are all done.
+ */
+static void nss_dma_copy_work(struct work_struct *work)
+{
+	struct nss_dma_copy_job *job = container_of(work, struct nss_dma_copy_job, work);
+	uint16_t i;
+
+	for (i = 0; job->mapped && (i < job->num_segs); i++) {
+		if (job->mapped & BIT(i)) {
+			nss_dma_copy_unmap(job, i);
+		}
+	}
+
+	/*
+	 * The callback may free or resubmit the job, it must be the last access.
+	 */
+	job->cb(job->app_data, job->status);
+}
+
+/*
+ * nss_dma_copy_job_init()
+ *	Initialize a copy job.
+ */
+void nss_dma_copy_job_init(struct nss_dma_copy_job *job, struct nss_dma_copy_seg *segs, uint16_t num_segs,
+			uint32_t flags, nss_dma_copy_callback_t cb, void *app_data)
+{
+	INIT_WORK(&job->work, nss_dma_copy_work);
+	job->segs = segs;
+	job->num_segs = num_segs;
+	job->flags = flags;
+	atomic_set(&job->pending, 0);
+	job->cb = cb;
+	job->app_data = app_data;
+}
+EXPORT_SYMBOL(nss_dma_copy_job_init);
+
+/*
+ * nss_dma_copy_submit()
+ *	Queue a copy job.
+ */
+int nss_dma_copy_submit(struct nss_dma_copy_job *job)
+{
+	bool offload = false;
+	uint16_t i;
+
+	if (unlikely(!nss_dma_copy_wq)) {
+		return -ENODEV;
+	}
+
+	if (!job->cb || !nss_dma_copy_verify(job->segs, job->num_segs)
+		|| ((job->flags & NSS_DMA_COPY_FLAG_CPU) && (job->flags & NSS_DMA_COPY_FLAG_OFFLOAD))) {
+		nss_warning("%px: invalid DMA copy job\n", job);
+		return -EINVAL;
+	}
+
+	if ((job->flags & NSS_DMA_COPY_FLAG_OFFLOAD) && !nss_dma_copy_chan) {
+		return -EOPNOTSUPP;
+	}
+
+	if (atomic_read(&job->pending) || work_pending(&job->work)) {
+		nss_warning("%px: DMA copy job already queued\n", job);
+		return -EBUSY;
+	}
+
+	/*
+	 * The submitter holds a reference so that the job cannot complete
+	 * from under this loop.
+	 */
+	atomic_set(&job->pending, 1);
+	job->mapped = 0;
+	job->status = 0;
+
+	for (i = 0; i < job->num_segs; i++) {
+		struct nss_dma_copy_seg *seg = &job->segs[i];
+
+		if (!seg->len) {
+			continue;
+		}
+
+		if (nss_dma_copy_chan && !(job->flags & NSS_DMA_COPY_FLAG_CPU)
+			&& ((seg->len >= NSS_DMA_COPY_OFFLOAD_MIN) || (job->flags & NSS_DMA_COPY_FLAG_OFFLOAD))) {
+			if (nss_dma_copy_engine(job, i)) {
+				offload = true;
+				continue;
+			}
+
+			if (job->flags & NSS_DMA_COPY_FLAG_OFFLOAD) {
+				job->status = -EIO;
+				break;
+			}
+		}
+
+		nss_dma_copy_cpu(seg, 1);
+	}
+
+	if (offload) {
+		dma_async_issue_pending(nss_dma_copy_chan);
+	}
+
+	nss_dma_copy_put(job);
+	return 0;
+}
+EXPORT_SYMBOL(nss_dma_copy_submit);
+
+/*
+ * nss_dma_copy()
+ *	Copy the segments in the caller context.
+ */
+int nss_dma_copy(struct nss_dma_copy_seg *segs, uint16_t num_segs)
+{
+	if (!nss_dma_copy_verify(segs, num_segs)) {
+		return -EINVAL;
+	}
+
+	nss_dma_copy_cpu(segs, num_segs);
+	return 0;
+}
+EXPORT_SYMBOL(nss_dma_copy);
+
+/*
+ * nss_dma_copy_has_offload()
+ *	Return true if copy jobs can be offloaded to a DMA engine.
+ */
+bool nss_dma_copy_has_offload(void)
+{
+	return nss_dma_copy_chan != NULL;
+}
+EXPORT_SYMBOL(nss_dma_copy_has_offload);
+
+/*
+ * nss_dma_copy_init()
+ *	Create the copy job workqueue and look for a memcpy capable DMA channel.
+ */
+void nss_dma_copy_init(void)
+{
+	dma_cap_mask_t mask;
+
+	nss_dma_copy_wq = alloc_workqueue("nss_dma_copy", WQ_UNBOUND | WQ_MEM_RECLAIM, 0);
+	if (!nss_dma_copy_wq) {
+		nss_warning("DMA copy workqueue allocation failed\n");
+		return;
+	}
+
+	dma_cap_zero(mask);
+	dma_cap_set(DMA_MEMCPY, mask);
+	nss_dma_copy_chan = dma_request_channel(mask, NULL, NULL);
+	if (!nss_dma_copy_chan) {
+		nss_info("no memcpy capable DMA channel, copy jobs use the CPU\n");
+		return;
+	}
+
+	nss_info("DMA copy jobs offloaded to %s\n", dma_chan_name(nss_dma_copy_chan));
+}
+
+/*
+ * nss_dma_copy_exit()
+ *	Drain the queued jobs, destroy the workqueue and release the channel.
+ *
+ * Users of the copy APIs are modules depending on this one, so they have
+ * waited for their jobs before the driver can be unloaded.
+ */
+void nss_dma_copy_exit(void)
+{
+	if (!nss_dma_copy_wq) {
+		return;
+	}
+
+	destroy_workqueue(nss_dma_copy_wq);
+	nss_dma_copy_wq = NULL;
+
+	if (nss_dma_copy_chan) {
+		dma_release_channel(nss_dma_copy_chan);
+		nss_dma_copy_chan = NULL;
+	}
+}
@@ -25,6 +25,7 @@
 static ssize_t nss_drv_stats_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos)
 {
 	int32_t i;
+	uint64_t recycle_total;
 
 	/*
 	 * Max output lines = #stats * NSS_MAX_CORES  +
@@ -56,6 +57,13 @@ static ssize_t nss_drv_stats_read(struct file *fp, char __user *ubuf, size_t sz,
 
 	size_wr += nss_stats_print("drv", NULL, NSS_STATS_SINGLE_INSTANCE, nss_drv_strings_stats, stats_shadow, NSS_DRV_STATS_MAX, lbuf, size_wr, size_al);
 
+	/*
+	 * Share of empty buffer refills served by the recycle cache.
+	 */
+	recycle_total = stats_shadow[NSS_DRV_STATS_TX_EMPTY_RECYCLE_HIT] + stats_shadow[NSS_DRV_STATS_TX_EMPTY_RECYCLE_MISS];
+	size_wr += scnprintf(lbuf + size_wr, size_al - size_wr, "\tdrv_tx_empty_recycle_ratio = %llu%%\n",
+			recycle_total ? div64_u64(stats_shadow[NSS_DRV_STATS_TX_EMPTY_RECYCLE_HIT] * 100, recycle_total) : 0);
+
 	bytes_read = simple_read_from_buffer(ubuf, sz, ppos, lbuf, strlen(lbuf));
 	kfree(lbuf);
 	kfree(stats_shadow);
@@ -63,11 +71,103 @@ static ssize_t nss_drv_stats_read(struct file *fp, char __user *ubuf, size_t sz,
 	return bytes_read;
 }
 
+/*
+ * nss_drv_stats_bin_read()
+ *	Read HLOS driver stats in binary form.
+ */
+static ssize_t nss_drv_stats_bin_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos)
+{
+	size_t size_al, size_wr;
+	ssize_t bytes_read;
+	uint64_t *counters;
+	char *buf;
+	int32_t i;
+
+	buf = nss_stats_bin_alloc(1, NSS_DRV_STATS_MAX, &size_al, &size_wr);
+	if (unlikely(!buf)) {
+		return 0;
+	}
+
+	counters = nss_stats_bin_add_block(buf, &size_wr, size_al, NSS_DRV_STATS_MAX);
+	if (unlikely(!counters)) {
+		goto done;
+	}
+
+	for (i = 0; i < NSS_DRV_STATS_MAX; i++) {
+		counters[i] = NSS_PKT_STATS_READ(&nss_top_main.stats_drv[i]);
+	}
+
+done:
+	bytes_read = simple_read_from_buffer(ubuf, sz, ppos, buf, size_wr);
+	kfree(buf);
+
+	return bytes_read;
+}
+
 /*
  * drv_stats_ops
  */
 NSS_STATS_DECLARE_FILE_OPERATIONS(drv);
 
+/*
+ * drv_stats_bin_ops
+ */
+NSS_STATS_BIN_DECLARE_FILE_OPERATIONS(drv);
+
+/*
+ * nss_n2h_napi_stats_read()
+ *	Read the adaptive NAPI state of the N2H queues.
+ */
+static ssize_t nss_n2h_napi_stats_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos)
+{
+	/*
+	 * Each queue prints one line about twice NSS_STATS_MAX_STR_LENGTH long
+	 */
+	uint32_t max_output_lines = (NSS_IF_N2H_DATA_QUEUE_3 + 1) * 2 * NSS_MAX_CORES + NSS_STATS_EXTRA_OUTPUT_LINES;
+	size_t size_al = NSS_STATS_MAX_STR_LENGTH * max_output_lines;
+	size_t size_wr = 0;
+	ssize_t bytes_read = 0;
+	struct nss_core_napi_adapt adapt;
+	int core, qid;
+
+	char *lbuf = kzalloc(size_al, GFP_KERNEL);
+	if (unlikely(lbuf == NULL)) {
+		nss_warning("Could not allocate memory for local statistics buffer");
+		return 0;
+	}
+
+	size_wr += nss_stats_banner(lbuf, size_wr, size_al, "n2h_napi", NSS_STATS_SINGLE_CORE);
+	size_wr += scnprintf(lbuf + size_wr, size_al - size_wr, "adaptive napi %s\n\n",
+				nss_core_get_napi_adapt() ? "enabled" : "disabled");
+
+	for (core = 0; core < nss_top_main.num_nss; core++) {
+		for (qid = NSS_IF_N2H_EMPTY_BUFFER_RETURN_QUEUE; qid <= NSS_IF_N2H_DATA_QUEUE_3; qid++) {
+			/*
+			 * The state is only updated from the queue's NAPI context; a torn
+			 * snapshot is good enough for reporting.
+			 */
+			adapt = nss_top_main.nss[core].n2h_desc_ring[qid].adapt;
+			size_wr += scnprintf(lbuf + size_wr, size_al - size_wr,
+					"core%d queue%d: level %u weight %d linger %u backlog_avg %u backlog_max %u"
+					" level_up %llu level_down %llu linger_polls %llu irq_enable %llu\n",
+					core, qid, adapt.level, nss_core_napi_level_weight(adapt.level),
+					nss_core_napi_level_linger(adapt.level),
+					adapt.backlog_avg >> NSS_CORE_NAPI_ADAPT_AVG_SHIFT, adapt.backlog_max,
+					adapt.level_up, adapt.level_down, adapt.linger_polls, adapt.irq_enable);
+		}
+	}
+
+	bytes_read = simple_read_from_buffer(ubuf, sz, ppos, lbuf, strlen(lbuf));
+	kfree(lbuf);
+
+	return bytes_read;
+}
+
+/*
+ * n2h_napi_stats_ops
+ */
+NSS_STATS_DECLARE_FILE_OPERATIONS(n2h_napi);
+
 /*
  * nss_drv_stats_dentry_create()
  *	Create DRV statistics debug entry.
@@ -75,12 +175,19 @@ NSS_STATS_DECLARE_FILE_OPERATIONS(drv);
 void nss_drv_stats_dentry_create(void)
 {
 	nss_stats_create_dentry("drv", &nss_drv_stats_ops);
+	nss_stats_bin_create_dentry("drv", &nss_drv_stats_bin_ops);
+	nss_stats_create_dentry("n2h_napi", &nss_n2h_napi_stats_ops);
 }
 
 /*
  * TODO: Move this (nss_wt_stats_read) function to new file (nss_wt_stats.c)
  */
 
+/*
+ * Statistics domain for worker thread statistics; the project message handler updates under it.
+ */
+struct nss_stats_domain nss_wt_stats_domain = NSS_STATS_DOMAIN_INIT(nss_wt_stats_domain);
+
 /*
  * nss_wt_stats_read()
  *	Reads and formats worker thread statistics and outputs them to ubuf
@@ -117,9 +224,9 @@ ssize_t nss_wt_stats_read(struct file *fp, char __user *ubuf, size_t sz, loff_t
 		return 0;
 	}
 
-	spin_lock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_read_lock(&nss_wt_stats_domain);
 	if (unlikely(!nss_ctx->wt_stats)) {
-		spin_unlock_bh(&nss_top_main.stats_lock);
+		nss_stats_domain_read_unlock(&nss_wt_stats_domain);
 		nss_warning("Worker thread statistics not allocated\n");
 		kfree(lbuf);
 		kfree(shadow);
@@ -137,7 +244,7 @@ ssize_t nss_wt_stats_read(struct file *fp, char __user *ubuf, size_t sz, loff_t
 			shadow[i * irq_count + j] = nss_ctx->wt_stats[i].irq_stats[j];
 		}
 	}
-	spin_unlock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_read_unlock(&nss_wt_stats_domain);
 
 	size_wr += nss_stats_banner(lbuf, size_wr, size_al, "worker thread", NSS_STATS_SINGLE_CORE);
 	for (i = 0; i < thread_count; ++i) {
@@ -164,3 +271,74 @@ ssize_t nss_wt_stats_read(struct file *fp, char __user *ubuf, size_t sz, loff_t
 
 	return bytes_read;
 }
+
+/*
+ * nss_wt_stats_bin_read()
+ *	Reads worker thread statistics in binary form.
+ *
+ * There is one block for each thread IRQ that has run, holding
+ * NSS_WT_STATS_BIN_COUNTERS counters: thread, irq, callback, count,
+ * ticks min/avg/max and insn min/avg/max, as reported by the firmware.
+ */
+#define NSS_WT_STATS_BIN_COUNTERS 10
+
+ssize_t nss_wt_stats_bin_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos)
+{
+	struct nss_stats_data *data = fp->private_data;
+	struct nss_ctx_instance *nss_ctx = data->nss_ctx;
+	uint32_t thread_count = nss_ctx->worker_thread_count;
+	uint32_t irq_count = nss_ctx->irq_count;
+	uint32_t max_blocks = min_t(uint32_t, thread_count * irq_count, U16_MAX);
+	size_t size_al, size_wr;
+	ssize_t bytes_read;
+	uint64_t *counters;
+	char *buf;
+	int i, j;
+
+	buf = nss_stats_bin_alloc(max_blocks, max_blocks * NSS_WT_STATS_BIN_COUNTERS, &size_al, &size_wr);
+	if (unlikely(!buf)) {
+		return 0;
+	}
+
+	nss_stats_domain_read_lock(&nss_wt_stats_domain);
+	if (unlikely(!nss_ctx->wt_stats)) {
+		nss_stats_domain_read_unlock(&nss_wt_stats_domain);
+		nss_warning("Worker thread statistics not allocated\n");
+		kfree(buf);
+		return 0;
+	}
+
+	for (i = 0; i < thread_count; ++i) {
+		for (j = 0; j < irq_count; ++j) {
+			struct nss_project_irq_stats *is = &nss_ctx->wt_stats[i].irq_stats[j];
+
+			if (!is->count) {
+				continue;
+			}
+
+			counters = nss_stats_bin_add_block(buf, &size_wr, size_al, NSS_WT_STATS_BIN_COUNTERS);
+			if (unlikely(!counters)) {
+				goto unlock;
+			}
+
+			counters[0] = i;
+			counters[1] = j;
+			counters[2] = is->callback;
+			counters[3] = is->count;
+			counters[4] = is->ticks_min;
+			counters[5] = is->ticks_avg;
+			counters[6] = is->ticks_max;
+			counters[7] = is->insn_min;
+			counters[8] = is->insn_avg;
+			counters[9] = is->insn_max;
+		}
+	}
+
+unlock:
+	nss_stats_domain_read_unlock(&nss_wt_stats_domain);
+
+	bytes_read = simple_read_from_buffer(ubuf, sz, ppos, buf, size_wr);
+	kfree(buf);
+
+	return bytes_read;
+}
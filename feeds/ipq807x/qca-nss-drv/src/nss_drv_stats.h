@@ -62,6 +62,14 @@ enum NSS_DRV_STATS {
 	NSS_DRV_STATS_CHAIN_SEG_PROCESSED,	/* N2H SKB Chain Processed Count */
 	NSS_DRV_STATS_FRAG_SEG_PROCESSED,	/* N2H Frag Processed Count */
 	NSS_DRV_STATS_TX_CMD_QUEUE_FULL,	/* Tx H2N Control packets fail due to queue full */
+	NSS_DRV_STATS_TX_BURST,			/* H2N bursts published with a single index update */
+	NSS_DRV_STATS_TX_CMD_POOL_HIT,		/* H2N Control buffers taken from the command buffer pool */
+	NSS_DRV_STATS_TX_CMD_POOL_MISS,		/* H2N Control buffers allocated because the pool was empty */
+	NSS_DRV_STATS_RX_LIST,			/* N2H Packet lists delivered to the stack */
+	NSS_DRV_STATS_TX_EMPTY_RECYCLE_HIT,	/* H2N Empty buffers refilled from the recycle cache */
+	NSS_DRV_STATS_TX_EMPTY_RECYCLE_MISS,	/* H2N Empty buffers allocated because the recycle cache was empty */
+	NSS_DRV_STATS_RX_EMPTY_SOS,		/* N2H Empty buffer SOS interrupts */
+	NSS_DRV_STATS_RX_PAGED_EMPTY_SOS,	/* N2H Paged empty buffer SOS interrupts */
 #ifdef NSS_MULTI_H2N_DATA_RING_SUPPORT
 	NSS_DRV_STATS_TX_PACKET_QUEUE_0,	/* H2N Data packets on queue0 */
 	NSS_DRV_STATS_TX_PACKET_QUEUE_1,	/* H2N Data packets on queue1 */
@@ -75,6 +83,8 @@ enum NSS_DRV_STATS {
 	NSS_DRV_STATS_MAX,
 };
 
+extern struct nss_stats_domain nss_wt_stats_domain;
 extern void nss_drv_stats_dentry_create(void);
 extern ssize_t nss_wt_stats_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos);
+extern ssize_t nss_wt_stats_bin_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos);
 #endif /* __NSS_DRV_STATS_H */
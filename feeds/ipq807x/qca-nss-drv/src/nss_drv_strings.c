@@ -56,6 +56,14 @@ struct nss_stats_info nss_drv_strings_stats[NSS_DRV_STATS_MAX] = {
 	{"rx_chain_seg_processed"	, NSS_STATS_TYPE_SPECIAL},
 	{"rx_frag_seg_processed"	, NSS_STATS_TYPE_SPECIAL},
 	{"tx_buffers_cmd_queue_full"	, NSS_STATS_TYPE_ERROR},
+	{"tx_buffers_burst"		, NSS_STATS_TYPE_SPECIAL},
+	{"tx_buffers_cmd_pool_hit"	, NSS_STATS_TYPE_SPECIAL},
+	{"tx_buffers_cmd_pool_miss"	, NSS_STATS_TYPE_SPECIAL},
+	{"rx_list"			, NSS_STATS_TYPE_SPECIAL},
+	{"tx_empty_recycle_hit"		, NSS_STATS_TYPE_SPECIAL},
+	{"tx_empty_recycle_miss"	, NSS_STATS_TYPE_SPECIAL},
+	{"rx_empty_sos"			, NSS_STATS_TYPE_SPECIAL},
+	{"rx_paged_empty_sos"		, NSS_STATS_TYPE_SPECIAL},
 #ifdef NSS_MULTI_H2N_DATA_RING_SUPPORT
 	{"tx_buffers_data_queue[0]"	, NSS_STATS_TYPE_SPECIAL},
 	{"tx_buffers_data_queue[1]"	, NSS_STATS_TYPE_SPECIAL},
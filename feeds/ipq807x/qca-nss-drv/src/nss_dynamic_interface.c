@@ -27,15 +27,6 @@ ATOMIC_NOTIFIER_HEAD(nss_dynamic_interface_stats_notifier);
 
 void nss_dynamic_interface_stats_notify(uint32_t if_num, uint32_t core_id);
 
-/*
- * Message data structure to store the message result
- */
-struct nss_dynamic_interface_msg_data {
-	struct completion complete;	/* completion structure */
-	int if_num;			/* Interface number */
-	enum nss_cmn_response response;	/* Message response */
-};
-
 static nss_dynamic_interface_assigned nss_dynamic_interface_assigned_types[NSS_CORE_MAX][NSS_MAX_DYNAMIC_INTERFACES]; /* Array of assigned interface types */
 
 /*
@@ -124,24 +115,6 @@ static void nss_dynamic_interface_handler(struct nss_ctx_instance *nss_ctx, stru
 	cb((void *)ncm->app_data, ncm);
 }
 
-/*
- * nss_dynamic_interface_callback
- *	Callback to handle the message response from NSS FW.
- */
-static void nss_dynamic_interface_callback(void *app_data, struct nss_cmn_msg *ncm)
-{
-	struct nss_dynamic_interface_msg_data *di_data = (struct nss_dynamic_interface_msg_data *)app_data;
-	struct nss_dynamic_interface_msg *ndim = (struct nss_dynamic_interface_msg *)ncm;
-
-	di_data->response = ncm->response;
-	di_data->if_num = ndim->msg.alloc_node.if_num;
-
-	/*
-	 * Unblock the sleeping function.
-	 */
-	complete(&di_data->complete);
-}
-
 /*
  * nss_dynamic_interface_tx()
  * 	Transmit a dynamic interface message to NSSFW, asynchronously.
@@ -174,28 +147,26 @@ nss_tx_status_t nss_dynamic_interface_tx(struct nss_ctx_instance *nss_ctx, struc
 /*
  * nss_dynamic_interface_tx_sync()
  *	Send the message to NSS and wait till we get an ACK or NACK for this msg.
+ *
+ * copy_len bytes of the response payload are copied back to the message.
  */
-static nss_tx_status_t nss_dynamic_interface_tx_sync(struct nss_ctx_instance *nss_ctx, struct nss_dynamic_interface_msg_data *di_data,
-						     struct nss_dynamic_interface_msg *ndim)
+static nss_tx_status_t nss_dynamic_interface_tx_sync(struct nss_ctx_instance *nss_ctx, struct nss_dynamic_interface_msg *ndim,
+						     uint32_t copy_len)
 {
+	struct nss_tx_msg_txn *txn;
 	nss_tx_status_t status;
-	int ret;
 
-	status = nss_dynamic_interface_tx(nss_ctx, ndim);
-	if (status != NSS_TX_SUCCESS) {
-		nss_warning("%px: not able to transmit msg successfully\n", nss_ctx);
-		return status;
+	txn = nss_tx_msg_txn_alloc(nss_ctx, 1, 1, NSS_DYNAMIC_INTERFACE_COMP_TIMEOUT);
+	if (!txn) {
+		return NSS_TX_FAILURE;
 	}
 
-	/*
-	 * Blocking call, wait till we get ACK for this msg.
-	 */
-	ret = wait_for_completion_timeout(&di_data->complete, msecs_to_jiffies(NSS_DYNAMIC_INTERFACE_COMP_TIMEOUT));
-	if (ret == 0) {
-		nss_warning("%px: Waiting for ack timed out\n", nss_ctx);
-		return NSS_TX_FAILURE;
+	status = nss_tx_msg_txn_add(txn, (nss_tx_msg_sync_subsys_async_t)nss_dynamic_interface_tx, &ndim->cm, 0, copy_len);
+	if (status == NSS_TX_SUCCESS) {
+		status = nss_tx_msg_txn_wait(txn);
 	}
 
+	nss_tx_msg_txn_free(txn);
 	return status;
 }
 
@@ -211,7 +182,6 @@ int nss_dynamic_interface_alloc_node(enum nss_dynamic_interface_type type)
 	struct nss_ctx_instance *nss_ctx = NULL;
 	struct nss_dynamic_interface_msg ndim;
 	struct nss_dynamic_interface_alloc_node_msg *ndia;
-	struct nss_dynamic_interface_msg_data di_data;
 	uint32_t core_id;
 	nss_tx_status_t status;
 
@@ -222,12 +192,9 @@ int nss_dynamic_interface_alloc_node(enum nss_dynamic_interface_type type)
 
 	core_id = nss_top_main.dynamic_interface_table[type];
 	nss_ctx = (struct nss_ctx_instance *)&nss_top_main.nss[core_id];
-	di_data.if_num = -1;
-	di_data.response = false;
-	init_completion(&di_data.complete);
 
 	nss_dynamic_interface_msg_init(&ndim, NSS_DYNAMIC_INTERFACE, NSS_DYNAMIC_INTERFACE_ALLOC_NODE,
-				sizeof(struct nss_dynamic_interface_alloc_node_msg), nss_dynamic_interface_callback, (void *)&di_data);
+				sizeof(struct nss_dynamic_interface_alloc_node_msg), NULL, NULL);
 
 	ndia = &ndim.msg.alloc_node;
 	ndia->type = type;
@@ -241,21 +208,13 @@ int nss_dynamic_interface_alloc_node(enum nss_dynamic_interface_type type)
 	/*
 	 * Calling synchronous transmit function.
 	 */
-	status = nss_dynamic_interface_tx_sync(nss_ctx, &di_data, &ndim);
+	status = nss_dynamic_interface_tx_sync(nss_ctx, &ndim, sizeof(*ndia));
 	if (status != NSS_TX_SUCCESS) {
-		nss_warning("%px not able to transmit alloc node msg\n", nss_ctx);
+		nss_warning("%px not able to allocate node - Status:%d Response:%d\n", nss_ctx, status, ndim.cm.response);
 		return -1;
 	}
 
-	/*
-	 * Check response and return -1 if its a NACK else proceed.
-	 */
-	if (di_data.response != NSS_CMN_RESPONSE_ACK) {
-		nss_warning("%px Received NACK from NSS - Response:%d\n", nss_ctx, di_data.response);
-		return -1;
-	}
-
-	return di_data.if_num;
+	return ndia->if_num;
 }
 
 /*
@@ -271,7 +230,6 @@ nss_tx_status_t nss_dynamic_interface_dealloc_node(int if_num, enum nss_dynamic_
 	struct nss_ctx_instance *nss_ctx = NULL;
 	struct nss_dynamic_interface_msg ndim;
 	struct nss_dynamic_interface_dealloc_node_msg *ndid;
-	struct nss_dynamic_interface_msg_data di_data;
 	uint32_t core_id;
 	nss_tx_status_t status;
 
@@ -282,8 +240,6 @@ nss_tx_status_t nss_dynamic_interface_dealloc_node(int if_num, enum nss_dynamic_
 
 	core_id = nss_top_main.dynamic_interface_table[type];
 	nss_ctx = (struct nss_ctx_instance *)&nss_top_main.nss[core_id];
-	di_data.response = false;
-	init_completion(&di_data.complete);
 
 	if (nss_is_dynamic_interface(if_num) == false) {
 		nss_warning("%px: nss_dynamic_interface if_num is not in range %d\n", nss_ctx, if_num);
@@ -291,7 +247,7 @@ nss_tx_status_t nss_dynamic_interface_dealloc_node(int if_num, enum nss_dynamic_
 	}
 
 	nss_dynamic_interface_msg_init(&ndim, NSS_DYNAMIC_INTERFACE, NSS_DYNAMIC_INTERFACE_DEALLOC_NODE,
-				sizeof(struct nss_dynamic_interface_dealloc_node_msg), nss_dynamic_interface_callback, (void *)&di_data);
+				sizeof(struct nss_dynamic_interface_dealloc_node_msg), NULL, NULL);
 
 	ndid = &ndim.msg.dealloc_node;
 	ndid->type = type;
@@ -300,15 +256,9 @@ nss_tx_status_t nss_dynamic_interface_dealloc_node(int if_num, enum nss_dynamic_
 	/*
 	 * Calling synchronous transmit function.
 	 */
-	status = nss_dynamic_interface_tx_sync(nss_ctx, &di_data, &ndim);
+	status = nss_dynamic_interface_tx_sync(nss_ctx, &ndim, 0);
 	if (status != NSS_TX_SUCCESS) {
-		nss_warning("%px not able to transmit alloc node msg\n", nss_ctx);
-		return status;
-	}
-
-	if (di_data.response != NSS_CMN_RESPONSE_ACK) {
-		nss_warning("%px Received NACK from NSS\n", nss_ctx);
-		return -1;
+		nss_warning("%px not able to deallocate node - Status:%d Response:%d\n", nss_ctx, status, ndim.cm.response);
 	}
 
 	return status;
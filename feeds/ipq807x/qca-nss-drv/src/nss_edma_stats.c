@@ -27,6 +27,11 @@
  */
 ATOMIC_NOTIFIER_HEAD(nss_edma_stats_notifier);
 
+/*
+ * Statistics domain for EDMA; the metadata sync handlers update under it.
+ */
+static struct nss_stats_domain nss_edma_stats_domain = NSS_STATS_DOMAIN_INIT(nss_edma_stats_domain);
+
 struct nss_edma_stats edma_stats;
 
 /*
@@ -41,8 +46,6 @@ struct nss_edma_stats edma_stats;
  */
 static ssize_t nss_edma_port_stats_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos)
 {
-	int32_t i;
-
 	/*
 	 * Max output lines = #stats * NSS_MAX_CORES  +
 	 * few blank lines for banner printing + Number of Extra outputlines for future reference to add new stats
@@ -74,12 +77,7 @@ static ssize_t nss_edma_port_stats_read(struct file *fp, char __user *ubuf, size
 	 */
 	size_wr += scnprintf(lbuf + size_wr, size_al - size_wr, "edma port %d stats:\n\n", data->edma_id);
 
-	spin_lock_bh(&nss_top_main.stats_lock);
-	for (i = 0; (i < NSS_STATS_NODE_MAX); i++) {
-		stats_shadow[i] = edma_stats.port[data->edma_id].port_stats[i];
-	}
-
-	spin_unlock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_copy(&nss_edma_stats_domain, stats_shadow, edma_stats.port[data->edma_id].port_stats, sizeof(*stats_shadow) * NSS_STATS_NODE_MAX);
 	size_wr += nss_stats_print("edma_port", NULL, data->edma_id
 					, nss_edma_strings_stats_node
 					, stats_shadow
@@ -120,9 +118,7 @@ static ssize_t nss_edma_port_type_stats_read(struct file *fp, char __user *ubuf,
 	/*
 	 * Port type
 	 */
-	spin_lock_bh(&nss_top_main.stats_lock);
-	port_type = edma_stats.port[data->edma_id].port_type;
-	spin_unlock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_copy(&nss_edma_stats_domain, &port_type, &edma_stats.port[data->edma_id].port_type, sizeof(port_type));
 
 	size_wr += scnprintf(lbuf + size_wr, size_al - size_wr,
 					"port_type = %s\n", nss_edma_strings_stats_port_type[port_type].stats_name);
@@ -140,8 +136,6 @@ static ssize_t nss_edma_port_type_stats_read(struct file *fp, char __user *ubuf,
  */
 static ssize_t nss_edma_port_ring_map_stats_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos)
 {
-	int32_t i;
-
 	/*
 	 * max output lines = #stats + start tag line + end tag line + three blank lines
 	 */
@@ -171,12 +165,7 @@ static ssize_t nss_edma_port_ring_map_stats_read(struct file *fp, char __user *u
 	 * Port ring map
 	 */
 	size_wr += scnprintf(lbuf + size_wr, size_al - size_wr, "edma port %d ring map:\n\n", data->edma_id);
-	spin_lock_bh(&nss_top_main.stats_lock);
-	for (i = 0; i < NSS_EDMA_PORT_RING_MAP_MAX; i++) {
-		stats_shadow[i] = edma_stats.port[data->edma_id].port_ring_map[i];
-	}
-
-	spin_unlock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_copy(&nss_edma_stats_domain, stats_shadow, edma_stats.port[data->edma_id].port_ring_map, sizeof(*stats_shadow) * NSS_EDMA_PORT_RING_MAP_MAX);
 
 	size_wr += nss_stats_print("edma_port_ring", NULL, data->edma_id
 					, nss_edma_strings_stats_port_ring_map
@@ -196,8 +185,6 @@ static ssize_t nss_edma_port_ring_map_stats_read(struct file *fp, char __user *u
  */
 static ssize_t nss_edma_txring_stats_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos)
 {
-	int32_t i;
-
 	/*
 	 * max output lines = #stats + start tag line + end tag line + three blank lines
 	 */
@@ -227,12 +214,7 @@ static ssize_t nss_edma_txring_stats_read(struct file *fp, char __user *ubuf, si
 	 * Tx ring stats
 	 */
 	size_wr += scnprintf(lbuf + size_wr, size_al - size_wr, "Tx ring %d stats:\n\n", data->edma_id);
-	spin_lock_bh(&nss_top_main.stats_lock);
-	for (i = 0; i < NSS_EDMA_STATS_TX_MAX; i++) {
-		stats_shadow[i] = edma_stats.tx_stats[data->edma_id][i];
-	}
-
-	spin_unlock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_copy(&nss_edma_stats_domain, stats_shadow, edma_stats.tx_stats[data->edma_id], sizeof(*stats_shadow) * NSS_EDMA_STATS_TX_MAX);
 
 	size_wr += nss_stats_print("edma_tx_ring", NULL, data->edma_id
 					, nss_edma_strings_stats_tx
@@ -252,8 +234,6 @@ static ssize_t nss_edma_txring_stats_read(struct file *fp, char __user *ubuf, si
  */
 static ssize_t nss_edma_rxring_stats_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos)
 {
-	int32_t i;
-
 	/*
 	 * max output lines = #stats + start tag line + end tag line + three blank lines
 	 */
@@ -280,12 +260,7 @@ static ssize_t nss_edma_rxring_stats_read(struct file *fp, char __user *ubuf, si
 	/*
 	 * RX ring stats
 	 */
-	spin_lock_bh(&nss_top_main.stats_lock);
-	for (i = 0; i < NSS_EDMA_STATS_RX_MAX; i++) {
-		stats_shadow[i] = edma_stats.rx_stats[data->edma_id][i];
-	}
-
-	spin_unlock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_copy(&nss_edma_stats_domain, stats_shadow, edma_stats.rx_stats[data->edma_id], sizeof(*stats_shadow) * NSS_EDMA_STATS_RX_MAX);
 	size_wr += nss_stats_print("edma_rx_ring", NULL, data->edma_id
 					, nss_edma_strings_stats_rx
 					, stats_shadow
@@ -304,8 +279,6 @@ static ssize_t nss_edma_rxring_stats_read(struct file *fp, char __user *ubuf, si
  */
 static ssize_t nss_edma_txcmplring_stats_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos)
 {
-	int32_t i;
-
 	/*
 	 * max output lines = #stats + start tag line + end tag line + three blank lines
 	 */
@@ -335,12 +308,7 @@ static ssize_t nss_edma_txcmplring_stats_read(struct file *fp, char __user *ubuf
 	 * Tx cmpl ring stats
 	 */
 	size_wr += scnprintf(lbuf + size_wr, size_al - size_wr, "Tx cmpl ring %d stats:\n\n", data->edma_id);
-	spin_lock_bh(&nss_top_main.stats_lock);
-	for (i = 0; i < NSS_EDMA_STATS_TXCMPL_MAX; i++) {
-		stats_shadow[i] = edma_stats.txcmpl_stats[data->edma_id][i];
-	}
-
-	spin_unlock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_copy(&nss_edma_stats_domain, stats_shadow, edma_stats.txcmpl_stats[data->edma_id], sizeof(*stats_shadow) * NSS_EDMA_STATS_TXCMPL_MAX);
 	size_wr += nss_stats_print("edma_tx_cmpl_ring", NULL, data->edma_id
 					, nss_edma_strings_stats_txcmpl
 					, stats_shadow
@@ -360,8 +328,6 @@ static ssize_t nss_edma_txcmplring_stats_read(struct file *fp, char __user *ubuf
  */
 static ssize_t nss_edma_rxfillring_stats_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos)
 {
-	int32_t i;
-
 	/*
 	 * max output lines = #stats + start tag line + end tag line + three blank lines
 	 */
@@ -391,12 +357,7 @@ static ssize_t nss_edma_rxfillring_stats_read(struct file *fp, char __user *ubuf
 	 * Rx fill ring stats
 	 */
 	size_wr += scnprintf(lbuf + size_wr, size_al - size_wr, "Rx fill ring %d stats:\n\n", data->edma_id);
-	spin_lock_bh(&nss_top_main.stats_lock);
-	for (i = 0; i < NSS_EDMA_STATS_RXFILL_MAX; i++) {
-		stats_shadow[i] = edma_stats.rxfill_stats[data->edma_id][i];
-	}
-
-	spin_unlock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_copy(&nss_edma_stats_domain, stats_shadow, edma_stats.rxfill_stats[data->edma_id], sizeof(*stats_shadow) * NSS_EDMA_STATS_RXFILL_MAX);
 	size_wr += nss_stats_print("edma_rx_fill_ring", NULL
 					, NSS_STATS_SINGLE_INSTANCE
 					, nss_edma_strings_stats_rxfill
@@ -416,8 +377,6 @@ static ssize_t nss_edma_rxfillring_stats_read(struct file *fp, char __user *ubuf
  */
 static ssize_t nss_edma_err_stats_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos)
 {
-	int32_t i;
-
 	/*
 	 * max output lines = #stats + start tag line + end tag line + three blank lines
 	 */
@@ -445,12 +404,7 @@ static ssize_t nss_edma_err_stats_read(struct file *fp, char __user *ubuf, size_
 	/*
 	 * Common node stats
 	 */
-	spin_lock_bh(&nss_top_main.stats_lock);
-
-	for (i = 0; (i < NSS_EDMA_ERR_STATS_MAX); i++)
-		stats_shadow[i] = edma_stats.misc_err[i];
-
-	spin_unlock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_copy(&nss_edma_stats_domain, stats_shadow, edma_stats.misc_err, sizeof(*stats_shadow) * NSS_EDMA_ERR_STATS_MAX);
 	size_wr += nss_stats_print("edma_err", NULL, NSS_STATS_SINGLE_INSTANCE
 					, nss_edma_strings_stats_err_map
 					, stats_shadow
@@ -675,9 +629,8 @@ void nss_edma_stats_dentry_create(void)
 void nss_edma_metadata_port_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss_edma_port_stats_sync *nepss)
 {
 	uint16_t i, j = 0;
-	struct nss_top_instance *nss_top = nss_ctx->nss_top;
 
-	spin_lock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_begin(&nss_edma_stats_domain);
 
 	/*
 	 * edma port stats
@@ -701,7 +654,7 @@ void nss_edma_metadata_port_stats_sync(struct nss_ctx_instance *nss_ctx, struct
 		j++;
 	}
 
-	spin_unlock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_end(&nss_edma_stats_domain);
 }
 
 /*
@@ -711,9 +664,8 @@ void nss_edma_metadata_port_stats_sync(struct nss_ctx_instance *nss_ctx, struct
 void nss_edma_metadata_ring_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss_edma_ring_stats_sync *nerss)
 {
 	int32_t i;
-	struct nss_top_instance *nss_top = nss_ctx->nss_top;
 
-	spin_lock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_begin(&nss_edma_stats_domain);
 
 	/*
 	 * edma tx ring stats
@@ -749,7 +701,7 @@ void nss_edma_metadata_ring_stats_sync(struct nss_ctx_instance *nss_ctx, struct
 		edma_stats.rxfill_stats[i][NSS_EDMA_STATS_RXFILL_DESC] += nerss->rxfill_ring[i].desc_cnt;
 	}
 
-	spin_unlock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_end(&nss_edma_stats_domain);
 }
 
 /*
@@ -759,9 +711,7 @@ void nss_edma_metadata_ring_stats_sync(struct nss_ctx_instance *nss_ctx, struct
 void nss_edma_metadata_err_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss_edma_err_stats_sync *nerss)
 {
 
-	struct nss_top_instance *nss_top = nss_ctx->nss_top;
-
-	spin_lock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_begin(&nss_edma_stats_domain);
 
 	edma_stats.misc_err[NSS_EDMA_AXI_RD_ERR] += nerss->msg_err_stats.axi_rd_err;
 	edma_stats.misc_err[NSS_EDMA_AXI_WR_ERR] += nerss->msg_err_stats.axi_wr_err;
@@ -775,7 +725,7 @@ void nss_edma_metadata_err_stats_sync(struct nss_ctx_instance *nss_ctx, struct n
 	edma_stats.misc_err[NSS_EDMA_ALLOC_FAIL_CNT] += nerss->msg_err_stats.alloc_fail_cnt;
 	edma_stats.misc_err[NSS_EDMA_QOS_INVAL_DST_DROPS] += nerss->msg_err_stats.qos_inval_dst_drops;
 
-	spin_unlock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_end(&nss_edma_stats_domain);
 }
 
 /*
@@ -817,6 +767,6 @@ EXPORT_SYMBOL(nss_edma_stats_unregister_notifier);
  */
 void nss_edma_get_stats(uint64_t  *stats, int port_id)
 {
-	memcpy(stats, edma_stats.port[port_id].port_stats, sizeof(uint64_t) * NSS_STATS_NODE_MAX);
+	nss_stats_domain_copy(&nss_edma_stats_domain, stats, edma_stats.port[port_id].port_stats, sizeof(uint64_t) * NSS_STATS_NODE_MAX);
 }
 EXPORT_SYMBOL(nss_edma_get_stats);
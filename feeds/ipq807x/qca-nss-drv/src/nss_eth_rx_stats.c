@@ -23,6 +23,11 @@
  */
 ATOMIC_NOTIFIER_HEAD(nss_eth_rx_stats_notifier);
 
+/*
+ * Statistics domain for ETH_RX; the sync handler below updates under it.
+ */
+static struct nss_stats_domain nss_eth_rx_stats_domain = NSS_STATS_DOMAIN_INIT(nss_eth_rx_stats_domain);
+
 uint64_t nss_eth_rx_stats[NSS_ETH_RX_STATS_MAX];			/* ETH_RX statistics */
 uint64_t nss_eth_rx_exception_stats[NSS_ETH_RX_EXCEPTION_EVENT_MAX];	/* Unknown protocol exception events per interface */
 
@@ -32,8 +37,6 @@ uint64_t nss_eth_rx_exception_stats[NSS_ETH_RX_EXCEPTION_EVENT_MAX];	/* Unknown
  */
 static ssize_t nss_eth_rx_stats_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos)
 {
-	int32_t i;
-
 	/*
 	 * Max output lines = #stats * NSS_MAX_CORES  +
 	 * few blank lines for banner printing + Number of Extra outputlines for future reference to add new stats
@@ -67,12 +70,7 @@ static ssize_t nss_eth_rx_stats_read(struct file *fp, char __user *ubuf, size_t
 	/*
 	 * eth_rx node stats.
 	 */
-	spin_lock_bh(&nss_top_main.stats_lock);
-	for (i = 0; (i < NSS_ETH_RX_STATS_MAX); i++) {
-		stats_shadow[i] = nss_eth_rx_stats[i];
-	}
-
-	spin_unlock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_copy(&nss_eth_rx_stats_domain, stats_shadow, nss_eth_rx_stats, sizeof(*stats_shadow) * NSS_ETH_RX_STATS_MAX);
 
 	size_wr += nss_stats_print("eth_rx", "eth_rx node stats"
 					, NSS_STATS_SINGLE_INSTANCE
@@ -84,12 +82,7 @@ static ssize_t nss_eth_rx_stats_read(struct file *fp, char __user *ubuf, size_t
 	/*
 	 * Exception stats.
 	 */
-	spin_lock_bh(&nss_top_main.stats_lock);
-	for (i = 0; (i < NSS_ETH_RX_EXCEPTION_EVENT_MAX); i++) {
-		stats_shadow[i] = nss_eth_rx_exception_stats[i];
-	}
-
-	spin_unlock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_copy(&nss_eth_rx_stats_domain, stats_shadow, nss_eth_rx_exception_stats, sizeof(*stats_shadow) * NSS_ETH_RX_EXCEPTION_EVENT_MAX);
 
 	size_wr += nss_stats_print("eth_rx", "eth_rx exception stats"
 					, NSS_STATS_SINGLE_INSTANCE
@@ -115,6 +108,11 @@ NSS_STATS_DECLARE_FILE_OPERATIONS(eth_rx);
  */
 void nss_eth_rx_stats_dentry_create(void)
 {
+	/*
+	 * The node sync handler updates the common node stats under the domain
+	 */
+	nss_stats_domain_own_node(&nss_eth_rx_stats_domain, NSS_ETH_RX_INTERFACE);
+
 	nss_stats_create_dentry("eth_rx", &nss_eth_rx_stats_ops);
 }
 
@@ -127,7 +125,7 @@ void nss_eth_rx_metadata_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss
 	int32_t i;
 	struct nss_top_instance *nss_top = nss_ctx->nss_top;
 
-	spin_lock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_begin(&nss_eth_rx_stats_domain);
 
 	nss_top->stats_node[NSS_ETH_RX_INTERFACE][NSS_STATS_NODE_RX_PKTS] += nens->node_stats.rx_packets;
 	nss_top->stats_node[NSS_ETH_RX_INTERFACE][NSS_STATS_NODE_RX_BYTES] += nens->node_stats.rx_bytes;
@@ -146,7 +144,7 @@ void nss_eth_rx_metadata_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss
 		nss_eth_rx_exception_stats[i] += nens->exception_events[i];
 	}
 
-	spin_unlock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_end(&nss_eth_rx_stats_domain);
 }
 
 /*
@@ -160,9 +158,9 @@ void nss_eth_rx_stats_notify(struct nss_ctx_instance *nss_ctx)
 	struct nss_eth_rx_stats_notification eth_rx_stats;
 
 	eth_rx_stats.core_id = nss_ctx->id;
-	memcpy(eth_rx_stats.cmn_node_stats, nss_top_main.stats_node[NSS_ETH_RX_INTERFACE], sizeof(eth_rx_stats.cmn_node_stats));
-	memcpy(eth_rx_stats.special_stats, nss_eth_rx_stats, sizeof(eth_rx_stats.special_stats));
-	memcpy(eth_rx_stats.exception_stats, nss_eth_rx_exception_stats, sizeof(eth_rx_stats.exception_stats));
+	nss_stats_domain_copy(&nss_eth_rx_stats_domain, eth_rx_stats.cmn_node_stats, nss_top_main.stats_node[NSS_ETH_RX_INTERFACE], sizeof(eth_rx_stats.cmn_node_stats));
+	nss_stats_domain_copy(&nss_eth_rx_stats_domain, eth_rx_stats.special_stats, nss_eth_rx_stats, sizeof(eth_rx_stats.special_stats));
+	nss_stats_domain_copy(&nss_eth_rx_stats_domain, eth_rx_stats.exception_stats, nss_eth_rx_exception_stats, sizeof(eth_rx_stats.exception_stats));
 	atomic_notifier_call_chain(&nss_eth_rx_stats_notifier, NSS_STATS_EVENT_NOTIFY, (void *)&eth_rx_stats);
 }
 
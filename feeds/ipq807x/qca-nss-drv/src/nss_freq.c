@@ -46,6 +46,17 @@ extern struct nss_runtime_sampling nss_runtime_samples;
 extern struct workqueue_struct *nss_wq;
 extern nss_work_t *nss_work;
 
+/*
+ * Governor selected from sysctl, and the one whose state is current.
+ */
+static atomic_t nss_freq_governor_id = ATOMIC_INIT(0);
+static int nss_freq_governor_active;
+
+/*
+ * Frequency changes made by the governors.
+ */
+struct nss_freq_governor_stats nss_freq_governor_stats;
+
 /*
  * nss_freq_msg_init()
  *	Initialize the freq message
@@ -198,6 +209,38 @@ static void nss_freq_compute_cpu_usage(struct nss_ctx_instance *nss_ctx, uint32_
 	spin_unlock_bh(&nss_freq_cpu_usage_lock);
 }
 
+/*
+ * nss_freq_governor_name()
+ *	Return the name of a governor, or NULL if there is no such governor.
+ */
+const char *nss_freq_governor_name(int id)
+{
+	return nss_freq_gov_name(id);
+}
+
+/*
+ * nss_freq_set_governor()
+ *	Select the governor used for auto scaling.
+ */
+bool nss_freq_set_governor(int id)
+{
+	if (!nss_freq_governor_name(id)) {
+		return false;
+	}
+
+	atomic_set(&nss_freq_governor_id, id);
+	return true;
+}
+
+/*
+ * nss_freq_get_governor()
+ *	Return the governor used for auto scaling.
+ */
+int nss_freq_get_governor(void)
+{
+	return atomic_read(&nss_freq_governor_id);
+}
+
 /*
  * nss_freq_scale_frequency()
  * 	Frequency scaling algorithm to scale frequency.
@@ -205,9 +248,10 @@ static void nss_freq_compute_cpu_usage(struct nss_ctx_instance *nss_ctx, uint32_
 void nss_freq_scale_frequency(struct nss_ctx_instance *nss_ctx, uint32_t inst_cnt)
 {
 	uint32_t b_index;
-	uint32_t minimum;
-	uint32_t maximum;
-	uint32_t index = nss_runtime_samples.freq_scale_index;
+	uint32_t backlog = 0;
+	nss_freq_scales_t target;
+	int gov_id;
+	nss_freq_scales_t index = nss_runtime_samples.freq_scale_index;
 
 	/*
 	 * We do not accept any statistics if auto scaling is off,
@@ -265,60 +309,45 @@ void nss_freq_scale_frequency(struct nss_ctx_instance *nss_ctx, uint32_t inst_cn
 	}
 
 	/*
-	 * Scale Algorithmn
-	 *	Algorithmn will limit how fast it will transition each scale, by the number of samples seen.
-	 *	If any sample is out of scale during the idle count, the rate_limit will reset to 0.
-	 *	Scales are limited to the max number of cpu scales we support.
+	 * A governor switch from sysctl takes effect here, in the only context
+	 * the governors run in, so their state needs no locking.
 	 */
-	if (nss_runtime_samples.freq_scale_rate_limit_up++ >= NSS_FREQUENCY_SCALE_RATE_LIMIT_UP) {
-		maximum = nss_runtime_samples.freq_scale[index].maximum;
-		if ((nss_runtime_samples.average > maximum) && (index < (NSS_FREQ_MAX_SCALE - 1))) {
-			nss_runtime_samples.freq_scale_index++;
-			nss_runtime_samples.freq_scale_ready = 0;
-
-			/*
-			 * If fail to increase frequency, decrease index
-			 */
-			nss_trace("frequency increase to %d inst:%x > maximum:%x\n", nss_runtime_samples.freq_scale[nss_runtime_samples.freq_scale_index].frequency, inst_cnt, maximum);
-			if (!nss_freq_queue_work()) {
-				nss_runtime_samples.freq_scale_index--;
-			}
-		}
+	gov_id = atomic_read(&nss_freq_governor_id);
+	if (unlikely(gov_id != nss_freq_governor_active)) {
+		nss_freq_governor_active = gov_id;
+		nss_freq_gov_reset(&nss_runtime_samples.gov);
+	}
 
-		/*
-		 * Reset the down scale counter based on running average, so can idle properly
-		 */
-		if (nss_runtime_samples.average > maximum) {
-			nss_trace("down scale timeout reset running average:%x\n", nss_runtime_samples.average);
-			nss_runtime_samples.freq_scale_rate_limit_down = 0;
-		}
+	if (gov_id == NSS_FREQ_GOV_QUEUE) {
+		backlog = nss_core_n2h_backlog(nss_ctx);
+	}
 
-		nss_runtime_samples.freq_scale_rate_limit_up = 0;
+	target = nss_freq_gov_select(gov_id, &nss_runtime_samples.gov, nss_runtime_samples.freq_scale,
+					index, nss_runtime_samples.average, backlog);
+	if (target == index) {
 		return;
 	}
 
-	if (nss_runtime_samples.freq_scale_rate_limit_down++ >= NSS_FREQUENCY_SCALE_RATE_LIMIT_DOWN) {
-		minimum = nss_runtime_samples.freq_scale[index].minimum;
+	nss_trace("%px: %s governor, frequency %d -> %d, average:%x inst:%x backlog:%u\n", nss_ctx,
+			nss_freq_gov_name(gov_id), nss_runtime_samples.freq_scale[index].frequency,
+			nss_runtime_samples.freq_scale[target].frequency, nss_runtime_samples.average, inst_cnt, backlog);
 
-		/*
-		 * Check if we need to lower the frequency. For some SoC like IPQ50xx, low frequency
-		 * is not supported. So check if the next lower frequency is configured before shifting down
-		 */
-		if ((nss_runtime_samples.average < minimum) && (index > 0) && nss_runtime_samples.freq_scale[index - 1].maximum) {
-			nss_runtime_samples.freq_scale_index--;
-			nss_runtime_samples.freq_scale_ready = 0;
+	nss_runtime_samples.freq_scale_index = target;
+	nss_runtime_samples.freq_scale_ready = 0;
 
-			/*
-			 * If fail to decrease frequency, increase index
-			 */
-			nss_trace("frequency decrease to %d inst:%x < minumum:%x\n", nss_runtime_samples.freq_scale[nss_runtime_samples.freq_scale_index].frequency, nss_runtime_samples.average, minimum);
-			if (!nss_freq_queue_work()) {
-				nss_runtime_samples.freq_scale_index++;
-			}
-		}
-		nss_runtime_samples.freq_scale_rate_limit_down = 0;
+	/*
+	 * If fail to change frequency, restore index
+	 */
+	if (!nss_freq_queue_work()) {
+		nss_runtime_samples.freq_scale_index = index;
 		return;
 	}
+
+	if (target > index) {
+		nss_freq_governor_stats.scale_up++;
+	} else {
+		nss_freq_governor_stats.scale_down++;
+	}
 }
 
 /*
@@ -329,6 +358,11 @@ static void nss_freq_handle_core_stats(struct nss_ctx_instance *nss_ctx, struct
 {
 	uint32_t inst_cnt = core_stats->inst_cnt_total;
 
+	/*
+	 * One line per sample, in the format tools/nss_freq_sim replays
+	 */
+	nss_trace("%px: inst_cnt:%x backlog:%u\n", nss_ctx, inst_cnt, nss_core_n2h_backlog(nss_ctx));
+
 	/*
 	 * compute CPU utilization by using the instruction count
 	 */
@@ -0,0 +1,314 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/*
+ * nss_freq_gov.h
+ *	Frequency scaling governors.
+ *
+ * A governor is handed the running average of the instruction count, and
+ * for the queue governor the N2H backlog, and returns the scale index it
+ * wants to run at. The decisions only depend on the scale table and the
+ * governor state passed in, so the header can also be built outside the
+ * kernel to replay recorded traces through the governors.
+ */
+
+#ifndef __NSS_FREQ_GOV_H
+#define __NSS_FREQ_GOV_H
+
+#ifdef __KERNEL__
+#include <linux/types.h>
+#include <linux/string.h>
+#else
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#endif
+
+/*
+ * The scales for NSS
+ */
+typedef enum nss_freq_scales {
+	NSS_FREQ_LOW_SCALE = 0,
+	NSS_FREQ_MID_SCALE = 1,
+	NSS_FREQ_HIGH_SCALE = 2,
+	NSS_FREQ_MAX_SCALE = 3,
+} nss_freq_scales_t;
+
+/*
+ * NSS Core Statistics and Frequencies
+ */
+#define NSS_SAMPLE_BUFFER_SIZE 4			/* Ring Buffer should be a Size of two */
+#define NSS_SAMPLE_BUFFER_MASK (NSS_SAMPLE_BUFFER_SIZE - 1)
+#define NSS_FREQUENCY_SCALE_RATE_LIMIT_UP 2		/* Adjust the Rate of Frequency Switching Up */
+#define NSS_FREQUENCY_SCALE_RATE_LIMIT_DOWN 60000	/* Adjust the Rate of Frequency Switching Down */
+
+/*
+ * NSS Frequency Scale Info
+ *
+ * INFO: Contains the Scale information per Frequency
+ *	Per Scale information needed to Program PLL and make switching decisions
+ */
+struct nss_scale_info {
+	uint32_t frequency;	/* Frequency in Mhz */
+	uint32_t minimum;	/* Minimum INST_CNT per Sec */
+	uint32_t maximum;	/* Maximum INST_CNT per Sec */
+};
+
+/*
+ * Governors, indexed by the value of the governor sysctl
+ */
+enum nss_freq_gov_id {
+	NSS_FREQ_GOV_RATE_LIMIT,	/* Original rate limited algorithm */
+	NSS_FREQ_GOV_PID,		/* PID controller with hysteresis */
+	NSS_FREQ_GOV_QUEUE,		/* Queue depth aware */
+	NSS_FREQ_GOV_MAX,
+};
+
+/*
+ * PID governor gains and hold off, as shifts and samples.
+ */
+#define NSS_FREQ_GOV_PID_KI_SHIFT	3	/* Integral gain of 1/8 */
+#define NSS_FREQ_GOV_PID_KD_SHIFT	1	/* Derivative gain of 1/2 */
+#define NSS_FREQ_GOV_PID_HOLD_UP	16	/* Samples to hold after scaling up */
+#define NSS_FREQ_GOV_PID_HOLD_DOWN	4096	/* Samples to hold after scaling down */
+
+/*
+ * Queue depth governor N2H backlog thresholds, in descriptors.
+ */
+#define NSS_FREQ_GOV_QUEUE_AVG_SHIFT	4
+#define NSS_FREQ_GOV_QUEUE_BACKLOG_HIGH	128	/* Scale up at this average backlog */
+#define NSS_FREQ_GOV_QUEUE_BACKLOG_LOW	8	/* Do not scale down above this average backlog */
+
+/*
+ * Governor state
+ *	Only the active governor's fields are meaningful; the state is reset
+ *	whenever the governor changes.
+ */
+struct nss_freq_gov {
+	uint32_t rate_limit_up;		/* Samples since the last scale up check */
+	uint32_t rate_limit_down;	/* Samples since the last scale down check */
+	int32_t pid_integral;		/* Accumulated error */
+	int32_t pid_prev_error;		/* Error at the previous sample */
+	uint32_t pid_hold;		/* Samples left before the next change */
+	int32_t backlog_avg;		/* Average N2H backlog, scaled by NSS_FREQ_GOV_QUEUE_AVG_SHIFT */
+};
+
+/*
+ * nss_freq_gov_name()
+ *	Return the name of a governor, or NULL if there is no such governor.
+ */
+static inline const char *nss_freq_gov_name(int id)
+{
+	switch (id) {
+	case NSS_FREQ_GOV_RATE_LIMIT:
+		return "rate_limit";
+	case NSS_FREQ_GOV_PID:
+		return "pid";
+	case NSS_FREQ_GOV_QUEUE:
+		return "queue";
+	}
+
+	return NULL;
+}
+
+/*
+ * nss_freq_gov_reset()
+ *	Clear the governor state.
+ */
+static inline void nss_freq_gov_reset(struct nss_freq_gov *gov)
+{
+	memset(gov, 0, sizeof(*gov));
+}
+
+/*
+ * nss_freq_gov_can_scale_up()
+ *	Check if there is a higher scale to move to from index.
+ */
+static inline bool nss_freq_gov_can_scale_up(nss_freq_scales_t index)
+{
+	return index < (NSS_FREQ_MAX_SCALE - 1);
+}
+
+/*
+ * nss_freq_gov_can_scale_down()
+ *	Check if there is a lower scale to move to from index.
+ *
+ * For some SoC like IPQ50xx, low frequency is not supported. So check if the
+ * next lower frequency is configured before shifting down.
+ */
+static inline bool nss_freq_gov_can_scale_down(const struct nss_scale_info *scale, nss_freq_scales_t index)
+{
+	return (index > 0) && scale[index - 1].maximum;
+}
+
+/*
+ * nss_freq_gov_rate_limit_select()
+ *	Rate limit governor, the original scaling algorithm.
+ *
+ * Algorithmn will limit how fast it will transition each scale, by the number of samples seen.
+ * If any sample is out of scale during the idle count, the rate_limit will reset to 0.
+ * Scales are limited to the max number of cpu scales we support.
+ */
+static inline nss_freq_scales_t nss_freq_gov_rate_limit_select(struct nss_freq_gov *gov, const struct nss_scale_info *scale,
+								nss_freq_scales_t index, uint32_t average)
+{
+	if (gov->rate_limit_up++ >= NSS_FREQUENCY_SCALE_RATE_LIMIT_UP) {
+		gov->rate_limit_up = 0;
+		if (average <= scale[index].maximum) {
+			return index;
+		}
+
+		/*
+		 * Reset the down scale counter based on running average, so can idle properly
+		 */
+		gov->rate_limit_down = 0;
+
+		if (!nss_freq_gov_can_scale_up(index)) {
+			return index;
+		}
+
+		return index + 1;
+	}
+
+	if (gov->rate_limit_down++ >= NSS_FREQUENCY_SCALE_RATE_LIMIT_DOWN) {
+		gov->rate_limit_down = 0;
+		if ((average >= scale[index].minimum) || !nss_freq_gov_can_scale_down(scale, index)) {
+			return index;
+		}
+
+		return index - 1;
+	}
+
+	return index;
+}
+
+/*
+ * nss_freq_gov_pid_select()
+ *	PID governor with hysteresis.
+ *
+ * The controller steers the running average towards the middle of the current
+ * scale's [minimum, maximum] band. Its output has to leave the band before a
+ * change is made, and after each change the governor holds for a number of
+ * samples, longer for a step down than for a step up.
+ */
+static inline nss_freq_scales_t nss_freq_gov_pid_select(struct nss_freq_gov *gov, const struct nss_scale_info *scale,
+							nss_freq_scales_t index, uint32_t average)
+{
+	int32_t setpoint = (scale[index].minimum + scale[index].maximum) >> 1;
+	int32_t band_up = scale[index].maximum - setpoint;
+	int32_t band_down = setpoint - scale[index].minimum;
+	int32_t error = (int32_t)average - setpoint;
+	int32_t integral_min = -(band_down << NSS_FREQ_GOV_PID_KI_SHIFT);
+	int32_t integral_max = band_up << NSS_FREQ_GOV_PID_KI_SHIFT;
+	int32_t output;
+
+	gov->pid_integral += error;
+	if (gov->pid_integral < integral_min) {
+		gov->pid_integral = integral_min;
+	} else if (gov->pid_integral > integral_max) {
+		gov->pid_integral = integral_max;
+	}
+
+	output = error + (gov->pid_integral >> NSS_FREQ_GOV_PID_KI_SHIFT)
+			+ ((error - gov->pid_prev_error) >> NSS_FREQ_GOV_PID_KD_SHIFT);
+	gov->pid_prev_error = error;
+
+	if (gov->pid_hold) {
+		gov->pid_hold--;
+		return index;
+	}
+
+	if ((output > band_up) && nss_freq_gov_can_scale_up(index)) {
+		nss_freq_gov_reset(gov);
+		gov->pid_hold = NSS_FREQ_GOV_PID_HOLD_UP;
+		return index + 1;
+	}
+
+	if ((output < -band_down) && nss_freq_gov_can_scale_down(scale, index)) {
+		nss_freq_gov_reset(gov);
+		gov->pid_hold = NSS_FREQ_GOV_PID_HOLD_DOWN;
+		return index - 1;
+	}
+
+	return index;
+}
+
+/*
+ * nss_freq_gov_queue_select()
+ *	Queue depth aware governor.
+ *
+ * Same bands as the rate limit governor, but descriptors piling up on the N2H
+ * data queues count as load too: a deep backlog scales up even when the
+ * instruction count is still inside the band, and any backlog holds off
+ * scaling down.
+ */
+static inline nss_freq_scales_t nss_freq_gov_queue_select(struct nss_freq_gov *gov, const struct nss_scale_info *scale,
+							nss_freq_scales_t index, uint32_t average, uint32_t backlog)
+{
+	int32_t avg;
+	bool busy;
+
+	/*
+	 * Moving average with a 1/8 contribution from the latest sample.
+	 */
+	avg = gov->backlog_avg;
+	avg += ((int32_t)(backlog << NSS_FREQ_GOV_QUEUE_AVG_SHIFT) - avg) >> 3;
+	gov->backlog_avg = avg;
+
+	busy = (average > scale[index].maximum)
+		|| (avg > (NSS_FREQ_GOV_QUEUE_BACKLOG_HIGH << NSS_FREQ_GOV_QUEUE_AVG_SHIFT));
+
+	if (busy || (avg > (NSS_FREQ_GOV_QUEUE_BACKLOG_LOW << NSS_FREQ_GOV_QUEUE_AVG_SHIFT))) {
+		gov->rate_limit_down = 0;
+	}
+
+	if (gov->rate_limit_up++ >= NSS_FREQUENCY_SCALE_RATE_LIMIT_UP) {
+		gov->rate_limit_up = 0;
+		if (busy && nss_freq_gov_can_scale_up(index)) {
+			return index + 1;
+		}
+
+		return index;
+	}
+
+	if (gov->rate_limit_down++ >= NSS_FREQUENCY_SCALE_RATE_LIMIT_DOWN) {
+		gov->rate_limit_down = 0;
+		if ((average < scale[index].minimum) && nss_freq_gov_can_scale_down(scale, index)) {
+			return index - 1;
+		}
+	}
+
+	return index;
+}
+
+/*
+ * nss_freq_gov_select()
+ *	Pick the scale for the latest sample with governor id.
+ */
+static inline nss_freq_scales_t nss_freq_gov_select(int id, struct nss_freq_gov *gov, const struct nss_scale_info *scale,
+							nss_freq_scales_t index, uint32_t average, uint32_t backlog)
+{
+	switch (id) {
+	case NSS_FREQ_GOV_PID:
+		return nss_freq_gov_pid_select(gov, scale, index, average);
+	case NSS_FREQ_GOV_QUEUE:
+		return nss_freq_gov_queue_select(gov, scale, index, average, backlog);
+	}
+
+	return nss_freq_gov_rate_limit_select(gov, scale, index, average);
+}
+
+#endif /* __NSS_FREQ_GOV_H */
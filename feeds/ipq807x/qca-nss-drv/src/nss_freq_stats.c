@@ -32,6 +32,11 @@ extern struct nss_freq_cpu_usage nss_freq_cpu_status;
  */
 extern spinlock_t nss_freq_cpu_usage_lock;
 
+/*
+ * Frequency changes made by the governors.
+ */
+extern struct nss_freq_governor_stats nss_freq_governor_stats;
+
 /*
  * nss_freq_stats_read()
  * 	Read frequency stats and display CPU information.
@@ -41,7 +46,7 @@ static ssize_t nss_freq_stats_read(struct file *fp, char __user *ubuf, size_t sz
 	/*
 	 * max output lines = Should change in case of number of lines below.
 	 */
-	uint32_t max_output_lines = (2 + 3) + 5;
+	uint32_t max_output_lines = (2 + 3) + 5 + 4;
 	size_t size_al = NSS_STATS_MAX_STR_LENGTH * max_output_lines;
 	size_t size_wr = 0;
 	ssize_t bytes_read = 0;
@@ -66,6 +71,10 @@ static ssize_t nss_freq_stats_read(struct file *fp, char __user *ubuf, size_t sz
 	size_wr += scnprintf(lbuf + size_wr, size_al - size_wr, "Min\tAvg\tMax\n");
 	size_wr += scnprintf(lbuf + size_wr, size_al - size_wr, " %u%%\t %u%%\t %u%%\n\n", min, avg, max);
 
+	size_wr += scnprintf(lbuf + size_wr, size_al - size_wr, "Governor: %s\n", nss_freq_governor_name(nss_freq_get_governor()));
+	size_wr += scnprintf(lbuf + size_wr, size_al - size_wr, "Scale up:\t%u\n", READ_ONCE(nss_freq_governor_stats.scale_up));
+	size_wr += scnprintf(lbuf + size_wr, size_al - size_wr, "Scale down:\t%u\n", READ_ONCE(nss_freq_governor_stats.scale_down));
+
 	bytes_read = simple_read_from_buffer(ubuf, sz, ppos, lbuf, strlen(lbuf));
 	kfree(lbuf);
 
@@ -27,13 +27,18 @@ struct nss_stats_info nss_gmac_stats_str[NSS_GMAC_STATS_MAX] = {
 	{"iterations"	, NSS_STATS_TYPE_SPECIAL}
 };
 
+/*
+ * Statistics domain for GMAC; the physical interface handler updates under it.
+ */
+struct nss_stats_domain nss_gmac_stats_domain = NSS_STATS_DOMAIN_INIT(nss_gmac_stats_domain);
+
 /*
  * nss_gmac_stats_read()
  *	Read GMAC stats.
  */
 ssize_t nss_gmac_stats_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos)
 {
-	uint32_t i, id;
+	uint32_t id;
 
 	/*
 	 * max output lines = ((#stats + start tag + one blank) * #GMACs) Number of Extra outputlines for future
@@ -61,12 +66,7 @@ ssize_t nss_gmac_stats_read(struct file *fp, char __user *ubuf, size_t sz, loff_
 	size_wr += nss_stats_banner(lbuf, size_wr, size_al, "gmac", NSS_STATS_SINGLE_CORE);
 
 	for (id = 0; id < NSS_MAX_PHYSICAL_INTERFACES; id++) {
-		spin_lock_bh(&nss_top_main.stats_lock);
-		for (i = 0; (i < NSS_GMAC_STATS_MAX); i++) {
-			stats_shadow[i] = nss_top_main.stats_gmac[id][i];
-		}
-
-		spin_unlock_bh(&nss_top_main.stats_lock);
+		nss_stats_domain_copy(&nss_gmac_stats_domain, stats_shadow, nss_top_main.stats_gmac[id], sizeof(*stats_shadow) * NSS_GMAC_STATS_MAX);
 		size_wr += nss_stats_print("gmac", "gmac stats", id
 						, nss_gmac_stats_str
 						, stats_shadow
@@ -29,5 +29,6 @@ enum nss_stats_gmac {
 	NSS_GMAC_STATS_MAX,
 };
 
+extern struct nss_stats_domain nss_gmac_stats_domain;
 extern ssize_t nss_gmac_stats_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos);
 #endif /* __NSS_GMAC_STATS_H */
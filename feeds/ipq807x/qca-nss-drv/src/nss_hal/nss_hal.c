@@ -24,6 +24,7 @@
 #include <linux/firmware.h>
 #include <linux/of.h>
 #include <linux/irq.h>
+#include <linux/crc32.h>
 
 #include "nss_hal.h"
 #include "nss_arch.h"
@@ -87,6 +88,13 @@ int nss_hal_firmware_load(struct nss_ctx_instance *nss_ctx, struct platform_devi
 
 	nss_info_always("nss_driver - fw of size %d  bytes copied to load addr: %x, nss_id : %d\n", (int)nss_fw->size, npd->load_addr, nss_dev->id);
 	memcpy_toio(load_mem, nss_fw->data, nss_fw->size);
+
+	/*
+	 * The firmware does not report a version, so identify the image
+	 * by its size and CRC for the coredump.
+	 */
+	nss_ctx->fw_size = nss_fw->size;
+	nss_ctx->fw_crc = crc32(0, nss_fw->data, nss_fw->size);
 	release_firmware(nss_fw);
 	iounmap(load_mem);
 	return 0;
@@ -153,6 +161,12 @@ static void nss_hal_clean_up_irq(struct int_ctx_instance *int_ctx)
 	 */
 	napi_disable(&int_ctx->napi);
 
+	/*
+	 * A lingering queue may have armed its timer in the last poll; it
+	 * can no longer schedule NAPI, so just stop it.
+	 */
+	hrtimer_cancel(&int_ctx->linger_timer);
+
 	/*
 	 * Interrupt can be raised here before free_irq() but as napi is
 	 * already disabled, it will be never sheduled from hard_irq
@@ -179,6 +193,10 @@ static int nss_hal_register_irq(struct nss_ctx_instance *nss_ctx, struct nss_pla
 	 * request for IRQs
 	 */
 	int_ctx->nss_ctx = nss_ctx;
+	int_ctx->rx_batch.ndev = NULL;
+	__skb_queue_head_init(&int_ctx->rx_batch.list);
+	hrtimer_init(&int_ctx->linger_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL_PINNED);
+	int_ctx->linger_timer.function = nss_core_handle_napi_linger;
 	err = nss_top->hal_ops->request_irq(nss_ctx, npd, irq_num);
 	if (err) {
 		nss_warning("%px: IRQ request for queue %d failed", nss_ctx, irq_num);
@@ -725,6 +743,12 @@ int nss_hal_probe(struct platform_device *nss_dev)
 	}
 
 	spin_lock_init(&(nss_ctx->decongest_cb_lock));
+
+	/*
+	 * Fill the command buffer pool
+	 */
+	nss_core_cmd_buf_pool_init(nss_ctx);
+	nss_core_rx_buf_cache_init(nss_ctx);
 	nss_ctx->magic = NSS_CTX_MAGIC;
 
 	nss_info("%px: Reseting NSS core %d now", nss_ctx, nss_ctx->id);
@@ -734,7 +758,7 @@ int nss_hal_probe(struct platform_device *nss_dev)
 	 */
 	err = nss_top->hal_ops->core_reset(nss_dev, nss_ctx->nmap, nss_ctx->load, nss_top->clk_src);
 	if (err) {
-		goto err_register_irq;
+		goto err_cmd_buf_pool;
 	}
 
 	/*
@@ -749,6 +773,8 @@ int nss_hal_probe(struct platform_device *nss_dev)
 		nss_ctx->n2h_desc_ring[i].head = NULL;
 		nss_ctx->n2h_desc_ring[i].tail = NULL;
 		nss_ctx->n2h_desc_ring[i].jumbo_start = NULL;
+		memset(&nss_ctx->n2h_desc_ring[i].adapt, 0, sizeof(nss_ctx->n2h_desc_ring[i].adapt));
+		nss_ctx->n2h_desc_ring[i].adapt.level = NSS_CORE_NAPI_ADAPT_LEVEL_DEFAULT;
 	}
 
 	/*
@@ -761,6 +787,10 @@ int nss_hal_probe(struct platform_device *nss_dev)
 	nss_info("%px: All resources initialized and nss core%d has been brought out of reset", nss_ctx, nss_dev->id);
 	goto out;
 
+err_cmd_buf_pool:
+	nss_core_rx_buf_cache_free(nss_ctx);
+	nss_core_cmd_buf_pool_free(nss_ctx);
+
 err_register_irq:
 	for (i = 0; i < npd->num_irq; i++) {
 		nss_hal_clean_up_irq(&nss_ctx->int_ctx[i]);
@@ -813,6 +843,12 @@ int nss_hal_remove(struct platform_device *nss_dev)
 	 */
 	nss_top->data_plane_ops->data_plane_unregister();
 
+	/*
+	 * Free the command buffers and empty buffers held for recycling
+	 */
+	nss_core_cmd_buf_pool_free(nss_ctx);
+	nss_core_rx_buf_cache_free(nss_ctx);
+
 #if (NSS_FABRIC_SCALING_SUPPORT == 1)
 	fab_scaling_unregister(nss_core0_clk);
 #endif
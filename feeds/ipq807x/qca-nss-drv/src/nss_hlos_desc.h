@@ -0,0 +1,194 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2020, The Linux Foundation. All rights reserved.
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/*
+ * nss_hlos_desc.h
+ *	H2N/N2H descriptor layout and the segment fill helpers shared with tools/nss_ring.
+ *
+ * Only fixed width types are used here so the header also builds outside the
+ * kernel.
+ */
+
+#ifndef __NSS_HLOS_DESC_H
+#define __NSS_HLOS_DESC_H
+
+#ifdef __KERNEL__
+#include <linux/types.h>
+#else
+#include <stdbool.h>
+#include <stdint.h>
+#endif
+#include "nss_def.h"
+
+/*
+ * H2N Buffer Types
+ */
+#define H2N_BUFFER_EMPTY			0
+#define H2N_PAGED_BUFFER_EMPTY			1
+#define H2N_BUFFER_PACKET			2
+#define H2N_BUFFER_CTRL				4
+#define H2N_BUFFER_NATIVE_WIFI			8
+#define H2N_BUFFER_SHAPER_BOUNCE_INTERFACE	9
+#define H2N_BUFFER_SHAPER_BOUNCE_BRIDGE		10
+#define H2N_BUFFER_RATE_TEST			14
+#define H2N_BUFFER_MAX				16
+
+/*
+ * H2N Bit Flag Definitions
+ */
+#define H2N_BIT_FLAG_GEN_IPV4_IP_CHECKSUM		0x0001
+#define H2N_BIT_FLAG_GEN_IP_TRANSPORT_CHECKSUM		0x0002
+#define H2N_BIT_FLAG_FIRST_SEGMENT			0x0004
+#define H2N_BIT_FLAG_LAST_SEGMENT			0x0008
+
+#define H2N_BIT_FLAG_GEN_IP_TRANSPORT_CHECKSUM_NONE	0x0010
+#define H2N_BIT_FLAG_TX_TS_REQUIRED			0x0040
+#define H2N_BIT_FLAG_DISCARD				0x0080
+#define H2N_BIT_FLAG_SEGMENTATION_ENABLE		0x0100
+
+#define H2N_BIT_FLAG_VIRTUAL_BUFFER			0x2000
+#define H2N_BIT_FLAG_BUFFER_REUSABLE			0x8000
+
+/*
+ * HLOS to NSS descriptor structure.
+ */
+struct h2n_descriptor {
+	uint32_t interface_num;	/* Interface number to which the buffer is to be sent (where appropriate) */
+	uint32_t buffer;	/* Physical buffer address. This is the address of the start of the usable buffer being provided by the HLOS */
+	uint32_t qos_tag;	/* QoS tag information of the buffer (where appropriate) */
+	uint16_t buffer_len;	/* Length of the buffer (in bytes) */
+	uint16_t payload_len;	/* Length of the active payload of the buffer (in bytes) */
+	uint16_t mss;		/* MSS to be used with TSO/UFO */
+	uint16_t payload_offs;	/* Offset from the start of the buffer to the start of the payload (in bytes) */
+	uint16_t bit_flags;	/* Bit flags associated with the buffer */
+	uint8_t buffer_type;	/* Type of buffer */
+	uint8_t reserved;	/* Reserved for future use */
+	nss_ptr_t opaque;	/* 32 or 64-bit value provided by the HLOS to associate with the buffer. The cookie has no meaning to the NSS */
+#ifndef __LP64__
+	uint32_t padding;	/* Pad to fit 64bits, do not reuse */
+#endif
+};
+
+/*
+ * N2H Buffer Types
+ */
+#define N2H_BUFFER_EMPTY			1
+#define N2H_BUFFER_PACKET			3
+#define N2H_BUFFER_COMMAND_RESP			5
+#define N2H_BUFFER_STATUS			6
+#define N2H_BUFFER_CRYPTO_RESP			8
+#define N2H_BUFFER_PACKET_VIRTUAL		10
+#define N2H_BUFFER_SHAPER_BOUNCED_INTERFACE	11
+#define N2H_BUFFER_SHAPER_BOUNCED_BRIDGE	12
+#define N2H_BUFFER_PACKET_EXT			13
+#define N2H_BUFFER_RATE_TEST			14
+#define N2H_BUFFER_MAX				16
+
+/*
+ * Command Response Types
+ */
+#define N2H_COMMAND_RESP_OK			0
+#define N2H_COMMAND_RESP_BUFFER_TOO_SMALL	1
+#define N2H_COMMAND_RESP_BUFFER_NOT_WRITEABLE	2
+#define N2H_COMMAND_RESP_UNSUPPORTED_COMMAND	3
+#define N2H_COMMAND_RESP_INVALID_PARAMETERS	4
+#define N2H_COMMAND_RESP_INACTIVE_SUBSYSTEM	5
+
+/*
+ * N2H Bit Flag Definitions
+ */
+#define N2H_BIT_FLAG_IPV4_IP_CHECKSUM_VALID		0x0001
+#define N2H_BIT_FLAG_IP_TRANSPORT_CHECKSUM_VALID	0x0002
+#define N2H_BIT_FLAG_FIRST_SEGMENT			0x0004
+#define N2H_BIT_FLAG_LAST_SEGMENT			0x0008
+#define N2H_BIT_FLAG_INGRESS_SHAPED			0x0010
+
+/*
+ * NSS to HLOS descriptor structure
+ */
+struct n2h_descriptor {
+	uint32_t interface_num;	/* Interface number to which the buffer is to be sent (where appropriate) */
+	uint32_t buffer;	/* Physical buffer address. This is the address of the start of the usable buffer being provided by the HLOS */
+	uint16_t buffer_len;	/* Length of the buffer (in bytes) */
+	uint16_t payload_len;	/* Length of the active payload of the buffer (in bytes) */
+	uint16_t payload_offs;	/* Offset from the start of the buffer to the start of the payload (in bytes) */
+	uint16_t bit_flags;	/* Bit flags associated with the buffer */
+	uint8_t buffer_type;	/* Type of buffer */
+	uint8_t response_type;	/* Response type if the buffer is a command response */
+	uint8_t pri;		/* Packet priority */
+	uint8_t service_code;	/* Service code */
+	uint32_t reserved;	/* Reserved for future use */
+	nss_ptr_t opaque;	/* 32 or 64-bit value provided by the HLOS to associate with the buffer. The cookie has no meaning to the NSS */
+#ifndef __LP64__
+	uint32_t padding;	/* Pad to fit 64 bits, do not reuse */
+#endif
+};
+
+/*
+ * nss_core_write_one_descriptor()
+ *	Fills-up a descriptor with required fields.
+ */
+static inline void nss_core_write_one_descriptor(struct h2n_descriptor *desc,
+	uint16_t buffer_type, uint32_t buffer, uint32_t if_num,
+	nss_ptr_t opaque, uint16_t payload_off, uint16_t payload_len, uint16_t buffer_len,
+	uint32_t qos_tag, uint16_t mss, uint16_t bit_flags)
+{
+	desc->buffer_type = buffer_type;
+	desc->buffer = buffer;
+	desc->interface_num = if_num;
+	desc->opaque = opaque;
+	desc->payload_offs = payload_off;
+	desc->payload_len = payload_len;
+	desc->buffer_len = buffer_len;
+	desc->qos_tag = qos_tag;
+	desc->mss = mss;
+	desc->bit_flags = bit_flags;
+}
+
+/*
+ * nss_core_h2n_segment_flags()
+ *	Bit flags for every segment of a multi-descriptor buffer.
+ *
+ * The NSS discards the segments of a frags[] buffer except the last one, which
+ * carries the opaque back to the HLOS. Each fraglist segment owns an skb and is
+ * returned on its own. The first segment also needs H2N_BIT_FLAG_FIRST_SEGMENT.
+ */
+static inline uint16_t nss_core_h2n_segment_flags(uint16_t flags, bool is_fraglist)
+{
+	flags &= ~H2N_BIT_FLAG_BUFFER_REUSABLE;
+	if (!is_fraglist) {
+		flags |= H2N_BIT_FLAG_DISCARD;
+	}
+
+	return flags;
+}
+
+/*
+ * nss_core_h2n_close_segments()
+ *	Mark the last descriptor of a multi-descriptor buffer.
+ */
+static inline void nss_core_h2n_close_segments(struct h2n_descriptor *desc, nss_ptr_t opaque, bool is_fraglist)
+{
+	desc->bit_flags |= H2N_BIT_FLAG_LAST_SEGMENT;
+	if (is_fraglist) {
+		return;
+	}
+
+	desc->bit_flags &= ~H2N_BIT_FLAG_DISCARD;
+	desc->opaque = opaque;
+}
+
+#endif /* __NSS_HLOS_DESC_H */
@@ -22,6 +22,8 @@
 #ifndef __NSS_HLOS_IF_H
 #define __NSS_HLOS_IF_H
 
+#include "nss_hlos_desc.h"
+
 #define NSS_MIN_NUM_CONN			256		/* MIN Connection shared between IPv4 and IPv6 */
 #define NSS_FW_DEFAULT_NUM_CONN			1024		/* Firmware default number of connections for IPv4 and IPv6 */
 #define NSS_NUM_CONN_QUANTA_MASK		(1024 - 1)	/* Quanta of number of connections 1024 */
@@ -211,110 +213,6 @@ struct nss_corefreq_msg {
 	} msg;
 };
 
-/*
- * H2N Buffer Types
- */
-#define H2N_BUFFER_EMPTY			0
-#define H2N_PAGED_BUFFER_EMPTY			1
-#define H2N_BUFFER_PACKET			2
-#define H2N_BUFFER_CTRL				4
-#define H2N_BUFFER_NATIVE_WIFI			8
-#define H2N_BUFFER_SHAPER_BOUNCE_INTERFACE	9
-#define H2N_BUFFER_SHAPER_BOUNCE_BRIDGE		10
-#define H2N_BUFFER_RATE_TEST			14
-#define H2N_BUFFER_MAX				16
-
-/*
- * H2N Bit Flag Definitions
- */
-#define H2N_BIT_FLAG_GEN_IPV4_IP_CHECKSUM		0x0001
-#define H2N_BIT_FLAG_GEN_IP_TRANSPORT_CHECKSUM		0x0002
-#define H2N_BIT_FLAG_FIRST_SEGMENT			0x0004
-#define H2N_BIT_FLAG_LAST_SEGMENT			0x0008
-
-#define H2N_BIT_FLAG_GEN_IP_TRANSPORT_CHECKSUM_NONE	0x0010
-#define H2N_BIT_FLAG_TX_TS_REQUIRED			0x0040
-#define H2N_BIT_FLAG_DISCARD				0x0080
-#define H2N_BIT_FLAG_SEGMENTATION_ENABLE		0x0100
-
-#define H2N_BIT_FLAG_VIRTUAL_BUFFER			0x2000
-#define H2N_BIT_FLAG_BUFFER_REUSABLE			0x8000
-
-/*
- * HLOS to NSS descriptor structure.
- */
-struct h2n_descriptor {
-	uint32_t interface_num;	/* Interface number to which the buffer is to be sent (where appropriate) */
-	uint32_t buffer;	/* Physical buffer address. This is the address of the start of the usable buffer being provided by the HLOS */
-	uint32_t qos_tag;	/* QoS tag information of the buffer (where appropriate) */
-	uint16_t buffer_len;	/* Length of the buffer (in bytes) */
-	uint16_t payload_len;	/* Length of the active payload of the buffer (in bytes) */
-	uint16_t mss;		/* MSS to be used with TSO/UFO */
-	uint16_t payload_offs;	/* Offset from the start of the buffer to the start of the payload (in bytes) */
-	uint16_t bit_flags;	/* Bit flags associated with the buffer */
-	uint8_t buffer_type;	/* Type of buffer */
-	uint8_t reserved;	/* Reserved for future use */
-	nss_ptr_t opaque;	/* 32 or 64-bit value provided by the HLOS to associate with the buffer. The cookie has no meaning to the NSS */
-#ifndef __LP64__
-	uint32_t padding;	/* Pad to fit 64bits, do not reuse */
-#endif
-};
-
-/*
- * N2H Buffer Types
- */
-#define N2H_BUFFER_EMPTY			1
-#define N2H_BUFFER_PACKET			3
-#define N2H_BUFFER_COMMAND_RESP			5
-#define N2H_BUFFER_STATUS			6
-#define N2H_BUFFER_CRYPTO_RESP			8
-#define N2H_BUFFER_PACKET_VIRTUAL		10
-#define N2H_BUFFER_SHAPER_BOUNCED_INTERFACE	11
-#define N2H_BUFFER_SHAPER_BOUNCED_BRIDGE	12
-#define N2H_BUFFER_PACKET_EXT			13
-#define N2H_BUFFER_RATE_TEST			14
-#define N2H_BUFFER_MAX				16
-
-/*
- * Command Response Types
- */
-#define N2H_COMMAND_RESP_OK			0
-#define N2H_COMMAND_RESP_BUFFER_TOO_SMALL	1
-#define N2H_COMMAND_RESP_BUFFER_NOT_WRITEABLE	2
-#define N2H_COMMAND_RESP_UNSUPPORTED_COMMAND	3
-#define N2H_COMMAND_RESP_INVALID_PARAMETERS	4
-#define N2H_COMMAND_RESP_INACTIVE_SUBSYSTEM	5
-
-/*
- * N2H Bit Flag Definitions
- */
-#define N2H_BIT_FLAG_IPV4_IP_CHECKSUM_VALID		0x0001
-#define N2H_BIT_FLAG_IP_TRANSPORT_CHECKSUM_VALID	0x0002
-#define N2H_BIT_FLAG_FIRST_SEGMENT			0x0004
-#define N2H_BIT_FLAG_LAST_SEGMENT			0x0008
-#define N2H_BIT_FLAG_INGRESS_SHAPED			0x0010
-
-/*
- * NSS to HLOS descriptor structure
- */
-struct n2h_descriptor {
-	uint32_t interface_num;	/* Interface number to which the buffer is to be sent (where appropriate) */
-	uint32_t buffer;	/* Physical buffer address. This is the address of the start of the usable buffer being provided by the HLOS */
-	uint16_t buffer_len;	/* Length of the buffer (in bytes) */
-	uint16_t payload_len;	/* Length of the active payload of the buffer (in bytes) */
-	uint16_t payload_offs;	/* Offset from the start of the buffer to the start of the payload (in bytes) */
-	uint16_t bit_flags;	/* Bit flags associated with the buffer */
-	uint8_t buffer_type;	/* Type of buffer */
-	uint8_t response_type;	/* Response type if the buffer is a command response */
-	uint8_t pri;		/* Packet priority */
-	uint8_t service_code;	/* Service code */
-	uint32_t reserved;	/* Reserved for future use */
-	nss_ptr_t opaque;	/* 32 or 64-bit value provided by the HLOS to associate with the buffer. The cookie has no meaning to the NSS */
-#ifndef __LP64__
-	uint32_t padding;	/* Pad to fit 64 bits, do not reuse */
-#endif
-};
-
 /*
  * Device Memory Map Definitions
  */
@@ -236,7 +236,7 @@ void nss_igs_stats_sync(struct nss_ctx_instance *nss_ctx,
 	return;
 
 sync_cmn_stats:
-	spin_lock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_begin(&nss_stats_node_domain);
 
 	/*
 	 * sync common stats.
@@ -251,7 +251,7 @@ sync_cmn_stats:
 			node_stats_ptr->rx_dropped[i];
 	}
 
-	spin_unlock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_end(&nss_stats_node_domain);
 }
 
 /*
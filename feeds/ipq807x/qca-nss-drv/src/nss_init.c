@@ -58,8 +58,15 @@
 int nss_ctl_redirect __read_mostly = 0;
 int nss_ctl_debug __read_mostly = 0;
 int nss_ctl_logbuf __read_mostly = 0;
+int nss_ctl_meminfo_calibrate __read_mostly = 0;
+int nss_ctl_profiler_collect __read_mostly = 0;
 int nss_jumbo_mru  __read_mostly = 0;
 int nss_paged_mode __read_mostly = 0;
+int nss_rx_list __read_mostly = 0;
+int nss_napi_adapt __read_mostly = 0;
+#if (NSS_FREQ_SCALE_SUPPORT == 1)
+int nss_freq_governor __read_mostly = 0;
+#endif
 #if (NSS_SKB_REUSE_SUPPORT == 1)
 int nss_max_reuse __read_mostly = PAGE_SIZE;
 #endif
@@ -161,7 +168,7 @@ static void nss_reset_frequency_stats_samples(void)
 	nss_runtime_samples.average = 0;
 	nss_runtime_samples.sample_count = 0;
 	nss_runtime_samples.message_rate_limit = 0;
-	nss_runtime_samples.freq_scale_rate_limit_down = 0;
+	nss_freq_gov_reset(&nss_runtime_samples.gov);
 }
 
 /*
@@ -337,6 +344,33 @@ static int nss_get_average_inst_handler(struct ctl_table *ctl, int write, void _
 	*lenp = 0;
 	return ret;
 }
+
+/*
+ * nss_freq_governor_handler()
+ *	Sysctl to select the auto scaling governor.
+ */
+static int nss_freq_governor_handler(struct ctl_table *ctl, int write, void __user *buffer, size_t *lenp, loff_t *ppos)
+{
+	int ret;
+
+	ret = proc_dointvec(ctl, write, buffer, lenp, ppos);
+	if (ret) {
+		return ret;
+	}
+
+	if (!write) {
+		return ret;
+	}
+
+	if (!nss_freq_set_governor(nss_freq_governor)) {
+		nss_warning("Invalid governor %d, options are 0 (rate_limit), 1 (pid), 2 (queue)\n", nss_freq_governor);
+		nss_freq_governor = nss_freq_get_governor();
+		return -EINVAL;
+	}
+
+	nss_info("freq governor set to %s\n", nss_freq_governor_name(nss_freq_governor));
+	return ret;
+}
 #endif
 
 #if (NSS_FW_DBG_SUPPORT == 1)
@@ -427,6 +461,48 @@ static int nss_paged_mode_handler(struct ctl_table *ctl, int write, void __user
 	return ret;
 }
 
+/*
+ * nss_rx_list_handler()
+ *	Sysctl to modify nss_rx_list.
+ */
+static int nss_rx_list_handler(struct ctl_table *ctl, int write, void __user *buffer, size_t *lenp, loff_t *ppos)
+{
+	int ret;
+
+	ret = proc_dointvec(ctl, write, buffer, lenp, ppos);
+	if (ret) {
+		return ret;
+	}
+
+	if (write) {
+		nss_core_set_rx_list(nss_rx_list);
+		nss_info("rx_list set to %d\n", nss_rx_list);
+	}
+
+	return ret;
+}
+
+/*
+ * nss_napi_adapt_handler()
+ *	Sysctl to modify nss_napi_adapt.
+ */
+static int nss_napi_adapt_handler(struct ctl_table *ctl, int write, void __user *buffer, size_t *lenp, loff_t *ppos)
+{
+	int ret;
+
+	ret = proc_dointvec(ctl, write, buffer, lenp, ppos);
+	if (ret) {
+		return ret;
+	}
+
+	if (write) {
+		nss_core_set_napi_adapt(nss_napi_adapt);
+		nss_info("napi_adapt set to %d\n", nss_napi_adapt);
+	}
+
+	return ret;
+}
+
 #if (NSS_SKB_REUSE_SUPPORT == 1)
 /*
  * nss_get_min_reuse_handler()
@@ -532,6 +608,13 @@ static struct ctl_table nss_freq_table[] = {
 		.mode			= 0644,
 		.proc_handler	= &nss_get_average_inst_handler,
 	},
+	{
+		.procname		= "governor",
+		.data			= &nss_freq_governor,
+		.maxlen			= sizeof(int),
+		.mode			= 0644,
+		.proc_handler	= &nss_freq_governor_handler,
+	},
 	{ }
 };
 #endif
@@ -567,6 +650,20 @@ static struct ctl_table nss_general_table[] = {
 		.mode                   = 0644,
 		.proc_handler		= &nss_logbuffer_handler,
 	},
+	{
+		.procname               = "meminfo_calibrate",
+		.data                   = &nss_ctl_meminfo_calibrate,
+		.maxlen                 = sizeof(int),
+		.mode                   = 0644,
+		.proc_handler		= &nss_meminfo_calibrate_handler,
+	},
+	{
+		.procname               = "profiler_collect",
+		.data                   = &nss_ctl_profiler_collect,
+		.maxlen                 = sizeof(int),
+		.mode                   = 0644,
+		.proc_handler		= &nss_profiler_collect_handler,
+	},
 	{
 		.procname               = "jumbo_mru",
 		.data                   = &nss_jumbo_mru,
@@ -581,6 +678,20 @@ static struct ctl_table nss_general_table[] = {
 		.mode                   = 0644,
 		.proc_handler           = &nss_paged_mode_handler,
 	},
+	{
+		.procname               = "rx_list",
+		.data                   = &nss_rx_list,
+		.maxlen                 = sizeof(int),
+		.mode                   = 0644,
+		.proc_handler           = &nss_rx_list_handler,
+	},
+	{
+		.procname               = "napi_adapt",
+		.data                   = &nss_napi_adapt,
+		.maxlen                 = sizeof(int),
+		.mode                   = 0644,
+		.proc_handler           = &nss_napi_adapt_handler,
+	},
 	{ }
 };
 
@@ -706,11 +817,22 @@ static int __init nss_init(void)
 #endif /* NSS_DT_SUPPORT */
 	nss_top_main.nss_hal_common_init_done = false;
 
+	/*
+	 * Allocate per CPU driver statistics
+	 */
+	nss_top_main.stats_drv = __alloc_percpu(sizeof(uint64_t) * NSS_DRV_STATS_MAX, __alignof__(uint64_t));
+	if (!nss_top_main.stats_drv) {
+		nss_warning("Error allocating driver statistics\n");
+		return -ENOMEM;
+	}
+
 	/*
 	 * Initialize data_plane workqueue
 	 */
 	if (nss_data_plane_init_delay_work()) {
 		nss_warning("Error initializing nss_data_plane_workqueue\n");
+		free_percpu(nss_top_main.stats_drv);
+		nss_top_main.stats_drv = NULL;
 		return -EFAULT;
 	}
 
@@ -718,7 +840,6 @@ static int __init nss_init(void)
 	 * Enable spin locks
 	 */
 	spin_lock_init(&(nss_top_main.lock));
-	spin_lock_init(&(nss_top_main.stats_lock));
 	mutex_init(&(nss_top_main.wq_lock));
 
 	/*
@@ -731,6 +852,16 @@ static int __init nss_init(void)
 	 */
 	nss_strings_init();
 
+	/*
+	 * Enable the profiler sample collector.
+	 */
+	nss_profiler_collect_init();
+
+	/*
+	 * Register the self-test benchmark family.
+	 */
+	nss_bench_init();
+
 	/*
 	 * Register sysctl table.
 	 */
@@ -785,7 +916,7 @@ static int __init nss_init(void)
 	 */
 	nss_runtime_samples.freq_scale_index = 1;
 	nss_runtime_samples.freq_scale_ready = 0;
-	nss_runtime_samples.freq_scale_rate_limit_down = 0;
+	nss_freq_gov_reset(&nss_runtime_samples.gov);
 	nss_runtime_samples.buffer_index = 0;
 	nss_runtime_samples.sum = 0;
 	nss_runtime_samples.sample_count = 0;
@@ -896,6 +1027,28 @@ static void __exit nss_cleanup(void)
 	if (nss_dev_header)
 		unregister_sysctl_table(nss_dev_header);
 
+	/*
+	 * Stop any meminfo calibration still running
+	 */
+	nss_meminfo_calibrate_cancel();
+
+	/*
+	 * Stop the profiler sample collector
+	 */
+	nss_profiler_collect_exit();
+
+	/*
+	 * Unregister the self-test benchmark family
+	 */
+	nss_bench_exit();
+
+#ifdef NSS_DRV_DMA_ENABLE
+	/*
+	 * Complete the queued DMA copy jobs
+	 */
+	nss_dma_copy_exit();
+#endif
+
 	/*
 	 * Unregister n2h specific sysctl
 	 */
@@ -918,6 +1071,20 @@ static void __exit nss_cleanup(void)
 	 */
 	nss_pppoe_unregister_sysctl();
 
+	/*
+	 * Stop coalescing ipv4/6 rule messages before their handlers go away
+	 */
+	nss_ipv4_rule_batch_exit();
+#ifdef NSS_DRV_IPV6_ENABLE
+	nss_ipv6_rule_batch_exit();
+#endif
+
+	/*
+	 * Deliver the pending ipv4 inquiry answers and forget the accelerated connections
+	 */
+	nss_ipv4_flow_exit();
+	nss_ipv4_flow_flush();
+
 	/*
 	 * Unregister ipv4/6 specific sysctl and free allocated to connection tables
 	 */
@@ -929,6 +1096,14 @@ static void __exit nss_cleanup(void)
 	nss_ipv6_free_conn_tables();
 #endif
 
+#ifdef NSS_DRV_QRFS_ENABLE
+	nss_qrfs_exit();
+#endif
+
+#ifdef NSS_DRV_UDP_ST_ENABLE
+	nss_udp_st_nl_exit();
+#endif
+
 	nss_project_unregister_sysctl();
 	nss_data_plane_destroy_delay_work();
 
@@ -940,6 +1115,8 @@ static void __exit nss_cleanup(void)
 #endif
 
 	platform_driver_unregister(&nss_driver);
+
+	free_percpu(nss_top_main.stats_drv);
 }
 
 module_init(nss_init);
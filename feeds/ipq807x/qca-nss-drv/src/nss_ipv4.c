@@ -21,7 +21,9 @@
 #include <linux/sysctl.h>
 #include "nss_dscp_map.h"
 #include "nss_ipv4_stats.h"
+#include "nss_ipv4_flow.h"
 #include "nss_ipv4_strings.h"
+#include "nss_rule_batch.h"
 
 #define NSS_IPV4_TX_MSG_TIMEOUT 1000	/* 1 sec timeout for IPv4 messages */
 
@@ -46,6 +48,11 @@ struct nss_ipv4_conn_table_info {
 	unsigned long cme_mem;		/* Start address for connection match entry table */
 } nss_ipv4_ct_info;
 
+/*
+ * Coalescing state for nss_ipv4_tx_rule_coalesced()
+ */
+static struct nss_rule_batcher nss_ipv4_rule_batcher;
+
 int nss_ipv4_conn_cfg = NSS_DEFAULT_NUM_CONN;
 int nss_ipv4_accel_mode_cfg __read_mostly = 1;
 
@@ -91,6 +98,7 @@ static void nss_ipv4_rx_msg_handler(struct nss_ctx_instance *nss_ctx, struct nss
 {
 	struct nss_ipv4_msg *nim = (struct nss_ipv4_msg *)ncm;
 	nss_ipv4_msg_callback_t cb;
+	uint16_t i;
 
 	BUG_ON(ncm->interface != NSS_IPV4_RX_INTERFACE);
 
@@ -126,6 +134,7 @@ static void nss_ipv4_rx_msg_handler(struct nss_ctx_instance *nss_ctx, struct nss
 		 * Update driver statistics on connection sync.
 		 */
 		nss_ipv4_stats_conn_sync(nss_ctx, &nim->msg.conn_stats);
+		nss_ipv4_flow_sync(&nim->msg.conn_stats);
 		break;
 
 	case NSS_IPV4_TX_CONN_STATS_SYNC_MANY_MSG:
@@ -133,8 +142,28 @@ static void nss_ipv4_rx_msg_handler(struct nss_ctx_instance *nss_ctx, struct nss
 		 * Update driver statistics on connection sync many.
 		 */
 		nss_ipv4_stats_conn_sync_many(nss_ctx, &nim->msg.conn_stats_many);
+		if (nim->msg.conn_stats_many.count * sizeof(struct nss_ipv4_conn_sync) < nim->msg.conn_stats_many.size) {
+			for (i = 0; i < nim->msg.conn_stats_many.count; i++) {
+				nss_ipv4_flow_sync(&nim->msg.conn_stats_many.conn_sync[i]);
+			}
+		}
 		ncm->cb = (nss_ptr_t)nss_ipv4_conn_sync_many_msg_cb;
 		break;
+
+	case NSS_IPV4_TX_CREATE_RULE_MSG:
+		/*
+		 * Track the connections NSS accelerates.
+		 */
+		if (nim->cm.response == NSS_CMN_RESPONSE_ACK) {
+			nss_ipv4_flow_add(&nim->msg.rule_create);
+		}
+		break;
+
+	case NSS_IPV4_TX_DESTROY_RULE_MSG:
+		if (nim->cm.response == NSS_CMN_RESPONSE_ACK) {
+			nss_ipv4_flow_del(&nim->msg.rule_destroy.tuple);
+		}
+		break;
 	}
 
 	/*
@@ -214,6 +243,10 @@ EXPORT_SYMBOL(nss_ipv4_max_conn_count);
 /*
  * nss_ipv4_conn_inquiry()
  *	Inquiry if a connection has been established in NSS FW
+ *
+ * Connections in the host flow table are answered from it without a message
+ * to NSS; cb is still called asynchronously. Only unknown connections are
+ * asked of NSS.
  */
 nss_tx_status_t nss_ipv4_conn_inquiry(struct nss_ipv4_5tuple *ipv4_5t_p,
 				nss_ipv4_msg_callback_t cb)
@@ -233,6 +266,11 @@ nss_tx_status_t nss_ipv4_conn_inquiry(struct nss_ipv4_5tuple *ipv4_5t_p,
 			sizeof(struct nss_ipv4_inquiry_msg),
 			cb, NULL);
 	nim.msg.inquiry.rr.tuple = *ipv4_5t_p;
+
+	if (cb && nss_ipv4_flow_inquiry(&nim, cb)) {
+		return NSS_TX_SUCCESS;
+	}
+
 	nss_tx_status = nss_ipv4_tx(nss_ctx, &nim);
 	if (nss_tx_status != NSS_TX_SUCCESS) {
 		nss_warning("%px: Send inquiry message failed\n", ipv4_5t_p);
@@ -317,6 +355,87 @@ nss_tx_status_t nss_ipv4_tx_sync(struct nss_ctx_instance *nss_ctx, struct nss_ip
 }
 EXPORT_SYMBOL(nss_ipv4_tx_sync);
 
+/*
+ * nss_ipv4_rule_batch_log_tx()
+ *	Trace a message of the rule batcher.
+ */
+static void nss_ipv4_rule_batch_log_tx(struct nss_cmn_msg *ncm)
+{
+	nss_ipv4_log_tx_msg((struct nss_ipv4_msg *)ncm);
+}
+
+/*
+ * nss_ipv4_rule_batch_tx()
+ *	Send a single rule message for the rule batcher.
+ */
+static nss_tx_status_t nss_ipv4_rule_batch_tx(struct nss_ctx_instance *nss_ctx, struct nss_cmn_msg *ncm)
+{
+	return nss_ipv4_tx(nss_ctx, (struct nss_ipv4_msg *)ncm);
+}
+
+/*
+ * nss_ipv4_rule_batch_ack()
+ *	Track the connections NSS accelerates.
+ */
+static void nss_ipv4_rule_batch_ack(struct nss_cmn_msg *ncm)
+{
+	struct nss_ipv4_msg *nim = (struct nss_ipv4_msg *)ncm;
+
+	if (ncm->type == NSS_IPV4_TX_CREATE_RULE_MSG) {
+		nss_ipv4_flow_add(&nim->msg.rule_create);
+	} else {
+		nss_ipv4_flow_del(&nim->msg.rule_destroy.tuple);
+	}
+}
+
+/*
+ * nss_ipv4_rule_batch_ops
+ */
+static const struct nss_rule_batch_ops nss_ipv4_rule_batch_ops = {
+	.name = "IPv4",
+	.interface = NSS_IPV4_RX_INTERFACE,
+	.unknown_msg_error = NSS_IPV4_UNKNOWN_MSG_TYPE,
+	.msg_size = sizeof(struct nss_ipv4_msg),
+	.msg_rule = offsetof(struct nss_ipv4_msg, msg),
+	.msg_entry = offsetof(struct nss_ipv4_msg, msg.rule_create_many.entry),
+	.create = {
+		.type = NSS_IPV4_TX_CREATE_RULE_MSG,
+		.many_type = NSS_IPV4_TX_CREATE_RULE_MANY_MSG,
+		.rule_size = sizeof(struct nss_ipv4_rule_create_msg),
+		.entry_size = sizeof(struct nss_ipv4_rule_create_many_entry),
+		.entry_rule = offsetof(struct nss_ipv4_rule_create_many_entry, rule),
+	},
+	.destroy = {
+		.type = NSS_IPV4_TX_DESTROY_RULE_MSG,
+		.many_type = NSS_IPV4_TX_DESTROY_RULE_MANY_MSG,
+		.rule_size = sizeof(struct nss_ipv4_rule_destroy_msg),
+		.entry_size = sizeof(struct nss_ipv4_rule_destroy_many_entry),
+		.entry_rule = offsetof(struct nss_ipv4_rule_destroy_many_entry, rule),
+	},
+	.log_tx = nss_ipv4_rule_batch_log_tx,
+	.tx = nss_ipv4_rule_batch_tx,
+	.rule_ack = nss_ipv4_rule_batch_ack,
+};
+
+/*
+ * nss_ipv4_tx_rule_coalesced()
+ *	Queue an ipv4 create or destroy rule message to be sent with others.
+ */
+nss_tx_status_t nss_ipv4_tx_rule_coalesced(struct nss_ctx_instance *nss_ctx, struct nss_ipv4_msg *nim)
+{
+	return nss_rule_batcher_queue(&nss_ipv4_rule_batcher, nss_ctx, &nim->cm);
+}
+EXPORT_SYMBOL(nss_ipv4_tx_rule_coalesced);
+
+/*
+ * nss_ipv4_rule_batch_exit()
+ *	Stop coalescing ipv4 rule messages, failing the rules still queued.
+ */
+void nss_ipv4_rule_batch_exit(void)
+{
+	nss_rule_batcher_exit(&nss_ipv4_rule_batcher);
+}
+
 /*
  **********************************
  Register/Unregister/Miscellaneous APIs
@@ -396,8 +515,21 @@ void nss_ipv4_register_handler(void)
 		nss_warning("IPv4 handler failed to register");
 	}
 
+	/*
+	 * The rule batcher relies on both kinds of multiple rule messages sharing
+	 * the header and on every entry starting with its status.
+	 */
+	BUILD_BUG_ON(offsetof(struct nss_ipv4_msg, msg.rule_create_many.entry) != offsetof(struct nss_ipv4_msg, msg.rule_destroy_many.entry));
+	BUILD_BUG_ON(offsetof(struct nss_ipv4_msg, msg.rule_create_many.count) != offsetof(struct nss_ipv4_msg, msg.rule_destroy_many.count));
+	BUILD_BUG_ON(offsetof(struct nss_ipv4_msg, msg.rule_create_many.count) != offsetof(struct nss_ipv4_msg, msg));
+	BUILD_BUG_ON(offsetof(struct nss_ipv4_rule_create_many_entry, status) || offsetof(struct nss_ipv4_rule_destroy_many_entry, status));
+	BUILD_BUG_ON(sizeof(struct nss_ipv4_rule_many_status) != sizeof(struct nss_rule_many_status));
+	nss_rule_batcher_init(&nss_ipv4_rule_batcher, &nss_ipv4_rule_batch_ops);
+
 	nss_ipv4_stats_dentry_create();
 	nss_ipv4_strings_dentry_create();
+	nss_ipv4_flow_init();
+	nss_ipv4_flow_dentry_create();
 }
 
 /*
@@ -0,0 +1,471 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/*
+ * nss_ipv4_flow.c
+ *	Host copy of the IPv4 connections accelerated by NSS.
+ *
+ * Connections are added when NSS acknowledges a create rule message and
+ * removed when it acknowledges a destroy, or reports in a conn_sync that
+ * it flushed or evicted them. The table is emptied when the NSS core
+ * running IPv4 dies, since its connections die with it. Lookups, dumps and
+ * inquiries about known connections never go to the firmware.
+ */
+
+#include <linux/hashtable.h>
+#include <linux/jhash.h>
+#include <linux/seq_file.h>
+#include "nss_core.h"
+#include <nss_ipv4.h>
+#include "nss_ipv4_flow.h"
+
+#define NSS_IPV4_FLOW_HASH_BITS 12
+#define NSS_IPV4_FLOW_ITER_BATCH 4	/* Connections copied per lock hold while iterating */
+
+/*
+ * nss_ipv4_flow
+ *	Accelerated connection entry
+ */
+struct nss_ipv4_flow {
+	struct hlist_node node;		/* Hash bucket linkage */
+	struct nss_ipv4_flow_info info;	/* Connection information */
+	struct nss_ipv4_rule_create_msg rule;
+					/* Create rule NSS acknowledged, returned to inquiries */
+};
+
+/*
+ * nss_ipv4_flow_inquiry_work
+ *	Answer to an inquiry, delivered from the workqueue
+ */
+struct nss_ipv4_flow_inquiry_work {
+	struct work_struct work;	/* Runs the callback */
+	nss_ipv4_msg_callback_t cb;	/* Inquirer's callback */
+	struct nss_ipv4_msg nim;	/* Inquiry with its answer */
+};
+
+static DEFINE_HASHTABLE(nss_ipv4_flow_table, NSS_IPV4_FLOW_HASH_BITS);
+static DEFINE_SPINLOCK(nss_ipv4_flow_lock);
+static uint32_t nss_ipv4_flow_count;
+static uint32_t nss_ipv4_flow_overflow;
+static struct workqueue_struct *nss_ipv4_flow_wq;
+
+/*
+ * nss_ipv4_flow_hash()
+ *	Hash of a 5-tuple.
+ */
+static inline uint32_t nss_ipv4_flow_hash(uint32_t flow_ip, uint32_t flow_ident, uint32_t return_ip, uint32_t return_ident, uint8_t protocol)
+{
+	return jhash_3words(flow_ip, return_ip, (flow_ident << 16) ^ return_ident, protocol);
+}
+
+/*
+ * nss_ipv4_flow_find_locked()
+ *	Find a connection by its 5-tuple; called with nss_ipv4_flow_lock held.
+ */
+static struct nss_ipv4_flow *nss_ipv4_flow_find_locked(uint32_t flow_ip, uint32_t flow_ident, uint32_t return_ip, uint32_t return_ident, uint8_t protocol)
+{
+	struct nss_ipv4_flow *flow;
+	struct nss_ipv4_5tuple *tuple;
+	uint32_t hash = nss_ipv4_flow_hash(flow_ip, flow_ident, return_ip, return_ident, protocol);
+
+	hash_for_each_possible(nss_ipv4_flow_table, flow, node, hash) {
+		tuple = &flow->info.tuple;
+		if ((tuple->flow_ip == flow_ip) && (tuple->flow_ident == flow_ident)
+				&& (tuple->return_ip == return_ip) && (tuple->return_ident == return_ident)
+				&& (tuple->protocol == protocol)) {
+			return flow;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * nss_ipv4_flow_add()
+ *	Record a connection NSS acknowledged the create rule of.
+ */
+void nss_ipv4_flow_add(struct nss_ipv4_rule_create_msg *nircm)
+{
+	struct nss_ipv4_5tuple *tuple = &nircm->tuple;
+	struct nss_ipv4_flow *flow;
+	uint32_t hash;
+
+	spin_lock_bh(&nss_ipv4_flow_lock);
+	flow = nss_ipv4_flow_find_locked(tuple->flow_ip, tuple->flow_ident, tuple->return_ip, tuple->return_ident, tuple->protocol);
+	if (flow) {
+		flow->info.conn_rule = nircm->conn_rule;
+		flow->rule = *nircm;
+		spin_unlock_bh(&nss_ipv4_flow_lock);
+		return;
+	}
+
+	if (nss_ipv4_flow_count >= nss_ipv4_max_conn_count()) {
+		nss_ipv4_flow_overflow++;
+		spin_unlock_bh(&nss_ipv4_flow_lock);
+		return;
+	}
+
+	flow = kzalloc(sizeof(*flow), GFP_ATOMIC);
+	if (!flow) {
+		nss_ipv4_flow_overflow++;
+		spin_unlock_bh(&nss_ipv4_flow_lock);
+		return;
+	}
+
+	flow->info.tuple.flow_ip = tuple->flow_ip;
+	flow->info.tuple.flow_ident = tuple->flow_ident;
+	flow->info.tuple.return_ip = tuple->return_ip;
+	flow->info.tuple.return_ident = tuple->return_ident;
+	flow->info.tuple.protocol = tuple->protocol;
+	flow->info.conn_rule = nircm->conn_rule;
+	flow->info.last_sync = jiffies;
+	flow->rule = *nircm;
+
+	hash = nss_ipv4_flow_hash(tuple->flow_ip, tuple->flow_ident, tuple->return_ip, tuple->return_ident, tuple->protocol);
+	hash_add(nss_ipv4_flow_table, &flow->node, hash);
+	nss_ipv4_flow_count++;
+	spin_unlock_bh(&nss_ipv4_flow_lock);
+}
+
+/*
+ * nss_ipv4_flow_del()
+ *	Forget a connection NSS no longer accelerates.
+ */
+void nss_ipv4_flow_del(struct nss_ipv4_5tuple *tuple)
+{
+	struct nss_ipv4_flow *flow;
+
+	spin_lock_bh(&nss_ipv4_flow_lock);
+	flow = nss_ipv4_flow_find_locked(tuple->flow_ip, tuple->flow_ident, tuple->return_ip, tuple->return_ident, tuple->protocol);
+	if (flow) {
+		hash_del(&flow->node);
+		nss_ipv4_flow_count--;
+	}
+	spin_unlock_bh(&nss_ipv4_flow_lock);
+
+	kfree(flow);
+}
+
+/*
+ * nss_ipv4_flow_sync()
+ *	Update a connection from a conn_sync.
+ *
+ * The return address in a conn_sync may be reported before or after
+ * translation, so both are tried.
+ */
+void nss_ipv4_flow_sync(struct nss_ipv4_conn_sync *sync)
+{
+	struct nss_ipv4_flow *flow;
+
+	spin_lock_bh(&nss_ipv4_flow_lock);
+	flow = nss_ipv4_flow_find_locked(sync->flow_ip, sync->flow_ident, sync->return_ip, sync->return_ident, sync->protocol);
+	if (!flow) {
+		flow = nss_ipv4_flow_find_locked(sync->flow_ip, sync->flow_ident, sync->return_ip_xlate, sync->return_ident_xlate, sync->protocol);
+	}
+
+	if (!flow) {
+		spin_unlock_bh(&nss_ipv4_flow_lock);
+		return;
+	}
+
+	if (sync->reason != NSS_IPV4_RULE_SYNC_REASON_STATS) {
+		hash_del(&flow->node);
+		nss_ipv4_flow_count--;
+		spin_unlock_bh(&nss_ipv4_flow_lock);
+		kfree(flow);
+		return;
+	}
+
+	flow->info.flow_rx_packets += sync->flow_rx_packet_count;
+	flow->info.flow_rx_bytes += sync->flow_rx_byte_count;
+	flow->info.return_rx_packets += sync->return_rx_packet_count;
+	flow->info.return_rx_bytes += sync->return_rx_byte_count;
+	flow->info.last_sync = jiffies;
+	spin_unlock_bh(&nss_ipv4_flow_lock);
+}
+
+/*
+ * nss_ipv4_flow_flush()
+ *	Forget all connections, after NSS lost them.
+ */
+void nss_ipv4_flow_flush(void)
+{
+	struct nss_ipv4_flow *flow;
+	struct hlist_node *tmp;
+	int bkt;
+
+	spin_lock_bh(&nss_ipv4_flow_lock);
+	hash_for_each_safe(nss_ipv4_flow_table, bkt, tmp, flow, node) {
+		hash_del(&flow->node);
+		kfree(flow);
+	}
+	nss_ipv4_flow_count = 0;
+	spin_unlock_bh(&nss_ipv4_flow_lock);
+}
+
+/*
+ * nss_ipv4_flow_inquiry_work()
+ *	Deliver an inquiry answered from the host copy.
+ */
+static void nss_ipv4_flow_inquiry_work(struct work_struct *work)
+{
+	struct nss_ipv4_flow_inquiry_work *niw = container_of(work, struct nss_ipv4_flow_inquiry_work, work);
+
+	niw->cb(NULL, &niw->nim);
+	kfree(niw);
+}
+
+/*
+ * nss_ipv4_flow_inquiry()
+ *	Answer a connection inquiry from the host copy.
+ *
+ * The answer is the create rule NSS acknowledged for the connection. As
+ * with an answer from NSS, the callback runs later, from a workqueue, and
+ * never from the inquirer's context. Returns false if the connection
+ * is not known or the answer cannot be queued, in which case NSS has to be
+ * asked.
+ */
+bool nss_ipv4_flow_inquiry(struct nss_ipv4_msg *nim, nss_ipv4_msg_callback_t cb)
+{
+	struct nss_ipv4_5tuple *tuple = &nim->msg.inquiry.rr.tuple;
+	struct nss_ipv4_flow_inquiry_work *niw;
+	struct nss_ipv4_flow *flow;
+
+	if (!nss_ipv4_flow_wq) {
+		return false;
+	}
+
+	niw = kmalloc(sizeof(*niw), GFP_ATOMIC);
+	if (!niw) {
+		return false;
+	}
+
+	spin_lock_bh(&nss_ipv4_flow_lock);
+	flow = nss_ipv4_flow_find_locked(tuple->flow_ip, tuple->flow_ident, tuple->return_ip, tuple->return_ident, tuple->protocol);
+	if (!flow) {
+		spin_unlock_bh(&nss_ipv4_flow_lock);
+		kfree(niw);
+		return false;
+	}
+
+	niw->nim = *nim;
+	niw->nim.msg.inquiry.rr = flow->rule;
+	spin_unlock_bh(&nss_ipv4_flow_lock);
+
+	niw->nim.cm.response = NSS_CMN_RESPONSE_ACK;
+	niw->cb = cb;
+	INIT_WORK(&niw->work, nss_ipv4_flow_inquiry_work);
+	queue_work(nss_ipv4_flow_wq, &niw->work);
+	return true;
+}
+
+/*
+ * nss_ipv4_flow_find()
+ *	Look up an accelerated connection by its 5-tuple.
+ */
+bool nss_ipv4_flow_find(struct nss_ipv4_5tuple *tuple, struct nss_ipv4_flow_info *info)
+{
+	struct nss_ipv4_flow *flow;
+
+	spin_lock_bh(&nss_ipv4_flow_lock);
+	flow = nss_ipv4_flow_find_locked(tuple->flow_ip, tuple->flow_ident, tuple->return_ip, tuple->return_ident, tuple->protocol);
+	if (flow && info) {
+		*info = flow->info;
+	}
+	spin_unlock_bh(&nss_ipv4_flow_lock);
+
+	return flow != NULL;
+}
+EXPORT_SYMBOL(nss_ipv4_flow_find);
+
+/*
+ * nss_ipv4_flow_iterate()
+ *	Call cb for every accelerated connection until it returns false.
+ *
+ * The table is walked one bucket at a time and cb is given copies, made
+ * a few at a time under the lock and passed to cb after releasing it.
+ */
+uint32_t nss_ipv4_flow_iterate(nss_ipv4_flow_iter_callback_t cb, void *app_data)
+{
+	struct nss_ipv4_flow_info info[NSS_IPV4_FLOW_ITER_BATCH];
+	struct nss_ipv4_flow *flow;
+	uint32_t count = 0;
+	uint32_t skip, seen, n, i;
+	int bkt;
+
+	for (bkt = 0; bkt < HASH_SIZE(nss_ipv4_flow_table); bkt++) {
+		skip = 0;
+		do {
+			n = 0;
+			seen = 0;
+			spin_lock_bh(&nss_ipv4_flow_lock);
+			hlist_for_each_entry(flow, &nss_ipv4_flow_table[bkt], node) {
+				if (seen++ < skip) {
+					continue;
+				}
+
+				if (n == NSS_IPV4_FLOW_ITER_BATCH) {
+					break;
+				}
+
+				info[n++] = flow->info;
+			}
+			spin_unlock_bh(&nss_ipv4_flow_lock);
+
+			for (i = 0; i < n; i++) {
+				count++;
+				if (!cb(app_data, &info[i])) {
+					return count;
+				}
+			}
+
+			skip += n;
+		} while (n == NSS_IPV4_FLOW_ITER_BATCH);
+	}
+
+	return count;
+}
+EXPORT_SYMBOL(nss_ipv4_flow_iterate);
+
+/*
+ * nss_ipv4_flow_seq_start()
+ *	Start or resume a dump; position 0 is the header, position n is bucket n - 1.
+ */
+static void *nss_ipv4_flow_seq_start(struct seq_file *seq, loff_t *pos)
+{
+	if (*pos == 0) {
+		return SEQ_START_TOKEN;
+	}
+
+	if (*pos > HASH_SIZE(nss_ipv4_flow_table)) {
+		return NULL;
+	}
+
+	return &nss_ipv4_flow_table[*pos - 1];
+}
+
+/*
+ * nss_ipv4_flow_seq_next()
+ *	Move to the next bucket.
+ */
+static void *nss_ipv4_flow_seq_next(struct seq_file *seq, void *v, loff_t *pos)
+{
+	++*pos;
+	return nss_ipv4_flow_seq_start(seq, pos);
+}
+
+/*
+ * nss_ipv4_flow_seq_stop()
+ */
+static void nss_ipv4_flow_seq_stop(struct seq_file *seq, void *v)
+{
+}
+
+/*
+ * nss_ipv4_flow_seq_show()
+ *	Dump the accelerated connections of one bucket.
+ *
+ * The lock is only held for one bucket at a time, so a dump does not keep
+ * the rule and sync handlers out for the whole table. Connections added or
+ * removed during the dump may or may not be shown.
+ */
+static int nss_ipv4_flow_seq_show(struct seq_file *seq, void *v)
+{
+	struct hlist_head *bucket = v;
+	struct nss_ipv4_flow_info *info;
+	struct nss_ipv4_flow *flow;
+
+	spin_lock_bh(&nss_ipv4_flow_lock);
+	if (v == SEQ_START_TOKEN) {
+		seq_printf(seq, "flows: %u overflow: %u\n", nss_ipv4_flow_count, nss_ipv4_flow_overflow);
+		spin_unlock_bh(&nss_ipv4_flow_lock);
+		return 0;
+	}
+
+	hlist_for_each_entry(flow, bucket, node) {
+		info = &flow->info;
+		seq_printf(seq, "proto %u %pI4h:%u (%d) -> %pI4h:%u (%d) rx_pkts %llu/%llu rx_bytes %llu/%llu age %ums\n",
+				info->tuple.protocol,
+				&info->tuple.flow_ip, info->tuple.flow_ident, info->conn_rule.flow_interface_num,
+				&info->tuple.return_ip, info->tuple.return_ident, info->conn_rule.return_interface_num,
+				info->flow_rx_packets, info->return_rx_packets,
+				info->flow_rx_bytes, info->return_rx_bytes,
+				jiffies_to_msecs(jiffies - info->last_sync));
+	}
+	spin_unlock_bh(&nss_ipv4_flow_lock);
+
+	return 0;
+}
+
+static const struct seq_operations nss_ipv4_flow_seq_ops = {
+	.start = nss_ipv4_flow_seq_start,
+	.next  = nss_ipv4_flow_seq_next,
+	.stop  = nss_ipv4_flow_seq_stop,
+	.show  = nss_ipv4_flow_seq_show,
+};
+
+/*
+ * nss_ipv4_flow_open()
+ */
+static int nss_ipv4_flow_open(struct inode *inode, struct file *file)
+{
+	return seq_open(file, &nss_ipv4_flow_seq_ops);
+}
+
+static const struct file_operations nss_ipv4_flow_ops = {
+	.owner   = THIS_MODULE,
+	.open    = nss_ipv4_flow_open,
+	.read    = seq_read,
+	.llseek  = seq_lseek,
+	.release = seq_release,
+};
+
+/*
+ * nss_ipv4_flow_init()
+ *	Create the workqueue answering inquiries.
+ */
+void nss_ipv4_flow_init(void)
+{
+	nss_ipv4_flow_wq = alloc_workqueue("nss_ipv4_flow", WQ_MEM_RECLAIM, 0);
+	if (!nss_ipv4_flow_wq) {
+		nss_warning("Failed to create the IPv4 flow workqueue, inquiries go to NSS\n");
+	}
+}
+
+/*
+ * nss_ipv4_flow_exit()
+ *	Deliver the queued inquiry answers and destroy the workqueue.
+ */
+void nss_ipv4_flow_exit(void)
+{
+	if (!nss_ipv4_flow_wq) {
+		return;
+	}
+
+	destroy_workqueue(nss_ipv4_flow_wq);
+	nss_ipv4_flow_wq = NULL;
+}
+
+/*
+ * nss_ipv4_flow_dentry_create()
+ *	Create the ipv4_flows file in debugfs.
+ */
+void nss_ipv4_flow_dentry_create(void)
+{
+	if (!debugfs_create_file("ipv4_flows", 0400, nss_top_main.top_dentry, NULL, &nss_ipv4_flow_ops)) {
+		nss_warning("Failed to create qca-nss-drv/ipv4_flows file in debugfs");
+	}
+}
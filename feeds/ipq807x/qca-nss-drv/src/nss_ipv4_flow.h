@@ -0,0 +1,30 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+#ifndef __NSS_IPV4_FLOW_H
+#define __NSS_IPV4_FLOW_H
+
+/*
+ * NSS IPV4 host flow table APIs
+ */
+extern void nss_ipv4_flow_add(struct nss_ipv4_rule_create_msg *nircm);
+extern void nss_ipv4_flow_del(struct nss_ipv4_5tuple *tuple);
+extern void nss_ipv4_flow_sync(struct nss_ipv4_conn_sync *sync);
+extern bool nss_ipv4_flow_inquiry(struct nss_ipv4_msg *nim, nss_ipv4_msg_callback_t cb);
+extern void nss_ipv4_flow_init(void);
+extern void nss_ipv4_flow_dentry_create(void);
+
+#endif /* __NSS_IPV4_FLOW_H */
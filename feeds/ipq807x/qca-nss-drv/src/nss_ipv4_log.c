@@ -34,6 +34,13 @@ static int8_t *nss_ipv4_log_message_types_str[NSS_IPV4_MAX_MSG_TYPES] __maybe_un
 	"IPv4 number of connections supported rule message",
 	"IPv4 multicast create rule message",
 	"IPv4 request FW to send many conn sync message",
+	"IPv4 acceleration mode configuration message",
+	"IPv4 connection inquiry message",
+	"IPv4 connection table size message",
+	"IPv4 DSCP to priority configuration message",
+	"IPv4 RPS hash bitmap configuration message",
+	"IPv4 create many rules message",
+	"IPv4 destroy many rules message",
 };
 
 /*
@@ -263,6 +270,21 @@ static void nss_ipv4_log_conn_sync_many_msg(struct nss_ipv4_msg *nim)
 	}
 }
 
+/*
+ * nss_ipv4_log_rule_many_msg()
+ *	Log IPv4 create or destroy many rules message.
+ */
+static void nss_ipv4_log_rule_many_msg(struct nss_ipv4_msg *nim)
+{
+	struct nss_ipv4_rule_create_many_msg *nircmm = &nim->msg.rule_create_many;
+	nss_trace("%px: IPv4 rule many message\n"
+		"count: %u\n"
+		"size: %u\n",
+		nim,
+		nircmm->count,
+		nircmm->size);
+}
+
 /*
  * nss_ipv4_log_verbose()
  *	Log message contents.
@@ -298,6 +320,11 @@ static void nss_ipv4_log_verbose(struct nss_ipv4_msg *nim)
 		nss_ipv4_log_conn_sync_many_msg(nim);
 		break;
 
+	case NSS_IPV4_TX_CREATE_RULE_MANY_MSG:
+	case NSS_IPV4_TX_DESTROY_RULE_MANY_MSG:
+		nss_ipv4_log_rule_many_msg(nim);
+		break;
+
 	default:
 		nss_trace("%px: Invalid message type\n", nim);
 		break;
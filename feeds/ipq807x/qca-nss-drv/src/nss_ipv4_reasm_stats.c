@@ -25,6 +25,11 @@
  */
 ATOMIC_NOTIFIER_HEAD(nss_ipv4_reasm_stats_notifier);
 
+/*
+ * Statistics domain for IPv4 reassembly; the sync handler below updates under it.
+ */
+static struct nss_stats_domain nss_ipv4_reasm_stats_domain = NSS_STATS_DOMAIN_INIT(nss_ipv4_reasm_stats_domain);
+
 uint64_t nss_ipv4_reasm_stats[NSS_IPV4_REASM_STATS_MAX]; /* IPv4 reasm statistics */
 
 /*
@@ -33,8 +38,6 @@ uint64_t nss_ipv4_reasm_stats[NSS_IPV4_REASM_STATS_MAX]; /* IPv4 reasm statistic
  */
 static ssize_t nss_ipv4_reasm_stats_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos)
 {
-	int32_t i;
-
 	/*
 	 * Max output lines = #stats + few blank lines for banner printing +
 	 * Number of Extra outputlines for future reference to add new stats
@@ -65,12 +68,7 @@ static ssize_t nss_ipv4_reasm_stats_read(struct file *fp, char __user *ubuf, siz
 	/*
 	 * IPv4 reasm node stats
 	 */
-	spin_lock_bh(&nss_top_main.stats_lock);
-	for (i = 0; (i < NSS_IPV4_REASM_STATS_MAX); i++) {
-		stats_shadow[i] = nss_ipv4_reasm_stats[i];
-	}
-
-	spin_unlock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_copy(&nss_ipv4_reasm_stats_domain, stats_shadow, nss_ipv4_reasm_stats, sizeof(*stats_shadow) * NSS_IPV4_REASM_STATS_MAX);
 	size_wr += nss_stats_print("ipv4_reasm", NULL, NSS_STATS_SINGLE_INSTANCE
 					, nss_ipv4_reasm_strings_stats
 					, stats_shadow
@@ -94,6 +92,11 @@ NSS_STATS_DECLARE_FILE_OPERATIONS(ipv4_reasm);
  */
 void nss_ipv4_reasm_stats_dentry_create(void)
 {
+	/*
+	 * The node sync handler updates the common node stats under the domain
+	 */
+	nss_stats_domain_own_node(&nss_ipv4_reasm_stats_domain, NSS_IPV4_REASM_INTERFACE);
+
 	nss_stats_create_dentry("ipv4_reasm", &nss_ipv4_reasm_stats_ops);
 }
 
@@ -106,7 +109,7 @@ void nss_ipv4_reasm_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss_ipv4
 	int i;
 	struct nss_top_instance *nss_top = nss_ctx->nss_top;
 
-	spin_lock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_begin(&nss_ipv4_reasm_stats_domain);
 
 	/*
 	 * Common node stats
@@ -127,7 +130,7 @@ void nss_ipv4_reasm_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss_ipv4
 	nss_ipv4_reasm_stats[NSS_IPV4_REASM_STATS_ALLOC_FAILS] += nirs->ipv4_reasm_alloc_fails;
 	nss_ipv4_reasm_stats[NSS_IPV4_REASM_STATS_TIMEOUTS] += nirs->ipv4_reasm_timeouts;
 
-	spin_unlock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_end(&nss_ipv4_reasm_stats_domain);
 }
 
 /*
@@ -141,8 +144,8 @@ void nss_ipv4_reasm_stats_notify(struct nss_ctx_instance *nss_ctx)
 	struct nss_ipv4_reasm_stats_notification ipv4_reasm_stats;
 
 	ipv4_reasm_stats.core_id = nss_ctx->id;
-	memcpy(ipv4_reasm_stats.cmn_node_stats, nss_top_main.stats_node[NSS_IPV4_REASM_INTERFACE], sizeof(ipv4_reasm_stats.cmn_node_stats));
-	memcpy(ipv4_reasm_stats.ipv4_reasm_stats, nss_ipv4_reasm_stats, sizeof(ipv4_reasm_stats.ipv4_reasm_stats));
+	nss_stats_domain_copy(&nss_ipv4_reasm_stats_domain, ipv4_reasm_stats.cmn_node_stats, nss_top_main.stats_node[NSS_IPV4_REASM_INTERFACE], sizeof(ipv4_reasm_stats.cmn_node_stats));
+	nss_stats_domain_copy(&nss_ipv4_reasm_stats_domain, ipv4_reasm_stats.ipv4_reasm_stats, nss_ipv4_reasm_stats, sizeof(ipv4_reasm_stats.ipv4_reasm_stats));
 	atomic_notifier_call_chain(&nss_ipv4_reasm_stats_notifier, NSS_STATS_EVENT_NOTIFY, (void *)&ipv4_reasm_stats);
 }
 
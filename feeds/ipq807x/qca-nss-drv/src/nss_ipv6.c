@@ -22,6 +22,7 @@
 #include "nss_dscp_map.h"
 #include "nss_ipv6_stats.h"
 #include "nss_ipv6_strings.h"
+#include "nss_rule_batch.h"
 
 #define NSS_IPV6_TX_MSG_TIMEOUT 1000	/* 1 sec timeout for IPv6 messages */
 
@@ -46,6 +47,11 @@ struct nss_ipv6_conn_table_info {
 	unsigned long cme_mem;		/* Start address for connection match entry table */
 } nss_ipv6_ct_info;
 
+/*
+ * Coalescing state for nss_ipv6_tx_rule_coalesced()
+ */
+static struct nss_rule_batcher nss_ipv6_rule_batcher;
+
 int nss_ipv6_conn_cfg = NSS_DEFAULT_NUM_CONN;
 int nss_ipv6_accel_mode_cfg __read_mostly = 1;
 
@@ -306,6 +312,72 @@ nss_tx_status_t nss_ipv6_tx_sync(struct nss_ctx_instance *nss_ctx, struct nss_ip
 }
 EXPORT_SYMBOL(nss_ipv6_tx_sync);
 
+/*
+ * nss_ipv6_rule_batch_log_tx()
+ *	Trace a message of the rule batcher.
+ */
+static void nss_ipv6_rule_batch_log_tx(struct nss_cmn_msg *ncm)
+{
+	nss_ipv6_log_tx_msg((struct nss_ipv6_msg *)ncm);
+}
+
+/*
+ * nss_ipv6_rule_batch_tx()
+ *	Send a single rule message for the rule batcher.
+ */
+static nss_tx_status_t nss_ipv6_rule_batch_tx(struct nss_ctx_instance *nss_ctx, struct nss_cmn_msg *ncm)
+{
+	return nss_ipv6_tx(nss_ctx, (struct nss_ipv6_msg *)ncm);
+}
+
+/*
+ * nss_ipv6_rule_batch_ops
+ */
+static const struct nss_rule_batch_ops nss_ipv6_rule_batch_ops = {
+	.name = "IPv6",
+	.interface = NSS_IPV6_RX_INTERFACE,
+	.unknown_msg_error = NSS_IPV6_UNKNOWN_MSG_TYPE,
+	.msg_size = sizeof(struct nss_ipv6_msg),
+	.msg_rule = offsetof(struct nss_ipv6_msg, msg),
+	.msg_entry = offsetof(struct nss_ipv6_msg, msg.rule_create_many.entry),
+	.create = {
+		.type = NSS_IPV6_TX_CREATE_RULE_MSG,
+		.many_type = NSS_IPV6_TX_CREATE_RULE_MANY_MSG,
+		.rule_size = sizeof(struct nss_ipv6_rule_create_msg),
+		.entry_size = sizeof(struct nss_ipv6_rule_create_many_entry),
+		.entry_rule = offsetof(struct nss_ipv6_rule_create_many_entry, rule),
+	},
+	.destroy = {
+		.type = NSS_IPV6_TX_DESTROY_RULE_MSG,
+		.many_type = NSS_IPV6_TX_DESTROY_RULE_MANY_MSG,
+		.rule_size = sizeof(struct nss_ipv6_rule_destroy_msg),
+		.entry_size = sizeof(struct nss_ipv6_rule_destroy_many_entry),
+		.entry_rule = offsetof(struct nss_ipv6_rule_destroy_many_entry, rule),
+	},
+	.log_tx = nss_ipv6_rule_batch_log_tx,
+	.tx = nss_ipv6_rule_batch_tx,
+	.rule_ack = NULL,
+};
+
+/*
+ * nss_ipv6_tx_rule_coalesced()
+ *	Queue an ipv6 create or destroy rule message to be sent with others.
+ */
+nss_tx_status_t nss_ipv6_tx_rule_coalesced(struct nss_ctx_instance *nss_ctx, struct nss_ipv6_msg *nim)
+{
+	return nss_rule_batcher_queue(&nss_ipv6_rule_batcher, nss_ctx, &nim->cm);
+}
+EXPORT_SYMBOL(nss_ipv6_tx_rule_coalesced);
+
+/*
+ * nss_ipv6_rule_batch_exit()
+ *	Stop coalescing ipv6 rule messages, failing the rules still queued.
+ */
+void nss_ipv6_rule_batch_exit(void)
+{
+	nss_rule_batcher_exit(&nss_ipv6_rule_batcher);
+}
+
 /*
  **********************************
  Register/Unregister/Miscellaneous APIs
@@ -385,6 +457,17 @@ void nss_ipv6_register_handler()
 		nss_warning("IPv6 handler failed to register");
 	}
 
+	/*
+	 * The rule batcher relies on both kinds of multiple rule messages sharing
+	 * the header and on every entry starting with its status.
+	 */
+	BUILD_BUG_ON(offsetof(struct nss_ipv6_msg, msg.rule_create_many.entry) != offsetof(struct nss_ipv6_msg, msg.rule_destroy_many.entry));
+	BUILD_BUG_ON(offsetof(struct nss_ipv6_msg, msg.rule_create_many.count) != offsetof(struct nss_ipv6_msg, msg.rule_destroy_many.count));
+	BUILD_BUG_ON(offsetof(struct nss_ipv6_msg, msg.rule_create_many.count) != offsetof(struct nss_ipv6_msg, msg));
+	BUILD_BUG_ON(offsetof(struct nss_ipv6_rule_create_many_entry, status) || offsetof(struct nss_ipv6_rule_destroy_many_entry, status));
+	BUILD_BUG_ON(sizeof(struct nss_ipv6_rule_many_status) != sizeof(struct nss_rule_many_status));
+	nss_rule_batcher_init(&nss_ipv6_rule_batcher, &nss_ipv6_rule_batch_ops);
+
 	nss_ipv6_stats_dentry_create();
 	nss_ipv6_strings_dentry_create();
 }
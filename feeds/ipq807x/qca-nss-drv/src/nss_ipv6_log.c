@@ -45,6 +45,13 @@ static int8_t *nss_ipv6_log_message_types_str[NSS_IPV6_MAX_MSG_TYPES] __maybe_un
 	"IPv6 number of connections supported rule message",
 	"IPv6 multicast create rule message",
 	"IPv6 request FW to send many conn sync message",
+	"IPv6 acceleration mode configuration message",
+	"IPv6 connection inquiry message",
+	"IPv6 connection table size message",
+	"IPv6 DSCP to priority configuration message",
+	"IPv6 RPS hash bitmap configuration message",
+	"IPv6 create many rules message",
+	"IPv6 destroy many rules message",
 };
 
 /*
@@ -300,6 +307,21 @@ static void nss_ipv6_log_conn_sync_many_msg(struct nss_ipv6_msg *nim)
 	}
 }
 
+/*
+ * nss_ipv6_log_rule_many_msg()
+ *	Log IPv6 create or destroy many rules message.
+ */
+static void nss_ipv6_log_rule_many_msg(struct nss_ipv6_msg *nim)
+{
+	struct nss_ipv6_rule_create_many_msg *nircmm = &nim->msg.rule_create_many;
+	nss_trace("%px: IPv6 rule many message\n"
+		"count: %u\n"
+		"size: %u\n",
+		nim,
+		nircmm->count,
+		nircmm->size);
+}
+
 /*
  * nss_ipv6_log_verbose()
  *	Log message contents.
@@ -335,6 +357,11 @@ static void nss_ipv6_log_verbose(struct nss_ipv6_msg *nim)
 		nss_ipv6_log_conn_sync_many_msg(nim);
 		break;
 
+	case NSS_IPV6_TX_CREATE_RULE_MANY_MSG:
+	case NSS_IPV6_TX_DESTROY_RULE_MANY_MSG:
+		nss_ipv6_log_rule_many_msg(nim);
+		break;
+
 	default:
 		nss_trace("%px: Invalid message type\n", nim);
 		break;
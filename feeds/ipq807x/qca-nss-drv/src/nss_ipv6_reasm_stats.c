@@ -24,6 +24,11 @@
  */
 ATOMIC_NOTIFIER_HEAD(nss_ipv6_reasm_stats_notifier);
 
+/*
+ * Statistics domain for IPv6 reassembly; the sync handler below updates under it.
+ */
+static struct nss_stats_domain nss_ipv6_reasm_stats_domain = NSS_STATS_DOMAIN_INIT(nss_ipv6_reasm_stats_domain);
+
 uint64_t nss_ipv6_reasm_stats[NSS_IPV6_REASM_STATS_MAX]; /* IPv6 reasm statistics */
 
 /*
@@ -32,7 +37,6 @@ uint64_t nss_ipv6_reasm_stats[NSS_IPV6_REASM_STATS_MAX]; /* IPv6 reasm statistic
  */
 static ssize_t nss_ipv6_reasm_stats_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos)
 {
-	int32_t i;
 	/*
 	 * Max output lines = #stats + few blank lines for banner printing +
 	 * Number of Extra outputlines for future reference to add new stats
@@ -64,12 +68,7 @@ static ssize_t nss_ipv6_reasm_stats_read(struct file *fp, char __user *ubuf, siz
 	 * Ipv6 reasm node stats
 	 */
 
-	spin_lock_bh(&nss_top_main.stats_lock);
-	for (i = 0; (i < NSS_IPV6_REASM_STATS_MAX); i++) {
-		stats_shadow[i] = nss_ipv6_reasm_stats[i];
-	}
-
-	spin_unlock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_copy(&nss_ipv6_reasm_stats_domain, stats_shadow, nss_ipv6_reasm_stats, sizeof(*stats_shadow) * NSS_IPV6_REASM_STATS_MAX);
 
 	size_wr += nss_stats_print("ipv6_reasm", NULL, NSS_STATS_SINGLE_INSTANCE
 					, nss_ipv6_reasm_strings_stats
@@ -94,6 +93,11 @@ NSS_STATS_DECLARE_FILE_OPERATIONS(ipv6_reasm);
  */
 void nss_ipv6_reasm_stats_dentry_create(void)
 {
+	/*
+	 * The node sync handler updates the common node stats under the domain
+	 */
+	nss_stats_domain_own_node(&nss_ipv6_reasm_stats_domain, NSS_IPV6_REASM_INTERFACE);
+
 	nss_stats_create_dentry("ipv6_reasm", &nss_ipv6_reasm_stats_ops);
 }
 
@@ -106,7 +110,7 @@ void nss_ipv6_reasm_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss_ipv6
 	struct nss_top_instance *nss_top = nss_ctx->nss_top;
 	int j;
 
-	spin_lock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_begin(&nss_ipv6_reasm_stats_domain);
 
 	/*
 	 * Common node stats
@@ -127,7 +131,7 @@ void nss_ipv6_reasm_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss_ipv6
 	nss_ipv6_reasm_stats[NSS_IPV6_REASM_STATS_TIMEOUTS] += nirs->ipv6_reasm_timeouts;
 	nss_ipv6_reasm_stats[NSS_IPV6_REASM_STATS_DISCARDS] += nirs->ipv6_reasm_discards;
 
-	spin_unlock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_end(&nss_ipv6_reasm_stats_domain);
 }
 
 /*
@@ -141,8 +145,8 @@ void nss_ipv6_reasm_stats_notify(struct nss_ctx_instance *nss_ctx)
 	struct nss_ipv6_reasm_stats_notification ipv6_reasm_stats;
 
 	ipv6_reasm_stats.core_id = nss_ctx->id;
-	memcpy(ipv6_reasm_stats.cmn_node_stats, nss_top_main.stats_node[NSS_IPV6_REASM_INTERFACE], sizeof(ipv6_reasm_stats.cmn_node_stats));
-	memcpy(ipv6_reasm_stats.ipv6_reasm_stats, nss_ipv6_reasm_stats, sizeof(ipv6_reasm_stats.ipv6_reasm_stats));
+	nss_stats_domain_copy(&nss_ipv6_reasm_stats_domain, ipv6_reasm_stats.cmn_node_stats, nss_top_main.stats_node[NSS_IPV6_REASM_INTERFACE], sizeof(ipv6_reasm_stats.cmn_node_stats));
+	nss_stats_domain_copy(&nss_ipv6_reasm_stats_domain, ipv6_reasm_stats.ipv6_reasm_stats, nss_ipv6_reasm_stats, sizeof(ipv6_reasm_stats.ipv6_reasm_stats));
 	atomic_notifier_call_chain(&nss_ipv6_reasm_stats_notifier, NSS_STATS_EVENT_NOTIFY, (void *)&ipv6_reasm_stats);
 }
 
@@ -24,26 +24,35 @@
  */
 ATOMIC_NOTIFIER_HEAD(nss_ipv6_stats_notifier);
 
+/*
+ * Statistics domain for IPv6; the sync handlers below update under it.
+ */
+static struct nss_stats_domain nss_ipv6_stats_domain = NSS_STATS_DOMAIN_INIT(nss_ipv6_stats_domain);
+
 uint64_t nss_ipv6_stats[NSS_IPV6_STATS_MAX];
 uint64_t nss_ipv6_exception_stats[NSS_IPV6_EXCEPTION_EVENT_MAX];
 
+/*
+ * Time spent processing conn_sync and conn_sync_many messages
+ */
+static struct nss_stats_hist nss_ipv6_conn_sync_hist;
+
 /*
  * nss_ipv6_stats_read()
  *	Read IPV6 stats.
  */
 static ssize_t nss_ipv6_stats_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos)
 {
-	int32_t i;
-
 	/*
 	 * max output lines = #stats + Number of Extra outputlines for future reference to add new stats +
 	 * start tag line + end tag line + three blank lines.
 	 */
-	uint32_t max_output_lines = NSS_STATS_NODE_MAX + NSS_IPV6_STATS_MAX + NSS_IPV6_EXCEPTION_EVENT_MAX + NSS_STATS_EXTRA_OUTPUT_LINES;
+	uint32_t max_output_lines = NSS_STATS_NODE_MAX + NSS_IPV6_STATS_MAX + NSS_IPV6_EXCEPTION_EVENT_MAX + NSS_STATS_HIST_BUCKETS + NSS_STATS_EXTRA_OUTPUT_LINES;
 	size_t size_al = NSS_STATS_MAX_STR_LENGTH * max_output_lines;
 	size_t size_wr = 0;
 	ssize_t bytes_read = 0;
 	uint64_t *stats_shadow;
+	struct nss_stats_hist hist;
 
 	char *lbuf = kzalloc(size_al, GFP_KERNEL);
 	if (unlikely(lbuf == NULL)) {
@@ -62,17 +71,12 @@ static ssize_t nss_ipv6_stats_read(struct file *fp, char __user *ubuf, size_t sz
 	}
 
 	size_wr += nss_stats_banner(lbuf, size_wr, size_al, "ipv6", NSS_STATS_SINGLE_CORE);
-	size_wr += nss_stats_fill_common_stats(NSS_IPV6_RX_INTERFACE, NSS_STATS_SINGLE_INSTANCE, lbuf, size_wr, size_al, "ipv6");
+	size_wr += nss_stats_domain_fill_common_stats(&nss_ipv6_stats_domain, NSS_IPV6_RX_INTERFACE, NSS_STATS_SINGLE_INSTANCE, lbuf, size_wr, size_al, "ipv6");
 
 	/*
 	 * IPv6 node stats
 	 */
-	spin_lock_bh(&nss_top_main.stats_lock);
-	for (i = 0; (i < NSS_IPV6_STATS_MAX); i++) {
-		stats_shadow[i] = nss_ipv6_stats[i];
-	}
-
-	spin_unlock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_copy(&nss_ipv6_stats_domain, stats_shadow, nss_ipv6_stats, sizeof(nss_ipv6_stats));
 
 	size_wr += nss_stats_print("ipv6", "ipv6 node stats", NSS_STATS_SINGLE_INSTANCE
 					, nss_ipv6_strings_stats
@@ -83,17 +87,20 @@ static ssize_t nss_ipv6_stats_read(struct file *fp, char __user *ubuf, size_t sz
 	/*
 	 * Exception stats
 	 */
-	spin_lock_bh(&nss_top_main.stats_lock);
-	for (i = 0; (i < NSS_IPV6_EXCEPTION_EVENT_MAX); i++) {
-		stats_shadow[i] = nss_ipv6_exception_stats[i];
-	}
-	spin_unlock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_copy(&nss_ipv6_stats_domain, stats_shadow, nss_ipv6_exception_stats, sizeof(nss_ipv6_exception_stats));
 
 	size_wr += nss_stats_print("ipv6", "ipv6 exception stats", NSS_STATS_SINGLE_INSTANCE
 					, nss_ipv6_strings_exception_stats
 					, stats_shadow
 					, NSS_IPV6_EXCEPTION_EVENT_MAX
 					, lbuf, size_wr, size_al);
+
+	/*
+	 * Connection sync processing time
+	 */
+	nss_stats_domain_copy(&nss_ipv6_stats_domain, &hist, &nss_ipv6_conn_sync_hist, sizeof(hist));
+	size_wr += nss_stats_hist_print("ipv6_conn_sync", "ipv6 conn sync time", &hist, lbuf, size_wr, size_al);
+
 	bytes_read = simple_read_from_buffer(ubuf, sz, ppos, lbuf, strlen(lbuf));
 	kfree(lbuf);
 	kfree(stats_shadow);
@@ -101,31 +108,84 @@ static ssize_t nss_ipv6_stats_read(struct file *fp, char __user *ubuf, size_t sz
 	return bytes_read;
 }
 
+/*
+ * nss_ipv6_stats_bin_read()
+ *	Read IPV6 stats in binary form.
+ *
+ * Blocks: common node stats, special stats, exception stats.
+ */
+static ssize_t nss_ipv6_stats_bin_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos)
+{
+	size_t size_al, size_wr;
+	ssize_t bytes_read;
+	uint64_t *counters;
+	char *buf;
+
+	buf = nss_stats_bin_alloc(3, NSS_STATS_NODE_MAX + NSS_IPV6_STATS_MAX + NSS_IPV6_EXCEPTION_EVENT_MAX, &size_al, &size_wr);
+	if (unlikely(!buf)) {
+		return 0;
+	}
+
+	counters = nss_stats_bin_add_block(buf, &size_wr, size_al, NSS_STATS_NODE_MAX);
+	if (unlikely(!counters)) {
+		goto done;
+	}
+
+	nss_stats_domain_copy(&nss_ipv6_stats_domain, counters, nss_top_main.stats_node[NSS_IPV6_RX_INTERFACE],
+				NSS_STATS_NODE_MAX * sizeof(uint64_t));
+
+	counters = nss_stats_bin_add_block(buf, &size_wr, size_al, NSS_IPV6_STATS_MAX);
+	if (unlikely(!counters)) {
+		goto done;
+	}
+
+	nss_stats_domain_copy(&nss_ipv6_stats_domain, counters, nss_ipv6_stats, sizeof(nss_ipv6_stats));
+
+	counters = nss_stats_bin_add_block(buf, &size_wr, size_al, NSS_IPV6_EXCEPTION_EVENT_MAX);
+	if (unlikely(!counters)) {
+		goto done;
+	}
+
+	nss_stats_domain_copy(&nss_ipv6_stats_domain, counters, nss_ipv6_exception_stats, sizeof(nss_ipv6_exception_stats));
+
+done:
+	bytes_read = simple_read_from_buffer(ubuf, sz, ppos, buf, size_wr);
+	kfree(buf);
+
+	return bytes_read;
+}
+
 /*
  * nss_ipv6_stats_conn_sync()
  *	Update driver specific information from the messsage.
  */
 void nss_ipv6_stats_conn_sync(struct nss_ctx_instance *nss_ctx, struct nss_ipv6_conn_sync *nics)
 {
-	struct nss_top_instance *nss_top = nss_ctx->nss_top;
+	uint64_t sum[NSS_STATS_CONN_SYNC_MAX] = {0};
+	ktime_t start = ktime_get();
+
+	BUILD_BUG_ON(NSS_IPV6_STATS_ACCELERATED_RX_BYTES - NSS_IPV6_STATS_ACCELERATED_RX_PKTS != NSS_STATS_CONN_SYNC_RX_BYTES);
+	BUILD_BUG_ON(NSS_IPV6_STATS_ACCELERATED_TX_PKTS - NSS_IPV6_STATS_ACCELERATED_RX_PKTS != NSS_STATS_CONN_SYNC_TX_PKTS);
+	BUILD_BUG_ON(NSS_IPV6_STATS_ACCELERATED_TX_BYTES - NSS_IPV6_STATS_ACCELERATED_RX_PKTS != NSS_STATS_CONN_SYNC_TX_BYTES);
 
 	/*
 	 * Update statistics maintained by NSS driver
 	 */
-	spin_lock_bh(&nss_top->stats_lock);
-	nss_ipv6_stats[NSS_IPV6_STATS_ACCELERATED_RX_PKTS] += nics->flow_rx_packet_count + nics->return_rx_packet_count;
-	nss_ipv6_stats[NSS_IPV6_STATS_ACCELERATED_RX_BYTES] += nics->flow_rx_byte_count + nics->return_rx_byte_count;
-	nss_ipv6_stats[NSS_IPV6_STATS_ACCELERATED_TX_PKTS] += nics->flow_tx_packet_count + nics->return_tx_packet_count;
-	nss_ipv6_stats[NSS_IPV6_STATS_ACCELERATED_TX_BYTES] += nics->flow_tx_byte_count + nics->return_tx_byte_count;
-	spin_unlock_bh(&nss_top->stats_lock);
+	NSS_STATS_CONN_SYNC_ACCUMULATE(sum, nics);
+	nss_stats_conn_sync_commit(&nss_ipv6_stats_domain, &nss_ipv6_stats[NSS_IPV6_STATS_ACCELERATED_RX_PKTS], sum,
+					&nss_ipv6_conn_sync_hist, start);
 }
 
 /*
  * nss_ipv6_stats_conn_sync_many()
  *	Update driver specific information from the conn_sync_many messsage.
+ *
+ * The entries are summed locally and committed once per message.
  */
 void nss_ipv6_stats_conn_sync_many(struct nss_ctx_instance *nss_ctx, struct nss_ipv6_conn_sync_many_msg *nicsm)
 {
+	uint64_t sum[NSS_STATS_CONN_SYNC_MAX] = {0};
+	ktime_t start = ktime_get();
 	uint32_t i;
 
 	/*
@@ -137,8 +197,11 @@ void nss_ipv6_stats_conn_sync_many(struct nss_ctx_instance *nss_ctx, struct nss_
 	}
 
 	for (i = 0; i < nicsm->count; i++) {
-		nss_ipv6_stats_conn_sync(nss_ctx, &nicsm->conn_sync[i]);
+		NSS_STATS_CONN_SYNC_ACCUMULATE(sum, &nicsm->conn_sync[i]);
 	}
+
+	nss_stats_conn_sync_commit(&nss_ipv6_stats_domain, &nss_ipv6_stats[NSS_IPV6_STATS_ACCELERATED_RX_PKTS], sum,
+					&nss_ipv6_conn_sync_hist, start);
 }
 
 /*
@@ -153,7 +216,7 @@ void nss_ipv6_stats_node_sync(struct nss_ctx_instance *nss_ctx, struct nss_ipv6_
 	/*
 	 * Update statistics maintained by NSS driver
 	 */
-	spin_lock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_begin(&nss_ipv6_stats_domain);
 	nss_top->stats_node[NSS_IPV6_RX_INTERFACE][NSS_STATS_NODE_RX_PKTS] += nins->node_stats.rx_packets;
 	nss_top->stats_node[NSS_IPV6_RX_INTERFACE][NSS_STATS_NODE_RX_BYTES] += nins->node_stats.rx_bytes;
 	nss_top->stats_node[NSS_IPV6_RX_INTERFACE][NSS_STATS_NODE_TX_PKTS] += nins->node_stats.tx_packets;
@@ -187,7 +250,7 @@ void nss_ipv6_stats_node_sync(struct nss_ctx_instance *nss_ctx, struct nss_ipv6_
 	for (i = 0; i < NSS_IPV6_EXCEPTION_EVENT_MAX; i++) {
 		nss_ipv6_exception_stats[i] += nins->exception_events[i];
 	}
-	spin_unlock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_end(&nss_ipv6_stats_domain);
 }
 
 /*
@@ -195,13 +258,24 @@ void nss_ipv6_stats_node_sync(struct nss_ctx_instance *nss_ctx, struct nss_ipv6_
  */
 NSS_STATS_DECLARE_FILE_OPERATIONS(ipv6);
 
+/*
+ * nss_ipv6_stats_bin_ops
+ */
+NSS_STATS_BIN_DECLARE_FILE_OPERATIONS(ipv6);
+
 /*
  * nss_ipv6_stats_dentry_create()
  *	Create IPv6 statistics debug entry.
  */
 void nss_ipv6_stats_dentry_create(void)
 {
+	/*
+	 * The node sync handler updates the common node stats under the domain
+	 */
+	nss_stats_domain_own_node(&nss_ipv6_stats_domain, NSS_IPV6_RX_INTERFACE);
+
 	nss_stats_create_dentry("ipv6", &nss_ipv6_stats_ops);
+	nss_stats_bin_create_dentry("ipv6", &nss_ipv6_stats_bin_ops);
 }
 
 /*
@@ -215,9 +289,9 @@ void nss_ipv6_stats_notify(struct nss_ctx_instance *nss_ctx)
 	struct nss_ipv6_stats_notification ipv6_stats;
 
 	ipv6_stats.core_id = nss_ctx->id;
-	memcpy(ipv6_stats.cmn_node_stats, nss_top_main.stats_node[NSS_IPV6_RX_INTERFACE], sizeof(ipv6_stats.cmn_node_stats));
-	memcpy(ipv6_stats.special_stats, nss_ipv6_stats, sizeof(ipv6_stats.special_stats));
-	memcpy(ipv6_stats.exception_stats, nss_ipv6_exception_stats, sizeof(ipv6_stats.exception_stats));
+	nss_stats_domain_copy(&nss_ipv6_stats_domain, ipv6_stats.cmn_node_stats, nss_top_main.stats_node[NSS_IPV6_RX_INTERFACE], sizeof(ipv6_stats.cmn_node_stats));
+	nss_stats_domain_copy(&nss_ipv6_stats_domain, ipv6_stats.special_stats, nss_ipv6_stats, sizeof(ipv6_stats.special_stats));
+	nss_stats_domain_copy(&nss_ipv6_stats_domain, ipv6_stats.exception_stats, nss_ipv6_exception_stats, sizeof(ipv6_stats.exception_stats));
 
 	atomic_notifier_call_chain(&nss_ipv6_stats_notifier, NSS_STATS_EVENT_NOTIFY, (void *)&ipv6_stats);
 }
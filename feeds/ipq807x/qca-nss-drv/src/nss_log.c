@@ -59,6 +59,15 @@ static wait_queue_head_t msg_wq;
 enum nss_cmn_response msg_response;
 static bool msg_event;
 
+/*
+ * nss_log_ring_size()
+ *	Size of a log ring of nentries entries, rounded up to whole pages so that it can be mapped to user space.
+ */
+static inline size_t nss_log_ring_size(uint32_t nentries)
+{
+	return PAGE_ALIGN(sizeof(struct nss_log_descriptor) + (sizeof(struct nss_log_entry) * nentries));
+}
+
 /*
  * nss_log_llseek()
  *	Seek operation.
@@ -187,8 +196,9 @@ static ssize_t nss_log_read(struct file *filp, char __user *buf, size_t size, lo
 	size_t b;
 	struct nss_log_entry *rb;
 	uint32_t entry;
-	uint32_t offset, index;
-	char msg[NSS_LOG_OUTPUT_LINE_SIZE];
+	uint32_t index;
+	size_t kbuf_size;
+	char *kbuf;
 
 	if (!data) {
 		return -EINVAL;
@@ -208,10 +218,8 @@ static ssize_t nss_log_read(struct file *filp, char __user *buf, size_t size, lo
 	}
 
 	/*
-	 * Get the current index
+	 * Get the current index. The ring is coherent memory, no sync is needed.
 	 */
-	dma_sync_single_for_cpu(data->nss_ctx->dev, data->dma_addr, sizeof(struct nss_log_descriptor), DMA_FROM_DEVICE);
-
 	entry = nss_log_current_entry(desc);
 
 	/*
@@ -247,50 +255,92 @@ static ssize_t nss_log_read(struct file *filp, char __user *buf, size_t size, lo
 		data->last_entry = entry - data->nentries;
 	}
 
+	/*
+	 * Lines are formatted into a kernel buffer and copied out at once.
+	 */
+	kbuf_size = min_t(size_t, size, NSS_LOG_READ_BUF_SIZE);
+	kbuf = kmalloc(kbuf_size, GFP_KERNEL);
+	if (!kbuf) {
+		return -ENOMEM;
+	}
+
 	/*
 	 * Iterate over indexes.
 	 */
 	while (entry > data->last_entry) {
-		index = offset = (data->last_entry % data->nentries);
-		offset = (offset * sizeof(struct nss_log_entry))
-			 + offsetof(struct nss_log_descriptor, log_ring_buffer);
-
-		dma_sync_single_for_cpu(data->nss_ctx->dev, data->dma_addr + offset,
-			sizeof(struct nss_log_entry), DMA_FROM_DEVICE);
+		index = data->last_entry % data->nentries;
 		rb = &desc->log_ring_buffer[index];
 
-		b = scnprintf(msg, sizeof(msg), NSS_LOG_LINE_FORMAT,
+		b = scnprintf(kbuf + bytes, NSS_LOG_OUTPUT_LINE_SIZE, NSS_LOG_LINE_FORMAT,
 			rb->thread_num, rb->timestamp, rb->message);
 
 		data->last_entry++;
-
-		/*
-		 * Copy to user buffer and if we fail then we return
-		 * failure.
-		 */
-		if (copy_to_user(buf + bytes, msg, b)) {
-			return -EFAULT;
-		}
-
 		bytes += b;
 
 		/*
 		 * If we ran out of space in the buffer.
 		 */
-		if ((bytes + NSS_LOG_OUTPUT_LINE_SIZE) >= size)
+		if ((bytes + NSS_LOG_OUTPUT_LINE_SIZE) >= kbuf_size)
 			break;
 	}
 
+	/*
+	 * Copy to user buffer and if we fail then we return
+	 * failure.
+	 */
+	if (copy_to_user(buf, kbuf, bytes)) {
+		kfree(kbuf);
+		return -EFAULT;
+	}
+
+	kfree(kbuf);
+
 	if (bytes > 0)
 		*ppos =  bytes;
 
 	return bytes;
 }
 
+/*
+ * nss_log_mmap()
+ *	Map the log ring read-only to user space.
+ *
+ * The mapping starts with struct nss_log_descriptor, whose current_entry is
+ * the producer index, followed by log_nentries struct nss_log_entry. The
+ * ring is coherent DMA memory and dma_mmap_coherent() maps it with the same
+ * attributes as the kernel mapping, so user space needs no sync. The open
+ * file holds a reference on the ring, so it is not replaced while it is
+ * mapped.
+ */
+static int nss_log_mmap(struct file *filp, struct vm_area_struct *vma)
+{
+	struct nss_log_data *data = filp->private_data;
+	unsigned long size = vma->vm_end - vma->vm_start;
+
+	if (!data || !data->load_mem) {
+		return -EINVAL;
+	}
+
+	if (vma->vm_pgoff || (size > nss_log_ring_size(data->nentries))) {
+		return -EINVAL;
+	}
+
+	if (vma->vm_flags & VM_WRITE) {
+		return -EPERM;
+	}
+
+	vma->vm_flags &= ~VM_MAYWRITE;
+	vma->vm_flags |= VM_DONTEXPAND | VM_DONTDUMP;
+
+	return dma_mmap_coherent(data->nss_ctx->dev, vma, data->load_mem, data->dma_addr,
+				nss_log_ring_size(data->nentries));
+}
+
 struct file_operations nss_logs_core_ops = {
 	.owner = THIS_MODULE,
 	.open = nss_log_open,
 	.read = nss_log_read,
+	.mmap = nss_log_mmap,
 	.release = nss_log_release,
 	.llseek = nss_log_llseek,
 };
@@ -415,20 +465,18 @@ bool nss_debug_log_buffer_alloc(uint8_t nss_id, uint32_t nentry)
 		return false;
 	}
 
-	size = sizeof(struct nss_log_descriptor) + (sizeof(struct nss_log_entry) * nentry);
-	addr = kmalloc(size, GFP_ATOMIC);
+	/*
+	 * The ring is coherent memory in whole pages, so that the kernel and the
+	 * user space mappings of it have the same attributes.
+	 */
+	size = nss_log_ring_size(nentry);
+	addr = dma_alloc_coherent(nss_ctx->dev, size, &dma_addr, GFP_KERNEL);
 	if (!addr) {
 		nss_warning("%px: Failed to allocate memory for logging (size:%d)\n", nss_ctx, size);
 		return false;
 	}
 
 	memset(addr, 0, size);
-	dma_addr = (uint32_t)dma_map_single(nss_ctx->dev, addr, size, DMA_FROM_DEVICE);
-	if (unlikely(dma_mapping_error(nss_ctx->dev, dma_addr))) {
-		nss_warning("%px: Failed to map address in DMA", nss_ctx);
-		kfree(addr);
-		return false;
-	}
 
 	/*
 	 * If we already have ring buffer associated with nss_id, then
@@ -499,10 +547,8 @@ bool nss_debug_log_buffer_alloc(uint8_t nss_id, uint32_t nentry)
 	 */
 	if (nss_rbe[nss_id].addr) {
 		uint32_t old_size;
-		old_size = sizeof(struct nss_log_descriptor) +
-			(sizeof(struct nss_log_entry) * nss_rbe[nss_id].nentries);
-		dma_unmap_single(nss_ctx->dev, nss_rbe[nss_id].dma_addr, old_size, DMA_FROM_DEVICE);
-		kfree(nss_rbe[nss_id].addr);
+		old_size = nss_log_ring_size(nss_rbe[nss_id].nentries);
+		dma_free_coherent(nss_ctx->dev, old_size, nss_rbe[nss_id].addr, nss_rbe[nss_id].dma_addr);
 	}
 
 	nss_rbe[nss_id].addr = addr;
@@ -514,8 +560,7 @@ bool nss_debug_log_buffer_alloc(uint8_t nss_id, uint32_t nentry)
 	return true;
 
 fail:
-	dma_unmap_single(nss_ctx->dev, dma_addr, size, DMA_FROM_DEVICE);
-	kfree(addr);
+	dma_free_coherent(nss_ctx->dev, size, addr, dma_addr);
 	wake_up(&nss_log_wq);
 	return false;
 }
@@ -21,6 +21,8 @@
 #ifndef __NSS_LOG_H
 #define __NSS_LOG_H
 
+#include "nss_log_ring.h"
+
 #define NSS_DEBUG_LOG_VERSION		0x1
 
 /**
@@ -37,8 +39,11 @@ enum nss_debug_interface_msg_type {
  */
 #define	NSS_LOG_OUTPUT_LINE_SIZE	151	/* 5 + 12 + 132 + '\n' + '\0' (see below) */
 #define	NSS_LOG_LINE_FORMAT		"%3d: %010u: %s\n"
-#define	NSS_LOG_LINE_WIDTH		132
-#define	NSS_LOG_COOKIE			0xFF785634
+
+/*
+ * Largest chunk of formatted log lines handed to user space per read.
+ */
+#define NSS_LOG_READ_BUF_SIZE		(16 * 1024)
 
 /*
  * Dump last N entry during the coredump.
@@ -57,31 +62,6 @@ struct nss_log_ring_buffer_addr {
 	int ref_cnt;		/* Reference count */
 };
 
-/*
- * nss_log_entry is shared between Host and NSS FW
- */
-struct nss_log_entry {
-	uint64_t sequence_num;		/* Sequence number */
-	uint32_t cookie;		/* Magic for verification */
-	uint32_t thread_num;		/* thread-id */
-	uint32_t timestamp;		/* timestamp in ticks */
-	char message[NSS_LOG_LINE_WIDTH];	/* actual debug message */
-} __attribute__((aligned(NSS_CACHE_LINE_SIZE)));
-
-/*
- * The NSS log descripts holds ring-buffer along with other variables and
- * it is shared between NSS FW and Host.
- *
- * NSS FW writes to ring buffer and current_entry but read by only Host.
- */
-struct nss_log_descriptor {
-	uint32_t cookie;		/* Magic for verification */
-	uint32_t log_nentries;		/* No.of log entries */
-	uint32_t current_entry;		/* pointer to current log entry */
-	uint8_t  pad[20];			/* pad to align ring buffer at cacheline boundary */
-	struct nss_log_entry log_ring_buffer[0];	/* The actual log entry ring buffer */
-} __attribute__((aligned(NSS_CACHE_LINE_SIZE)));
-
 struct nss_log_debug_memory_msg {
 	uint32_t version;
 	uint32_t nentry;
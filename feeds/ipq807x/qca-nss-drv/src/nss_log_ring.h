@@ -0,0 +1,65 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+/*
+ */
+
+/*
+ * nss_log_ring.h
+ *	Layout of the NSS FW log ring shared by the NSS, the driver and tools/nss_log.
+ *
+ * Only fixed width types are used so the header also builds outside the
+ * kernel, to decode a ring mapped from qca-nss-drv/logs/coreN or a capture.
+ */
+
+#ifndef __NSS_LOG_RING_H
+#define __NSS_LOG_RING_H
+
+#ifdef __KERNEL__
+#include <linux/types.h>
+#else
+#include <stdint.h>
+#endif
+
+#define	NSS_LOG_LINE_WIDTH		132
+#define	NSS_LOG_COOKIE			0xFF785634
+#define	NSS_LOG_ALIGN			32	/* NSS cache line, part of the firmware layout */
+
+/*
+ * nss_log_entry is shared between Host and NSS FW
+ */
+struct nss_log_entry {
+	uint64_t sequence_num;		/* Sequence number */
+	uint32_t cookie;		/* Magic for verification */
+	uint32_t thread_num;		/* thread-id */
+	uint32_t timestamp;		/* timestamp in ticks */
+	char message[NSS_LOG_LINE_WIDTH];	/* actual debug message */
+} __attribute__((aligned(NSS_LOG_ALIGN)));
+
+/*
+ * The NSS log descripts holds ring-buffer along with other variables and
+ * it is shared between NSS FW and Host.
+ *
+ * NSS FW writes to ring buffer and current_entry but read by only Host.
+ */
+struct nss_log_descriptor {
+	uint32_t cookie;		/* Magic for verification */
+	uint32_t log_nentries;		/* No.of log entries */
+	uint32_t current_entry;		/* pointer to current log entry */
+	uint8_t  pad[20];			/* pad to align ring buffer at cacheline boundary */
+	struct nss_log_entry log_ring_buffer[0];	/* The actual log entry ring buffer */
+} __attribute__((aligned(NSS_LOG_ALIGN)));
+
+#endif /* __NSS_LOG_RING_H */
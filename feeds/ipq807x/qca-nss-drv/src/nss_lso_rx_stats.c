@@ -24,6 +24,11 @@
  */
 ATOMIC_NOTIFIER_HEAD(nss_lso_rx_stats_notifier);
 
+/*
+ * Statistics domain for LSO_RX; the sync handler below updates under it.
+ */
+static struct nss_stats_domain nss_lso_rx_stats_domain = NSS_STATS_DOMAIN_INIT(nss_lso_rx_stats_domain);
+
 uint64_t nss_lso_rx_stats[NSS_LSO_RX_STATS_MAX];	/* LSO_RX statistics */
 
 /*
@@ -32,8 +37,6 @@ uint64_t nss_lso_rx_stats[NSS_LSO_RX_STATS_MAX];	/* LSO_RX statistics */
  */
 static ssize_t nss_lso_rx_stats_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos)
 {
-	int32_t i;
-
 	/*
 	 * Max output lines = #stats + few blank lines for banner printing +
 	 * Number of Extra outputlines for future reference to add new stats
@@ -63,12 +66,7 @@ static ssize_t nss_lso_rx_stats_read(struct file *fp, char __user *ubuf, size_t
 	 * lso_rx node stats
 	 */
 
-	spin_lock_bh(&nss_top_main.stats_lock);
-	for (i = 0; (i < NSS_LSO_RX_STATS_MAX); i++) {
-		stats_shadow[i] = nss_lso_rx_stats[i];
-	}
-
-	spin_unlock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_copy(&nss_lso_rx_stats_domain, stats_shadow, nss_lso_rx_stats, sizeof(*stats_shadow) * NSS_LSO_RX_STATS_MAX);
 	size_wr += nss_stats_print("lso_rx", "lso_rx node stats"
 					, NSS_STATS_SINGLE_INSTANCE
 					, nss_lso_rx_strings_stats
@@ -94,6 +92,11 @@ NSS_STATS_DECLARE_FILE_OPERATIONS(lso_rx);
  */
 void nss_lso_rx_stats_dentry_create(void)
 {
+	/*
+	 * The node sync handler updates the common node stats under the domain
+	 */
+	nss_stats_domain_own_node(&nss_lso_rx_stats_domain, NSS_LSO_RX_INTERFACE);
+
 	nss_stats_create_dentry("lso_rx", &nss_lso_rx_stats_ops);
 }
 
@@ -106,7 +109,7 @@ void nss_lso_rx_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss_lso_rx_s
 	struct nss_top_instance *nss_top = nss_ctx->nss_top;
 	int j;
 
-	spin_lock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_begin(&nss_lso_rx_stats_domain);
 
 	/*
 	 * common node stats
@@ -132,7 +135,7 @@ void nss_lso_rx_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss_lso_rx_s
 	nss_lso_rx_stats[NSS_LSO_RX_STATS_PBUF_ALLOC_FAIL] += nlrss->pbuf_alloc_fail;
 	nss_lso_rx_stats[NSS_LSO_RX_STATS_PBUF_REFERENCE_FAIL] += nlrss->pbuf_reference_fail;
 
-	spin_unlock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_end(&nss_lso_rx_stats_domain);
 }
 
 /*
@@ -146,8 +149,8 @@ void nss_lso_rx_stats_notify(struct nss_ctx_instance *nss_ctx)
 	struct nss_lso_rx_stats_notification lso_rx_stats;
 
 	lso_rx_stats.core_id = nss_ctx->id;
-	memcpy(lso_rx_stats.cmn_node_stats, nss_top_main.stats_node[NSS_LSO_RX_INTERFACE], sizeof(lso_rx_stats.cmn_node_stats));
-	memcpy(lso_rx_stats.node_stats, nss_lso_rx_stats, sizeof(lso_rx_stats.node_stats));
+	nss_stats_domain_copy(&nss_lso_rx_stats_domain, lso_rx_stats.cmn_node_stats, nss_top_main.stats_node[NSS_LSO_RX_INTERFACE], sizeof(lso_rx_stats.cmn_node_stats));
+	nss_stats_domain_copy(&nss_lso_rx_stats_domain, lso_rx_stats.node_stats, nss_lso_rx_stats, sizeof(lso_rx_stats.node_stats));
 	atomic_notifier_call_chain(&nss_lso_rx_stats_notifier, NSS_STATS_EVENT_NOTIFY, (void *)&lso_rx_stats);
 }
 
@@ -35,6 +35,33 @@ MODULE_PARM_DESC(nss_meminfo_user_config, "meminfo user configuration");
 
 static bool nss_meminfo_debugfs_exist;
 
+/*
+ * Ring placement calibration.
+ */
+#define NSS_MEMINFO_CALIBRATE_MAX_SEC	60	/* Longest window; keeps 32-bit counters from wrapping */
+#define NSS_MEMINFO_CALIBRATE_HOT_RATE	10000	/* Descriptors per second that are worth IMEM */
+
+/*
+ * Calibration window of one core
+ */
+struct nss_meminfo_calibrate {
+	struct delayed_work work;			/* Ends the window */
+	struct nss_ctx_instance *nss_ctx;		/* Core measured */
+	bool running;					/* Window is open */
+	bool valid;					/* Results below are usable */
+	unsigned long start;				/* Window start in jiffies */
+	uint32_t msecs;					/* Window length */
+	uint32_t n2h_base[NSS_N2H_RING_COUNT];		/* N2H descriptor counts at start */
+	uint32_t h2n_base[NSS_H2N_RING_COUNT];		/* H2N descriptor counts at start */
+	uint32_t n2h_rate[NSS_N2H_RING_COUNT];		/* N2H descriptors per second */
+	uint32_t h2n_rate[NSS_H2N_RING_COUNT];		/* H2N descriptors per second */
+	enum nss_meminfo_memtype n2h_memtype;		/* Recommended N2H rings memory type */
+	enum nss_meminfo_memtype h2n_memtype;		/* Recommended H2N rings memory type */
+};
+
+static struct nss_meminfo_calibrate nss_meminfo_calibrate[NSS_MAX_CORES];
+static DEFINE_MUTEX(nss_meminfo_calibrate_lock);
+
 /*
  * Name table of memory type presented to user.
  */
@@ -591,6 +618,282 @@ cleanup:
 	return false;
 }
 
+/*
+ * nss_meminfo_calibrate_sample()
+ *	Take a snapshot of the descriptor counters of every ring.
+ */
+static void nss_meminfo_calibrate_sample(struct nss_ctx_instance *nss_ctx, uint32_t *n2h, uint32_t *h2n)
+{
+	int i;
+
+	for (i = 0; i < NSS_N2H_RING_COUNT; i++)
+		n2h[i] = READ_ONCE(nss_ctx->n2h_desc_ring[i].desc_count);
+
+	for (i = 0; i < NSS_H2N_RING_COUNT; i++)
+		h2n[i] = READ_ONCE(nss_ctx->h2n_desc_rings[i].desc_count);
+}
+
+/*
+ * nss_meminfo_calibrate_recommend()
+ *	Pick a memory type for the N2H and H2N ring blocks from measured pressure.
+ *
+ * Each ring block is allocated as one piece, so the choice is made per block.
+ * The block with the most descriptors per byte goes to IMEM first, as long as
+ * it is busy enough to matter and fits in what IMEM would have free once the
+ * rings already placed there are released.
+ */
+static void nss_meminfo_calibrate_recommend(struct nss_ctx_instance *nss_ctx, struct nss_meminfo_calibrate *c)
+{
+	struct nss_meminfo_ctx *mem_ctx = &nss_ctx->meminfo_ctx;
+	struct nss_meminfo_n2h_h2n_info *n2h_info = &mem_ctx->n2h_info;
+	struct nss_meminfo_n2h_h2n_info *h2n_info = &mem_ctx->h2n_info;
+	uint64_t n2h_rate = 0, h2n_rate = 0;
+	uint32_t budget;
+	bool n2h_first;
+	int i;
+
+	for (i = 0; i < NSS_N2H_RING_COUNT; i++)
+		n2h_rate += c->n2h_rate[i];
+
+	for (i = 0; i < NSS_H2N_RING_COUNT; i++)
+		h2n_rate += c->h2n_rate[i];
+
+	c->n2h_memtype = NSS_MEMINFO_MEMTYPE_SDRAM;
+	c->h2n_memtype = NSS_MEMINFO_MEMTYPE_SDRAM;
+
+	/*
+	 * For SOC's where TCM is not present
+	 */
+	if (!nss_ctx->vphys)
+		return;
+
+	budget = mem_ctx->imem_end - mem_ctx->imem_tail;
+	if (n2h_info->memtype == NSS_MEMINFO_MEMTYPE_IMEM)
+		budget += n2h_info->total_size;
+	if (h2n_info->memtype == NSS_MEMINFO_MEMTYPE_IMEM)
+		budget += h2n_info->total_size;
+
+	/*
+	 * Compare descriptors per byte: n2h_rate / n2h_size against h2n_rate / h2n_size.
+	 */
+	n2h_first = n2h_rate * h2n_info->total_size >= h2n_rate * n2h_info->total_size;
+
+	for (i = 0; i < 2; i++) {
+		bool n2h = (i == 0) == n2h_first;
+		uint64_t rate = n2h ? n2h_rate : h2n_rate;
+		uint32_t size = n2h ? n2h_info->total_size : h2n_info->total_size;
+
+		if (rate < NSS_MEMINFO_CALIBRATE_HOT_RATE || size > budget)
+			continue;
+
+		budget -= size;
+		if (n2h)
+			c->n2h_memtype = NSS_MEMINFO_MEMTYPE_IMEM;
+		else
+			c->h2n_memtype = NSS_MEMINFO_MEMTYPE_IMEM;
+	}
+}
+
+/*
+ * nss_meminfo_calibrate_work()
+ *	End of a calibration window.
+ */
+static void nss_meminfo_calibrate_work(struct work_struct *work)
+{
+	struct nss_meminfo_calibrate *c = container_of(to_delayed_work(work), struct nss_meminfo_calibrate, work);
+	struct nss_ctx_instance *nss_ctx = c->nss_ctx;
+	uint32_t n2h[NSS_N2H_RING_COUNT];
+	uint32_t h2n[NSS_H2N_RING_COUNT];
+	uint32_t msecs;
+	int i;
+
+	mutex_lock(&nss_meminfo_calibrate_lock);
+
+	nss_meminfo_calibrate_sample(nss_ctx, n2h, h2n);
+	msecs = max_t(uint32_t, jiffies_to_msecs(jiffies - c->start), 1);
+
+	for (i = 0; i < NSS_N2H_RING_COUNT; i++)
+		c->n2h_rate[i] = (uint32_t)div_u64((uint64_t)(n2h[i] - c->n2h_base[i]) * MSEC_PER_SEC, msecs);
+
+	for (i = 0; i < NSS_H2N_RING_COUNT; i++)
+		c->h2n_rate[i] = (uint32_t)div_u64((uint64_t)(h2n[i] - c->h2n_base[i]) * MSEC_PER_SEC, msecs);
+
+	c->msecs = msecs;
+	nss_meminfo_calibrate_recommend(nss_ctx, c);
+	c->running = false;
+	c->valid = true;
+
+	mutex_unlock(&nss_meminfo_calibrate_lock);
+
+	nss_info_always("%px: meminfo calibration done in %ums, recommend n2h_rings %s, h2n_rings %s\n",
+			nss_ctx, msecs, nss_meminfo_memtype_table[c->n2h_memtype],
+			nss_meminfo_memtype_table[c->h2n_memtype]);
+}
+
+/*
+ * nss_meminfo_calibrate_start()
+ *	Open a calibration window of secs seconds on a core.
+ */
+static void nss_meminfo_calibrate_start(struct nss_meminfo_calibrate *c, int secs)
+{
+	cancel_delayed_work_sync(&c->work);
+
+	mutex_lock(&nss_meminfo_calibrate_lock);
+	nss_meminfo_calibrate_sample(c->nss_ctx, c->n2h_base, c->h2n_base);
+	c->start = jiffies;
+	c->running = true;
+	c->valid = false;
+	mutex_unlock(&nss_meminfo_calibrate_lock);
+
+	schedule_delayed_work(&c->work, secs * HZ);
+}
+
+/*
+ * nss_meminfo_calibrate_handler()
+ *	Sysctl to start a ring placement calibration window on all cores.
+ */
+int nss_meminfo_calibrate_handler(struct ctl_table *ctl, int write, void __user *buffer, size_t *lenp, loff_t *ppos)
+{
+	int ret;
+	int i;
+
+	ret = proc_dointvec(ctl, write, buffer, lenp, ppos);
+	if (ret || !write)
+		return ret;
+
+	if (nss_ctl_meminfo_calibrate <= 0 || nss_ctl_meminfo_calibrate > NSS_MEMINFO_CALIBRATE_MAX_SEC) {
+		nss_warning("Invalid meminfo calibration window:%d (must be 1 to %d seconds)\n",
+				nss_ctl_meminfo_calibrate, NSS_MEMINFO_CALIBRATE_MAX_SEC);
+		nss_ctl_meminfo_calibrate = 0;
+		return -EINVAL;
+	}
+
+	for (i = 0; i < nss_top_main.num_nss; i++) {
+		struct nss_meminfo_calibrate *c = &nss_meminfo_calibrate[i];
+
+		if (!c->nss_ctx)
+			continue;
+
+		nss_meminfo_calibrate_start(c, nss_ctl_meminfo_calibrate);
+	}
+
+	nss_info("meminfo calibration started for %d seconds\n", nss_ctl_meminfo_calibrate);
+	return ret;
+}
+
+/*
+ * nss_meminfo_calibrate_cancel()
+ *	Stop calibration windows still open.
+ */
+void nss_meminfo_calibrate_cancel(void)
+{
+	int i;
+
+	for (i = 0; i < NSS_MAX_CORES; i++) {
+		if (nss_meminfo_calibrate[i].nss_ctx)
+			cancel_delayed_work_sync(&nss_meminfo_calibrate[i].work);
+	}
+}
+
+/*
+ * nss_meminfo_calibrate_append()
+ *	Append one <core_id, name, memory_type> entry to a user config string.
+ */
+static int nss_meminfo_calibrate_append(char *buf, int len, int size, int core, const char *name, int mtype)
+{
+	if (len >= size)
+		return len;
+
+	return len + snprintf(buf + len, size - len, "%s<%d, %s, %s>", len ? ", " : "",
+				core, name, nss_meminfo_memtype_table[mtype]);
+}
+
+/*
+ * nss_meminfo_calibrate_config()
+ *	Build the meminfo_user_config string that applies the recommendation.
+ *
+ * Overrides already in effect for firmware memory blocks are kept, and cores
+ * without a finished calibration keep their current ring placement.
+ */
+static void nss_meminfo_calibrate_config(char *buf, int size)
+{
+	int len = 0;
+	int i, j;
+
+	buf[0] = '\0';
+	for (i = 0; i < nss_top_main.num_nss; i++) {
+		struct nss_ctx_instance *nss_ctx = &nss_top_main.nss[i];
+		struct nss_meminfo_ctx *mem_ctx = &nss_ctx->meminfo_ctx;
+		struct nss_meminfo_calibrate *c = &nss_meminfo_calibrate[i];
+		struct nss_meminfo_request *r = mem_ctx->meminfo_map.requests;
+		int n2h_mtype = mem_ctx->n2h_info.memtype;
+		int h2n_mtype = mem_ctx->h2n_info.memtype;
+
+		if (!c->nss_ctx)
+			continue;
+
+		if (c->valid) {
+			n2h_mtype = c->n2h_memtype;
+			h2n_mtype = c->h2n_memtype;
+		}
+
+		if (n2h_mtype != NSS_MEMINFO_MEMTYPE_SDRAM)
+			len = nss_meminfo_calibrate_append(buf, len, size, i, "n2h_rings", n2h_mtype);
+		if (h2n_mtype != NSS_MEMINFO_MEMTYPE_SDRAM)
+			len = nss_meminfo_calibrate_append(buf, len, size, i, "h2n_rings", h2n_mtype);
+
+		for (j = 0; j < mem_ctx->meminfo_map.num_requests; j++) {
+			if (r[j].memtype_user != r[j].memtype_default)
+				len = nss_meminfo_calibrate_append(buf, len, size, i, r[j].name, r[j].memtype_user);
+		}
+	}
+}
+
+/*
+ * nss_meminfo_calibrate_show()
+ *	Show the calibration result of a core.
+ */
+static void nss_meminfo_calibrate_show(struct seq_file *seq, struct nss_ctx_instance *nss_ctx)
+{
+	struct nss_meminfo_calibrate *c = &nss_meminfo_calibrate[nss_ctx->id];
+	char *config;
+	int i;
+
+	seq_printf(seq, "\nPlacement calibration: ");
+
+	mutex_lock(&nss_meminfo_calibrate_lock);
+	if (c->running) {
+		seq_printf(seq, "running\n");
+		mutex_unlock(&nss_meminfo_calibrate_lock);
+		return;
+	}
+
+	if (!c->valid) {
+		seq_printf(seq, "not run, echo <seconds> > /proc/sys/dev/nss/general/meminfo_calibrate under load\n");
+		mutex_unlock(&nss_meminfo_calibrate_lock);
+		return;
+	}
+
+	seq_printf(seq, "measured over %ums\n", c->msecs);
+	for (i = 0; i < NSS_N2H_RING_COUNT; i++)
+		seq_printf(seq, "n2h ring %d: %u desc/s\n", i, c->n2h_rate[i]);
+	for (i = 0; i < NSS_H2N_RING_COUNT; i++)
+		seq_printf(seq, "h2n ring %d: %u desc/s\n", i, c->h2n_rate[i]);
+
+	seq_printf(seq, "Recommended: n2h_rings %s, h2n_rings %s\n",
+			nss_meminfo_memtype_table[c->n2h_memtype],
+			nss_meminfo_memtype_table[c->h2n_memtype]);
+
+	config = kmalloc(NSS_MEMINFO_USER_CONFIG_MAXLEN, GFP_KERNEL);
+	if (config) {
+		nss_meminfo_calibrate_config(config, NSS_MEMINFO_USER_CONFIG_MAXLEN);
+		seq_printf(seq, "To apply on next boot: qca-nss-drv meminfo_user_config=\"%s\"\n", config);
+		kfree(config);
+	}
+
+	mutex_unlock(&nss_meminfo_calibrate_lock);
+}
+
 /*
  * nss_meminfo_config_show()
  *	function to show meinfo configuration per core.
@@ -650,6 +953,8 @@ static int nss_meminfo_config_show(struct seq_file *seq, void *v)
 	seq_printf(seq, "For example, <1, h2n_rings, IMEM> stands for: h2n_rings of core 1 is on IMEM\n");
 	seq_printf(seq, "Note:UTCM_SHARED cannot be used for n2h_rings, h2n_rings and debug_log_boot_desc.\n");
 
+	nss_meminfo_calibrate_show(seq, nss_ctx);
+
 	return 0;
 }
 
@@ -793,6 +1098,9 @@ bool nss_meminfo_init(struct nss_ctx_instance *nss_ctx)
 
 	nss_meminfo_init_debugfs(nss_ctx);
 
+	nss_meminfo_calibrate[nss_ctx->id].nss_ctx = nss_ctx;
+	INIT_DELAYED_WORK(&nss_meminfo_calibrate[nss_ctx->id].work, nss_meminfo_calibrate_work);
+
 	nss_info_always("%px: meminfo init succeed\n", nss_ctx);
 	return true;
 }
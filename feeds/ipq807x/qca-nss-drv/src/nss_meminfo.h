@@ -131,5 +131,9 @@ struct nss_meminfo_ctx {
 							/* Block lists for each memory type */
 };
 
+extern int nss_ctl_meminfo_calibrate;
+
 bool nss_meminfo_init(struct nss_ctx_instance *nss_ctx);
+int nss_meminfo_calibrate_handler(struct ctl_table *ctl, int write, void __user *buffer, size_t *lenp, loff_t *ppos);
+void nss_meminfo_calibrate_cancel(void);
 #endif
@@ -177,7 +177,7 @@ void nss_mirror_stats_sync(struct nss_ctx_instance *nss_ctx,
 	return;
 
 sync_cmn_stats:
-	spin_lock_bh(&nss_mirror_stats_lock);
+	nss_stats_domain_write_begin(&nss_stats_node_domain);
 
 	/*
 	 * Sync common stats.
@@ -192,7 +192,7 @@ sync_cmn_stats:
 			node_stats_ptr->rx_dropped[i];
 	}
 
-	spin_unlock_bh(&nss_mirror_stats_lock);
+	nss_stats_domain_write_end(&nss_stats_node_domain);
 }
 
 /*
@@ -30,6 +30,17 @@
 #define NSS_N2H_DEFAULT_EMPTY_POOL_BUF_SZ	8192
 #define NSS_N2H_TX_TIMEOUT 3000 /* 3 Seconds */
 
+/*
+ * Empty buffer water mark controller.
+ */
+#define NSS_N2H_AUTOTUNE_PERIOD_MS		1000	/* Sampling period */
+#define NSS_N2H_AUTOTUNE_SOS_THRESHOLD		16	/* SOS per period that count as starvation */
+#define NSS_N2H_AUTOTUNE_QUIET_PERIODS		30	/* Quiet periods before shrinking */
+#define NSS_N2H_AUTOTUNE_HEADROOM_MS		4	/* Traffic high water must cover */
+#define NSS_N2H_AUTOTUNE_DEFAULT_MIN		1024
+#define NSS_N2H_AUTOTUNE_DEFAULT_MAX		32768
+#define NSS_N2H_AUTOTUNE_DEFAULT_MIN_FREE_MB	32
+
 int nss_n2h_empty_pool_buf_cfg[NSS_MAX_CORES] __read_mostly = {-1, -1};
 int nss_n2h_empty_paged_pool_buf_cfg[NSS_MAX_CORES] __read_mostly = {-1, -1};
 int nss_n2h_water_mark[NSS_MAX_CORES][2] __read_mostly = {{-1, -1}, {-1, -1} };
@@ -41,19 +52,40 @@ int nss_n2h_core0_add_buf_pool_size __read_mostly;
 int nss_n2h_core1_add_buf_pool_size __read_mostly;
 int nss_n2h_queue_limit[NSS_MAX_CORES] __read_mostly = {NSS_DEFAULT_QUEUE_LIMIT, NSS_DEFAULT_QUEUE_LIMIT};
 int nss_n2h_host_bp_config[NSS_MAX_CORES] __read_mostly;
+int nss_n2h_autotune __read_mostly;
+int nss_n2h_autotune_min __read_mostly = NSS_N2H_AUTOTUNE_DEFAULT_MIN;
+int nss_n2h_autotune_max __read_mostly = NSS_N2H_AUTOTUNE_DEFAULT_MAX;
+int nss_n2h_autotune_min_free_mb __read_mostly = NSS_N2H_AUTOTUNE_DEFAULT_MIN_FREE_MB;
+
+static int nss_n2h_autotune_buf_min = NSS_N2H_MIN_EMPTY_POOL_BUF_SZ;
+static int nss_n2h_autotune_buf_max = NSS_N2H_MAX_EMPTY_POOL_BUF_SZ;
+static int nss_n2h_autotune_zero;
 
 struct nss_n2h_registered_data {
 	nss_n2h_msg_callback_t n2h_callback;
 	void *app_data;
 };
 
+/*
+ * Per core state of the empty buffer water mark controller.
+ */
+struct nss_n2h_autotune {
+	struct delayed_work work;	/* Sampling work */
+	uint32_t core;			/* Core being tuned */
+	bool primed;			/* Counter snapshots are valid */
+	uint32_t quiet;			/* Consecutive periods without starvation */
+	uint32_t last_sos;		/* Empty buffer SOS count at last sample */
+	uint64_t last_alloc_fails;	/* Payload allocation failures at last sample */
+	uint64_t last_data_pkts;	/* N2H data packets at last sample */
+};
+
 static struct nss_n2h_cfg_pvt nss_n2h_nepbcfgp[NSS_MAX_CORES];
+static struct nss_n2h_autotune nss_n2h_at[NSS_MAX_CORES];
 static struct nss_n2h_registered_data nss_n2h_rd[NSS_MAX_CORES];
 static struct nss_n2h_cfg_pvt nss_n2h_rcp;
 static struct nss_n2h_cfg_pvt nss_n2h_mitigationcp[NSS_CORE_MAX];
 static struct nss_n2h_cfg_pvt nss_n2h_bufcp[NSS_CORE_MAX];
 static struct nss_n2h_cfg_pvt nss_n2h_wp;
-static struct nss_n2h_cfg_pvt nss_n2h_q_cfg_pvt;
 static struct nss_n2h_cfg_pvt nss_n2h_q_lim_pvt;
 static struct nss_n2h_cfg_pvt nss_n2h_host_bp_cfg_pvt;
 
@@ -141,164 +173,58 @@ static void nss_n2h_interface_handler(struct nss_ctx_instance *nss_ctx,
 }
 
 /*
- * nss_n2h_mitigation_cfg_callback()
- *	call back function for mitigation configuration
- */
-static void nss_n2h_mitigation_cfg_callback(void *app_data, struct nss_n2h_msg *nnm)
-{
-	uint32_t core_num = (uint32_t)(nss_ptr_t)app_data;
-	struct nss_top_instance *nss_top = &nss_top_main;
-	struct nss_ctx_instance *nss_ctx = &nss_top->nss[core_num];
-
-	if (nnm->cm.response != NSS_CMN_RESPONSE_ACK) {
-
-		/*
-		 * Error, hence we are not updating the nss_n2h_mitigate_en
-		 */
-		nss_n2h_mitigationcp[core_num].response = NSS_FAILURE;
-		complete(&nss_n2h_mitigationcp[core_num].complete);
-		nss_warning("core%d: MITIGATION configuration failed : %d\n", core_num, nnm->cm.error);
-		return;
-	}
-
-	nss_info("core%d: MITIGATION configuration succeeded: %d\n", core_num, nnm->cm.error);
-
-	nss_ctx->n2h_mitigate_en = nnm->msg.mitigation_cfg.enable;
-	nss_n2h_mitigationcp[core_num].response = NSS_SUCCESS;
-	complete(&nss_n2h_mitigationcp[core_num].complete);
-}
-
-/*
- * nss_n2h_buf_cfg_callback()
- *	call back function for pbuf configuration
- */
-static void nss_n2h_bufs_cfg_callback(void *app_data, struct nss_n2h_msg *nnm)
-{
-	uint32_t core_num = (uint32_t)(nss_ptr_t)app_data;
-	unsigned int allocated_sz;
-
-	struct nss_top_instance *nss_top = &nss_top_main;
-	struct nss_ctx_instance *nss_ctx = &nss_top->nss[core_num];
-
-	if (nnm->cm.response != NSS_CMN_RESPONSE_ACK) {
-		nss_n2h_bufcp[core_num].response = NSS_FAILURE;
-		nss_warning("core%d: buf configuration failed : %d\n", core_num, nnm->cm.error);
-		goto done;
-	}
-
-	nss_info("core%d: buf configuration succeeded: %d\n", core_num, nnm->cm.error);
-
-	allocated_sz = nnm->msg.buf_pool.nss_buf_page_size * nnm->msg.buf_pool.nss_buf_num_pages;
-	nss_ctx->buf_sz_allocated += allocated_sz;
-
-	nss_n2h_bufcp[core_num].response = NSS_SUCCESS;
-
-done:
-	complete(&nss_n2h_bufcp[core_num].complete);
-}
-
-/*
- * nss_n2h_payload_stats_callback()
- *	It gets called response to payload accounting.
+ * nss_n2h_tx_msg_txn()
+ *	Send a message to NSS and wait for its response.
+ *
+ * copy_len bytes of the response payload are copied back to the message.
  */
-static void nss_n2h_payload_stats_callback(void *app_data,
-					struct nss_n2h_msg *nnm)
+static nss_tx_status_t nss_n2h_tx_msg_txn(struct nss_ctx_instance *nss_ctx, struct nss_n2h_msg *nnm,
+					uint32_t copy_len, uint32_t timeout)
 {
-	uint32_t core_num = (uint32_t)(nss_ptr_t)app_data;
-
-	if (nnm->cm.response != NSS_CMN_RESPONSE_ACK) {
-		struct nss_n2h_empty_pool_buf *nnepbcm;
-		nnepbcm = &nnm->msg.empty_pool_buf_cfg;
-
-		nss_warning("%d: core empty pool buf set failure: %d\n",
-				core_num, nnm->cm.error);
-		nss_n2h_nepbcfgp[core_num].response = NSS_FAILURE;
-		complete(&nss_n2h_nepbcfgp[core_num].complete);
-		return;
-	}
+	struct nss_tx_msg_txn *txn;
+	nss_tx_status_t status;
 
-	if (nnm->cm.type == NSS_TX_METADATA_TYPE_GET_WATER_MARK) {
-		nss_n2h_nepbcfgp[core_num].empty_buf_pool_info.pool_size =
-			ntohl(nnm->msg.payload_info.pool_size);
-		nss_n2h_nepbcfgp[core_num].empty_buf_pool_info.low_water =
-			ntohl(nnm->msg.payload_info.low_water);
-		nss_n2h_nepbcfgp[core_num].empty_buf_pool_info.high_water =
-			ntohl(nnm->msg.payload_info.high_water);
+	txn = nss_tx_msg_txn_alloc(nss_ctx, 1, 1, timeout);
+	if (!txn) {
+		return NSS_TX_FAILURE;
 	}
 
-	if (nnm->cm.type == NSS_TX_METADATA_TYPE_GET_PAGED_WATER_MARK) {
-		nss_n2h_nepbcfgp[core_num].empty_paged_buf_pool_info.pool_size =
-			ntohl(nnm->msg.paged_payload_info.pool_size);
-		nss_n2h_nepbcfgp[core_num].empty_paged_buf_pool_info.low_water =
-			ntohl(nnm->msg.paged_payload_info.low_water);
-		nss_n2h_nepbcfgp[core_num].empty_paged_buf_pool_info.high_water =
-			ntohl(nnm->msg.paged_payload_info.high_water);
+	status = nss_tx_msg_txn_add(txn, (nss_tx_msg_sync_subsys_async_t)nss_n2h_tx_msg, &nnm->cm, 0, copy_len);
+	if (status == NSS_TX_SUCCESS) {
+		status = nss_tx_msg_txn_wait(txn);
 	}
 
-	nss_n2h_nepbcfgp[core_num].response = NSS_SUCCESS;
-	complete(&nss_n2h_nepbcfgp[core_num].complete);
-}
-
-/*
- * nss_n2h_set_wifi_payloads_callback()
- *	call back function for response to wifi pool configuration
- *
- */
-static void nss_n2h_set_wifi_payloads_callback(void *app_data,
-					struct nss_n2h_msg *nnm)
-{
-	struct nss_ctx_instance *nss_ctx __maybe_unused = (struct nss_ctx_instance *)app_data;
-	if (nnm->cm.response != NSS_CMN_RESPONSE_ACK) {
-
-		nss_n2h_wp.response = NSS_FAILURE;
-		complete(&nss_n2h_wp.complete);
-		nss_warning("%px: wifi pool configuration failed : %d\n", nss_ctx,
-				nnm->cm.error);
-		return;
-	}
-
-	nss_info("%px: wifi payload configuration succeeded: %d\n", nss_ctx,
-			nnm->cm.error);
-	nss_n2h_wp.response = NSS_SUCCESS;
-	nss_n2h_wp.wifi_pool = ntohl(nnm->msg.wp.payloads);
-	complete(&nss_n2h_wp.complete);
+	nss_tx_msg_txn_free(txn);
+	return status;
 }
 
 /*
  * nss_n2h_get_payload_info()
  *	Gets Payload information.
+ *
+ * The payload information of the response is stored in nnepbcm, if any.
  */
 static int nss_n2h_get_payload_info(nss_ptr_t core_num, struct nss_n2h_msg *nnm, struct nss_n2h_payload_info *nnepbcm)
 {
 	struct nss_top_instance *nss_top = &nss_top_main;
 	struct nss_ctx_instance *nss_ctx = &nss_top->nss[core_num];
+	struct nss_n2h_payload_info *info = &nnm->msg.payload_info;
 	nss_tx_status_t nss_tx_status;
-	int ret = NSS_FAILURE;
 
 	/*
 	 * Note that semaphore should be already held.
 	 */
-
-	nss_tx_status = nss_n2h_tx_msg(nss_ctx, nnm);
-
+	nss_tx_status = nss_n2h_tx_msg_txn(nss_ctx, nnm, nnepbcm ? sizeof(*info) : 0, NSS_CONN_CFG_TIMEOUT);
 	if (nss_tx_status != NSS_TX_SUCCESS) {
-		nss_warning("%px: core %d nss_tx error errorn", nss_ctx, (int)core_num);
+		nss_warning("%px: core %d payload info msg type %d failed: %d\n", nss_ctx, (int)core_num,
+				nnm->cm.type, nss_tx_status);
 		return NSS_FAILURE;
 	}
 
-	/*
-	 * Blocking call, wait till we get ACK for this msg.
-	 */
-	ret = wait_for_completion_timeout(&nss_n2h_nepbcfgp[core_num].complete,
-			msecs_to_jiffies(NSS_CONN_CFG_TIMEOUT));
-	if (ret == 0) {
-		nss_warning("%px: core %d waiting for ack timed out\n", nss_ctx, (int)core_num);
-		return NSS_FAILURE;
-	}
-
-	if (NSS_FAILURE == nss_n2h_nepbcfgp[core_num].response) {
-		nss_warning("%px: core %d response returned failure\n", nss_ctx, (int)core_num);
-		return NSS_FAILURE;
+	if (nnepbcm) {
+		nnepbcm->pool_size = ntohl(info->pool_size);
+		nnepbcm->low_water = ntohl(info->low_water);
+		nnepbcm->high_water = ntohl(info->high_water);
 	}
 
 	return NSS_SUCCESS;
@@ -314,12 +240,10 @@ static int nss_n2h_get_default_payload_info(nss_ptr_t core_num)
 
 	nss_n2h_msg_init(&nnm, NSS_N2H_INTERFACE,
 			NSS_TX_METADATA_TYPE_GET_WATER_MARK,
-			sizeof(struct nss_n2h_payload_info),
-			nss_n2h_payload_stats_callback,
-			(void *)core_num);
+			sizeof(struct nss_n2h_payload_info), NULL, NULL);
 
 	return nss_n2h_get_payload_info(core_num, &nnm,
-			&nnm.msg.payload_info);
+			&nss_n2h_nepbcfgp[core_num].empty_buf_pool_info);
 }
 
 /*
@@ -332,12 +256,10 @@ static int nss_n2h_get_paged_payload_info(nss_ptr_t core_num)
 
 	nss_n2h_msg_init(&nnm, NSS_N2H_INTERFACE,
 			NSS_TX_METADATA_TYPE_GET_PAGED_WATER_MARK,
-			sizeof(struct nss_n2h_payload_info),
-			nss_n2h_payload_stats_callback,
-			(void *)core_num);
+			sizeof(struct nss_n2h_payload_info), NULL, NULL);
 
 	return nss_n2h_get_payload_info(core_num, &nnm,
-			&nnm.msg.paged_payload_info);
+			&nss_n2h_nepbcfgp[core_num].empty_paged_buf_pool_info);
 }
 
 /*
@@ -397,36 +319,18 @@ static int nss_n2h_set_empty_buf_pool(struct ctl_table *ctl, int write,
 
 	nss_n2h_msg_init(&nnm, NSS_N2H_INTERFACE,
 			NSS_TX_METADATA_TYPE_N2H_EMPTY_POOL_BUF_CFG,
-			sizeof(struct nss_n2h_empty_pool_buf),
-			nss_n2h_payload_stats_callback,
-			(nss_ptr_t *)core_num);
+			sizeof(struct nss_n2h_empty_pool_buf), NULL, NULL);
 
 	nnepbcm = &nnm.msg.empty_pool_buf_cfg;
 	nnepbcm->pool_size = htonl(*new_val);
-	nss_tx_status = nss_n2h_tx_msg(nss_ctx, &nnm);
-
-	if (nss_tx_status != NSS_TX_SUCCESS) {
-		nss_warning("%px: core %d nss_tx error empty pool buffer: %d\n",
-				nss_ctx, (int)core_num, *new_val);
-		goto failure;
-	}
 
 	/*
 	 * Blocking call, wait till we get ACK for this msg.
 	 */
-	ret = wait_for_completion_timeout(&nss_n2h_nepbcfgp[core_num].complete,
-			msecs_to_jiffies(NSS_CONN_CFG_TIMEOUT));
-	if (ret == 0) {
-		nss_warning("%px: core %d Waiting for ack timed out\n", nss_ctx, (int)core_num);
-		goto failure;
-	}
-
-	/*
-	 * ACK/NACK received from NSS FW
-	 * If ACK: Callback function will update nss_n2h_empty_pool_buf with
-	 * nss_n2h_nepbcfgp.num_conn_valid, which holds the user input
-	 */
-	if (NSS_FAILURE == nss_n2h_nepbcfgp[core_num].response) {
+	nss_tx_status = nss_n2h_tx_msg_txn(nss_ctx, &nnm, 0, NSS_CONN_CFG_TIMEOUT);
+	if (nss_tx_status != NSS_TX_SUCCESS) {
+		nss_warning("%px: core %d nss_tx error empty pool buffer: %d, status %d\n",
+				nss_ctx, (int)core_num, *new_val, nss_tx_status);
 		goto failure;
 	}
 
@@ -499,36 +403,18 @@ static int nss_n2h_set_empty_paged_pool_buf(struct ctl_table *ctl, int write,
 
 	nss_n2h_msg_init(&nnm, NSS_N2H_INTERFACE,
 			NSS_TX_METADATA_TYPE_N2H_EMPTY_PAGED_POOL_BUF_CFG,
-			sizeof(struct nss_n2h_empty_pool_buf),
-			nss_n2h_payload_stats_callback,
-			(nss_ptr_t *)core_num);
+			sizeof(struct nss_n2h_empty_pool_buf), NULL, NULL);
 
 	nneppbcm = &nnm.msg.empty_pool_buf_cfg;
 	nneppbcm->pool_size = htonl(*new_val);
-	nss_tx_status = nss_n2h_tx_msg(nss_ctx, &nnm);
-
-	if (nss_tx_status != NSS_TX_SUCCESS) {
-		nss_warning("%px: core %d nss_tx error empty paged pool buffer: %d\n",
-				nss_ctx, (int)core_num, *new_val);
-		goto failure;
-	}
 
 	/*
 	 * Blocking call, wait till we get ACK for this msg.
 	 */
-	ret = wait_for_completion_timeout(&nss_n2h_nepbcfgp[core_num].complete,
-			msecs_to_jiffies(NSS_CONN_CFG_TIMEOUT));
-	if (ret == 0) {
-		nss_warning("%px: core %d Waiting for ack timed out\n", nss_ctx, (int)core_num);
-		goto failure;
-	}
-
-	/*
-	 * ACK/NACK received from NSS FW
-	 * If ACK: Callback function will update nss_n2h_empty_pool_buf with
-	 * nss_n2h_nepbcfgp.num_conn_valid, which holds the user input
-	 */
-	if (NSS_FAILURE == nss_n2h_nepbcfgp[core_num].response) {
+	nss_tx_status = nss_n2h_tx_msg_txn(nss_ctx, &nnm, 0, NSS_CONN_CFG_TIMEOUT);
+	if (nss_tx_status != NSS_TX_SUCCESS) {
+		nss_warning("%px: core %d nss_tx error empty paged pool buffer: %d, status %d\n",
+				nss_ctx, (int)core_num, *new_val, nss_tx_status);
 		goto failure;
 	}
 
@@ -613,38 +499,22 @@ static int nss_n2h_set_water_mark(struct ctl_table *ctl, int write,
 
 	nss_n2h_msg_init(&nnm, NSS_N2H_INTERFACE,
 			NSS_TX_METADATA_TYPE_SET_WATER_MARK,
-			sizeof(struct nss_n2h_water_mark),
-			nss_n2h_payload_stats_callback,
-			(void *)(nss_ptr_t)core_num);
+			sizeof(struct nss_n2h_water_mark), NULL, NULL);
 
 	wm = &nnm.msg.wm;
 	wm->low_water = htonl(*low);
 	wm->high_water = htonl(*high);
-	nss_tx_status = nss_n2h_tx_msg(nss_ctx, &nnm);
-
-	if (nss_tx_status != NSS_TX_SUCCESS) {
-		nss_warning("%px: core %d nss_tx error setting : %d, %d\n",
-				nss_ctx, core_num, *low, *high);
-		goto failure;
-	}
 
 	/*
 	 * Blocking call, wait till we get ACK for this msg.
 	 */
-	ret = wait_for_completion_timeout(&nss_n2h_nepbcfgp[core_num].complete,
-			msecs_to_jiffies(NSS_CONN_CFG_TIMEOUT));
-	if (ret == 0) {
-		nss_warning("%px: core %d Waiting for ack timed out\n", nss_ctx,
-			core_num);
+	nss_tx_status = nss_n2h_tx_msg_txn(nss_ctx, &nnm, 0, NSS_CONN_CFG_TIMEOUT);
+	if (nss_tx_status != NSS_TX_SUCCESS) {
+		nss_warning("%px: core %d nss_tx error setting : %d, %d, status %d\n",
+				nss_ctx, core_num, *low, *high, nss_tx_status);
 		goto failure;
 	}
 
-	/*
-	 * ACK/NACK received from NSS FW
-	 */
-	if (NSS_FAILURE == nss_n2h_nepbcfgp[core_num].response)
-		goto failure;
-
 	up(&nss_n2h_nepbcfgp[core_num].sem);
 	return NSS_SUCCESS;
 
@@ -727,38 +597,22 @@ static int nss_n2h_set_paged_water_mark(struct ctl_table *ctl, int write,
 
 	nss_n2h_msg_init(&nnm, NSS_N2H_INTERFACE,
 			NSS_TX_METADATA_TYPE_SET_PAGED_WATER_MARK,
-			sizeof(struct nss_n2h_water_mark),
-			nss_n2h_payload_stats_callback,
-			(void *)(nss_ptr_t)core_num);
+			sizeof(struct nss_n2h_water_mark), NULL, NULL);
 
 	pwm = &nnm.msg.wm_paged;
 	pwm->low_water = htonl(*low);
 	pwm->high_water = htonl(*high);
-	nss_tx_status = nss_n2h_tx_msg(nss_ctx, &nnm);
-
-	if (nss_tx_status != NSS_TX_SUCCESS) {
-		nss_warning("%px: core %d nss_tx error setting : %d, %d\n",
-				nss_ctx, core_num, *low, *high);
-		goto failure;
-	}
 
 	/*
 	 * Blocking call, wait till we get ACK for this msg.
 	 */
-	ret = wait_for_completion_timeout(&nss_n2h_nepbcfgp[core_num].complete,
-			msecs_to_jiffies(NSS_CONN_CFG_TIMEOUT));
-	if (ret == 0) {
-		nss_warning("%px: core %d Waiting for ack timed out\n", nss_ctx,
-			core_num);
+	nss_tx_status = nss_n2h_tx_msg_txn(nss_ctx, &nnm, 0, NSS_CONN_CFG_TIMEOUT);
+	if (nss_tx_status != NSS_TX_SUCCESS) {
+		nss_warning("%px: core %d nss_tx error setting : %d, %d, status %d\n",
+				nss_ctx, core_num, *low, *high, nss_tx_status);
 		goto failure;
 	}
 
-	/*
-	 * ACK/NACK received from NSS FW
-	 */
-	if (NSS_FAILURE == nss_n2h_nepbcfgp[core_num].response)
-		goto failure;
-
 	up(&nss_n2h_nepbcfgp[core_num].sem);
 	return NSS_SUCCESS;
 
@@ -831,35 +685,23 @@ static int nss_n2h_cfg_wifi_pool(struct ctl_table *ctl, int write,
 
 	nss_n2h_msg_init(&nnm, NSS_N2H_INTERFACE,
 			NSS_TX_METADATA_TYPE_N2H_WIFI_POOL_BUF_CFG,
-			sizeof(struct nss_n2h_wifi_payloads),
-			nss_n2h_set_wifi_payloads_callback,
-			(void *)nss_ctx);
+			sizeof(struct nss_n2h_wifi_payloads), NULL, NULL);
 
 	wp = &nnm.msg.wp;
 	wp->payloads = htonl(*payloads);
-	nss_tx_status = nss_n2h_tx_msg(nss_ctx, &nnm);
-
-	if (nss_tx_status != NSS_TX_SUCCESS) {
-		nss_warning("%px: wifi setting %d nss_tx error",
-				nss_ctx, *payloads);
-		goto failure;
-	}
 
 	/*
 	 * Blocking call, wait till we get ACK for this msg.
 	 */
-	ret = wait_for_completion_timeout(&nss_n2h_wp.complete,
-			msecs_to_jiffies(NSS_CONN_CFG_TIMEOUT));
-	if (ret == 0) {
-		nss_warning("%px: Waiting for ack timed out\n", nss_ctx);
+	nss_tx_status = nss_n2h_tx_msg_txn(nss_ctx, &nnm, sizeof(*wp), NSS_CONN_CFG_TIMEOUT);
+	if (nss_tx_status != NSS_TX_SUCCESS) {
+		nss_warning("%px: wifi setting %d nss_tx error %d\n",
+				nss_ctx, *payloads, nss_tx_status);
 		goto failure;
 	}
 
-	/*
-	 * ACK/NACK received from NSS FW
-	 */
-	if (NSS_FAILURE == nss_n2h_wp.response)
-		goto failure;
+	nss_info("%px: wifi payload configuration succeeded\n", nss_ctx);
+	nss_n2h_wp.wifi_pool = ntohl(wp->payloads);
 
 	up(&nss_n2h_wp.sem);
 	return NSS_SUCCESS;
@@ -981,22 +823,6 @@ static int nss_n2h_wifi_payloads_handler(struct ctl_table *ctl,
 			&nss_n2h_wifi_pool_buf_cfg);
 }
 
-/*
- * nss_n2h_update_queue_config_callback()
- *	Callback to handle the completion of queue config command
- */
-static void nss_n2h_update_queue_config_callback(void *app_data, struct nss_n2h_msg *nim)
-{
-	if (nim->cm.response != NSS_CMN_RESPONSE_ACK) {
-		nss_warning("n2h Error response %d\n", nim->cm.response);
-		nss_n2h_q_cfg_pvt.response = NSS_TX_FAILURE;
-	} else {
-		nss_n2h_q_cfg_pvt.response = NSS_TX_SUCCESS;
-	}
-
-	complete(&nss_n2h_q_cfg_pvt.complete);
-}
-
 /*
  * nss_n2h_update_queue_config_async()
  *	Asynchronous call to send pnode queue configuration.
@@ -1057,7 +883,7 @@ nss_tx_status_t nss_n2h_update_queue_config_sync(struct nss_ctx_instance *nss_ct
 	struct nss_n2h_msg nnm;
 	struct nss_n2h_pnode_queue_config *cfg;
 	nss_tx_status_t status;
-	int ret, i;
+	int i;
 
 	if (!mq_en) {
 		return NSS_TX_SUCCESS;
@@ -1075,7 +901,7 @@ nss_tx_status_t nss_n2h_update_queue_config_sync(struct nss_ctx_instance *nss_ct
 
 	nss_n2h_msg_init(&nnm, NSS_N2H_INTERFACE,
 			 NSS_TX_METADATA_TYPE_N2H_SET_PNODE_QUEUE_CFG,
-			 sizeof(struct nss_n2h_pnode_queue_config), nss_n2h_update_queue_config_callback, 0);
+			 sizeof(struct nss_n2h_pnode_queue_config), NULL, NULL);
 
 	cfg = &nnm.msg.pn_q_cfg;
 
@@ -1087,24 +913,11 @@ nss_tx_status_t nss_n2h_update_queue_config_sync(struct nss_ctx_instance *nss_ct
 	}
 	cfg->mq_en = true;
 
-	down(&nss_n2h_q_cfg_pvt.sem);
-
-	status = nss_n2h_tx_msg(nss_ctx, &nnm);
-
+	status = nss_n2h_tx_msg_txn(nss_ctx, &nnm, 0, NSS_N2H_TX_TIMEOUT);
 	if (status != NSS_TX_SUCCESS) {
-		nss_warning("%px: n2h_tx_msg failed\n", nss_ctx);
-		up(&nss_n2h_q_cfg_pvt.sem);
-		return status;
-	}
-	ret = wait_for_completion_timeout(&nss_n2h_q_cfg_pvt.complete, msecs_to_jiffies(NSS_N2H_TX_TIMEOUT));
-
-	if (!ret) {
-		nss_warning("%px: Timeout expired for pnode queue config sync message\n", nss_ctx);
-		nss_n2h_q_cfg_pvt.response = NSS_TX_FAILURE;
+		nss_warning("%px: pnode queue config sync message failed: %d\n", nss_ctx, status);
 	}
 
-	status = nss_n2h_q_cfg_pvt.response;
-	up(&nss_n2h_q_cfg_pvt.sem);
 	return status;
 }
 EXPORT_SYMBOL(nss_n2h_update_queue_config_sync);
@@ -1118,41 +931,27 @@ static nss_tx_status_t nss_n2h_mitigation_cfg(struct nss_ctx_instance *nss_ctx,
 	struct nss_n2h_msg nnm;
 	struct nss_n2h_mitigation *mitigation_cfg;
 	nss_tx_status_t nss_tx_status;
-	int ret;
 
 	nss_assert(core_num < NSS_CORE_MAX);
 
 	down(&nss_n2h_mitigationcp[core_num].sem);
 	nss_n2h_msg_init(&nnm, NSS_N2H_INTERFACE, NSS_TX_METADATA_TYPE_N2H_MITIGATION_CFG,
-			sizeof(struct nss_n2h_mitigation),
-			nss_n2h_mitigation_cfg_callback,
-			(void *)core_num);
+			sizeof(struct nss_n2h_mitigation), NULL, NULL);
 
 	mitigation_cfg = &nnm.msg.mitigation_cfg;
 	mitigation_cfg->enable = enable_mitigation;
 
-	nss_tx_status = nss_n2h_tx_msg(nss_ctx, &nnm);
-
-	if (nss_tx_status != NSS_TX_SUCCESS) {
-		nss_warning("%px: nss_tx error setting mitigation\n", nss_ctx);
-		goto failure;
-	}
-
 	/*
 	 * Blocking call, wait till we get ACK for this msg.
 	 */
-	ret = wait_for_completion_timeout(&nss_n2h_mitigationcp[core_num].complete, msecs_to_jiffies(NSS_CONN_CFG_TIMEOUT));
-	if (ret == 0) {
-		nss_warning("%px: Waiting for ack timed out\n", nss_ctx);
+	nss_tx_status = nss_n2h_tx_msg_txn(nss_ctx, &nnm, sizeof(*mitigation_cfg), NSS_CONN_CFG_TIMEOUT);
+	if (nss_tx_status != NSS_TX_SUCCESS) {
+		nss_warning("%px: core%d: MITIGATION configuration failed: %d\n", nss_ctx, core_num, nss_tx_status);
 		goto failure;
 	}
 
-	/*
-	 * ACK/NACK received from NSS FW
-	 */
-	if (NSS_FAILURE == nss_n2h_mitigationcp[core_num].response) {
-		goto failure;
-	}
+	nss_info("core%d: MITIGATION configuration succeeded\n", core_num);
+	nss_ctx->n2h_mitigate_en = mitigation_cfg->enable;
 
 	up(&nss_n2h_mitigationcp[core_num].sem);
 	return NSS_SUCCESS;
@@ -1173,35 +972,50 @@ static inline void nss_n2h_buf_pool_free(struct nss_n2h_buf_pool *buf_pool)
 /*
  * nss_n2h_buf_cfg()
  *	Send Message to NSS to enable pbufs.
+ *
+ * The pages are handed over in messages of MAX_PAGES_PER_MSG pages, all
+ * sent back to back and acknowledged together.
  */
 static nss_tx_status_t nss_n2h_buf_pool_cfg(struct nss_ctx_instance *nss_ctx,
 					int buf_pool_size, nss_core_id_t core_num)
 {
-	static struct nss_n2h_msg nnm;
+	struct nss_n2h_msg *nnm;
 	struct nss_n2h_buf_pool *buf_pool;
-	nss_tx_status_t nss_tx_status;
-	int ret;
+	struct nss_tx_msg_txn *txn;
+	nss_tx_status_t nss_tx_status = NSS_TX_SUCCESS;
 	int page_count;
 	int num_pages = ALIGN(buf_pool_size, PAGE_SIZE)/PAGE_SIZE;
+	int num_msgs = DIV_ROUND_UP(num_pages, MAX_PAGES_PER_MSG);
+	int i, sent;
 
 	nss_assert(core_num < NSS_CORE_MAX);
 
-	nss_n2h_msg_init(&nnm, NSS_N2H_INTERFACE, NSS_METADATA_TYPE_N2H_ADD_BUF_POOL,
-			sizeof(struct nss_n2h_buf_pool),
-			nss_n2h_bufs_cfg_callback,
-			(void *)core_num);
+	nnm = kcalloc(num_msgs, sizeof(*nnm), GFP_KERNEL);
+	if (!nnm) {
+		nss_warning("%px: no memory for %d pbuf messages\n", nss_ctx, num_msgs);
+		return NSS_FAILURE;
+	}
 
-	do {
+	txn = nss_tx_msg_txn_alloc(nss_ctx, num_msgs, 0, NSS_CONN_CFG_TIMEOUT);
+	if (!txn) {
+		kfree(nnm);
+		return NSS_FAILURE;
+	}
+
+	down(&nss_n2h_bufcp[core_num].sem);
 
-		down(&nss_n2h_bufcp[core_num].sem);
+	for (sent = 0; sent < num_msgs && num_pages; sent++) {
+		nss_n2h_msg_init(&nnm[sent], NSS_N2H_INTERFACE, NSS_METADATA_TYPE_N2H_ADD_BUF_POOL,
+				sizeof(struct nss_n2h_buf_pool), NULL, NULL);
 
-		buf_pool = &nnm.msg.buf_pool;
+		buf_pool = &nnm[sent].msg.buf_pool;
 		buf_pool->nss_buf_page_size = PAGE_SIZE;
 
 		for (page_count = 0; page_count < MAX_PAGES_PER_MSG && num_pages; page_count++, num_pages--) {
 			void *kern_addr = kzalloc(PAGE_SIZE, GFP_ATOMIC);
 			if (!kern_addr) {
 				BUG_ON(!page_count);
+				num_pages = 0;
 				break;
 			}
 
@@ -1211,39 +1025,48 @@ static nss_tx_status_t nss_n2h_buf_pool_cfg(struct nss_ctx_instance *nss_ctx,
 		}
 
 		buf_pool->nss_buf_num_pages = page_count;
-		nss_tx_status = nss_n2h_tx_msg(nss_ctx, &nnm);
+		nss_tx_status = nss_tx_msg_txn_add(txn, (nss_tx_msg_sync_subsys_async_t)nss_n2h_tx_msg, &nnm[sent].cm, 0, 0);
 		if (nss_tx_status != NSS_TX_SUCCESS) {
-
-			nss_n2h_buf_pool_free(buf_pool);
 			nss_warning("%px: nss_tx error setting pbuf\n", nss_ctx);
-			goto failure;
+			sent++;
+			break;
 		}
+	}
 
-		/*
-		 * Blocking call, wait till we get ACK for this msg.
-		 */
-		ret = wait_for_completion_timeout(&nss_n2h_bufcp[core_num].complete, msecs_to_jiffies(NSS_CONN_CFG_TIMEOUT));
-		if (ret == 0) {
-			nss_warning("%px: Waiting for ack timed out\n", nss_ctx);
-			goto failure;
-		}
+	/*
+	 * Blocking call, wait till we get ACK for the messages sent.
+	 */
+	if (nss_tx_msg_txn_wait(txn) != NSS_TX_SUCCESS) {
+		nss_tx_status = NSS_TX_FAILURE;
+	}
 
-		/*
-		 * ACK/NACK received from NSS FW
-		 */
-		if (NSS_FAILURE == nss_n2h_bufcp[core_num].response) {
+	for (i = 0; i < sent; i++) {
+		buf_pool = &nnm[i].msg.buf_pool;
+
+		switch (nss_tx_msg_txn_status(txn, i)) {
+		case NSS_TX_SUCCESS:
+			nss_ctx->buf_sz_allocated += buf_pool->nss_buf_page_size * buf_pool->nss_buf_num_pages;
+			break;
+
+		case NSS_TX_FAILURE_SYNC_TIMEOUT:
+			/*
+			 * The firmware may still own the pages.
+			 */
+			nss_warning("%px: core%d: buf configuration timed out\n", nss_ctx, core_num);
+			break;
 
+		default:
+			nss_warning("%px: core%d: buf configuration failed\n", nss_ctx, core_num);
 			nss_n2h_buf_pool_free(buf_pool);
-			goto failure;
+			break;
 		}
+	}
 
-		up(&nss_n2h_bufcp[core_num].sem);
-	} while(num_pages);
-
-	return NSS_SUCCESS;
-failure:
+	nss_tx_msg_txn_free(txn);
 	up(&nss_n2h_bufcp[core_num].sem);
-	return NSS_FAILURE;
+	kfree(nnm);
+
+	return (nss_tx_status == NSS_TX_SUCCESS) ? NSS_SUCCESS : NSS_FAILURE;
 }
 
 /*
@@ -1386,20 +1209,6 @@ static int nss_n2h_buf_cfg_core1_handler(struct ctl_table *ctl, int write, void
 	return -EINVAL;
 }
 
-/*
- * nss_n2h_queue_limit_callback()
- *	Callback to handle the completion of queue limit command.
- */
-static void nss_n2h_queue_limit_callback(void *app_data, struct nss_n2h_msg *nim)
-{
-	if (nim->cm.response != NSS_CMN_RESPONSE_ACK) {
-		nss_warning("n2h error response %d\n", nim->cm.response);
-	}
-
-	nss_n2h_q_lim_pvt.response = nim->cm.response;
-	complete(&nss_n2h_q_lim_pvt.complete);
-}
-
 /*
  * nss_n2h_set_queue_limit_sync()
  *	Sets the n2h queue size limit synchronously.
@@ -1440,7 +1249,7 @@ static int nss_n2h_set_queue_limit_sync(struct ctl_table *ctl, int write, void _
 	memset(&nim, 0, sizeof(struct nss_n2h_msg));
 	nss_n2h_msg_init(&nim, NSS_N2H_INTERFACE,
 			NSS_TX_METADATA_TYPE_N2H_QUEUE_LIMIT_CFG,
-			sizeof(struct nss_n2h_queue_limit_config), nss_n2h_queue_limit_callback, NULL);
+			sizeof(struct nss_n2h_queue_limit_config), NULL, NULL);
 
 	nnqlc = &nim.msg.ql_cfg;
 	nnqlc->qlimit = nss_n2h_queue_limit[core_id];
@@ -1450,31 +1259,18 @@ static int nss_n2h_set_queue_limit_sync(struct ctl_table *ctl, int write, void _
 	 */
 	down(&nss_n2h_q_lim_pvt.sem);
 
-	nss_tx_status = nss_n2h_tx_msg(nss_ctx, &nim);
-	if (nss_tx_status != NSS_TX_SUCCESS) {
-		nss_warning("%px: n2h queue limit message send failed\n", nss_ctx);
-		nss_n2h_queue_limit[core_id] = current_val;
-		up(&nss_n2h_q_lim_pvt.sem);
-		return nss_tx_status;
-	}
-
-	ret = wait_for_completion_timeout(&nss_n2h_q_lim_pvt.complete, msecs_to_jiffies(NSS_N2H_TX_TIMEOUT));
-	if (!ret) {
-		nss_warning("%px: Timeout expired for queue limit sync message\n", nss_ctx);
-		nss_n2h_queue_limit[core_id] = current_val;
-		up(&nss_n2h_q_lim_pvt.sem);
-		return NSS_TX_FAILURE;
-	}
+	nss_tx_status = nss_n2h_tx_msg_txn(nss_ctx, &nim, 0, NSS_N2H_TX_TIMEOUT);
 
 	/*
 	 * If setting the queue limit failed, reset the value to original value
 	 */
-	if (nss_n2h_q_lim_pvt.response != NSS_CMN_RESPONSE_ACK) {
+	if (nss_tx_status != NSS_TX_SUCCESS) {
+		nss_warning("%px: n2h queue limit message failed: %d\n", nss_ctx, nss_tx_status);
 		nss_n2h_queue_limit[core_id] = current_val;
 	}
 
 	up(&nss_n2h_q_lim_pvt.sem);
-	return NSS_TX_SUCCESS;
+	return (nss_tx_status == NSS_TX_FAILURE_SYNC_FW_ERR) ? NSS_TX_SUCCESS : nss_tx_status;
 }
 
 /*
@@ -1501,25 +1297,6 @@ static int nss_n2h_queue_limit_core1_handler(struct ctl_table *ctl,
 			NSS_CORE_1);
 }
 
-/*
- * nss_n2h_host_bp_cfg_callback()
- *	Callback function for back pressure configuration.
- */
-static void nss_n2h_host_bp_cfg_callback(void *app_data, struct nss_n2h_msg *nnm)
-{
-	struct nss_ctx_instance *nss_ctx __maybe_unused = (struct nss_ctx_instance *)app_data;
-	if (nnm->cm.response != NSS_CMN_RESPONSE_ACK) {
-		nss_n2h_host_bp_cfg_pvt.response = NSS_FAILURE;
-		complete(&nss_n2h_host_bp_cfg_pvt.complete);
-		nss_warning("%px: n2h back pressure configuration failed : %d\n", nss_ctx, nnm->cm.error);
-		return;
-	}
-
-	nss_info("%px: n2h back pressure configuration succeeded: %d\n", nss_ctx, nnm->cm.error);
-	nss_n2h_host_bp_cfg_pvt.response = NSS_SUCCESS;
-	complete(&nss_n2h_host_bp_cfg_pvt.complete);
-}
-
 /*
  * nss_n2h_host_bp_cfg()
  *	Send Message to n2h to enable back pressure.
@@ -1528,42 +1305,25 @@ static nss_tx_status_t nss_n2h_host_bp_cfg_sync(struct nss_ctx_instance *nss_ctx
 {
 	struct nss_n2h_msg nnm;
 	nss_tx_status_t nss_tx_status;
-	int ret;
 
 	down(&nss_n2h_host_bp_cfg_pvt.sem);
 	nss_n2h_msg_init(&nnm, NSS_N2H_INTERFACE, NSS_TX_METADATA_TYPE_N2H_HOST_BACK_PRESSURE_CFG,
-			sizeof(struct nss_n2h_host_back_pressure),
-			nss_n2h_host_bp_cfg_callback,
-			(void *)nss_ctx);
+			sizeof(struct nss_n2h_host_back_pressure), NULL, NULL);
 
 	nnm.msg.host_bp_cfg.enable = enable_bp;
 
-	nss_tx_status = nss_n2h_tx_msg(nss_ctx, &nnm);
-	if (nss_tx_status != NSS_TX_SUCCESS) {
-		nss_warning("%px: nss_tx error setting back pressure\n", nss_ctx);
-		up(&nss_n2h_host_bp_cfg_pvt.sem);
-		return NSS_FAILURE;
-	}
-
 	/*
 	 * Blocking call, wait till we get ACK for this msg.
 	 */
-	ret = wait_for_completion_timeout(&nss_n2h_host_bp_cfg_pvt.complete, msecs_to_jiffies(NSS_CONN_CFG_TIMEOUT));
-	if (ret == 0) {
-		nss_warning("%px: Waiting for ack timed out\n", nss_ctx);
-		up(&nss_n2h_host_bp_cfg_pvt.sem);
-		return NSS_FAILURE;
-	}
+	nss_tx_status = nss_n2h_tx_msg_txn(nss_ctx, &nnm, 0, NSS_CONN_CFG_TIMEOUT);
+	up(&nss_n2h_host_bp_cfg_pvt.sem);
 
-	/*
-	 * Response received from NSS FW
-	 */
-	if (nss_n2h_host_bp_cfg_pvt.response == NSS_FAILURE) {
-		up(&nss_n2h_host_bp_cfg_pvt.sem);
+	if (nss_tx_status != NSS_TX_SUCCESS) {
+		nss_warning("%px: n2h back pressure configuration failed: %d\n", nss_ctx, nss_tx_status);
 		return NSS_FAILURE;
 	}
 
-	up(&nss_n2h_host_bp_cfg_pvt.sem);
+	nss_info("%px: n2h back pressure configuration succeeded\n", nss_ctx);
 	return NSS_SUCCESS;
 }
 
@@ -1625,6 +1385,251 @@ static int nss_n2h_host_bp_cfg_core1_handler(struct ctl_table *ctl, int write,
 	return nss_n2h_host_bp_cfg_handler(ctl, write, buffer, lenp, ppos, NSS_CORE_1);
 }
 
+/*
+ * nss_n2h_autotune_mem_avail_mb()
+ *	Host memory that can still be handed out as empty buffers, in MB.
+ */
+static unsigned long nss_n2h_autotune_mem_avail_mb(void)
+{
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(4, 6, 0))
+	return si_mem_available() >> (20 - PAGE_SHIFT);
+#else
+	return global_page_state(NR_FREE_PAGES) >> (20 - PAGE_SHIFT);
+#endif
+}
+
+/*
+ * nss_n2h_autotune_set_pool()
+ *	Send a new empty buffer pool size to the core.
+ *
+ * Semaphore of the core must be held.
+ */
+static int nss_n2h_autotune_set_pool(uint32_t core_num, uint32_t pool_size)
+{
+	struct nss_n2h_msg nnm;
+
+	nss_n2h_msg_init(&nnm, NSS_N2H_INTERFACE,
+			NSS_TX_METADATA_TYPE_N2H_EMPTY_POOL_BUF_CFG,
+			sizeof(struct nss_n2h_empty_pool_buf), NULL, NULL);
+
+	nnm.msg.empty_pool_buf_cfg.pool_size = htonl(pool_size);
+	if (nss_n2h_get_payload_info(core_num, &nnm, NULL) != NSS_SUCCESS) {
+		return NSS_FAILURE;
+	}
+
+	nss_n2h_nepbcfgp[core_num].empty_buf_pool_info.pool_size = pool_size;
+	nss_n2h_empty_pool_buf_cfg[core_num] = pool_size;
+	return NSS_SUCCESS;
+}
+
+/*
+ * nss_n2h_autotune_set_water_mark()
+ *	Send new empty buffer water marks to the core.
+ *
+ * Semaphore of the core must be held.
+ */
+static int nss_n2h_autotune_set_water_mark(uint32_t core_num, uint32_t low, uint32_t high)
+{
+	struct nss_n2h_msg nnm;
+
+	nss_n2h_msg_init(&nnm, NSS_N2H_INTERFACE,
+			NSS_TX_METADATA_TYPE_SET_WATER_MARK,
+			sizeof(struct nss_n2h_water_mark), NULL, NULL);
+
+	nnm.msg.wm.low_water = htonl(low);
+	nnm.msg.wm.high_water = htonl(high);
+	if (nss_n2h_get_payload_info(core_num, &nnm, NULL) != NSS_SUCCESS) {
+		return NSS_FAILURE;
+	}
+
+	nss_n2h_nepbcfgp[core_num].empty_buf_pool_info.low_water = low;
+	nss_n2h_nepbcfgp[core_num].empty_buf_pool_info.high_water = high;
+	nss_n2h_water_mark[core_num][0] = low;
+	nss_n2h_water_mark[core_num][1] = high;
+	return NSS_SUCCESS;
+}
+
+/*
+ * nss_n2h_autotune_work()
+ *	Periodically resize the empty buffer pool of a core.
+ *
+ * High water grows by a quarter whenever the core ran out of payloads or
+ * kept raising SOS for empty buffers during the last period, and drops
+ * by an eighth after a long quiet spell, but never below what the
+ * measured N2H packet rate needs for NSS_N2H_AUTOTUNE_HEADROOM_MS of
+ * traffic. Low host memory shrinks it by a quarter regardless. Low water
+ * keeps its ratio to high water and the pool size is kept above high
+ * water; everything stays within the n2h_autotune_min/max bounds.
+ */
+static void nss_n2h_autotune_work(struct work_struct *work)
+{
+	struct nss_n2h_autotune *at = container_of(to_delayed_work(work), struct nss_n2h_autotune, work);
+	uint32_t core_num = at->core;
+	struct nss_ctx_instance *nss_ctx = &nss_top_main.nss[core_num];
+	struct nss_n2h_payload_info *info = &nss_n2h_nepbcfgp[core_num].empty_buf_pool_info;
+	uint32_t sos, delta_sos, low, high, pool, floor, lower, upper;
+	uint64_t fails, pkts, delta_fails, delta_pkts;
+	unsigned long avail_mb;
+	bool pressure;
+
+	if (!READ_ONCE(nss_n2h_autotune)) {
+		return;
+	}
+
+	if (nss_ctx->state != NSS_CORE_STATE_INITIALIZED) {
+		goto resched;
+	}
+
+	/*
+	 * Leave the period out if a sysctl handler is talking to the core.
+	 */
+	if (down_trylock(&nss_n2h_nepbcfgp[core_num].sem)) {
+		goto resched;
+	}
+
+	/*
+	 * Always start from what the firmware is using, the water marks
+	 * may have been changed through sysctl since the last period.
+	 */
+	if (nss_n2h_get_default_payload_info(core_num) != NSS_SUCCESS || !info->high_water) {
+		goto unlock;
+	}
+
+	sos = READ_ONCE(nss_ctx->empty_buf_sos);
+	fails = nss_n2h_stats_get(core_num, NSS_N2H_STATS_PAYLOAD_ALLOC_FAILS);
+	pkts = nss_n2h_stats_get(core_num, NSS_N2H_STATS_N2H_DATA_PACKETS);
+	delta_sos = sos - at->last_sos;
+	delta_fails = fails - at->last_alloc_fails;
+	delta_pkts = pkts - at->last_data_pkts;
+	at->last_sos = sos;
+	at->last_alloc_fails = fails;
+	at->last_data_pkts = pkts;
+
+	if (!at->primed) {
+		at->primed = true;
+		goto unlock;
+	}
+
+	lower = max_t(uint32_t, nss_n2h_autotune_min, NSS_N2H_MIN_EMPTY_POOL_BUF_SZ);
+	upper = clamp_t(uint32_t, nss_n2h_autotune_max, lower, NSS_N2H_MAX_EMPTY_POOL_BUF_SZ);
+
+	avail_mb = nss_n2h_autotune_mem_avail_mb();
+	pressure = avail_mb < (unsigned long)nss_n2h_autotune_min_free_mb;
+
+	high = info->high_water;
+	if (pressure) {
+		high -= high / 4;
+		at->quiet = 0;
+	} else if (delta_fails || delta_sos >= NSS_N2H_AUTOTUNE_SOS_THRESHOLD) {
+		high += high / 4;
+		at->quiet = 0;
+	} else if (++at->quiet >= NSS_N2H_AUTOTUNE_QUIET_PERIODS) {
+		floor = (uint32_t)min_t(uint64_t, div_u64(delta_pkts * NSS_N2H_AUTOTUNE_HEADROOM_MS, NSS_N2H_AUTOTUNE_PERIOD_MS), upper);
+		high = max(high - high / 8, floor);
+		at->quiet = 0;
+	}
+
+	high = clamp(high, lower, upper);
+	if (pressure) {
+		high = min(high, info->high_water);
+	}
+
+	low = (uint32_t)div_u64((uint64_t)high * info->low_water, info->high_water);
+	low = clamp_t(uint32_t, low, NSS_N2H_MIN_EMPTY_POOL_BUF_SZ, high);
+
+	/*
+	 * Grow the pool to keep room above high water; only give buffers
+	 * back to the host when it is short of memory.
+	 */
+	pool = info->pool_size;
+	if (pool < high + high / 4 || pressure) {
+		pool = min_t(uint32_t, high + high / 4, NSS_N2H_MAX_EMPTY_POOL_BUF_SZ);
+	}
+
+	if (high == info->high_water && low == info->low_water && pool == info->pool_size) {
+		goto unlock;
+	}
+
+	nss_info_always("%px: core %d n2h autotune: high water %u -> %u, low water %u -> %u, pool %u -> %u "
+			"(sos %u, alloc fails %llu, n2h packets %llu, available %luMB)\n",
+			nss_ctx, core_num, info->high_water, high, info->low_water, low, info->pool_size, pool,
+			delta_sos, delta_fails, delta_pkts, avail_mb);
+
+	/*
+	 * Never let high water run ahead of the pool: resize the pool first
+	 * when growing and last when shrinking.
+	 */
+	if (pool > info->pool_size && nss_n2h_autotune_set_pool(core_num, pool) != NSS_SUCCESS) {
+		goto fail;
+	}
+
+	if ((high != info->high_water || low != info->low_water) &&
+			nss_n2h_autotune_set_water_mark(core_num, low, high) != NSS_SUCCESS) {
+		goto fail;
+	}
+
+	if (pool < info->pool_size && nss_n2h_autotune_set_pool(core_num, pool) != NSS_SUCCESS) {
+		goto fail;
+	}
+
+	goto unlock;
+
+fail:
+	nss_warning("%px: core %d n2h autotune adjustment failed\n", nss_ctx, core_num);
+
+unlock:
+	up(&nss_n2h_nepbcfgp[core_num].sem);
+
+resched:
+	schedule_delayed_work(&at->work, msecs_to_jiffies(NSS_N2H_AUTOTUNE_PERIOD_MS));
+}
+
+/*
+ * nss_n2h_autotune_init()
+ *	Prepare the water mark controller of a core.
+ */
+static void nss_n2h_autotune_init(uint32_t core_num)
+{
+	struct nss_n2h_autotune *at = &nss_n2h_at[core_num];
+
+	at->core = core_num;
+	at->primed = false;
+	at->quiet = 0;
+	INIT_DELAYED_WORK(&at->work, nss_n2h_autotune_work);
+}
+
+/*
+ * nss_n2h_autotune_handler()
+ *	Start or stop the water mark controller on all cores.
+ */
+static int nss_n2h_autotune_handler(struct ctl_table *ctl, int write,
+				void __user *buffer, size_t *lenp, loff_t *ppos)
+{
+	struct nss_top_instance *nss_top = &nss_top_main;
+	int ret, i;
+
+	ret = proc_dointvec(ctl, write, buffer, lenp, ppos);
+	if (!write || ret) {
+		return ret;
+	}
+
+	for (i = 0; i < nss_top->num_nss; i++) {
+		struct nss_n2h_autotune *at = &nss_n2h_at[i];
+
+		if (!nss_n2h_autotune) {
+			cancel_delayed_work_sync(&at->work);
+			continue;
+		}
+
+		at->primed = false;
+		at->quiet = 0;
+		schedule_delayed_work(&at->work, msecs_to_jiffies(NSS_N2H_AUTOTUNE_PERIOD_MS));
+	}
+
+	nss_info_always("n2h water mark autotune %s\n", nss_n2h_autotune ? "enabled" : "disabled");
+	return 0;
+}
+
 static struct ctl_table nss_n2h_table_single_core[] = {
 	{
 		.procname	= "n2h_empty_pool_buf_core0",
@@ -1704,6 +1709,40 @@ static struct ctl_table nss_n2h_table_single_core[] = {
 		.proc_handler	= &nss_n2h_host_bp_cfg_core0_handler,
 	},
 
+	{
+		.procname	= "n2h_autotune",
+		.data		= &nss_n2h_autotune,
+		.maxlen		= sizeof(int),
+		.mode		= 0644,
+		.proc_handler	= &nss_n2h_autotune_handler,
+	},
+	{
+		.procname	= "n2h_autotune_min",
+		.data		= &nss_n2h_autotune_min,
+		.maxlen		= sizeof(int),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_minmax,
+		.extra1		= &nss_n2h_autotune_buf_min,
+		.extra2		= &nss_n2h_autotune_buf_max,
+	},
+	{
+		.procname	= "n2h_autotune_max",
+		.data		= &nss_n2h_autotune_max,
+		.maxlen		= sizeof(int),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_minmax,
+		.extra1		= &nss_n2h_autotune_buf_min,
+		.extra2		= &nss_n2h_autotune_buf_max,
+	},
+	{
+		.procname	= "n2h_autotune_min_free_mb",
+		.data		= &nss_n2h_autotune_min_free_mb,
+		.maxlen		= sizeof(int),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_minmax,
+		.extra1		= &nss_n2h_autotune_zero,
+	},
+
 	{ }
 };
 
@@ -1856,6 +1895,40 @@ static struct ctl_table nss_n2h_table_multi_core[] = {
 		.mode		= 0644,
 		.proc_handler	= &nss_n2h_host_bp_cfg_core1_handler,
 	},
+	{
+		.procname	= "n2h_autotune",
+		.data		= &nss_n2h_autotune,
+		.maxlen		= sizeof(int),
+		.mode		= 0644,
+		.proc_handler	= &nss_n2h_autotune_handler,
+	},
+	{
+		.procname	= "n2h_autotune_min",
+		.data		= &nss_n2h_autotune_min,
+		.maxlen		= sizeof(int),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_minmax,
+		.extra1		= &nss_n2h_autotune_buf_min,
+		.extra2		= &nss_n2h_autotune_buf_max,
+	},
+	{
+		.procname	= "n2h_autotune_max",
+		.data		= &nss_n2h_autotune_max,
+		.maxlen		= sizeof(int),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_minmax,
+		.extra1		= &nss_n2h_autotune_buf_min,
+		.extra2		= &nss_n2h_autotune_buf_max,
+	},
+	{
+		.procname	= "n2h_autotune_min_free_mb",
+		.data		= &nss_n2h_autotune_min_free_mb,
+		.maxlen		= sizeof(int),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_minmax,
+		.extra1		= &nss_n2h_autotune_zero,
+	},
+
 	{ }
 };
 
@@ -2054,9 +2127,6 @@ struct nss_ctx_instance *nss_n2h_notify_register(int core, nss_n2h_msg_callback_
  */
 void nss_n2h_register_handler(struct nss_ctx_instance *nss_ctx)
 {
-	sema_init(&nss_n2h_q_cfg_pvt.sem, 1);
-	init_completion(&nss_n2h_q_cfg_pvt.complete);
-
 	nss_core_register_handler(nss_ctx, NSS_N2H_INTERFACE, nss_n2h_interface_handler, NULL);
 
 	if (nss_ctx->id == NSS_CORE_0) {
@@ -2107,6 +2177,7 @@ void nss_n2h_single_core_register_sysctl(void)
 		nss_n2h_paged_water_mark[NSS_CORE_0][0];
 	nss_n2h_nepbcfgp[NSS_CORE_0].empty_paged_buf_pool_info.high_water =
 		nss_n2h_paged_water_mark[NSS_CORE_0][1];
+	nss_n2h_autotune_init(NSS_CORE_0);
 
 	/*
 	 * WiFi pool buf cfg sema init
@@ -2187,6 +2258,7 @@ void nss_n2h_multi_core_register_sysctl(void)
 		nss_n2h_paged_water_mark[NSS_CORE_0][0];
 	nss_n2h_nepbcfgp[NSS_CORE_0].empty_paged_buf_pool_info.high_water =
 		nss_n2h_paged_water_mark[NSS_CORE_0][1];
+	nss_n2h_autotune_init(NSS_CORE_0);
 
 	/*
 	 * Core1
@@ -2205,6 +2277,7 @@ void nss_n2h_multi_core_register_sysctl(void)
 		nss_n2h_paged_water_mark[NSS_CORE_1][0];
 	nss_n2h_nepbcfgp[NSS_CORE_1].empty_paged_buf_pool_info.high_water =
 		nss_n2h_paged_water_mark[NSS_CORE_1][1];
+	nss_n2h_autotune_init(NSS_CORE_1);
 
 	/*
 	 * WiFi pool buf cfg sema init
@@ -2239,12 +2312,19 @@ void nss_n2h_multi_core_register_sysctl(void)
  */
 void nss_n2h_unregister_sysctl(void)
 {
+	int i;
+
 	/*
 	 * Unregister sysctl table.
 	 */
 	if (nss_n2h_header) {
 		unregister_sysctl_table(nss_n2h_header);
 	}
+
+	nss_n2h_autotune = 0;
+	for (i = 0; i < nss_top_main.num_nss; i++) {
+		cancel_delayed_work_sync(&nss_n2h_at[i].work);
+	}
 }
 
 EXPORT_SYMBOL(nss_n2h_notify_register);
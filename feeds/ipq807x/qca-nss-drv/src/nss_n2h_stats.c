@@ -24,6 +24,11 @@
  */
 ATOMIC_NOTIFIER_HEAD(nss_n2h_stats_notifier);
 
+/*
+ * Statistics domain for N2H; nss_n2h_stats_sync() updates under it.
+ */
+static struct nss_stats_domain nss_n2h_stats_domain = NSS_STATS_DOMAIN_INIT(nss_n2h_stats_domain);
+
 uint64_t nss_n2h_stats[NSS_MAX_CORES][NSS_N2H_STATS_MAX];
 
 /*
@@ -32,7 +37,7 @@ uint64_t nss_n2h_stats[NSS_MAX_CORES][NSS_N2H_STATS_MAX];
  */
 static ssize_t nss_n2h_stats_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos)
 {
-	int32_t i, core;
+	int32_t core;
 
 	/*
 	 * Max output lines = #stats + few blank lines for banner printing +
@@ -61,11 +66,7 @@ static ssize_t nss_n2h_stats_read(struct file *fp, char __user *ubuf, size_t sz,
 	 * N2H node stats
 	 */
 	for (core = 0; core < nss_top_main.num_nss; core++) {
-		spin_lock_bh(&nss_top_main.stats_lock);
-		for (i = 0; i < NSS_N2H_STATS_MAX; i++) {
-			stats_shadow[i] = nss_n2h_stats[core][i];
-		}
-		spin_unlock_bh(&nss_top_main.stats_lock);
+		nss_stats_domain_copy(&nss_n2h_stats_domain, stats_shadow, nss_n2h_stats[core], sizeof(nss_n2h_stats[core]));
 		size_wr += nss_stats_banner(lbuf, size_wr, size_al, "n2h", core);
 		size_wr += nss_stats_print("n2h", NULL, NSS_STATS_SINGLE_INSTANCE
 						, nss_n2h_strings_stats
@@ -95,17 +96,28 @@ void nss_n2h_stats_dentry_create(void)
 	nss_stats_create_dentry("n2h", &nss_n2h_stats_ops);
 }
 
+/*
+ * nss_n2h_stats_get()
+ *	Read a single N2H statistic of a core.
+ */
+uint64_t nss_n2h_stats_get(uint32_t core, uint32_t index)
+{
+	uint64_t val;
+
+	nss_stats_domain_copy(&nss_n2h_stats_domain, &val, &nss_n2h_stats[core][index], sizeof(val));
+	return val;
+}
+
 /*
  * nss_n2h_stats_sync()
  *	Handle the syncing of NSS statistics.
  */
 void nss_n2h_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss_n2h_stats_sync *nnss)
 {
-	struct nss_top_instance *nss_top = nss_ctx->nss_top;
 	int id = nss_ctx->id;
 	int j;
 
-	spin_lock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_begin(&nss_n2h_stats_domain);
 
 	/*
 	 * common node stats
@@ -170,7 +182,7 @@ void nss_n2h_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss_n2h_stats_s
 	nss_n2h_stats[id][NSS_N2H_STATS_N2H_INTERFACE_INVALID] += nnss->data_interface_invalid;
 	nss_n2h_stats[id][NSS_N2H_STATS_ENQUEUE_RETRIES] += nnss->enqueue_retries;
 
-	spin_unlock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_end(&nss_n2h_stats_domain);
 }
 
 /*
@@ -189,7 +201,7 @@ void nss_n2h_stats_notify(struct nss_ctx_instance *nss_ctx)
 	}
 
 	stats.core_id = nss_ctx->id;
-	memcpy(stats.n2h_stats, nss_n2h_stats[stats.core_id], sizeof(stats.n2h_stats));
+	nss_stats_domain_copy(&nss_n2h_stats_domain, stats.n2h_stats, nss_n2h_stats[stats.core_id], sizeof(stats.n2h_stats));
 	atomic_notifier_call_chain(&nss_n2h_stats_notifier, NSS_STATS_EVENT_NOTIFY, (void *)&stats);
 }
 
@@ -23,5 +23,6 @@
 extern void nss_n2h_stats_notify(struct nss_ctx_instance *nss_ctx);
 extern void nss_n2h_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss_n2h_stats_sync *nnss);
 extern void nss_n2h_stats_dentry_create(void);
+extern uint64_t nss_n2h_stats_get(uint32_t core, uint32_t index);
 
 #endif /* __NSS_N2H_STATS_H */
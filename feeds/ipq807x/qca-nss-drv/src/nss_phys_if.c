@@ -54,13 +54,13 @@ static void nss_phys_if_update_driver_stats(struct nss_ctx_instance *nss_ctx, ui
 	struct nss_top_instance *nss_top = nss_ctx->nss_top;
 	uint64_t *top_stats = &(nss_top->stats_gmac[id][0]);
 
-	spin_lock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_begin(&nss_gmac_stats_domain);
 	top_stats[NSS_GMAC_STATS_TOTAL_TICKS] += stats->estats.gmac_total_ticks;
 	if (unlikely(top_stats[NSS_GMAC_STATS_WORST_CASE_TICKS] < stats->estats.gmac_worst_case_ticks)) {
 		top_stats[NSS_GMAC_STATS_WORST_CASE_TICKS] = stats->estats.gmac_worst_case_ticks;
 	}
 	top_stats[NSS_GMAC_STATS_ITERATIONS] += stats->estats.gmac_iterations;
-	spin_unlock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_end(&nss_gmac_stats_domain);
 }
 
 /*
@@ -157,10 +157,10 @@ static void nss_phys_if_callback(void *app_data, struct nss_phys_if_msg *nim)
 }
 
 /*
- * nss_phys_if_buf()
- *	Send packet to physical interface owned by NSS
+ * nss_phys_if_buf_more()
+ *	Send packet to physical interface owned by NSS, deferring the doorbell while xmit_more is set
  */
-nss_tx_status_t nss_phys_if_buf(struct nss_ctx_instance *nss_ctx, struct sk_buff *os_buf, uint32_t if_num)
+nss_tx_status_t nss_phys_if_buf_more(struct nss_ctx_instance *nss_ctx, struct sk_buff *os_buf, uint32_t if_num, bool xmit_more)
 {
 	nss_trace("%px: Phys If Tx packet, id:%d, data=%px", nss_ctx, if_num, os_buf->data);
 
@@ -174,12 +174,91 @@ nss_tx_status_t nss_phys_if_buf(struct nss_ctx_instance *nss_ctx, struct sk_buff
 #if defined(NSS_HAL_IPQ807x_SUPPORT) || defined(NSS_HAL_IPQ60XX_SUPPORT)
 		nss_phy_tstamp_tx_buf(os_buf->dev, os_buf);
 #endif
-		if (!(skb_shinfo(os_buf)->tx_flags & SKBTX_IN_PROGRESS))
+		if (!(skb_shinfo(os_buf)->tx_flags & SKBTX_IN_PROGRESS)) {
+			/*
+			 * Publish what an earlier xmit_more left behind before the
+			 * packet takes the tstamp path.
+			 */
+			nss_core_flush_data_queues(nss_ctx);
 			return nss_tstamp_tx_buf(nss_ctx, os_buf, if_num);
+		}
+	}
+#endif
+
+	return nss_core_send_packet_more(nss_ctx, os_buf, if_num, H2N_BIT_FLAG_BUFFER_REUSABLE, xmit_more);
+}
+
+/*
+ * nss_phys_if_buf()
+ *	Send packet to physical interface owned by NSS
+ */
+nss_tx_status_t nss_phys_if_buf(struct nss_ctx_instance *nss_ctx, struct sk_buff *os_buf, uint32_t if_num)
+{
+	return nss_phys_if_buf_more(nss_ctx, os_buf, if_num, false);
+}
+
+#ifdef NSS_DRV_TSTAMP_ENABLE
+/*
+ * nss_phys_if_list_needs_tstamp()
+ *	Returns true if any packet of the list needs a Tx timestamp
+ */
+static bool nss_phys_if_list_needs_tstamp(struct sk_buff_head *list)
+{
+	struct sk_buff *os_buf;
+
+	skb_queue_walk(list, os_buf) {
+		if (unlikely(skb_shinfo(os_buf)->tx_flags & SKBTX_HW_TSTAMP)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+#endif
+
+/*
+ * nss_phys_if_buf_list()
+ *	Send a burst of packets to physical interface owned by NSS
+ *
+ * Packets that were not sent are left on the list and belong to the caller.
+ */
+nss_tx_status_t nss_phys_if_buf_list(struct nss_ctx_instance *nss_ctx, struct sk_buff_head *list, uint32_t if_num)
+{
+	uint32_t sent;
+
+	nss_trace("%px: Phys If Tx packet list, id:%d, len=%u", nss_ctx, if_num, skb_queue_len(list));
+
+#ifdef NSS_DRV_TSTAMP_ENABLE
+	/*
+	 * Timestamped packets take a different path; fall back to sending
+	 * the list one packet at a time.
+	 */
+	if (unlikely(nss_phys_if_list_needs_tstamp(list))) {
+		struct sk_buff *os_buf;
+		nss_tx_status_t status;
+
+		while ((os_buf = __skb_dequeue(list)) != NULL) {
+			status = nss_phys_if_buf(nss_ctx, os_buf, if_num);
+			if (status != NSS_TX_SUCCESS) {
+				__skb_queue_head(list, os_buf);
+				return status;
+			}
+		}
+
+		return NSS_TX_SUCCESS;
 	}
 #endif
 
-	return nss_core_send_packet(nss_ctx, os_buf, if_num, H2N_BIT_FLAG_BUFFER_REUSABLE);
+	return nss_core_send_packet_list(nss_ctx, list, if_num, H2N_BIT_FLAG_BUFFER_REUSABLE, &sent);
+}
+
+/*
+ * nss_phys_if_buf_flush()
+ *	Publish packets left behind by nss_phys_if_buf_more()
+ */
+void nss_phys_if_buf_flush(struct nss_ctx_instance *nss_ctx)
+{
+	nss_core_flush_data_queues(nss_ctx);
 }
 
 /*
@@ -215,6 +215,36 @@ struct nss_ctx_instance *nss_phys_if_register(uint32_t if_num,
  */
 nss_tx_status_t nss_phys_if_buf(struct nss_ctx_instance *nss_ctx, struct sk_buff *os_buf, uint32_t if_num);
 
+/**
+ * @brief Send GMAC packet from ndo_start_xmit, deferring the doorbell while the stack has more packets
+ *
+ * @param nss_ctx NSS context
+ * @param os_buf OS buffer (e.g. skbuff)
+ * @param if_num GMAC i/f number
+ * @param xmit_more True if the stack has more packets queued behind os_buf
+ *
+ * @return nss_tx_status_t Tx status
+ */
+nss_tx_status_t nss_phys_if_buf_more(struct nss_ctx_instance *nss_ctx, struct sk_buff *os_buf, uint32_t if_num, bool xmit_more);
+
+/**
+ * @brief Send a burst of GMAC packets with a single doorbell
+ *
+ * @param nss_ctx NSS context
+ * @param list List of OS buffers; buffers not sent are left on the list
+ * @param if_num GMAC i/f number
+ *
+ * @return nss_tx_status_t Tx status
+ */
+nss_tx_status_t nss_phys_if_buf_list(struct nss_ctx_instance *nss_ctx, struct sk_buff_head *list, uint32_t if_num);
+
+/**
+ * @brief Publish packets deferred by nss_phys_if_buf_more()
+ *
+ * @param nss_ctx NSS context
+ */
+void nss_phys_if_buf_flush(struct nss_ctx_instance *nss_ctx);
+
 /**
  * @brief Send message to physical interface
  *
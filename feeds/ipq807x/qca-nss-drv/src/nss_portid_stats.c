@@ -28,6 +28,11 @@ struct nss_stats_info nss_portid_stats_str[NSS_PORTID_STATS_MAX] = {
 	{"rx_invalid_header"	, NSS_STATS_TYPE_EXCEPTION}
 };
 
+/*
+ * Statistics domain for port ID; the sync handler below updates under it.
+ */
+static struct nss_stats_domain nss_portid_stats_domain = NSS_STATS_DOMAIN_INIT(nss_portid_stats_domain);
+
 uint64_t nss_portid_stats[NSS_PORTID_STATS_MAX];
 
 /*
@@ -36,7 +41,6 @@ uint64_t nss_portid_stats[NSS_PORTID_STATS_MAX];
  */
 static ssize_t nss_portid_stats_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos)
 {
-	int32_t i;
 	/*
 	 * Max output lines = #stats + few output lines for banner printing +
 	 * Number of Extra outputlines for future reference to add new stats.
@@ -66,12 +70,7 @@ static ssize_t nss_portid_stats_read(struct file *fp, char __user *ubuf, size_t
 	/*
 	 * PortID node stats
 	 */
-	spin_lock_bh(&nss_top_main.stats_lock);
-	for (i = 0; (i < NSS_PORTID_STATS_MAX); i++) {
-		stats_shadow[i] = nss_portid_stats[i];
-	}
-
-	spin_unlock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_copy(&nss_portid_stats_domain, stats_shadow, nss_portid_stats, sizeof(*stats_shadow) * NSS_PORTID_STATS_MAX);
 
 	size_wr += nss_stats_print("portid", NULL, NSS_STATS_SINGLE_INSTANCE
 					, nss_portid_stats_str
@@ -97,6 +96,11 @@ NSS_STATS_DECLARE_FILE_OPERATIONS(portid)
  */
 void nss_portid_stats_dentry_create(void)
 {
+	/*
+	 * The node sync handler updates the common node stats under the domain
+	 */
+	nss_stats_domain_own_node(&nss_portid_stats_domain, NSS_PORTID_INTERFACE);
+
 	nss_stats_create_dentry("portid", &nss_portid_stats_ops);
 }
 
@@ -114,7 +118,7 @@ void nss_portid_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss_portid_s
 		/*
 		 * Update PORTID base node stats.
 		 */
-		spin_lock_bh(&nss_top->stats_lock);
+		nss_stats_domain_write_begin(&nss_portid_stats_domain);
 		nss_top->stats_node[NSS_PORTID_INTERFACE][NSS_STATS_NODE_RX_PKTS] += npsm->node_stats.rx_packets;
 		nss_top->stats_node[NSS_PORTID_INTERFACE][NSS_STATS_NODE_RX_BYTES] += npsm->node_stats.rx_bytes;
 		nss_top->stats_node[NSS_PORTID_INTERFACE][NSS_STATS_NODE_TX_PKTS] += npsm->node_stats.tx_packets;
@@ -125,7 +129,7 @@ void nss_portid_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss_portid_s
 		}
 
 		nss_portid_stats[NSS_PORTID_STATS_RX_INVALID_HEADER] += npsm->rx_invalid_header;
-		spin_unlock_bh(&nss_top->stats_lock);
+		nss_stats_domain_write_end(&nss_portid_stats_domain);
 		return;
 	}
 
@@ -19,7 +19,73 @@
  *	NSS profiler APIs
  */
 
+#include <linux/kfifo.h>
 #include "nss_tx_rx_common.h"
+#include "nss_profiler_record.h"
+
+/*
+ * Sample collector
+ *	Keeps the profiler messages of all cores in a ring that is read from
+ * debugfs (qca-nss-drv/profiler), see nss_profiler_record.h for the format.
+ * Messages that do not fit are dropped and counted in the next record, so a
+ * reader that keeps up sees a complete stream.
+ */
+#define NSS_PROFILER_COLLECT_MAX_KB	16384
+
+static struct kfifo nss_profiler_fifo;
+static uint32_t nss_profiler_dropped;		/* Messages dropped since the last record */
+static DEFINE_SPINLOCK(nss_profiler_fifo_lock);	/* Serializes the cores writing to the fifo */
+static DEFINE_MUTEX(nss_profiler_read_lock);	/* Serializes readers and resizing */
+static DECLARE_WAIT_QUEUE_HEAD(nss_profiler_read_wq);
+static bool nss_profiler_handler_registered[NSS_MAX_CORES];
+
+/*
+ * nss_profiler_collect()
+ *	Append a profiler message to the collector fifo.
+ */
+static void nss_profiler_collect(struct nss_ctx_instance *nss_ctx, struct nss_cmn_msg *ncm)
+{
+	static const uint8_t pad[NSS_PROFILER_RECORD_ALIGN];
+	struct nss_profiler_record rec;
+	uint32_t len = ncm->len;
+	uint32_t padded = ALIGN(len, NSS_PROFILER_RECORD_ALIGN);
+
+	if (!nss_ctl_profiler_collect)
+		return;
+
+	if (ncm->type < NSS_PROFILER_FIXED_INFO_MSG || ncm->type > NSS_PROFILER_SAMPLES_MSG)
+		return;
+
+	if (len > NSS_NBUF_PAYLOAD_SIZE - sizeof(*ncm))
+		return;
+
+	spin_lock_bh(&nss_profiler_fifo_lock);
+	if (!kfifo_initialized(&nss_profiler_fifo)) {
+		spin_unlock_bh(&nss_profiler_fifo_lock);
+		return;
+	}
+
+	if (kfifo_avail(&nss_profiler_fifo) < sizeof(rec) + padded) {
+		nss_profiler_dropped++;
+		spin_unlock_bh(&nss_profiler_fifo_lock);
+		return;
+	}
+
+	rec.magic = NSS_PROFILER_RECORD_MAGIC;
+	rec.core = nss_ctx->id;
+	rec.type = ncm->type;
+	rec.len = len;
+	rec.dropped = nss_profiler_dropped;
+	rec.ts_ns = ktime_get_ns();
+	nss_profiler_dropped = 0;
+
+	kfifo_in(&nss_profiler_fifo, &rec, sizeof(rec));
+	kfifo_in(&nss_profiler_fifo, &((struct nss_profiler_msg *)ncm)->payload, len);
+	kfifo_in(&nss_profiler_fifo, pad, padded - len);
+	spin_unlock_bh(&nss_profiler_fifo_lock);
+
+	wake_up_interruptible(&nss_profiler_read_wq);
+}
 
 /*
  * nss_profiler_rx_msg_handler()
@@ -53,6 +119,8 @@ static void nss_profiler_rx_msg_handler(struct nss_ctx_instance *nss_ctx, struct
 		}
 	}
 
+	nss_profiler_collect(nss_ctx, ncm);
+
 	/*
 	 * status per request callback
 	 */
@@ -65,7 +133,8 @@ static void nss_profiler_rx_msg_handler(struct nss_ctx_instance *nss_ctx, struct
 	 * sample related callback
 	 */
 	if (!cb || !ctx) {
-		nss_warning("%px: Event received for profiler interface before registration", nss_ctx);
+		if (!nss_ctl_profiler_collect)
+			nss_warning("%px: Event received for profiler interface before registration", nss_ctx);
 		return;
 	}
 
@@ -209,6 +278,173 @@ struct nss_profile_sdma_ctrl *nss_profile_dma_get_ctrl(struct nss_ctx_instance *
 }
 EXPORT_SYMBOL(nss_profile_dma_get_ctrl);
 
+/*
+ * nss_profiler_handler_register()
+ *	Register the message handler of a core, shared by the client and the collector.
+ */
+static bool nss_profiler_handler_register(nss_core_id_t core_id)
+{
+	if (nss_profiler_handler_registered[core_id])
+		return true;
+
+	if (NSS_CORE_STATUS_SUCCESS !=
+		nss_core_register_handler(&nss_top_main.nss[core_id], NSS_PROFILER_INTERFACE, nss_profiler_rx_msg_handler, NULL)) {
+			return false;
+	}
+
+	nss_profiler_handler_registered[core_id] = true;
+	return true;
+}
+
+/*
+ * nss_profiler_handler_unregister()
+ *	Unregister the message handler of a core once neither the client nor the collector uses it.
+ */
+static void nss_profiler_handler_unregister(nss_core_id_t core_id)
+{
+	if (!nss_profiler_handler_registered[core_id] || nss_ctl_profiler_collect ||
+			nss_top_main.profiler_callback[core_id]) {
+		return;
+	}
+
+	nss_core_unregister_handler(&nss_top_main.nss[core_id], NSS_PROFILER_INTERFACE);
+	nss_profiler_handler_registered[core_id] = false;
+}
+
+/*
+ * nss_profiler_collect_read()
+ *	Read collected records, waiting for more while the collector is enabled.
+ */
+static ssize_t nss_profiler_collect_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos)
+{
+	unsigned int copied;
+	int ret;
+
+	for (;;) {
+		mutex_lock(&nss_profiler_read_lock);
+		if (kfifo_initialized(&nss_profiler_fifo) && !kfifo_is_empty(&nss_profiler_fifo))
+			break;
+
+		mutex_unlock(&nss_profiler_read_lock);
+		if (!nss_ctl_profiler_collect || (fp->f_flags & O_NONBLOCK))
+			return 0;
+
+		ret = wait_event_interruptible(nss_profiler_read_wq,
+				!nss_ctl_profiler_collect || !kfifo_is_empty(&nss_profiler_fifo));
+		if (ret)
+			return ret;
+	}
+
+	ret = kfifo_to_user(&nss_profiler_fifo, ubuf, sz, &copied);
+	mutex_unlock(&nss_profiler_read_lock);
+
+	return ret ? ret : copied;
+}
+
+static const struct file_operations nss_profiler_collect_ops = {
+	.owner = THIS_MODULE,
+	.open = simple_open,
+	.read = nss_profiler_collect_read,
+	.llseek = no_llseek,
+};
+
+/*
+ * nss_profiler_collect_handler()
+ *	Sysctl to size the collector fifo in KB; 0 stops collecting.
+ */
+int nss_profiler_collect_handler(struct ctl_table *ctl, int write, void __user *buffer, size_t *lenp, loff_t *ppos)
+{
+	struct kfifo fifo, old;
+	int kb = nss_ctl_profiler_collect;
+	int ret;
+	int i;
+
+	ret = proc_dointvec(ctl, write, buffer, lenp, ppos);
+	if (ret || !write)
+		return ret;
+
+	if (nss_ctl_profiler_collect < 0 || nss_ctl_profiler_collect > NSS_PROFILER_COLLECT_MAX_KB) {
+		nss_warning("Invalid profiler collector size %d KB (0 - %d)\n",
+				nss_ctl_profiler_collect, NSS_PROFILER_COLLECT_MAX_KB);
+		nss_ctl_profiler_collect = kb;
+		return -EINVAL;
+	}
+
+	memset(&fifo, 0, sizeof(fifo));
+	if (nss_ctl_profiler_collect && kfifo_alloc(&fifo, nss_ctl_profiler_collect * 1024, GFP_KERNEL)) {
+		nss_warning("Failed to allocate %d KB for the profiler collector\n", nss_ctl_profiler_collect);
+		nss_ctl_profiler_collect = kb;
+		return -ENOMEM;
+	}
+
+	mutex_lock(&nss_profiler_read_lock);
+	spin_lock_bh(&nss_profiler_fifo_lock);
+	old = nss_profiler_fifo;
+	nss_profiler_fifo = fifo;
+	nss_profiler_dropped = 0;
+	spin_unlock_bh(&nss_profiler_fifo_lock);
+	mutex_unlock(&nss_profiler_read_lock);
+
+	if (kfifo_initialized(&old))
+		kfifo_free(&old);
+
+	for (i = 0; i < nss_top_main.num_nss; i++) {
+		if (!nss_ctl_profiler_collect) {
+			nss_profiler_handler_unregister(i);
+			continue;
+		}
+
+		if (!nss_profiler_handler_register(i))
+			nss_warning("%d: profiler message handler is owned by another module\n", i);
+	}
+
+	/*
+	 * Let readers blocked on an empty fifo see the end of the stream.
+	 */
+	wake_up_interruptible(&nss_profiler_read_wq);
+	return 0;
+}
+
+/*
+ * nss_profiler_collect_init()
+ *	Create the debugfs file of the collector.
+ */
+void nss_profiler_collect_init(void)
+{
+	BUILD_BUG_ON(NSS_PROFILER_RECORD_FIXED_INFO != NSS_PROFILER_FIXED_INFO_MSG);
+	BUILD_BUG_ON(NSS_PROFILER_RECORD_COUNTERS != NSS_PROFILER_COUNTERS_MSG);
+	BUILD_BUG_ON(NSS_PROFILER_RECORD_SAMPLES != NSS_PROFILER_SAMPLES_MSG);
+
+	if (!debugfs_create_file("profiler", 0400, nss_top_main.top_dentry, NULL, &nss_profiler_collect_ops))
+		nss_warning("Failed to create qca-nss-drv/profiler file in debugfs");
+}
+
+/*
+ * nss_profiler_collect_exit()
+ *	Stop collecting and free the fifo.
+ */
+void nss_profiler_collect_exit(void)
+{
+	struct kfifo fifo;
+	int i;
+
+	nss_ctl_profiler_collect = 0;
+	for (i = 0; i < nss_top_main.num_nss; i++)
+		nss_profiler_handler_unregister(i);
+
+	wake_up_interruptible(&nss_profiler_read_wq);
+
+	mutex_lock(&nss_profiler_read_lock);
+	spin_lock_bh(&nss_profiler_fifo_lock);
+	fifo = nss_profiler_fifo;
+	memset(&nss_profiler_fifo, 0, sizeof(nss_profiler_fifo));
+	spin_unlock_bh(&nss_profiler_fifo_lock);
+	mutex_unlock(&nss_profiler_read_lock);
+
+	if (kfifo_initialized(&fifo))
+		kfifo_free(&fifo);
+}
+
 /*
  * nss_profiler_notify_register()
  */
@@ -216,10 +452,9 @@ void *nss_profiler_notify_register(nss_core_id_t core_id, nss_profiler_callback_
 {
 	nss_assert(core_id < NSS_CORE_MAX);
 
-	if (NSS_CORE_STATUS_SUCCESS !=
-		nss_core_register_handler(&nss_top_main.nss[core_id], NSS_PROFILER_INTERFACE, nss_profiler_rx_msg_handler, NULL)) {
-			nss_warning("Message handler FAILED to be registered for profiler");
-			return NULL;
+	if (!nss_profiler_handler_register(core_id)) {
+		nss_warning("Message handler FAILED to be registered for profiler");
+		return NULL;
 	}
 
 	nss_top_main.profiler_ctx[core_id] = ctx;
@@ -236,9 +471,9 @@ void nss_profiler_notify_unregister(nss_core_id_t core_id)
 {
 	nss_assert(core_id < NSS_CORE_MAX);
 
-	nss_core_unregister_handler(&nss_top_main.nss[core_id], NSS_PROFILER_INTERFACE);
 	nss_top_main.profiler_callback[core_id] = NULL;
 	nss_top_main.profiler_ctx[core_id] = NULL;
+	nss_profiler_handler_unregister(core_id);
 }
 EXPORT_SYMBOL(nss_profiler_notify_unregister);
 
@@ -0,0 +1,62 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2020, The Linux Foundation. All rights reserved.
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/*
+ * nss_profiler_record.h
+ *	Record format of the profiler sample collector.
+ *
+ * The collector in nss_profiler.c writes every profiler message it receives
+ * to qca-nss-drv/profiler in debugfs as a struct nss_profiler_record followed
+ * by the message payload, padded to NSS_PROFILER_RECORD_ALIGN bytes. Records
+ * are in host byte order; the payload is as sent by the firmware.
+ *
+ * The header is shared with the host tools that decode a capture, so it
+ * can also be built outside the kernel.
+ */
+
+#ifndef __NSS_PROFILER_RECORD_H
+#define __NSS_PROFILER_RECORD_H
+
+#ifdef __KERNEL__
+#include <linux/types.h>
+#else
+#include <stdint.h>
+#endif
+
+#define NSS_PROFILER_RECORD_MAGIC	0x4e505246	/* "NPRF" */
+#define NSS_PROFILER_RECORD_ALIGN	8
+
+/*
+ * Message types kept by the collector, same values as
+ * enum nss_profiler_message_types.
+ */
+#define NSS_PROFILER_RECORD_FIXED_INFO	8		/* NSS_PROFILER_FIXED_INFO_MSG */
+#define NSS_PROFILER_RECORD_COUNTERS	9		/* NSS_PROFILER_COUNTERS_MSG */
+#define NSS_PROFILER_RECORD_SAMPLES	10		/* NSS_PROFILER_SAMPLES_MSG */
+
+/*
+ * Record header
+ */
+struct nss_profiler_record {
+	uint32_t magic;			/* NSS_PROFILER_RECORD_MAGIC */
+	uint16_t core;			/* NSS core the message came from */
+	uint16_t type;			/* NSS_PROFILER_RECORD_* */
+	uint32_t len;			/* Payload length, without padding */
+	uint32_t dropped;		/* Messages dropped since the previous record */
+	uint64_t ts_ns;			/* Host time the message was received */
+};
+
+#endif /* __NSS_PROFILER_RECORD_H */
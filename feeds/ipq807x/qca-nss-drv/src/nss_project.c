@@ -58,7 +58,7 @@ static struct nss_worker_thread_stats *nss_project_alloc_wt_stats(uint32_t threa
 		wt_stats[i].irq_stats =
 			kzalloc(irq_count * sizeof(struct nss_project_irq_stats), GFP_ATOMIC);
 		if (unlikely(!wt_stats[i].irq_stats)) {
-			nss_project_free_wt_stats(wt_stats, i);
+			nss_project_free_wt_stats(wt_stats, i + 1);
 			return NULL;
 		}
 	}
@@ -97,11 +97,11 @@ static void nss_project_wt_stats_enable_callback(void *app_data, struct nss_proj
 		return;
 	}
 
-	spin_lock_bh(&nss_ctx->nss_top->stats_lock);
+	nss_stats_domain_write_begin(&nss_wt_stats_domain);
 	nss_ctx->wt_stats = stats_temp;
 	nss_ctx->worker_thread_count = stats_enable->worker_thread_count;
 	nss_ctx->irq_count = stats_enable->irq_count;
-	spin_unlock_bh(&nss_ctx->nss_top->stats_lock);
+	nss_stats_domain_write_end(&nss_wt_stats_domain);
 }
 
 /*
@@ -170,7 +170,7 @@ static void nss_project_wt_stats_update(struct nss_ctx_instance *nss_ctx,
 		return;
 	}
 
-	spin_lock_bh(&nss_ctx->nss_top->stats_lock);
+	nss_stats_domain_write_begin(&nss_wt_stats_domain);
 	for (i = 0; i < stats_notify->stats_written; ++i) {
 		int irq = stats_notify->stats[i].irq;
 		if (unlikely(irq >= nss_ctx->irq_count)) {
@@ -180,7 +180,7 @@ static void nss_project_wt_stats_update(struct nss_ctx_instance *nss_ctx,
 
 		wt_stats->irq_stats[irq] = stats_notify->stats[i];
 	}
-	spin_unlock_bh(&nss_ctx->nss_top->stats_lock);
+	nss_stats_domain_write_end(&nss_wt_stats_domain);
 }
 
 /*
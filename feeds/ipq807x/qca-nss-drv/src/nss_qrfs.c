@@ -14,9 +14,12 @@
  **************************************************************************
  */
 
+#include <linux/hashtable.h>
 #include "nss_tx_rx_common.h"
 #include "nss_qrfs_stats.h"
 #include "nss_qrfs_log.h"
+#include "nss_qrfs_rule.h"
+#include "nss_qrfs_steer.h"
 
 /*
  * Notify data structure
@@ -28,6 +31,59 @@ struct nss_qrfs_notify_data {
 
 static struct nss_qrfs_notify_data nss_qrfs_notify[NSS_CORE_MAX];
 
+#define NSS_QRFS_RULE_HASH_BITS		10
+#define NSS_QRFS_RULE_BATCH_WINDOW_MS	1	/* Time rules wait for company */
+
+/*
+ * Flow rule programmed in the NSS
+ */
+struct nss_qrfs_rule {
+	struct hlist_node node;			/* Hash table node */
+	struct nss_qrfs_flow_rule_msg rule;	/* Rule as sent to the NSS */
+	uint32_t hash;				/* Hash of the 5-tuple */
+	unsigned long last_active;		/* Last time the flow was seen or the rule refreshed */
+};
+
+/*
+ * Multi-rule message sent to one core, kept to resend its rules one by one
+ */
+struct nss_qrfs_rule_many {
+	struct nss_ctx_instance *nss_ctx;	/* Core the message went to */
+	uint32_t action;			/* NSS_QRFS_MSG_FLOW_ADD or NSS_QRFS_MSG_FLOW_DELETE */
+	uint16_t count;				/* Rules in the message */
+	struct nss_qrfs_flow_rule_msg rule[];	/* Copy of the rules */
+};
+
+/*
+ * Rule messages waiting to be sent
+ */
+struct nss_qrfs_rule_batch {
+	struct nss_qrfs_msg *nqm;		/* Message being filled */
+	uint32_t action;			/* NSS_QRFS_MSG_FLOW_ADD or NSS_QRFS_MSG_FLOW_DELETE */
+	uint16_t count;				/* Rules in the message */
+	uint16_t max;				/* Rules that fit in the message */
+	struct delayed_work dwork;		/* Sends a partial batch */
+};
+
+static DEFINE_HASHTABLE(nss_qrfs_rule_table, NSS_QRFS_RULE_HASH_BITS);
+static DEFINE_SPINLOCK(nss_qrfs_rule_lock);
+static struct nss_qrfs_rule_batch nss_qrfs_rule_batch;
+int nss_qrfs_rule_count;
+
+/*
+ * Aging is off by default. The NSS does not report per-flow activity, only
+ * aggregate rule hits, so a rule is only seen active when it is added again
+ * or when a packet of its flow is sampled on the host path. Flows that stay
+ * offloaded would otherwise lose their rule while busy.
+ */
+int nss_qrfs_rule_idle_sec __read_mostly;
+int nss_qrfs_rule_max __read_mostly = 4096;
+int nss_qrfs_rule_batch_enable __read_mostly;	/* Firmware takes the multi-rule messages */
+static int nss_qrfs_rule_zero;
+static int nss_qrfs_rule_one = 1;
+
+static void nss_qrfs_rule_age(void);
+
 /*
  * nss_qrfs_verify_if_num()
  *	Verify if_num passed to us.
@@ -37,6 +93,42 @@ static bool nss_qrfs_verify_if_num(uint32_t if_num)
 	return if_num == NSS_QRFS_INTERFACE;
 }
 
+/*
+ * nss_qrfs_rule_find()
+ *	Look up a programmed rule; called with the rule lock held.
+ */
+static struct nss_qrfs_rule *nss_qrfs_rule_find(struct nss_qrfs_flow_rule_msg *rule, uint32_t hash)
+{
+	struct nss_qrfs_rule *r;
+
+	hash_for_each_possible(nss_qrfs_rule_table, r, node, hash) {
+		if ((r->hash == hash) && nss_qrfs_rule_match(&r->rule, rule)) {
+			return r;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * nss_qrfs_rule_forget()
+ *	Drop a rule that did not reach the NSS; called with the rule lock held.
+ *
+ * A rule moved to another CPU since is left alone.
+ */
+static void nss_qrfs_rule_forget(struct nss_qrfs_flow_rule_msg *rule)
+{
+	struct nss_qrfs_rule *r = nss_qrfs_rule_find(rule, nss_qrfs_rule_hash(rule));
+
+	if (!r || (r->rule.cpu != rule->cpu)) {
+		return;
+	}
+
+	hash_del(&r->node);
+	kfree(r);
+	nss_qrfs_rule_count--;
+}
+
 /*
  * nss_qrfs_msg_handler()
  *	Handle NSS -> HLOS messages for QRFS
@@ -80,6 +172,13 @@ static void nss_qrfs_msg_handler(struct nss_ctx_instance *nss_ctx, struct nss_cm
 		 * Update QRFS statistics.
 		 */
 		nss_qrfs_stats_sync(nss_ctx, &nqm->msg.stats_sync);
+
+		/*
+		 * Rules are shared by all cores; let one core's sync drive aging.
+		 */
+		if (nss_ctx->id == NSS_CORE_0) {
+			nss_qrfs_rule_age();
+		}
 		break;
 	}
 
@@ -211,6 +310,13 @@ static void nss_qrfs_flow_add_msg_callback(void *app_data, struct nss_qrfs_msg *
 	if (nqm->cm.response != NSS_CMN_RESPONSE_ACK) {
 		nss_warning("%px: flow add configuration error: %d for NSS core %d\n",
 				nss_ctx, nqm->cm.error, nss_ctx->id);
+
+		/*
+		 * The rule is not programmed; forget it so that the next add sends it again.
+		 */
+		spin_lock_bh(&nss_qrfs_rule_lock);
+		nss_qrfs_rule_forget(nqfrm);
+		spin_unlock_bh(&nss_qrfs_rule_lock);
 	}
 }
 
@@ -251,10 +357,10 @@ static void nss_qrfs_msg_init(struct nss_qrfs_msg *nqm, uint16_t if_num, uint32_
 }
 
 /*
- * nss_qrfs_tx_msg()
- *	Transmit a QRFS message to NSS firmware
+ * nss_qrfs_tx_msg_len()
+ *	Transmit a QRFS message of len bytes to NSS firmware
  */
-static nss_tx_status_t nss_qrfs_tx_msg(struct nss_ctx_instance *nss_ctx, struct nss_qrfs_msg *msg)
+static nss_tx_status_t nss_qrfs_tx_msg_len(struct nss_ctx_instance *nss_ctx, struct nss_qrfs_msg *msg, size_t len)
 {
 	struct nss_cmn_msg *ncm = &msg->cm;
 
@@ -276,144 +382,409 @@ static nss_tx_status_t nss_qrfs_tx_msg(struct nss_ctx_instance *nss_ctx, struct
 		return NSS_TX_FAILURE;
 	}
 
-	return nss_core_send_cmd(nss_ctx, msg, sizeof(*msg), NSS_NBUF_PAYLOAD_SIZE);
+	return nss_core_send_cmd(nss_ctx, msg, len, max_t(size_t, len, NSS_NBUF_PAYLOAD_SIZE));
 }
 
 /*
- * nss_qrfs_add_flow_rule()
- *	Set a QRFS flow rule add message and transmit the message to NSS core.
+ * nss_qrfs_tx_flow_rule()
+ *	Transmit a prepared QRFS flow rule add or delete message to a NSS core.
  */
-static nss_tx_status_t nss_qrfs_add_flow_rule(struct nss_ctx_instance *nss_ctx, uint32_t if_num,
-					struct sk_buff *skb, uint32_t cpu, bool need_cb)
+static nss_tx_status_t nss_qrfs_tx_flow_rule(struct nss_ctx_instance *nss_ctx, struct nss_qrfs_flow_rule_msg *rule,
+						uint32_t action)
 {
 	struct nss_qrfs_msg nqm;
-	struct nss_qrfs_flow_rule_msg *nqfrm;
-	nss_tx_status_t status;
-	nss_qrfs_msg_callback_t cb = NULL;
-	void *app_data = NULL;
-	bool res;
+	nss_qrfs_msg_callback_t cb = nss_qrfs_flow_add_msg_callback;
 
 	memset(&nqm, 0, sizeof(struct nss_qrfs_msg));
 
-	if (need_cb) {
-		cb = nss_qrfs_flow_add_msg_callback;
-		app_data = (void *)nss_ctx;
+	if (action != NSS_QRFS_MSG_FLOW_ADD) {
+		action = NSS_QRFS_MSG_FLOW_DELETE;
+		cb = nss_qrfs_flow_delete_msg_callback;
 	}
 
-	/*
-	 * Initialize common header of QRFS flow rule add message.
-	 */
-	nss_qrfs_msg_init(&nqm, NSS_QRFS_INTERFACE, NSS_QRFS_MSG_FLOW_ADD,
-				sizeof(struct nss_qrfs_flow_rule_msg), cb, app_data);
+	nss_qrfs_msg_init(&nqm, NSS_QRFS_INTERFACE, action,
+				sizeof(struct nss_qrfs_flow_rule_msg), cb, (void *)nss_ctx);
 
 	/*
-	 * Set flow rule of QRFS flow rule add message
+	 * flow_add and flow_delete share the same layout.
 	 */
-	nqfrm = &nqm.msg.flow_add;
-	res = nss_qrfs_get_flow_keys(nss_ctx, skb, nqfrm);
-	if (!res) {
-		return NSS_TX_FAILURE;
+	nqm.msg.flow_add = *rule;
+
+	return nss_qrfs_tx_msg_len(nss_ctx, &nqm, sizeof(struct nss_qrfs_msg));
+}
+
+/*
+ * nss_qrfs_rule_send_each()
+ *	Send rules to a core one message each; called with the rule lock held.
+ *
+ * Adds that cannot be sent are forgotten, so the next add sends them again.
+ */
+static void nss_qrfs_rule_send_each(struct nss_ctx_instance *nss_ctx, struct nss_qrfs_flow_rule_msg *rule,
+					uint16_t count, uint32_t action)
+{
+	uint16_t i;
+
+	for (i = 0; i < count; i++) {
+		if (nss_qrfs_tx_flow_rule(nss_ctx, &rule[i], action) == NSS_TX_SUCCESS) {
+			continue;
+		}
+
+		nss_warning("%px: failed to send flow rule to NSS core %d\n", nss_ctx, nss_ctx->id);
+		if (action == NSS_QRFS_MSG_FLOW_ADD) {
+			nss_qrfs_rule_forget(&rule[i]);
+		}
 	}
+}
 
-	nqfrm->cpu = (uint16_t)cpu;
-	nqfrm->if_num = if_num;
+/*
+ * nss_qrfs_flow_many_msg_callback()
+ *	Callback function for receiving multiple flow rule response messages.
+ *
+ * Firmware without the multi-rule messages rejects them. Batching is then
+ * turned off and the rules still current in the table are resent one by one.
+ */
+static void nss_qrfs_flow_many_msg_callback(void *app_data, struct nss_qrfs_msg *nqm)
+{
+	struct nss_qrfs_rule_many *many = (struct nss_qrfs_rule_many *)app_data;
+	struct nss_ctx_instance *nss_ctx = many->nss_ctx;
+	struct nss_qrfs_rule *r;
+	uint16_t i;
 
-	/*
-	 * Send QRFS flow rule add message to NSS core
-	 */
-	status = nss_qrfs_tx_msg(nss_ctx, &nqm);
-	if (status == NSS_TX_SUCCESS) {
-		return status;
+	if ((nqm->cm.type != NSS_QRFS_MSG_FLOW_ADD_MANY) && (nqm->cm.type != NSS_QRFS_MSG_FLOW_DELETE_MANY)) {
+		nss_warning("%px: invalid flow response message %d\n", nss_ctx, nqm->cm.type);
+		kfree(many);
+		return;
 	}
 
-	return NSS_TX_FAILURE;
+	if (nqm->cm.response == NSS_CMN_RESPONSE_ACK) {
+		kfree(many);
+		return;
+	}
+
+	nss_warning("%px: flow %s many configuration error: %d for NSS core %d, sending rules one by one\n", nss_ctx,
+			many->action == NSS_QRFS_MSG_FLOW_ADD ? "add" : "delete", nqm->cm.error, nss_ctx->id);
+	WRITE_ONCE(nss_qrfs_rule_batch_enable, 0);
+
+	spin_lock_bh(&nss_qrfs_rule_lock);
+	for (i = 0; i < many->count; i++) {
+		/*
+		 * Skip rules changed since the batch went out; their newer
+		 * message already reached the core.
+		 */
+		r = nss_qrfs_rule_find(&many->rule[i], nss_qrfs_rule_hash(&many->rule[i]));
+		if (many->action == NSS_QRFS_MSG_FLOW_ADD) {
+			if (!r || (r->rule.cpu != many->rule[i].cpu)) {
+				continue;
+			}
+		} else if (r) {
+			continue;
+		}
+
+		nss_qrfs_rule_send_each(nss_ctx, &many->rule[i], 1, many->action);
+	}
+	spin_unlock_bh(&nss_qrfs_rule_lock);
+
+	kfree(many);
 }
 
 /*
- * nss_qrfs_delete_flow_rule()
- *	Set a QRFS delete flow rule message and transmit the message to all NSS core.
+ * nss_qrfs_rule_batch_flush()
+ *	Send the pending rules to all NSS cores.
+ *
+ * Called with the rule lock held so batches reach the NSS in order. A single
+ * rule goes out as a plain add or delete message.
  */
-static nss_tx_status_t nss_qrfs_delete_flow_rule(struct nss_ctx_instance *nss_ctx, uint32_t if_num,
-						struct sk_buff *skb, uint32_t cpu, bool need_cb)
+static void nss_qrfs_rule_batch_flush(void)
 {
-	struct nss_qrfs_msg nqm;
-	struct nss_qrfs_flow_rule_msg *nqfrm;
-	nss_tx_status_t status;
-	nss_qrfs_msg_callback_t cb = NULL;
-	void *app_data = NULL;
-	bool res;
+	struct nss_qrfs_msg *nqm = nss_qrfs_rule_batch.nqm;
+	struct nss_qrfs_flow_rule_msg *rule;
+	struct nss_qrfs_rule_many *many;
+	struct nss_ctx_instance *nss_ctx;
+	uint16_t count = nss_qrfs_rule_batch.count;
+	uint32_t action = nss_qrfs_rule_batch.action;
+	uint32_t type;
+	size_t size;
+	int i;
 
-	memset(&nqm, 0, sizeof(struct nss_qrfs_msg));
+	if (!count) {
+		return;
+	}
 
-	if (need_cb) {
-		cb = nss_qrfs_flow_delete_msg_callback;
-		app_data = (void *)nss_ctx;
+	nss_qrfs_rule_batch.count = 0;
+	rule = nqm->msg.flow_add_many.rule;
+
+	type = (action == NSS_QRFS_MSG_FLOW_ADD) ? NSS_QRFS_MSG_FLOW_ADD_MANY : NSS_QRFS_MSG_FLOW_DELETE_MANY;
+	size = offsetof(struct nss_qrfs_msg, msg.flow_add_many.rule) + count * sizeof(struct nss_qrfs_flow_rule_msg);
+	nss_qrfs_msg_init(nqm, NSS_QRFS_INTERFACE, type, sizeof(struct nss_qrfs_flow_rule_many_msg),
+				nss_qrfs_flow_many_msg_callback, NULL);
+	nqm->msg.flow_add_many.count = count;
+	nqm->msg.flow_add_many.size = size;
+
+	for (i = 0; i < NSS_CORE_MAX; i++) {
+		nss_ctx = nss_qrfs_get_ctx(i);
+
+		if (count == 1) {
+			nss_qrfs_rule_send_each(nss_ctx, rule, 1, action);
+			continue;
+		}
+
+		/*
+		 * Keep the rules until the core answers, to resend them if it
+		 * does not take multi-rule messages.
+		 */
+		many = kmalloc(sizeof(*many) + count * sizeof(*rule), GFP_ATOMIC);
+		if (!many) {
+			nss_qrfs_rule_send_each(nss_ctx, rule, count, action);
+			continue;
+		}
+
+		many->nss_ctx = nss_ctx;
+		many->action = action;
+		many->count = count;
+		memcpy(many->rule, rule, count * sizeof(*rule));
+		nqm->cm.app_data = (nss_ptr_t)many;
+
+		if (nss_qrfs_tx_msg_len(nss_ctx, nqm, size) != NSS_TX_SUCCESS) {
+			nss_warning("%px: failed to send %d flow rules to NSS core %d\n", nss_ctx, count, i);
+			kfree(many);
+			nss_qrfs_rule_send_each(nss_ctx, rule, count, action);
+		}
 	}
+}
 
-	/*
-	 * Initialize common header of QRFS flow rule delete message.
-	 */
-	nss_qrfs_msg_init(&nqm, NSS_QRFS_INTERFACE, NSS_QRFS_MSG_FLOW_DELETE,
-				sizeof(struct nss_qrfs_flow_rule_msg), cb, app_data);
+/*
+ * nss_qrfs_rule_batch_work()
+ *	Send whatever was batched during the window.
+ */
+static void nss_qrfs_rule_batch_work(struct work_struct *work)
+{
+	spin_lock_bh(&nss_qrfs_rule_lock);
+	nss_qrfs_rule_batch_flush();
+	spin_unlock_bh(&nss_qrfs_rule_lock);
+}
+
+/*
+ * nss_qrfs_rule_batch_add()
+ *	Queue one rule message; called with the rule lock held.
+ */
+static void nss_qrfs_rule_batch_add(struct nss_qrfs_flow_rule_msg *rule, uint32_t action)
+{
+	struct nss_qrfs_msg *nqm = nss_qrfs_rule_batch.nqm;
 
 	/*
-	 * Set flow rule of QRFS flow rule delete message
+	 * A batch carries a single kind of message.
 	 */
-	nqfrm = &nqm.msg.flow_delete;
-	res = nss_qrfs_get_flow_keys(nss_ctx, skb, nqfrm);
-	if (!res) {
-		return NSS_TX_FAILURE;
+	if (nss_qrfs_rule_batch.count && (nss_qrfs_rule_batch.action != action)) {
+		nss_qrfs_rule_batch_flush();
 	}
 
-	nqfrm->cpu = (uint16_t)cpu;
-	nqfrm->if_num = if_num;
+	nss_qrfs_rule_batch.action = action;
+	nqm->msg.flow_add_many.rule[nss_qrfs_rule_batch.count++] = *rule;
 
-	/*
-	 * Send QRFS flow rule delete message to NSS core
-	 */
-	status = nss_qrfs_tx_msg(nss_ctx, &nqm);
-	if (status == NSS_TX_SUCCESS) {
-		return status;
+	if (nss_qrfs_rule_batch.count == nss_qrfs_rule_batch.max) {
+		nss_qrfs_rule_batch_flush();
+		return;
 	}
 
-	return NSS_TX_FAILURE;
+	if (nss_qrfs_rule_batch.count == 1) {
+		schedule_delayed_work(&nss_qrfs_rule_batch.dwork, msecs_to_jiffies(NSS_QRFS_RULE_BATCH_WINDOW_MS));
+	}
 }
 
 /*
- * nss_qrfs_set_flow_rule()
- *	Set a QRFS flow rule message and transmit the message to all NSS cores.
+ * nss_qrfs_rule_queue()
+ *	Send a rule change to all NSS cores; called with the rule lock held.
+ *
+ * Changes are batched only while the firmware is known to take multi-rule
+ * messages, and are then reported as sent.
  */
-nss_tx_status_t nss_qrfs_set_flow_rule(struct sk_buff *skb, uint32_t cpu, uint32_t action)
+static nss_tx_status_t nss_qrfs_rule_queue(struct nss_qrfs_flow_rule_msg *rule, uint32_t action)
 {
 	struct nss_ctx_instance *nss_ctx;
-	nss_tx_status_t status;
 	int i;
 
+	if (READ_ONCE(nss_qrfs_rule_batch_enable) && nss_qrfs_rule_batch.nqm) {
+		nss_qrfs_rule_batch_add(rule, action);
+		return NSS_TX_SUCCESS;
+	}
+
+	/*
+	 * Rules batched before batching was turned off go first.
+	 */
+	nss_qrfs_rule_batch_flush();
+
 	for (i = 0; i < NSS_CORE_MAX; i++) {
 		nss_ctx = nss_qrfs_get_ctx(i);
 
+		if (nss_qrfs_tx_flow_rule(nss_ctx, rule, action) != NSS_TX_SUCCESS) {
+			nss_warning("%px: failed to send flow rule to NSS core %d\n", nss_ctx, i);
+			return NSS_TX_FAILURE;
+		}
+	}
+
+	return NSS_TX_SUCCESS;
+}
+
+/*
+ * nss_qrfs_rule_set()
+ *	Record a rule add or delete and queue it for the NSS.
+ */
+static nss_tx_status_t nss_qrfs_rule_set(struct nss_qrfs_flow_rule_msg *rule, uint32_t action)
+{
+	uint32_t hash = nss_qrfs_rule_hash(rule);
+	nss_tx_status_t status = NSS_TX_SUCCESS;
+	struct nss_qrfs_rule *r;
+
+	spin_lock_bh(&nss_qrfs_rule_lock);
+	r = nss_qrfs_rule_find(rule, hash);
+
+	if (action != NSS_QRFS_MSG_FLOW_ADD) {
 		/*
-		 * Set QRFS flow rule message and transmit the message to NSS core.
-		 *
-		 * TODO: Remove if_num parameter from add_flow_rule() and
-		 * delete_flow_rule(), since it is unused in firmware.
+		 * Nothing to do if the rule already aged out.
 		 */
-		if (action == NSS_QRFS_MSG_FLOW_ADD) {
-			status = nss_qrfs_add_flow_rule(nss_ctx, 0, skb, cpu, true);
-		} else {
-			status = nss_qrfs_delete_flow_rule(nss_ctx, 0, skb, cpu, true);
+		if (r) {
+			hash_del(&r->node);
+			kfree(r);
+			nss_qrfs_rule_count--;
+			status = nss_qrfs_rule_queue(rule, NSS_QRFS_MSG_FLOW_DELETE);
 		}
 
-		if (status != NSS_TX_SUCCESS) {
-			nss_warning("%px: failed to send flow rule to NSS core %d\n", nss_ctx, i);
-			return NSS_TX_FAILURE;
+		spin_unlock_bh(&nss_qrfs_rule_lock);
+		return status;
+	}
+
+	if (r) {
+		r->last_active = jiffies;
+		if (r->rule.cpu != rule->cpu) {
+			r->rule.cpu = rule->cpu;
+			status = nss_qrfs_rule_queue(rule, NSS_QRFS_MSG_FLOW_ADD);
+			if (status != NSS_TX_SUCCESS) {
+				nss_qrfs_rule_forget(rule);
+			}
 		}
+
+		spin_unlock_bh(&nss_qrfs_rule_lock);
+		return status;
 	}
 
-	return NSS_TX_SUCCESS;
+	if (nss_qrfs_rule_count >= nss_qrfs_rule_max) {
+		spin_unlock_bh(&nss_qrfs_rule_lock);
+		nss_warning("qrfs rule table full: %d rules\n", nss_qrfs_rule_count);
+		return NSS_TX_FAILURE;
+	}
+
+	r = kmalloc(sizeof(*r), GFP_ATOMIC);
+	if (!r) {
+		spin_unlock_bh(&nss_qrfs_rule_lock);
+		return NSS_TX_FAILURE;
+	}
+
+	r->rule = *rule;
+	r->hash = hash;
+	r->last_active = jiffies;
+	hash_add(nss_qrfs_rule_table, &r->node, hash);
+	nss_qrfs_rule_count++;
+	status = nss_qrfs_rule_queue(rule, NSS_QRFS_MSG_FLOW_ADD);
+	if (status != NSS_TX_SUCCESS) {
+		nss_qrfs_rule_forget(rule);
+	}
+
+	spin_unlock_bh(&nss_qrfs_rule_lock);
+	return status;
+}
+
+/*
+ * nss_qrfs_rule_touch()
+ *	Mark a programmed rule as active after seeing a packet of its flow.
+ */
+void nss_qrfs_rule_touch(struct nss_qrfs_flow_rule_msg *rule, uint32_t hash)
+{
+	struct nss_qrfs_rule *r;
+
+	spin_lock(&nss_qrfs_rule_lock);
+	r = nss_qrfs_rule_find(rule, hash);
+	if (r) {
+		r->last_active = jiffies;
+	}
+	spin_unlock(&nss_qrfs_rule_lock);
+}
+
+/*
+ * nss_qrfs_rule_age()
+ *	Delete rules that have been idle for longer than the idle timeout.
+ */
+static void nss_qrfs_rule_age(void)
+{
+	unsigned long timeout = (unsigned long)nss_qrfs_rule_idle_sec * HZ;
+	unsigned long now = jiffies;
+	struct nss_qrfs_rule *r;
+	struct hlist_node *tmp;
+	uint32_t aged = 0;
+	int bkt;
+
+	if (!timeout || !READ_ONCE(nss_qrfs_rule_count)) {
+		return;
+	}
+
+	spin_lock_bh(&nss_qrfs_rule_lock);
+
+	/*
+	 * A failed add batch forgets its rules; send it before walking the
+	 * table so only deletes are batched during the walk.
+	 */
+	nss_qrfs_rule_batch_flush();
+
+	hash_for_each_safe(nss_qrfs_rule_table, bkt, tmp, r, node) {
+		if (time_before(now, r->last_active + timeout)) {
+			continue;
+		}
+
+		nss_qrfs_rule_queue(&r->rule, NSS_QRFS_MSG_FLOW_DELETE);
+		hash_del(&r->node);
+		kfree(r);
+		nss_qrfs_rule_count--;
+		aged++;
+	}
+	nss_qrfs_rule_batch_flush();
+	spin_unlock_bh(&nss_qrfs_rule_lock);
+
+	if (aged) {
+		nss_info("qrfs aged out %u idle rules, %d left\n", aged, nss_qrfs_rule_count);
+	}
+}
+
+/*
+ * nss_qrfs_set_flow_rule()
+ *	Set a QRFS flow rule message and transmit the message to all NSS cores.
+ */
+nss_tx_status_t nss_qrfs_set_flow_rule(struct sk_buff *skb, uint32_t cpu, uint32_t action)
+{
+	struct nss_qrfs_flow_rule_msg rule;
+
+	memset(&rule, 0, sizeof(rule));
+
+	/*
+	 * TODO: Remove if_num from the flow rule, since it is unused in firmware.
+	 */
+	if (!nss_qrfs_get_flow_keys(nss_qrfs_get_ctx(NSS_CORE_0), skb, &rule)) {
+		return NSS_TX_FAILURE;
+	}
+
+	rule.cpu = (uint16_t)cpu;
+	return nss_qrfs_rule_set(&rule, action);
 }
 EXPORT_SYMBOL(nss_qrfs_set_flow_rule);
 
+/*
+ * nss_qrfs_set_flow_rule_msg()
+ *	Transmit a prepared QRFS flow rule message to all NSS cores.
+ */
+nss_tx_status_t nss_qrfs_set_flow_rule_msg(struct nss_qrfs_flow_rule_msg *rule, uint32_t action)
+{
+	return nss_qrfs_rule_set(rule, action);
+}
+EXPORT_SYMBOL(nss_qrfs_set_flow_rule_msg);
+
 /*
  * nss_qrfs_register_handler()
  */
@@ -459,6 +830,71 @@ void nss_qrfs_notify_unregister(int core)
 	nss_qrfs_notify[core].app_data = NULL;
 }
 
+static struct ctl_table nss_qrfs_table[] = {
+	{
+		.procname	= "rule_idle_sec",
+		.data		= &nss_qrfs_rule_idle_sec,
+		.maxlen		= sizeof(int),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_minmax,
+		.extra1		= &nss_qrfs_rule_zero,
+	},
+	{
+		.procname	= "rule_max",
+		.data		= &nss_qrfs_rule_max,
+		.maxlen		= sizeof(int),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_minmax,
+		.extra1		= &nss_qrfs_rule_zero,
+	},
+	{
+		.procname	= "rule_batch",
+		.data		= &nss_qrfs_rule_batch_enable,
+		.maxlen		= sizeof(int),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_minmax,
+		.extra1		= &nss_qrfs_rule_zero,
+		.extra2		= &nss_qrfs_rule_one,
+	},
+	{
+		.procname	= "rule_count",
+		.data		= &nss_qrfs_rule_count,
+		.maxlen		= sizeof(int),
+		.mode		= 0444,
+		.proc_handler	= proc_dointvec,
+	},
+	{ }
+};
+
+static struct ctl_table nss_qrfs_dir[] = {
+	{
+		.procname		= "qrfs",
+		.mode			= 0555,
+		.child			= nss_qrfs_table,
+	},
+	{ }
+};
+
+static struct ctl_table nss_qrfs_root_dir[] = {
+	{
+		.procname		= "nss",
+		.mode			= 0555,
+		.child			= nss_qrfs_dir,
+	},
+	{ }
+};
+
+static struct ctl_table nss_qrfs_root[] = {
+	{
+		.procname		= "dev",
+		.mode			= 0555,
+		.child			= nss_qrfs_root_dir,
+	},
+	{ }
+};
+
+static struct ctl_table_header *nss_qrfs_header;
+
 /*
  * nss_qrfs_init()
  */
@@ -469,4 +905,48 @@ void nss_qrfs_init(void)
 	for (core = 0; core < NSS_CORE_MAX; core++) {
 		nss_qrfs_notify_register(core, NULL, NULL);
 	}
+
+	INIT_DELAYED_WORK(&nss_qrfs_rule_batch.dwork, nss_qrfs_rule_batch_work);
+	nss_qrfs_rule_batch.nqm = kzalloc(PAGE_SIZE, GFP_KERNEL);
+	if (!nss_qrfs_rule_batch.nqm) {
+		nss_warning("failed to allocate qrfs rule batch\n");
+	}
+
+	nss_qrfs_rule_batch.max = (PAGE_SIZE - offsetof(struct nss_qrfs_msg, msg.flow_add_many.rule)) /
+					sizeof(struct nss_qrfs_flow_rule_msg);
+
+	nss_qrfs_header = register_sysctl_table(nss_qrfs_root);
+
+	nss_qrfs_steer_init();
+}
+
+/*
+ * nss_qrfs_exit()
+ *	Tear down QRFS host state.
+ */
+void nss_qrfs_exit(void)
+{
+	struct nss_qrfs_rule *r;
+	struct hlist_node *tmp;
+	int bkt;
+
+	nss_qrfs_steer_exit();
+
+	if (nss_qrfs_header) {
+		unregister_sysctl_table(nss_qrfs_header);
+	}
+
+	cancel_delayed_work_sync(&nss_qrfs_rule_batch.dwork);
+
+	spin_lock_bh(&nss_qrfs_rule_lock);
+	hash_for_each_safe(nss_qrfs_rule_table, bkt, tmp, r, node) {
+		hash_del(&r->node);
+		kfree(r);
+	}
+	nss_qrfs_rule_count = 0;
+	nss_qrfs_rule_batch.count = 0;
+	spin_unlock_bh(&nss_qrfs_rule_lock);
+
+	kfree(nss_qrfs_rule_batch.nqm);
+	nss_qrfs_rule_batch.nqm = NULL;
 }
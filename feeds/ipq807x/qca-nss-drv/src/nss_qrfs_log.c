@@ -33,6 +33,8 @@ static int8_t *nss_qrfs_log_message_types_str[NSS_QRFS_MSG_MAX] __maybe_unused =
 	"QRFS MAC Add Message",
 	"QRFS MAC Delete Message",
 	"QRFS Stats Sync",
+	"QRFS Flow Add Many Message",
+	"QRFS Flow Delete Many Message",
 };
 
 /*
@@ -80,6 +82,18 @@ static void nss_qrfs_log_flow_rule_msg(struct nss_qrfs_flow_rule_msg *nqfm)
 	}
 }
 
+/*
+ * nss_qrfs_log_flow_rule_many_msg()
+ *	Log NSS QRFS Flow Rule Many Message.
+ */
+static void nss_qrfs_log_flow_rule_many_msg(struct nss_qrfs_flow_rule_many_msg *nqfmm)
+{
+	nss_trace("%px: NSS QRFS Flow Rule Many Message:\n"
+		"QRFS Rule Count: %d\n"
+		"QRFS Message Size: %d\n",
+		nqfmm, nqfmm->count, nqfmm->size);
+}
+
 /*
  * nss_qrfs_log_mac_rule_msg()
  *	Log NSS QRFS MAC Rule Message.
@@ -111,6 +125,11 @@ static void nss_qrfs_log_verbose(struct nss_qrfs_msg *nqm)
 		nss_qrfs_log_mac_rule_msg(&nqm->msg.mac_add);
 		break;
 
+	case NSS_QRFS_MSG_FLOW_ADD_MANY:
+	case NSS_QRFS_MSG_FLOW_DELETE_MANY:
+		nss_qrfs_log_flow_rule_many_msg(&nqm->msg.flow_add_many);
+		break;
+
 	case NSS_QRFS_MSG_STATS_SYNC:
 		/*
 		 * No log for valid stats message.
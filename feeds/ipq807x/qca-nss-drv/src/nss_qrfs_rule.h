@@ -0,0 +1,53 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+
+/*
+ * nss_qrfs_rule.h
+ *	Host table of QRFS flow rules programmed in the NSS.
+ */
+
+#ifndef __NSS_QRFS_RULE_H
+#define __NSS_QRFS_RULE_H
+
+#include <linux/jhash.h>
+
+/*
+ * nss_qrfs_rule_hash()
+ *	Hash the 5-tuple of a flow rule.
+ */
+static inline uint32_t nss_qrfs_rule_hash(struct nss_qrfs_flow_rule_msg *rule)
+{
+	return jhash2(rule->src_addr, 4, jhash2(rule->dst_addr, 4,
+			((uint32_t)rule->src_port << 16 | rule->dst_port) ^ rule->protocol));
+}
+
+/*
+ * nss_qrfs_rule_match()
+ *	Compare the 5-tuple of two flow rules.
+ */
+static inline bool nss_qrfs_rule_match(struct nss_qrfs_flow_rule_msg *a, struct nss_qrfs_flow_rule_msg *b)
+{
+	return a->src_port == b->src_port && a->dst_port == b->dst_port &&
+		a->protocol == b->protocol && a->ip_version == b->ip_version &&
+		!memcmp(a->src_addr, b->src_addr, sizeof(a->src_addr)) &&
+		!memcmp(a->dst_addr, b->dst_addr, sizeof(a->dst_addr));
+}
+
+extern int nss_qrfs_rule_count;
+extern void nss_qrfs_rule_touch(struct nss_qrfs_flow_rule_msg *rule, uint32_t hash);
+
+#endif /* __NSS_QRFS_RULE_H */
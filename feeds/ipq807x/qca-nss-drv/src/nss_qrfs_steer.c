@@ -0,0 +1,635 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+
+/*
+ * nss_qrfs_steer.c
+ *	Move elephant flows off overloaded host CPUs with QRFS flow rules.
+ *
+ * A sample of the packets the NSS hands to the host is accounted per flow,
+ * together with the CPU that received it. Once a second the softirq and
+ * irq load of every CPU is read; a CPU that stays above the high load mark
+ * for NSS_QRFS_STEER_HOLD_PERIODS periods gets its heaviest flow steered
+ * to the least loaded CPU below the low load mark. A moved flow is left
+ * alone for NSS_QRFS_STEER_MIN_AGE_SEC, the number of moves per period and
+ * of rules installed at once are capped, and rules of flows that went
+ * idle are removed.
+ */
+
+#include <linux/hashtable.h>
+#include <linux/kernel_stat.h>
+#include <linux/if_vlan.h>
+#include <linux/ip.h>
+#include <linux/ipv6.h>
+#include <linux/tcp.h>
+#include <linux/udp.h>
+#include "nss_tx_rx_common.h"
+#include "nss_qrfs_rule.h"
+#include "nss_qrfs_steer.h"
+
+#define NSS_QRFS_STEER_PERIOD_MS	1000	/* Sampling period */
+#define NSS_QRFS_STEER_HASH_BITS	8
+#define NSS_QRFS_STEER_MAX_FLOWS	1024	/* Flows tracked at once */
+#define NSS_QRFS_STEER_HOLD_PERIODS	2	/* Overloaded periods before a move */
+#define NSS_QRFS_STEER_MIN_AGE_SEC	10	/* Time before a moved flow can move again */
+#define NSS_QRFS_STEER_IDLE_SEC		30	/* Idle time before a flow is forgotten */
+#define NSS_QRFS_STEER_CMD_MAX		16	/* Rule messages sent per period */
+
+/*
+ * Flow being tracked
+ */
+struct nss_qrfs_steer_flow {
+	struct hlist_node node;			/* Hash table node */
+	struct nss_qrfs_flow_rule_msg rule;	/* 5-tuple; cpu is the steering target */
+	uint32_t hash;				/* Hash of the 5-tuple */
+	uint64_t bytes;				/* Sampled bytes, scaled to all packets */
+	uint64_t last_bytes;			/* bytes at the last period */
+	uint64_t rate;				/* Bytes per second over the last period */
+	int cpu;				/* CPU the flow was last received on */
+	bool steered;				/* A rule is installed for the flow */
+	unsigned long steered_at;		/* Time of the last move */
+	unsigned long last_seen;		/* Time of the last sampled packet */
+};
+
+/*
+ * Per CPU load tracking
+ */
+struct nss_qrfs_steer_cpu {
+	uint64_t busy;				/* Softirq and irq time at the last period */
+	uint32_t load;				/* Percentage of the last period spent in softirq and irq */
+	uint32_t hot;				/* Consecutive periods above the high load mark */
+	struct nss_qrfs_steer_flow *heaviest;	/* Heaviest flow received on this CPU */
+};
+
+/*
+ * Rule message queued while walking the flow table
+ */
+struct nss_qrfs_steer_cmd {
+	struct nss_qrfs_flow_rule_msg rule;
+	uint32_t action;
+	int from;
+};
+
+int nss_qrfs_steer_enable __read_mostly;
+int nss_qrfs_steer_high_load __read_mostly = 90;
+int nss_qrfs_steer_low_load __read_mostly = 60;
+int nss_qrfs_steer_elephant_kbps __read_mostly = 100000;
+int nss_qrfs_steer_max_moves __read_mostly = 1;
+int nss_qrfs_steer_max_rules __read_mostly = 64;
+
+DEFINE_PER_CPU(uint32_t, nss_qrfs_steer_skip);
+static DEFINE_PER_CPU(struct nss_qrfs_steer_cpu, nss_qrfs_steer_cpus);
+
+static DEFINE_HASHTABLE(nss_qrfs_steer_table, NSS_QRFS_STEER_HASH_BITS);
+static DEFINE_SPINLOCK(nss_qrfs_steer_lock);
+static uint32_t nss_qrfs_steer_flows;
+static uint32_t nss_qrfs_steer_rules;
+static unsigned long nss_qrfs_steer_last;
+static struct delayed_work nss_qrfs_steer_dwork;
+static struct nss_qrfs_steer_cmd nss_qrfs_steer_cmds[NSS_QRFS_STEER_CMD_MAX];
+
+static int nss_qrfs_steer_zero;
+static int nss_qrfs_steer_hundred = 100;
+
+/*
+ * nss_qrfs_steer_parse()
+ *	Extract the 5-tuple of a TCP or UDP packet starting at its Ethernet header.
+ */
+static bool nss_qrfs_steer_parse(struct sk_buff *nbuf, struct nss_qrfs_flow_rule_msg *rule)
+{
+	uint8_t *data = nbuf->data;
+	uint32_t len = skb_headlen(nbuf);
+	uint32_t off = ETH_HLEN;
+	__be16 proto;
+	uint8_t l4proto;
+
+	if (len < ETH_HLEN) {
+		return false;
+	}
+
+	proto = ((struct ethhdr *)data)->h_proto;
+	if (proto == htons(ETH_P_8021Q)) {
+		if (len < off + VLAN_HLEN) {
+			return false;
+		}
+
+		proto = ((struct vlan_hdr *)(data + off))->h_vlan_encapsulated_proto;
+		off += VLAN_HLEN;
+	}
+
+	memset(rule, 0, sizeof(*rule));
+
+	if (proto == htons(ETH_P_IP)) {
+		struct iphdr *iph = (struct iphdr *)(data + off);
+
+		if (len < off + sizeof(*iph) || iph->ihl < 5) {
+			return false;
+		}
+
+		/*
+		 * Only the first fragment has ports; leave fragmented flows alone.
+		 */
+		if (iph->frag_off & htons(IP_MF | IP_OFFSET)) {
+			return false;
+		}
+
+		rule->ip_version = 4;
+		rule->src_addr[0] = iph->saddr;
+		rule->dst_addr[0] = iph->daddr;
+		l4proto = iph->protocol;
+		off += iph->ihl * 4;
+	} else if (proto == htons(ETH_P_IPV6)) {
+		struct ipv6hdr *ip6h = (struct ipv6hdr *)(data + off);
+
+		if (len < off + sizeof(*ip6h)) {
+			return false;
+		}
+
+		rule->ip_version = 6;
+		memcpy(rule->src_addr, &ip6h->saddr, sizeof(struct in6_addr));
+		memcpy(rule->dst_addr, &ip6h->daddr, sizeof(struct in6_addr));
+		l4proto = ip6h->nexthdr;
+		off += sizeof(*ip6h);
+	} else {
+		return false;
+	}
+
+	if (l4proto != IPPROTO_TCP && l4proto != IPPROTO_UDP) {
+		return false;
+	}
+
+	/*
+	 * TCP and UDP both start with the source and destination ports.
+	 */
+	if (len < off + 2 * sizeof(__be16)) {
+		return false;
+	}
+
+	rule->protocol = l4proto;
+	rule->src_port = ((__be16 *)(data + off))[0];
+	rule->dst_port = ((__be16 *)(data + off))[1];
+	return true;
+}
+
+/*
+ * nss_qrfs_steer_sample()
+ *	Account a sampled packet to its flow and to its programmed rule.
+ */
+void nss_qrfs_steer_sample(struct sk_buff *nbuf)
+{
+	struct nss_qrfs_flow_rule_msg rule;
+	struct nss_qrfs_steer_flow *f;
+	uint32_t hash;
+
+	if (!nss_qrfs_steer_parse(nbuf, &rule)) {
+		return;
+	}
+
+	hash = nss_qrfs_rule_hash(&rule);
+
+	/*
+	 * Keep programmed rules of live flows from aging out.
+	 */
+	if (READ_ONCE(nss_qrfs_rule_count)) {
+		nss_qrfs_rule_touch(&rule, hash);
+	}
+
+	if (!nss_qrfs_steer_enable) {
+		return;
+	}
+
+	spin_lock(&nss_qrfs_steer_lock);
+	hash_for_each_possible(nss_qrfs_steer_table, f, node, hash) {
+		if (f->hash == hash && nss_qrfs_rule_match(&f->rule, &rule)) {
+			goto found;
+		}
+	}
+
+	if (nss_qrfs_steer_flows >= NSS_QRFS_STEER_MAX_FLOWS) {
+		spin_unlock(&nss_qrfs_steer_lock);
+		return;
+	}
+
+	f = kzalloc(sizeof(*f), GFP_ATOMIC);
+	if (!f) {
+		spin_unlock(&nss_qrfs_steer_lock);
+		return;
+	}
+
+	f->rule = rule;
+	f->hash = hash;
+	hash_add(nss_qrfs_steer_table, &f->node, hash);
+	nss_qrfs_steer_flows++;
+
+found:
+	f->bytes += (uint64_t)nbuf->len << NSS_QRFS_STEER_SAMPLE_SHIFT;
+	f->cpu = smp_processor_id();
+	f->last_seen = jiffies;
+	spin_unlock(&nss_qrfs_steer_lock);
+}
+
+/*
+ * nss_qrfs_steer_cpu_busy()
+ *	Time a CPU has spent in softirq and irq context, in nanoseconds.
+ */
+static uint64_t nss_qrfs_steer_cpu_busy(int cpu)
+{
+	struct kernel_cpustat *kcs = &kcpustat_cpu(cpu);
+
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(4, 11, 0))
+	return kcs->cpustat[CPUTIME_SOFTIRQ] + kcs->cpustat[CPUTIME_IRQ];
+#else
+	return cputime_to_nsecs(kcs->cpustat[CPUTIME_SOFTIRQ] + kcs->cpustat[CPUTIME_IRQ]);
+#endif
+}
+
+/*
+ * nss_qrfs_steer_update_load()
+ *	Refresh the load of every online CPU; a zero period only takes the baseline.
+ */
+static void nss_qrfs_steer_update_load(uint64_t period_ns)
+{
+	int cpu;
+
+	for_each_online_cpu(cpu) {
+		struct nss_qrfs_steer_cpu *c = per_cpu_ptr(&nss_qrfs_steer_cpus, cpu);
+		uint64_t busy = nss_qrfs_steer_cpu_busy(cpu);
+
+		if (!period_ns) {
+			c->busy = busy;
+			c->load = 0;
+			c->hot = 0;
+			c->heaviest = NULL;
+			continue;
+		}
+
+		c->load = (uint32_t)min_t(uint64_t, div64_u64((busy - c->busy) * 100, period_ns), 100);
+		c->busy = busy;
+		c->heaviest = NULL;
+
+		if (c->load >= nss_qrfs_steer_high_load) {
+			c->hot++;
+		} else {
+			c->hot = 0;
+		}
+	}
+}
+
+/*
+ * nss_qrfs_steer_target()
+ *	Least loaded online CPU other than from that is below the low load mark.
+ */
+static int nss_qrfs_steer_target(int from)
+{
+	uint32_t best_load = nss_qrfs_steer_low_load;
+	int target = -1;
+	int cpu;
+
+	for_each_online_cpu(cpu) {
+		struct nss_qrfs_steer_cpu *c = per_cpu_ptr(&nss_qrfs_steer_cpus, cpu);
+
+		if (cpu == from || c->load >= best_load) {
+			continue;
+		}
+
+		best_load = c->load;
+		target = cpu;
+	}
+
+	return target;
+}
+
+/*
+ * nss_qrfs_steer_queue()
+ *	Queue a rule message to send once the flow table is unlocked.
+ */
+static bool nss_qrfs_steer_queue(int *ncmds, struct nss_qrfs_steer_flow *f, uint32_t action, int from)
+{
+	struct nss_qrfs_steer_cmd *cmd;
+
+	if (*ncmds >= NSS_QRFS_STEER_CMD_MAX) {
+		return false;
+	}
+
+	cmd = &nss_qrfs_steer_cmds[(*ncmds)++];
+	cmd->rule = f->rule;
+	cmd->action = action;
+	cmd->from = from;
+	return true;
+}
+
+/*
+ * nss_qrfs_steer_send()
+ *	Send queued rule messages.
+ */
+static void nss_qrfs_steer_send(int ncmds)
+{
+	int i;
+
+	for (i = 0; i < ncmds; i++) {
+		struct nss_qrfs_steer_cmd *cmd = &nss_qrfs_steer_cmds[i];
+
+		if (nss_qrfs_set_flow_rule_msg(&cmd->rule, cmd->action) != NSS_TX_SUCCESS) {
+			nss_warning("qrfs steer: failed to send rule for cpu %d\n", cmd->rule.cpu);
+			continue;
+		}
+
+		if (cmd->action == NSS_QRFS_MSG_FLOW_ADD) {
+			nss_info("qrfs steer: moved %s flow port %u -> %u from cpu %d to cpu %d\n",
+					cmd->rule.protocol == IPPROTO_TCP ? "tcp" : "udp",
+					ntohs(cmd->rule.src_port), ntohs(cmd->rule.dst_port),
+					cmd->from, cmd->rule.cpu);
+		}
+	}
+}
+
+/*
+ * nss_qrfs_steer_work()
+ *	Periodic load evaluation and flow steering.
+ */
+static void nss_qrfs_steer_work(struct work_struct *work)
+{
+	struct nss_qrfs_steer_flow *f;
+	struct hlist_node *tmp;
+	unsigned long now = jiffies;
+	uint64_t period_ns, elephant;
+	int ncmds = 0;
+	int moves = 0;
+	int bkt, cpu;
+
+	period_ns = max_t(uint64_t, (uint64_t)jiffies_to_msecs(now - nss_qrfs_steer_last) * NSEC_PER_MSEC, 1);
+	nss_qrfs_steer_last = now;
+	nss_qrfs_steer_update_load(period_ns);
+
+	elephant = (uint64_t)nss_qrfs_steer_elephant_kbps * 1000 / 8;
+
+	spin_lock_bh(&nss_qrfs_steer_lock);
+	hash_for_each_safe(nss_qrfs_steer_table, bkt, tmp, f, node) {
+		struct nss_qrfs_steer_cpu *c;
+
+		f->rate = div64_u64((f->bytes - f->last_bytes) * NSEC_PER_SEC, period_ns);
+		f->last_bytes = f->bytes;
+
+		if (time_after(now, f->last_seen + NSS_QRFS_STEER_IDLE_SEC * HZ)) {
+			if (f->steered) {
+				if (!nss_qrfs_steer_queue(&ncmds, f, NSS_QRFS_MSG_FLOW_DELETE, f->cpu)) {
+					continue;
+				}
+
+				nss_qrfs_steer_rules--;
+			}
+
+			hash_del(&f->node);
+			kfree(f);
+			nss_qrfs_steer_flows--;
+			continue;
+		}
+
+		if (!cpu_online(f->cpu)) {
+			continue;
+		}
+
+		c = per_cpu_ptr(&nss_qrfs_steer_cpus, f->cpu);
+		if (!c->heaviest || f->rate > c->heaviest->rate) {
+			c->heaviest = f;
+		}
+	}
+
+	for_each_online_cpu(cpu) {
+		struct nss_qrfs_steer_cpu *c = per_cpu_ptr(&nss_qrfs_steer_cpus, cpu);
+		int target;
+
+		if (moves >= nss_qrfs_steer_max_moves) {
+			break;
+		}
+
+		if (c->hot < NSS_QRFS_STEER_HOLD_PERIODS) {
+			continue;
+		}
+
+		f = c->heaviest;
+		if (!f || f->rate < elephant) {
+			continue;
+		}
+
+		if (f->steered && time_before(now, f->steered_at + NSS_QRFS_STEER_MIN_AGE_SEC * HZ)) {
+			continue;
+		}
+
+		if (!f->steered && nss_qrfs_steer_rules >= nss_qrfs_steer_max_rules) {
+			continue;
+		}
+
+		target = nss_qrfs_steer_target(cpu);
+		if (target < 0) {
+			continue;
+		}
+
+		f->rule.cpu = (uint16_t)target;
+		if (!nss_qrfs_steer_queue(&ncmds, f, NSS_QRFS_MSG_FLOW_ADD, cpu)) {
+			break;
+		}
+
+		if (!f->steered) {
+			f->steered = true;
+			nss_qrfs_steer_rules++;
+		}
+
+		f->steered_at = now;
+		f->cpu = target;
+		moves++;
+
+		/*
+		 * Let the load settle before acting on either CPU again.
+		 */
+		c->hot = 0;
+		per_cpu_ptr(&nss_qrfs_steer_cpus, target)->load = nss_qrfs_steer_high_load;
+	}
+	spin_unlock_bh(&nss_qrfs_steer_lock);
+
+	nss_qrfs_steer_send(ncmds);
+
+	if (nss_qrfs_steer_enable) {
+		schedule_delayed_work(&nss_qrfs_steer_dwork, msecs_to_jiffies(NSS_QRFS_STEER_PERIOD_MS));
+	}
+}
+
+/*
+ * nss_qrfs_steer_flush()
+ *	Remove all rules installed by steering and forget every flow.
+ */
+static void nss_qrfs_steer_flush(void)
+{
+	struct nss_qrfs_steer_flow *f;
+	struct hlist_node *tmp;
+	int bkt;
+
+	do {
+		int ncmds = 0;
+
+		spin_lock_bh(&nss_qrfs_steer_lock);
+		hash_for_each_safe(nss_qrfs_steer_table, bkt, tmp, f, node) {
+			if (f->steered) {
+				if (!nss_qrfs_steer_queue(&ncmds, f, NSS_QRFS_MSG_FLOW_DELETE, f->cpu)) {
+					break;
+				}
+
+				nss_qrfs_steer_rules--;
+			}
+
+			hash_del(&f->node);
+			kfree(f);
+			nss_qrfs_steer_flows--;
+		}
+		spin_unlock_bh(&nss_qrfs_steer_lock);
+
+		nss_qrfs_steer_send(ncmds);
+	} while (nss_qrfs_steer_flows);
+}
+
+/*
+ * nss_qrfs_steer_enable_handler()
+ *	Start or stop flow steering.
+ */
+static int nss_qrfs_steer_enable_handler(struct ctl_table *ctl, int write, void __user *buffer, size_t *lenp, loff_t *ppos)
+{
+	int ret;
+
+	ret = proc_dointvec(ctl, write, buffer, lenp, ppos);
+	if (!write || ret) {
+		return ret;
+	}
+
+	if (nss_qrfs_steer_enable) {
+		nss_qrfs_steer_last = jiffies;
+		nss_qrfs_steer_update_load(0);
+		schedule_delayed_work(&nss_qrfs_steer_dwork, msecs_to_jiffies(NSS_QRFS_STEER_PERIOD_MS));
+		nss_info("qrfs steer enabled\n");
+		return 0;
+	}
+
+	cancel_delayed_work_sync(&nss_qrfs_steer_dwork);
+	nss_qrfs_steer_flush();
+	nss_info("qrfs steer disabled\n");
+	return 0;
+}
+
+static struct ctl_table nss_qrfs_steer_table_ctl[] = {
+	{
+		.procname	= "enable",
+		.data		= &nss_qrfs_steer_enable,
+		.maxlen		= sizeof(int),
+		.mode		= 0644,
+		.proc_handler	= &nss_qrfs_steer_enable_handler,
+	},
+	{
+		.procname	= "high_load",
+		.data		= &nss_qrfs_steer_high_load,
+		.maxlen		= sizeof(int),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_minmax,
+		.extra1		= &nss_qrfs_steer_zero,
+		.extra2		= &nss_qrfs_steer_hundred,
+	},
+	{
+		.procname	= "low_load",
+		.data		= &nss_qrfs_steer_low_load,
+		.maxlen		= sizeof(int),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_minmax,
+		.extra1		= &nss_qrfs_steer_zero,
+		.extra2		= &nss_qrfs_steer_hundred,
+	},
+	{
+		.procname	= "elephant_kbps",
+		.data		= &nss_qrfs_steer_elephant_kbps,
+		.maxlen		= sizeof(int),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_minmax,
+		.extra1		= &nss_qrfs_steer_zero,
+	},
+	{
+		.procname	= "max_moves",
+		.data		= &nss_qrfs_steer_max_moves,
+		.maxlen		= sizeof(int),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_minmax,
+		.extra1		= &nss_qrfs_steer_zero,
+	},
+	{
+		.procname	= "max_rules",
+		.data		= &nss_qrfs_steer_max_rules,
+		.maxlen		= sizeof(int),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_minmax,
+		.extra1		= &nss_qrfs_steer_zero,
+	},
+	{ }
+};
+
+static struct ctl_table nss_qrfs_steer_dir[] = {
+	{
+		.procname		= "qrfs_steer",
+		.mode			= 0555,
+		.child			= nss_qrfs_steer_table_ctl,
+	},
+	{ }
+};
+
+static struct ctl_table nss_qrfs_steer_root_dir[] = {
+	{
+		.procname		= "nss",
+		.mode			= 0555,
+		.child			= nss_qrfs_steer_dir,
+	},
+	{ }
+};
+
+static struct ctl_table nss_qrfs_steer_root[] = {
+	{
+		.procname		= "dev",
+		.mode			= 0555,
+		.child			= nss_qrfs_steer_root_dir,
+	},
+	{ }
+};
+
+static struct ctl_table_header *nss_qrfs_steer_header;
+
+/*
+ * nss_qrfs_steer_init()
+ *	Register flow steering sysctl.
+ */
+void nss_qrfs_steer_init(void)
+{
+	INIT_DELAYED_WORK(&nss_qrfs_steer_dwork, nss_qrfs_steer_work);
+	nss_qrfs_steer_header = register_sysctl_table(nss_qrfs_steer_root);
+}
+
+/*
+ * nss_qrfs_steer_exit()
+ *	Stop flow steering and remove its rules.
+ */
+void nss_qrfs_steer_exit(void)
+{
+	if (nss_qrfs_steer_header) {
+		unregister_sysctl_table(nss_qrfs_steer_header);
+	}
+
+	nss_qrfs_steer_enable = 0;
+	cancel_delayed_work_sync(&nss_qrfs_steer_dwork);
+	nss_qrfs_steer_flush();
+}
@@ -0,0 +1,59 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+
+/*
+ * nss_qrfs_steer.h
+ *	Load driven QRFS flow steering.
+ */
+
+#ifndef __NSS_QRFS_STEER_H
+#define __NSS_QRFS_STEER_H
+
+/*
+ * One packet in 1 << NSS_QRFS_STEER_SAMPLE_SHIFT is looked at.
+ */
+#define NSS_QRFS_STEER_SAMPLE_SHIFT	5
+#define NSS_QRFS_STEER_SAMPLE_MASK	((1 << NSS_QRFS_STEER_SAMPLE_SHIFT) - 1)
+
+extern int nss_qrfs_steer_enable;
+extern int nss_qrfs_rule_count;
+DECLARE_PER_CPU(uint32_t, nss_qrfs_steer_skip);
+
+extern void nss_qrfs_steer_sample(struct sk_buff *nbuf);
+extern void nss_qrfs_steer_init(void);
+extern void nss_qrfs_steer_exit(void);
+
+/*
+ * nss_qrfs_steer_rx()
+ *	Account a packet about to be delivered to the host.
+ *
+ * nbuf->data must point at the Ethernet header.
+ */
+static inline void nss_qrfs_steer_rx(struct sk_buff *nbuf)
+{
+	if (likely(!nss_qrfs_steer_enable && !READ_ONCE(nss_qrfs_rule_count))) {
+		return;
+	}
+
+	if (this_cpu_inc_return(nss_qrfs_steer_skip) & NSS_QRFS_STEER_SAMPLE_MASK) {
+		return;
+	}
+
+	nss_qrfs_steer_sample(nbuf);
+}
+
+#endif /* __NSS_QRFS_STEER_H */
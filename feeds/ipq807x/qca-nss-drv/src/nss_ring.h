@@ -0,0 +1,107 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2020, The Linux Foundation. All rights reserved.
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/*
+ * nss_ring.h
+ *	H2N/N2H descriptor ring index arithmetic.
+ *
+ * Rings are a power of two in size; mask is size - 1. The producer owns
+ * one index and the consumer the other, and one descriptor is always left
+ * unused so that a full ring can be told apart from an empty one.
+ *
+ * Nothing here touches the HAL, DMA or skbs, so the header can also be
+ * built outside the kernel to exercise the ring logic against a mock.
+ */
+
+#ifndef __NSS_RING_H
+#define __NSS_RING_H
+
+#ifdef __KERNEL__
+#include <linux/types.h>
+#else
+#include <stdint.h>
+#endif
+
+/*
+ * nss_ring_used()
+ *	Number of descriptors posted by the producer and not yet consumed.
+ */
+static inline uint32_t nss_ring_used(uint32_t prod_index, uint32_t cons_index, uint32_t mask)
+{
+	return (prod_index - cons_index) & mask;
+}
+
+/*
+ * nss_ring_free()
+ *	Number of descriptors the producer can still post.
+ */
+static inline uint32_t nss_ring_free(uint32_t prod_index, uint32_t cons_index, uint32_t mask)
+{
+	return (cons_index - prod_index - 1) & mask;
+}
+
+/*
+ * nss_ring_advance()
+ *	Index count descriptors after index, wrapping around the ring.
+ */
+static inline uint32_t nss_ring_advance(uint32_t index, uint32_t count, uint32_t mask)
+{
+	return (index + count) & mask;
+}
+
+/*
+ * nss_ring_next()
+ *	Index of the descriptor following index.
+ */
+static inline uint32_t nss_ring_next(uint32_t index, uint32_t mask)
+{
+	return (index + 1) & mask;
+}
+
+/*
+ * nss_ring_prev()
+ *	Index of the descriptor preceding index.
+ */
+static inline uint32_t nss_ring_prev(uint32_t index, uint32_t mask)
+{
+	return (index - 1) & mask;
+}
+
+/*
+ * nss_ring_drain_count()
+ *	Number of descriptors a consumer takes in one pass, bounded by weight.
+ */
+static inline uint32_t nss_ring_drain_count(uint32_t prod_index, uint32_t cons_index, uint32_t mask, uint32_t weight)
+{
+	uint32_t count = nss_ring_used(prod_index, cons_index, mask);
+
+	return (count > weight) ? weight : count;
+}
+
+/*
+ * nss_ring_contig()
+ *	Number of the count descriptors starting at index that come before the ring wraps.
+ *
+ * The remaining count - nss_ring_contig() descriptors start at index 0.
+ */
+static inline uint32_t nss_ring_contig(uint32_t index, uint32_t count, uint32_t mask)
+{
+	uint32_t to_end = mask + 1 - index;
+
+	return (count > to_end) ? to_end : count;
+}
+
+#endif /* __NSS_RING_H */
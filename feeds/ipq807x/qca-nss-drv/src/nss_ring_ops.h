@@ -0,0 +1,448 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/*
+ * nss_ring_ops.h
+ *	H2N descriptor fill and N2H descriptor drain loops.
+ *
+ * nss_core.c and tools/nss_ring both build their rings from these loops.
+ * Everything that depends on the buffer type, DMA or the cache goes through
+ * the nss_ring_hal_*() hooks declared below, which the including file defines.
+ * Before including this header, define:
+ *	NSS_RING_HAL_CTX	type of the context handed to the hooks
+ *	NSS_RING_HAL_BUF	type of the buffers sent on H2N rings
+ */
+
+#ifndef __NSS_RING_OPS_H
+#define __NSS_RING_OPS_H
+
+#ifndef __KERNEL__
+#include <stdbool.h>
+#include <stdint.h>
+#endif
+#include "nss_ring.h"
+#include "nss_hlos_desc.h"
+
+#if !defined(NSS_RING_HAL_CTX) || !defined(NSS_RING_HAL_BUF)
+#error "NSS_RING_HAL_CTX and NSS_RING_HAL_BUF must be defined before including nss_ring_ops.h"
+#endif
+
+/*
+ * Checksum state of a buffer, as skb->ip_summed
+ */
+enum nss_ring_csum {
+	NSS_RING_CSUM_NONE,		/* CHECKSUM_NONE */
+	NSS_RING_CSUM_UNNECESSARY,	/* CHECKSUM_UNNECESSARY */
+	NSS_RING_CSUM_PARTIAL,		/* CHECKSUM_PARTIAL */
+};
+
+/*
+ * How a buffer was laid out on the H2N ring
+ */
+enum nss_ring_h2n_kind {
+	NSS_RING_H2N_SIMPLE,		/* Linear buffer, one descriptor */
+	NSS_RING_H2N_REUSE,		/* Linear buffer the NSS may keep */
+	NSS_RING_H2N_NR_FRAGS,		/* Head and frags[] pages */
+	NSS_RING_H2N_FRAGLIST,		/* Head and frag_list buffers */
+};
+
+/*
+ * DMA mapped segment of a buffer
+ */
+struct nss_ring_seg {
+	uint32_t buffer;		/* DMA address of the segment */
+	uint16_t payload_offs;		/* Offset of the payload in the segment */
+	uint16_t payload_len;		/* Payload bytes */
+	uint16_t buffer_len;		/* Size of the mapped segment */
+	uint32_t priority;
+};
+
+/*
+ * HAL hooks
+ */
+
+/*
+ * Write back one H2N descriptor for the NSS to read.
+ */
+static inline void nss_ring_hal_desc_flush(NSS_RING_HAL_CTX *ctx, struct h2n_descriptor *desc);
+
+/*
+ * Invalidate the N2H descriptors from start up to, not including, end.
+ */
+static inline void nss_ring_hal_desc_inv(NSS_RING_HAL_CTX *ctx, struct n2h_descriptor *start, struct n2h_descriptor *end);
+
+static inline void nss_ring_hal_prefetch(const void *addr);
+
+/*
+ * Map the linear area of buf, or of a frag_list member. Returns false when mapping fails.
+ */
+static inline bool nss_ring_hal_map_head(NSS_RING_HAL_CTX *ctx, NSS_RING_HAL_BUF *buf, struct nss_ring_seg *seg);
+static inline bool nss_ring_hal_map_chained(NSS_RING_HAL_CTX *ctx, NSS_RING_HAL_BUF *iter, struct nss_ring_seg *seg);
+
+/*
+ * Map buf so the NSS can receive into it once it is sent. Returns false when buf cannot be reused.
+ */
+static inline bool nss_ring_hal_map_reuse(NSS_RING_HAL_CTX *ctx, uint32_t if_num, NSS_RING_HAL_BUF *buf, struct nss_ring_seg *seg);
+
+/*
+ * Map frags[i] of buf. Returns false when mapping fails.
+ */
+static inline bool nss_ring_hal_map_frag(NSS_RING_HAL_CTX *ctx, NSS_RING_HAL_BUF *buf, uint32_t i, struct nss_ring_seg *seg);
+
+/*
+ * Unmap count descriptors, going backwards from hlos_index.
+ */
+static inline void nss_ring_hal_unmap(NSS_RING_HAL_CTX *ctx, struct h2n_descriptor *desc_ring, uint32_t mask,
+					uint32_t hlos_index, uint32_t count, bool is_fraglist);
+
+/*
+ * Called once the count descriptors of buf are written.
+ */
+static inline void nss_ring_hal_written(NSS_RING_HAL_CTX *ctx, NSS_RING_HAL_BUF *buf,
+					enum nss_ring_h2n_kind kind, uint32_t count);
+
+/*
+ * Buffer accessors
+ */
+static inline uint16_t nss_ring_hal_len(NSS_RING_HAL_BUF *buf);
+static inline uint16_t nss_ring_hal_gso_size(NSS_RING_HAL_BUF *buf);
+static inline enum nss_ring_csum nss_ring_hal_csum(NSS_RING_HAL_BUF *buf);
+static inline uint32_t nss_ring_hal_nr_frags(NSS_RING_HAL_BUF *buf);
+static inline NSS_RING_HAL_BUF *nss_ring_hal_frag_list(NSS_RING_HAL_BUF *buf);
+static inline NSS_RING_HAL_BUF *nss_ring_hal_frag_next(NSS_RING_HAL_BUF *iter);
+
+/*
+ * nss_ring_h2n_segments()
+ *	Return the number of segments that follow the head of buf.
+ *
+ * Returns -1 if buf can never fit in a ring of the given size.
+ */
+static inline int32_t nss_ring_h2n_segments(NSS_RING_HAL_BUF *buf, uint32_t size)
+{
+	NSS_RING_HAL_BUF *iter;
+	uint32_t segments = 0;
+
+	/*
+	 * If buf does not have fraglist, then use nr_frags
+	 * from frags[] array. Otherwise walk the frag_list.
+	 */
+	iter = nss_ring_hal_frag_list(buf);
+	if (!iter) {
+		return nss_ring_hal_nr_frags(buf);
+	}
+
+	for (; iter; iter = nss_ring_hal_frag_next(iter)) {
+		segments++;
+	}
+
+	/*
+	 * Check that segments do not overflow the number of descriptors
+	 */
+	if (segments > size) {
+		return -1;
+	}
+
+	return segments;
+}
+
+/*
+ * nss_ring_h2n_csum_flags()
+ *	Checksum offload bit flags of buf.
+ */
+static inline uint16_t nss_ring_h2n_csum_flags(NSS_RING_HAL_BUF *buf, bool is_linear)
+{
+	switch (nss_ring_hal_csum(buf)) {
+	case NSS_RING_CSUM_PARTIAL:
+		return H2N_BIT_FLAG_GEN_IP_TRANSPORT_CHECKSUM | H2N_BIT_FLAG_GEN_IPV4_IP_CHECKSUM;
+
+	case NSS_RING_CSUM_UNNECESSARY:
+		return is_linear ? H2N_BIT_FLAG_GEN_IP_TRANSPORT_CHECKSUM_NONE : 0;
+
+	default:
+		return 0;
+	}
+}
+
+/*
+ * nss_ring_h2n_fill_simple()
+ *	Write one descriptor for a linear buffer.
+ */
+static inline int32_t nss_ring_h2n_fill_simple(NSS_RING_HAL_CTX *ctx, struct h2n_descriptor *desc_ring,
+	uint32_t hlos_index, uint32_t if_num, NSS_RING_HAL_BUF *buf, uint16_t flags, uint8_t buffer_type, uint16_t mss)
+{
+	struct h2n_descriptor *desc = &desc_ring[hlos_index];
+	enum nss_ring_h2n_kind kind = NSS_RING_H2N_SIMPLE;
+	struct nss_ring_seg seg;
+	uint16_t bit_flags;
+
+	bit_flags = flags | H2N_BIT_FLAG_FIRST_SEGMENT | H2N_BIT_FLAG_LAST_SEGMENT;
+	bit_flags |= nss_ring_h2n_csum_flags(buf, true);
+
+	/*
+	 * The caller allows the NSS to keep the buffer; the HAL checks if it meets the criteria.
+	 */
+	if ((bit_flags & H2N_BIT_FLAG_BUFFER_REUSABLE) && nss_ring_hal_map_reuse(ctx, if_num, buf, &seg)) {
+		kind = NSS_RING_H2N_REUSE;
+	} else {
+		bit_flags &= ~H2N_BIT_FLAG_BUFFER_REUSABLE;
+		if (!nss_ring_hal_map_head(ctx, buf, &seg)) {
+			return 0;
+		}
+	}
+
+	nss_core_write_one_descriptor(desc, buffer_type, seg.buffer, if_num,
+		(nss_ptr_t)buf, seg.payload_offs, nss_ring_hal_len(buf),
+		seg.buffer_len, seg.priority, mss, bit_flags);
+
+	nss_ring_hal_desc_flush(ctx, desc);
+
+	nss_ring_hal_written(ctx, buf, kind, 1);
+	return 1;
+}
+
+/*
+ * nss_ring_h2n_fill_nr_frags()
+ *	Write the descriptors of a frags[] array (NETIF_F_SG) buffer.
+ *
+ * Note - Opaque is set only on LAST fragment, and DISCARD is set for the rest of segments
+ * Used to differentiate from FRAGLIST
+ */
+static inline int32_t nss_ring_h2n_fill_nr_frags(NSS_RING_HAL_CTX *ctx, struct h2n_descriptor *desc_ring, uint32_t mask,
+	uint32_t hlos_index, uint32_t if_num, NSS_RING_HAL_BUF *buf, uint16_t flags, uint8_t buffer_type, uint16_t mss)
+{
+	struct h2n_descriptor *desc;
+	struct nss_ring_seg seg;
+	uint32_t nr_frags, i;
+	uint16_t bit_flags;
+
+	if (!nss_ring_hal_map_head(ctx, buf, &seg)) {
+		return 0;
+	}
+
+	bit_flags = nss_core_h2n_segment_flags(flags, false);
+	bit_flags |= nss_ring_h2n_csum_flags(buf, false);
+
+	/*
+	 * First fragment/descriptor is special
+	 */
+	desc = &desc_ring[hlos_index];
+	nss_core_write_one_descriptor(desc, buffer_type, seg.buffer, if_num,
+		(nss_ptr_t)NULL, seg.payload_offs, seg.payload_len,
+		seg.buffer_len, seg.priority, mss, bit_flags | H2N_BIT_FLAG_FIRST_SEGMENT);
+
+	nss_ring_hal_desc_flush(ctx, desc);
+
+	/*
+	 * Now handle rest of the fragments.
+	 */
+	nr_frags = nss_ring_hal_nr_frags(buf);
+	for (i = 0; i < nr_frags; i++) {
+		if (!nss_ring_hal_map_frag(ctx, buf, i, &seg)) {
+			nss_ring_hal_unmap(ctx, desc_ring, mask, hlos_index, i + 1, false);
+			return -(int32_t)(i + 1);
+		}
+
+		hlos_index = nss_ring_next(hlos_index, mask);
+		desc = &desc_ring[hlos_index];
+
+		nss_core_write_one_descriptor(desc, buffer_type, seg.buffer, if_num,
+			(nss_ptr_t)NULL, seg.payload_offs, seg.payload_len,
+			seg.buffer_len, seg.priority, mss, bit_flags);
+
+		nss_ring_hal_desc_flush(ctx, desc);
+	}
+
+	/*
+	 * The NSS returns the last fragment to HLOS after the packet
+	 * processing is done, and the HLOS uses its opaque to free the buffer.
+	 */
+	nss_core_h2n_close_segments(desc, (nss_ptr_t)buf, false);
+	nss_ring_hal_desc_flush(ctx, desc);
+
+	nss_ring_hal_written(ctx, buf, NSS_RING_H2N_NR_FRAGS, i + 1);
+	return i + 1;
+}
+
+/*
+ * nss_ring_h2n_fill_fraglist()
+ *	Write the descriptors of a frag_list (NETIF_F_FRAGLIST) buffer.
+ *
+ * Note - Opaque will be set on all fragments, and DISCARD is set for the rest of segments
+ * Used to differentiate from FRAGS
+ */
+static inline int32_t nss_ring_h2n_fill_fraglist(NSS_RING_HAL_CTX *ctx, struct h2n_descriptor *desc_ring, uint32_t mask,
+	uint32_t hlos_index, uint32_t if_num, NSS_RING_HAL_BUF *buf, uint16_t flags, uint8_t buffer_type, uint16_t mss)
+{
+	struct h2n_descriptor *desc;
+	struct nss_ring_seg seg;
+	NSS_RING_HAL_BUF *iter;
+	uint16_t bit_flags;
+	uint32_t i = 0;
+
+	if (!nss_ring_hal_map_head(ctx, buf, &seg)) {
+		return 0;
+	}
+
+	bit_flags = nss_core_h2n_segment_flags(flags, true);
+	bit_flags |= nss_ring_h2n_csum_flags(buf, false);
+
+	/*
+	 * First fragment/descriptor is special. Will hold the Opaque
+	 */
+	desc = &desc_ring[hlos_index];
+	nss_core_write_one_descriptor(desc, buffer_type, seg.buffer, if_num,
+		(nss_ptr_t)buf, seg.payload_offs, seg.payload_len,
+		seg.buffer_len, seg.priority, mss, bit_flags | H2N_BIT_FLAG_FIRST_SEGMENT);
+
+	nss_ring_hal_desc_flush(ctx, desc);
+
+	for (iter = nss_ring_hal_frag_list(buf); iter; iter = nss_ring_hal_frag_next(iter)) {
+		if (!nss_ring_hal_map_chained(ctx, iter, &seg)) {
+			nss_ring_hal_unmap(ctx, desc_ring, mask, hlos_index, i + 1, true);
+			return -(int32_t)(i + 1);
+		}
+
+		hlos_index = nss_ring_next(hlos_index, mask);
+		desc = &desc_ring[hlos_index];
+
+		nss_core_write_one_descriptor(desc, buffer_type, seg.buffer, if_num,
+			(nss_ptr_t)iter, seg.payload_offs, seg.payload_len,
+			seg.buffer_len, seg.priority, mss, bit_flags);
+
+		nss_ring_hal_desc_flush(ctx, desc);
+		i++;
+	}
+
+	nss_core_h2n_close_segments(desc, (nss_ptr_t)buf, true);
+	nss_ring_hal_desc_flush(ctx, desc);
+
+	nss_ring_hal_written(ctx, buf, NSS_RING_H2N_FRAGLIST, i + 1);
+	return i + 1;
+}
+
+/*
+ * nss_ring_h2n_fill()
+ *	Fill the descriptors for one buffer starting at hlos_index.
+ *
+ * The caller has checked that segments + 1 descriptors are free. Returns the
+ * number of descriptors used, or <= 0 on failure.
+ */
+static inline int32_t nss_ring_h2n_fill(NSS_RING_HAL_CTX *ctx, struct h2n_descriptor *desc_ring, uint32_t mask,
+	uint32_t hlos_index, uint32_t if_num, NSS_RING_HAL_BUF *buf, int32_t segments, uint8_t buffer_type, uint16_t flags)
+{
+	uint16_t mss = 0;
+	bool is_bounce = ((buffer_type == H2N_BUFFER_SHAPER_BOUNCE_INTERFACE) || (buffer_type == H2N_BUFFER_SHAPER_BOUNCE_BRIDGE));
+
+	/*
+	 * NOTE: We dont have to perform segmentation offload for packets that are being
+	 * bounced. These packets WILL return to the HLOS for freeing or further processing.
+	 * They will NOT be transmitted by the NSS.
+	 */
+	if (!is_bounce) {
+		mss = nss_ring_hal_gso_size(buf);
+		if (mss) {
+			flags |= H2N_BIT_FLAG_SEGMENTATION_ENABLE;
+		}
+	}
+
+	/*
+	 * WARNING! : The following "is_bounce" check has a potential to cause corruption
+	 * if things change in the NSS. This check allows fragmented packets to be sent down
+	 * with incomplete payload information since NSS does not care about the payload content
+	 * when packets are bounced for shaping. If it starts caring in future, then this code
+	 * will have to change.
+	 *
+	 * WHY WE ARE DOING THIS - Skipping S/G processing helps with performance.
+	 */
+	if ((segments == 0) || is_bounce) {
+		return nss_ring_h2n_fill_simple(ctx, desc_ring, hlos_index, if_num, buf, flags, buffer_type, mss);
+	}
+
+	if (nss_ring_hal_frag_list(buf)) {
+		return nss_ring_h2n_fill_fraglist(ctx, desc_ring, mask, hlos_index, if_num, buf, flags, buffer_type, mss);
+	}
+
+	return nss_ring_h2n_fill_nr_frags(ctx, desc_ring, mask, hlos_index, if_num, buf, flags, buffer_type, mss);
+}
+
+/*
+ * nss_ring_n2h_drain_begin()
+ *	Get the count descriptors at hlos_index ready to be read.
+ *
+ * Returns the first descriptor.
+ */
+static inline struct n2h_descriptor *nss_ring_n2h_drain_begin(NSS_RING_HAL_CTX *ctx, struct n2h_descriptor *desc_ring,
+	uint32_t hlos_index, uint32_t count, uint32_t mask)
+{
+	uint32_t contig;
+
+	/*
+	 * Invalidate all the descriptors we are going to read
+	 */
+	contig = nss_ring_contig(hlos_index, count, mask);
+	nss_ring_hal_desc_inv(ctx, &desc_ring[hlos_index], &desc_ring[hlos_index + contig]);
+	if (contig < count) {
+		/*
+		 * We have wrapped around
+		 */
+		nss_ring_hal_desc_inv(ctx, &desc_ring[0], &desc_ring[count - contig]);
+	}
+
+	/*
+	 * Prefetch the first descriptor
+	 */
+	nss_ring_hal_prefetch(&desc_ring[hlos_index]);
+
+	/*
+	 * Prefetch the next cache line of descriptors if we are starting with
+	 * the second descriptor in the cache line. If it is the first in the cache line,
+	 * this will be done inside the loop.
+	 */
+	if (((hlos_index & 1) == 1) && (count > 1)) {
+		nss_ring_hal_prefetch(&desc_ring[nss_ring_advance(hlos_index, 2, mask)]);
+	}
+
+	return &desc_ring[hlos_index];
+}
+
+/*
+ * nss_ring_n2h_prefetch_next()
+ *	Prefetch the next cache line of descriptors when at the first one of a line.
+ */
+static inline bool nss_ring_n2h_prefetch_next(struct n2h_descriptor *desc_ring, uint32_t hlos_index,
+	uint32_t count, uint32_t mask)
+{
+	if (((hlos_index & 1) == 0) && (count > 2)) {
+		nss_ring_hal_prefetch(&desc_ring[nss_ring_advance(hlos_index, 2, mask)]);
+	}
+
+	return true;
+}
+
+/*
+ * nss_ring_n2h_for_each()
+ *	Walk count descriptors from desc, at hlos_index, after nss_ring_n2h_drain_begin().
+ *
+ * hlos_index and desc are left on the first descriptor not read, and count at 0.
+ * "continue" moves on to the next descriptor.
+ */
+#define nss_ring_n2h_for_each(desc_ring, desc, hlos_index, count, mask)				\
+	for (; (count) && nss_ring_n2h_prefetch_next(desc_ring, hlos_index, count, mask);	\
+		(hlos_index) = nss_ring_next(hlos_index, mask), (desc) = &(desc_ring)[hlos_index], (count)--)
+
+#endif /* __NSS_RING_OPS_H */
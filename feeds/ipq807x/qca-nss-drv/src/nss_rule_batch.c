@@ -0,0 +1,426 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/*
+ * nss_rule_batch.c
+ *	Coalescing of rule create and destroy messages.
+ *
+ * Rules are queued into a page sized multiple rule message. A batch goes
+ * out when it is full, when its 1 ms window ends, or when a rule of the
+ * other kind or for another core arrives, which keeps creates and
+ * destroys in order. Each queued rule's own callback is invoked with its
+ * per-rule response.
+ *
+ * If the firmware NACKs a multiple rule message, its rules are sent again
+ * one message each, so their callbacks see the firmware's answer to every
+ * rule. A NACK for an unknown message type means the firmware has no
+ * multiple rule messages; from then on rules are sent one by one straight
+ * away.
+ */
+
+#include "nss_rule_batch.h"
+
+/*
+ * Rule messages queued to be sent in one multiple rule message
+ */
+struct nss_rule_batch {
+	struct nss_rule_batcher *rb;			/* Batcher the batch belongs to */
+	struct nss_ctx_instance *nss_ctx;		/* Core the rules are sent to */
+	const struct nss_rule_batch_layout *layout;	/* Kind of the queued rules */
+	uint16_t count;					/* Number of rules queued */
+	uint16_t max;					/* Number of rules that fit in the message */
+	struct nss_cmn_msg *cm;				/* Header of each queued rule message */
+	struct nss_cmn_msg *reply;			/* Message handed to each rule callback */
+	struct nss_cmn_msg *many;			/* Multiple rule message, PAGE_SIZE bytes */
+};
+
+/*
+ * Callback of the protocol messages
+ */
+typedef void (*nss_rule_batch_msg_callback_t)(void *app_data, struct nss_cmn_msg *ncm);
+
+/*
+ * nss_rule_batch_hdr()
+ *	Header of a multiple rule message.
+ */
+static inline struct nss_rule_many_hdr *nss_rule_batch_hdr(struct nss_rule_batch *batch, struct nss_cmn_msg *ncm)
+{
+	return (struct nss_rule_many_hdr *)((uint8_t *)ncm + batch->rb->ops->msg_rule);
+}
+
+/*
+ * nss_rule_batch_entry()
+ *	Entry i of a multiple rule message.
+ */
+static inline uint8_t *nss_rule_batch_entry(struct nss_rule_batch *batch, struct nss_cmn_msg *ncm, uint16_t i)
+{
+	return (uint8_t *)ncm + batch->rb->ops->msg_entry + i * batch->layout->entry_size;
+}
+
+/*
+ * nss_rule_batch_free()
+ *	Free a rule batch.
+ */
+static void nss_rule_batch_free(struct nss_rule_batch *batch)
+{
+	kfree(batch->many);
+	kfree(batch->reply);
+	kfree(batch->cm);
+	kfree(batch);
+}
+
+/*
+ * nss_rule_batch_alloc()
+ *	Allocate a rule batch for rules of the given layout.
+ */
+static struct nss_rule_batch *nss_rule_batch_alloc(struct nss_rule_batcher *rb, struct nss_ctx_instance *nss_ctx,
+							const struct nss_rule_batch_layout *layout)
+{
+	struct nss_rule_batch *batch;
+
+	batch = kzalloc(sizeof(*batch), GFP_ATOMIC);
+	if (!batch) {
+		return NULL;
+	}
+
+	batch->rb = rb;
+	batch->nss_ctx = nss_ctx;
+	batch->layout = layout;
+	batch->max = (PAGE_SIZE - rb->ops->msg_entry) / layout->entry_size;
+	batch->cm = kcalloc(batch->max, sizeof(struct nss_cmn_msg), GFP_ATOMIC);
+	batch->reply = kmalloc(rb->ops->msg_size, GFP_ATOMIC);
+	batch->many = kzalloc(PAGE_SIZE, GFP_ATOMIC);
+	if (!batch->cm || !batch->reply || !batch->many) {
+		nss_rule_batch_free(batch);
+		return NULL;
+	}
+
+	return batch;
+}
+
+/*
+ * nss_rule_batch_reply()
+ *	Rebuild the single rule message of rule i in the reply buffer.
+ */
+static struct nss_cmn_msg *nss_rule_batch_reply(struct nss_rule_batch *batch, uint16_t i)
+{
+	struct nss_cmn_msg *reply = batch->reply;
+
+	*reply = batch->cm[i];
+	memcpy((uint8_t *)reply + batch->rb->ops->msg_rule, nss_rule_batch_entry(batch, batch->many, i) + batch->layout->entry_rule,
+			batch->layout->rule_size);
+	return reply;
+}
+
+/*
+ * nss_rule_batch_rule_done()
+ *	Hand a rule its response.
+ */
+static void nss_rule_batch_rule_done(struct nss_cmn_msg *reply, uint16_t response, uint16_t error)
+{
+	nss_rule_batch_msg_callback_t cb = (nss_rule_batch_msg_callback_t)reply->cb;
+
+	reply->response = response;
+	reply->error = error;
+	if (cb) {
+		cb((void *)reply->app_data, reply);
+	}
+}
+
+/*
+ * nss_rule_batch_complete()
+ *	Hand the result of every rule in a batch to its callback and free the batch.
+ *
+ * resp is the multiple rule response, or NULL if the batch could not be sent.
+ * Rules the response does not cover get its overall response instead.
+ */
+static void nss_rule_batch_complete(struct nss_rule_batch *batch, struct nss_cmn_msg *resp)
+{
+	const struct nss_rule_batch_ops *ops = batch->rb->ops;
+	struct nss_rule_many_status *status;
+	struct nss_cmn_msg *reply;
+	uint16_t count = 0;
+	uint16_t i;
+
+	if (resp && (resp->response == NSS_CMN_RESPONSE_ACK)) {
+		count = min(nss_rule_batch_hdr(batch, resp)->count, batch->count);
+	}
+
+	for (i = 0; i < batch->count; i++) {
+		reply = nss_rule_batch_reply(batch, i);
+		if (i < count) {
+			status = (struct nss_rule_many_status *)nss_rule_batch_entry(batch, resp, i);
+			if ((status->response == NSS_CMN_RESPONSE_ACK) && ops->rule_ack) {
+				ops->rule_ack(reply);
+			}
+
+			nss_rule_batch_rule_done(reply, status->response, status->error);
+		} else if (resp) {
+			nss_rule_batch_rule_done(reply, resp->response, resp->error);
+		} else {
+			nss_rule_batch_rule_done(reply, NSS_CMN_RESPONSE_EMSG, 0);
+		}
+	}
+
+	nss_rule_batch_free(batch);
+}
+
+/*
+ * nss_rule_batch_resend()
+ *	Send every rule of a rejected batch in a message of its own and free the batch.
+ */
+static void nss_rule_batch_resend(struct nss_rule_batch *batch)
+{
+	const struct nss_rule_batch_ops *ops = batch->rb->ops;
+	struct nss_cmn_msg *reply;
+	nss_tx_status_t status;
+	uint16_t i;
+
+	for (i = 0; i < batch->count; i++) {
+		reply = nss_rule_batch_reply(batch, i);
+		status = ops->tx(batch->nss_ctx, reply);
+		if (status != NSS_TX_SUCCESS) {
+			nss_warning("%px: %s rule msg tx failed: %d\n", batch->nss_ctx, ops->name, status);
+			nss_rule_batch_rule_done(reply, NSS_CMN_RESPONSE_EMSG, 0);
+		}
+	}
+
+	nss_rule_batch_free(batch);
+}
+
+/*
+ * nss_rule_batch_callback()
+ *	Handle the response to a multiple rule message.
+ */
+static void nss_rule_batch_callback(void *app_data, struct nss_cmn_msg *ncm)
+{
+	struct nss_rule_batch *batch = (struct nss_rule_batch *)app_data;
+	struct nss_rule_batcher *rb = batch->rb;
+	struct nss_rule_many_hdr *hdr = nss_rule_batch_hdr(batch, ncm);
+
+	if (ncm->response != NSS_CMN_RESPONSE_ACK) {
+		if ((ncm->error == rb->ops->unknown_msg_error) && !READ_ONCE(rb->single)) {
+			nss_warning("%px: firmware has no %s multiple rule messages, sending rules one by one\n",
+					batch->nss_ctx, rb->ops->name);
+			WRITE_ONCE(rb->single, true);
+		}
+
+		nss_rule_batch_resend(batch);
+		return;
+	}
+
+	/*
+	 * Sanity check the rule count against the size of this message
+	 */
+	if (rb->ops->msg_entry + hdr->count * batch->layout->entry_size > hdr->size) {
+		nss_warning("%px: rule many count %u exceeds the size of this msg %u\n", batch->nss_ctx,
+				hdr->count, hdr->size);
+		hdr->count = 0;
+	}
+
+	nss_rule_batch_complete(batch, ncm);
+}
+
+/*
+ * nss_rule_batch_send()
+ *	Send a rule batch as one multiple rule message.
+ */
+static nss_tx_status_t nss_rule_batch_send(struct nss_rule_batch *batch)
+{
+	const struct nss_rule_batch_ops *ops = batch->rb->ops;
+	struct nss_cmn_msg *many = batch->many;
+	struct nss_rule_many_hdr *hdr = nss_rule_batch_hdr(batch, many);
+	size_t size = ops->msg_entry + batch->count * batch->layout->entry_size;
+
+	nss_cmn_msg_init(many, ops->interface, batch->layout->many_type, sizeof(*hdr),
+			nss_rule_batch_callback, batch);
+	hdr->count = batch->count;
+	hdr->size = size;
+
+	/*
+	 * Trace messages.
+	 */
+	ops->log_tx(many);
+
+	return nss_core_send_cmd(batch->nss_ctx, many, size, size);
+}
+
+/*
+ * nss_rule_batch_work()
+ *	Send the pending rule batch at the end of its window.
+ */
+static void nss_rule_batch_work(struct work_struct *work)
+{
+	struct nss_rule_batcher *rb = container_of(work, struct nss_rule_batcher, work);
+	struct nss_rule_batch *batch;
+	nss_tx_status_t status = NSS_TX_SUCCESS;
+
+	spin_lock_bh(&rb->lock);
+	batch = rb->pending;
+	rb->pending = NULL;
+	if (batch) {
+		status = nss_rule_batch_send(batch);
+	}
+	spin_unlock_bh(&rb->lock);
+
+	if (batch && (status != NSS_TX_SUCCESS)) {
+		nss_warning("%px: %s rule many msg tx failed: %d\n", batch->nss_ctx, rb->ops->name, status);
+		nss_rule_batch_complete(batch, NULL);
+	}
+}
+
+/*
+ * nss_rule_batch_timer()
+ *	End of the window of the pending batch.
+ *
+ * Sending takes bottom half locks, so it is left to the work.
+ */
+static enum hrtimer_restart nss_rule_batch_timer(struct hrtimer *timer)
+{
+	struct nss_rule_batcher *rb = container_of(timer, struct nss_rule_batcher, timer);
+
+	queue_work(system_highpri_wq, &rb->work);
+	return HRTIMER_NORESTART;
+}
+
+/*
+ * nss_rule_batcher_queue()
+ *	Queue a create or destroy rule message to be sent with others.
+ *
+ * Batches are sent with the lock held so that they reach the command queue in
+ * the order their rules were queued. A batch that failed to go out is only
+ * completed after the lock is dropped, since its callbacks may queue rules.
+ */
+nss_tx_status_t nss_rule_batcher_queue(struct nss_rule_batcher *rb, struct nss_ctx_instance *nss_ctx,
+					struct nss_cmn_msg *ncm)
+{
+	const struct nss_rule_batch_ops *ops = rb->ops;
+	const struct nss_rule_batch_layout *layout;
+	struct nss_rule_batch *batch;
+	struct nss_rule_batch *failed[2] = {NULL, NULL};
+	nss_tx_status_t status;
+	uint32_t i;
+
+	if (ncm->interface != ops->interface) {
+		nss_warning("%px: tx request for another interface: %d", nss_ctx, ncm->interface);
+		return NSS_TX_FAILURE;
+	}
+
+	if (ncm->type == ops->create.type) {
+		layout = &ops->create;
+	} else if (ncm->type == ops->destroy.type) {
+		layout = &ops->destroy;
+	} else {
+		nss_warning("%px: message type can not be coalesced: %d", nss_ctx, ncm->type);
+		return NSS_TX_FAILURE_BAD_PARAM;
+	}
+
+	if (READ_ONCE(rb->single)) {
+		return ops->tx(nss_ctx, ncm);
+	}
+
+	spin_lock_bh(&rb->lock);
+
+	/*
+	 * A rule of another kind or for another core ends the pending batch,
+	 * so that a destroy is never sent ahead of the create it follows.
+	 */
+	batch = rb->pending;
+	if (batch && ((batch->layout != layout) || (batch->nss_ctx != nss_ctx))) {
+		rb->pending = NULL;
+		if (nss_rule_batch_send(batch) != NSS_TX_SUCCESS) {
+			failed[0] = batch;
+		}
+		batch = NULL;
+	}
+
+	if (!batch) {
+		batch = nss_rule_batch_alloc(rb, nss_ctx, layout);
+		if (!batch) {
+			spin_unlock_bh(&rb->lock);
+			nss_warning("%px: unable to allocate %s rule batch\n", nss_ctx, ops->name);
+			status = NSS_TX_FAILURE;
+			goto done;
+		}
+
+		rb->pending = batch;
+		hrtimer_start(&rb->timer, ns_to_ktime(NSS_RULE_BATCH_WINDOW_NS), HRTIMER_MODE_REL);
+	}
+
+	memcpy(nss_rule_batch_entry(batch, batch->many, batch->count) + layout->entry_rule,
+			(uint8_t *)ncm + ops->msg_rule, layout->rule_size);
+	batch->cm[batch->count++] = *ncm;
+	status = NSS_TX_SUCCESS;
+
+	if (batch->count == batch->max) {
+		rb->pending = NULL;
+		if (nss_rule_batch_send(batch) != NSS_TX_SUCCESS) {
+			failed[1] = batch;
+		}
+	}
+
+	spin_unlock_bh(&rb->lock);
+
+done:
+	for (i = 0; i < ARRAY_SIZE(failed); i++) {
+		if (failed[i]) {
+			nss_warning("%px: %s rule many msg tx failed\n", nss_ctx, ops->name);
+			nss_rule_batch_complete(failed[i], NULL);
+		}
+	}
+
+	return status;
+}
+
+/*
+ * nss_rule_batcher_init()
+ *	Initialize the batcher of a protocol.
+ */
+void nss_rule_batcher_init(struct nss_rule_batcher *rb, const struct nss_rule_batch_ops *ops)
+{
+	rb->ops = ops;
+	rb->pending = NULL;
+	rb->single = false;
+	spin_lock_init(&rb->lock);
+	hrtimer_init(&rb->timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	rb->timer.function = nss_rule_batch_timer;
+	INIT_WORK(&rb->work, nss_rule_batch_work);
+}
+
+/*
+ * nss_rule_batcher_exit()
+ *	Stop the window and fail the rules still waiting in it.
+ */
+void nss_rule_batcher_exit(struct nss_rule_batcher *rb)
+{
+	struct nss_rule_batch *batch;
+
+	if (!rb->ops) {
+		return;
+	}
+
+	hrtimer_cancel(&rb->timer);
+	cancel_work_sync(&rb->work);
+
+	spin_lock_bh(&rb->lock);
+	batch = rb->pending;
+	rb->pending = NULL;
+	spin_unlock_bh(&rb->lock);
+
+	if (batch) {
+		nss_rule_batch_complete(batch, NULL);
+	}
+}
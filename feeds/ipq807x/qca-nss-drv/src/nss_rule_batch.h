@@ -0,0 +1,104 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/*
+ * nss_rule_batch.h
+ *	Coalescing of rule create and destroy messages, shared by IPv4 and IPv6.
+ *
+ * A multiple rule message is laid out the same way for every protocol: a
+ * struct nss_rule_many_hdr at the start of the message payload, followed
+ * by an array of entries, each starting with a struct nss_rule_many_status
+ * and holding the rule as it appears in the single rule message. The ops of
+ * a protocol give the types, sizes and offsets; the batcher only copies
+ * bytes around.
+ */
+
+#ifndef __NSS_RULE_BATCH_H
+#define __NSS_RULE_BATCH_H
+
+#include <linux/hrtimer.h>
+#include <linux/workqueue.h>
+#include "nss_core.h"
+
+#define NSS_RULE_BATCH_WINDOW_NS	NSEC_PER_MSEC	/* Time a rule waits for others to share its message */
+
+/*
+ * Header of a multiple rule message
+ */
+struct nss_rule_many_hdr {
+	uint16_t count;			/* Number of rules in the message */
+	uint16_t size;			/* Buffer size of the message */
+};
+
+/*
+ * Result for one rule of a multiple rule message
+ */
+struct nss_rule_many_status {
+	uint16_t response;		/* Response for the rule, from nss_cmn_response */
+	uint16_t error;			/* Protocol error for the rule */
+};
+
+/*
+ * Layout of one kind of rule
+ */
+struct nss_rule_batch_layout {
+	uint32_t type;			/* Single rule message type */
+	uint32_t many_type;		/* Multiple rule message type */
+	size_t rule_size;		/* Size of the rule */
+	size_t entry_size;		/* Size of an entry of the multiple rule message */
+	size_t entry_rule;		/* Offset of the rule in an entry */
+};
+
+/*
+ * Protocol whose rules a batcher coalesces
+ */
+struct nss_rule_batch_ops {
+	const char *name;			/* Protocol name for warnings */
+	uint32_t interface;			/* Interface the rule messages go to */
+	uint32_t unknown_msg_error;		/* Error of a NACK for an unknown message type */
+	size_t msg_size;			/* Size of a protocol message */
+	size_t msg_rule;			/* Offset of the payload in a protocol message */
+	size_t msg_entry;			/* Offset of the entries in a multiple rule message */
+	struct nss_rule_batch_layout create;	/* Create rule messages */
+	struct nss_rule_batch_layout destroy;	/* Destroy rule messages */
+	void (*log_tx)(struct nss_cmn_msg *ncm);
+						/* Trace a message sent */
+	nss_tx_status_t (*tx)(struct nss_ctx_instance *nss_ctx, struct nss_cmn_msg *ncm);
+						/* Send a single rule message */
+	void (*rule_ack)(struct nss_cmn_msg *ncm);
+						/* A coalesced rule was accepted, may be NULL */
+};
+
+struct nss_rule_batch;
+
+/*
+ * Coalescing state of a protocol
+ */
+struct nss_rule_batcher {
+	const struct nss_rule_batch_ops *ops;	/* Protocol */
+	spinlock_t lock;			/* Protects pending and the send order */
+	struct nss_rule_batch *pending;		/* Batch being filled */
+	struct hrtimer timer;			/* Ends the window of the pending batch */
+	struct work_struct work;		/* Sends the pending batch once its window ended */
+	bool single;				/* Firmware has no multiple rule messages */
+};
+
+extern void nss_rule_batcher_init(struct nss_rule_batcher *rb, const struct nss_rule_batch_ops *ops);
+extern void nss_rule_batcher_exit(struct nss_rule_batcher *rb);
+extern nss_tx_status_t nss_rule_batcher_queue(struct nss_rule_batcher *rb, struct nss_ctx_instance *nss_ctx,
+						struct nss_cmn_msg *ncm);
+
+#endif /* __NSS_RULE_BATCH_H */
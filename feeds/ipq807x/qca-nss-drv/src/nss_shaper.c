@@ -80,10 +80,10 @@ void *nss_shaper_register_shaper_bounce_interface(uint32_t if_num, nss_shaper_bo
 	 */
 	reg = &nss_top->bounce_interface_registrants[if_num];
 	if (reg->registered) {
-		spin_unlock_bh(&nss_top->stats_lock);
+		spin_unlock_bh(&nss_top->lock);
 		module_put(owner);
 		nss_warning("Already registered: %u", if_num);
-		BUG_ON(false);
+		return NULL;
 	}
 
 	/*
@@ -125,9 +125,9 @@ void nss_shaper_unregister_shaper_bounce_interface(uint32_t if_num)
 	 */
 	reg = &nss_top->bounce_interface_registrants[if_num];
 	if (!reg->registered) {
-		spin_unlock_bh(&nss_top->stats_lock);
+		spin_unlock_bh(&nss_top->lock);
 		nss_warning("Already unregistered: %u", if_num);
-		BUG_ON(false);
+		return;
 	}
 
 	/*
@@ -185,10 +185,10 @@ void *nss_shaper_register_shaper_bounce_bridge(uint32_t if_num, nss_shaper_bounc
 	 */
 	reg = &nss_top->bounce_bridge_registrants[if_num];
 	if (reg->registered) {
-		spin_unlock_bh(&nss_top->stats_lock);
+		spin_unlock_bh(&nss_top->lock);
 		module_put(owner);
 		nss_warning("Already registered: %u", if_num);
-		BUG_ON(false);
+		return NULL;
 	}
 
 	/*
@@ -231,18 +231,18 @@ void nss_shaper_unregister_shaper_bounce_bridge(uint32_t if_num)
 	 */
 	reg = &nss_top->bounce_bridge_registrants[if_num];
 	if (!reg->registered) {
-		spin_unlock_bh(&nss_top->stats_lock);
+		spin_unlock_bh(&nss_top->lock);
 		nss_warning("Already unregistered: %u", if_num);
-		BUG_ON(false);
+		return;
 	}
 
 	/*
 	 * Wait until any bounce callback that is active is finished
 	 */
 	while (reg->callback_active) {
-		spin_unlock_bh(&nss_top->stats_lock);
+		spin_unlock_bh(&nss_top->lock);
 		yield();
-		spin_lock_bh(&nss_top->stats_lock);
+		spin_lock_bh(&nss_top->lock);
 	}
 
 	/*
@@ -283,7 +283,7 @@ nss_tx_status_t nss_shaper_bounce_interface_packet(void *ctx, uint32_t if_num, s
 	spin_lock_bh(&nss_top->lock);
 	reg = &nss_top->bounce_interface_registrants[if_num];
 	if (!reg->registered) {
-		spin_unlock_bh(&nss_top->stats_lock);
+		spin_unlock_bh(&nss_top->lock);
 		nss_warning("unregistered: %u", if_num);
 		return NSS_TX_FAILURE;
 	}
@@ -327,7 +327,7 @@ nss_tx_status_t nss_shaper_bounce_bridge_packet(void *ctx, uint32_t if_num, stru
 	spin_lock_bh(&nss_top->lock);
 	reg = &nss_top->bounce_bridge_registrants[if_num];
 	if (!reg->registered) {
-		spin_unlock_bh(&nss_top->stats_lock);
+		spin_unlock_bh(&nss_top->lock);
 		nss_warning("unregistered: %u", if_num);
 		return NSS_TX_FAILURE;
 	}
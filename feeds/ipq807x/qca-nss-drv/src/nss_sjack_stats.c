@@ -80,7 +80,7 @@ void nss_sjack_stats_node_sync(struct nss_ctx_instance *nss_ctx, struct nss_sjac
 	/*
 	 * Update SJACK node stats.
 	 */
-	spin_lock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_begin(&nss_stats_node_domain);
 	nss_top->stats_node[NSS_SJACK_INTERFACE][NSS_SJACK_STATS_RX_PKTS] += nins->node_stats.rx_packets;
 	nss_top->stats_node[NSS_SJACK_INTERFACE][NSS_SJACK_STATS_RX_BYTES] += nins->node_stats.rx_bytes;
 	nss_top->stats_node[NSS_SJACK_INTERFACE][NSS_SJACK_STATS_TX_PKTS] += nins->node_stats.tx_packets;
@@ -90,5 +90,5 @@ void nss_sjack_stats_node_sync(struct nss_ctx_instance *nss_ctx, struct nss_sjac
 		nss_top->stats_node[NSS_SJACK_INTERFACE][NSS_SJACK_STATS_RX_QUEUE_0_DROPPED + j] += nins->node_stats.rx_dropped[j];
 	}
 
-	spin_unlock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_end(&nss_stats_node_domain);
 }
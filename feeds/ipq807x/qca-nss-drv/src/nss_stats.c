@@ -178,19 +178,59 @@ void nss_stats_clean(void)
 	}
 }
 
+/*
+ * Statistics domain of the common node statistics of unclaimed interfaces
+ */
+struct nss_stats_domain nss_stats_node_domain = NSS_STATS_DOMAIN_INIT(nss_stats_node_domain);
+
+/*
+ * Statistics domain that updates the common node statistics of each
+ * interface, or NULL when they are updated under nss_stats_node_domain
+ */
+static struct nss_stats_domain *nss_stats_node_owner[NSS_MAX_NET_INTERFACES];
+
+/*
+ * nss_stats_domain_own_node()
+ *	Claim the common node statistics of an interface for a statistics domain.
+ *
+ * Must be called before the sync handler of the interface is registered.
+ */
+void nss_stats_domain_own_node(struct nss_stats_domain *domain, uint32_t if_num)
+{
+	if (unlikely(if_num >= NSS_MAX_NET_INTERFACES)) {
+		return;
+	}
+
+	WRITE_ONCE(nss_stats_node_owner[if_num], domain);
+}
+
+/*
+ * nss_stats_node_domain_get()
+ *	Get the statistics domain of the common node statistics of an interface.
+ */
+static struct nss_stats_domain *nss_stats_node_domain_get(uint32_t if_num)
+{
+	struct nss_stats_domain *domain = READ_ONCE(nss_stats_node_owner[if_num]);
+
+	return domain ? domain : &nss_stats_node_domain;
+}
+
 /*
  * nss_stats_reset_common_stats()
  *	Reset common node statistics.
  */
 void nss_stats_reset_common_stats(uint32_t if_num)
 {
+	struct nss_stats_domain *domain;
+
 	if (unlikely(if_num >= NSS_MAX_NET_INTERFACES)) {
 		return;
 	}
 
-	spin_lock_bh(&nss_top_main.stats_lock);
+	domain = nss_stats_node_domain_get(if_num);
+	nss_stats_domain_write_begin(domain);
 	memset(nss_top_main.stats_node[if_num], 0, NSS_STATS_NODE_MAX * sizeof(uint64_t));
-	spin_unlock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_write_end(domain);
 }
 
 /*
@@ -198,18 +238,71 @@ void nss_stats_reset_common_stats(uint32_t if_num)
  *	Fill common node statistics.
  */
 size_t nss_stats_fill_common_stats(uint32_t if_num, int instance, char *lbuf, size_t size_wr, size_t size_al, char *node)
+{
+	return nss_stats_domain_fill_common_stats(nss_stats_node_domain_get(if_num), if_num, instance, lbuf, size_wr, size_al, node);
+}
+
+/*
+ * nss_stats_domain_fill_common_stats()
+ *	Fill common node statistics of an interface whose sync handler updates them under a statistics domain.
+ */
+size_t nss_stats_domain_fill_common_stats(struct nss_stats_domain *domain, uint32_t if_num, int instance, char *lbuf, size_t size_wr, size_t size_al, char *node)
 {
 	uint64_t stats_val[NSS_STATS_NODE_MAX];
+	size_t orig_size_wr = size_wr;
+
+	nss_stats_domain_copy(domain, stats_val, nss_top_main.stats_node[if_num], sizeof(stats_val));
+	size_wr += nss_stats_print(node, NULL, instance, nss_strings_stats_node, stats_val, NSS_STATS_NODE_MAX, lbuf, size_wr, size_al);
+	return size_wr - orig_size_wr;
+}
+
+/*
+ * nss_stats_conn_sync_commit()
+ *	Commit connection sync counters summed by NSS_STATS_CONN_SYNC_ACCUMULATE().
+ *
+ * stats points to the first of the NSS_STATS_CONN_SYNC_MAX accelerated counters
+ * of the subsystem. The time since start, which the caller took before it started
+ * summing the message, is accounted in hist.
+ */
+void nss_stats_conn_sync_commit(struct nss_stats_domain *domain, uint64_t *stats, uint64_t *sum, struct nss_stats_hist *hist, ktime_t start)
+{
 	int i;
+
+	nss_stats_domain_write_begin(domain);
+	for (i = 0; i < NSS_STATS_CONN_SYNC_MAX; i++) {
+		stats[i] += sum[i];
+	}
+
+	nss_stats_hist_add(hist, ktime_to_ns(ktime_sub(ktime_get(), start)));
+	nss_stats_domain_write_end(domain);
+}
+
+/*
+ * nss_stats_hist_print()
+ *	Helper API to print a duration histogram.
+ */
+size_t nss_stats_hist_print(char *node, char *stat_details, struct nss_stats_hist *hist, char *lbuf, size_t size_wr, size_t size_al)
+{
+	uint32_t i;
 	size_t orig_size_wr = size_wr;
 
-	spin_lock_bh(&nss_top_main.stats_lock);
-	for (i = 0; i < NSS_STATS_NODE_MAX; i++) {
-		stats_val[i] = nss_top_main.stats_node[if_num][i];
+	size_wr += scnprintf(lbuf + size_wr, size_al - size_wr, "\n#%s\n\n", stat_details);
+	for (i = 0; i < NSS_STATS_HIST_BUCKETS; i++) {
+		if (nonzero_stats_print == 1 && hist->bucket[i] == 0) {
+			continue;
+		}
+
+		if (i == 0) {
+			size_wr += scnprintf(lbuf + size_wr, size_al - size_wr, "\t%s_time[<1us]", node);
+		} else if (i == NSS_STATS_HIST_BUCKETS - 1) {
+			size_wr += scnprintf(lbuf + size_wr, size_al - size_wr, "\t%s_time[>=%uus]", node, 1U << (i - 1));
+		} else {
+			size_wr += scnprintf(lbuf + size_wr, size_al - size_wr, "\t%s_time[%u-%uus]", node, 1U << (i - 1), 1U << i);
+		}
+
+		size_wr += scnprintf(lbuf + size_wr, size_al - size_wr, " = %llu\n", hist->bucket[i]);
 	}
 
-	spin_unlock_bh(&nss_top_main.stats_lock);
-	size_wr += nss_stats_print(node, NULL, instance, nss_strings_stats_node, stats_val, NSS_STATS_NODE_MAX, lbuf, size_wr, size_al);
 	return size_wr - orig_size_wr;
 }
 
@@ -382,6 +475,109 @@ void nss_stats_create_dentry(char *name, const struct file_operations *ops)
 	}
 }
 
+/*
+ * nss_stats_bin_alloc()
+ *	Allocate a binary statistics buffer for up to max_blocks blocks holding num_counters counters in total.
+ *
+ * The header is filled in; size_wr is set past it.
+ */
+char *nss_stats_bin_alloc(uint16_t max_blocks, size_t num_counters, size_t *size_al, size_t *size_wr)
+{
+	struct nss_stats_bin_hdr *hdr;
+	char *buf;
+
+	*size_al = sizeof(*hdr) + (max_blocks * sizeof(struct nss_stats_bin_block)) + (num_counters * sizeof(uint64_t));
+	buf = kzalloc(*size_al, GFP_KERNEL);
+	if (unlikely(!buf)) {
+		nss_warning("Could not allocate memory for binary statistics buffer");
+		return NULL;
+	}
+
+	hdr = (struct nss_stats_bin_hdr *)buf;
+	hdr->magic = NSS_STATS_BIN_MAGIC;
+	hdr->version = NSS_STATS_BIN_VERSION;
+	*size_wr = sizeof(*hdr);
+	return buf;
+}
+
+/*
+ * nss_stats_bin_add_block()
+ *	Append a block of num_counters counters and return where the caller should write them.
+ */
+uint64_t *nss_stats_bin_add_block(char *buf, size_t *size_wr, size_t size_al, uint32_t num_counters)
+{
+	struct nss_stats_bin_hdr *hdr = (struct nss_stats_bin_hdr *)buf;
+	struct nss_stats_bin_block *block;
+	size_t len = sizeof(*block) + (num_counters * sizeof(uint64_t));
+
+	if (unlikely(*size_wr + len > size_al)) {
+		nss_warning("%px: no room for a block of %u counters", buf, num_counters);
+		return NULL;
+	}
+
+	block = (struct nss_stats_bin_block *)(buf + *size_wr);
+	block->num_counters = num_counters;
+	hdr->num_blocks++;
+	*size_wr += len;
+	return (uint64_t *)(block + 1);
+}
+
+/*
+ * nss_stats_bin_create_dentry()
+ *	Create binary statistics debug entry for subsystem.
+ */
+void nss_stats_bin_create_dentry(char *name, const struct file_operations *ops)
+{
+	if (!nss_top_main.stats_bin_dentry) {
+		return;
+	}
+
+	if (!debugfs_create_file(name, 0400, nss_top_main.stats_bin_dentry, &nss_top_main, ops)) {
+		nss_warning("Failed to create binary debug entry for subsystem %s\n", name);
+	}
+}
+
+/*
+ * nss_node_stats_bin_read()
+ *	Read the common node statistics of all interfaces in binary form.
+ *
+ * Block i holds the common node stats of interface i, so the blocks of
+ * successive snapshots line up.
+ */
+static ssize_t nss_node_stats_bin_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos)
+{
+	size_t size_al, size_wr;
+	ssize_t bytes_read;
+	uint64_t *counters;
+	uint32_t if_num;
+	char *buf;
+
+	buf = nss_stats_bin_alloc(NSS_MAX_NET_INTERFACES, NSS_MAX_NET_INTERFACES * NSS_STATS_NODE_MAX, &size_al, &size_wr);
+	if (unlikely(!buf)) {
+		return 0;
+	}
+
+	for (if_num = 0; if_num < NSS_MAX_NET_INTERFACES; if_num++) {
+		counters = nss_stats_bin_add_block(buf, &size_wr, size_al, NSS_STATS_NODE_MAX);
+		if (unlikely(!counters)) {
+			break;
+		}
+
+		nss_stats_domain_copy(nss_stats_node_domain_get(if_num), counters, nss_top_main.stats_node[if_num],
+					NSS_STATS_NODE_MAX * sizeof(uint64_t));
+	}
+
+	bytes_read = simple_read_from_buffer(ubuf, sz, ppos, buf, size_wr);
+	kfree(buf);
+
+	return bytes_read;
+}
+
+/*
+ * node_stats_bin_ops
+ */
+NSS_STATS_BIN_DECLARE_FILE_OPERATIONS(node);
+
 /*
  * TODO: Move the rest of the code to (nss_wt_stats.c, nss_gmac_stats.c) accordingly.
  */
@@ -396,6 +592,11 @@ NSS_STATS_DECLARE_FILE_OPERATIONS(gmac);
  */
 NSS_STATS_DECLARE_FILE_OPERATIONS(wt);
 
+/*
+ * wt_stats_bin_ops
+ */
+NSS_STATS_BIN_DECLARE_FILE_OPERATIONS(wt);
+
 /*
  * nss_stats_init()
  *	Enable NSS statistics.
@@ -432,6 +633,11 @@ void nss_stats_init(void)
 		return;
 	}
 
+	nss_top_main.stats_bin_dentry = debugfs_create_dir("stats_bin", nss_top_main.top_dentry);
+	if (unlikely(nss_top_main.stats_bin_dentry == NULL)) {
+		nss_warning("Failed to create qca-nss-drv/stats_bin directory in debugfs");
+	}
+
 	/*
 	 * Create files to obtain statistics.
 	 */
@@ -446,6 +652,11 @@ void nss_stats_init(void)
 	 */
 	nss_stats_create_dentry("gmac", &nss_gmac_stats_ops);
 
+	/*
+	 * Common node stats of all interfaces
+	 */
+	nss_stats_bin_create_dentry("node", &nss_node_stats_bin_ops);
+
 	/*
 	 * Per-project stats
 	 */
@@ -475,6 +686,16 @@ void nss_stats_init(void)
 			nss_warning("Failed to create qca-nss-drv/stats/project/core%d/worker_threads file in debugfs", i);
 			return;
 		}
+
+		wt_dentry = debugfs_create_file("worker_threads_bin",
+						0400,
+						core_dentry,
+						&(nss_top_main.nss[i]),
+						&nss_wt_stats_bin_ops);
+		if (unlikely(wt_dentry == NULL)) {
+			nss_warning("Failed to create qca-nss-drv/stats/project/core%d/worker_threads_bin file in debugfs", i);
+			return;
+		}
 	}
 
 	nss_log_init();
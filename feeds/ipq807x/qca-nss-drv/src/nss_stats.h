@@ -22,9 +22,13 @@
 #ifndef __NSS_STATS_PRINT_H
 #define __NSS_STATS_PRINT_H
 #include <linux/ctype.h>
+#include <linux/seqlock.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
 #include <nss_drv_stats.h>
 #include <nss_def.h>
 #include <nss_stats_public.h>
+#include <nss_stats_bin.h>
 
 /*
  * Defines to be used by single instance/core packages.
@@ -45,6 +49,14 @@ static const struct file_operations nss_##name##_stats_ops = { \
 	.release = nss_stats_release, \
 };
 
+#define NSS_STATS_BIN_DECLARE_FILE_OPERATIONS(name) \
+static const struct file_operations nss_##name##_stats_bin_ops = { \
+	.open = nss_stats_open, \
+	.read = nss_##name##_stats_bin_read, \
+	.llseek = generic_file_llseek, \
+	.release = nss_stats_release, \
+};
+
 /*
  * Private data for every file descriptor
  */
@@ -64,6 +76,126 @@ struct nss_stats_info {
 	enum nss_stats_types stats_type;		/* enum that tags stat type  */
 };
 
+/*
+ * Statistics domain.
+ *
+ * Every subsystem serializes its sync handlers on its own domain, so
+ * subsystems never contend with each other. Readers copy a snapshot and retry
+ * if a sync raced with them; a reader that cannot restart takes the domain
+ * read lock instead.
+ *
+ * A domain that updates the common node statistics of an interface must claim
+ * it with nss_stats_domain_own_node(), so that the common helpers use the
+ * domain for that interface too. The common node statistics of unclaimed
+ * interfaces are updated under nss_stats_node_domain.
+ */
+struct nss_stats_domain {
+	seqlock_t lock;		/* Serializes writers, versions readers */
+};
+
+#define NSS_STATS_DOMAIN_INIT(name) { .lock = __SEQLOCK_UNLOCKED(name.lock) }
+
+/*
+ * nss_stats_domain_write_begin()
+ *	Start updating statistics of a domain.
+ */
+static inline void nss_stats_domain_write_begin(struct nss_stats_domain *domain)
+{
+	write_seqlock_bh(&domain->lock);
+}
+
+/*
+ * nss_stats_domain_write_end()
+ *	Finish updating statistics of a domain.
+ */
+static inline void nss_stats_domain_write_end(struct nss_stats_domain *domain)
+{
+	write_sequnlock_bh(&domain->lock);
+}
+
+/*
+ * nss_stats_domain_copy()
+ *	Take a consistent snapshot of len bytes of domain statistics.
+ */
+static inline void nss_stats_domain_copy(struct nss_stats_domain *domain, void *dst, const void *src, size_t len)
+{
+	unsigned int seq;
+
+	do {
+		seq = read_seqbegin(&domain->lock);
+		memcpy(dst, src, len);
+	} while (read_seqretry(&domain->lock, seq));
+}
+
+/*
+ * nss_stats_domain_read_lock()
+ *	Keep the statistics of a domain from changing while a reader walks them.
+ */
+static inline void nss_stats_domain_read_lock(struct nss_stats_domain *domain)
+{
+	read_seqlock_excl_bh(&domain->lock);
+}
+
+/*
+ * nss_stats_domain_read_unlock()
+ *	Let the sync handlers of a domain update its statistics again.
+ */
+static inline void nss_stats_domain_read_unlock(struct nss_stats_domain *domain)
+{
+	read_sequnlock_excl_bh(&domain->lock);
+}
+
+/*
+ * Log2 histogram of durations.
+ *
+ * Bucket 0 counts durations below 1us, bucket i counts [2^(i-1), 2^i) us
+ * and the last bucket is open ended.
+ */
+#define NSS_STATS_HIST_BUCKETS 16
+
+struct nss_stats_hist {
+	uint64_t bucket[NSS_STATS_HIST_BUCKETS];
+};
+
+/*
+ * nss_stats_hist_add()
+ *	Account a duration given in nanoseconds.
+ */
+static inline void nss_stats_hist_add(struct nss_stats_hist *hist, uint64_t ns)
+{
+	uint32_t i = fls64(div_u64(ns, NSEC_PER_USEC));
+
+	if (i >= NSS_STATS_HIST_BUCKETS) {
+		i = NSS_STATS_HIST_BUCKETS - 1;
+	}
+
+	hist->bucket[i]++;
+}
+
+/*
+ * Accelerated connection counters carried by IPv4 and IPv6 conn_sync messages.
+ * Both keep them at the head of their special stats in this order.
+ */
+enum nss_stats_conn_sync_types {
+	NSS_STATS_CONN_SYNC_RX_PKTS,
+	NSS_STATS_CONN_SYNC_RX_BYTES,
+	NSS_STATS_CONN_SYNC_TX_PKTS,
+	NSS_STATS_CONN_SYNC_TX_BYTES,
+	NSS_STATS_CONN_SYNC_MAX,
+};
+
+/*
+ * NSS_STATS_CONN_SYNC_ACCUMULATE()
+ *	Add one nss_ipv4_conn_sync/nss_ipv6_conn_sync entry to a local sum.
+ */
+#define NSS_STATS_CONN_SYNC_ACCUMULATE(sum, cs) \
+	do { \
+		(sum)[NSS_STATS_CONN_SYNC_RX_PKTS] += (cs)->flow_rx_packet_count + (cs)->return_rx_packet_count; \
+		(sum)[NSS_STATS_CONN_SYNC_RX_BYTES] += (cs)->flow_rx_byte_count + (cs)->return_rx_byte_count; \
+		(sum)[NSS_STATS_CONN_SYNC_TX_PKTS] += (cs)->flow_tx_packet_count + (cs)->return_tx_packet_count; \
+		(sum)[NSS_STATS_CONN_SYNC_TX_BYTES] += (cs)->flow_tx_byte_count + (cs)->return_tx_byte_count; \
+	} while (0)
+
 extern void nss_stats_register_sysctl(void);
 void nss_stats_init(void);
 extern int nss_stats_release(struct inode *inode, struct file *filp);
@@ -71,6 +203,14 @@ extern int nss_stats_open(struct inode *inode, struct file *filp);
 void nss_stats_create_dentry(char *name, const struct file_operations *ops);
 extern void nss_stats_reset_common_stats(uint32_t if_num);
 extern size_t nss_stats_fill_common_stats(uint32_t if_num, int instance, char *lbuf, size_t size_wr, size_t size_al, char *node);
+extern struct nss_stats_domain nss_stats_node_domain;
+extern void nss_stats_domain_own_node(struct nss_stats_domain *domain, uint32_t if_num);
+extern size_t nss_stats_domain_fill_common_stats(struct nss_stats_domain *domain, uint32_t if_num, int instance, char *lbuf, size_t size_wr, size_t size_al, char *node);
+extern void nss_stats_conn_sync_commit(struct nss_stats_domain *domain, uint64_t *stats, uint64_t *sum, struct nss_stats_hist *hist, ktime_t start);
+extern char *nss_stats_bin_alloc(uint16_t max_blocks, size_t num_counters, size_t *size_al, size_t *size_wr);
+extern uint64_t *nss_stats_bin_add_block(char *buf, size_t *size_wr, size_t size_al, uint32_t num_counters);
+extern void nss_stats_bin_create_dentry(char *name, const struct file_operations *ops);
+extern size_t nss_stats_hist_print(char *node, char *stat_details, struct nss_stats_hist *hist, char *lbuf, size_t size_wr, size_t size_al);
 extern size_t nss_stats_banner(char *lbuf , size_t size_wr, size_t size_al, char *node, int core);
 extern size_t nss_stats_print(char *node, char *stat_details, int instance, struct nss_stats_info *stats_info, uint64_t *stats_val, uint16_t max, char *lbuf, size_t size_wr, size_t size_al);
 #endif /* __NSS_STATS_H */
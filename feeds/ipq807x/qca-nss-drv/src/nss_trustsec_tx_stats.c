@@ -28,6 +28,11 @@ struct nss_stats_info nss_trustsec_tx_stats_str[NSS_TRUSTSEC_TX_STATS_MAX] = {
 	{"HEADROOM_NOT_ENOUGH"	, NSS_STATS_TYPE_ERROR}
 };
 
+/*
+ * Statistics domain for TrustSec Tx; the sync handler below updates under it.
+ */
+static struct nss_stats_domain nss_trustsec_tx_stats_domain = NSS_STATS_DOMAIN_INIT(nss_trustsec_tx_stats_domain);
+
 /*
  * trustsec_tx_stats
  *	Trustsec TX statistics.
@@ -47,7 +52,7 @@ void nss_trustsec_tx_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss_tru
 	struct nss_top_instance *nss_top = nss_ctx->nss_top;
 	int j;
 
-	spin_lock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_begin(&nss_trustsec_tx_stats_domain);
 
 	/*
 	 * Update common node stats
@@ -68,7 +73,7 @@ void nss_trustsec_tx_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss_tru
 	trustsec_tx_stats[NSS_TRUSTSEC_TX_STATS_UNCONFIGURED_SRC] += ntsm->unconfigured_src;
 	trustsec_tx_stats[NSS_TRUSTSEC_TX_STATS_HEADROOM_NOT_ENOUGH] += ntsm->headroom_not_enough;
 
-	spin_unlock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_end(&nss_trustsec_tx_stats_domain);
 }
 
 /*
@@ -77,8 +82,6 @@ void nss_trustsec_tx_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss_tru
  */
 static ssize_t nss_trustsec_tx_stats_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos)
 {
-	int32_t i;
-
 	/*
 	 * Max output lines = #stats + few blank lines for banner printing +
 	 * Number of Extra outputlines for future reference to add new stats.
@@ -112,12 +115,7 @@ static ssize_t nss_trustsec_tx_stats_read(struct file *fp, char __user *ubuf, si
 	/*
 	 * TrustSec TX node stats
 	 */
-	spin_lock_bh(&nss_top_main.stats_lock);
-	for (i = 0; (i < NSS_TRUSTSEC_TX_STATS_MAX); i++) {
-		stats_shadow[i] = trustsec_tx_stats[i];
-	}
-
-	spin_unlock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_copy(&nss_trustsec_tx_stats_domain, stats_shadow, trustsec_tx_stats, sizeof(*stats_shadow) * NSS_TRUSTSEC_TX_STATS_MAX);
 	size_wr += nss_stats_print("trustsec_tx", NULL, NSS_STATS_SINGLE_INSTANCE
 					, nss_trustsec_tx_stats_str
 					, stats_shadow
@@ -141,5 +139,10 @@ NSS_STATS_DECLARE_FILE_OPERATIONS(trustsec_tx)
  */
 void nss_trustsec_tx_stats_dentry_create(void)
 {
+	/*
+	 * The node sync handler updates the common node stats under the domain
+	 */
+	nss_stats_domain_own_node(&nss_trustsec_tx_stats_domain, NSS_TRUSTSEC_TX_INTERFACE);
+
 	nss_stats_create_dentry("trustsec_tx", &nss_trustsec_tx_stats_ops);
 }
@@ -94,7 +94,7 @@ void nss_tunipip6_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss_tunipi
 	uint64_t i, *dest;
 	uint32_t *src;
 
-	spin_lock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_begin(&nss_stats_node_domain);
 
 	/*
 	 * Update common node stats
@@ -105,7 +105,7 @@ void nss_tunipip6_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss_tunipi
 		*dest++ = *src++;
 	}
 
-	spin_unlock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_end(&nss_stats_node_domain);
 
 }
 
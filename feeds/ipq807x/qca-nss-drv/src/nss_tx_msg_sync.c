@@ -22,27 +22,20 @@
 #include "nss_tx_rx_common.h"
 
 /*
- * nss_tx_msg_sync_callback()
- *	Internal callback used to handle the message response.
+ * nss_tx_msg_sync_copy_response()
+ *	Copy the response of a return message back to the caller-build message.
  */
-static void nss_tx_msg_sync_callback(void *app_data, struct nss_cmn_msg *ncm)
+static nss_tx_status_t nss_tx_msg_sync_copy_response(struct nss_cmn_msg *original_msg, struct nss_cmn_msg *ncm,
+							uint32_t resp_offset, uint32_t copy_len)
 {
-	uint32_t resp_offset;
-
-	/*
-	 * Per-message sync data was used as app_data.
-	 * Retrieve the address of the original message from it.
-	 */
-	struct nss_tx_msg_sync_cmn_data *sync_data = (struct nss_tx_msg_sync_cmn_data *)app_data;
-	struct nss_cmn_msg *original_msg = (struct nss_cmn_msg *)sync_data->original_msg;
+	nss_tx_status_t status = NSS_TX_SUCCESS;
 
 	/*
 	 * Set TX status. And Copy back ncm->error and ncm->response if it is NACK.
 	 */
-	sync_data->status = NSS_TX_SUCCESS;
 	if (ncm->response != NSS_CMN_RESPONSE_ACK) {
 		nss_warning("Tx msg sync error response %d\n", ncm->response);
-		sync_data->status = NSS_TX_FAILURE_SYNC_FW_ERR;
+		status = NSS_TX_FAILURE_SYNC_FW_ERR;
 		original_msg->error = ncm->error;
 		original_msg->response = ncm->response;
 	}
@@ -55,12 +48,30 @@ static void nss_tx_msg_sync_callback(void *app_data, struct nss_cmn_msg *ncm)
 	 * the return message. So the caller can use response in their context
 	 * once wake up instead of calling a passed-in user callback here.
 	 */
-	resp_offset = sync_data->resp_offset + sizeof(struct nss_cmn_msg);
+	resp_offset += sizeof(struct nss_cmn_msg);
 
-	if (sync_data->copy_len > 0)
+	if (copy_len > 0)
 		memcpy((uint8_t *)((nss_ptr_t)original_msg + resp_offset),
 			(uint8_t *)((nss_ptr_t)ncm + resp_offset),
-			sync_data->copy_len);
+			copy_len);
+
+	return status;
+}
+
+/*
+ * nss_tx_msg_sync_callback()
+ *	Internal callback used to handle the message response.
+ */
+static void nss_tx_msg_sync_callback(void *app_data, struct nss_cmn_msg *ncm)
+{
+	/*
+	 * Per-message sync data was used as app_data.
+	 * Retrieve the address of the original message from it.
+	 */
+	struct nss_tx_msg_sync_cmn_data *sync_data = (struct nss_tx_msg_sync_cmn_data *)app_data;
+	struct nss_cmn_msg *original_msg = (struct nss_cmn_msg *)sync_data->original_msg;
+
+	sync_data->status = nss_tx_msg_sync_copy_response(original_msg, ncm, sync_data->resp_offset, sync_data->copy_len);
 
 	/*
 	 * Wake up the caller
@@ -195,3 +206,247 @@ nss_tx_status_t nss_tx_msg_sync_with_size(struct nss_ctx_instance *nss_ctx,
 					msg_buf_size, &sync_data, ncm, timeout);
 }
 EXPORT_SYMBOL(nss_tx_msg_sync_with_size);
+
+/*
+ * nss_tx_msg_txn_put()
+ *	Drop a reference to a transaction.
+ */
+static void nss_tx_msg_txn_put(struct nss_tx_msg_txn *txn)
+{
+	if (atomic_dec_and_test(&txn->refcnt)) {
+		kfree(txn);
+	}
+}
+
+/*
+ * nss_tx_msg_txn_abandon()
+ *	Stop accepting responses into the caller's messages.
+ */
+static void nss_tx_msg_txn_abandon(struct nss_tx_msg_txn *txn)
+{
+	spin_lock_bh(&txn->lock);
+	txn->abandoned = true;
+	spin_unlock_bh(&txn->lock);
+}
+
+/*
+ * nss_tx_msg_txn_callback()
+ *	Internal callback used to handle the response of a transaction message.
+ */
+static void nss_tx_msg_txn_callback(void *app_data, struct nss_cmn_msg *ncm)
+{
+	struct nss_tx_msg_txn_entry *entry = (struct nss_tx_msg_txn_entry *)app_data;
+	struct nss_tx_msg_txn *txn = entry->txn;
+
+	/*
+	 * The caller may have given up on the transaction and released its
+	 * messages; only touch them while it is still waiting.
+	 */
+	spin_lock_bh(&txn->lock);
+	if (!txn->abandoned) {
+		entry->status = nss_tx_msg_sync_copy_response((struct nss_cmn_msg *)entry->original_msg, ncm,
+								entry->resp_offset, entry->copy_len);
+	}
+	spin_unlock_bh(&txn->lock);
+
+	atomic_dec(&txn->in_flight);
+	wake_up(&txn->wait);
+	nss_tx_msg_txn_put(txn);
+}
+
+/*
+ * nss_tx_msg_txn_add_internal()
+ *	Internal call for sending a transaction message.
+ */
+static nss_tx_status_t nss_tx_msg_txn_add_internal(struct nss_tx_msg_txn *txn,
+						nss_tx_msg_sync_subsys_async_t tx_msg_async,
+						nss_tx_msg_sync_subsys_async_with_size_t tx_msg_async_with_size,
+						uint32_t msg_buf_size, struct nss_cmn_msg *ncm,
+						uint32_t resp_offset, uint32_t copy_len)
+{
+	struct nss_ctx_instance *nss_ctx = txn->nss_ctx;
+	struct nss_tx_msg_txn_entry *entry;
+	nss_tx_status_t status;
+	long ret;
+
+	if (txn->num_msgs >= txn->max_msgs) {
+		nss_warning("%px: Tx msg transaction full: %u messages\n", nss_ctx, txn->max_msgs);
+		return NSS_TX_FAILURE_SYNC_BAD_PARAM;
+	}
+
+	/*
+	 * Sleep while the in-flight limit is reached. Every response wakes us up.
+	 */
+	ret = wait_event_timeout(txn->wait, atomic_read(&txn->in_flight) < txn->max_in_flight,
+					msecs_to_jiffies(txn->timeout));
+	if (!ret) {
+		nss_warning("%px: Tx msg transaction timeout waiting for in-flight messages\n", nss_ctx);
+		return NSS_TX_FAILURE_SYNC_TIMEOUT;
+	}
+
+	entry = &txn->entries[txn->num_msgs++];
+	entry->txn = txn;
+	entry->original_msg = (void *)ncm;
+	entry->resp_offset = resp_offset;
+	entry->copy_len = copy_len;
+	entry->status = NSS_TX_FAILURE_SYNC_TIMEOUT;
+
+	ncm->cb = (nss_ptr_t)nss_tx_msg_txn_callback;
+	ncm->app_data = (nss_ptr_t)entry;
+
+	/*
+	 * The message holds a reference until its response is handled.
+	 */
+	atomic_inc(&txn->refcnt);
+	atomic_inc(&txn->in_flight);
+
+	if (tx_msg_async)
+		status = tx_msg_async(nss_ctx, ncm);
+	else
+		status = tx_msg_async_with_size(nss_ctx, ncm, msg_buf_size);
+
+	if (status != NSS_TX_SUCCESS) {
+		nss_warning("%px: Tx msg async failed\n", nss_ctx);
+		entry->status = status;
+		atomic_dec(&txn->in_flight);
+		nss_tx_msg_txn_put(txn);
+	}
+
+	return status;
+}
+
+/*
+ * nss_tx_msg_txn_alloc()
+ *	Allocate a transaction for up to max_msgs messages.
+ */
+struct nss_tx_msg_txn *nss_tx_msg_txn_alloc(struct nss_ctx_instance *nss_ctx, uint32_t max_msgs,
+				uint32_t max_in_flight, uint32_t timeout)
+{
+	struct nss_tx_msg_txn *txn;
+
+	NSS_VERIFY_CTX_MAGIC(nss_ctx);
+
+	if (!max_msgs) {
+		nss_warning("%px: empty Tx msg transaction\n", nss_ctx);
+		return NULL;
+	}
+
+	txn = kzalloc(sizeof(*txn) + max_msgs * sizeof(struct nss_tx_msg_txn_entry), GFP_KERNEL);
+	if (!txn) {
+		nss_warning("%px: failed to allocate Tx msg transaction of %u messages\n", nss_ctx, max_msgs);
+		return NULL;
+	}
+
+	txn->nss_ctx = nss_ctx;
+	spin_lock_init(&txn->lock);
+	init_waitqueue_head(&txn->wait);
+	atomic_set(&txn->in_flight, 0);
+	atomic_set(&txn->refcnt, 1);
+	txn->max_in_flight = max_in_flight ? max_in_flight : NSS_TX_MSG_TXN_DEFAULT_IN_FLIGHT;
+	txn->timeout = timeout;
+	txn->max_msgs = max_msgs;
+
+	return txn;
+}
+EXPORT_SYMBOL(nss_tx_msg_txn_alloc);
+
+/*
+ * nss_tx_msg_txn_add()
+ *	Send a message as part of a transaction with default message buffer size.
+ */
+nss_tx_status_t nss_tx_msg_txn_add(struct nss_tx_msg_txn *txn,
+				nss_tx_msg_sync_subsys_async_t tx_msg_async,
+				struct nss_cmn_msg *ncm, uint32_t resp_offset, uint32_t copy_len)
+{
+	if (!unlikely(tx_msg_async)) {
+		nss_warning("%px: missing Tx msg async API\n", txn->nss_ctx);
+		return NSS_TX_FAILURE_SYNC_BAD_PARAM;
+	}
+
+	return nss_tx_msg_txn_add_internal(txn, tx_msg_async, NULL, 0, ncm, resp_offset, copy_len);
+}
+EXPORT_SYMBOL(nss_tx_msg_txn_add);
+
+/*
+ * nss_tx_msg_txn_add_with_size()
+ *	Send a message as part of a transaction with specified message buffer size.
+ */
+nss_tx_status_t nss_tx_msg_txn_add_with_size(struct nss_tx_msg_txn *txn,
+				nss_tx_msg_sync_subsys_async_with_size_t tx_msg_async_with_size,
+				uint32_t msg_buf_size, struct nss_cmn_msg *ncm,
+				uint32_t resp_offset, uint32_t copy_len)
+{
+	if (!unlikely(tx_msg_async_with_size)) {
+		nss_warning("%px: missing Tx msg async API\n", txn->nss_ctx);
+		return NSS_TX_FAILURE_SYNC_BAD_PARAM;
+	}
+
+	return nss_tx_msg_txn_add_internal(txn, NULL, tx_msg_async_with_size, msg_buf_size,
+						ncm, resp_offset, copy_len);
+}
+EXPORT_SYMBOL(nss_tx_msg_txn_add_with_size);
+
+/*
+ * nss_tx_msg_txn_wait()
+ *	Wait for the responses of all messages of a transaction.
+ */
+nss_tx_status_t nss_tx_msg_txn_wait(struct nss_tx_msg_txn *txn)
+{
+	nss_tx_status_t status = NSS_TX_SUCCESS;
+	uint32_t i;
+	long ret;
+
+	ret = wait_event_timeout(txn->wait, atomic_read(&txn->in_flight) == 0, msecs_to_jiffies(txn->timeout));
+	if (!ret) {
+		nss_warning("%px: Tx msg transaction timeout, %d messages without response\n",
+				txn->nss_ctx, atomic_read(&txn->in_flight));
+	}
+
+	/*
+	 * The lock orders us after the responses that have been handled and,
+	 * on timeout, keeps the late ones out.
+	 */
+	spin_lock_bh(&txn->lock);
+	if (!ret) {
+		txn->abandoned = true;
+	}
+
+	for (i = 0; i < txn->num_msgs; i++) {
+		if (txn->entries[i].status != NSS_TX_SUCCESS) {
+			status = txn->entries[i].status;
+			break;
+		}
+	}
+	spin_unlock_bh(&txn->lock);
+
+	return status;
+}
+EXPORT_SYMBOL(nss_tx_msg_txn_wait);
+
+/*
+ * nss_tx_msg_txn_status()
+ *	Status of the index'th message added to a transaction.
+ */
+nss_tx_status_t nss_tx_msg_txn_status(struct nss_tx_msg_txn *txn, uint32_t index)
+{
+	if (index >= txn->num_msgs) {
+		return NSS_TX_FAILURE_SYNC_BAD_PARAM;
+	}
+
+	return txn->entries[index].status;
+}
+EXPORT_SYMBOL(nss_tx_msg_txn_status);
+
+/*
+ * nss_tx_msg_txn_free()
+ *	Release a transaction.
+ *
+ * Responses still in flight keep the transaction alive but are no longer
+ * copied to the caller's messages.
+ */
+void nss_tx_msg_txn_free(struct nss_tx_msg_txn *txn)
+{
+	nss_tx_msg_txn_abandon(txn);
+	nss_tx_msg_txn_put(txn);
+}
+EXPORT_SYMBOL(nss_tx_msg_txn_free);
@@ -42,18 +42,6 @@ struct nss_tx_msg_sync_cmn_data {
 	uint32_t copy_len;			/* Length in bytes copied from the return message */
 };
 
-/*
- * nss_tx_msg_sync_subsys_async_t()
- *	Tx msg asynchronous API of each subsystem.
- */
-typedef nss_tx_status_t (*nss_tx_msg_sync_subsys_async_t)(struct nss_ctx_instance *nss_ctx, struct nss_cmn_msg *ncm);
-
-/*
- * nss_tx_msg_sync_subsys_async_with_size_t()
- *	Tx msg asynchronous API of each subsystem with message buffer size specified.
- */
-typedef nss_tx_status_t (*nss_tx_msg_sync_subsys_async_with_size_t)(struct nss_ctx_instance *nss_ctx, struct nss_cmn_msg *ncm, uint32_t size);
-
 /*
  * nss_tx_msg_sync()
  *	Core function to send message to FW synchronously.
@@ -79,4 +67,34 @@ nss_tx_status_t nss_tx_msg_sync_with_size(struct nss_ctx_instance *nss_ctx,
 				uint32_t msg_buf_size, uint32_t timeout,
 				struct nss_cmn_msg *ncm, uint32_t resp_offset, uint32_t copy_len);
 
+/*
+ * Per-message transaction data
+ *	Used as message app_data.
+ */
+struct nss_tx_msg_txn_entry {
+	struct nss_tx_msg_txn *txn;		/* Transaction this message belongs to */
+	void *original_msg;			/* Address of the caller-build message */
+	uint32_t resp_offset;			/* Response offset in message payload */
+	uint32_t copy_len;			/* Length in bytes copied from the return message */
+	nss_tx_status_t status;			/* Tx status */
+};
+
+/*
+ * Pipelined message transaction
+ *	Messages are sent back to back and waited for once.
+ */
+struct nss_tx_msg_txn {
+	struct nss_ctx_instance *nss_ctx;	/* NSS context the messages are sent to */
+	spinlock_t lock;			/* Protects abandoned against late responses */
+	wait_queue_head_t wait;			/* Woken up on every response */
+	atomic_t in_flight;			/* Messages sent and not yet responded */
+	atomic_t refcnt;			/* Caller plus one per message in flight */
+	bool abandoned;				/* Caller stopped waiting; late responses are dropped */
+	uint32_t max_in_flight;			/* In-flight limit */
+	uint32_t timeout;			/* Timeout in msec for a response */
+	uint32_t num_msgs;			/* Messages added */
+	uint32_t max_msgs;			/* Size of entries[] */
+	struct nss_tx_msg_txn_entry entries[];	/* Per-message data */
+};
+
 #endif /* __NSS_TX_MSG_SYNC_H */
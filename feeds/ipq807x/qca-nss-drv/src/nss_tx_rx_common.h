@@ -69,6 +69,10 @@ extern void nss_ipv4_register_handler(void);
 extern void nss_ipv4_reasm_register_handler(void);
 extern void nss_ipv6_register_handler(void);
 extern void nss_ipv6_reasm_register_handler(void);
+extern void nss_ipv4_rule_batch_exit(void);
+extern void nss_ipv4_flow_flush(void);
+extern void nss_ipv4_flow_exit(void);
+extern void nss_ipv6_rule_batch_exit(void);
 extern void nss_n2h_register_handler(struct nss_ctx_instance *nss_ctx);
 extern void nss_tunipip6_register_handler(void);
 extern void nss_pppoe_register_handler(void);
@@ -220,6 +220,8 @@ void nss_udp_st_register_handler(struct nss_ctx_instance *nss_ctx)
 
 	sema_init(&nss_udp_st_pvt.sem, 1);
 	init_completion(&nss_udp_st_pvt.complete);
+
+	nss_udp_st_nl_init();
 }
 
 /*
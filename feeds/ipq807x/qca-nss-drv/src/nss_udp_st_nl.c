@@ -0,0 +1,519 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/*
+ * nss_udp_st_nl.c
+ *	NSS UDP_ST generic netlink interface
+ */
+
+#include <net/genetlink.h>
+#include "nss_core.h"
+#include "nss_udp_st_stats.h"
+#include "nss_udp_st_nl.h"
+
+#define NSS_UDP_ST_NL_BATCH_TIMEOUT 1000	/* 1 sec for the firmware to answer the last rule of a batch */
+#define NSS_UDP_ST_NL_QUEUE_RETRY 100		/* Attempts to send a rule while the host to NSS queue is full */
+
+/*
+ * Outstanding rule messages of one CFG/UNCFG command
+ */
+struct nss_udp_st_nl_batch {
+	struct kref ref;		/* One reference per message in flight plus the sender's */
+	struct completion complete;	/* Completed when no message is pending */
+	atomic_t pending;		/* Messages not answered yet, plus one for the sender */
+	atomic_t failed;		/* Messages rejected by the firmware */
+	atomic_t error;			/* Firmware error of the first rejected message */
+};
+
+static bool nss_udp_st_nl_registered;
+static struct genl_family nss_udp_st_nl_family;
+
+/*
+ * nss_udp_st_nl_policy
+ */
+static const struct nla_policy nss_udp_st_nl_policy[NSS_UDP_ST_NL_ATTR_MAX + 1] = {
+	[NSS_UDP_ST_NL_ATTR_RATE] = { .type = NLA_U32 },
+	[NSS_UDP_ST_NL_ATTR_BUFFER_SIZE] = { .type = NLA_U32 },
+	[NSS_UDP_ST_NL_ATTR_DSCP] = { .type = NLA_U8 },
+	[NSS_UDP_ST_NL_ATTR_TYPE] = { .type = NLA_U32 },
+	[NSS_UDP_ST_NL_ATTR_FLAG] = { .type = NLA_U32 },
+	[NSS_UDP_ST_NL_ATTR_RULES] = { .type = NLA_BINARY,
+				.len = NSS_UDP_ST_NL_RULES_MAX * sizeof(struct nss_udp_st_nl_rule) },
+	[NSS_UDP_ST_NL_ATTR_CONFIGURED] = { .type = NLA_U32 },
+	[NSS_UDP_ST_NL_ATTR_FAILED] = { .type = NLA_U32 },
+	[NSS_UDP_ST_NL_ATTR_ERROR] = { .type = NLA_U32 },
+	[NSS_UDP_ST_NL_ATTR_STATS] = { .type = NLA_BINARY, .len = sizeof(struct nss_udp_st_nl_stats) },
+};
+
+/*
+ * nss_udp_st_nl_tx_sync()
+ *	Send a udp_st message and wait for the firmware to answer it.
+ */
+static int nss_udp_st_nl_tx_sync(struct genl_info *info, struct nss_udp_st_msg *num)
+{
+	struct nss_ctx_instance *nss_ctx = nss_udp_st_get_mgr();
+	nss_tx_status_t status;
+
+	status = nss_udp_st_tx_sync(nss_ctx, num);
+	if (status != NSS_TX_SUCCESS) {
+		nss_warning("%px: udp_st message %d failed\n", nss_ctx, num->cm.type);
+		NSS_GENL_SET_ERR_MSG(info, "udp_st message rejected or not answered by the firmware");
+		return -EIO;
+	}
+
+	return 0;
+}
+
+/*
+ * nss_udp_st_nl_create()
+ *	Create the transmit node.
+ */
+static int nss_udp_st_nl_create(struct sk_buff *skb, struct genl_info *info)
+{
+	struct nss_udp_st_msg num;
+
+	if (!info->attrs[NSS_UDP_ST_NL_ATTR_RATE] || !info->attrs[NSS_UDP_ST_NL_ATTR_BUFFER_SIZE]) {
+		NSS_GENL_SET_ERR_MSG(info, "rate and buffer size are required");
+		return -EINVAL;
+	}
+
+	memset(&num, 0, sizeof(num));
+	nss_udp_st_msg_init(&num, NSS_UDP_ST_INTERFACE, NSS_UDP_ST_TX_CREATE_MSG,
+			sizeof(struct nss_udp_st_tx_create), NULL, NULL);
+	num.msg.create.rate = nla_get_u32(info->attrs[NSS_UDP_ST_NL_ATTR_RATE]);
+	num.msg.create.buffer_size = nla_get_u32(info->attrs[NSS_UDP_ST_NL_ATTR_BUFFER_SIZE]);
+	if (info->attrs[NSS_UDP_ST_NL_ATTR_DSCP]) {
+		num.msg.create.dscp = nla_get_u8(info->attrs[NSS_UDP_ST_NL_ATTR_DSCP]);
+	}
+
+	return nss_udp_st_nl_tx_sync(info, &num);
+}
+
+/*
+ * nss_udp_st_nl_flag_msg()
+ *	Send a message that only carries a flag or a test type.
+ */
+static int nss_udp_st_nl_flag_msg(struct genl_info *info, uint32_t type, int attr)
+{
+	struct nss_udp_st_msg num;
+	uint32_t value = 0;
+
+	if (info->attrs[attr]) {
+		value = nla_get_u32(info->attrs[attr]);
+	}
+
+	if ((attr == NSS_UDP_ST_NL_ATTR_TYPE) && (value >= NSS_UDP_ST_TEST_MAX)) {
+		NSS_GENL_SET_ERR_MSG(info, "invalid test type");
+		return -EINVAL;
+	}
+
+	/*
+	 * The start, stop, destroy and reset messages all carry a single word.
+	 */
+	BUILD_BUG_ON(sizeof(struct nss_udp_st_start) != sizeof(uint32_t));
+	BUILD_BUG_ON(sizeof(struct nss_udp_st_stop) != sizeof(uint32_t));
+	BUILD_BUG_ON(sizeof(struct nss_udp_st_tx_destroy) != sizeof(uint32_t));
+	BUILD_BUG_ON(sizeof(struct nss_udp_st_reset_stats) != sizeof(uint32_t));
+
+	memset(&num, 0, sizeof(num));
+	nss_udp_st_msg_init(&num, NSS_UDP_ST_INTERFACE, type, sizeof(uint32_t), NULL, NULL);
+	num.msg.start.type = value;
+
+	return nss_udp_st_nl_tx_sync(info, &num);
+}
+
+/*
+ * nss_udp_st_nl_destroy()
+ *	Destroy the transmit node.
+ */
+static int nss_udp_st_nl_destroy(struct sk_buff *skb, struct genl_info *info)
+{
+	return nss_udp_st_nl_flag_msg(info, NSS_UDP_ST_TX_DESTROY_MSG, NSS_UDP_ST_NL_ATTR_FLAG);
+}
+
+/*
+ * nss_udp_st_nl_start()
+ *	Start a test.
+ */
+static int nss_udp_st_nl_start(struct sk_buff *skb, struct genl_info *info)
+{
+	return nss_udp_st_nl_flag_msg(info, NSS_UDP_ST_START_MSG, NSS_UDP_ST_NL_ATTR_TYPE);
+}
+
+/*
+ * nss_udp_st_nl_stop()
+ *	Stop a test.
+ */
+static int nss_udp_st_nl_stop(struct sk_buff *skb, struct genl_info *info)
+{
+	return nss_udp_st_nl_flag_msg(info, NSS_UDP_ST_STOP_MSG, NSS_UDP_ST_NL_ATTR_TYPE);
+}
+
+/*
+ * nss_udp_st_nl_reset_stats()
+ *	Reset the firmware statistics; the driver ones are reset on the reply.
+ */
+static int nss_udp_st_nl_reset_stats(struct sk_buff *skb, struct genl_info *info)
+{
+	return nss_udp_st_nl_flag_msg(info, NSS_UDP_ST_RESET_STATS_MSG, NSS_UDP_ST_NL_ATTR_FLAG);
+}
+
+/*
+ * nss_udp_st_nl_batch_release()
+ *	Free a batch once the sender and every reply are done with it.
+ */
+static void nss_udp_st_nl_batch_release(struct kref *ref)
+{
+	struct nss_udp_st_nl_batch *batch = container_of(ref, struct nss_udp_st_nl_batch, ref);
+
+	kfree(batch);
+}
+
+/*
+ * nss_udp_st_nl_batch_callback()
+ *	Account the firmware reply to one rule of a batch.
+ */
+static void nss_udp_st_nl_batch_callback(void *app_data, struct nss_udp_st_msg *num)
+{
+	struct nss_udp_st_nl_batch *batch = (struct nss_udp_st_nl_batch *)app_data;
+
+	if (num->cm.response != NSS_CMN_RESPONSE_ACK) {
+		atomic_inc(&batch->failed);
+		atomic_cmpxchg(&batch->error, NSS_UDP_ST_ERROR_NONE, num->cm.error);
+	}
+
+	if (atomic_dec_and_test(&batch->pending)) {
+		complete(&batch->complete);
+	}
+
+	kref_put(&batch->ref, nss_udp_st_nl_batch_release);
+}
+
+/*
+ * nss_udp_st_nl_rule_to_cfg()
+ *	Fill a rule message from a netlink rule.
+ */
+static int nss_udp_st_nl_rule_to_cfg(const struct nss_udp_st_nl_rule *rule, struct nss_udp_st_cfg *cfg)
+{
+	if (rule->type >= NSS_UDP_ST_TEST_MAX) {
+		return -EINVAL;
+	}
+
+	switch (rule->ip_version) {
+	case NSS_UDP_ST_FLAG_IPV4:
+		cfg->src_ip.ip.ipv4 = rule->src_ip[0];
+		cfg->dest_ip.ip.ipv4 = rule->dest_ip[0];
+		break;
+
+	case NSS_UDP_ST_FLAG_IPV6:
+		memcpy(cfg->src_ip.ip.ipv6, rule->src_ip, sizeof(cfg->src_ip.ip.ipv6));
+		memcpy(cfg->dest_ip.ip.ipv6, rule->dest_ip, sizeof(cfg->dest_ip.ip.ipv6));
+		break;
+
+	default:
+		return -EINVAL;
+	}
+
+	cfg->src_port = rule->src_port;
+	cfg->dest_port = rule->dest_port;
+	cfg->type = rule->type;
+	cfg->ip_version = rule->ip_version;
+	return 0;
+}
+
+/*
+ * nss_udp_st_nl_rules()
+ *	Configure or unconfigure an array of rules.
+ *
+ * The rules are queued to the firmware back to back and the replies are
+ * collected afterwards, so a batch costs one round trip instead of one per
+ * rule. The reply tells how many rules the firmware took.
+ */
+static int nss_udp_st_nl_rules(struct genl_info *info, uint32_t type)
+{
+	struct nss_ctx_instance *nss_ctx = nss_udp_st_get_mgr();
+	const struct nss_udp_st_nl_rule *rules;
+	struct nss_udp_st_nl_batch *batch;
+	struct nss_udp_st_msg num;
+	uint32_t count, sent = 0, failed, i;
+	struct sk_buff *reply;
+	void *hdr;
+
+	if (!info->attrs[NSS_UDP_ST_NL_ATTR_RULES]) {
+		NSS_GENL_SET_ERR_MSG(info, "rules are required");
+		return -EINVAL;
+	}
+
+	count = nla_len(info->attrs[NSS_UDP_ST_NL_ATTR_RULES]) / sizeof(*rules);
+	if (!count || (nla_len(info->attrs[NSS_UDP_ST_NL_ATTR_RULES]) % sizeof(*rules))) {
+		NSS_GENL_SET_ERR_MSG(info, "rules attribute is not an array of rules");
+		return -EINVAL;
+	}
+
+	rules = nla_data(info->attrs[NSS_UDP_ST_NL_ATTR_RULES]);
+	memset(&num, 0, sizeof(num));
+	for (i = 0; i < count; i++) {
+		if (nss_udp_st_nl_rule_to_cfg(&rules[i], &num.msg.cfg)) {
+			NSS_GENL_SET_ERR_MSG(info, "invalid rule");
+			return -EINVAL;
+		}
+	}
+
+	reply = genlmsg_new(3 * nla_total_size(sizeof(uint32_t)), GFP_KERNEL);
+	if (!reply) {
+		return -ENOMEM;
+	}
+
+	batch = kzalloc(sizeof(*batch), GFP_KERNEL);
+	if (!batch) {
+		nlmsg_free(reply);
+		return -ENOMEM;
+	}
+
+	kref_init(&batch->ref);
+	init_completion(&batch->complete);
+	atomic_set(&batch->pending, 1);
+
+	for (i = 0; i < count; i++) {
+		nss_tx_status_t status;
+		int retry = NSS_UDP_ST_NL_QUEUE_RETRY;
+
+		memset(&num, 0, sizeof(num));
+		nss_udp_st_msg_init(&num, NSS_UDP_ST_INTERFACE, type, sizeof(struct nss_udp_st_cfg),
+				nss_udp_st_nl_batch_callback, batch);
+		nss_udp_st_nl_rule_to_cfg(&rules[i], &num.msg.cfg);
+
+		atomic_inc(&batch->pending);
+		kref_get(&batch->ref);
+
+		/*
+		 * Let the firmware drain the queue when the whole batch does not fit.
+		 */
+		while ((status = nss_udp_st_tx(nss_ctx, &num)) == NSS_TX_FAILURE_QUEUE && --retry) {
+			usleep_range(100, 200);
+		}
+
+		if (status != NSS_TX_SUCCESS) {
+			nss_warning("%px: udp_st rule %u of %u not sent, status %d\n", nss_ctx, i, count, status);
+			atomic_dec(&batch->pending);
+			kref_put(&batch->ref, nss_udp_st_nl_batch_release);
+			break;
+		}
+
+		sent++;
+	}
+
+	/*
+	 * Drop the sender's count and wait for the replies still pending.
+	 */
+	if (!atomic_dec_and_test(&batch->pending)) {
+		wait_for_completion_timeout(&batch->complete, msecs_to_jiffies(NSS_UDP_ST_NL_BATCH_TIMEOUT));
+	}
+
+	failed = (count - sent) + atomic_read(&batch->failed) + atomic_read(&batch->pending);
+	if (failed > count) {
+		failed = count;
+	}
+
+	hdr = genlmsg_put_reply(reply, info, &nss_udp_st_nl_family, 0, info->genlhdr->cmd);
+	if (!hdr
+		|| nla_put_u32(reply, NSS_UDP_ST_NL_ATTR_CONFIGURED, count - failed)
+		|| nla_put_u32(reply, NSS_UDP_ST_NL_ATTR_FAILED, failed)
+		|| nla_put_u32(reply, NSS_UDP_ST_NL_ATTR_ERROR, atomic_read(&batch->error))) {
+		kref_put(&batch->ref, nss_udp_st_nl_batch_release);
+		nlmsg_free(reply);
+		return -EMSGSIZE;
+	}
+
+	if (failed) {
+		nss_warning("%px: udp_st %u of %u rules failed, first error %d\n", nss_ctx, failed, count,
+				atomic_read(&batch->error));
+	}
+
+	kref_put(&batch->ref, nss_udp_st_nl_batch_release);
+
+	genlmsg_end(reply, hdr);
+	return genlmsg_reply(reply, info);
+}
+
+/*
+ * nss_udp_st_nl_cfg()
+ *	Configure rules.
+ */
+static int nss_udp_st_nl_cfg(struct sk_buff *skb, struct genl_info *info)
+{
+	return nss_udp_st_nl_rules(info, NSS_UDP_ST_CFG_RULE_MSG);
+}
+
+/*
+ * nss_udp_st_nl_uncfg()
+ *	Unconfigure rules.
+ */
+static int nss_udp_st_nl_uncfg(struct sk_buff *skb, struct genl_info *info)
+{
+	return nss_udp_st_nl_rules(info, NSS_UDP_ST_UNCFG_RULE_MSG);
+}
+
+/*
+ * nss_udp_st_nl_get_stats()
+ *	Reply with the driver statistics.
+ */
+static int nss_udp_st_nl_get_stats(struct sk_buff *skb, struct genl_info *info)
+{
+	struct nss_udp_st_nl_stats stats;
+	struct sk_buff *reply;
+	void *hdr;
+
+	reply = genlmsg_new(nla_total_size(sizeof(stats)), GFP_KERNEL);
+	if (!reply) {
+		return -ENOMEM;
+	}
+
+	hdr = genlmsg_put_reply(reply, info, &nss_udp_st_nl_family, 0, info->genlhdr->cmd);
+	if (!hdr) {
+		nlmsg_free(reply);
+		return -EMSGSIZE;
+	}
+
+	nss_udp_st_stats_get(&stats);
+	if (nla_put(reply, NSS_UDP_ST_NL_ATTR_STATS, sizeof(stats), &stats)) {
+		nlmsg_free(reply);
+		return -EMSGSIZE;
+	}
+
+	genlmsg_end(reply, hdr);
+	return genlmsg_reply(reply, info);
+}
+
+/*
+ * nss_udp_st_nl_ops
+ */
+static const struct genl_ops nss_udp_st_nl_ops[] = {
+	{
+		.cmd = NSS_UDP_ST_NL_CMD_CREATE,
+		.doit = nss_udp_st_nl_create,
+		NSS_GENL_OP_POLICY(nss_udp_st_nl_policy)
+		.flags = GENL_ADMIN_PERM,
+	},
+	{
+		.cmd = NSS_UDP_ST_NL_CMD_DESTROY,
+		.doit = nss_udp_st_nl_destroy,
+		NSS_GENL_OP_POLICY(nss_udp_st_nl_policy)
+		.flags = GENL_ADMIN_PERM,
+	},
+	{
+		.cmd = NSS_UDP_ST_NL_CMD_CFG,
+		.doit = nss_udp_st_nl_cfg,
+		NSS_GENL_OP_POLICY(nss_udp_st_nl_policy)
+		.flags = GENL_ADMIN_PERM,
+	},
+	{
+		.cmd = NSS_UDP_ST_NL_CMD_UNCFG,
+		.doit = nss_udp_st_nl_uncfg,
+		NSS_GENL_OP_POLICY(nss_udp_st_nl_policy)
+		.flags = GENL_ADMIN_PERM,
+	},
+	{
+		.cmd = NSS_UDP_ST_NL_CMD_START,
+		.doit = nss_udp_st_nl_start,
+		NSS_GENL_OP_POLICY(nss_udp_st_nl_policy)
+		.flags = GENL_ADMIN_PERM,
+	},
+	{
+		.cmd = NSS_UDP_ST_NL_CMD_STOP,
+		.doit = nss_udp_st_nl_stop,
+		NSS_GENL_OP_POLICY(nss_udp_st_nl_policy)
+		.flags = GENL_ADMIN_PERM,
+	},
+	{
+		.cmd = NSS_UDP_ST_NL_CMD_RESET_STATS,
+		.doit = nss_udp_st_nl_reset_stats,
+		NSS_GENL_OP_POLICY(nss_udp_st_nl_policy)
+		.flags = GENL_ADMIN_PERM,
+	},
+	{
+		.cmd = NSS_UDP_ST_NL_CMD_GET_STATS,
+		.doit = nss_udp_st_nl_get_stats,
+		NSS_GENL_OP_POLICY(nss_udp_st_nl_policy)
+	},
+};
+
+/*
+ * nss_udp_st_nl_family
+ */
+static struct genl_family nss_udp_st_nl_family = {
+	.name = NSS_UDP_ST_NL_FAMILY,
+	.version = NSS_UDP_ST_NL_VERSION,
+	.maxattr = NSS_UDP_ST_NL_ATTR_MAX,
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(5, 2, 0))
+	.policy = nss_udp_st_nl_policy,
+#endif
+	.module = THIS_MODULE,
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(4, 10, 0))
+	.ops = nss_udp_st_nl_ops,
+	.n_ops = ARRAY_SIZE(nss_udp_st_nl_ops),
+#endif
+};
+
+/*
+ * nss_udp_st_nl_init()
+ *	Register the udp_st generic netlink family.
+ */
+void nss_udp_st_nl_init(void)
+{
+	int ret;
+
+	/*
+	 * The netlink structures are shared with userspace, keep them in step
+	 * with the firmware interface.
+	 */
+	BUILD_BUG_ON(NSS_UDP_ST_NL_ERRORS != NSS_UDP_ST_ERROR_MAX);
+	BUILD_BUG_ON(NSS_UDP_ST_NL_TESTS != NSS_UDP_ST_TEST_MAX);
+	BUILD_BUG_ON(NSS_UDP_ST_NL_TIMES != NSS_UDP_ST_STATS_TIME_MAX);
+	BUILD_BUG_ON(NSS_UDP_ST_NL_RULES_MAX * sizeof(struct nss_udp_st_nl_rule) > U16_MAX - NLA_HDRLEN);
+
+	if (nss_udp_st_nl_registered) {
+		return;
+	}
+
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(4, 10, 0))
+	ret = genl_register_family_with_ops(&nss_udp_st_nl_family, nss_udp_st_nl_ops);
+#else
+	ret = genl_register_family(&nss_udp_st_nl_family);
+#endif
+	if (ret) {
+		nss_warning("udp_st netlink family registration failed: %d\n", ret);
+		return;
+	}
+
+	nss_udp_st_nl_registered = true;
+}
+
+/*
+ * nss_udp_st_nl_exit()
+ *	Unregister the udp_st generic netlink family.
+ */
+void nss_udp_st_nl_exit(void)
+{
+	if (!nss_udp_st_nl_registered) {
+		return;
+	}
+
+	genl_unregister_family(&nss_udp_st_nl_family);
+	nss_udp_st_nl_registered = false;
+}
@@ -0,0 +1,111 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/*
+ * nss_udp_st_nl.h
+ *	Generic netlink interface of the UDP speed test.
+ *
+ * Every command maps to the udp_st message of the same name, except
+ * NSS_UDP_ST_NL_CMD_CFG and NSS_UDP_ST_NL_CMD_UNCFG which take an array of
+ * rules and send them to the firmware without waiting for each reply, and
+ * NSS_UDP_ST_NL_CMD_GET_STATS which replies with the driver statistics.
+ *
+ * The header is shared with the host tools, so it can also be built
+ * outside the kernel.
+ */
+
+#ifndef __NSS_UDP_ST_NL_H
+#define __NSS_UDP_ST_NL_H
+
+#ifdef __KERNEL__
+#include <linux/types.h>
+#else
+#include <stdint.h>
+#endif
+
+#define NSS_UDP_ST_NL_FAMILY		"nss_udp_st"
+#define NSS_UDP_ST_NL_VERSION		1
+
+#define NSS_UDP_ST_NL_ERRORS		17	/* NSS_UDP_ST_ERROR_MAX */
+#define NSS_UDP_ST_NL_TESTS		2	/* NSS_UDP_ST_TEST_MAX */
+#define NSS_UDP_ST_NL_TIMES		3	/* NSS_UDP_ST_STATS_TIME_MAX */
+#define NSS_UDP_ST_NL_RULES_MAX		1024	/* Rules in one CFG/UNCFG command */
+
+/*
+ * Commands
+ */
+enum nss_udp_st_nl_cmd {
+	NSS_UDP_ST_NL_CMD_UNSPEC,
+	NSS_UDP_ST_NL_CMD_CREATE,	/* RATE, BUFFER_SIZE, DSCP */
+	NSS_UDP_ST_NL_CMD_DESTROY,	/* FLAG */
+	NSS_UDP_ST_NL_CMD_CFG,		/* RULES; replies CONFIGURED, FAILED, ERROR */
+	NSS_UDP_ST_NL_CMD_UNCFG,	/* RULES; replies CONFIGURED, FAILED, ERROR */
+	NSS_UDP_ST_NL_CMD_START,	/* TYPE */
+	NSS_UDP_ST_NL_CMD_STOP,		/* TYPE */
+	NSS_UDP_ST_NL_CMD_RESET_STATS,	/* FLAG */
+	NSS_UDP_ST_NL_CMD_GET_STATS,	/* Replies STATS */
+	NSS_UDP_ST_NL_CMD_MAX
+};
+
+/*
+ * Attributes
+ */
+enum nss_udp_st_nl_attr {
+	NSS_UDP_ST_NL_ATTR_UNSPEC,
+	NSS_UDP_ST_NL_ATTR_RATE,	/* u32, Mbps */
+	NSS_UDP_ST_NL_ATTR_BUFFER_SIZE,	/* u32, UDP payload bytes */
+	NSS_UDP_ST_NL_ATTR_DSCP,	/* u8 */
+	NSS_UDP_ST_NL_ATTR_TYPE,	/* u32, enum nss_udp_st_test_types */
+	NSS_UDP_ST_NL_ATTR_FLAG,	/* u32 */
+	NSS_UDP_ST_NL_ATTR_RULES,	/* Array of struct nss_udp_st_nl_rule */
+	NSS_UDP_ST_NL_ATTR_CONFIGURED,	/* u32, rules acknowledged by the firmware */
+	NSS_UDP_ST_NL_ATTR_FAILED,	/* u32, rules rejected or not answered */
+	NSS_UDP_ST_NL_ATTR_ERROR,	/* u32, firmware error of the first rejected rule */
+	NSS_UDP_ST_NL_ATTR_STATS,	/* struct nss_udp_st_nl_stats */
+	NSS_UDP_ST_NL_ATTR_MAX_PLUS_ONE
+};
+
+#define NSS_UDP_ST_NL_ATTR_MAX (NSS_UDP_ST_NL_ATTR_MAX_PLUS_ONE - 1)
+
+/*
+ * Connection rule, addresses and ports in host byte order
+ */
+struct nss_udp_st_nl_rule {
+	uint32_t src_ip[4];		/* Source address, IPv4 in src_ip[0] */
+	uint32_t dest_ip[4];		/* Destination address, IPv4 in dest_ip[0] */
+	uint16_t src_port;		/* Source port */
+	uint16_t dest_port;		/* Destination port */
+	uint16_t ip_version;		/* 4 or 6 */
+	uint16_t type;			/* enum nss_udp_st_test_types */
+};
+
+/*
+ * Driver statistics, accumulated since the last reset
+ */
+struct nss_udp_st_nl_stats {
+	uint64_t rx_packets;
+	uint64_t rx_bytes;
+	uint64_t tx_packets;
+	uint64_t tx_bytes;
+	uint32_t errors[NSS_UDP_ST_NL_ERRORS];
+					/* By enum nss_udp_st_error */
+	uint32_t time[NSS_UDP_ST_NL_TESTS][NSS_UDP_ST_NL_TIMES];
+					/* Test timings in ms, by enum nss_udp_st_stats_time */
+};
+
+#endif /* __NSS_UDP_ST_NL_H */
@@ -19,6 +19,12 @@
 #include "nss_core.h"
 #include "nss_udp_st_stats.h"
 #include "nss_udp_st_strings.h"
+#include "nss_udp_st_nl.h"
+
+/*
+ * Statistics domain for UDP speed test; the sync handler below updates under it.
+ */
+static struct nss_stats_domain nss_udp_st_stats_domain = NSS_STATS_DOMAIN_INIT(nss_udp_st_stats_domain);
 
 uint32_t nss_udp_st_errors[NSS_UDP_ST_ERROR_MAX];
 uint32_t nss_udp_st_stats_time[NSS_UDP_ST_TEST_MAX][NSS_UDP_ST_STATS_TIME_MAX];
@@ -63,11 +69,11 @@ static ssize_t nss_udp_st_stats_read(struct file *fp, char __user *ubuf, size_t
 	/*
 	 * Error stats
 	 */
-	spin_lock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_read_lock(&nss_udp_st_stats_domain);
 	for (i = 0; (i < NSS_UDP_ST_ERROR_MAX); i++) {
 		stats_shadow[i] = nss_udp_st_errors[i];
 	}
-	spin_unlock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_read_unlock(&nss_udp_st_stats_domain);
 	size_wr += nss_stats_print("udp_st", "udp_st error stats"
 					, NSS_STATS_SINGLE_INSTANCE
 					, nss_udp_st_strings_error_stats
@@ -78,11 +84,11 @@ static ssize_t nss_udp_st_stats_read(struct file *fp, char __user *ubuf, size_t
 	/*
 	 * Rx time stats
 	 */
-	spin_lock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_read_lock(&nss_udp_st_stats_domain);
 	for (i = 0; (i < NSS_UDP_ST_STATS_TIME_MAX); i++) {
 		stats_shadow[i] = nss_udp_st_stats_time[NSS_UDP_ST_TEST_RX][i];
 	}
-	spin_unlock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_read_unlock(&nss_udp_st_stats_domain);
 	size_wr += nss_stats_print("udp_st", "udp_st Rx time stats (ms)"
 					, NSS_STATS_SINGLE_INSTANCE
 					, nss_udp_st_strings_rx_time_stats
@@ -93,11 +99,11 @@ static ssize_t nss_udp_st_stats_read(struct file *fp, char __user *ubuf, size_t
 	/*
 	 * Tx time stats
 	 */
-	spin_lock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_read_lock(&nss_udp_st_stats_domain);
 	for (i = 0; (i < NSS_UDP_ST_STATS_TIME_MAX); i++) {
 		stats_shadow[i] = nss_udp_st_stats_time[NSS_UDP_ST_TEST_TX][i];
 	}
-	spin_unlock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_read_unlock(&nss_udp_st_stats_domain);
 	size_wr += nss_stats_print("udp_st", "udp_st Tx time stats (ms)"
 					, NSS_STATS_SINGLE_INSTANCE
 					, nss_udp_st_strings_tx_time_stats
@@ -123,6 +129,11 @@ NSS_STATS_DECLARE_FILE_OPERATIONS(udp_st);
  */
 void nss_udp_st_stats_dentry_create(void)
 {
+	/*
+	 * The node sync handler updates the common node stats under the domain
+	 */
+	nss_stats_domain_own_node(&nss_udp_st_stats_domain, NSS_UDP_ST_INTERFACE);
+
 	nss_stats_create_dentry("udp_st", &nss_udp_st_stats_ops);
 }
 
@@ -142,11 +153,11 @@ void nss_udp_st_stats_reset(uint32_t if_num)
 	/*
 	 * Reset error stats.
 	 */
-	spin_lock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_write_begin(&nss_udp_st_stats_domain);
 	for (i = 0; i < NSS_UDP_ST_ERROR_MAX; i++) {
 		nss_udp_st_errors[i] = 0;
 	}
-	spin_unlock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_write_end(&nss_udp_st_stats_domain);
 }
 
 /*
@@ -158,7 +169,7 @@ void nss_udp_st_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss_udp_st_s
 	struct nss_top_instance *nss_top = nss_ctx->nss_top;
 	uint32_t i, j;
 
-	spin_lock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_begin(&nss_udp_st_stats_domain);
 
 	nss_top->stats_node[NSS_UDP_ST_INTERFACE][NSS_STATS_NODE_RX_PKTS] += nus->nstats.node_stats.rx_packets;
 	nss_top->stats_node[NSS_UDP_ST_INTERFACE][NSS_STATS_NODE_RX_BYTES] += nus->nstats.node_stats.rx_bytes;
@@ -174,5 +185,23 @@ void nss_udp_st_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss_udp_st_s
 			nss_udp_st_stats_time[i][j] = nus->time_stats[i][j];
 		}
 	}
-	spin_unlock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_end(&nss_udp_st_stats_domain);
+}
+
+/*
+ * nss_udp_st_stats_get()
+ *	Copy the udp_st statistics for the netlink interface.
+ */
+void nss_udp_st_stats_get(struct nss_udp_st_nl_stats *stats)
+{
+	uint64_t *node = nss_top_main.stats_node[NSS_UDP_ST_INTERFACE];
+
+	nss_stats_domain_read_lock(&nss_udp_st_stats_domain);
+	stats->rx_packets = node[NSS_STATS_NODE_RX_PKTS];
+	stats->rx_bytes = node[NSS_STATS_NODE_RX_BYTES];
+	stats->tx_packets = node[NSS_STATS_NODE_TX_PKTS];
+	stats->tx_bytes = node[NSS_STATS_NODE_TX_BYTES];
+	memcpy(stats->errors, nss_udp_st_errors, sizeof(stats->errors));
+	memcpy(stats->time, nss_udp_st_stats_time, sizeof(stats->time));
+	nss_stats_domain_read_unlock(&nss_udp_st_stats_domain);
 }
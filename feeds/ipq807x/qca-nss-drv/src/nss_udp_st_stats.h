@@ -21,6 +21,8 @@
 
 #include <nss_cmn.h>
 
+struct nss_udp_st_nl_stats;
+
 /*
  * nss_udp_st_stats.h
  *	NSS driver UDP_ST statistics header file.
@@ -32,5 +34,6 @@
 extern void nss_udp_st_stats_reset(uint32_t if_num);
 extern void nss_udp_st_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss_udp_st_stats *nus);
 extern void nss_udp_st_stats_dentry_create(void);
+extern void nss_udp_st_stats_get(struct nss_udp_st_nl_stats *stats);
 
 #endif /* __NSS_UDP_ST_STATS_H */
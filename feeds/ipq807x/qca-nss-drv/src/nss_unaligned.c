@@ -32,7 +32,7 @@ static void nss_unaligned_update_stats(struct nss_ctx_instance *nss_ctx,
 {
 	uint32_t start_index = NSS_UNALIGNED_OPS_PER_MSG * usm->current_iteration;
 	uint32_t i;
-	spin_lock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_write_begin(&nss_unaligned_stats_domain);
 	nss_ctx->unaligned_stats.trap_count = usm->trap_count;
 	for (i = 0; i < NSS_UNALIGNED_OPS_PER_MSG; i++) {
 		uint32_t index = i + start_index;
@@ -41,7 +41,7 @@ static void nss_unaligned_update_stats(struct nss_ctx_instance *nss_ctx,
 		}
 		nss_ctx->unaligned_stats.ops[index] = usm->ops[i];
 	}
-	spin_unlock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_write_end(&nss_unaligned_stats_domain);
 }
 
 /*
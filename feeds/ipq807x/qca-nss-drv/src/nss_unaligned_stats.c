@@ -17,6 +17,11 @@
 #include "nss_tx_rx_common.h"
 #include "nss_unaligned_stats.h"
 
+/*
+ * Statistics domain for unaligned accesses; the unaligned message handler updates under it.
+ */
+struct nss_stats_domain nss_unaligned_stats_domain = NSS_STATS_DOMAIN_INIT(nss_unaligned_stats_domain);
+
 /*
  * nss_unaligned_stats_read()
  *	Read unaligned stats
@@ -43,11 +48,11 @@ static ssize_t nss_unaligned_stats_read(struct file *fp, char __user *ubuf, size
 		return 0;
 	}
 
-	spin_lock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_read_lock(&nss_unaligned_stats_domain);
 	for (i = 0; i < NSS_MAX_CORES; i++) {
 		stats_shadow[i] = nss_top_main.nss[i].unaligned_stats;
 	}
-	spin_unlock_bh(&nss_top_main.stats_lock);
+	nss_stats_domain_read_unlock(&nss_unaligned_stats_domain);
 
 	for (i = 0; i < NSS_MAX_CORES; i++) {
 		size_wr += scnprintf(lbuf + size_wr, size_al - size_wr,
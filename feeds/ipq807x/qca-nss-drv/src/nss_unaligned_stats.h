@@ -17,6 +17,7 @@
 #ifndef __NSS_UNALIGNED_STATS_H
 #define __NSS_UNALIGNED_STATS_H
 
+extern struct nss_stats_domain nss_unaligned_stats_domain;
 extern void nss_unaligned_stats_dentry_create(void);
 
 #endif
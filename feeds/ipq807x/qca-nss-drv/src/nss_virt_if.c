@@ -139,60 +139,6 @@ static void nss_virt_if_msg_handler(struct nss_ctx_instance *nss_ctx,
 	cb((void *)ncm->app_data, ncm);
 }
 
-/*
- * nss_virt_if_callback
- *	Callback to handle the completion of NSS ->HLOS messages.
- */
-static void nss_virt_if_callback(void *app_data, struct nss_cmn_msg *ncm)
-{
-	struct nss_virt_if_handle *handle = (struct nss_virt_if_handle *)app_data;
-	struct nss_virt_if_pvt *nvip = handle->pvt;
-
-	if (ncm->response != NSS_CMN_RESPONSE_ACK) {
-		nss_warning("%px: virt_if Error response %d\n", handle->nss_ctx, ncm->response);
-		nvip->response = NSS_TX_FAILURE;
-		complete(&nvip->complete);
-		return;
-	}
-
-	nvip->response = NSS_TX_SUCCESS;
-	complete(&nvip->complete);
-}
-
-/*
- * nss_virt_if_tx_msg_sync
- *	Send a message from HLOS to NSS synchronously.
- */
-static nss_tx_status_t nss_virt_if_tx_msg_sync(struct nss_virt_if_handle *handle,
-						struct nss_virt_if_msg *nvim)
-{
-	nss_tx_status_t status;
-	int ret = 0;
-	struct nss_virt_if_pvt *nwip = handle->pvt;
-	struct nss_ctx_instance *nss_ctx = handle->nss_ctx;
-
-	down(&nwip->sem);
-
-	status = nss_virt_if_tx_msg(nss_ctx, nvim);
-	if (status != NSS_TX_SUCCESS) {
-		nss_warning("%px: nss_virt_if_msg failed\n", nss_ctx);
-		up(&nwip->sem);
-		return status;
-	}
-
-	ret = wait_for_completion_timeout(&nwip->complete,
-						msecs_to_jiffies(NSS_VIRT_IF_TX_TIMEOUT));
-	if (!ret) {
-		nss_warning("%px: virt_if tx failed due to timeout\n", nss_ctx);
-		nwip->response = NSS_TX_FAILURE;
-	}
-
-	status = nwip->response;
-	up(&nwip->sem);
-
-	return status;
-}
-
 /*
  * nss_virt_if_msg_init()
  *	Initialize virt specific message structure.
@@ -347,11 +293,13 @@ static uint32_t nss_virt_if_register_handler_sync(struct nss_ctx_instance *nss_c
 struct nss_virt_if_handle *nss_virt_if_create_sync_nexthop(struct net_device *netdev, uint32_t nexthop_n2h, uint32_t nexthop_h2n)
 {
 	struct nss_ctx_instance *nss_ctx = nss_virt_if_get_context();
-	struct nss_virt_if_msg nvim;
+	struct nss_virt_if_msg nvim[2];
 	struct nss_virt_if_config_msg *nvcm;
+	struct nss_tx_msg_txn *txn;
 	uint32_t ret;
 	struct nss_virt_if_handle *handle = NULL;
 	int32_t if_num_n2h, if_num_h2n;
+	int i;
 
 	if (unlikely(nss_ctx->state != NSS_CORE_STATE_INITIALIZED)) {
 		nss_warning("%px: Interface could not be created as core not ready\n", nss_ctx);
@@ -388,28 +336,44 @@ struct nss_virt_if_handle *nss_virt_if_create_sync_nexthop(struct net_device *ne
 		goto error1;
 	}
 
-	nss_virt_if_msg_init(&nvim, handle->if_num_n2h, NSS_VIRT_IF_TX_CONFIG_MSG,
-				sizeof(struct nss_virt_if_config_msg), nss_virt_if_callback, handle);
+	/*
+	 * Both configurations are sent back to back and their responses waited for once.
+	 */
+	txn = nss_tx_msg_txn_alloc(nss_ctx, 2, 0, NSS_VIRT_IF_TX_TIMEOUT);
+	if (!txn) {
+		nss_warning("%px: failed to allocate config transaction\n", nss_ctx);
+		goto error2;
+	}
+
+	nss_virt_if_msg_init(&nvim[0], if_num_n2h, NSS_VIRT_IF_TX_CONFIG_MSG,
+				sizeof(struct nss_virt_if_config_msg), NULL, handle);
 
-	nvcm = &nvim.msg.if_config;
+	nvcm = &nvim[0].msg.if_config;
 	nvcm->flags = 0;
 	nvcm->sibling = if_num_h2n;
 	nvcm->nexthop = nexthop_n2h;
 	memcpy(nvcm->mac_addr, netdev->dev_addr, ETH_ALEN);
 
-	ret = nss_virt_if_tx_msg_sync(handle, &nvim);
-	if (ret != NSS_TX_SUCCESS) {
-		nss_warning("%px: nss_virt_if_tx_msg_sync failed %u\n", nss_ctx, ret);
-		goto error2;
-	}
-
-	nvim.cm.interface = if_num_h2n;
+	nvim[1] = nvim[0];
+	nvim[1].cm.interface = if_num_h2n;
+	nvcm = &nvim[1].msg.if_config;
 	nvcm->sibling = if_num_n2h;
 	nvcm->nexthop = nexthop_h2n;
 
-	ret = nss_virt_if_tx_msg_sync(handle, &nvim);
+	for (i = 0; i < 2; i++) {
+		ret = nss_tx_msg_txn_add(txn, (nss_tx_msg_sync_subsys_async_t)nss_virt_if_tx_msg, &nvim[i].cm, 0, 0);
+		if (ret != NSS_TX_SUCCESS) {
+			break;
+		}
+	}
+
+	if (ret == NSS_TX_SUCCESS) {
+		ret = nss_tx_msg_txn_wait(txn);
+	}
+
+	nss_tx_msg_txn_free(txn);
 	if (ret != NSS_TX_SUCCESS) {
-		nss_warning("%px: nss_virt_if_tx_msg_sync failed %u\n", nss_ctx, ret);
+		nss_warning("%px: virt_if config failed %u\n", nss_ctx, ret);
 		goto error2;
 	}
 
@@ -569,6 +533,60 @@ nss_tx_status_t nss_virt_if_tx_buf(struct nss_virt_if_handle *handle,
 }
 EXPORT_SYMBOL(nss_virt_if_tx_buf);
 
+/*
+ * nss_virt_if_tx_buf_list()
+ *	Redirect a burst of HLOS packets to the NSS with a single doorbell.
+ *
+ * Packets that were not sent are left on the list and belong to the caller.
+ */
+nss_tx_status_t nss_virt_if_tx_buf_list(struct nss_virt_if_handle *handle,
+						struct sk_buff_head *list)
+{
+	int32_t if_num = handle->if_num_h2n;
+	struct nss_ctx_instance *nss_ctx = handle->nss_ctx;
+	struct sk_buff *skb;
+	uint32_t sent;
+	int cpu = 0;
+
+	if (unlikely(nss_ctl_redirect == 0)) {
+		return NSS_TX_FAILURE_NOT_ENABLED;
+	}
+
+	if (!nss_virt_if_verify_if_num(if_num)) {
+		nss_warning("%px: bad interface number %d\n", nss_ctx, if_num);
+		return NSS_TX_FAILURE_BAD_PARAM;
+	}
+
+	nss_trace("%px: Virtual Rx packet list, if_num:%d, len:%u", nss_ctx, if_num, skb_queue_len(list));
+
+	/*
+	 * Sanity check the SKBs to ensure that they are suitable for us
+	 */
+	skb_queue_walk(list, skb) {
+		if (unlikely(skb->vlan_tci)) {
+			return NSS_TX_FAILURE_NOT_SUPPORTED;
+		}
+
+		if (unlikely(skb->len <= ETH_HLEN)) {
+			nss_warning("%px: Virtual Rx packet: %px too short", nss_ctx, skb);
+			return NSS_TX_FAILURE_TOO_SHORT;
+		}
+	}
+
+	/*
+	 * set skb queue mapping; the whole burst goes to this CPU's queue
+	 */
+	cpu = get_cpu();
+	put_cpu();
+	skb_queue_walk(list, skb) {
+		skb_set_queue_mapping(skb, cpu);
+	}
+
+	return nss_core_send_packet_list(nss_ctx, list, if_num, H2N_BIT_FLAG_VIRTUAL_BUFFER |
+							H2N_BIT_FLAG_BUFFER_REUSABLE, &sent);
+}
+EXPORT_SYMBOL(nss_virt_if_tx_buf_list);
+
 /*
  * nss_virt_if_tx_msg()
  */
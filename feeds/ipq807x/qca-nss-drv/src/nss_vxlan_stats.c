@@ -88,7 +88,7 @@ void nss_vxlan_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss_vxlan_msg
 	struct nss_vxlan_stats_msg *msg_stats = &nvm->msg.stats;
 	uint64_t *if_stats;
 
-	spin_lock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_begin(&nss_stats_node_domain);
 
 	/*
 	 * Update common node stats
@@ -104,7 +104,7 @@ void nss_vxlan_stats_sync(struct nss_ctx_instance *nss_ctx, struct nss_vxlan_msg
 	if_stats[NSS_STATS_NODE_TX_PKTS] += msg_stats->node_stats.tx_packets;
 	if_stats[NSS_STATS_NODE_TX_BYTES] += msg_stats->node_stats.tx_bytes;
 
-	spin_unlock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_end(&nss_stats_node_domain);
 }
 
 /*
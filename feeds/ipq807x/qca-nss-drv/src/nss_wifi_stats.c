@@ -89,6 +89,11 @@ struct nss_stats_info nss_wifi_stats_str[NSS_WIFI_STATS_MAX] = {
 	{"tidq_full_cnt"			, NSS_STATS_TYPE_SPECIAL}
 };
 
+/*
+ * Statistics domain for wifi; the sync handler below updates under it.
+ */
+static struct nss_stats_domain nss_wifi_stats_domain = NSS_STATS_DOMAIN_INIT(nss_wifi_stats_domain);
+
 uint64_t nss_wifi_stats[NSS_MAX_WIFI_RADIO_INTERFACES][NSS_WIFI_STATS_MAX]; /* WIFI statistics */
 
 /*
@@ -97,7 +102,7 @@ uint64_t nss_wifi_stats[NSS_MAX_WIFI_RADIO_INTERFACES][NSS_WIFI_STATS_MAX]; /* W
  */
 static ssize_t nss_wifi_stats_read(struct file *fp, char __user *ubuf, size_t sz, loff_t *ppos)
 {
-	uint32_t i, id;
+	uint32_t id;
 
 	/*
 	 * Max output lines = #stats * NSS_MAX_CORES  +
@@ -125,12 +130,7 @@ static ssize_t nss_wifi_stats_read(struct file *fp, char __user *ubuf, size_t sz
 	size_wr += nss_stats_banner(lbuf, size_wr, size_al, "wifi", NSS_STATS_SINGLE_CORE);
 
 	for (id = 0; id < NSS_MAX_WIFI_RADIO_INTERFACES; id++) {
-		spin_lock_bh(&nss_top_main.stats_lock);
-		for (i = 0; (i < NSS_WIFI_STATS_MAX); i++) {
-			stats_shadow[i] = nss_wifi_stats[id][i];
-		}
-
-		spin_unlock_bh(&nss_top_main.stats_lock);
+		nss_stats_domain_copy(&nss_wifi_stats_domain, stats_shadow, nss_wifi_stats[id], sizeof(*stats_shadow) * NSS_WIFI_STATS_MAX);
 		size_wr += nss_stats_print("wifi", NULL, id, nss_wifi_stats_str, stats_shadow, NSS_WIFI_STATS_MAX, lbuf, size_wr, size_al);
 		size_wr += scnprintf(lbuf + size_wr, size_al - size_wr, "\n");
 	}
@@ -162,7 +162,6 @@ void nss_wifi_stats_dentry_create(void)
 void nss_wifi_stats_sync(struct nss_ctx_instance *nss_ctx,
 		struct nss_wifi_stats_sync_msg *stats, uint16_t interface)
 {
-	struct nss_top_instance *nss_top = nss_ctx->nss_top;
 	uint32_t radio_id = interface - NSS_WIFI_INTERFACE0;
 	uint8_t i = 0;
 
@@ -171,7 +170,7 @@ void nss_wifi_stats_sync(struct nss_ctx_instance *nss_ctx,
 		return;
 	}
 
-	spin_lock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_begin(&nss_wifi_stats_domain);
 
 	/*
 	 * Tx/Rx stats
@@ -209,5 +208,5 @@ void nss_wifi_stats_sync(struct nss_ctx_instance *nss_ctx,
 	nss_wifi_stats[radio_id][NSS_WIFI_STATS_GLOBAL_Q_FULL_CNT] += stats->global_q_full_cnt;
 	nss_wifi_stats[radio_id][NSS_WIFI_STATS_TIDQ_FULL_CNT] += stats->tidq_full_cnt;
 
-	spin_unlock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_end(&nss_wifi_stats_domain);
 }
@@ -36,6 +36,11 @@ ATOMIC_NOTIFIER_HEAD(nss_wifili_stats_notifier);
  */
 struct nss_wifili_soc_stats soc_stats[NSS_WIFILI_MAX_SOC_NUM];
 
+/*
+ * Statistics domain for all wifili SOCs; nss_wifili_stats_sync() updates under it.
+ */
+static struct nss_stats_domain nss_wifili_stats_domain = NSS_STATS_DOMAIN_INIT(nss_wifili_stats_domain);
+
 /*
  * nss_wifili_stats_read()
  *	Read wifili statistics
@@ -83,111 +88,101 @@ static ssize_t nss_wifili_stats_read(struct file *fp, char __user *ubuf, size_t
 		return 0;
 	}
 
+	stats_wifili = kzalloc(sizeof(struct nss_wifili_stats), GFP_KERNEL);
+	if (unlikely(stats_wifili == NULL)) {
+		nss_warning("Could not allocate memory for local shadow buffer");
+		kfree(lbuf);
+		return 0;
+	}
+
 	size_wr += nss_stats_banner(lbuf, size_wr, size_al, "wifili", NSS_STATS_SINGLE_CORE);
 
 	for (soc_idx = 0; soc_idx < NSS_WIFILI_MAX_SOC_NUM; soc_idx++) {
-		stats_wifili = &(soc_stats[soc_idx].stats_wifili);
+		nss_stats_domain_copy(&nss_wifili_stats_domain, stats_wifili, &soc_stats[soc_idx].stats_wifili, sizeof(struct nss_wifili_stats));
 		for (i = 0; i < soc_stats[soc_idx].soc_maxpdev; i++) {
 
-			spin_lock_bh(&nss_top_main.stats_lock);
 			size_wr += nss_stats_print("wifili", "txrx", i
 					, nss_wifili_strings_stats_txrx
 					, stats_wifili->stats_txrx[i]
 					, NSS_WIFILI_STATS_TXRX_MAX
 					, lbuf, size_wr, size_al);
-			spin_unlock_bh(&nss_top_main.stats_lock);
 			size_wr += scnprintf(lbuf + size_wr
 					, size_al - size_wr, "\n");
 
 			/*
 			 * Filling TCL ring stats
 			 */
-			spin_lock_bh(&nss_top_main.stats_lock);
 			size_wr += nss_stats_print("wifili", "tcl ring", i
 					, nss_wifili_strings_stats_tcl
 					, stats_wifili->stats_tcl_ring[i]
 					, NSS_WIFILI_STATS_TCL_MAX
 					, lbuf, size_wr, size_al);
-			spin_unlock_bh(&nss_top_main.stats_lock);
 			size_wr += scnprintf(lbuf + size_wr
 					, size_al - size_wr, "\n");
 
 			/*
 			 * Filling TCL comp stats
 			 */
-			spin_lock_bh(&nss_top_main.stats_lock);
 			size_wr += nss_stats_print("wifili", "tcl comp", i
 					, nss_wifili_strings_stats_tx_comp
 					, stats_wifili->stats_tx_comp[i]
 					, NSS_WIFILI_STATS_TX_DESC_FREE_MAX
 					, lbuf, size_wr, size_al);
-			spin_unlock_bh(&nss_top_main.stats_lock);
 			size_wr += scnprintf(lbuf + size_wr
 					, size_al - size_wr, "\n");
 
 			/*
 			 * Filling reo ring stats
 			 */
-			spin_lock_bh(&nss_top_main.stats_lock);
 			size_wr += nss_stats_print("wifili", "reo ring", i
 					, nss_wifili_strings_stats_reo
 					, stats_wifili->stats_reo[i]
 					, NSS_WIFILI_STATS_REO_MAX
 					, lbuf, size_wr, size_al);
-
-			spin_unlock_bh(&nss_top_main.stats_lock);
 			size_wr += scnprintf(lbuf + size_wr
 					, size_al - size_wr, "\n");
 
 			/*
 			 * Filling TX SW Pool
 			 */
-			spin_lock_bh(&nss_top_main.stats_lock);
 			size_wr += nss_stats_print("wifili", "tx sw pool", i
 					, nss_wifili_strings_stats_txsw_pool
 					, stats_wifili->stats_tx_desc[i]
 					, NSS_WIFILI_STATS_TX_DESC_MAX
 					, lbuf, size_wr, size_al);
-			spin_unlock_bh(&nss_top_main.stats_lock);
 			size_wr += scnprintf(lbuf + size_wr
 					, size_al - size_wr, "\n");
 
 			/*
 			 * Filling TX EXt SW Pool
 			 */
-			spin_lock_bh(&nss_top_main.stats_lock);
 			size_wr += nss_stats_print("wifili", "tx ext sw pool", i
 					, nss_wifili_strings_stats_ext_txsw_pool
 					, stats_wifili->stats_ext_tx_desc[i]
 					, NSS_WIFILI_STATS_EXT_TX_DESC_MAX
 					, lbuf, size_wr, size_al);
-			spin_unlock_bh(&nss_top_main.stats_lock);
 			size_wr += scnprintf(lbuf + size_wr
 					, size_al - size_wr, "\n");
 
 			/*
 			 * Filling rxdma pool stats
 			 */
-			spin_lock_bh(&nss_top_main.stats_lock);
 			size_wr += nss_stats_print("wifili", "rxdma pool", i
 					, nss_wifili_strings_stats_rxdma_pool
 					, stats_wifili->stats_rx_desc[i]
 					, NSS_WIFILI_STATS_RX_DESC_MAX
 					, lbuf, size_wr, size_al);
-			spin_unlock_bh(&nss_top_main.stats_lock);
 			size_wr += scnprintf(lbuf + size_wr
 					, size_al - size_wr, "\n");
 
 			/*
 			 * Filling rxdma ring stats
 			 */
-			spin_lock_bh(&nss_top_main.stats_lock);
 			size_wr += nss_stats_print("wifili", "rxdma ring", i
 					, nss_wifili_strings_stats_rxdma_ring
 					, stats_wifili->stats_rxdma[i]
 					, NSS_WIFILI_STATS_RXDMA_DESC_MAX
 					, lbuf, size_wr, size_al);
-			spin_unlock_bh(&nss_top_main.stats_lock);
 			size_wr += scnprintf(lbuf + size_wr
 					, size_al - size_wr, "\n");
 		}
@@ -195,19 +190,18 @@ static ssize_t nss_wifili_stats_read(struct file *fp, char __user *ubuf, size_t
 		/*
 		 * Filling wbm ring stats
 		 */
-		spin_lock_bh(&nss_top_main.stats_lock);
 		size_wr += nss_stats_print("wifili", "wbm ring"
 				, NSS_STATS_SINGLE_INSTANCE
 				, nss_wifili_strings_stats_wbm
 				, stats_wifili->stats_wbm
 				, NSS_WIFILI_STATS_WBM_MAX
 				, lbuf, size_wr, size_al);
-		spin_unlock_bh(&nss_top_main.stats_lock);
 		size_wr += scnprintf(lbuf + size_wr, size_al - size_wr, "\n");
 	}
 
 	bytes_read = simple_read_from_buffer(ubuf, sz, ppos, lbuf, strlen(lbuf));
 	kfree(lbuf);
+	kfree(stats_wifili);
 
 	return bytes_read;
 }
@@ -233,7 +227,6 @@ void nss_wifili_stats_dentry_create(void)
 void nss_wifili_stats_sync(struct nss_ctx_instance *nss_ctx,
 		struct nss_wifili_stats_sync_msg *wlsoc_stats, uint16_t interface)
 {
-	struct nss_top_instance *nss_top = nss_ctx->nss_top;
 	struct nss_wifili_soc_stats *nwss = NULL;
 	struct nss_wifili_stats *stats = NULL;
 	struct nss_wifili_device_stats *devstats = &wlsoc_stats->stats;
@@ -268,7 +261,7 @@ void nss_wifili_stats_sync(struct nss_ctx_instance *nss_ctx,
 	 */
 	stats = &(nwss->stats_wifili);
 
-	spin_lock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_begin(&nss_wifili_stats_domain);
 
 	for (index = 0; index < nwss->soc_maxpdev; index++) {
 		/*
@@ -443,7 +436,7 @@ void nss_wifili_stats_sync(struct nss_ctx_instance *nss_ctx,
 	stats->stats_wbm[NSS_WIFILI_STATS_WBM_SRC_REO_CODE_NULLQ] += devstats->rxwbm_stats.err_src_reo_code_nullq;
 	stats->stats_wbm[NSS_WIFILI_STATS_WBM_SRC_REO_CODE_INV] += devstats->rxwbm_stats.err_src_reo_code_inv;
 	stats->stats_wbm[NSS_WIFILI_STATS_WBM_SRC_INV] += devstats->rxwbm_stats.err_src_invalid;
-	spin_unlock_bh(&nss_top->stats_lock);
+	nss_stats_domain_write_end(&nss_wifili_stats_domain);
 	return;
 }
 
@@ -483,7 +476,7 @@ void nss_wifili_stats_notify(struct nss_ctx_instance *nss_ctx, uint32_t if_num)
 		goto done;
 	}
 	wifili_stats->if_num = if_num;
-	memcpy(&wifili_stats->stats, &soc_stats[index].stats_wifili, sizeof(wifili_stats->stats));
+	nss_stats_domain_copy(&nss_wifili_stats_domain, &wifili_stats->stats, &soc_stats[index].stats_wifili, sizeof(wifili_stats->stats));
 	atomic_notifier_call_chain(&nss_wifili_stats_notifier, NSS_STATS_EVENT_NOTIFY, (void *)wifili_stats);
 
 done:
@@ -0,0 +1,813 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/*
+ * nss_bench.c
+ *	Run the NSS firmware self-tests and compare runs against a baseline.
+ *
+ *	nss_bench list
+ *	nss_bench run dma -r 10 -b 1024 > dma.json
+ *	nss_bench run c2c -c 1 -d 5000 -r 5 >> run.json
+ *	nss_bench run udp_st -R 1000 -s 64,512,1400 --dst 192.168.1.2 -d 10000 >> run.json
+ *	nss_bench run stats_drv -v 1 -l atomic > counters.json
+ *	nss_bench run copy -v 2 -s 64,1024,16384,262144 -b 1024 >> copy.json
+ *	nss_bench compare baseline.json run.json
+ *
+ * "run" prints one JSON line with the parameters, a min/avg/max/stddev
+ * summary of every metric over the successful repetitions, and the raw
+ * samples. Lines can be appended to one file to form a baseline. A comma
+ * separated payload size runs the test once per size, one line each.
+ *
+ * "compare" matches every run of the second file to the baseline run of
+ * the same test and parameters and flags throughput changes larger than
+ * the threshold and than the noise of both runs. It exits with 1 when
+ * anything regressed.
+ *
+ * "copy" times the host copy APIs: memcpy, copy jobs forced on the CPU and
+ * copy jobs offloaded to the DMA engine, so that one file compares the CPU
+ * and DMA paths per copy size.
+ *
+ * --mock makes "run" produce synthetic samples, so the tooling can be
+ * checked without the driver.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <math.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/genetlink.h>
+
+#include "nss_bench_nl.h"
+
+#define NSS_BENCH_NL_BUF	(16 * 1024)
+#define NSS_BENCH_LINE_MAX	(64 * 1024)
+
+static const char *nss_bench_test_names[NSS_BENCH_NL_TEST_MAX] = {
+	[NSS_BENCH_NL_TEST_DMA] = "dma",
+	[NSS_BENCH_NL_TEST_C2C] = "c2c",
+	[NSS_BENCH_NL_TEST_UDP_ST] = "udp_st",
+	[NSS_BENCH_NL_TEST_STATS_DRV] = "stats_drv",
+	[NSS_BENCH_NL_TEST_COPY] = "copy",
+};
+
+/*
+ * Parameters of a run, sent as attributes when set
+ */
+struct nss_bench_params {
+	uint32_t test;
+	uint32_t repeat;
+	uint32_t duration;
+	uint32_t pkt_size;
+	uint32_t burst;
+	uint32_t core;
+	uint32_t variant;
+	uint32_t flags;
+	uint32_t rate;
+	uint32_t src_ip;
+	uint32_t dest_ip;
+	uint16_t src_port;
+	uint16_t dest_port;
+	bool has_variant;
+	const char *label;
+};
+
+/*
+ * Summary of one metric
+ */
+struct nss_bench_stat {
+	double min;
+	double avg;
+	double max;
+	double stddev;
+};
+
+/*
+ * Reply of the family
+ */
+struct nss_bench_reply {
+	struct nss_bench_nl_sample samples[NSS_BENCH_NL_REPEAT_MAX];
+	uint32_t num_samples;
+	uint32_t tests[NSS_BENCH_NL_TEST_MAX];
+	uint32_t num_tests;
+};
+
+static int nss_bench_fd = -1;
+static uint16_t nss_bench_family;
+static uint32_t nss_bench_seq;
+
+/*
+ * nss_bench_nl_msg()
+ *	Start a generic netlink request.
+ */
+static struct nlmsghdr *nss_bench_nl_msg(void *buf, uint16_t family, uint8_t cmd, uint8_t version)
+{
+	struct nlmsghdr *nlh = (struct nlmsghdr *)buf;
+	struct genlmsghdr *gnlh;
+
+	memset(buf, 0, NLMSG_HDRLEN + GENL_HDRLEN);
+	nlh->nlmsg_len = NLMSG_HDRLEN + GENL_HDRLEN;
+	nlh->nlmsg_type = family;
+	nlh->nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK;
+	nlh->nlmsg_seq = ++nss_bench_seq;
+
+	gnlh = (struct genlmsghdr *)NLMSG_DATA(nlh);
+	gnlh->cmd = cmd;
+	gnlh->version = version;
+	return nlh;
+}
+
+/*
+ * nss_bench_nl_put()
+ *	Append an attribute to a request.
+ */
+static void nss_bench_nl_put(struct nlmsghdr *nlh, uint16_t type, const void *data, size_t len)
+{
+	struct nlattr *nla = (struct nlattr *)((char *)nlh + NLMSG_ALIGN(nlh->nlmsg_len));
+
+	nla->nla_type = type;
+	nla->nla_len = (uint16_t)(NLA_HDRLEN + len);
+	memcpy((char *)nla + NLA_HDRLEN, data, len);
+	nlh->nlmsg_len = NLMSG_ALIGN(nlh->nlmsg_len) + NLA_ALIGN(nla->nla_len);
+}
+
+/*
+ * nss_bench_nl_parse()
+ *	Pick the attributes of a reply.
+ */
+static void nss_bench_nl_parse(struct nlmsghdr *nlh, bool ctrl, struct nss_bench_reply *reply)
+{
+	int len = nlh->nlmsg_len - NLMSG_HDRLEN - GENL_HDRLEN;
+	struct nlattr *nla = (struct nlattr *)((char *)NLMSG_DATA(nlh) + GENL_HDRLEN);
+
+	while ((len >= NLA_HDRLEN) && (nla->nla_len >= NLA_HDRLEN) && (nla->nla_len <= len)) {
+		void *data = (char *)nla + NLA_HDRLEN;
+		int dlen = nla->nla_len - NLA_HDRLEN;
+		uint16_t type = nla->nla_type & NLA_TYPE_MASK;
+
+		if (ctrl) {
+			if ((type == CTRL_ATTR_FAMILY_ID) && (dlen >= 2)) {
+				memcpy(&nss_bench_family, data, sizeof(uint16_t));
+			}
+		} else if ((type == NSS_BENCH_NL_ATTR_TEST) && (dlen >= 4) && (reply->num_tests < NSS_BENCH_NL_TEST_MAX)) {
+			memcpy(&reply->tests[reply->num_tests++], data, sizeof(uint32_t));
+		} else if (type == NSS_BENCH_NL_ATTR_SAMPLES) {
+			reply->num_samples = dlen / sizeof(struct nss_bench_nl_sample);
+			if (reply->num_samples > NSS_BENCH_NL_REPEAT_MAX) {
+				reply->num_samples = NSS_BENCH_NL_REPEAT_MAX;
+			}
+			memcpy(reply->samples, data, reply->num_samples * sizeof(struct nss_bench_nl_sample));
+		}
+
+		len -= NLA_ALIGN(nla->nla_len);
+		nla = (struct nlattr *)((char *)nla + NLA_ALIGN(nla->nla_len));
+	}
+}
+
+/*
+ * nss_bench_nl_transact()
+ *	Send a request and read its reply up to the acknowledgement.
+ */
+static int nss_bench_nl_transact(struct nlmsghdr *req, struct nss_bench_reply *reply)
+{
+	static char buf[NSS_BENCH_NL_BUF];
+	bool ctrl = (req->nlmsg_type == GENL_ID_CTRL);
+	uint32_t seq = req->nlmsg_seq;
+
+	memset(reply, 0, sizeof(*reply));
+	if (send(nss_bench_fd, req, req->nlmsg_len, 0) < 0) {
+		return -errno;
+	}
+
+	for (;;) {
+		struct nlmsghdr *nlh;
+		ssize_t len = recv(nss_bench_fd, buf, sizeof(buf), 0);
+
+		if (len < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -errno;
+		}
+
+		for (nlh = (struct nlmsghdr *)buf; NLMSG_OK(nlh, len); nlh = NLMSG_NEXT(nlh, len)) {
+			if (nlh->nlmsg_seq != seq) {
+				continue;
+			}
+
+			if (nlh->nlmsg_type == NLMSG_ERROR) {
+				return ((struct nlmsgerr *)NLMSG_DATA(nlh))->error;
+			}
+
+			if (nlh->nlmsg_type == NLMSG_DONE) {
+				return 0;
+			}
+
+			nss_bench_nl_parse(nlh, ctrl, reply);
+		}
+	}
+}
+
+/*
+ * nss_bench_nl_open()
+ *	Open the generic netlink socket and resolve the bench family.
+ */
+static int nss_bench_nl_open(void)
+{
+	static char req[NLMSG_HDRLEN + GENL_HDRLEN + 64];
+	struct sockaddr_nl addr = { .nl_family = AF_NETLINK };
+	static struct nss_bench_reply reply;
+	struct nlmsghdr *nlh;
+	int ret;
+
+	nss_bench_fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_GENERIC);
+	if (nss_bench_fd < 0) {
+		return -errno;
+	}
+
+	if (bind(nss_bench_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		return -errno;
+	}
+
+	nlh = nss_bench_nl_msg(req, GENL_ID_CTRL, CTRL_CMD_GETFAMILY, 1);
+	nss_bench_nl_put(nlh, CTRL_ATTR_FAMILY_NAME, NSS_BENCH_NL_FAMILY, sizeof(NSS_BENCH_NL_FAMILY));
+
+	ret = nss_bench_nl_transact(nlh, &reply);
+	if (ret) {
+		return ret;
+	}
+
+	return nss_bench_family ? 0 : -ENOENT;
+}
+
+/*
+ * nss_bench_nl_run()
+ *	Run a test in the driver.
+ */
+static int nss_bench_nl_run(const struct nss_bench_params *p, struct nss_bench_reply *reply)
+{
+	static char req[NLMSG_HDRLEN + GENL_HDRLEN + 256];
+	struct nlmsghdr *nlh;
+
+	nlh = nss_bench_nl_msg(req, nss_bench_family, NSS_BENCH_NL_CMD_RUN, NSS_BENCH_NL_VERSION);
+	nss_bench_nl_put(nlh, NSS_BENCH_NL_ATTR_TEST, &p->test, sizeof(uint32_t));
+	nss_bench_nl_put(nlh, NSS_BENCH_NL_ATTR_REPEAT, &p->repeat, sizeof(uint32_t));
+	nss_bench_nl_put(nlh, NSS_BENCH_NL_ATTR_DURATION, &p->duration, sizeof(uint32_t));
+	nss_bench_nl_put(nlh, NSS_BENCH_NL_ATTR_PKT_SIZE, &p->pkt_size, sizeof(uint32_t));
+	nss_bench_nl_put(nlh, NSS_BENCH_NL_ATTR_BURST, &p->burst, sizeof(uint32_t));
+	nss_bench_nl_put(nlh, NSS_BENCH_NL_ATTR_CORE, &p->core, sizeof(uint32_t));
+	nss_bench_nl_put(nlh, NSS_BENCH_NL_ATTR_FLAGS, &p->flags, sizeof(uint32_t));
+	nss_bench_nl_put(nlh, NSS_BENCH_NL_ATTR_RATE, &p->rate, sizeof(uint32_t));
+	nss_bench_nl_put(nlh, NSS_BENCH_NL_ATTR_SRC_IP, &p->src_ip, sizeof(uint32_t));
+	nss_bench_nl_put(nlh, NSS_BENCH_NL_ATTR_DEST_IP, &p->dest_ip, sizeof(uint32_t));
+	nss_bench_nl_put(nlh, NSS_BENCH_NL_ATTR_SRC_PORT, &p->src_port, sizeof(uint16_t));
+	nss_bench_nl_put(nlh, NSS_BENCH_NL_ATTR_DEST_PORT, &p->dest_port, sizeof(uint16_t));
+	if (p->has_variant) {
+		nss_bench_nl_put(nlh, NSS_BENCH_NL_ATTR_VARIANT, &p->variant, sizeof(uint32_t));
+	}
+
+	return nss_bench_nl_transact(nlh, reply);
+}
+
+/*
+ * nss_bench_mock_run()
+ *	Synthetic samples: about a million packets per second with a few
+ *	percent of noise.
+ */
+static int nss_bench_mock_run(const struct nss_bench_params *p, struct nss_bench_reply *reply)
+{
+	uint32_t i;
+
+	memset(reply, 0, sizeof(*reply));
+	for (i = 0; i < p->repeat; i++) {
+		struct nss_bench_nl_sample *s = &reply->samples[i];
+		double pps = 1e6 * (0.97 + (rand() % 600) / 10000.0);
+		double secs;
+
+		if (p->test == NSS_BENCH_NL_TEST_COPY) {
+			pps = fmin(pps, 2e9 / p->pkt_size);
+		}
+
+		secs = ((p->test == NSS_BENCH_NL_TEST_DMA) || (p->test == NSS_BENCH_NL_TEST_COPY)) ? p->burst / pps : p->duration / 1000.0;
+
+		s->packets = (uint64_t)(pps * secs);
+		s->bytes = ((p->test == NSS_BENCH_NL_TEST_DMA) || (p->test == NSS_BENCH_NL_TEST_STATS_DRV)) ? 0 : s->packets * p->pkt_size;
+		s->elapsed_ns = (uint64_t)(secs * 1e9);
+		s->fw_time = (p->test == NSS_BENCH_NL_TEST_DMA) ? (uint32_t)(secs * 1e6) : 0;
+	}
+
+	reply->num_samples = p->repeat;
+	return 0;
+}
+
+/*
+ * nss_bench_stat_print()
+ *	Summarize one metric over the successful samples.
+ */
+static void nss_bench_stat_print(const char *name, const double *v, uint32_t n, bool comma)
+{
+	struct nss_bench_stat st = { 0 };
+	double sum = 0, sq = 0;
+	uint32_t i;
+
+	for (i = 0; i < n; i++) {
+		st.min = (!i || (v[i] < st.min)) ? v[i] : st.min;
+		st.max = (!i || (v[i] > st.max)) ? v[i] : st.max;
+		sum += v[i];
+	}
+
+	if (n) {
+		st.avg = sum / n;
+	}
+
+	for (i = 0; i < n; i++) {
+		sq += (v[i] - st.avg) * (v[i] - st.avg);
+	}
+
+	if (n > 1) {
+		st.stddev = sqrt(sq / (n - 1));
+	}
+
+	printf("\"%s\":{\"min\":%.3f,\"avg\":%.3f,\"max\":%.3f,\"stddev\":%.3f}%s",
+		name, st.min, st.avg, st.max, st.stddev, comma ? "," : "");
+}
+
+/*
+ * nss_bench_report()
+ *	Print a run as one JSON line.
+ */
+static void nss_bench_report(const struct nss_bench_params *p, const struct nss_bench_reply *reply)
+{
+	double pps[NSS_BENCH_NL_REPEAT_MAX], mbps[NSS_BENCH_NL_REPEAT_MAX];
+	double elapsed[NSS_BENCH_NL_REPEAT_MAX], fw[NSS_BENCH_NL_REPEAT_MAX];
+	uint32_t i, n = 0;
+
+	for (i = 0; i < reply->num_samples; i++) {
+		const struct nss_bench_nl_sample *s = &reply->samples[i];
+		double secs = s->elapsed_ns / 1e9;
+
+		if (s->status || !s->elapsed_ns) {
+			continue;
+		}
+
+		pps[n] = s->packets / secs;
+		mbps[n] = s->bytes * 8 / secs / 1e6;
+		elapsed[n] = s->elapsed_ns / 1e6;
+		fw[n] = s->fw_time;
+		n++;
+	}
+
+	printf("{\"test\":\"%s\",\"label\":\"%s\",\"variant\":%d,\"pkt_size\":%u,\"burst\":%u,\"core\":%u,"
+		"\"duration_ms\":%u,\"rate\":%u,\"flags\":%u,\"repeat\":%u,\"ok\":%u,",
+		nss_bench_test_names[p->test], p->label ? p->label : "", p->has_variant ? (int)p->variant : -1,
+		p->pkt_size, p->burst, p->core, p->duration, p->rate, p->flags, p->repeat, n);
+
+	nss_bench_stat_print("pps", pps, n, true);
+	nss_bench_stat_print("mbps", mbps, n, true);
+	nss_bench_stat_print("elapsed_ms", elapsed, n, true);
+	nss_bench_stat_print("fw_time", fw, n, true);
+
+	printf("\"samples\":[");
+	for (i = 0; i < reply->num_samples; i++) {
+		const struct nss_bench_nl_sample *s = &reply->samples[i];
+
+		printf("%s{\"packets\":%llu,\"bytes\":%llu,\"elapsed_ns\":%llu,\"fw_time\":%u,\"status\":%d}",
+			i ? "," : "", (unsigned long long)s->packets, (unsigned long long)s->bytes,
+			(unsigned long long)s->elapsed_ns, s->fw_time, s->status);
+	}
+
+	printf("]}\n");
+	fflush(stdout);
+}
+
+/*
+ * nss_bench_json_find()
+ *	Point after "key": in a JSON line, searching from a nested object if given.
+ */
+static const char *nss_bench_json_find(const char *line, const char *object, const char *key)
+{
+	char pattern[64];
+	const char *p = line;
+
+	if (object) {
+		snprintf(pattern, sizeof(pattern), "\"%s\":{", object);
+		p = strstr(p, pattern);
+		if (!p) {
+			return NULL;
+		}
+	}
+
+	snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+	p = strstr(p, pattern);
+	return p ? p + strlen(pattern) : NULL;
+}
+
+/*
+ * nss_bench_json_num()
+ *	Number at "key" (of object), NAN if missing.
+ */
+static double nss_bench_json_num(const char *line, const char *object, const char *key)
+{
+	const char *p = nss_bench_json_find(line, object, key);
+
+	return p ? strtod(p, NULL) : NAN;
+}
+
+/*
+ * nss_bench_json_key()
+ *	Identity of a run: test and the parameters that change its results.
+ */
+static void nss_bench_json_key(const char *line, char *key, size_t len)
+{
+	const char *test = nss_bench_json_find(line, NULL, "test");
+	int n = 0;
+
+	if (test && (*test == '"')) {
+		n = (int)strcspn(test + 1, "\"");
+	}
+
+	snprintf(key, len, "%.*s/%g/%g/%g/%g/%g/%g", n, test ? test + 1 : "",
+		nss_bench_json_num(line, NULL, "variant"), nss_bench_json_num(line, NULL, "pkt_size"),
+		nss_bench_json_num(line, NULL, "burst"), nss_bench_json_num(line, NULL, "core"),
+		nss_bench_json_num(line, NULL, "rate"), nss_bench_json_num(line, NULL, "flags"));
+}
+
+/*
+ * nss_bench_compare_metric()
+ *	Compare one metric of two runs; returns true on a regression.
+ */
+static bool nss_bench_compare_metric(const char *key, const char *metric, const char *base, const char *cur,
+			double threshold)
+{
+	double b = nss_bench_json_num(base, metric, "avg"), c = nss_bench_json_num(cur, metric, "avg");
+	double bs = nss_bench_json_num(base, metric, "stddev"), cs = nss_bench_json_num(cur, metric, "stddev");
+	double delta, noise;
+	const char *verdict = "ok";
+
+	if (isnan(b) || isnan(c) || (b <= 0)) {
+		return false;
+	}
+
+	/*
+	 * A change only counts when it is larger than the threshold and than
+	 * twice the combined spread of both runs.
+	 */
+	delta = (c - b) * 100 / b;
+	noise = 2 * sqrt((isnan(bs) ? 0 : bs * bs) + (isnan(cs) ? 0 : cs * cs)) * 100 / b;
+	if ((fabs(delta) > threshold) && (fabs(delta) > noise)) {
+		verdict = delta < 0 ? "regression" : "improvement";
+	}
+
+	printf("{\"run\":\"%s\",\"metric\":\"%s\",\"baseline\":%.3f,\"current\":%.3f,\"delta_pct\":%.2f,"
+		"\"noise_pct\":%.2f,\"verdict\":\"%s\"}\n", key, metric, b, c, delta, noise, verdict);
+	return delta < 0 && strcmp(verdict, "ok");
+}
+
+/*
+ * nss_bench_read_lines()
+ *	Read the runs of a file.
+ */
+static char **nss_bench_read_lines(const char *path, int *count)
+{
+	char **lines = NULL, *line;
+	FILE *fp = fopen(path, "r");
+	int n = 0;
+
+	if (!fp) {
+		return NULL;
+	}
+
+	line = malloc(NSS_BENCH_LINE_MAX);
+	while (line && fgets(line, NSS_BENCH_LINE_MAX, fp)) {
+		char **tmp;
+
+		if (!strstr(line, "\"test\":")) {
+			continue;
+		}
+
+		tmp = realloc(lines, (n + 1) * sizeof(*lines));
+		if (!tmp) {
+			break;
+		}
+
+		lines = tmp;
+		lines[n++] = strdup(line);
+	}
+
+	free(line);
+	fclose(fp);
+	*count = n;
+	return lines ? lines : calloc(1, sizeof(*lines));
+}
+
+/*
+ * nss_bench_compare()
+ *	Compare the runs of a file against a baseline.
+ */
+static int nss_bench_compare(const char *base_path, const char *cur_path, double threshold)
+{
+	char **base, **cur, bkey[256], ckey[256];
+	int nbase = 0, ncur = 0, i, j, regressions = 0;
+
+	base = nss_bench_read_lines(base_path, &nbase);
+	cur = nss_bench_read_lines(cur_path, &ncur);
+	if (!base || !cur) {
+		fprintf(stderr, "cannot read %s\n", base ? cur_path : base_path);
+		return 2;
+	}
+
+	for (i = 0; i < ncur; i++) {
+		bool found = false;
+
+		nss_bench_json_key(cur[i], ckey, sizeof(ckey));
+
+		/*
+		 * The last baseline run of the same key wins.
+		 */
+		for (j = nbase - 1; j >= 0; j--) {
+			nss_bench_json_key(base[j], bkey, sizeof(bkey));
+			if (!strcmp(bkey, ckey)) {
+				found = true;
+				break;
+			}
+		}
+
+		if (!found) {
+			printf("{\"run\":\"%s\",\"verdict\":\"no_baseline\"}\n", ckey);
+			continue;
+		}
+
+		regressions += nss_bench_compare_metric(ckey, "pps", base[j], cur[i], threshold);
+		regressions += nss_bench_compare_metric(ckey, "mbps", base[j], cur[i], threshold);
+	}
+
+	for (i = 0; i < nbase; i++) {
+		free(base[i]);
+	}
+
+	for (i = 0; i < ncur; i++) {
+		free(cur[i]);
+	}
+
+	free(base);
+	free(cur);
+	return regressions ? 1 : 0;
+}
+
+/*
+ * nss_bench_usage()
+ */
+static void nss_bench_usage(const char *prog)
+{
+	fprintf(stderr,
+		"usage: %s list\n"
+		"       %s run dma|c2c|udp_st|stats_drv|copy [options]\n"
+		"       %s compare BASELINE CURRENT [-t PCT]\n"
+		"run options:\n"
+		"  -r, --repeat N        repetitions (default 5, max %d)\n"
+		"  -d, --duration MS     duration of a timed repetition (default 1000)\n"
+		"  -s, --pkt-size N[,N]  payload size, one run per size (default 1400)\n"
+		"  -b, --burst N         packets per loop (default 1)\n"
+		"  -c, --core N          NSS core (default 0)\n"
+		"  -v, --variant N       test type (dma), test ID (c2c) or counter backend\n"
+		"                        (stats_drv: 0 per CPU, 1 shared atomic;\n"
+		"                        copy: 0 memcpy, 1 jobs on CPU, 2 jobs on DMA)\n"
+		"  -f, --flags N         test flags (dma: 1 linearize, 2 split)\n"
+		"  -R, --rate MBPS       transmit rate (udp_st)\n"
+		"      --src IP          source address (udp_st)\n"
+		"      --dst IP          destination address (udp_st)\n"
+		"      --sport PORT      source port (udp_st)\n"
+		"      --dport PORT      destination port (udp_st)\n"
+		"  -l, --label TEXT      label stored with the run\n"
+		"  -M, --mock            synthetic samples instead of the driver\n"
+		"compare options:\n"
+		"  -t, --threshold PCT   smallest change reported (default 5)\n",
+		prog, prog, prog, NSS_BENCH_NL_REPEAT_MAX);
+}
+
+/*
+ * nss_bench_ipv4()
+ *	Parse an IPv4 address to host byte order.
+ */
+static int nss_bench_ipv4(const char *str, uint32_t *ip)
+{
+	struct in_addr in;
+
+	if (inet_pton(AF_INET, str, &in) != 1) {
+		return -EINVAL;
+	}
+
+	*ip = ntohl(in.s_addr);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	static const struct option longopts[] = {
+		{ "repeat", required_argument, NULL, 'r' },
+		{ "duration", required_argument, NULL, 'd' },
+		{ "pkt-size", required_argument, NULL, 's' },
+		{ "burst", required_argument, NULL, 'b' },
+		{ "core", required_argument, NULL, 'c' },
+		{ "variant", required_argument, NULL, 'v' },
+		{ "flags", required_argument, NULL, 'f' },
+		{ "rate", required_argument, NULL, 'R' },
+		{ "src", required_argument, NULL, 1 },
+		{ "dst", required_argument, NULL, 2 },
+		{ "sport", required_argument, NULL, 3 },
+		{ "dport", required_argument, NULL, 4 },
+		{ "label", required_argument, NULL, 'l' },
+		{ "mock", no_argument, NULL, 'M' },
+		{ "threshold", required_argument, NULL, 't' },
+		{ "help", no_argument, NULL, 'h' },
+		{ NULL, 0, NULL, 0 },
+	};
+	struct nss_bench_params p = {
+		.repeat = 5,
+		.duration = 1000,
+		.pkt_size = 1400,
+		.burst = 1,
+		.dest_port = 5201,
+		.src_port = 10000,
+	};
+	static struct nss_bench_reply reply;
+	const char *cmd;
+	const char *sizes = NULL;
+	double threshold = 5;
+	bool mock = false;
+	char *end;
+	int opt, ret;
+	uint32_t i;
+
+	if (argc < 2) {
+		nss_bench_usage(argv[0]);
+		return 2;
+	}
+
+	cmd = argv[1];
+	optind = 2;
+	while ((opt = getopt_long(argc, argv, "r:d:s:b:c:v:f:R:l:Mt:h", longopts, NULL)) != -1) {
+		switch (opt) {
+		case 'r':
+			p.repeat = strtoul(optarg, NULL, 0);
+			break;
+		case 'd':
+			p.duration = strtoul(optarg, NULL, 0);
+			break;
+		case 's':
+			sizes = optarg;
+			break;
+		case 'b':
+			p.burst = strtoul(optarg, NULL, 0);
+			break;
+		case 'c':
+			p.core = strtoul(optarg, NULL, 0);
+			break;
+		case 'v':
+			p.variant = strtoul(optarg, NULL, 0);
+			p.has_variant = true;
+			break;
+		case 'f':
+			p.flags = strtoul(optarg, NULL, 0);
+			break;
+		case 'R':
+			p.rate = strtoul(optarg, NULL, 0);
+			break;
+		case 1:
+		case 2:
+			if (nss_bench_ipv4(optarg, opt == 1 ? &p.src_ip : &p.dest_ip)) {
+				fprintf(stderr, "bad address %s\n", optarg);
+				return 2;
+			}
+			break;
+		case 3:
+			p.src_port = (uint16_t)strtoul(optarg, NULL, 0);
+			break;
+		case 4:
+			p.dest_port = (uint16_t)strtoul(optarg, NULL, 0);
+			break;
+		case 'l':
+			p.label = optarg;
+			break;
+		case 'M':
+			mock = true;
+			break;
+		case 't':
+			threshold = strtod(optarg, NULL);
+			break;
+		default:
+			nss_bench_usage(argv[0]);
+			return opt == 'h' ? 0 : 2;
+		}
+	}
+
+	if (!strcmp(cmd, "compare")) {
+		if (argc - optind != 2) {
+			nss_bench_usage(argv[0]);
+			return 2;
+		}
+
+		return nss_bench_compare(argv[optind], argv[optind + 1], threshold);
+	}
+
+	if (!strcmp(cmd, "list")) {
+		static char req[NLMSG_HDRLEN + GENL_HDRLEN];
+
+		ret = nss_bench_nl_open();
+		if (!ret) {
+			ret = nss_bench_nl_transact(nss_bench_nl_msg(req, nss_bench_family, NSS_BENCH_NL_CMD_LIST,
+							NSS_BENCH_NL_VERSION), &reply);
+		}
+
+		if (ret) {
+			fprintf(stderr, "%s: %s\n", NSS_BENCH_NL_FAMILY, strerror(-ret));
+			return 2;
+		}
+
+		for (i = 0; i < reply.num_tests; i++) {
+			if (reply.tests[i] < NSS_BENCH_NL_TEST_MAX) {
+				printf("%s\n", nss_bench_test_names[reply.tests[i]]);
+			}
+		}
+
+		return 0;
+	}
+
+	if (strcmp(cmd, "run") || (optind >= argc)) {
+		nss_bench_usage(argv[0]);
+		return 2;
+	}
+
+	for (p.test = 0; p.test < NSS_BENCH_NL_TEST_MAX; p.test++) {
+		if (!strcmp(argv[optind], nss_bench_test_names[p.test])) {
+			break;
+		}
+	}
+
+	if ((p.test == NSS_BENCH_NL_TEST_MAX) || !p.repeat || (p.repeat > NSS_BENCH_NL_REPEAT_MAX)) {
+		nss_bench_usage(argv[0]);
+		return 2;
+	}
+
+	/*
+	 * Check the whole payload size list before running anything.
+	 */
+	end = (char *)sizes;
+	while (end && *end) {
+		strtoul(end, &end, 0);
+		if (*end && (*end++ != ',')) {
+			fprintf(stderr, "bad payload size list %s\n", sizes);
+			return 2;
+		}
+	}
+
+	if (!mock) {
+		ret = nss_bench_nl_open();
+		if (ret) {
+			fprintf(stderr, "%s: %s\n", NSS_BENCH_NL_FAMILY, strerror(-ret));
+			return 2;
+		}
+	}
+
+	/*
+	 * One run per payload size of the list.
+	 */
+	end = (char *)sizes;
+	do {
+		if (sizes) {
+			p.pkt_size = strtoul(end, &end, 0);
+			end += (*end == ',');
+		}
+
+		ret = mock ? nss_bench_mock_run(&p, &reply) : nss_bench_nl_run(&p, &reply);
+		if (ret) {
+			fprintf(stderr, "%s %s: %s\n", NSS_BENCH_NL_FAMILY, nss_bench_test_names[p.test], strerror(-ret));
+			return 2;
+		}
+
+		nss_bench_report(&p, &reply);
+	} while (sizes && *end);
+
+	return 0;
+}
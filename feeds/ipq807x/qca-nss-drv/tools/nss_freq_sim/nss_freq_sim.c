@@ -0,0 +1,594 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/*
+ * nss_freq_sim.c
+ *	Replay an instruction count trace through the frequency governors.
+ *
+ *	nss_freq_sim trace.txt
+ *	nss_freq_sim -g pid -l 4 -v trace.txt
+ *	dmesg | nss_freq_sim -
+ *
+ * A trace has one sample per line, one line per millisecond as the NSS
+ * sends core statistics. Lines logged by nss_freq_handle_core_stats()
+ * ("inst_cnt:<hex> backlog:<n>", enabled with dynamic debug) are taken as
+ * they are; other lines are read as "<inst_cnt> [<backlog>]" in any base
+ * strtoul() accepts. Everything else, and '#' comments, is skipped.
+ *
+ * The recorded count is taken as the work the NSS had to do in that
+ * millisecond, so traces should be recorded with auto scaling off at the
+ * highest frequency. The running scale can complete -c percent of its
+ * frequency / 1000 instructions per millisecond, the capacity estimate of
+ * nss_freq_compute_cpu_usage(); the rest is carried over to the next
+ * sample, and a sample that ends with work still carried over is counted
+ * as a missed deadline. The governors see the completed count, averaged
+ * the way nss_freq_scale_frequency() does, and make their decisions with
+ * the same nss_freq_gov.h code the driver runs. A change of scale takes
+ * effect when the NSS acknowledges it, -l samples later, and no further
+ * decision is made until then.
+ *
+ * Without a backlog column the N2H backlog seen by the queue governor is
+ * the carried over work divided by -p instructions per packet.
+ *
+ * -M replays a synthetic trace so the tool can be checked without one. Its
+ * backlog column models a host that takes a fixed number of packets off
+ * the N2H queues per millisecond: bursts and peaks above that rate build a
+ * backlog up to the ring size, and packets of the last millisecond waiting
+ * for the next poll add some noise at any load.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "nss_freq_gov.h"
+
+#define NSS_FREQ_SIM_LINE_MAX		512
+#define NSS_FREQ_SIM_MOCK_SAMPLES	300000	/* Five minutes */
+#define NSS_FREQ_SIM_CAPACITY		75	/* NSS_FREQ_CPU_USAGE_MAX_BOUND of nss_freq.c */
+#define NSS_FREQ_SIM_MOCK_DRAIN		128	/* Packets the host takes off the N2H queues per ms */
+#define NSS_FREQ_SIM_MOCK_RING		1024	/* Deepest N2H backlog */
+
+/*
+ * Trace sample
+ */
+struct nss_freq_sim_sample {
+	uint32_t inst_cnt;	/* Work to do in this millisecond */
+	uint32_t backlog;	/* N2H backlog, when recorded */
+};
+
+/*
+ * Trace being replayed
+ */
+struct nss_freq_sim_trace {
+	struct nss_freq_sim_sample *samples;
+	uint32_t count;
+	uint32_t size;
+	bool has_backlog;	/* At least one sample recorded the backlog */
+};
+
+/*
+ * Replay parameters
+ */
+struct nss_freq_sim_cfg {
+	struct nss_scale_info scale[NSS_FREQ_MAX_SCALE];
+	nss_freq_scales_t start_index;	/* Scale at the start of the trace */
+	uint32_t ack_latency;		/* Samples between a decision and the NSS acknowledging it */
+	uint32_t inst_per_pkt;		/* Work per packet, to estimate the backlog */
+	uint32_t capacity;		/* Usable share of the instructions per ms, in percent */
+	bool verbose;
+};
+
+/*
+ * Replay results for one governor
+ */
+struct nss_freq_sim_result {
+	uint64_t samples_at[NSS_FREQ_MAX_SCALE];	/* Samples run at each scale */
+	uint64_t scale_up;
+	uint64_t scale_down;
+	uint64_t missed;		/* Samples that ended with work carried over */
+	uint64_t max_missed_run;	/* Longest run of consecutive missed samples */
+	uint64_t carried_max;		/* Largest carried over work, in instructions */
+	uint64_t work_total;		/* Work in the trace */
+	uint64_t work_done;		/* Work completed by the end of the trace */
+};
+
+/*
+ * Default scale table, the IPQ807x defaults of nss_hal_pvt.c
+ */
+static const struct nss_scale_info nss_freq_sim_default_scale[NSS_FREQ_MAX_SCALE] = {
+	{187200000, 0x03000, 0x07000},
+	{748800000, 0x07000, 0x14000},
+	{1497600000, 0x14000, 0x25000},
+};
+
+/*
+ * nss_freq_sim_usage()
+ *	Print the usage.
+ */
+static void nss_freq_sim_usage(const char *prog)
+{
+	fprintf(stderr, "Usage: %s [options] <trace|->\n"
+		"       %s -M [options]\n"
+		"  -g <name>\tGovernor to replay: rate_limit, pid, queue or all (default)\n"
+		"  -S <table>\tScales as mhz:min:max,mhz:min:max,mhz:min:max\n"
+		"  -i <index>\tScale at the start of the trace (default 1)\n"
+		"  -l <samples>\tSamples until a change is acknowledged (default 2)\n"
+		"  -p <inst>\tInstructions per packet for the estimated backlog (default 512)\n"
+		"  -c <percent>\tUsable share of frequency / 1000 instructions per ms (default %d)\n"
+		"  -v\t\tPrint every frequency change\n"
+		"  -M\t\tReplay a synthetic trace\n", prog, prog, NSS_FREQ_SIM_CAPACITY);
+}
+
+/*
+ * nss_freq_sim_add()
+ *	Append a sample to the trace.
+ */
+static int nss_freq_sim_add(struct nss_freq_sim_trace *trace, uint32_t inst_cnt, uint32_t backlog)
+{
+	if (trace->count == trace->size) {
+		uint32_t size = trace->size ? trace->size * 2 : 4096;
+		struct nss_freq_sim_sample *samples = realloc(trace->samples, size * sizeof(*samples));
+
+		if (!samples) {
+			return -ENOMEM;
+		}
+
+		trace->samples = samples;
+		trace->size = size;
+	}
+
+	trace->samples[trace->count].inst_cnt = inst_cnt;
+	trace->samples[trace->count].backlog = backlog;
+	trace->count++;
+	return 0;
+}
+
+/*
+ * nss_freq_sim_parse_line()
+ *	Parse one trace line. Returns false if the line holds no sample.
+ */
+static bool nss_freq_sim_parse_line(const char *line, uint32_t *inst_cnt, uint32_t *backlog, bool *has_backlog)
+{
+	const char *p = strstr(line, "inst_cnt:");
+	char *end;
+
+	*has_backlog = false;
+	if (p) {
+		*inst_cnt = strtoul(p + strlen("inst_cnt:"), &end, 16);
+		if (end == p + strlen("inst_cnt:")) {
+			return false;
+		}
+
+		p = strstr(end, "backlog:");
+		if (p) {
+			*backlog = strtoul(p + strlen("backlog:"), NULL, 10);
+			*has_backlog = true;
+		}
+
+		return true;
+	}
+
+	while (*line == ' ' || *line == '\t') {
+		line++;
+	}
+
+	if (*line < '0' || *line > '9') {
+		return false;
+	}
+
+	*inst_cnt = strtoul(line, &end, 0);
+	while (*end == ' ' || *end == '\t') {
+		end++;
+	}
+
+	if (*end >= '0' && *end <= '9') {
+		*backlog = strtoul(end, NULL, 0);
+		*has_backlog = true;
+	}
+
+	return true;
+}
+
+/*
+ * nss_freq_sim_load()
+ *	Read a trace file, or stdin for "-".
+ */
+static int nss_freq_sim_load(struct nss_freq_sim_trace *trace, const char *path)
+{
+	char line[NSS_FREQ_SIM_LINE_MAX];
+	FILE *fp = stdin;
+	int ret = 0;
+
+	if (strcmp(path, "-")) {
+		fp = fopen(path, "r");
+		if (!fp) {
+			return -errno;
+		}
+	}
+
+	while (fgets(line, sizeof(line), fp)) {
+		uint32_t inst_cnt, backlog = 0;
+		bool has_backlog;
+
+		if (!nss_freq_sim_parse_line(line, &inst_cnt, &backlog, &has_backlog)) {
+			continue;
+		}
+
+		trace->has_backlog |= has_backlog;
+		ret = nss_freq_sim_add(trace, inst_cnt, backlog);
+		if (ret) {
+			break;
+		}
+	}
+
+	if (fp != stdin) {
+		fclose(fp);
+	}
+
+	return ret;
+}
+
+/*
+ * nss_freq_sim_mock()
+ *	Build a synthetic trace: idle periods, ramps, steady traffic and bursts.
+ */
+static int nss_freq_sim_mock(struct nss_freq_sim_trace *trace, uint32_t count, uint32_t inst_per_pkt)
+{
+	uint32_t seed = 1, queued = 0;
+	uint32_t i;
+
+	for (i = 0; i < count; i++) {
+		uint32_t phase = (i / 20000) % 6;
+		uint32_t pos = i % 20000;
+		uint32_t inst_cnt, packets, backlog;
+		int ret;
+
+		seed = seed * 1103515245 + 12345;
+
+		switch (phase) {
+		case 0:
+			inst_cnt = 0x1000;
+			break;
+		case 1:
+			inst_cnt = 0x1000 + (pos * 0x28000) / 20000;
+			break;
+		case 2:
+			inst_cnt = 0x18000;
+			break;
+		case 3:
+			inst_cnt = (pos % 2000) < 200 ? 0x40000 : 0x4000;
+			break;
+		case 4:
+			inst_cnt = 0x29000 - (pos * 0x28000) / 20000;
+			break;
+		default:
+			inst_cnt = 0x8000;
+			break;
+		}
+
+		inst_cnt += (seed >> 16) & 0xfff;
+
+		/*
+		 * Packets left after the host drained its share, plus up to a
+		 * quarter of this millisecond's packets waiting for the next poll.
+		 */
+		packets = inst_cnt / inst_per_pkt;
+		queued += packets;
+		queued -= queued < NSS_FREQ_SIM_MOCK_DRAIN ? queued : NSS_FREQ_SIM_MOCK_DRAIN;
+		if (queued > NSS_FREQ_SIM_MOCK_RING) {
+			queued = NSS_FREQ_SIM_MOCK_RING;
+		}
+
+		backlog = queued + packets * ((seed >> 8) & 0x3f) / 256;
+		if (backlog > NSS_FREQ_SIM_MOCK_RING) {
+			backlog = NSS_FREQ_SIM_MOCK_RING;
+		}
+
+		ret = nss_freq_sim_add(trace, inst_cnt, backlog);
+		if (ret) {
+			return ret;
+		}
+	}
+
+	trace->has_backlog = true;
+	return 0;
+}
+
+/*
+ * nss_freq_sim_parse_scales()
+ *	Parse the -S scale table.
+ */
+static bool nss_freq_sim_parse_scales(struct nss_scale_info *scale, const char *arg)
+{
+	const char *p = arg;
+	int i;
+
+	for (i = 0; i < NSS_FREQ_MAX_SCALE; i++) {
+		unsigned long mhz, min, max;
+		char *end;
+
+		mhz = strtoul(p, &end, 0);
+		if (*end != ':') {
+			return false;
+		}
+
+		min = strtoul(end + 1, &end, 0);
+		if (*end != ':') {
+			return false;
+		}
+
+		max = strtoul(end + 1, &end, 0);
+		if ((i < NSS_FREQ_MAX_SCALE - 1) ? (*end != ',') : (*end != '\0')) {
+			return false;
+		}
+
+		scale[i].frequency = mhz * 1000000;
+		scale[i].minimum = min;
+		scale[i].maximum = max;
+		p = end + 1;
+	}
+
+	return true;
+}
+
+/*
+ * nss_freq_sim_run()
+ *	Replay the trace through one governor.
+ */
+static void nss_freq_sim_run(const struct nss_freq_sim_cfg *cfg, const struct nss_freq_sim_trace *trace,
+				int gov_id, struct nss_freq_sim_result *res)
+{
+	uint32_t buffer[NSS_SAMPLE_BUFFER_SIZE] = {0};
+	uint32_t buffer_index = 0, sample_count = 0, sum = 0;
+	nss_freq_scales_t index = cfg->start_index;	/* Scale the governor asked for */
+	nss_freq_scales_t running = cfg->start_index;	/* Scale the NSS runs at */
+	uint32_t ack_wait = 0;
+	uint64_t carried = 0;
+	uint64_t missed_run = 0;
+	struct nss_freq_gov gov;
+	uint32_t i;
+
+	memset(res, 0, sizeof(*res));
+	nss_freq_gov_reset(&gov);
+
+	for (i = 0; i < trace->count; i++) {
+		uint32_t capacity = (uint64_t)cfg->scale[running].frequency / 1000 * cfg->capacity / 100;
+		uint32_t done, backlog, average;
+		nss_freq_scales_t target;
+
+		/*
+		 * Run the sample at the running scale
+		 */
+		res->work_total += trace->samples[i].inst_cnt;
+		carried += trace->samples[i].inst_cnt;
+		done = carried < capacity ? carried : capacity;
+		carried -= done;
+		res->work_done += done;
+		res->samples_at[running]++;
+
+		if (carried) {
+			res->missed++;
+			if (++missed_run > res->max_missed_run) {
+				res->max_missed_run = missed_run;
+			}
+
+			if (carried > res->carried_max) {
+				res->carried_max = carried;
+			}
+		} else {
+			missed_run = 0;
+		}
+
+		backlog = trace->has_backlog ? trace->samples[i].backlog : carried / cfg->inst_per_pkt;
+
+		/*
+		 * The NSS acknowledges a change ack_latency samples after it was asked for
+		 */
+		if (ack_wait && !--ack_wait) {
+			running = index;
+		}
+
+		/*
+		 * Running average, as in nss_freq_scale_frequency()
+		 */
+		sum -= buffer[buffer_index];
+		buffer[buffer_index] = done;
+		sum += done;
+		buffer_index = (buffer_index + 1) & NSS_SAMPLE_BUFFER_MASK;
+		if (sample_count < NSS_SAMPLE_BUFFER_SIZE) {
+			sample_count++;
+			continue;
+		}
+
+		average = sum / sample_count;
+		if (ack_wait) {
+			continue;
+		}
+
+		target = nss_freq_gov_select(gov_id, &gov, cfg->scale, index, average, backlog);
+		if (target == index) {
+			continue;
+		}
+
+		if (cfg->verbose) {
+			printf("%s: %10u ms: %u -> %u MHz, average:%x backlog:%u\n", nss_freq_gov_name(gov_id), i,
+				cfg->scale[index].frequency / 1000000, cfg->scale[target].frequency / 1000000, average, backlog);
+		}
+
+		if (target > index) {
+			res->scale_up++;
+		} else {
+			res->scale_down++;
+		}
+
+		index = target;
+		if (!cfg->ack_latency) {
+			running = index;
+			continue;
+		}
+
+		ack_wait = cfg->ack_latency;
+	}
+}
+
+/*
+ * nss_freq_sim_print()
+ *	Print the results of one governor.
+ */
+static void nss_freq_sim_print(const struct nss_freq_sim_cfg *cfg, const struct nss_freq_sim_trace *trace,
+				int gov_id, const struct nss_freq_sim_result *res)
+{
+	uint64_t mhz_ms = 0;
+	int i;
+
+	printf("governor %s\n", nss_freq_gov_name(gov_id));
+	printf("  %-10s %12s %8s\n", "frequency", "time (ms)", "share");
+	for (i = 0; i < NSS_FREQ_MAX_SCALE; i++) {
+		if (!cfg->scale[i].maximum) {
+			continue;
+		}
+
+		printf("  %6u MHz %12llu %7.2f%%\n", cfg->scale[i].frequency / 1000000,
+			(unsigned long long)res->samples_at[i], 100.0 * res->samples_at[i] / trace->count);
+		mhz_ms += (uint64_t)res->samples_at[i] * (cfg->scale[i].frequency / 1000000);
+	}
+
+	printf("  average frequency:\t%llu MHz\n", (unsigned long long)(mhz_ms / trace->count));
+	printf("  switches:\t\t%llu up, %llu down\n", (unsigned long long)res->scale_up, (unsigned long long)res->scale_down);
+	printf("  missed deadlines:\t%llu ms (%.3f%%), longest run %llu ms\n", (unsigned long long)res->missed,
+		100.0 * res->missed / trace->count, (unsigned long long)res->max_missed_run);
+	printf("  carried over work:\tpeak %llu inst, %llu inst left at the end\n",
+		(unsigned long long)res->carried_max, (unsigned long long)(res->work_total - res->work_done));
+}
+
+int main(int argc, char *argv[])
+{
+	struct nss_freq_sim_trace trace = {0};
+	struct nss_freq_sim_cfg cfg;
+	struct nss_freq_sim_result res;
+	int gov_first = 0, gov_last = NSS_FREQ_GOV_MAX - 1;
+	bool mock = false;
+	int ret, opt, i;
+
+	memset(&cfg, 0, sizeof(cfg));
+	memcpy(cfg.scale, nss_freq_sim_default_scale, sizeof(cfg.scale));
+	cfg.start_index = NSS_FREQ_MID_SCALE;
+	cfg.ack_latency = 2;
+	cfg.inst_per_pkt = 512;
+	cfg.capacity = NSS_FREQ_SIM_CAPACITY;
+
+	while ((opt = getopt(argc, argv, "g:S:i:l:p:c:vMh")) != -1) {
+		switch (opt) {
+		case 'g':
+			if (!strcmp(optarg, "all")) {
+				break;
+			}
+
+			for (i = 0; i < NSS_FREQ_GOV_MAX; i++) {
+				if (!strcmp(optarg, nss_freq_gov_name(i))) {
+					break;
+				}
+			}
+
+			if (i == NSS_FREQ_GOV_MAX) {
+				fprintf(stderr, "Unknown governor %s\n", optarg);
+				return 2;
+			}
+
+			gov_first = gov_last = i;
+			break;
+		case 'S':
+			if (!nss_freq_sim_parse_scales(cfg.scale, optarg)) {
+				fprintf(stderr, "Invalid scale table %s\n", optarg);
+				return 2;
+			}
+			break;
+		case 'i':
+			cfg.start_index = strtoul(optarg, NULL, 0);
+			if (cfg.start_index >= NSS_FREQ_MAX_SCALE) {
+				fprintf(stderr, "Invalid scale index %s\n", optarg);
+				return 2;
+			}
+			break;
+		case 'l':
+			cfg.ack_latency = strtoul(optarg, NULL, 0);
+			break;
+		case 'p':
+			cfg.inst_per_pkt = strtoul(optarg, NULL, 0);
+			if (!cfg.inst_per_pkt) {
+				fprintf(stderr, "Invalid instructions per packet %s\n", optarg);
+				return 2;
+			}
+			break;
+		case 'c':
+			cfg.capacity = strtoul(optarg, NULL, 0);
+			if (!cfg.capacity) {
+				fprintf(stderr, "Invalid capacity %s\n", optarg);
+				return 2;
+			}
+			break;
+		case 'v':
+			cfg.verbose = true;
+			break;
+		case 'M':
+			mock = true;
+			break;
+		default:
+			nss_freq_sim_usage(argv[0]);
+			return 2;
+		}
+	}
+
+	if (!mock && optind >= argc) {
+		nss_freq_sim_usage(argv[0]);
+		return 2;
+	}
+
+	if (!cfg.scale[cfg.start_index].maximum) {
+		fprintf(stderr, "Scale %u is not configured\n", cfg.start_index);
+		return 2;
+	}
+
+	ret = mock ? nss_freq_sim_mock(&trace, NSS_FREQ_SIM_MOCK_SAMPLES, cfg.inst_per_pkt) : nss_freq_sim_load(&trace, argv[optind]);
+	if (ret) {
+		fprintf(stderr, "Unable to read the trace: %s\n", strerror(-ret));
+		free(trace.samples);
+		return 1;
+	}
+
+	if (!trace.count) {
+		fprintf(stderr, "No samples in the trace\n");
+		free(trace.samples);
+		return 1;
+	}
+
+	printf("%u samples (%u ms), backlog %s\n", trace.count, trace.count,
+		trace.has_backlog ? "recorded" : "estimated from carried over work");
+
+	for (i = gov_first; i <= gov_last; i++) {
+		nss_freq_sim_run(&cfg, &trace, i, &res);
+		nss_freq_sim_print(&cfg, &trace, i, &res);
+	}
+
+	free(trace.samples);
+	return 0;
+}
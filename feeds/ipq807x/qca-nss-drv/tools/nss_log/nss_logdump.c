@@ -0,0 +1,416 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/*
+ * nss_logdump.c
+ *	Decode the NSS FW log ring and capture it to a file.
+ *
+ *	nss_logdump /sys/kernel/debug/qca-nss-drv/logs/core0
+ *	nss_logdump -f -w core0.nsslog /sys/kernel/debug/qca-nss-drv/logs/core0
+ *	nss_logdump -r core0.nsslog
+ *
+ * The log file is mapped read-only. Entries between the oldest one still
+ * in the ring and the producer index (current_entry) are copied out in one
+ * go and decoded; current_entry is read again after the copy and entries
+ * the NSS may have overwritten meanwhile are dropped and counted as lost.
+ *
+ * -f keeps following the ring every -i milliseconds until interrupted.
+ * -w also writes the raw entries to a capture file, which -r decodes
+ * later, on any host. -M follows a synthetic ring with a fake producer so
+ * the tool can be checked without the driver.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "nss_log_ring.h"
+
+#define NSS_LOGDUMP_CAPTURE_MAGIC	0x4e534c43	/* "NSLC" */
+#define NSS_LOGDUMP_CAPTURE_VERSION	1
+#define NSS_LOGDUMP_MOCK_ENTRIES	64
+
+/*
+ * Header of a capture file, followed by raw struct nss_log_entry records
+ */
+struct nss_logdump_capture_hdr {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t entry_size;
+};
+
+/*
+ * Ring being followed
+ */
+struct nss_logdump_ring {
+	volatile struct nss_log_descriptor *desc;
+	size_t map_size;
+	uint32_t nentries;
+	uint32_t last_entry;	/* Next entry to decode */
+	struct nss_log_entry *copy;
+	uint64_t decoded;
+	uint64_t lost;
+	bool mock;
+	uint32_t mock_seq;
+};
+
+static volatile sig_atomic_t nss_logdump_stop;
+
+/*
+ * nss_logdump_sigint()
+ *	Stop following.
+ */
+static void nss_logdump_sigint(__attribute__((unused)) int sig)
+{
+	nss_logdump_stop = 1;
+}
+
+/*
+ * nss_logdump_print()
+ *	Print one entry like the qca-nss-drv/logs/coreN text file does.
+ */
+static void nss_logdump_print(const struct nss_log_entry *le)
+{
+	printf("%3u: %010u: %.*s\n", le->thread_num, le->timestamp,
+		(int)strnlen(le->message, NSS_LOG_LINE_WIDTH), le->message);
+}
+
+/*
+ * nss_logdump_mock_produce()
+ *	Fake producer: append a burst of entries to the synthetic ring.
+ */
+static void nss_logdump_mock_produce(struct nss_logdump_ring *ring)
+{
+	volatile struct nss_log_descriptor *desc = ring->desc;
+	uint32_t burst = 1 + (ring->mock_seq * 7) % 100;
+	uint32_t i;
+
+	for (i = 0; i < burst; i++) {
+		uint32_t entry = desc->current_entry;
+		struct nss_log_entry *le = (struct nss_log_entry *)&desc->log_ring_buffer[entry % ring->nentries];
+
+		le->sequence_num = entry;
+		le->cookie = NSS_LOG_COOKIE;
+		le->thread_num = entry % 4;
+		le->timestamp = entry * 1000;
+		snprintf(le->message, sizeof(le->message), "mock log line %u", entry);
+		__atomic_store_n(&desc->current_entry, entry + 1, __ATOMIC_RELEASE);
+	}
+
+	ring->mock_seq++;
+}
+
+/*
+ * nss_logdump_open()
+ *	Map the log ring of path, or build a synthetic one.
+ */
+static int nss_logdump_open(struct nss_logdump_ring *ring, const char *path, bool mock)
+{
+	long page = sysconf(_SC_PAGESIZE);
+	void *map;
+	int fd;
+
+	memset(ring, 0, sizeof(*ring));
+	ring->mock = mock;
+	if (mock) {
+		ring->nentries = NSS_LOGDUMP_MOCK_ENTRIES;
+		ring->map_size = sizeof(struct nss_log_descriptor) + ring->nentries * sizeof(struct nss_log_entry);
+		ring->desc = calloc(1, ring->map_size);
+		if (!ring->desc) {
+			return -ENOMEM;
+		}
+
+		ring->desc->cookie = NSS_LOG_COOKIE;
+		ring->desc->log_nentries = ring->nentries;
+		goto copy;
+	}
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		return -errno;
+	}
+
+	/*
+	 * Map the descriptor to learn the ring size, then the whole ring
+	 */
+	map = mmap(NULL, page, PROT_READ, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED) {
+		close(fd);
+		return -errno;
+	}
+
+	ring->nentries = ((struct nss_log_descriptor *)map)->log_nentries;
+	munmap(map, page);
+	if (!ring->nentries) {
+		close(fd);
+		return -EINVAL;
+	}
+
+	ring->map_size = sizeof(struct nss_log_descriptor) + (size_t)ring->nentries * sizeof(struct nss_log_entry);
+	ring->map_size = (ring->map_size + page - 1) & ~(size_t)(page - 1);
+	map = mmap(NULL, ring->map_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		return -errno;
+	}
+
+	ring->desc = map;
+
+copy:
+	ring->copy = malloc((size_t)ring->nentries * sizeof(struct nss_log_entry));
+	if (!ring->copy) {
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+/*
+ * nss_logdump_close()
+ *	Release the ring.
+ */
+static void nss_logdump_close(struct nss_logdump_ring *ring)
+{
+	if (ring->mock) {
+		free((void *)ring->desc);
+	} else if (ring->desc) {
+		munmap((void *)ring->desc, ring->map_size);
+	}
+
+	free(ring->copy);
+}
+
+/*
+ * nss_logdump_poll()
+ *	Decode, and capture to cfp when set, the entries produced since the last poll.
+ *
+ * Returns the number of entries decoded.
+ */
+static uint32_t nss_logdump_poll(struct nss_logdump_ring *ring, FILE *cfp)
+{
+	uint32_t entry, start, count, first, index, i, skip;
+
+	if (ring->mock) {
+		nss_logdump_mock_produce(ring);
+	}
+
+	entry = __atomic_load_n(&ring->desc->current_entry, __ATOMIC_ACQUIRE);
+	if (entry == ring->last_entry) {
+		return 0;
+	}
+
+	/*
+	 * Only the last nentries entries are still in the ring
+	 */
+	start = ring->last_entry;
+	if (entry - start > ring->nentries) {
+		ring->lost += entry - ring->nentries - start;
+		start = entry - ring->nentries;
+	}
+
+	count = entry - start;
+	index = start % ring->nentries;
+	first = ring->nentries - index;
+	if (first > count) {
+		first = count;
+	}
+
+	memcpy(ring->copy, (const void *)&ring->desc->log_ring_buffer[index], first * sizeof(struct nss_log_entry));
+	memcpy(ring->copy + first, (const void *)&ring->desc->log_ring_buffer[0], (count - first) * sizeof(struct nss_log_entry));
+
+	/*
+	 * Drop what the NSS overwrote while we were copying
+	 */
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	skip = 0;
+	i = __atomic_load_n(&ring->desc->current_entry, __ATOMIC_ACQUIRE);
+	if (i - start > ring->nentries) {
+		skip = i - ring->nentries - start;
+		if (skip > count) {
+			skip = count;
+		}
+
+		ring->lost += skip;
+	}
+
+	for (i = skip; i < count; i++) {
+		nss_logdump_print(&ring->copy[i]);
+	}
+
+	if (cfp && (count > skip)) {
+		fwrite(ring->copy + skip, sizeof(struct nss_log_entry), count - skip, cfp);
+	}
+
+	ring->last_entry = entry;
+	ring->decoded += count - skip;
+	return count - skip;
+}
+
+/*
+ * nss_logdump_replay()
+ *	Decode a capture file.
+ */
+static int nss_logdump_replay(const char *path)
+{
+	struct nss_logdump_capture_hdr hdr;
+	struct nss_log_entry le[64];
+	size_t n, i;
+	FILE *fp;
+
+	fp = fopen(path, "rb");
+	if (!fp) {
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+		return 1;
+	}
+
+	if ((fread(&hdr, sizeof(hdr), 1, fp) != 1) || (hdr.magic != NSS_LOGDUMP_CAPTURE_MAGIC)
+			|| (hdr.version != NSS_LOGDUMP_CAPTURE_VERSION) || (hdr.entry_size != sizeof(struct nss_log_entry))) {
+		fprintf(stderr, "%s: not a log capture of this version\n", path);
+		fclose(fp);
+		return 1;
+	}
+
+	while ((n = fread(le, sizeof(le[0]), sizeof(le) / sizeof(le[0]), fp)) > 0) {
+		for (i = 0; i < n; i++) {
+			nss_logdump_print(&le[i]);
+		}
+	}
+
+	fclose(fp);
+	return 0;
+}
+
+/*
+ * nss_logdump_usage()
+ *	Print the usage.
+ */
+static void nss_logdump_usage(const char *prog)
+{
+	fprintf(stderr, "usage: %s [-f] [-i interval_ms] [-w capture] logs/coreN\n"
+		"       %s -M [-f] [-i interval_ms] [-w capture]\n"
+		"       %s -r capture\n"
+		"  -f       follow the ring until interrupted\n"
+		"  -i ms    poll interval when following (default 100)\n"
+		"  -w file  also write the raw entries to a capture file\n"
+		"  -r file  decode a capture file\n"
+		"  -M       follow a synthetic ring\n", prog, prog, prog);
+}
+
+int main(int argc, char **argv)
+{
+	struct nss_logdump_capture_hdr hdr;
+	struct nss_logdump_ring ring;
+	const char *capture = NULL, *replay = NULL;
+	uint32_t interval = 100, polls = 0;
+	bool follow = false, mock = false;
+	FILE *cfp = NULL;
+	int opt, ret;
+
+	while ((opt = getopt(argc, argv, "fi:w:r:Mh")) != -1) {
+		switch (opt) {
+		case 'f':
+			follow = true;
+			break;
+
+		case 'i':
+			interval = strtoul(optarg, NULL, 0);
+			break;
+
+		case 'w':
+			capture = optarg;
+			break;
+
+		case 'r':
+			replay = optarg;
+			break;
+
+		case 'M':
+			mock = true;
+			break;
+
+		default:
+			nss_logdump_usage(argv[0]);
+			return 2;
+		}
+	}
+
+	if (replay) {
+		return nss_logdump_replay(replay);
+	}
+
+	if (!mock && (optind >= argc)) {
+		nss_logdump_usage(argv[0]);
+		return 2;
+	}
+
+	ret = nss_logdump_open(&ring, mock ? NULL : argv[optind], mock);
+	if (ret) {
+		fprintf(stderr, "%s: %s\n", mock ? "mock" : argv[optind], strerror(-ret));
+		nss_logdump_close(&ring);
+		return 1;
+	}
+
+	if (capture) {
+		cfp = fopen(capture, "wb");
+		if (!cfp) {
+			fprintf(stderr, "%s: %s\n", capture, strerror(errno));
+			nss_logdump_close(&ring);
+			return 1;
+		}
+
+		hdr.magic = NSS_LOGDUMP_CAPTURE_MAGIC;
+		hdr.version = NSS_LOGDUMP_CAPTURE_VERSION;
+		hdr.entry_size = sizeof(struct nss_log_entry);
+		fwrite(&hdr, sizeof(hdr), 1, cfp);
+	}
+
+	signal(SIGINT, nss_logdump_sigint);
+	signal(SIGTERM, nss_logdump_sigint);
+
+	do {
+		nss_logdump_poll(&ring, cfp);
+		fflush(stdout);
+
+		/*
+		 * The synthetic ring stops on its own so that -M -f can be scripted
+		 */
+		if (mock && (++polls == 50)) {
+			break;
+		}
+
+		if (follow && !nss_logdump_stop) {
+			usleep(interval * 1000);
+		}
+	} while (follow && !nss_logdump_stop);
+
+	fprintf(stderr, "%llu entries decoded, %llu lost\n",
+		(unsigned long long)ring.decoded, (unsigned long long)ring.lost);
+
+	if (cfp) {
+		fclose(cfp);
+	}
+
+	nss_logdump_close(&ring);
+	return 0;
+}
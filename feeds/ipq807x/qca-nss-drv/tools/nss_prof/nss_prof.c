@@ -0,0 +1,472 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2020, The Linux Foundation. All rights reserved.
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/*
+ * nss_prof.c
+ *	Convert an NSS profiler capture to perf script or folded stacks.
+ *
+ * A capture is what was read from qca-nss-drv/profiler in debugfs while
+ * dev.nss.general.profiler_collect was set, e.g.
+ *
+ *	echo 1024 > /proc/sys/dev/nss/general/profiler_collect
+ *	cat /sys/kernel/debug/qca-nss-drv/profiler > nss.prof
+ *
+ * It runs on any host, so captures can be decoded off target:
+ *
+ *	nss_prof -s qca-nss0.sym nss.prof > nss.perf
+ *	nss_prof -F -s qca-nss0.sym nss.prof | flamegraph.pl > nss.svg
+ *
+ * The symbol file is "nm -n" output of the firmware ELF (or a System.map).
+ *
+ * Each sample message starts with a header whose third byte holds its size
+ * and fourth byte the number of samples, followed by fixed size samples with
+ * the PC and the return addresses of the callers. The layout belongs to the
+ * firmware, so all of it can be changed from the command line.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "nss_profiler_record.h"
+
+#define NSS_PROF_MAX_FRAMES	8
+#define NSS_PROF_MAX_PAYLOAD	(64 * 1024)
+
+/*
+ * Firmware sample layout
+ */
+struct nss_prof_layout {
+	int header_size;		/* Header size, -1 to read it from the header */
+	int sample_count;		/* Samples per message, -1 to read it from the header */
+	int stride;			/* Size of a sample */
+	int pc;				/* Offset of the PC in a sample */
+	int frames[NSS_PROF_MAX_FRAMES];
+					/* Offsets of the caller return addresses */
+	int num_frames;			/* Number of caller return addresses */
+	int thread;			/* Offset of the thread number, -1 if none */
+	bool big_endian;		/* Firmware data is big endian */
+};
+
+/*
+ * Symbol from the symbol file
+ */
+struct nss_prof_sym {
+	uint32_t addr;			/* Start address */
+	char *name;			/* Symbol name */
+};
+
+/*
+ * Folded stack and its sample count
+ */
+struct nss_prof_stack {
+	char *stack;			/* Frames separated by ';', outermost first */
+	unsigned long count;		/* Number of samples */
+};
+
+static struct nss_prof_sym *syms;
+static size_t num_syms;
+static struct nss_prof_stack *stacks;
+static size_t num_stacks, max_stacks;
+static unsigned long total_samples, total_dropped, total_bad;
+
+/*
+ * nss_prof_sym_cmp()
+ *	Order symbols by address.
+ */
+static int nss_prof_sym_cmp(const void *a, const void *b)
+{
+	const struct nss_prof_sym *sa = a, *sb = b;
+
+	return (sa->addr > sb->addr) - (sa->addr < sb->addr);
+}
+
+/*
+ * nss_prof_sym_load()
+ *	Read "address type name" lines, keeping text symbols.
+ */
+static int nss_prof_sym_load(const char *path)
+{
+	char line[512], name[400], type;
+	unsigned long addr;
+	size_t max = 0;
+	FILE *fp;
+
+	fp = fopen(path, "r");
+	if (!fp) {
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+		return -1;
+	}
+
+	while (fgets(line, sizeof(line), fp)) {
+		if (sscanf(line, "%lx %c %399s", &addr, &type, name) != 3)
+			continue;
+
+		if (type != 't' && type != 'T' && type != 'w' && type != 'W')
+			continue;
+
+		if (num_syms == max) {
+			max = max ? max * 2 : 1024;
+			syms = realloc(syms, max * sizeof(*syms));
+			if (!syms) {
+				fclose(fp);
+				return -1;
+			}
+		}
+
+		syms[num_syms].addr = (uint32_t)addr;
+		syms[num_syms].name = strdup(name);
+		num_syms++;
+	}
+
+	fclose(fp);
+	qsort(syms, num_syms, sizeof(*syms), nss_prof_sym_cmp);
+	return 0;
+}
+
+/*
+ * nss_prof_sym_find()
+ *	Symbol containing addr, NULL if below the first one.
+ */
+static struct nss_prof_sym *nss_prof_sym_find(uint32_t addr)
+{
+	size_t lo = 0, hi = num_syms;
+
+	while (lo < hi) {
+		size_t mid = (lo + hi) / 2;
+
+		if (syms[mid].addr <= addr)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo ? &syms[lo - 1] : NULL;
+}
+
+/*
+ * nss_prof_get32()
+ *	Read a firmware word.
+ */
+static uint32_t nss_prof_get32(const uint8_t *p, bool big_endian)
+{
+	if (big_endian)
+		return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+
+	return (uint32_t)p[3] << 24 | (uint32_t)p[2] << 16 | (uint32_t)p[1] << 8 | p[0];
+}
+
+/*
+ * nss_prof_stack_add()
+ *	Count one sample of a folded stack.
+ */
+static void nss_prof_stack_add(const char *stack)
+{
+	size_t i;
+
+	/*
+	 * Most samples hit a few hot stacks; look at the recent ones first.
+	 */
+	for (i = num_stacks; i > 0; i--) {
+		if (!strcmp(stacks[i - 1].stack, stack)) {
+			stacks[i - 1].count++;
+			return;
+		}
+	}
+
+	if (num_stacks == max_stacks) {
+		max_stacks = max_stacks ? max_stacks * 2 : 1024;
+		stacks = realloc(stacks, max_stacks * sizeof(*stacks));
+		if (!stacks) {
+			fprintf(stderr, "out of memory\n");
+			exit(1);
+		}
+	}
+
+	stacks[num_stacks].stack = strdup(stack);
+	stacks[num_stacks].count = 1;
+	num_stacks++;
+}
+
+/*
+ * nss_prof_stack_cmp()
+ *	Order folded stacks by name.
+ */
+static int nss_prof_stack_cmp(const void *a, const void *b)
+{
+	const struct nss_prof_stack *sa = a, *sb = b;
+
+	return strcmp(sa->stack, sb->stack);
+}
+
+/*
+ * nss_prof_sample()
+ *	Output one sample, frames[0] being the PC.
+ */
+static void nss_prof_sample(const struct nss_profiler_record *rec, uint32_t thread,
+				const uint32_t *frames, int num_frames, bool folded)
+{
+	char stack[NSS_PROF_MAX_FRAMES * 128];
+	size_t len = 0;
+	int i;
+
+	if (!folded) {
+		printf("nss-core%u %u/%u [%03u] %llu.%06llu: 1 cycles:\n",
+				rec->core, rec->core, thread, rec->core,
+				(unsigned long long)(rec->ts_ns / 1000000000ULL),
+				(unsigned long long)(rec->ts_ns % 1000000000ULL) / 1000);
+
+		for (i = 0; i < num_frames; i++) {
+			struct nss_prof_sym *sym = nss_prof_sym_find(frames[i]);
+
+			if (sym)
+				printf("\t%8x %s+0x%x (nss-fw)\n", frames[i], sym->name, frames[i] - sym->addr);
+			else
+				printf("\t%8x [unknown] (nss-fw)\n", frames[i]);
+		}
+
+		printf("\n");
+		return;
+	}
+
+	len += snprintf(stack + len, sizeof(stack) - len, "nss-core%u;thread%u", rec->core, thread);
+	for (i = num_frames - 1; i >= 0 && len < sizeof(stack); i--) {
+		struct nss_prof_sym *sym = nss_prof_sym_find(frames[i]);
+
+		if (sym)
+			len += snprintf(stack + len, sizeof(stack) - len, ";%s", sym->name);
+		else
+			len += snprintf(stack + len, sizeof(stack) - len, ";0x%x", frames[i]);
+	}
+
+	nss_prof_stack_add(stack);
+}
+
+/*
+ * nss_prof_samples()
+ *	Decode a sample message.
+ */
+static void nss_prof_samples(const struct nss_profiler_record *rec, const uint8_t *payload,
+				const struct nss_prof_layout *l, bool folded)
+{
+	uint32_t frames[NSS_PROF_MAX_FRAMES + 1];
+	int header_size = l->header_size;
+	int count = l->sample_count;
+	int i, j, n;
+
+	if (header_size < 0)
+		header_size = rec->len > 2 ? payload[2] : 0;
+
+	if (count < 0)
+		count = rec->len > 3 ? payload[3] : 0;
+
+	if (header_size < 4 || (uint32_t)header_size > rec->len) {
+		total_bad++;
+		return;
+	}
+
+	if ((uint32_t)(header_size + count * l->stride) > rec->len) {
+		total_bad++;
+		count = (rec->len - header_size) / l->stride;
+	}
+
+	for (i = 0; i < count; i++) {
+		const uint8_t *s = payload + header_size + i * l->stride;
+		uint32_t thread = l->thread >= 0 ? s[l->thread] : 0;
+
+		frames[0] = nss_prof_get32(s + l->pc, l->big_endian);
+		for (j = 0, n = 1; j < l->num_frames; j++) {
+			uint32_t ret = nss_prof_get32(s + l->frames[j], l->big_endian);
+
+			/*
+			 * A zero return address ends the chain.
+			 */
+			if (!ret)
+				break;
+
+			frames[n++] = ret;
+		}
+
+		nss_prof_sample(rec, thread, frames, n, folded);
+		total_samples++;
+	}
+}
+
+/*
+ * nss_prof_parse_frames()
+ *	Parse a comma separated list of return address offsets.
+ */
+static int nss_prof_parse_frames(struct nss_prof_layout *l, char *arg)
+{
+	char *tok;
+
+	l->num_frames = 0;
+	for (tok = strtok(arg, ","); tok; tok = strtok(NULL, ",")) {
+		if (l->num_frames == NSS_PROF_MAX_FRAMES)
+			return -1;
+
+		l->frames[l->num_frames++] = atoi(tok);
+	}
+
+	return 0;
+}
+
+/*
+ * nss_prof_usage()
+ */
+static void nss_prof_usage(const char *prog)
+{
+	fprintf(stderr,
+		"usage: %s [options] capture\n"
+		"  -F        output folded stacks instead of perf script\n"
+		"  -s file   firmware symbols (nm -n output)\n"
+		"  -b        firmware data is big endian\n"
+		"  -H size   sample header size (default: byte 2 of the header)\n"
+		"  -n count  samples per message (default: byte 3 of the header)\n"
+		"  -z size   size of a sample (default 20)\n"
+		"  -p off    offset of the PC in a sample (default 0)\n"
+		"  -r offs   offsets of the caller return addresses (default 4,8)\n"
+		"  -t off    offset of the thread number, -1 for none (default 19)\n",
+		prog);
+}
+
+int main(int argc, char *argv[])
+{
+	struct nss_prof_layout l = {
+		.header_size = -1,
+		.sample_count = -1,
+		.stride = 20,
+		.pc = 0,
+		.frames = { 4, 8 },
+		.num_frames = 2,
+		.thread = 19,
+	};
+	struct nss_profiler_record rec;
+	uint8_t *payload;
+	bool folded = false;
+	const char *sym_path = NULL;
+	unsigned long skipped = 0;
+	size_t i;
+	FILE *fp;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "Fs:bH:n:z:p:r:t:")) != -1) {
+		switch (opt) {
+		case 'F':
+			folded = true;
+			break;
+		case 's':
+			sym_path = optarg;
+			break;
+		case 'b':
+			l.big_endian = true;
+			break;
+		case 'H':
+			l.header_size = atoi(optarg);
+			break;
+		case 'n':
+			l.sample_count = atoi(optarg);
+			break;
+		case 'z':
+			l.stride = atoi(optarg);
+			break;
+		case 'p':
+			l.pc = atoi(optarg);
+			break;
+		case 'r':
+			if (nss_prof_parse_frames(&l, optarg)) {
+				fprintf(stderr, "at most %d return addresses\n", NSS_PROF_MAX_FRAMES);
+				return 1;
+			}
+			break;
+		case 't':
+			l.thread = atoi(optarg);
+			break;
+		default:
+			nss_prof_usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (optind != argc - 1) {
+		nss_prof_usage(argv[0]);
+		return 1;
+	}
+
+	for (i = 0; i < (size_t)l.num_frames; i++) {
+		if (l.frames[i] < 0 || l.frames[i] + 4 > l.stride)
+			break;
+	}
+
+	if (l.stride < 4 || l.pc < 0 || l.pc + 4 > l.stride || i < (size_t)l.num_frames || l.thread >= l.stride) {
+		fprintf(stderr, "sample offsets do not fit in a %d byte sample\n", l.stride);
+		return 1;
+	}
+
+	if (sym_path && nss_prof_sym_load(sym_path))
+		return 1;
+
+	fp = fopen(argv[optind], "rb");
+	if (!fp) {
+		fprintf(stderr, "%s: %s\n", argv[optind], strerror(errno));
+		return 1;
+	}
+
+	payload = malloc(NSS_PROF_MAX_PAYLOAD);
+	if (!payload) {
+		fclose(fp);
+		return 1;
+	}
+
+	while (fread(&rec, sizeof(rec), 1, fp) == 1) {
+		size_t padded;
+
+		/*
+		 * Resynchronize on the next record magic after a damaged record.
+		 */
+		if (rec.magic != NSS_PROFILER_RECORD_MAGIC || rec.len > NSS_PROF_MAX_PAYLOAD) {
+			if (fseek(fp, 4 - (long)sizeof(rec), SEEK_CUR))
+				break;
+
+			skipped += 4;
+			continue;
+		}
+
+		padded = (rec.len + NSS_PROFILER_RECORD_ALIGN - 1) & ~(size_t)(NSS_PROFILER_RECORD_ALIGN - 1);
+		if (fread(payload, 1, padded, fp) != padded)
+			break;
+
+		total_dropped += rec.dropped;
+		if (rec.type == NSS_PROFILER_RECORD_SAMPLES)
+			nss_prof_samples(&rec, payload, &l, folded);
+	}
+
+	fclose(fp);
+	free(payload);
+
+	if (folded) {
+		qsort(stacks, num_stacks, sizeof(*stacks), nss_prof_stack_cmp);
+		for (i = 0; i < num_stacks; i++)
+			printf("%s %lu\n", stacks[i].stack, stacks[i].count);
+	}
+
+	fprintf(stderr, "%lu samples, %lu messages dropped by the driver, %lu bad messages, %lu bytes skipped\n",
+			total_samples, total_dropped, total_bad, skipped);
+	return 0;
+}
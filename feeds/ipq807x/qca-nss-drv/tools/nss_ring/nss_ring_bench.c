@@ -0,0 +1,544 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/*
+ * nss_ring_bench.c
+ *	Check and time the H2N/N2H ring logic against the mock HAL.
+ *
+ *	nss_ring_bench -t
+ *	nss_ring_bench -n 1000000 -r 256 -w 64 -b 8
+ *	nss_ring_bench -S jumbo -r 128
+ *
+ * -t only runs the checks: index arithmetic around the wrap, then one
+ * buffer of every stream sent across the end of the ring and returned by
+ * the mock NSS, with the descriptor flags and opaques verified.
+ *
+ * Otherwise the checks run first and every selected stream (linear,
+ * nr_frags, fraglist, jumbo) is sent in rounds: fill the H2N ring, let the
+ * mock NSS return the buffers, drain the N2H ring by weight. The H2N fill
+ * and the N2H drain are timed separately and reported in ns/packet; the
+ * mock NSS is not timed. -b posts that many packets per doorbell, as
+ * xmit_more does.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "nss_ring_lib.h"
+
+#define NSS_RING_BENCH_POOL	512
+#define NSS_RING_BENCH_IF_NUM	16
+#define NSS_RING_BENCH_PAGE	4096
+
+/*
+ * Synthetic descriptor streams
+ */
+enum nss_ring_bench_stream {
+	NSS_RING_BENCH_LINEAR,
+	NSS_RING_BENCH_NR_FRAGS,
+	NSS_RING_BENCH_FRAGLIST,
+	NSS_RING_BENCH_JUMBO,
+	NSS_RING_BENCH_STREAM_MAX,
+};
+
+static const char *nss_ring_bench_stream_names[NSS_RING_BENCH_STREAM_MAX] = {
+	[NSS_RING_BENCH_LINEAR] = "linear",
+	[NSS_RING_BENCH_NR_FRAGS] = "nr_frags",
+	[NSS_RING_BENCH_FRAGLIST] = "fraglist",
+	[NSS_RING_BENCH_JUMBO] = "jumbo",
+};
+
+/*
+ * Buffers of one stream, with their backing memory
+ */
+struct nss_ring_bench_pool {
+	struct nss_ring_buf bufs[NSS_RING_BENCH_POOL];
+	struct nss_ring_buf *chained;	/* frag_list members */
+	uint8_t *mem;
+	uint32_t segments;		/* Descriptors per packet */
+};
+
+/*
+ * State of the N2H drain callback
+ */
+struct nss_ring_bench_rx {
+	struct nss_ring_bench_pool *pool;
+	uint64_t packets;
+	uint64_t segments;
+	uint64_t bad;
+};
+
+/*
+ * nss_ring_bench_ns()
+ *	Monotonic time in nanoseconds.
+ */
+static uint64_t nss_ring_bench_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * nss_ring_bench_pool_init()
+ *	Build the buffers of a stream.
+ *
+ * linear: one head of -s bytes. nr_frags: 128 byte head and two 700
+ * byte pages. fraglist: a GRO train of three 1500 byte linear buffers.
+ * jumbo: a 9000 byte GSO packet, 256 byte head and three pages.
+ */
+static int nss_ring_bench_pool_init(struct nss_ring_bench_pool *pool, enum nss_ring_bench_stream stream, uint16_t size)
+{
+	uint32_t per_buf = 2048 + 3 * NSS_RING_BENCH_PAGE;
+	uint32_t i, f;
+
+	memset(pool, 0, sizeof(*pool));
+	pool->mem = malloc((size_t)NSS_RING_BENCH_POOL * per_buf);
+	pool->chained = calloc(NSS_RING_BENCH_POOL * 2, sizeof(struct nss_ring_buf));
+	if (!pool->mem || !pool->chained) {
+		free(pool->mem);
+		free(pool->chained);
+		return -1;
+	}
+
+	for (i = 0; i < NSS_RING_BENCH_POOL; i++) {
+		struct nss_ring_buf *buf = &pool->bufs[i];
+		uint8_t *mem = pool->mem + (size_t)i * per_buf;
+
+		buf->head = mem;
+		buf->data_offs = 64;
+		buf->buffer_len = 2048;
+		buf->priority = i & 7;
+		buf->ip_summed = NSS_RING_BUF_CHECKSUM_PARTIAL;
+
+		switch (stream) {
+		case NSS_RING_BENCH_LINEAR:
+			buf->head_len = size;
+			buf->ip_summed = NSS_RING_BUF_CHECKSUM_UNNECESSARY;
+			break;
+
+		case NSS_RING_BENCH_NR_FRAGS:
+			buf->head_len = 128;
+			buf->nr_frags = 2;
+			for (f = 0; f < buf->nr_frags; f++) {
+				buf->frags[f].addr = mem + 2048 + f * NSS_RING_BENCH_PAGE;
+				buf->frags[f].len = 700;
+			}
+			break;
+
+		case NSS_RING_BENCH_FRAGLIST:
+			buf->head_len = 1500;
+			for (f = 0; f < 2; f++) {
+				struct nss_ring_buf *seg = &pool->chained[i * 2 + f];
+
+				seg->head = mem + 2048 + f * NSS_RING_BENCH_PAGE;
+				seg->data_offs = 64;
+				seg->head_len = 1500;
+				seg->buffer_len = 2048;
+				seg->priority = buf->priority;
+				seg->next = f ? NULL : &pool->chained[i * 2 + 1];
+			}
+			buf->frag_list = &pool->chained[i * 2];
+			break;
+
+		case NSS_RING_BENCH_JUMBO:
+			buf->head_len = 256;
+			buf->mss = 1448;
+			buf->nr_frags = 3;
+			for (f = 0; f < buf->nr_frags; f++) {
+				buf->frags[f].addr = mem + 2048 + f * NSS_RING_BENCH_PAGE;
+				buf->frags[f].len = (f < 2) ? NSS_RING_BENCH_PAGE : 9000 - 256 - 2 * NSS_RING_BENCH_PAGE;
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	pool->segments = nss_ring_buf_segments(&pool->bufs[0], NSS_RING_MAX_FRAGS) + 1;
+	return 0;
+}
+
+/*
+ * nss_ring_bench_pool_deinit()
+ *	Free the buffers of a stream.
+ */
+static void nss_ring_bench_pool_deinit(struct nss_ring_bench_pool *pool)
+{
+	free(pool->mem);
+	free(pool->chained);
+}
+
+/*
+ * nss_ring_bench_is_head()
+ *	Whether opaque is the head buffer of a packet of the pool.
+ */
+static bool nss_ring_bench_is_head(struct nss_ring_bench_pool *pool, nss_ptr_t opaque)
+{
+	struct nss_ring_buf *buf = (struct nss_ring_buf *)opaque;
+
+	return (buf >= &pool->bufs[0]) && (buf < &pool->bufs[NSS_RING_BENCH_POOL]);
+}
+
+/*
+ * nss_ring_bench_rx()
+ *	N2H drain callback: account returned buffers.
+ */
+static void nss_ring_bench_rx(void *app_data, struct n2h_descriptor *desc)
+{
+	struct nss_ring_bench_rx *rx = app_data;
+
+	if (!desc->opaque) {
+		rx->bad++;
+		return;
+	}
+
+	if (nss_ring_bench_is_head(rx->pool, desc->opaque)) {
+		rx->packets++;
+		return;
+	}
+
+	rx->segments++;
+}
+
+/*
+ * nss_ring_bench_check_index()
+ *	Index arithmetic around the wrap.
+ */
+static int nss_ring_bench_check_index(void)
+{
+	uint32_t mask = 255;
+	int err = 0;
+
+	err |= (nss_ring_used(2, 250, mask) != 8);
+	err |= (nss_ring_free(2, 250, mask) != 247);
+	err |= (nss_ring_free(7, 8, mask) != 0);
+	err |= (nss_ring_used(8, 8, mask) != 0);
+	err |= (nss_ring_advance(250, 10, mask) != 4);
+	err |= (nss_ring_next(255, mask) != 0);
+	err |= (nss_ring_prev(0, mask) != 255);
+	err |= (nss_ring_drain_count(4, 250, mask, 64) != 10);
+	err |= (nss_ring_drain_count(200, 0, mask, 64) != 64);
+	err |= (nss_ring_contig(250, 10, mask) != 6);
+	err |= (nss_ring_contig(10, 10, mask) != 10);
+
+	if (err) {
+		fprintf(stderr, "index: arithmetic check failed\n");
+	}
+
+	return err;
+}
+
+/*
+ * nss_ring_bench_check_stream()
+ *	Send one buffer across the end of the ring and verify what is posted and returned.
+ */
+static int nss_ring_bench_check_stream(enum nss_ring_bench_stream stream, uint32_t ring_size)
+{
+	const char *name = nss_ring_bench_stream_names[stream];
+	struct nss_ring_bench_pool pool;
+	struct nss_ring_bench_rx rx;
+	struct nss_ring_h2n h2n;
+	struct nss_ring_n2h n2h;
+	struct nss_ring_buf *buf;
+	uint32_t i, index, start, returned;
+	int32_t count;
+	int err = 0;
+
+	if (nss_ring_bench_pool_init(&pool, stream, 64) || nss_ring_h2n_init(&h2n, ring_size) || nss_ring_n2h_init(&n2h, ring_size)) {
+		fprintf(stderr, "%s: out of memory\n", name);
+		return 1;
+	}
+
+	/*
+	 * Start two descriptors before the end so every multi-segment buffer wraps
+	 */
+	start = ring_size - 2;
+	h2n.hlos_index = h2n.hlos_published = h2n.nss_index = start;
+	n2h.hlos_index = n2h.nss_index = start;
+
+	buf = &pool.bufs[0];
+	count = nss_ring_h2n_send(&h2n, NSS_RING_BENCH_IF_NUM, buf, H2N_BUFFER_PACKET, H2N_BIT_FLAG_BUFFER_REUSABLE, false);
+	if (count != (int32_t)pool.segments) {
+		fprintf(stderr, "%s: sent %d descriptors, expected %u\n", name, count, pool.segments);
+		err = 1;
+		goto done;
+	}
+
+	returned = 0;
+	for (i = 0, index = start; i < (uint32_t)count; i++, index = nss_ring_next(index, h2n.mask)) {
+		struct h2n_descriptor *desc = &h2n.desc[index];
+		bool first = (i == 0);
+		bool last = (i == (uint32_t)count - 1);
+		bool discard = !!(desc->bit_flags & H2N_BIT_FLAG_DISCARD);
+
+		err |= (!!(desc->bit_flags & H2N_BIT_FLAG_FIRST_SEGMENT) != first);
+		err |= (!!(desc->bit_flags & H2N_BIT_FLAG_LAST_SEGMENT) != last);
+		err |= !!(desc->bit_flags & H2N_BIT_FLAG_BUFFER_REUSABLE);
+		err |= (desc->interface_num != NSS_RING_BENCH_IF_NUM);
+
+		if (buf->frag_list) {
+			/*
+			 * Every fraglist segment owns a buffer and comes back
+			 */
+			err |= discard || !desc->opaque;
+		} else if (buf->nr_frags) {
+			/*
+			 * Only the last frags[] segment comes back, with the head buffer
+			 */
+			err |= (discard == last);
+			err |= last ? (desc->opaque != (nss_ptr_t)buf) : (desc->opaque != 0);
+		} else {
+			err |= discard || (desc->opaque != (nss_ptr_t)buf);
+		}
+
+		err |= (buf->mss && !(desc->bit_flags & H2N_BIT_FLAG_SEGMENTATION_ENABLE));
+		returned += !discard;
+	}
+
+	if (err) {
+		fprintf(stderr, "%s: descriptor flags or opaque mismatch\n", name);
+		goto done;
+	}
+
+	nss_ring_mock_fw_run(&h2n, &n2h);
+	if (h2n.nss_index != h2n.hlos_index) {
+		fprintf(stderr, "%s: mock NSS left H2N descriptors behind\n", name);
+		err = 1;
+		goto done;
+	}
+
+	memset(&rx, 0, sizeof(rx));
+	rx.pool = &pool;
+	if (nss_ring_n2h_drain(&n2h, returned, nss_ring_bench_rx, &rx) != returned) {
+		fprintf(stderr, "%s: drained fewer than %u descriptors\n", name, returned);
+		err = 1;
+		goto done;
+	}
+
+	if ((rx.packets != 1) || (rx.segments != returned - 1) || rx.bad || (n2h.hlos_index != n2h.nss_index)) {
+		fprintf(stderr, "%s: returned %llu packets %llu segments %llu bad\n", name,
+			(unsigned long long)rx.packets, (unsigned long long)rx.segments, (unsigned long long)rx.bad);
+		err = 1;
+	}
+
+done:
+	nss_ring_n2h_deinit(&n2h);
+	nss_ring_h2n_deinit(&h2n);
+	nss_ring_bench_pool_deinit(&pool);
+	return err;
+}
+
+/*
+ * nss_ring_bench_run()
+ *	Time one stream and print a line with the result.
+ */
+static int nss_ring_bench_run(enum nss_ring_bench_stream stream, uint64_t packets, uint32_t ring_size,
+				uint32_t weight, uint32_t burst, uint16_t size)
+{
+	const char *name = nss_ring_bench_stream_names[stream];
+	struct nss_ring_hal_mock_stats hal_start;
+	struct nss_ring_bench_pool pool;
+	struct nss_ring_bench_rx rx;
+	struct nss_ring_h2n h2n;
+	struct nss_ring_n2h n2h;
+	uint64_t sent = 0, h2n_ns = 0, n2h_ns = 0, descs, t;
+	uint32_t next = 0, in_burst = 0;
+	int err = 0;
+
+	if (nss_ring_bench_pool_init(&pool, stream, size) || nss_ring_h2n_init(&h2n, ring_size) || nss_ring_n2h_init(&n2h, ring_size)) {
+		fprintf(stderr, "%s: out of memory\n", name);
+		return 1;
+	}
+
+	if (pool.segments >= ring_size) {
+		fprintf(stderr, "%s: %u descriptors per packet do not fit a %u entry ring\n", name, pool.segments, ring_size);
+		err = 1;
+		goto done;
+	}
+
+	memset(&rx, 0, sizeof(rx));
+	rx.pool = &pool;
+	hal_start = nss_ring_hal_mock_stats;
+
+	while (rx.packets < packets) {
+		/*
+		 * Fill the H2N ring
+		 */
+		t = nss_ring_bench_ns();
+		while (sent < packets) {
+			bool xmit_more = (++in_burst < burst) && (sent + 1 < packets);
+			int32_t count;
+
+			count = nss_ring_h2n_send(&h2n, NSS_RING_BENCH_IF_NUM, &pool.bufs[next],
+					H2N_BUFFER_PACKET, 0, xmit_more);
+			if (count <= 0) {
+				in_burst = 0;
+				break;
+			}
+
+			if (!xmit_more) {
+				in_burst = 0;
+			}
+
+			next = (next + 1) % NSS_RING_BENCH_POOL;
+			sent++;
+		}
+		h2n_ns += nss_ring_bench_ns() - t;
+
+		nss_ring_mock_fw_run(&h2n, &n2h);
+
+		/*
+		 * Drain the N2H ring one weight at a time, as NAPI polls do
+		 */
+		t = nss_ring_bench_ns();
+		while (nss_ring_n2h_drain(&n2h, weight, nss_ring_bench_rx, &rx)) {
+			;
+		}
+		n2h_ns += nss_ring_bench_ns() - t;
+	}
+
+	if (rx.bad || (rx.packets != packets)) {
+		fprintf(stderr, "%s: %llu packets returned of %llu, %llu bad\n", name,
+			(unsigned long long)rx.packets, (unsigned long long)packets, (unsigned long long)rx.bad);
+		err = 1;
+		goto done;
+	}
+
+	descs = packets * pool.segments;
+	printf("%-8s packets %llu desc/pkt %u h2n %.1f ns/pkt n2h %.1f ns/pkt total %.1f ns/pkt"
+		" (%.1f ns/desc) doorbells %llu full %llu\n",
+		name, (unsigned long long)packets, pool.segments,
+		(double)h2n_ns / packets, (double)n2h_ns / packets, (double)(h2n_ns + n2h_ns) / packets,
+		(double)(h2n_ns + n2h_ns) / descs,
+		(unsigned long long)(nss_ring_hal_mock_stats.interrupts - hal_start.interrupts),
+		(unsigned long long)h2n.full);
+
+done:
+	nss_ring_n2h_deinit(&n2h);
+	nss_ring_h2n_deinit(&h2n);
+	nss_ring_bench_pool_deinit(&pool);
+	return err;
+}
+
+/*
+ * nss_ring_bench_usage()
+ *	Print the usage.
+ */
+static void nss_ring_bench_usage(const char *prog)
+{
+	fprintf(stderr, "usage: %s [-t] [-S stream] [-n packets] [-r ring_size] [-w weight] [-b burst] [-s size]\n"
+		"  -t          run the checks only\n"
+		"  -S stream   linear, nr_frags, fraglist or jumbo (default: all)\n"
+		"  -n packets  packets per stream (default 1000000)\n"
+		"  -r size     ring size, a power of two (default 256)\n"
+		"  -w weight   N2H descriptors per drain (default 64)\n"
+		"  -b burst    packets per doorbell (default 1)\n"
+		"  -s size     payload of the linear stream (default 64)\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+	uint64_t packets = 1000000;
+	uint32_t ring_size = 256, weight = 64, burst = 1;
+	uint16_t size = 64;
+	int stream = -1;
+	bool check_only = false;
+	int opt, i, err = 0;
+
+	while ((opt = getopt(argc, argv, "tS:n:r:w:b:s:h")) != -1) {
+		switch (opt) {
+		case 't':
+			check_only = true;
+			break;
+
+		case 'S':
+			for (stream = 0; stream < NSS_RING_BENCH_STREAM_MAX; stream++) {
+				if (!strcmp(optarg, nss_ring_bench_stream_names[stream])) {
+					break;
+				}
+			}
+
+			if (stream == NSS_RING_BENCH_STREAM_MAX) {
+				fprintf(stderr, "unknown stream %s\n", optarg);
+				return 2;
+			}
+			break;
+
+		case 'n':
+			packets = strtoull(optarg, NULL, 0);
+			break;
+
+		case 'r':
+			ring_size = strtoul(optarg, NULL, 0);
+			break;
+
+		case 'w':
+			weight = strtoul(optarg, NULL, 0);
+			break;
+
+		case 'b':
+			burst = strtoul(optarg, NULL, 0);
+			break;
+
+		case 's':
+			size = strtoul(optarg, NULL, 0);
+			break;
+
+		default:
+			nss_ring_bench_usage(argv[0]);
+			return 2;
+		}
+	}
+
+	if ((ring_size < 8) || (ring_size & (ring_size - 1)) || !packets || !weight || !burst || !size || (size > 1984)) {
+		nss_ring_bench_usage(argv[0]);
+		return 2;
+	}
+
+	err |= nss_ring_bench_check_index();
+	for (i = 0; i < NSS_RING_BENCH_STREAM_MAX; i++) {
+		err |= nss_ring_bench_check_stream(i, ring_size);
+	}
+
+	if (err) {
+		fprintf(stderr, "checks failed\n");
+		return 1;
+	}
+
+	if (check_only) {
+		printf("checks passed\n");
+		return 0;
+	}
+
+	for (i = 0; i < NSS_RING_BENCH_STREAM_MAX; i++) {
+		if ((stream >= 0) && (stream != i)) {
+			continue;
+		}
+
+		err |= nss_ring_bench_run(i, packets, ring_size, weight, burst, size);
+	}
+
+	return err;
+}
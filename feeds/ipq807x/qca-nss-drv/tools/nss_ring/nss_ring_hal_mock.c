@@ -0,0 +1,115 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/*
+ * nss_ring_hal_mock.c
+ *	Mock HAL and NSS for the ring library.
+ *
+ * DMA mapping returns the low bits of the virtual address, cache
+ * maintenance and the doorbell only count calls. The mock NSS returns
+ * every H2N descriptor not marked for discard on the N2H ring, which is
+ * what the firmware does once it has transmitted a packet.
+ */
+
+#include <stdint.h>
+
+#include "nss_ring_lib.h"
+
+struct nss_ring_hal_mock_stats nss_ring_hal_mock_stats;
+
+/*
+ * nss_ring_hal_dma_map()
+ *	Map a buffer for the NSS.
+ */
+uint32_t nss_ring_hal_dma_map(void *addr, uint32_t len)
+{
+	nss_ring_hal_mock_stats.dma_maps++;
+	return (uint32_t)(uintptr_t)addr;
+}
+
+/*
+ * nss_ring_hal_cache_flush()
+ *	Write back descriptors before the NSS reads them.
+ */
+void nss_ring_hal_cache_flush(void *start, void *end)
+{
+	nss_ring_hal_mock_stats.cache_flushes++;
+}
+
+/*
+ * nss_ring_hal_cache_inv()
+ *	Drop stale lines before reading what the NSS wrote.
+ */
+void nss_ring_hal_cache_inv(void *start, void *end)
+{
+	nss_ring_hal_mock_stats.cache_invs++;
+}
+
+/*
+ * nss_ring_hal_send_interrupt()
+ *	Ring the H2N doorbell.
+ */
+void nss_ring_hal_send_interrupt(void)
+{
+	nss_ring_hal_mock_stats.interrupts++;
+}
+
+/*
+ * nss_ring_mock_fw_run()
+ *	Consume the published H2N descriptors and return buffers on the N2H ring.
+ *
+ * Stops early when the N2H ring is full. Returns the number of H2N
+ * descriptors consumed.
+ */
+uint32_t nss_ring_mock_fw_run(struct nss_ring_h2n *h2n, struct nss_ring_n2h *n2h)
+{
+	uint32_t published = __atomic_load_n(&h2n->hlos_published, __ATOMIC_ACQUIRE);
+	uint32_t n2h_hlos = n2h->hlos_index;
+	uint32_t h2n_index = h2n->nss_index;
+	uint32_t n2h_index = n2h->nss_index;
+	uint32_t consumed = 0;
+
+	while (h2n_index != published) {
+		struct h2n_descriptor *in = &h2n->desc[h2n_index];
+		struct n2h_descriptor *out;
+
+		if (!(in->bit_flags & H2N_BIT_FLAG_DISCARD)) {
+			if (nss_ring_free(n2h_index, n2h_hlos, n2h->mask) == 0) {
+				break;
+			}
+
+			out = &n2h->desc[n2h_index];
+			out->interface_num = in->interface_num;
+			out->buffer = in->buffer;
+			out->buffer_len = in->buffer_len;
+			out->payload_len = in->payload_len;
+			out->payload_offs = in->payload_offs;
+			out->bit_flags = in->bit_flags & (N2H_BIT_FLAG_FIRST_SEGMENT | N2H_BIT_FLAG_LAST_SEGMENT);
+			out->buffer_type = N2H_BUFFER_EMPTY;
+			out->opaque = in->opaque;
+			n2h_index = nss_ring_next(n2h_index, n2h->mask);
+		}
+
+		h2n_index = nss_ring_next(h2n_index, h2n->mask);
+		consumed++;
+	}
+
+	__atomic_store_n(&n2h->nss_index, n2h_index, __ATOMIC_RELEASE);
+	__atomic_store_n(&h2n->nss_index, h2n_index, __ATOMIC_RELEASE);
+	return consumed;
+}
@@ -0,0 +1,339 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/*
+ * nss_ring_lib.c
+ *	H2N descriptor fill and N2H cause queue drain on nss_ring_buf buffers.
+ *
+ * The loops come from nss_ring_ops.h, as in nss_core.c; this file only binds
+ * its hooks to struct nss_ring_buf and the HAL the library is linked with.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "nss_ring_lib.h"
+
+#define NSS_RING_HAL_CTX void
+#define NSS_RING_HAL_BUF struct nss_ring_buf
+#include "nss_ring_ops.h"
+
+/*
+ * nss_ring_hal_desc_flush()
+ */
+static inline void nss_ring_hal_desc_flush(void *ctx, struct h2n_descriptor *desc)
+{
+	nss_ring_hal_cache_flush(desc, desc + 1);
+}
+
+/*
+ * nss_ring_hal_desc_inv()
+ */
+static inline void nss_ring_hal_desc_inv(void *ctx, struct n2h_descriptor *start, struct n2h_descriptor *end)
+{
+	nss_ring_hal_cache_inv(start, end);
+}
+
+/*
+ * nss_ring_hal_prefetch()
+ */
+static inline void nss_ring_hal_prefetch(const void *addr)
+{
+	__builtin_prefetch(addr);
+}
+
+/*
+ * nss_ring_hal_map_head()
+ */
+static inline bool nss_ring_hal_map_head(void *ctx, struct nss_ring_buf *buf, struct nss_ring_seg *seg)
+{
+	seg->buffer = nss_ring_hal_dma_map(buf->head, buf->buffer_len);
+	seg->payload_offs = buf->data_offs;
+	seg->payload_len = buf->head_len;
+	seg->buffer_len = buf->buffer_len;
+	seg->priority = buf->priority;
+	return true;
+}
+
+/*
+ * nss_ring_hal_map_chained()
+ */
+static inline bool nss_ring_hal_map_chained(void *ctx, struct nss_ring_buf *iter, struct nss_ring_seg *seg)
+{
+	return nss_ring_hal_map_head(ctx, iter, seg);
+}
+
+/*
+ * nss_ring_hal_map_reuse()
+ *	Buffers are never handed to the mock NSS for reuse.
+ */
+static inline bool nss_ring_hal_map_reuse(void *ctx, uint32_t if_num, struct nss_ring_buf *buf, struct nss_ring_seg *seg)
+{
+	return false;
+}
+
+/*
+ * nss_ring_hal_map_frag()
+ */
+static inline bool nss_ring_hal_map_frag(void *ctx, struct nss_ring_buf *buf, uint32_t i, struct nss_ring_seg *seg)
+{
+	struct nss_ring_frag *frag = &buf->frags[i];
+
+	seg->buffer = nss_ring_hal_dma_map(frag->addr, frag->len);
+	seg->payload_offs = 0;
+	seg->payload_len = frag->len;
+	seg->buffer_len = frag->len;
+	seg->priority = buf->priority;
+	return true;
+}
+
+/*
+ * nss_ring_hal_unmap()
+ *	The mock HAL does not track mappings.
+ */
+static inline void nss_ring_hal_unmap(void *ctx, struct h2n_descriptor *desc_ring, uint32_t mask,
+					uint32_t hlos_index, uint32_t count, bool is_fraglist)
+{
+}
+
+/*
+ * nss_ring_hal_written()
+ */
+static inline void nss_ring_hal_written(void *ctx, struct nss_ring_buf *buf,
+					enum nss_ring_h2n_kind kind, uint32_t count)
+{
+}
+
+/*
+ * nss_ring_hal_len()
+ */
+static inline uint16_t nss_ring_hal_len(struct nss_ring_buf *buf)
+{
+	return buf->head_len;
+}
+
+/*
+ * nss_ring_hal_gso_size()
+ */
+static inline uint16_t nss_ring_hal_gso_size(struct nss_ring_buf *buf)
+{
+	return buf->mss;
+}
+
+/*
+ * nss_ring_hal_csum()
+ */
+static inline enum nss_ring_csum nss_ring_hal_csum(struct nss_ring_buf *buf)
+{
+	switch (buf->ip_summed) {
+	case NSS_RING_BUF_CHECKSUM_PARTIAL:
+		return NSS_RING_CSUM_PARTIAL;
+
+	case NSS_RING_BUF_CHECKSUM_UNNECESSARY:
+		return NSS_RING_CSUM_UNNECESSARY;
+
+	default:
+		return NSS_RING_CSUM_NONE;
+	}
+}
+
+/*
+ * nss_ring_hal_nr_frags()
+ */
+static inline uint32_t nss_ring_hal_nr_frags(struct nss_ring_buf *buf)
+{
+	return buf->nr_frags;
+}
+
+/*
+ * nss_ring_hal_frag_list()
+ */
+static inline struct nss_ring_buf *nss_ring_hal_frag_list(struct nss_ring_buf *buf)
+{
+	return buf->frag_list;
+}
+
+/*
+ * nss_ring_hal_frag_next()
+ */
+static inline struct nss_ring_buf *nss_ring_hal_frag_next(struct nss_ring_buf *iter)
+{
+	return iter->next;
+}
+
+/*
+ * nss_ring_h2n_init()
+ *	Allocate an H2N ring of size descriptors, size being a power of two.
+ */
+int nss_ring_h2n_init(struct nss_ring_h2n *ring, uint32_t size)
+{
+	memset(ring, 0, sizeof(*ring));
+	if (size < 2 || (size & (size - 1))) {
+		return -1;
+	}
+
+	ring->desc = aligned_alloc(64, size * sizeof(struct h2n_descriptor));
+	if (!ring->desc) {
+		return -1;
+	}
+
+	memset(ring->desc, 0, size * sizeof(struct h2n_descriptor));
+	ring->mask = size - 1;
+	return 0;
+}
+
+/*
+ * nss_ring_h2n_deinit()
+ *	Free an H2N ring.
+ */
+void nss_ring_h2n_deinit(struct nss_ring_h2n *ring)
+{
+	free(ring->desc);
+	ring->desc = NULL;
+}
+
+/*
+ * nss_ring_n2h_init()
+ *	Allocate an N2H ring of size descriptors, size being a power of two.
+ */
+int nss_ring_n2h_init(struct nss_ring_n2h *ring, uint32_t size)
+{
+	memset(ring, 0, sizeof(*ring));
+	if (size < 2 || (size & (size - 1))) {
+		return -1;
+	}
+
+	ring->desc = aligned_alloc(64, size * sizeof(struct n2h_descriptor));
+	if (!ring->desc) {
+		return -1;
+	}
+
+	memset(ring->desc, 0, size * sizeof(struct n2h_descriptor));
+	ring->mask = size - 1;
+	return 0;
+}
+
+/*
+ * nss_ring_n2h_deinit()
+ *	Free an N2H ring.
+ */
+void nss_ring_n2h_deinit(struct nss_ring_n2h *ring)
+{
+	free(ring->desc);
+	ring->desc = NULL;
+}
+
+/*
+ * nss_ring_buf_segments()
+ *	Number of segments following the head of buf.
+ *
+ * Returns -1 if buf can never fit in a ring of the given size.
+ */
+int32_t nss_ring_buf_segments(struct nss_ring_buf *buf, uint32_t size)
+{
+	return nss_ring_h2n_segments(buf, size);
+}
+
+/*
+ * nss_ring_h2n_publish()
+ *	Make the written descriptors visible to the NSS, as nss_core_h2n_publish_index().
+ */
+void nss_ring_h2n_publish(struct nss_ring_h2n *ring)
+{
+	__atomic_store_n(&ring->hlos_published, ring->hlos_index, __ATOMIC_RELEASE);
+	ring->pending = 0;
+	nss_ring_hal_send_interrupt();
+}
+
+/*
+ * nss_ring_h2n_send()
+ *	Post buf on the ring, as nss_core_send_buffer_one().
+ *
+ * Returns the number of descriptors used, 0 when the ring is full and -1
+ * when buf can never fit or fails to map.
+ */
+int32_t nss_ring_h2n_send(struct nss_ring_h2n *ring, uint32_t if_num, struct nss_ring_buf *buf,
+					uint8_t buffer_type, uint16_t flags, bool xmit_more)
+{
+	int32_t segments, count;
+	uint32_t nss_index;
+
+	segments = nss_ring_h2n_segments(buf, ring->mask + 1);
+	if (segments < 0) {
+		return -1;
+	}
+
+	nss_index = __atomic_load_n(&ring->nss_index, __ATOMIC_ACQUIRE);
+	if (nss_ring_free(ring->hlos_index, nss_index, ring->mask) < (uint32_t)(segments + 1)) {
+		ring->full++;
+		if (ring->pending) {
+			nss_ring_h2n_publish(ring);
+		}
+		return 0;
+	}
+
+	count = nss_ring_h2n_fill(NULL, ring->desc, ring->mask, ring->hlos_index, if_num, buf,
+			segments, buffer_type, flags);
+	if (count <= 0) {
+		if (ring->pending) {
+			nss_ring_h2n_publish(ring);
+		}
+		return -1;
+	}
+
+	ring->hlos_index = nss_ring_advance(ring->hlos_index, count, ring->mask);
+	ring->pending += count;
+	if (!xmit_more) {
+		nss_ring_h2n_publish(ring);
+	}
+
+	return count;
+}
+
+/*
+ * nss_ring_n2h_drain()
+ *	Consume up to weight descriptors, as nss_core_handle_cause_queue().
+ */
+uint32_t nss_ring_n2h_drain(struct nss_ring_n2h *ring, uint32_t weight, nss_ring_rx_cb_t cb, void *app_data)
+{
+	struct n2h_descriptor *desc_ring = ring->desc;
+	struct n2h_descriptor *desc;
+	uint32_t mask = ring->mask;
+	uint32_t hlos_index = ring->hlos_index;
+	uint32_t nss_index, count, count_temp;
+
+	nss_index = __atomic_load_n(&ring->nss_index, __ATOMIC_ACQUIRE);
+	count = nss_ring_drain_count(nss_index, hlos_index, mask, weight);
+	if (count == 0) {
+		return 0;
+	}
+
+	ring->desc_count += count;
+
+	desc = nss_ring_n2h_drain_begin(NULL, desc_ring, hlos_index, count, mask);
+	count_temp = count;
+	nss_ring_n2h_for_each(desc_ring, desc, hlos_index, count_temp, mask) {
+		cb(app_data, desc);
+	}
+
+	/*
+	 * Publish the consumer index back to the NSS
+	 */
+	ring->hlos_index = hlos_index;
+	return count;
+}
@@ -0,0 +1,140 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/*
+ * nss_ring_lib.h
+ *	Userspace build of the H2N/N2H ring logic of nss_core.c.
+ *
+ * The library fills H2N descriptors and drains N2H descriptors with the
+ * nss_ring_ops.h loops nss_core_send_buffer_one() and
+ * nss_core_handle_cause_queue() are built from. Cache maintenance, DMA
+ * mapping and the doorbell go through the nss_ring_hal_*() functions, which
+ * a HAL (the mock in nss_ring_hal_mock.c) provides.
+ */
+
+#ifndef __NSS_RING_LIB_H
+#define __NSS_RING_LIB_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "nss_ring.h"
+#include "nss_hlos_desc.h"
+
+#define NSS_RING_MAX_FRAGS	17	/* MAX_SKB_FRAGS with 4K pages */
+
+/*
+ * Checksum state of a buffer, as skb->ip_summed
+ */
+#define NSS_RING_BUF_CHECKSUM_NONE		0
+#define NSS_RING_BUF_CHECKSUM_UNNECESSARY	1
+#define NSS_RING_BUF_CHECKSUM_PARTIAL		3
+
+/*
+ * Page fragment of a buffer, the frags[] of an skb
+ */
+struct nss_ring_frag {
+	void *addr;
+	uint16_t len;
+};
+
+/*
+ * Stand-in for the skb fields the fill logic reads
+ */
+struct nss_ring_buf {
+	void *head;			/* Start of the linear area */
+	uint16_t data_offs;		/* Offset of the payload in the linear area */
+	uint16_t head_len;		/* Payload bytes in the linear area */
+	uint16_t buffer_len;		/* Size of the linear area */
+	uint16_t nr_frags;		/* Number of entries in frags */
+	uint16_t mss;			/* GSO size, 0 when not segmented */
+	uint32_t priority;
+	uint8_t ip_summed;		/* NSS_RING_BUF_CHECKSUM_* */
+	struct nss_ring_frag frags[NSS_RING_MAX_FRAGS];
+	struct nss_ring_buf *frag_list;	/* Chained buffers, the frag_list of an skb */
+	struct nss_ring_buf *next;
+};
+
+/*
+ * HLOS to NSS ring
+ */
+struct nss_ring_h2n {
+	struct h2n_descriptor *desc;
+	uint32_t mask;
+	uint32_t hlos_index;		/* Next descriptor the host writes */
+	uint32_t pending;		/* Descriptors written but not published */
+	volatile uint32_t hlos_published;	/* Host index seen by the NSS */
+	volatile uint32_t nss_index;	/* Next descriptor the NSS reads */
+	uint64_t full;			/* Sends refused for lack of descriptors */
+};
+
+/*
+ * NSS to HLOS ring
+ */
+struct nss_ring_n2h {
+	struct n2h_descriptor *desc;
+	uint32_t mask;
+	uint32_t hlos_index;		/* Next descriptor the host reads */
+	volatile uint32_t nss_index;	/* Next descriptor the NSS writes */
+	uint64_t desc_count;		/* Descriptors drained */
+};
+
+/*
+ * Called for every drained N2H descriptor
+ */
+typedef void (*nss_ring_rx_cb_t)(void *app_data, struct n2h_descriptor *desc);
+
+/*
+ * HAL hooks, provided by the HAL the library is linked with
+ */
+extern uint32_t nss_ring_hal_dma_map(void *addr, uint32_t len);
+extern void nss_ring_hal_cache_flush(void *start, void *end);
+extern void nss_ring_hal_cache_inv(void *start, void *end);
+extern void nss_ring_hal_send_interrupt(void);
+
+/*
+ * Ring library
+ */
+extern int nss_ring_h2n_init(struct nss_ring_h2n *ring, uint32_t size);
+extern void nss_ring_h2n_deinit(struct nss_ring_h2n *ring);
+extern int nss_ring_n2h_init(struct nss_ring_n2h *ring, uint32_t size);
+extern void nss_ring_n2h_deinit(struct nss_ring_n2h *ring);
+extern int32_t nss_ring_buf_segments(struct nss_ring_buf *buf, uint32_t size);
+extern int32_t nss_ring_h2n_send(struct nss_ring_h2n *ring, uint32_t if_num, struct nss_ring_buf *buf,
+					uint8_t buffer_type, uint16_t flags, bool xmit_more);
+extern void nss_ring_h2n_publish(struct nss_ring_h2n *ring);
+extern uint32_t nss_ring_n2h_drain(struct nss_ring_n2h *ring, uint32_t weight, nss_ring_rx_cb_t cb, void *app_data);
+
+/*
+ * Mock NSS: moves H2N descriptors the firmware would return to the N2H ring
+ */
+extern uint32_t nss_ring_mock_fw_run(struct nss_ring_h2n *h2n, struct nss_ring_n2h *n2h);
+
+/*
+ * Mock HAL counters
+ */
+struct nss_ring_hal_mock_stats {
+	uint64_t dma_maps;
+	uint64_t cache_flushes;
+	uint64_t cache_invs;
+	uint64_t interrupts;
+};
+
+extern struct nss_ring_hal_mock_stats nss_ring_hal_mock_stats;
+
+#endif /* __NSS_RING_LIB_H */
@@ -0,0 +1,262 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/*
+ * nss_stats_bin.c
+ *	Print the binary statistics files under qca-nss-drv/stats_bin.
+ *
+ *	nss_stats_bin /sys/kernel/debug/qca-nss-drv/stats_bin/drv
+ *	nss_stats_bin -n /sys/kernel/debug/qca-nss-drv/strings/common_node_stats \
+ *		-n /sys/kernel/debug/qca-nss-drv/strings/ipv4/special_stats_str \
+ *		-n /sys/kernel/debug/qca-nss-drv/strings/ipv4/exception_stats_str \
+ *		-i 1000 -c 10 -z /sys/kernel/debug/qca-nss-drv/stats_bin/ipv4
+ *	nss_stats_bin -z /sys/kernel/debug/qca-nss-drv/stats_bin/node
+ *
+ * Every output line is "<block> <counter> <name> <value>". -n gives the
+ * strings file naming the counters of the next block, "-" skipping one.
+ * With -c, the file is read count times -i milliseconds apart and the
+ * lines after the first snapshot also carry the delta and the rate per
+ * second. -z leaves out counters that are zero, or did not change. The
+ * blocks of the node file are the common node stats of each interface,
+ * indexed by interface number.
+ *
+ * -M reads synthetic snapshots instead of the file, so the tool can be
+ * checked without the driver.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "nss_stats_bin_lib.h"
+
+#define NSS_STATS_BIN_NAMES_MAX	16
+
+/*
+ * nss_stats_bin_ms()
+ *	Monotonic time in milliseconds.
+ */
+static uint64_t nss_stats_bin_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*
+ * nss_stats_bin_mock()
+ *	Build a synthetic snapshot: three blocks whose counters grow with seq.
+ */
+static int nss_stats_bin_mock(struct nss_stats_bin_snap *snap, uint32_t seq)
+{
+	static const uint32_t counts[] = { 8, 12, 5 };
+	struct nss_stats_bin_hdr *hdr;
+	struct nss_stats_bin_block *block;
+	size_t len = sizeof(*hdr);
+	uint64_t *counters;
+	uint32_t i, j;
+	char *buf;
+	int ret;
+
+	for (i = 0; i < 3; i++) {
+		len += sizeof(*block) + counts[i] * sizeof(uint64_t);
+	}
+
+	buf = calloc(1, len);
+	if (!buf) {
+		return -1;
+	}
+
+	hdr = (struct nss_stats_bin_hdr *)buf;
+	hdr->magic = NSS_STATS_BIN_MAGIC;
+	hdr->version = NSS_STATS_BIN_VERSION;
+	hdr->num_blocks = 3;
+
+	block = (struct nss_stats_bin_block *)(hdr + 1);
+	for (i = 0; i < 3; i++) {
+		block->num_counters = counts[i];
+		counters = (uint64_t *)(block + 1);
+		for (j = 0; j < counts[i]; j++) {
+			counters[j] = (j & 1) ? 0 : (uint64_t)(i + 1) * (j + 1) * (seq + 1) * 1000;
+		}
+
+		block = (struct nss_stats_bin_block *)(counters + counts[i]);
+	}
+
+	ret = nss_stats_bin_parse(snap, buf, len);
+	if (ret) {
+		nss_stats_bin_free(snap);
+	}
+
+	return ret;
+}
+
+/*
+ * nss_stats_bin_print()
+ *	Print a snapshot, with deltas against prev when given.
+ */
+static void nss_stats_bin_print(const struct nss_stats_bin_snap *snap, const struct nss_stats_bin_snap *prev,
+				uint64_t elapsed_ms, struct nss_stats_bin_names *names, uint32_t num_names, bool skip_zero)
+{
+	uint32_t b, i;
+
+	for (b = 0; b < snap->num_blocks; b++) {
+		const struct nss_stats_bin_view *view = &snap->blocks[b];
+		struct nss_stats_bin_names *bn = (b < num_names) ? &names[b] : NULL;
+
+		for (i = 0; i < view->num_counters; i++) {
+			const char *name = nss_stats_bin_name(bn, i);
+			uint64_t value = view->counters[i];
+			uint64_t delta;
+
+			if (!prev || (b >= prev->num_blocks) || (i >= prev->blocks[b].num_counters)) {
+				if (skip_zero && !value) {
+					continue;
+				}
+
+				printf("%u %u %s %llu\n", b, i, name ? name : "-", (unsigned long long)value);
+				continue;
+			}
+
+			delta = value - prev->blocks[b].counters[i];
+			if (skip_zero && !delta) {
+				continue;
+			}
+
+			printf("%u %u %s %llu %llu %.1f\n", b, i, name ? name : "-", (unsigned long long)value,
+				(unsigned long long)delta, elapsed_ms ? delta * 1000.0 / elapsed_ms : 0.0);
+		}
+	}
+}
+
+/*
+ * nss_stats_bin_usage()
+ *	Print the usage.
+ */
+static void nss_stats_bin_usage(const char *prog)
+{
+	fprintf(stderr, "usage: %s [-n strings_file]... [-i interval_ms] [-c count] [-z] [-M] file\n"
+		"  -n file  names of the counters of the next block, - for none\n"
+		"  -i ms    interval between snapshots (default 1000)\n"
+		"  -c count snapshots to take (default 1)\n"
+		"  -z       leave out counters that are zero or did not change\n"
+		"  -M       read synthetic snapshots instead of file\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+	struct nss_stats_bin_names names[NSS_STATS_BIN_NAMES_MAX];
+	struct nss_stats_bin_snap snap, prev;
+	uint32_t interval = 1000, count = 1, num_names = 0, n, i;
+	uint64_t t, prev_t = 0;
+	const char *path = NULL;
+	bool skip_zero = false, mock = false;
+	int opt, ret = 0;
+
+	memset(names, 0, sizeof(names));
+	memset(&prev, 0, sizeof(prev));
+
+	while ((opt = getopt(argc, argv, "n:i:c:zMh")) != -1) {
+		switch (opt) {
+		case 'n':
+			if (num_names == NSS_STATS_BIN_NAMES_MAX) {
+				fprintf(stderr, "at most %d -n options\n", NSS_STATS_BIN_NAMES_MAX);
+				ret = 2;
+				goto done;
+			}
+
+			if (strcmp(optarg, "-") && nss_stats_bin_names_load(optarg, &names[num_names])) {
+				fprintf(stderr, "cannot read names from %s\n", optarg);
+				ret = 1;
+				goto done;
+			}
+
+			num_names++;
+			break;
+
+		case 'i':
+			interval = strtoul(optarg, NULL, 0);
+			break;
+
+		case 'c':
+			count = strtoul(optarg, NULL, 0);
+			break;
+
+		case 'z':
+			skip_zero = true;
+			break;
+
+		case 'M':
+			mock = true;
+			break;
+
+		default:
+			nss_stats_bin_usage(argv[0]);
+			ret = 2;
+			goto done;
+		}
+	}
+
+	if (optind < argc) {
+		path = argv[optind];
+	}
+
+	if ((!path && !mock) || !count) {
+		nss_stats_bin_usage(argv[0]);
+		ret = 2;
+		goto done;
+	}
+
+	for (n = 0; n < count; n++) {
+		if (n) {
+			usleep(interval * 1000);
+		}
+
+		ret = mock ? nss_stats_bin_mock(&snap, n) : nss_stats_bin_read_file(path, &snap);
+		t = nss_stats_bin_ms();
+		if (ret) {
+			fprintf(stderr, "%s: %s\n", mock ? "mock" : path, strerror(ret < 0 ? -ret : ret));
+			ret = 1;
+			break;
+		}
+
+		if (n) {
+			printf("\n");
+		}
+
+		nss_stats_bin_print(&snap, n ? &prev : NULL, t - prev_t, names, num_names, skip_zero);
+		fflush(stdout);
+
+		nss_stats_bin_free(&prev);
+		prev = snap;
+		prev_t = t;
+	}
+
+	nss_stats_bin_free(&prev);
+
+done:
+	for (i = 0; i < num_names; i++) {
+		nss_stats_bin_names_free(&names[i]);
+	}
+
+	return ret;
+}
@@ -0,0 +1,244 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/*
+ * nss_stats_bin_lib.c
+ *	Reader for the binary statistics files under qca-nss-drv/stats_bin.
+ *
+ * Every read of a stats_bin file starting at offset 0 takes a new snapshot
+ * in the driver, and a read continuing at a later offset takes yet another
+ * one. A file is therefore read with a single read() into a buffer large
+ * enough for all of it, growing the buffer and starting over when it fills.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "nss_stats_bin_lib.h"
+
+#define NSS_STATS_BIN_READ_MIN	(16 * 1024)
+#define NSS_STATS_BIN_READ_MAX	(64 * 1024 * 1024)
+
+/*
+ * nss_stats_bin_parse()
+ *	Validate a snapshot and index its blocks.
+ */
+int nss_stats_bin_parse(struct nss_stats_bin_snap *snap, char *buf, size_t len)
+{
+	struct nss_stats_bin_hdr hdr;
+	size_t off;
+	uint16_t i;
+
+	memset(snap, 0, sizeof(*snap));
+	snap->buf = buf;
+	snap->len = len;
+
+	if (len < sizeof(hdr)) {
+		return -EINVAL;
+	}
+
+	memcpy(&hdr, buf, sizeof(hdr));
+	if (hdr.magic != NSS_STATS_BIN_MAGIC) {
+		return -EINVAL;
+	}
+
+	if (hdr.version != NSS_STATS_BIN_VERSION) {
+		return -EPROTONOSUPPORT;
+	}
+
+	snap->blocks = calloc(hdr.num_blocks ? hdr.num_blocks : 1, sizeof(*snap->blocks));
+	if (!snap->blocks) {
+		return -ENOMEM;
+	}
+
+	off = sizeof(hdr);
+	for (i = 0; i < hdr.num_blocks; i++) {
+		struct nss_stats_bin_block block;
+
+		if (len - off < sizeof(block)) {
+			return -EINVAL;
+		}
+
+		memcpy(&block, buf + off, sizeof(block));
+		off += sizeof(block);
+		if ((len - off) / sizeof(uint64_t) < block.num_counters) {
+			return -EINVAL;
+		}
+
+		/*
+		 * The driver keeps the counters 64-bit aligned, and the buffer comes from malloc()
+		 */
+		snap->blocks[i].num_counters = block.num_counters;
+		snap->blocks[i].counters = (const uint64_t *)(buf + off);
+		off += (size_t)block.num_counters * sizeof(uint64_t);
+	}
+
+	snap->num_blocks = hdr.num_blocks;
+	return 0;
+}
+
+/*
+ * nss_stats_bin_read_file()
+ *	Take a snapshot from a stats_bin file.
+ */
+int nss_stats_bin_read_file(const char *path, struct nss_stats_bin_snap *snap)
+{
+	size_t size = NSS_STATS_BIN_READ_MIN;
+	ssize_t len;
+	char *buf;
+	int fd, ret;
+
+	memset(snap, 0, sizeof(*snap));
+	for (;;) {
+		fd = open(path, O_RDONLY);
+		if (fd < 0) {
+			return -errno;
+		}
+
+		buf = malloc(size);
+		if (!buf) {
+			close(fd);
+			return -ENOMEM;
+		}
+
+		len = read(fd, buf, size);
+		ret = -errno;
+		close(fd);
+		if (len < 0) {
+			free(buf);
+			return ret;
+		}
+
+		if ((size_t)len < size) {
+			break;
+		}
+
+		/*
+		 * The snapshot may not have fit; take a new one in a larger buffer
+		 */
+		free(buf);
+		if (size >= NSS_STATS_BIN_READ_MAX) {
+			return -EFBIG;
+		}
+
+		size *= 2;
+	}
+
+	ret = nss_stats_bin_parse(snap, buf, len);
+	if (ret) {
+		nss_stats_bin_free(snap);
+	}
+
+	return ret;
+}
+
+/*
+ * nss_stats_bin_free()
+ *	Release a snapshot.
+ */
+void nss_stats_bin_free(struct nss_stats_bin_snap *snap)
+{
+	free(snap->blocks);
+	free(snap->buf);
+	memset(snap, 0, sizeof(*snap));
+}
+
+/*
+ * nss_stats_bin_names_load()
+ *	Read the counter names of a qca-nss-drv/strings file.
+ *
+ * Each line is "<stats type> , <name>"; counters are listed in order.
+ */
+int nss_stats_bin_names_load(const char *path, struct nss_stats_bin_names *names)
+{
+	char line[256], name[256];
+	unsigned int type;
+	uint32_t size = 0;
+	FILE *fp;
+
+	memset(names, 0, sizeof(*names));
+	fp = fopen(path, "r");
+	if (!fp) {
+		return -errno;
+	}
+
+	while (fgets(line, sizeof(line), fp)) {
+		if (sscanf(line, " %u , %255s", &type, name) != 2) {
+			continue;
+		}
+
+		if (names->count == size) {
+			char **grown;
+
+			size = size ? size * 2 : 64;
+			grown = realloc(names->name, size * sizeof(char *));
+			if (!grown) {
+				fclose(fp);
+				nss_stats_bin_names_free(names);
+				return -ENOMEM;
+			}
+
+			names->name = grown;
+		}
+
+		names->name[names->count] = strdup(name);
+		if (!names->name[names->count]) {
+			fclose(fp);
+			nss_stats_bin_names_free(names);
+			return -ENOMEM;
+		}
+
+		names->count++;
+	}
+
+	fclose(fp);
+	return 0;
+}
+
+/*
+ * nss_stats_bin_names_free()
+ *	Release the names of a block.
+ */
+void nss_stats_bin_names_free(struct nss_stats_bin_names *names)
+{
+	uint32_t i;
+
+	for (i = 0; i < names->count; i++) {
+		free(names->name[i]);
+	}
+
+	free(names->name);
+	memset(names, 0, sizeof(*names));
+}
+
+/*
+ * nss_stats_bin_name()
+ *	Name of counter i of a block.
+ */
+const char *nss_stats_bin_name(const struct nss_stats_bin_names *names, uint32_t i)
+{
+	if (!names || (i >= names->count)) {
+		return NULL;
+	}
+
+	return names->name[i];
+}
@@ -0,0 +1,82 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/*
+ * nss_stats_bin_lib.h
+ *	Reader for the binary statistics files under qca-nss-drv/stats_bin.
+ */
+
+#ifndef __NSS_STATS_BIN_LIB_H
+#define __NSS_STATS_BIN_LIB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "nss_stats_bin.h"
+
+/*
+ * One block of a snapshot, pointing into the snapshot buffer
+ */
+struct nss_stats_bin_view {
+	uint32_t num_counters;
+	const uint64_t *counters;
+};
+
+/*
+ * A parsed snapshot
+ */
+struct nss_stats_bin_snap {
+	char *buf;
+	size_t len;
+	uint16_t num_blocks;
+	struct nss_stats_bin_view *blocks;
+};
+
+/*
+ * Counter names of one block, from a qca-nss-drv/strings file
+ */
+struct nss_stats_bin_names {
+	uint32_t count;
+	char **name;
+};
+
+/*
+ * Parse len bytes of buf, which the snapshot takes over. Returns 0 or a negative errno.
+ */
+extern int nss_stats_bin_parse(struct nss_stats_bin_snap *snap, char *buf, size_t len);
+
+/*
+ * Take a snapshot by reading a whole stats_bin file at once. Returns 0 or a negative errno.
+ */
+extern int nss_stats_bin_read_file(const char *path, struct nss_stats_bin_snap *snap);
+
+extern void nss_stats_bin_free(struct nss_stats_bin_snap *snap);
+
+/*
+ * Load the names of a strings file, one "<stats type> , <name>" line per counter. Returns 0 or a negative errno.
+ */
+extern int nss_stats_bin_names_load(const char *path, struct nss_stats_bin_names *names);
+
+extern void nss_stats_bin_names_free(struct nss_stats_bin_names *names);
+
+/*
+ * Name of counter i, or NULL when unknown
+ */
+extern const char *nss_stats_bin_name(const struct nss_stats_bin_names *names, uint32_t i);
+
+#endif /* __NSS_STATS_BIN_LIB_H */
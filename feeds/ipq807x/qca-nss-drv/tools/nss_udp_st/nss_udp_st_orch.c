@@ -0,0 +1,1060 @@
+/*
+ **************************************************************************
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ **************************************************************************
+ */
+
+/*
+ * nss_udp_st_orch.c
+ *	Run UDP speed tests over many flows and rates through the nss_udp_st
+ *	generic netlink family.
+ *
+ * The firmware runs one test at a time with at most NSS_UDP_ST_TX_CONN_MAX
+ * connections and only keeps aggregate counters, so the flows are split in
+ * batches that are run one after the other, for every step of the rate ramp:
+ *
+ *	reset stats, create (tx), configure rules, start,
+ *	poll statistics for the step duration,
+ *	stop, unconfigure rules, destroy (tx)
+ *
+ * Every batch gives one JSON line on stdout, e.g.
+ *
+ *	nss_udp_st_orch -n 64 -S 192.168.1.1 -D 192.168.1.2 -r 100:100:1000 -t 10
+ *
+ * Flows can also be read from a file with one "src sport dst dport" per line.
+ * The firmware does not count per connection, so every figure is a batch
+ * aggregate; avg_flow_mbps is only the batch throughput shared evenly over
+ * the configured flows. Jitter is the standard deviation of the batch
+ * throughput seen between two polls.
+ *
+ * --mock replaces the netlink family with a loopback model of the firmware,
+ * so the orchestration and reporting can be checked on any host.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/genetlink.h>
+
+#include "nss_udp_st_nl.h"
+
+#define NSS_UDP_ST_ORCH_TEST_RX		0	/* NSS_UDP_ST_TEST_RX */
+#define NSS_UDP_ST_ORCH_TEST_TX		1	/* NSS_UDP_ST_TEST_TX */
+#define NSS_UDP_ST_ORCH_CONN_MAX	16	/* NSS_UDP_ST_TX_CONN_MAX */
+#define NSS_UDP_ST_ORCH_TIME_ELAPSED	2	/* NSS_UDP_ST_STATS_TIME_ELAPSED */
+
+/*
+ * enum nss_udp_st_error entries used in the report
+ */
+#define NSS_UDP_ST_ORCH_ERR_TOO_MANY_USERS	11
+#define NSS_UDP_ST_ORCH_ERR_PB_ALLOC		13
+#define NSS_UDP_ST_ORCH_ERR_PB_SIZE		14
+#define NSS_UDP_ST_ORCH_ERR_DROP_QUEUE		15
+#define NSS_UDP_ST_ORCH_ERR_TIMER_MISSED	16
+
+#define NSS_UDP_ST_ORCH_NL_BUF	(64 * 1024)
+
+/*
+ * Reply of a netlink command
+ */
+struct nss_udp_st_orch_reply {
+	uint32_t configured;		/* Rules taken by the firmware */
+	uint32_t failed;		/* Rules rejected */
+	uint32_t error;			/* First firmware error */
+	struct nss_udp_st_nl_stats stats;
+					/* Statistics */
+	bool has_stats;			/* stats is valid */
+};
+
+/*
+ * Test backend, the netlink family or the mock
+ */
+struct nss_udp_st_orch_backend {
+	int (*create)(uint32_t rate, uint32_t buffer_size, uint8_t dscp);
+	int (*destroy)(void);
+	int (*rules)(uint8_t cmd, const struct nss_udp_st_nl_rule *rules, uint32_t count,
+			struct nss_udp_st_orch_reply *reply);
+	int (*start)(uint32_t type);
+	int (*stop)(uint32_t type);
+	int (*reset_stats)(void);
+	int (*get_stats)(struct nss_udp_st_nl_stats *stats);
+};
+
+/*
+ * Run parameters
+ */
+struct nss_udp_st_orch_cfg {
+	uint32_t type;			/* NSS_UDP_ST_ORCH_TEST_* */
+	uint32_t rate_start;		/* First rate, Mbps */
+	uint32_t rate_step;		/* Rate increment, Mbps */
+	uint32_t rate_end;		/* Last rate, Mbps */
+	uint32_t buffer_size;		/* UDP payload size */
+	uint8_t dscp;			/* DSCP of the transmitted packets */
+	uint32_t duration_ms;		/* Duration of each step */
+	uint32_t interval_ms;		/* Statistics poll interval */
+	uint32_t max_conn;		/* Flows per batch */
+};
+
+static const char *nss_udp_st_orch_err_names[NSS_UDP_ST_NL_ERRORS] = {
+	"none", "incorrect_rate", "incorrect_buffer_size", "memory_failure",
+	"incorrect_state", "incorrect_flags", "entry_exist", "entry_add_failed",
+	"entry_not_exist", "wrong_start_msg_type", "wrong_stop_msg_type",
+	"too_many_users", "unknown_msg_type", "pb_alloc", "pb_size",
+	"drop_queue", "timer_missed",
+};
+
+/*
+ * nss_udp_st_orch_now_ms()
+ *	Monotonic time in ms.
+ */
+static double nss_udp_st_orch_now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+/*
+ * nss_udp_st_orch_sleep_ms()
+ *	Sleep for ms milliseconds.
+ */
+static void nss_udp_st_orch_sleep_ms(double ms)
+{
+	struct timespec ts;
+
+	if (ms <= 0) {
+		return;
+	}
+
+	ts.tv_sec = (time_t)(ms / 1000);
+	ts.tv_nsec = (long)((ms - ts.tv_sec * 1000.0) * 1000000.0);
+	nanosleep(&ts, NULL);
+}
+
+/*
+ * Generic netlink backend
+ */
+static int nss_udp_st_orch_nl_fd = -1;
+static uint16_t nss_udp_st_orch_nl_family;
+static uint32_t nss_udp_st_orch_nl_seq;
+
+/*
+ * nss_udp_st_orch_nl_msg()
+ *	Start a generic netlink request.
+ */
+static struct nlmsghdr *nss_udp_st_orch_nl_msg(void *buf, uint16_t family, uint8_t cmd, uint8_t version)
+{
+	struct nlmsghdr *nlh = (struct nlmsghdr *)buf;
+	struct genlmsghdr *gnlh;
+
+	memset(buf, 0, NLMSG_HDRLEN + GENL_HDRLEN);
+	nlh->nlmsg_len = NLMSG_HDRLEN + GENL_HDRLEN;
+	nlh->nlmsg_type = family;
+	nlh->nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK;
+	nlh->nlmsg_seq = ++nss_udp_st_orch_nl_seq;
+
+	gnlh = (struct genlmsghdr *)NLMSG_DATA(nlh);
+	gnlh->cmd = cmd;
+	gnlh->version = version;
+	return nlh;
+}
+
+/*
+ * nss_udp_st_orch_nl_put()
+ *	Append an attribute to a request.
+ */
+static int nss_udp_st_orch_nl_put(struct nlmsghdr *nlh, uint16_t type, const void *data, size_t len)
+{
+	struct nlattr *nla = (struct nlattr *)((char *)nlh + NLMSG_ALIGN(nlh->nlmsg_len));
+	size_t total = NLA_HDRLEN + len;
+
+	if ((total > UINT16_MAX) || (NLMSG_ALIGN(nlh->nlmsg_len) + NLA_ALIGN(total) > NSS_UDP_ST_ORCH_NL_BUF)) {
+		return -EMSGSIZE;
+	}
+
+	nla->nla_type = type;
+	nla->nla_len = (uint16_t)total;
+	memcpy((char *)nla + NLA_HDRLEN, data, len);
+	nlh->nlmsg_len = NLMSG_ALIGN(nlh->nlmsg_len) + NLA_ALIGN(total);
+	return 0;
+}
+
+/*
+ * nss_udp_st_orch_nl_parse()
+ *	Pick the attributes of a reply.
+ */
+static void nss_udp_st_orch_nl_parse(struct nlmsghdr *nlh, bool ctrl, struct nss_udp_st_orch_reply *reply)
+{
+	int len = nlh->nlmsg_len - NLMSG_HDRLEN - GENL_HDRLEN;
+	struct nlattr *nla = (struct nlattr *)((char *)NLMSG_DATA(nlh) + GENL_HDRLEN);
+
+	while ((len >= NLA_HDRLEN) && (nla->nla_len >= NLA_HDRLEN) && (nla->nla_len <= len)) {
+		void *data = (char *)nla + NLA_HDRLEN;
+		int dlen = nla->nla_len - NLA_HDRLEN;
+		uint16_t type = nla->nla_type & NLA_TYPE_MASK;
+
+		if (ctrl) {
+			if ((type == CTRL_ATTR_FAMILY_ID) && (dlen >= 2)) {
+				memcpy(&nss_udp_st_orch_nl_family, data, sizeof(uint16_t));
+			}
+		} else if ((type == NSS_UDP_ST_NL_ATTR_CONFIGURED) && (dlen >= 4)) {
+			memcpy(&reply->configured, data, sizeof(uint32_t));
+		} else if ((type == NSS_UDP_ST_NL_ATTR_FAILED) && (dlen >= 4)) {
+			memcpy(&reply->failed, data, sizeof(uint32_t));
+		} else if ((type == NSS_UDP_ST_NL_ATTR_ERROR) && (dlen >= 4)) {
+			memcpy(&reply->error, data, sizeof(uint32_t));
+		} else if ((type == NSS_UDP_ST_NL_ATTR_STATS) && (dlen >= (int)sizeof(reply->stats))) {
+			memcpy(&reply->stats, data, sizeof(reply->stats));
+			reply->has_stats = true;
+		}
+
+		len -= NLA_ALIGN(nla->nla_len);
+		nla = (struct nlattr *)((char *)nla + NLA_ALIGN(nla->nla_len));
+	}
+}
+
+/*
+ * nss_udp_st_orch_nl_transact()
+ *	Send a request and read its reply up to the acknowledgement.
+ */
+static int nss_udp_st_orch_nl_transact(struct nlmsghdr *req, struct nss_udp_st_orch_reply *reply)
+{
+	static char buf[NSS_UDP_ST_ORCH_NL_BUF];
+	bool ctrl = (req->nlmsg_type == GENL_ID_CTRL);
+	uint32_t seq = req->nlmsg_seq;
+
+	if (send(nss_udp_st_orch_nl_fd, req, req->nlmsg_len, 0) < 0) {
+		return -errno;
+	}
+
+	for (;;) {
+		struct nlmsghdr *nlh;
+		ssize_t len = recv(nss_udp_st_orch_nl_fd, buf, sizeof(buf), 0);
+
+		if (len < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -errno;
+		}
+
+		for (nlh = (struct nlmsghdr *)buf; NLMSG_OK(nlh, len); nlh = NLMSG_NEXT(nlh, len)) {
+			if (nlh->nlmsg_seq != seq) {
+				continue;
+			}
+
+			if (nlh->nlmsg_type == NLMSG_ERROR) {
+				struct nlmsgerr *err = (struct nlmsgerr *)NLMSG_DATA(nlh);
+				return err->error;
+			}
+
+			if (nlh->nlmsg_type == NLMSG_DONE) {
+				return 0;
+			}
+
+			nss_udp_st_orch_nl_parse(nlh, ctrl, reply);
+		}
+	}
+}
+
+/*
+ * nss_udp_st_orch_nl_open()
+ *	Open the generic netlink socket and resolve the udp_st family.
+ */
+static int nss_udp_st_orch_nl_open(void)
+{
+	static char req[NLMSG_HDRLEN + GENL_HDRLEN + 64];
+	struct sockaddr_nl addr = { .nl_family = AF_NETLINK };
+	struct nss_udp_st_orch_reply reply;
+	struct nlmsghdr *nlh;
+	int ret;
+
+	nss_udp_st_orch_nl_fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_GENERIC);
+	if (nss_udp_st_orch_nl_fd < 0) {
+		return -errno;
+	}
+
+	if (bind(nss_udp_st_orch_nl_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		return -errno;
+	}
+
+	nlh = nss_udp_st_orch_nl_msg(req, GENL_ID_CTRL, CTRL_CMD_GETFAMILY, 1);
+	nss_udp_st_orch_nl_put(nlh, CTRL_ATTR_FAMILY_NAME, NSS_UDP_ST_NL_FAMILY, sizeof(NSS_UDP_ST_NL_FAMILY));
+
+	memset(&reply, 0, sizeof(reply));
+	ret = nss_udp_st_orch_nl_transact(nlh, &reply);
+	if (ret) {
+		return ret;
+	}
+
+	return nss_udp_st_orch_nl_family ? 0 : -ENOENT;
+}
+
+/*
+ * nss_udp_st_orch_nl_cmd()
+ *	Send a command with an optional u32 attribute.
+ */
+static int nss_udp_st_orch_nl_cmd(uint8_t cmd, uint16_t attr, uint32_t value, struct nss_udp_st_orch_reply *reply)
+{
+	static char req[NLMSG_HDRLEN + GENL_HDRLEN + 64];
+	struct nss_udp_st_orch_reply dummy;
+	struct nlmsghdr *nlh;
+
+	nlh = nss_udp_st_orch_nl_msg(req, nss_udp_st_orch_nl_family, cmd, NSS_UDP_ST_NL_VERSION);
+	if (attr) {
+		nss_udp_st_orch_nl_put(nlh, attr, &value, sizeof(value));
+	}
+
+	if (!reply) {
+		reply = &dummy;
+	}
+
+	memset(reply, 0, sizeof(*reply));
+	return nss_udp_st_orch_nl_transact(nlh, reply);
+}
+
+static int nss_udp_st_orch_nl_create(uint32_t rate, uint32_t buffer_size, uint8_t dscp)
+{
+	static char req[NLMSG_HDRLEN + GENL_HDRLEN + 64];
+	struct nss_udp_st_orch_reply reply;
+	struct nlmsghdr *nlh;
+
+	nlh = nss_udp_st_orch_nl_msg(req, nss_udp_st_orch_nl_family, NSS_UDP_ST_NL_CMD_CREATE, NSS_UDP_ST_NL_VERSION);
+	nss_udp_st_orch_nl_put(nlh, NSS_UDP_ST_NL_ATTR_RATE, &rate, sizeof(rate));
+	nss_udp_st_orch_nl_put(nlh, NSS_UDP_ST_NL_ATTR_BUFFER_SIZE, &buffer_size, sizeof(buffer_size));
+	nss_udp_st_orch_nl_put(nlh, NSS_UDP_ST_NL_ATTR_DSCP, &dscp, sizeof(dscp));
+
+	memset(&reply, 0, sizeof(reply));
+	return nss_udp_st_orch_nl_transact(nlh, &reply);
+}
+
+static int nss_udp_st_orch_nl_destroy(void)
+{
+	return nss_udp_st_orch_nl_cmd(NSS_UDP_ST_NL_CMD_DESTROY, NSS_UDP_ST_NL_ATTR_FLAG, 0, NULL);
+}
+
+static int nss_udp_st_orch_nl_rules(uint8_t cmd, const struct nss_udp_st_nl_rule *rules, uint32_t count,
+			struct nss_udp_st_orch_reply *reply)
+{
+	static char req[NSS_UDP_ST_ORCH_NL_BUF];
+	struct nlmsghdr *nlh;
+	int ret;
+
+	nlh = nss_udp_st_orch_nl_msg(req, nss_udp_st_orch_nl_family, cmd, NSS_UDP_ST_NL_VERSION);
+	ret = nss_udp_st_orch_nl_put(nlh, NSS_UDP_ST_NL_ATTR_RULES, rules, count * sizeof(*rules));
+	if (ret) {
+		return ret;
+	}
+
+	memset(reply, 0, sizeof(*reply));
+	return nss_udp_st_orch_nl_transact(nlh, reply);
+}
+
+static int nss_udp_st_orch_nl_start(uint32_t type)
+{
+	return nss_udp_st_orch_nl_cmd(NSS_UDP_ST_NL_CMD_START, NSS_UDP_ST_NL_ATTR_TYPE, type, NULL);
+}
+
+static int nss_udp_st_orch_nl_stop(uint32_t type)
+{
+	return nss_udp_st_orch_nl_cmd(NSS_UDP_ST_NL_CMD_STOP, NSS_UDP_ST_NL_ATTR_TYPE, type, NULL);
+}
+
+static int nss_udp_st_orch_nl_reset_stats(void)
+{
+	return nss_udp_st_orch_nl_cmd(NSS_UDP_ST_NL_CMD_RESET_STATS, NSS_UDP_ST_NL_ATTR_FLAG, 0, NULL);
+}
+
+static int nss_udp_st_orch_nl_get_stats(struct nss_udp_st_nl_stats *stats)
+{
+	struct nss_udp_st_orch_reply reply;
+	int ret;
+
+	ret = nss_udp_st_orch_nl_cmd(NSS_UDP_ST_NL_CMD_GET_STATS, 0, 0, &reply);
+	if (ret) {
+		return ret;
+	}
+
+	if (!reply.has_stats) {
+		return -EPROTO;
+	}
+
+	*stats = reply.stats;
+	return 0;
+}
+
+static const struct nss_udp_st_orch_backend nss_udp_st_orch_nl = {
+	.create = nss_udp_st_orch_nl_create,
+	.destroy = nss_udp_st_orch_nl_destroy,
+	.rules = nss_udp_st_orch_nl_rules,
+	.start = nss_udp_st_orch_nl_start,
+	.stop = nss_udp_st_orch_nl_stop,
+	.reset_stats = nss_udp_st_orch_nl_reset_stats,
+	.get_stats = nss_udp_st_orch_nl_get_stats,
+};
+
+/*
+ * Loopback model of the firmware
+ *
+ * Packets are generated at the created rate (or received at it for an rx
+ * test), --mock-loss percent of them are dropped in the queue and the
+ * rate wobbles by a few percent between polls.
+ */
+static struct {
+	bool created;			/* Transmit node created */
+	uint32_t rate;			/* Mbps */
+	uint32_t buffer_size;		/* Bytes per packet */
+	uint32_t conns;			/* Configured rules */
+	int running;			/* Running test type, -1 if none */
+	double start_ms;		/* Test start */
+	double last_ms;			/* Last statistics update */
+	double carry;			/* Fraction of a packet not counted yet */
+	double loss;			/* Drop ratio */
+	struct nss_udp_st_nl_stats stats;
+} nss_udp_st_orch_mock = { .running = -1 };
+
+/*
+ * nss_udp_st_orch_mock_advance()
+ *	Account the traffic since the last update.
+ */
+static void nss_udp_st_orch_mock_advance(void)
+{
+	struct nss_udp_st_nl_stats *s = &nss_udp_st_orch_mock.stats;
+	double now = nss_udp_st_orch_now_ms();
+	double dt = now - nss_udp_st_orch_mock.last_ms;
+	double wobble, pkts;
+	uint64_t sent, dropped;
+
+	nss_udp_st_orch_mock.last_ms = now;
+	if (nss_udp_st_orch_mock.running < 0) {
+		return;
+	}
+
+	wobble = 0.97 + (rand() % 600) / 10000.0;
+	pkts = nss_udp_st_orch_mock.rate * 1e6 / 8 / nss_udp_st_orch_mock.buffer_size * dt / 1000 * wobble;
+	pkts += nss_udp_st_orch_mock.carry;
+	sent = (uint64_t)pkts;
+	nss_udp_st_orch_mock.carry = pkts - sent;
+	dropped = (uint64_t)(sent * nss_udp_st_orch_mock.loss + 0.5);
+	sent -= dropped;
+
+	if (nss_udp_st_orch_mock.running == NSS_UDP_ST_ORCH_TEST_TX) {
+		s->tx_packets += sent;
+		s->tx_bytes += sent * nss_udp_st_orch_mock.buffer_size;
+	} else {
+		s->rx_packets += sent;
+		s->rx_bytes += sent * nss_udp_st_orch_mock.buffer_size;
+	}
+
+	s->errors[NSS_UDP_ST_ORCH_ERR_DROP_QUEUE] += (uint32_t)dropped;
+	s->time[nss_udp_st_orch_mock.running][1] = (uint32_t)now;
+	s->time[nss_udp_st_orch_mock.running][NSS_UDP_ST_ORCH_TIME_ELAPSED] = (uint32_t)(now - nss_udp_st_orch_mock.start_ms);
+}
+
+static int nss_udp_st_orch_mock_create(uint32_t rate, uint32_t buffer_size, __attribute__((unused)) uint8_t dscp)
+{
+	if (nss_udp_st_orch_mock.created) {
+		nss_udp_st_orch_mock.stats.errors[4]++;
+		return -EIO;
+	}
+
+	if (!rate || !buffer_size) {
+		nss_udp_st_orch_mock.stats.errors[rate ? 2 : 1]++;
+		return -EIO;
+	}
+
+	nss_udp_st_orch_mock.created = true;
+	nss_udp_st_orch_mock.rate = rate;
+	nss_udp_st_orch_mock.buffer_size = buffer_size;
+	return 0;
+}
+
+static int nss_udp_st_orch_mock_destroy(void)
+{
+	nss_udp_st_orch_mock.created = false;
+	return 0;
+}
+
+static int nss_udp_st_orch_mock_rules(uint8_t cmd, __attribute__((unused)) const struct nss_udp_st_nl_rule *rules, uint32_t count,
+			struct nss_udp_st_orch_reply *reply)
+{
+	uint32_t i;
+
+	memset(reply, 0, sizeof(*reply));
+	for (i = 0; i < count; i++) {
+		if (cmd == NSS_UDP_ST_NL_CMD_UNCFG) {
+			if (!nss_udp_st_orch_mock.conns) {
+				reply->failed++;
+				reply->error = reply->error ? reply->error : 8;
+				continue;
+			}
+			nss_udp_st_orch_mock.conns--;
+		} else {
+			if (nss_udp_st_orch_mock.conns >= NSS_UDP_ST_ORCH_CONN_MAX) {
+				reply->failed++;
+				reply->error = reply->error ? reply->error : NSS_UDP_ST_ORCH_ERR_TOO_MANY_USERS;
+				nss_udp_st_orch_mock.stats.errors[NSS_UDP_ST_ORCH_ERR_TOO_MANY_USERS]++;
+				continue;
+			}
+			nss_udp_st_orch_mock.conns++;
+		}
+		reply->configured++;
+	}
+
+	return 0;
+}
+
+static int nss_udp_st_orch_mock_start(uint32_t type)
+{
+	if ((nss_udp_st_orch_mock.running >= 0) || !nss_udp_st_orch_mock.conns
+		|| ((type == NSS_UDP_ST_ORCH_TEST_TX) && !nss_udp_st_orch_mock.created)) {
+		nss_udp_st_orch_mock.stats.errors[4]++;
+		return -EIO;
+	}
+
+	nss_udp_st_orch_mock.running = type;
+	nss_udp_st_orch_mock.start_ms = nss_udp_st_orch_mock.last_ms = nss_udp_st_orch_now_ms();
+	nss_udp_st_orch_mock.stats.time[type][0] = (uint32_t)nss_udp_st_orch_mock.start_ms;
+	return 0;
+}
+
+static int nss_udp_st_orch_mock_stop(uint32_t type)
+{
+	if (nss_udp_st_orch_mock.running != (int)type) {
+		nss_udp_st_orch_mock.stats.errors[10]++;
+		return -EIO;
+	}
+
+	nss_udp_st_orch_mock_advance();
+	nss_udp_st_orch_mock.running = -1;
+	return 0;
+}
+
+static int nss_udp_st_orch_mock_reset_stats(void)
+{
+	memset(nss_udp_st_orch_mock.stats.errors, 0, sizeof(nss_udp_st_orch_mock.stats.errors));
+	nss_udp_st_orch_mock.stats.rx_packets = nss_udp_st_orch_mock.stats.rx_bytes = 0;
+	nss_udp_st_orch_mock.stats.tx_packets = nss_udp_st_orch_mock.stats.tx_bytes = 0;
+	return 0;
+}
+
+static int nss_udp_st_orch_mock_get_stats(struct nss_udp_st_nl_stats *stats)
+{
+	nss_udp_st_orch_mock_advance();
+	*stats = nss_udp_st_orch_mock.stats;
+	return 0;
+}
+
+static const struct nss_udp_st_orch_backend nss_udp_st_orch_mock_backend = {
+	.create = nss_udp_st_orch_mock_create,
+	.destroy = nss_udp_st_orch_mock_destroy,
+	.rules = nss_udp_st_orch_mock_rules,
+	.start = nss_udp_st_orch_mock_start,
+	.stop = nss_udp_st_orch_mock_stop,
+	.reset_stats = nss_udp_st_orch_mock_reset_stats,
+	.get_stats = nss_udp_st_orch_mock_get_stats,
+};
+
+/*
+ * nss_udp_st_orch_parse_ip()
+ *	Parse an IPv4 or IPv6 address into a rule, in host byte order.
+ */
+static int nss_udp_st_orch_parse_ip(const char *str, uint32_t *ip, uint16_t *version)
+{
+	struct in6_addr in6;
+	struct in_addr in;
+	int i;
+
+	if (inet_pton(AF_INET, str, &in) == 1) {
+		ip[0] = ntohl(in.s_addr);
+		*version = 4;
+		return 0;
+	}
+
+	if (inet_pton(AF_INET6, str, &in6) == 1) {
+		for (i = 0; i < 4; i++) {
+			uint32_t word;
+
+			memcpy(&word, &in6.s6_addr[i * 4], sizeof(word));
+			ip[i] = ntohl(word);
+		}
+		*version = 6;
+		return 0;
+	}
+
+	return -EINVAL;
+}
+
+/*
+ * nss_udp_st_orch_add_flow()
+ *	Append a flow to the flow table.
+ */
+static int nss_udp_st_orch_add_flow(struct nss_udp_st_nl_rule **flows, uint32_t *count, const char *src,
+			unsigned long sport, const char *dst, unsigned long dport)
+{
+	struct nss_udp_st_nl_rule rule, *tmp;
+	uint16_t dver = 0;
+
+	memset(&rule, 0, sizeof(rule));
+	if (nss_udp_st_orch_parse_ip(src, rule.src_ip, &rule.ip_version)
+		|| nss_udp_st_orch_parse_ip(dst, rule.dest_ip, &dver)
+		|| (dver != rule.ip_version) || (sport > UINT16_MAX) || (dport > UINT16_MAX)) {
+		return -EINVAL;
+	}
+
+	rule.src_port = (uint16_t)sport;
+	rule.dest_port = (uint16_t)dport;
+
+	if (!(*count & (*count - 1))) {
+		tmp = realloc(*flows, (*count ? *count * 2 : 1) * sizeof(rule));
+		if (!tmp) {
+			return -ENOMEM;
+		}
+		*flows = tmp;
+	}
+
+	(*flows)[(*count)++] = rule;
+	return 0;
+}
+
+/*
+ * nss_udp_st_orch_read_flows()
+ *	Read "src sport dst dport" lines.
+ */
+static int nss_udp_st_orch_read_flows(const char *path, struct nss_udp_st_nl_rule **flows, uint32_t *count)
+{
+	char line[512], src[INET6_ADDRSTRLEN], dst[INET6_ADDRSTRLEN];
+	unsigned long sport, dport;
+	unsigned int lineno = 0;
+	FILE *fp;
+
+	fp = strcmp(path, "-") ? fopen(path, "r") : stdin;
+	if (!fp) {
+		return -errno;
+	}
+
+	while (fgets(line, sizeof(line), fp)) {
+		char *p = line + strspn(line, " \t");
+
+		lineno++;
+		if ((*p == '#') || (*p == '\n') || !*p) {
+			continue;
+		}
+
+		if ((sscanf(p, "%45s %lu %45s %lu", src, &sport, dst, &dport) != 4)
+			|| nss_udp_st_orch_add_flow(flows, count, src, sport, dst, dport)) {
+			fprintf(stderr, "%s:%u: bad flow\n", path, lineno);
+			if (fp != stdin) {
+				fclose(fp);
+			}
+			return -EINVAL;
+		}
+	}
+
+	if (fp != stdin) {
+		fclose(fp);
+	}
+
+	return 0;
+}
+
+/*
+ * nss_udp_st_orch_drops()
+ *	Packets dropped by the firmware according to its error counters.
+ */
+static uint64_t nss_udp_st_orch_drops(const struct nss_udp_st_nl_stats *s)
+{
+	return (uint64_t)s->errors[NSS_UDP_ST_ORCH_ERR_PB_ALLOC] + s->errors[NSS_UDP_ST_ORCH_ERR_PB_SIZE]
+		+ s->errors[NSS_UDP_ST_ORCH_ERR_DROP_QUEUE];
+}
+
+/*
+ * nss_udp_st_orch_report()
+ *	Print the result of a batch.
+ */
+static void nss_udp_st_orch_report(const struct nss_udp_st_orch_cfg *cfg, uint32_t rate, uint32_t batch,
+			uint32_t count, const struct nss_udp_st_orch_reply *reply,
+			const struct nss_udp_st_nl_stats *base, const struct nss_udp_st_nl_stats *cur,
+			double elapsed_ms, double jitter, double min, double max)
+{
+	bool tx = (cfg->type == NSS_UDP_ST_ORCH_TEST_TX);
+	uint32_t configured = reply->configured;
+	uint64_t pkts, bytes, drops;
+	double mbps, pps, loss;
+	uint32_t i, n = 0;
+
+	pkts = tx ? cur->tx_packets - base->tx_packets : cur->rx_packets - base->rx_packets;
+	bytes = tx ? cur->tx_bytes - base->tx_bytes : cur->rx_bytes - base->rx_bytes;
+	drops = nss_udp_st_orch_drops(cur) - nss_udp_st_orch_drops(base);
+	mbps = elapsed_ms > 0 ? bytes * 8.0 / (elapsed_ms * 1000.0) : 0;
+	pps = elapsed_ms > 0 ? pkts * 1000.0 / elapsed_ms : 0;
+	loss = (pkts + drops) ? drops * 100.0 / (pkts + drops) : 0;
+
+	printf("{\"rate_mbps\":%u,\"batch\":%u,\"test\":\"%s\",\"flows\":%u,\"configured\":%u,"
+		"\"elapsed_ms\":%.1f,\"fw_elapsed_ms\":%u,"
+		"\"tx_pkts\":%llu,\"tx_bytes\":%llu,\"rx_pkts\":%llu,\"rx_bytes\":%llu,"
+		"\"drops\":%llu,\"loss_pct\":%.4f,\"mbps\":%.3f,\"pps\":%.1f,\"shortfall_pct\":%.3f,"
+		"\"jitter_mbps\":%.3f,\"min_mbps\":%.3f,\"max_mbps\":%.3f,\"avg_flow_mbps\":%.3f,\"errors\":{",
+		rate, batch, tx ? "tx" : "rx", count, configured,
+		elapsed_ms, cur->time[cfg->type][NSS_UDP_ST_ORCH_TIME_ELAPSED],
+		(unsigned long long)(cur->tx_packets - base->tx_packets),
+		(unsigned long long)(cur->tx_bytes - base->tx_bytes),
+		(unsigned long long)(cur->rx_packets - base->rx_packets),
+		(unsigned long long)(cur->rx_bytes - base->rx_bytes),
+		(unsigned long long)drops, loss, mbps, pps,
+		tx ? (1 - mbps / rate) * 100 : 0, jitter, min, max,
+		configured ? mbps / configured : 0);
+
+	for (i = 1; i < NSS_UDP_ST_NL_ERRORS; i++) {
+		uint32_t delta = cur->errors[i] - base->errors[i];
+
+		if (delta) {
+			printf("%s\"%s\":%u", n++ ? "," : "", nss_udp_st_orch_err_names[i], delta);
+		}
+	}
+
+	printf("}");
+	if (reply->error) {
+		printf(",\"cfg_error\":\"%s\"",
+			reply->error < NSS_UDP_ST_NL_ERRORS ? nss_udp_st_orch_err_names[reply->error] : "unknown");
+	}
+
+	printf("}\n");
+
+	fflush(stdout);
+}
+
+/*
+ * nss_udp_st_orch_batch()
+ *	Run one batch of flows at one rate and report it.
+ */
+static int nss_udp_st_orch_batch(const struct nss_udp_st_orch_backend *be, const struct nss_udp_st_orch_cfg *cfg,
+			uint32_t rate, uint32_t batch, struct nss_udp_st_nl_rule *flows, uint32_t count)
+{
+	struct nss_udp_st_nl_stats base, prev, cur;
+	struct nss_udp_st_orch_reply reply;
+	double t0, tprev, tcur, end, sum = 0, sum2 = 0, min = 0, max = 0, jitter = 0;
+	bool tx = (cfg->type == NSS_UDP_ST_ORCH_TEST_TX);
+	const char *stage;
+	uint32_t i, samples = 0;
+	int ret;
+
+	for (i = 0; i < count; i++) {
+		flows[i].type = (uint16_t)cfg->type;
+	}
+
+	memset(&reply, 0, sizeof(reply));
+	be->reset_stats();
+
+	stage = "create";
+	if (tx && (ret = be->create(rate, cfg->buffer_size, cfg->dscp))) {
+		goto fail;
+	}
+
+	stage = "cfg";
+	ret = be->rules(NSS_UDP_ST_NL_CMD_CFG, flows, count, &reply);
+	if (!ret && !reply.configured) {
+		ret = -EIO;
+	}
+
+	if (ret) {
+		goto destroy;
+	}
+
+	stage = "start";
+	if ((ret = be->get_stats(&base)) || (ret = be->start(cfg->type))) {
+		goto uncfg;
+	}
+
+	t0 = tprev = nss_udp_st_orch_now_ms();
+	end = t0 + cfg->duration_ms;
+	prev = base;
+
+	/*
+	 * Poll until the end of the step; every poll gives one throughput sample.
+	 */
+	stage = "get_stats";
+	do {
+		double left = end - nss_udp_st_orch_now_ms();
+		uint64_t db;
+		double m;
+
+		nss_udp_st_orch_sleep_ms(left < cfg->interval_ms ? left : cfg->interval_ms);
+		if ((ret = be->get_stats(&cur))) {
+			be->stop(cfg->type);
+			goto uncfg;
+		}
+
+		tcur = nss_udp_st_orch_now_ms();
+		db = tx ? cur.tx_bytes - prev.tx_bytes : cur.rx_bytes - prev.rx_bytes;
+		m = tcur > tprev ? db * 8.0 / ((tcur - tprev) * 1000.0) : 0;
+		sum += m;
+		sum2 += m * m;
+		min = (!samples || (m < min)) ? m : min;
+		max = (!samples || (m > max)) ? m : max;
+		samples++;
+
+		prev = cur;
+		tprev = tcur;
+	} while (tcur < end);
+
+	stage = "stop";
+	if ((ret = be->stop(cfg->type))) {
+		goto uncfg;
+	}
+
+	/*
+	 * Pick up what was counted between the last poll and the stop.
+	 */
+	if (!be->get_stats(&cur)) {
+		tcur = nss_udp_st_orch_now_ms();
+	}
+
+	if (samples > 1) {
+		double var = (sum2 - sum * sum / samples) / (samples - 1);
+
+		jitter = var > 0 ? sqrt(var) : 0;
+	}
+
+	nss_udp_st_orch_report(cfg, rate, batch, count, &reply, &base, &cur,
+			tcur - t0, jitter, min, max);
+
+	be->rules(NSS_UDP_ST_NL_CMD_UNCFG, flows, count, &reply);
+	if (tx) {
+		be->destroy();
+	}
+
+	return 0;
+
+uncfg:
+	be->rules(NSS_UDP_ST_NL_CMD_UNCFG, flows, count, &reply);
+
+destroy:
+	if (tx) {
+		be->destroy();
+	}
+
+fail:
+	printf("{\"rate_mbps\":%u,\"batch\":%u,\"test\":\"%s\",\"flows\":%u,\"failed\":\"%s\",\"errno\":%d",
+		rate, batch, tx ? "tx" : "rx", count, stage, -ret);
+	if (reply.error) {
+		printf(",\"fw_error\":\"%s\"",
+			reply.error < NSS_UDP_ST_NL_ERRORS ? nss_udp_st_orch_err_names[reply.error] : "unknown");
+	}
+
+	printf("}\n");
+	fflush(stdout);
+	return ret;
+}
+
+/*
+ * nss_udp_st_orch_usage()
+ */
+static void nss_udp_st_orch_usage(const char *prog)
+{
+	fprintf(stderr,
+		"usage: %s [options]\n"
+		"  -f, --flows FILE        flows, one \"src sport dst dport\" per line (- for stdin)\n"
+		"  -n, --count N           generate N flows from -S/-D/-p/-P, source port incrementing\n"
+		"  -S, --src IP            source address of generated flows\n"
+		"  -D, --dst IP            destination address of generated flows\n"
+		"  -p, --sport PORT        first source port of generated flows (default 10000)\n"
+		"  -P, --dport PORT        destination port of generated flows (default 5201)\n"
+		"  -T, --test tx|rx        test type (default tx)\n"
+		"  -r, --rate S[:STEP:E]   rate ramp in Mbps (default 100)\n"
+		"  -b, --buffer-size N     UDP payload size (default 1400)\n"
+		"  -q, --dscp N            DSCP of transmitted packets (default 0)\n"
+		"  -t, --duration SEC      duration of every step and batch (default 10)\n"
+		"  -i, --interval MS       statistics poll interval (default 1000)\n"
+		"  -m, --max-conn N        flows per batch (default %d)\n"
+		"  -M, --mock              use the loopback model instead of the firmware\n"
+		"  -L, --mock-loss PCT     drop ratio of the loopback model\n",
+		prog, NSS_UDP_ST_ORCH_CONN_MAX);
+}
+
+int main(int argc, char **argv)
+{
+	static const struct option longopts[] = {
+		{ "flows", required_argument, NULL, 'f' },
+		{ "count", required_argument, NULL, 'n' },
+		{ "src", required_argument, NULL, 'S' },
+		{ "dst", required_argument, NULL, 'D' },
+		{ "sport", required_argument, NULL, 'p' },
+		{ "dport", required_argument, NULL, 'P' },
+		{ "test", required_argument, NULL, 'T' },
+		{ "rate", required_argument, NULL, 'r' },
+		{ "buffer-size", required_argument, NULL, 'b' },
+		{ "dscp", required_argument, NULL, 'q' },
+		{ "duration", required_argument, NULL, 't' },
+		{ "interval", required_argument, NULL, 'i' },
+		{ "max-conn", required_argument, NULL, 'm' },
+		{ "mock", no_argument, NULL, 'M' },
+		{ "mock-loss", required_argument, NULL, 'L' },
+		{ "help", no_argument, NULL, 'h' },
+		{ NULL, 0, NULL, 0 },
+	};
+	struct nss_udp_st_orch_cfg cfg = {
+		.type = NSS_UDP_ST_ORCH_TEST_TX,
+		.rate_start = 100,
+		.rate_end = 100,
+		.buffer_size = 1400,
+		.duration_ms = 10000,
+		.interval_ms = 1000,
+		.max_conn = NSS_UDP_ST_ORCH_CONN_MAX,
+	};
+	const struct nss_udp_st_orch_backend *be = &nss_udp_st_orch_nl;
+	struct nss_udp_st_nl_rule *flows = NULL;
+	const char *src = NULL, *dst = NULL;
+	unsigned long n = 0, sport = 10000, dport = 5201;
+	uint32_t count = 0, rate, i;
+	int opt, ret, failures = 0;
+
+	while ((opt = getopt_long(argc, argv, "f:n:S:D:p:P:T:r:b:q:t:i:m:ML:h", longopts, NULL)) != -1) {
+		switch (opt) {
+		case 'f':
+			ret = nss_udp_st_orch_read_flows(optarg, &flows, &count);
+			if (ret) {
+				fprintf(stderr, "%s: %s\n", optarg, strerror(-ret));
+				return 1;
+			}
+			break;
+		case 'n':
+			n = strtoul(optarg, NULL, 0);
+			break;
+		case 'S':
+			src = optarg;
+			break;
+		case 'D':
+			dst = optarg;
+			break;
+		case 'p':
+			sport = strtoul(optarg, NULL, 0);
+			break;
+		case 'P':
+			dport = strtoul(optarg, NULL, 0);
+			break;
+		case 'T':
+			if (!strcmp(optarg, "tx")) {
+				cfg.type = NSS_UDP_ST_ORCH_TEST_TX;
+			} else if (!strcmp(optarg, "rx")) {
+				cfg.type = NSS_UDP_ST_ORCH_TEST_RX;
+			} else {
+				nss_udp_st_orch_usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'r':
+			ret = sscanf(optarg, "%u:%u:%u", &cfg.rate_start, &cfg.rate_step, &cfg.rate_end);
+			if (ret == 1) {
+				cfg.rate_end = cfg.rate_start;
+			} else if (ret != 3) {
+				nss_udp_st_orch_usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'b':
+			cfg.buffer_size = strtoul(optarg, NULL, 0);
+			break;
+		case 'q':
+			cfg.dscp = (uint8_t)strtoul(optarg, NULL, 0);
+			break;
+		case 't':
+			cfg.duration_ms = (uint32_t)(strtod(optarg, NULL) * 1000);
+			break;
+		case 'i':
+			cfg.interval_ms = strtoul(optarg, NULL, 0);
+			break;
+		case 'm':
+			cfg.max_conn = strtoul(optarg, NULL, 0);
+			break;
+		case 'M':
+			be = &nss_udp_st_orch_mock_backend;
+			break;
+		case 'L':
+			nss_udp_st_orch_mock.loss = strtod(optarg, NULL) / 100;
+			break;
+		default:
+			nss_udp_st_orch_usage(argv[0]);
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+
+	if (n && (!src || !dst)) {
+		fprintf(stderr, "-n needs -S and -D\n");
+		return 1;
+	}
+
+	for (i = 0; i < n; i++) {
+		if (nss_udp_st_orch_add_flow(&flows, &count, src, sport + i, dst, dport)) {
+			fprintf(stderr, "bad generated flow %u\n", i);
+			return 1;
+		}
+	}
+
+	if (!count || !cfg.max_conn || (cfg.max_conn > NSS_UDP_ST_NL_RULES_MAX) || !cfg.buffer_size
+		|| !cfg.interval_ms || !cfg.rate_start || (cfg.rate_end < cfg.rate_start)
+		|| ((cfg.rate_end != cfg.rate_start) && !cfg.rate_step)) {
+		nss_udp_st_orch_usage(argv[0]);
+		return 1;
+	}
+
+	if (be == &nss_udp_st_orch_nl) {
+		ret = nss_udp_st_orch_nl_open();
+		if (ret) {
+			fprintf(stderr, "%s netlink family: %s\n", NSS_UDP_ST_NL_FAMILY, strerror(-ret));
+			return 1;
+		}
+	}
+
+	for (rate = cfg.rate_start; rate <= cfg.rate_end; rate += cfg.rate_step) {
+		for (i = 0; i < count; i += cfg.max_conn) {
+			uint32_t batch = count - i < cfg.max_conn ? count - i : cfg.max_conn;
+
+			/*
+			 * An rx test has no transmit node; let the model receive
+			 * what the ramp would have sent.
+			 */
+			if ((be == &nss_udp_st_orch_mock_backend) && (cfg.type == NSS_UDP_ST_ORCH_TEST_RX)) {
+				nss_udp_st_orch_mock.rate = rate;
+				nss_udp_st_orch_mock.buffer_size = cfg.buffer_size;
+			}
+
+			if (nss_udp_st_orch_batch(be, &cfg, rate, i / cfg.max_conn, &flows[i], batch)) {
+				failures++;
+			}
+		}
+
+		if (!cfg.rate_step) {
+			break;
+		}
+	}
+
+	free(flows);
+	if (nss_udp_st_orch_nl_fd >= 0) {
+		close(nss_udp_st_orch_nl_fd);
+	}
+
+	return failures ? 2 : 0;
+}